@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+#
+# This file is part of the Fun programming language.
+# https://fun-lang.xyz/
+#
+# Copyright 2026 Johannes Findeisen <you@hanez.org>
+# Licensed under the terms of the Apache-2.0 license.
+# https://opensource.org/license/apache-2-0
+#
+# Compile-time benchmark: generates a synthetic script of roughly 50k lines
+# (data tables with many distinct literals, lots of functions and locals) and
+# measures how long `fun --compile` takes to parse and compile it.
+#
+# Constants are interned and globals/locals looked up through hash tables,
+# and line numbers are tracked incrementally, so compile time should grow
+# linearly with --lines: doubling it should about double the median. A
+# clearly faster growth means a per-line scan crept back into the compiler.
+#
+# Usage:
+#   bench/compile_large.py [--fun PATH] [--lines N] [--runs N] [--keep FILE]
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+FUNCS = 100           # globals grow on demand; this keeps the generated file readable
+LOCALS_PER_FUNC = 40  # a large function, far below MAX_FRAME_LOCALS
+
+
+def gen_function(idx, body_lines):
+    out = ["fun f_%d(a, b)" % idx]
+    for v in range(LOCALS_PER_FUNC):
+        out.append("  v%d = a + %d" % (v, idx * 1000 + v))
+    n = 0
+    while len(out) < body_lines - 1:
+        v = n % LOCALS_PER_FUNC
+        w = (n * 7 + 3) % LOCALS_PER_FUNC
+        kind = n % 4
+        if kind == 0:
+            out.append("  v%d = v%d * %d + b" % (v, w, idx * 100000 + n))
+        elif kind == 1:
+            out.append("  v%d = \"s_%d_%d\"" % (v, idx, n))
+        elif kind == 2:
+            out.append("  v%d = v%d + %d.%d" % (v, w, n, idx))
+        else:
+            out.append("  if v%d > %d" % (w, n))
+            out.append("    v%d = v%d - 1" % (v, v))
+        n += 1
+    out.append("  return v0")
+    return out
+
+
+def gen_table(rows):
+    out = ["fun table()", "  return ["]
+    for r in range(rows):
+        sep = "," if r + 1 < rows else ""
+        out.append("    {\"id\": %d, \"name\": \"item_%d\", \"w\": %d.5}%s" % (r, r, r, sep))
+    out.append("  ]")
+    return out
+
+
+def generate(total_lines):
+    table_rows = total_lines // 5
+    per_func = max(LOCALS_PER_FUNC + 4, (total_lines - table_rows) // FUNCS)
+    lines = ["// generated by bench/compile_large.py"]
+    lines += gen_table(table_rows)
+    for i in range(FUNCS):
+        lines += gen_function(i, per_func)
+    lines.append("print(len(table()))")
+    lines.append("print(f_0(1, 2))")
+    return "\n".join(lines) + "\n"
+
+
+def find_fun(root):
+    for cand in ("build/fun", "_gate_build/fun", "build_release/fun", "fun"):
+        p = os.path.join(root, cand)
+        if os.path.isfile(p) and os.access(p, os.X_OK):
+            return p
+    return None
+
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    ap = argparse.ArgumentParser(description=__doc__)
+    ap.add_argument("--fun", default=os.environ.get("FUN_BIN") or find_fun(root))
+    ap.add_argument("--lines", type=int, default=50000)
+    ap.add_argument("--runs", type=int, default=5)
+    ap.add_argument("--keep", help="write the generated script to this path")
+    args = ap.parse_args()
+    if not args.fun:
+        print("fun binary not found; pass --fun or set FUN_BIN", file=sys.stderr)
+        return 2
+
+    src = generate(args.lines)
+    tmpdir = tempfile.mkdtemp(prefix="fun_compile_bench_")
+    script = args.keep or os.path.join(tmpdir, "large.fun")
+    with open(script, "w") as fh:
+        fh.write(src)
+    out = os.path.join(tmpdir, "large.func")
+
+    times = []
+    for _ in range(args.runs):
+        t0 = time.perf_counter()
+        rc = subprocess.call([args.fun, "--compile", script, "-o", out])
+        times.append(time.perf_counter() - t0)
+        if rc != 0:
+            print("compile failed (exit %d)" % rc, file=sys.stderr)
+            return 1
+    times.sort()
+    print("compile_large: %d lines, %d runs: min %.3fs median %.3fs max %.3fs"
+          % (src.count("\n"), args.runs, times[0], times[len(times) // 2], times[-1]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,204 @@
+#!/usr/bin/env python3
+#
+# This file is part of the Fun programming language.
+# https://fun-lang.xyz/
+#
+# Copyright 2026 Johannes Findeisen <you@hanez.org>
+# Licensed under the terms of the Apache-2.0 license.
+# https://opensource.org/license/apache-2-0
+#
+# HTTP server benchmark: starts bench/http_hello.fun (HTTPServer from
+# lib/net) and drives it from a local client with CONNS concurrent keep-alive
+# connections, each sending PIPELINE requests per round trip, for DURATION
+# seconds. Reports requests per second. --pipeline 1 measures plain
+# keep-alive; --close opens a new connection per request; --file-size N
+# requests a static file of N bytes (served with sendfile) instead of the
+# "hello" handler and also reports throughput. --workers N preforks N server
+# processes on SO_REUSEPORT listeners; --clients N splits the connections over
+# N client processes so the load generator is not the bottleneck.
+#
+# Usage:
+#   bench/http_load.py [--fun PATH] [--conns N] [--pipeline N] [--duration S] [--close]
+#                      [--file-size N] [--workers N] [--clients N]
+
+import argparse
+import multiprocessing
+import os
+import selectors
+import signal
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+
+def find_fun(root):
+    for cand in ("build/fun", "_gate_build/fun", "build_release/fun", "fun"):
+        p = os.path.join(root, cand)
+        if os.path.isfile(p) and os.access(p, os.X_OK):
+            return p
+    return None
+
+
+def wait_listening(port, timeout):
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        try:
+            socket.create_connection(("127.0.0.1", port), timeout=0.2).close()
+            return True
+        except OSError:
+            time.sleep(0.05)
+    return False
+
+
+class Conn:
+    def __init__(self, port, pipeline, close, path):
+        self.request = b"GET %s HTTP/1.1\r\nHost: bench\r\n" % path.encode()
+        self.request += b"Connection: close\r\n\r\n" if close else b"\r\n"
+        self.port = port
+        self.pipeline = 1 if close else pipeline
+        self.close = close
+        self.sock = None
+        self.pending = 0
+        self.buf = b""
+
+    def open(self):
+        self.sock = socket.create_connection(("127.0.0.1", self.port))
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+
+    def send_batch(self):
+        self.sock.sendall(self.request * self.pipeline)
+        self.pending = self.pipeline
+
+    def on_data(self, data):
+        """Count complete responses (fixed-size bodies, Content-Length framing)."""
+        self.buf += data
+        done = 0
+        body_bytes = 0
+        while True:
+            hdr_end = self.buf.find(b"\r\n\r\n")
+            if hdr_end < 0:
+                break
+            head = self.buf[:hdr_end].lower()
+            i = head.find(b"content-length:")
+            length = int(head[i + 15:].split(b"\r\n", 1)[0]) if i >= 0 else 0
+            total = hdr_end + 4 + length
+            if len(self.buf) < total:
+                break
+            self.buf = self.buf[total:]
+            done += 1
+            body_bytes += length
+        self.pending -= done
+        return done, body_bytes
+
+
+def drive(port, nconns, pipeline, close, path, duration):
+    """Run one load-generating client; returns (requests, body bytes, errors, seconds)."""
+    sel = selectors.DefaultSelector()
+    conns = []
+    for _ in range(nconns):
+        c = Conn(port, pipeline, close, path)
+        c.open()
+        c.send_batch()
+        sel.register(c.sock, selectors.EVENT_READ, c)
+        conns.append(c)
+
+    served = 0
+    body_total = 0
+    errors = 0
+    t0 = time.perf_counter()
+    end = t0 + duration
+    while time.perf_counter() < end:
+        for key, _ in sel.select(timeout=0.5):
+            c = key.data
+            try:
+                data = c.sock.recv(65536)
+            except OSError:
+                data = b""
+            if data:
+                n, b = c.on_data(data)
+                served += n
+                body_total += b
+            if c.pending > 0 and data:
+                continue
+            if c.pending > 0:
+                errors += 1
+            sel.unregister(c.sock)
+            if c.close or not data:
+                c.sock.close()
+                c.buf = b""
+                c.open()
+            sel.register(c.sock, selectors.EVENT_READ, c)
+            c.send_batch()
+    elapsed = time.perf_counter() - t0
+    for c in conns:
+        c.sock.close()
+    return served, body_total, errors, elapsed
+
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    ap = argparse.ArgumentParser(description=__doc__)
+    ap.add_argument("--fun", default=os.environ.get("FUN_BIN") or find_fun(root))
+    ap.add_argument("--port", type=int, default=47330)
+    ap.add_argument("--conns", type=int, default=32)
+    ap.add_argument("--pipeline", type=int, default=8)
+    ap.add_argument("--duration", type=float, default=5.0)
+    ap.add_argument("--close", action="store_true", help="one request per connection")
+    ap.add_argument("--file-size", type=int, default=0, help="serve a static file of this many bytes")
+    ap.add_argument("--workers", type=int, default=1, help="server worker processes (SO_REUSEPORT)")
+    ap.add_argument("--clients", type=int, default=1, help="client processes sharing --conns")
+    args = ap.parse_args()
+    if not args.fun:
+        print("fun binary not found; pass --fun or set FUN_BIN", file=sys.stderr)
+        return 2
+
+    env = dict(os.environ)
+    env.setdefault("FUN_LIB_DIR", os.path.join(root, "lib"))
+    env["FUN_BENCH_PORT"] = str(args.port)
+    env["FUN_BENCH_WORKERS"] = str(args.workers)
+    path = "/"
+    if args.file_size > 0:
+        htdocs = tempfile.mkdtemp(prefix="fun_http_bench_")
+        with open(os.path.join(htdocs, "file.bin"), "wb") as fh:
+            fh.write((b"0123456789abcdef" * (args.file_size // 16 + 1))[:args.file_size])
+        env["FUN_BENCH_HTDOCS"] = htdocs
+        path = "/file.bin"
+    server = subprocess.Popen([args.fun, os.path.join(root, "bench", "http_hello.fun")],
+                              env=env, stdout=subprocess.DEVNULL, start_new_session=True)
+    try:
+        if not wait_listening(args.port, 5.0):
+            print("server did not start on port %d" % args.port, file=sys.stderr)
+            return 1
+        if args.workers > 1:
+            time.sleep(0.3)  # let every worker open its listener
+        if args.clients > 1:
+            per = [args.conns // args.clients + (1 if i < args.conns % args.clients else 0)
+                   for i in range(args.clients)]
+            jobs = [(args.port, n, args.pipeline, args.close, path, args.duration) for n in per if n > 0]
+            with multiprocessing.Pool(len(jobs)) as pool:
+                results = pool.starmap(drive, jobs)
+        else:
+            results = [drive(args.port, args.conns, args.pipeline, args.close, path, args.duration)]
+        served = sum(r[0] for r in results)
+        body_total = sum(r[1] for r in results)
+        errors = sum(r[2] for r in results)
+        elapsed = max(r[3] for r in results)
+    finally:
+        # the server and its forked workers share a process group
+        os.killpg(server.pid, signal.SIGTERM)
+        server.wait()
+
+    mode = "close" if args.close else "keep-alive, pipeline %d" % args.pipeline
+    if args.workers > 1:
+        mode += ", %d workers" % args.workers
+    if args.file_size > 0:
+        mode += ", %d-byte file" % args.file_size
+    print("http_load: %d conns (%s), %.1fs: %d requests, %.0f req/s, %.1f MB/s, %d errors"
+          % (args.conns, mode, elapsed, served, served / elapsed, body_total / elapsed / 1e6, errors))
+    return 0 if served > 0 else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+#
+# This file is part of the Fun programming language.
+# https://fun-lang.xyz/
+#
+# Copyright 2026 Johannes Findeisen <you@hanez.org>
+# Licensed under the terms of the Apache-2.0 license.
+# https://opensource.org/license/apache-2-0
+#
+# Benchmark suite runner (the fun_bench target). Runs every workload in
+# bench/suite/ (dispatch, calls, strings, maps, arrays, json, regex, crypto,
+# socket_echo) with FUN_BENCH_RUNS timed runs after one warm-up. Each
+# workload prints its per-run times and allocation count (see
+# bench/suite/harness.fun). The runner reports min, median and p99 (nearest
+# rank) per workload, and --out writes everything as JSON. compare diffs two
+# such files: median (or --metric min) change per workload, allocation and
+# result changes. It exits with 1 when a workload got slower by more than
+# --threshold percent or returned a different result.
+#
+# Usage:
+#   bench/suite.py [run] [--fun PATH] [--runs N] [--filter REGEX] [--out FILE]
+#   bench/suite.py compare BASE.json NEW.json [--threshold PCT] [--metric median|min]
+
+import argparse
+import datetime
+import glob
+import json
+import math
+import os
+import platform
+import re
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SUITE_FORMAT = 1
+
+
+def find_fun(root):
+    for cand in ("build/fun", "_gate_build/fun", "build_release/fun", "fun"):
+        p = os.path.join(root, cand)
+        if os.path.isfile(p) and os.access(p, os.X_OK):
+            return p
+    return None
+
+
+def workloads(pattern):
+    out = []
+    for path in sorted(glob.glob(os.path.join(ROOT, "bench", "suite", "*.fun"))):
+        name = os.path.splitext(os.path.basename(path))[0]
+        if name == "harness" or (pattern and not re.search(pattern, name)):
+            continue
+        out.append(path)
+    return out
+
+
+def percentile(sorted_vals, p):
+    return sorted_vals[max(0, math.ceil(p / 100.0 * len(sorted_vals)) - 1)]
+
+
+def summarize(rec):
+    ms = [t / 1e6 for t in rec["runs_ns"]]
+    s = sorted(ms)
+    n = len(s)
+    median = s[n // 2] if n % 2 else (s[n // 2 - 1] + s[n // 2]) / 2
+    return {
+        "runs": n,
+        "min_ms": round(s[0], 3),
+        "median_ms": round(median, 3),
+        "p99_ms": round(percentile(s, 99), 3),
+        "mean_ms": round(sum(s) / n, 3),
+        "allocs": rec.get("allocs"),
+        "result": rec.get("result"),
+        "samples_ms": [round(t, 3) for t in ms],
+    }
+
+
+def run_workload(fun, path, env):
+    """Run one workload script; returns (name, summary dict)."""
+    name = os.path.splitext(os.path.basename(path))[0]
+    # local includes ("bench/suite/harness.fun") resolve from the repository root
+    proc = subprocess.run([fun, os.path.relpath(path, ROOT)], cwd=ROOT, env=env,
+                          stdout=subprocess.PIPE, stderr=subprocess.PIPE, universal_newlines=True)
+    recs = [json.loads(line[6:]) for line in proc.stdout.splitlines() if line.startswith("BENCH ")]
+    if proc.returncode != 0 or not recs:
+        err = (proc.stderr.strip() or proc.stdout.strip()).splitlines()[-3:]
+        return name, {"error": "exit %d: %s" % (proc.returncode, " | ".join(err))}
+    rec = recs[-1]
+    if "skipped" in rec:
+        return rec["name"], {"skipped": rec["skipped"]}
+    return rec["name"], summarize(rec)
+
+
+def fun_version(fun):
+    try:
+        out = subprocess.run([fun, "--version"], stdout=subprocess.PIPE, universal_newlines=True).stdout
+        return out.strip()
+    except OSError:
+        return ""
+
+
+def cmd_run(args):
+    if not args.fun:
+        print("fun binary not found; pass --fun or set FUN_BIN", file=sys.stderr)
+        return 2
+    fun = os.path.abspath(args.fun)
+    env = dict(os.environ)
+    env["FUN_BENCH_RUNS"] = str(args.runs)
+    env.setdefault("FUN_LIB_DIR", os.path.join(ROOT, "lib"))
+
+    results = {}
+    failed = 0
+    print("%-12s %10s %10s %10s %10s" % ("workload", "min ms", "median ms", "p99 ms", "allocs"))
+    for path in workloads(args.filter):
+        name, res = run_workload(fun, path, env)
+        results[name] = res
+        if "error" in res:
+            failed += 1
+            print("%-12s %s" % (name, res["error"]))
+        elif "skipped" in res:
+            print("%-12s skipped: %s" % (name, res["skipped"]))
+        else:
+            print("%-12s %10.2f %10.2f %10.2f %10s" % (name, res["min_ms"], res["median_ms"], res["p99_ms"], res["allocs"]))
+        sys.stdout.flush()
+
+    if args.out:
+        doc = {
+            "format": SUITE_FORMAT,
+            "fun": fun,
+            "version": fun_version(fun),
+            "host": platform.node(),
+            "platform": platform.platform(),
+            "date": datetime.datetime.now().replace(microsecond=0).isoformat(),
+            "runs": args.runs,
+            "benchmarks": results,
+        }
+        with open(args.out, "w") as fh:
+            json.dump(doc, fh, indent=2, sort_keys=True)
+            fh.write("\n")
+        print("results: %s" % args.out)
+    return 1 if failed else 0
+
+
+def cmd_compare(args):
+    with open(args.base) as fh:
+        base = json.load(fh)["benchmarks"]
+    with open(args.new) as fh:
+        new = json.load(fh)["benchmarks"]
+
+    key = args.metric + "_ms"
+    regressions = changed = 0
+    print("%-12s %10s %10s %8s %8s  %s" % ("workload", "base ms", "new ms", "median", "min", "notes"))
+    for name in sorted(set(base) | set(new)):
+        b, n = base.get(name), new.get(name)
+        if not b or not n or "median_ms" not in b or "median_ms" not in n:
+            why = "only in base" if not n else "only in new" if not b else (n.get("error") or n.get("skipped") or b.get("error") or b.get("skipped"))
+            print("%-12s %10s %10s %8s %8s  %s" % (name, "-", "-", "-", "-", why))
+            continue
+        dmed = 100.0 * (n["median_ms"] - b["median_ms"]) / b["median_ms"] if b["median_ms"] else 0.0
+        dmin = 100.0 * (n["min_ms"] - b["min_ms"]) / b["min_ms"] if b["min_ms"] else 0.0
+        delta = dmed if args.metric == "median" else dmin
+        notes = []
+        if delta > args.threshold:
+            notes.append("SLOWER")
+            regressions += 1
+        elif delta < -args.threshold:
+            notes.append("faster")
+        if b.get("allocs") != n.get("allocs"):
+            notes.append("allocs %s -> %s" % (b.get("allocs"), n.get("allocs")))
+        if b.get("result") != n.get("result"):
+            notes.append("RESULT CHANGED")
+            changed += 1
+        print("%-12s %10.2f %10.2f %+7.1f%% %+7.1f%%  %s" % (name, b[key], n[key], dmed, dmin, ", ".join(notes)))
+    if regressions:
+        print("%d workload(s) slower than %.1f%% (%s)" % (regressions, args.threshold, args.metric))
+    if changed:
+        print("%d workload(s) returned a different result" % changed)
+    return 1 if regressions or changed else 0
+
+
+def main():
+    argv = sys.argv[1:]
+    if not argv or argv[0] not in ("run", "compare", "-h", "--help"):
+        argv = ["run"] + argv
+    ap = argparse.ArgumentParser(description="Fun benchmark suite")
+    sub = ap.add_subparsers(dest="cmd")
+    run = sub.add_parser("run", help="run the workloads")
+    run.add_argument("--fun", default=os.environ.get("FUN_BIN") or find_fun(ROOT))
+    run.add_argument("--runs", type=int, default=10, help="timed runs per workload (after one warm-up)")
+    run.add_argument("--filter", help="only workloads whose name matches this regex")
+    run.add_argument("--out", help="write the results as JSON to this file")
+    cmp_ = sub.add_parser("compare", help="diff two result files")
+    cmp_.add_argument("base")
+    cmp_.add_argument("new")
+    cmp_.add_argument("--threshold", type=float, default=5.0, help="change in percent to flag (default 5)")
+    cmp_.add_argument("--metric", choices=("median", "min"), default="median", help="time compared against the threshold")
+    args = ap.parse_args(argv)
+    return cmd_compare(args) if args.cmd == "compare" else cmd_run(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -37,9 +37,18 @@ option(FUN_DEBUG "Enable extra debug logging in Fun" OFF)
 # Optional: VM trace and opcode counters (disabled by default)
 option(FUN_TRACE "Enable VM tracing and opcode execution counters" OFF)
 
+# Event loop handles (evloop_*) use epoll on Linux; force the portable poll() backend instead
+option(FUN_EVLOOP_POLL "Use the poll() backend for evloop_* even where epoll is available" OFF)
+
+# Store array elements NaN-boxed in one 64-bit word instead of a 16-byte Value (see src/value.c)
+option(FUN_NANBOX "Store array elements NaN-boxed in 8 bytes" OFF)
+
+# Bypass the slab pools for strings, arrays and maps, e.g. for Valgrind or malloc debuggers (see src/pool.c)
+option(FUN_NO_POOL "Allocate small objects with malloc instead of the slab pools" OFF)
+
 # VM settings (configurable via -D...)
-set(MAX_FRAMES 128 CACHE STRING "Maximum depth of the call stack (frames)")
-set(MAX_FRAME_LOCALS 64 CACHE STRING "Maximum number of local variables per frame")
-set(MAX_GLOBALS 128 CACHE STRING "Maximum number of global variables")
+set(MAX_FRAMES 100000 CACHE STRING "Maximum depth of the call stack (frames grow on demand)")
+set(MAX_FRAME_LOCALS 65536 CACHE STRING "Maximum number of local variables per function")
+set(MAX_GLOBALS 65536 CACHE STRING "Maximum number of global variables (globals grow on demand)")
 set(OUTPUT_SIZE 1024 CACHE STRING "Size of the VM output buffer (number of values)")
-set(STACK_SIZE 1024 CACHE STRING "Size of the VM evaluation stack")
+set(STACK_SIZE 1048576 CACHE STRING "Maximum depth of the VM evaluation stack (grows on demand)")
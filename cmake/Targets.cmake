@@ -3,6 +3,7 @@
 # Core VM/library sources
 add_library(fun_core
   ${CMAKE_SOURCE_DIR}/src/bytecode.c
+  ${CMAKE_SOURCE_DIR}/src/bytecode_file.c
   ${CMAKE_SOURCE_DIR}/src/parser.c
   ${CMAKE_SOURCE_DIR}/src/value.c
   ${CMAKE_SOURCE_DIR}/src/vm.c
@@ -26,6 +27,21 @@ if(FUN_TRACE)
   target_compile_definitions(fun_core PUBLIC FUN_TRACE=1)
 endif()
 
+# Event loop backend override (see src/vm/os/evloop_common.c)
+if(FUN_EVLOOP_POLL)
+  target_compile_definitions(fun_core PUBLIC FUN_EVLOOP_POLL=1)
+endif()
+
+# NaN-boxed array element storage (see src/value.c)
+if(FUN_NANBOX)
+  target_compile_definitions(fun_core PUBLIC FUN_NANBOX=1)
+endif()
+
+# malloc instead of the slab pools (see src/pool.c)
+if(FUN_NO_POOL)
+  target_compile_definitions(fun_core PUBLIC FUN_NO_POOL=1)
+endif()
+
 # Provide default stdlib directory and version to the runtime
 target_compile_definitions(fun_core PUBLIC FUN_VERSION="${PROJECT_VERSION}")
 target_compile_definitions(fun_core PUBLIC DEFAULT_LIB_DIR="${DEFAULT_LIB_DIR}")
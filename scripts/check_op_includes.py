@@ -51,7 +51,7 @@ def parse_includes_from_vm(text: str) -> set[str]:
         switch_ops.add("CPP_ADD")
 
     # Drop support includes that are not opcode handlers
-    support_includes = {"thread_common", "stubs", "handles"}
+    support_includes = {"thread_common", "coroutine_common", "evloop_common", "http_common", "file_cache_common", "sockbuf_common", "proc_common", "csv_common", "profile_common", "hash_common", "codec_common", "stubs", "handles"}
     pairs = [(d, n) for (d, n) in pairs if n not in support_includes]
 
     # Base-name overrides (dir-agnostic) for a few special cases
@@ -107,7 +107,7 @@ def parse_includes_from_vm(text: str) -> set[str]:
     def map_token(d: str, n: str) -> str:
         # Directory-specific namespaces
         if d == "curl":
-            if n in {"download", "get", "post"}:
+            if n in {"download", "get", "multi", "post"}:
                 return f"CURL_{n.upper()}"
         if d == "openssl":
             if n in {"md5", "ripemd160", "sha256", "sha512"}:
@@ -129,7 +129,8 @@ def parse_includes_from_vm(text: str) -> set[str]:
             if n in {"parse", "stringify", "from_file", "to_file"}:
                 return f"JSON_{n.upper()}"
         if d == "xml":
-            if n in {"parse", "root", "name", "text"}:
+            if n in {"parse", "root", "name", "text", "free", "children", "next", "parent", "attrs", "attr", "xpath",
+                     "reader_open", "reader_next", "reader_record", "reader_close"}:
                 return f"XML_{n.upper()}"
         if d == "sqlite":
             if n in {"open", "close", "exec", "query"}:
@@ -10,6 +10,7 @@
 #include "bytecode.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /**
  * @file bytecode.c
@@ -28,53 +29,178 @@ Bytecode *bytecode_new(void) {
   Bytecode *bc = (Bytecode *)malloc(sizeof(Bytecode));
   bc->instructions = NULL;
   bc->instr_count = 0;
+  bc->instr_cap = 0;
   bc->constants = NULL;
   bc->const_count = 0;
+  bc->const_cap = 0;
+  bc->const_index = NULL;
+  bc->const_index_cap = 0;
+  bc->nlocals = 0;
   bc->name = NULL;
   bc->source_file = NULL;
+  bc->line_map = NULL;
   return bc;
 }
 
+/**
+ * @brief Check whether a constant takes part in interning.
+ *
+ * Only scalar literals and strings are de-duplicated; functions, arrays, maps
+ * and nil are always appended (matching the former value_equals behavior).
+ */
+static int const_is_internable(const Value *v) {
+  return v->type == VAL_INT || v->type == VAL_FLOAT || v->type == VAL_BOOL || v->type == VAL_STRING;
+}
+
+/**
+ * @brief Hash an internable constant. Keys are type-exact.
+ */
+static uint32_t const_hash(const Value *v) {
+  uint64_t h;
+  switch (v->type) {
+  case VAL_INT:
+    h = (uint64_t)v->i;
+    break;
+  case VAL_BOOL:
+    h = v->i != 0;
+    break;
+  case VAL_FLOAT:
+    memcpy(&h, &v->d, sizeof(h));
+    break;
+  case VAL_STRING: {
+    const unsigned char *p = (const unsigned char *)(v->s ? v->s : "");
+    h = 1469598103934665603ULL;
+    while (*p) {
+      h ^= *p++;
+      h *= 1099511628211ULL;
+    }
+    break;
+  }
+  default:
+    h = 0;
+    break;
+  }
+  h ^= (uint64_t)v->type * 0x9E3779B97F4A7C15ULL;
+  h ^= h >> 33;
+  h *= 0xFF51AFD7ED558CCDULL;
+  h ^= h >> 33;
+  return (uint32_t)h;
+}
+
+/**
+ * @brief Type-exact equality for interned constants.
+ *
+ * Unlike value_equals, 1 and 1.0 are different constants here: merging them
+ * would silently change the type of a literal. Floats compare bitwise so that
+ * 0.0 and -0.0 stay distinct as well.
+ */
+static int const_same(const Value *a, const Value *b) {
+  if (a->type != b->type) return 0;
+  switch (a->type) {
+  case VAL_INT:
+    return a->i == b->i;
+  case VAL_BOOL:
+    return (a->i != 0) == (b->i != 0);
+  case VAL_FLOAT:
+    return memcmp(&a->d, &b->d, sizeof(double)) == 0;
+  case VAL_STRING:
+    return strcmp(a->s ? a->s : "", b->s ? b->s : "") == 0;
+  default:
+    return 0;
+  }
+}
+
+/**
+ * @brief (Re)build the interning table with room for at least @p need entries.
+ *
+ * Also used lazily for bytecode whose constants were filled directly (e.g. by
+ * the .func loader).
+ *
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int const_index_rebuild(Bytecode *bc, int need) {
+  int cap = 16;
+  while (cap < need * 2)
+    cap *= 2;
+  int *slots = (int *)calloc((size_t)cap, sizeof(int));
+  if (!slots) return 0;
+  for (int i = 0; i < bc->const_count; ++i) {
+    if (!const_is_internable(&bc->constants[i])) continue;
+    uint32_t j = const_hash(&bc->constants[i]) & (uint32_t)(cap - 1);
+    while (slots[j]) {
+      if (const_same(&bc->constants[slots[j] - 1], &bc->constants[i])) break;
+      j = (j + 1) & (uint32_t)(cap - 1);
+    }
+    if (!slots[j]) slots[j] = i + 1;
+  }
+  free(bc->const_index);
+  bc->const_index = slots;
+  bc->const_index_cap = cap;
+  return 1;
+}
+
 /**
  * @brief Append a constant to a Bytecode's constant table with de-duplication.
  *
- * The value is compared against existing constants and if an equal constant is
- * already present, its index is returned without modifying the table. Equality
- * uses value_equals which supports numeric cross-type (int/float) equality and
- * string content equality. The caller retains ownership of @p v in all cases.
- * When a new constant is inserted, a deep copy is stored in the table.
+ * Scalar and string constants are interned through a hash table, so an equal
+ * constant already present is returned in O(1) without modifying the table.
+ * Equality is type-exact (an int never matches a float). The caller retains
+ * ownership of @p v in all cases. When a new constant is inserted, a deep copy
+ * is stored in the table, which grows geometrically.
  *
  * @param bc Target bytecode (must not be NULL).
  * @param v  Value to store (copied on insert).
  * @return The index of the stored or matched existing constant (zero-based).
  */
 int bytecode_add_constant(Bytecode *bc, Value v) {
-  /* Linear scan for a match. This is fast enough for small constant pools and
-   * avoids duplicates (smaller bytecode, better cache locality). */
-  for (int i = 0; i < bc->const_count; ++i) {
-    if (value_equals(&bc->constants[i], &v)) {
-      return i;
+  int internable = const_is_internable(&v);
+  uint32_t slot = 0;
+  if (internable) {
+    if ((bc->const_count + 1) * 2 > bc->const_index_cap && !const_index_rebuild(bc, bc->const_count + 1)) {
+      internable = 0; /* out of memory: fall back to plain append */
+    } else {
+      uint32_t mask = (uint32_t)(bc->const_index_cap - 1);
+      slot = const_hash(&v) & mask;
+      while (bc->const_index[slot]) {
+        int idx = bc->const_index[slot] - 1;
+        if (const_same(&bc->constants[idx], &v)) return idx;
+        slot = (slot + 1) & mask;
+      }
     }
   }
 
   /* Not found: append a copy */
-  bc->constants = (Value *)realloc(bc->constants, sizeof(Value) * (bc->const_count + 1));
+  if (bc->const_count >= bc->const_cap) {
+    int ncap = bc->const_cap ? bc->const_cap * 2 : 8;
+    bc->constants = (Value *)realloc(bc->constants, sizeof(Value) * (size_t)ncap);
+    bc->const_cap = ncap;
+  }
   bc->constants[bc->const_count] = copy_value(&v);
+  if (internable) bc->const_index[slot] = bc->const_count + 1;
   return bc->const_count++;
 }
 
 /**
  * @brief Append a single instruction to the instruction stream.
  *
+ * The instruction array grows geometrically, so emitting n instructions costs
+ * amortized O(n). Local slot operands are tracked in nlocals so the VM can
+ * size call frames exactly.
+ *
  * @param bc      Target bytecode (must not be NULL).
  * @param op      Opcode to emit.
  * @param operand Operand value (semantics depend on opcode).
  * @return The index of the emitted instruction (zero-based).
  */
 int bytecode_add_instruction(Bytecode *bc, OpCode op, int32_t operand) {
-  bc->instructions = (Instruction *)realloc(bc->instructions, sizeof(Instruction) * (bc->instr_count + 1));
+  if (bc->instr_count >= bc->instr_cap) {
+    int ncap = bc->instr_cap ? bc->instr_cap * 2 : 16;
+    bc->instructions = (Instruction *)realloc(bc->instructions, sizeof(Instruction) * (size_t)ncap);
+    bc->instr_cap = ncap;
+  }
   bc->instructions[bc->instr_count].op = op;
   bc->instructions[bc->instr_count].operand = operand;
+  if ((op == OP_LOAD_LOCAL || op == OP_STORE_LOCAL) && operand >= bc->nlocals) bc->nlocals = operand + 1;
   return bc->instr_count++;
 }
 
@@ -90,13 +216,195 @@ int bytecode_add_instruction(Bytecode *bc, OpCode op, int32_t operand) {
 void bytecode_set_operand(Bytecode *bc, int idx, int32_t operand) {
   if (idx >= 0 && idx < bc->instr_count) {
     bc->instructions[idx].operand = operand;
+    OpCode op = bc->instructions[idx].op;
+    if ((op == OP_LOAD_LOCAL || op == OP_STORE_LOCAL) && operand >= bc->nlocals) bc->nlocals = operand + 1;
+  }
+}
+
+/**
+ * @brief Allocate an empty include line map with a reference count of 1.
+ *
+ * @return Newly allocated LineMap*, or NULL on allocation failure.
+ */
+LineMap *line_map_new(void) {
+  LineMap *lm = (LineMap *)calloc(1, sizeof(LineMap));
+  if (lm) lm->refcount = 1;
+  return lm;
+}
+
+/** @brief FNV-1a hash of a file name for the line map's file index. */
+static uint32_t line_map_file_hash(const char *file) {
+  const unsigned char *p = (const unsigned char *)file;
+  uint32_t h = 2166136261u;
+  while (*p) {
+    h ^= *p++;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+/**
+ * @brief (Re)build the file name index with room for at least @p need files.
+ *
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int line_map_index_rebuild(LineMap *lm, int need) {
+  int cap = 16;
+  while (cap < need * 2)
+    cap *= 2;
+  int *slots = (int *)calloc((size_t)cap, sizeof(int));
+  if (!slots) return 0;
+  for (int i = 0; i < lm->file_count; ++i) {
+    uint32_t j = line_map_file_hash(lm->files[i]) & (uint32_t)(cap - 1);
+    while (slots[j])
+      j = (j + 1) & (uint32_t)(cap - 1);
+    slots[j] = i + 1;
+  }
+  free(lm->file_index);
+  lm->file_index = slots;
+  lm->file_index_cap = cap;
+  return 1;
+}
+
+/**
+ * @brief Append a span to a line map.
+ *
+ * Spans must be added in ascending first_line order (the order in which the
+ * preprocessor markers appear). File names are interned through a hash table
+ * so every span of the same file shares one string, and both arrays grow
+ * geometrically: building a map of n spans costs amortized O(n).
+ *
+ * @param lm         Target map.
+ * @param file       Original file path for the span.
+ * @param first_line First expanded line covered by the span (1-based).
+ * @param base_line  Original line that first_line corresponds to.
+ * @return 1 on success, 0 on invalid order or allocation failure.
+ */
+int line_map_add_span(LineMap *lm, const char *file, int first_line, int base_line) {
+  if (!lm || !file) return 0;
+  if (lm->span_count > 0 && lm->spans[lm->span_count - 1].first_line >= first_line) return 0;
+
+  if ((lm->file_count + 1) * 2 > lm->file_index_cap && !line_map_index_rebuild(lm, lm->file_count + 1)) return 0;
+  uint32_t mask = (uint32_t)(lm->file_index_cap - 1);
+  uint32_t slot = line_map_file_hash(file) & mask;
+  int fidx = -1;
+  while (lm->file_index[slot]) {
+    int i = lm->file_index[slot] - 1;
+    if (strcmp(lm->files[i], file) == 0) {
+      fidx = i;
+      break;
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  if (lm->span_count >= lm->span_cap) {
+    int ncap = lm->span_cap ? lm->span_cap * 2 : 16;
+    LineMapSpan *ns = (LineMapSpan *)realloc(lm->spans, sizeof(LineMapSpan) * (size_t)ncap);
+    if (!ns) return 0;
+    lm->spans = ns;
+    lm->span_cap = ncap;
+  }
+
+  if (fidx < 0) {
+    if (lm->file_count >= lm->file_cap) {
+      int ncap = lm->file_cap ? lm->file_cap * 2 : 8;
+      char **nf = (char **)realloc(lm->files, sizeof(char *) * (size_t)ncap);
+      if (!nf) return 0;
+      lm->files = nf;
+      lm->file_cap = ncap;
+    }
+    lm->files[lm->file_count] = strdup(file);
+    if (!lm->files[lm->file_count]) return 0;
+    fidx = lm->file_count++;
+    lm->file_index[slot] = fidx + 1;
+  }
+
+  lm->spans[lm->span_count].first_line = first_line;
+  lm->spans[lm->span_count].base_line = base_line;
+  lm->spans[lm->span_count].file = fidx;
+  lm->span_count++;
+  return 1;
+}
+
+/**
+ * @brief Take an additional reference on a line map (NULL-safe).
+ */
+void line_map_retain(LineMap *lm) {
+  if (lm) lm->refcount++;
+}
+
+/**
+ * @brief Drop a reference on a line map and free it when unused (NULL-safe).
+ */
+void line_map_release(LineMap *lm) {
+  if (!lm || --lm->refcount > 0) return;
+  for (int i = 0; i < lm->file_count; ++i)
+    free(lm->files[i]);
+  free(lm->files);
+  free(lm->file_index);
+  free(lm->spans);
+  free(lm);
+}
+
+/**
+ * @brief Map a line of the expanded source back to its original file and line.
+ *
+ * Binary-searches the span that contains @p line. Each span starts right after
+ * a preprocessor marker line and ends before the next marker line; the marker
+ * lines themselves do not map to any original line.
+ *
+ * @param lm       Line map (may be NULL).
+ * @param line     1-based line in the expanded source (OP_LINE operand).
+ * @param out_file Receives the original file path (owned by the map).
+ * @param out_line Receives the 1-based line within that file.
+ * @return 1 if the line was mapped, 0 otherwise.
+ */
+int line_map_lookup(const LineMap *lm, int line, const char **out_file, int *out_line) {
+  if (!lm || lm->span_count == 0 || line <= 0) return 0;
+  int lo = 0, hi = lm->span_count - 1, found = -1;
+  while (lo <= hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (lm->spans[mid].first_line <= line) {
+      found = mid;
+      lo = mid + 1;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  if (found < 0) return 0;
+  /* the line just before the next span is that span's marker line */
+  if (found + 1 < lm->span_count && line >= lm->spans[found + 1].first_line - 1) return 0;
+  const LineMapSpan *sp = &lm->spans[found];
+  if (out_file) *out_file = lm->files[sp->file];
+  if (out_line) *out_line = sp->base_line + (line - sp->first_line);
+  return 1;
+}
+
+/**
+ * @brief Attach a line map to a bytecode and every nested function bytecode.
+ *
+ * Each bytecode holds its own reference; a previously attached map is
+ * released. Bytecodes that already carry @p lm are skipped, which also stops
+ * the walk on shared or recursive function constants.
+ *
+ * @param bc Module or function bytecode.
+ * @param lm Line map to share (may be NULL to detach).
+ */
+void bytecode_set_line_map(Bytecode *bc, LineMap *lm) {
+  if (!bc || bc->line_map == lm) return;
+  line_map_retain(lm);
+  line_map_release(bc->line_map);
+  bc->line_map = lm;
+  for (int i = 0; i < bc->const_count; ++i) {
+    if (bc->constants[i].type == VAL_FUNCTION) bytecode_set_line_map(bc->constants[i].fn, lm);
   }
 }
 
 /**
  * @brief Free a Bytecode and all memory it owns.
  *
- * Frees constants (deep), instruction array, and metadata strings.
+ * Frees constants (deep), instruction array, and metadata strings, and drops
+ * the bytecode's reference on its line map.
  * Accepts NULL and is then a no-op.
  *
  * @param bc Bytecode to free (may be NULL).
@@ -107,9 +415,11 @@ void bytecode_free(Bytecode *bc) {
     free_value(bc->constants[i]);
   }
   free(bc->constants);
+  free(bc->const_index);
   free(bc->instructions);
   if (bc->name) free((void *)bc->name);
   if (bc->source_file) free((void *)bc->source_file);
+  line_map_release(bc->line_map);
   free(bc);
 }
 
@@ -255,10 +565,46 @@ static const char *opcode_name(OpCode op) {
     return "VALUES";
   case OP_HAS_KEY:
     return "HAS_KEY";
+  case OP_SET_NEW:
+    return "SET_NEW";
+  case OP_SET_ADD:
+    return "SET_ADD";
+  case OP_SET_REMOVE:
+    return "SET_REMOVE";
+  case OP_SET_UNION:
+    return "SET_UNION";
+  case OP_SET_INTERSECT:
+    return "SET_INTERSECT";
+  case OP_MAP_INCR:
+    return "MAP_INCR";
+  case OP_COUNT_BY:
+    return "COUNT_BY";
+  case OP_GROUP_BY:
+    return "GROUP_BY";
   case OP_READ_FILE:
     return "READ_FILE";
   case OP_WRITE_FILE:
     return "WRITE_FILE";
+  case OP_CSV_OPEN:
+    return "CSV_OPEN";
+  case OP_CSV_NEXT:
+    return "CSV_NEXT";
+  case OP_CSV_READ:
+    return "CSV_READ";
+  case OP_CSV_HEADER:
+    return "CSV_HEADER";
+  case OP_CSV_CLOSE:
+    return "CSV_CLOSE";
+  case OP_CSV_PARSE:
+    return "CSV_PARSE";
+  case OP_CSV_WRITER:
+    return "CSV_WRITER";
+  case OP_CSV_WRITE:
+    return "CSV_WRITE";
+  case OP_CSV_WRITER_CLOSE:
+    return "CSV_WRITER_CLOSE";
+  case OP_CSV_FORMAT:
+    return "CSV_FORMAT";
   case OP_ENV:
     return "ENV";
   case OP_INPUT_LINE:
@@ -267,10 +613,40 @@ static const char *opcode_name(OpCode op) {
     return "PROC_RUN";
   case OP_PROC_SYSTEM:
     return "PROC_SYSTEM";
+  case OP_PROC_FORK:
+    return "PROC_FORK";
+  case OP_PROC_WAITPID:
+    return "PROC_WAITPID";
+  case OP_PROC_KILL:
+    return "PROC_KILL";
+  case OP_PROC_GETPID:
+    return "PROC_GETPID";
+  case OP_PROC_GETPPID:
+    return "PROC_GETPPID";
+  case OP_PROC_SPAWN:
+    return "PROC_SPAWN";
+  case OP_PROC_WRITE:
+    return "PROC_WRITE";
+  case OP_PROC_CLOSE_STDIN:
+    return "PROC_CLOSE_STDIN";
+  case OP_PROC_READ:
+    return "PROC_READ";
+  case OP_PROC_POLL:
+    return "PROC_POLL";
+  case OP_PROC_WAIT:
+    return "PROC_WAIT";
+  case OP_PROC_WAIT_MANY:
+    return "PROC_WAIT_MANY";
+  case OP_PROC_PID:
+    return "PROC_PID";
+  case OP_PROC_CLOSE:
+    return "PROC_CLOSE";
   case OP_TIME_NOW_MS:
     return "TIME_NOW_MS";
   case OP_CLOCK_MONO_MS:
     return "CLOCK_MONO_MS";
+  case OP_CLOCK_MONO_NS:
+    return "CLOCK_MONO_NS";
   case OP_DATE_FORMAT:
     return "DATE_FORMAT";
   case OP_ENV_ALL:
@@ -315,6 +691,8 @@ static const char *opcode_name(OpCode op) {
     return "CURL_POST";
   case OP_CURL_DOWNLOAD:
     return "CURL_DOWNLOAD";
+  case OP_CURL_MULTI:
+    return "CURL_MULTI";
   case OP_SQLITE_OPEN:
     return "SQLITE_OPEN";
   case OP_SQLITE_CLOSE:
@@ -375,6 +753,28 @@ static const char *opcode_name(OpCode op) {
     return "XML_NAME";
   case OP_XML_TEXT:
     return "XML_TEXT";
+  case OP_XML_FREE:
+    return "XML_FREE";
+  case OP_XML_CHILDREN:
+    return "XML_CHILDREN";
+  case OP_XML_NEXT:
+    return "XML_NEXT";
+  case OP_XML_PARENT:
+    return "XML_PARENT";
+  case OP_XML_ATTRS:
+    return "XML_ATTRS";
+  case OP_XML_ATTR:
+    return "XML_ATTR";
+  case OP_XML_XPATH:
+    return "XML_XPATH";
+  case OP_XML_READER_OPEN:
+    return "XML_READER_OPEN";
+  case OP_XML_READER_NEXT:
+    return "XML_READER_NEXT";
+  case OP_XML_READER_RECORD:
+    return "XML_READER_RECORD";
+  case OP_XML_READER_CLOSE:
+    return "XML_READER_CLOSE";
   case OP_FLOOR:
     return "FLOOR";
   case OP_CEIL:
@@ -409,6 +809,100 @@ static const char *opcode_name(OpCode op) {
     return "FMIN";
   case OP_FMAX:
     return "FMAX";
+  case OP_CO_CREATE:
+    return "CO_CREATE";
+  case OP_CO_RESUME:
+    return "CO_RESUME";
+  case OP_YIELD:
+    return "YIELD";
+  case OP_CO_STATUS:
+    return "CO_STATUS";
+  case OP_CO_CLOSE:
+    return "CO_CLOSE";
+  case OP_CO_RUNNING:
+    return "CO_RUNNING";
+  case OP_EVLOOP_NEW:
+    return "EVLOOP_NEW";
+  case OP_EVLOOP_ADD:
+    return "EVLOOP_ADD";
+  case OP_EVLOOP_MOD:
+    return "EVLOOP_MOD";
+  case OP_EVLOOP_DEL:
+    return "EVLOOP_DEL";
+  case OP_EVLOOP_WAIT:
+    return "EVLOOP_WAIT";
+  case OP_EVLOOP_CLOSE:
+    return "EVLOOP_CLOSE";
+  case OP_HTTP_PARSE_REQUEST:
+    return "HTTP_PARSE_REQUEST";
+  case OP_HTTP_RESPONSE:
+    return "HTTP_RESPONSE";
+  case OP_SOCK_SENDFILE:
+    return "SOCK_SENDFILE";
+  case OP_FILE_CACHE_STAT:
+    return "FILE_CACHE_STAT";
+  case OP_SOCK_BUF_NEW:
+    return "SOCK_BUF_NEW";
+  case OP_SOCK_BUF_FREE:
+    return "SOCK_BUF_FREE";
+  case OP_SOCK_BUF_LEN:
+    return "SOCK_BUF_LEN";
+  case OP_SOCK_BUF_APPEND:
+    return "SOCK_BUF_APPEND";
+  case OP_SOCK_BUF_TAKE:
+    return "SOCK_BUF_TAKE";
+  case OP_SOCK_BUF_CONSUME:
+    return "SOCK_BUF_CONSUME";
+  case OP_SOCK_RECV_INTO:
+    return "SOCK_RECV_INTO";
+  case OP_SOCK_SEND_ALL:
+    return "SOCK_SEND_ALL";
+  case OP_SOCK_READV:
+    return "SOCK_READV";
+  case OP_SOCK_WRITEV:
+    return "SOCK_WRITEV";
+  case OP_GC:
+    return "GC";
+  case OP_GC_STATS:
+    return "GC_STATS";
+  case OP_MEM_STATS:
+    return "MEM_STATS";
+  case OP_HASH_NEW:
+    return "HASH_NEW";
+  case OP_HASH_UPDATE:
+    return "HASH_UPDATE";
+  case OP_HASH_UPDATE_HEX:
+    return "HASH_UPDATE_HEX";
+  case OP_HASH_FINAL:
+    return "HASH_FINAL";
+  case OP_HASH_FREE:
+    return "HASH_FREE";
+  case OP_AES256_ENCRYPT_HEX:
+    return "AES256_ENCRYPT_HEX";
+  case OP_CRYPTO_ACCEL:
+    return "CRYPTO_ACCEL";
+  case OP_BASE64_ENCODE:
+    return "BASE64_ENCODE";
+  case OP_BASE64_DECODE:
+    return "BASE64_DECODE";
+  case OP_HEX_ENCODE:
+    return "HEX_ENCODE";
+  case OP_HEX_DECODE:
+    return "HEX_DECODE";
+  case OP_URL_ENCODE:
+    return "URL_ENCODE";
+  case OP_URL_DECODE:
+    return "URL_DECODE";
+  case OP_CODEC_NEW:
+    return "CODEC_NEW";
+  case OP_CODEC_UPDATE:
+    return "CODEC_UPDATE";
+  case OP_CODEC_FINAL:
+    return "CODEC_FINAL";
+  case OP_CODEC_FREE:
+    return "CODEC_FREE";
+  case OP_CODEC_ACCEL:
+    return "CODEC_ACCEL";
   case OP_RUST_HELLO:
     return "RUST_HELLO";
   case OP_RUST_HELLO_ARGS:
@@ -127,22 +127,57 @@ typedef enum {
   OP_RANDOM_INT,  // pops hi, lo; pushes random int in [lo, hi)
 
   // maps
-  OP_MAKE_MAP, // operand = pair count; pops 2*n (key,value)..., pushes map
-  OP_KEYS,     // pops map; pushes array of keys
-  OP_VALUES,   // pops map; pushes array of values
-  OP_HAS_KEY,  // pops key, map; pushes 1/0
+  OP_MAKE_MAP,      // operand = pair count; pops 2*n (key,value)..., pushes map
+  OP_KEYS,          // pops map; pushes array of keys
+  OP_VALUES,        // pops map; pushes array of values
+  OP_HAS_KEY,       // pops key, map; pushes 1/0
+  OP_SET_NEW,       // operand 0: pushes empty set; 1: pops array, pushes set of its items
+  OP_SET_ADD,       // pops value, set; pushes 1 added / 0 present / -1 unhashable
+  OP_SET_REMOVE,    // pops key, set or map; pushes 1 if removed
+  OP_SET_UNION,     // pops b, a (sets); pushes new set a | b
+  OP_SET_INTERSECT, // pops b, a (sets); pushes new set a & b
+  OP_MAP_INCR,      // operand 1 pops delta (else 1); pops key, map; adds in place, pushes new value
+  OP_COUNT_BY,      // pops array; pushes map item -> occurrences
+  OP_GROUP_BY,      // pops keys array, items array; pushes map key -> array of items
 
   // file I/O
   OP_READ_FILE,  // pops path string; pushes content string (or "")
   OP_WRITE_FILE, // pops data string, path string; pushes 1/0
 
+  // CSV (streaming reader/writer, see vm/io/csv_common.c)
+  OP_CSV_OPEN,         // [pops options if operand==1], path or fd; pushes reader handle (0 on error)
+  OP_CSV_NEXT,         // pops reader; pushes next row (array or map) or nil at end
+  OP_CSV_READ,         // pops count, reader; pushes array of up to count rows
+  OP_CSV_HEADER,       // pops reader; pushes array of column names
+  OP_CSV_CLOSE,        // pops reader; pushes 1/0
+  OP_CSV_PARSE,        // [pops options if operand==1], text; pushes array of rows
+  OP_CSV_WRITER,       // [pops options if operand==1], path or fd; pushes writer handle (0 on error)
+  OP_CSV_WRITE,        // pops row or rows, writer; pushes rows written
+  OP_CSV_WRITER_CLOSE, // pops writer; flushes; pushes 1 if all writes succeeded
+  OP_CSV_FORMAT,       // [pops options if operand==1], rows; pushes CSV string
+
   // OS
-  OP_ENV,           // pops name string; pushes value string (or "")
-  OP_INPUT_LINE,    // operand: 0=no prompt; 1=has prompt. Pops [prompt?]; pushes input string (no trailing newline)
-  OP_PROC_RUN,      // pops command string; pushes map {"out": string, "code": int}
-  OP_PROC_SYSTEM,   // pops command string; pushes exit code number
-  OP_TIME_NOW_MS,   // pushes current wall-clock time in milliseconds since Unix epoch
-  OP_CLOCK_MONO_MS, // pushes monotonic clock in milliseconds (not wall time)
+  OP_ENV,              // pops name string; pushes value string (or "")
+  OP_INPUT_LINE,       // operand: 0=no prompt; 1=has prompt. Pops [prompt?]; pushes input string (no trailing newline)
+  OP_PROC_RUN,         // pops command string; pushes map {"out": string, "code": int}
+  OP_PROC_SYSTEM,      // pops command string; pushes exit code number
+  OP_PROC_FORK,        // fork(); pushes child pid in the parent, 0 in the child, -1 on error
+  OP_PROC_WAITPID,     // pops pid; waits for the child; pushes exit code (128+signal if killed) or -1
+  OP_PROC_KILL,        // pops signal, pid; pushes 1/0
+  OP_PROC_GETPID,      // pushes the process id
+  OP_PROC_GETPPID,     // pushes the parent process id
+  OP_PROC_SPAWN,       // operand 1=has options. Pops [options], argv array; pushes process handle or 0
+  OP_PROC_WRITE,       // pops data, handle; writes all to the child stdin; pushes bytes or -1
+  OP_PROC_CLOSE_STDIN, // pops handle; closes the child stdin; pushes 1/0
+  OP_PROC_READ,        // operand 1=has stream. Pops [stream], handle; pushes buffered stdout/stderr
+  OP_PROC_POLL,        // pops handle; pushes nil while running, else exit code
+  OP_PROC_WAIT,        // operand 1=has timeout. Pops [timeout_ms], handle; pushes exit code or nil
+  OP_PROC_WAIT_MANY,   // operand 1=has timeout. Pops [timeout_ms], handles; pushes exited handles
+  OP_PROC_PID,         // pops handle; pushes child pid or 0
+  OP_PROC_CLOSE,       // pops handle; kills a running child, frees it; pushes 1/0
+  OP_TIME_NOW_MS,      // pushes current wall-clock time in milliseconds since Unix epoch
+  OP_CLOCK_MONO_MS,    // pushes monotonic clock in milliseconds (not wall time)
+  OP_CLOCK_MONO_NS,    // pushes monotonic clock in nanoseconds (for timing short intervals)
 
   // kcgi (optional)
   OP_KCGI_PARSE,       // () -> Map | Nil (parse request via kcgi)
@@ -179,6 +214,7 @@ typedef enum {
   OP_CURL_GET,      // pops [headers map?], url; pushes response string (or "")
   OP_CURL_POST,     // pops [headers map?], body string, url; pushes response string (or "")
   OP_CURL_DOWNLOAD, // pops [headers map?], path, url; pushes 1/0
+  OP_CURL_MULTI,    // operand 1: pops max_parallel; pops requests array; pushes array of result maps
 
   // SQLite (optional)
   OP_SQLITE_OPEN,  // pops path; pushes handle (>0) or 0
@@ -221,14 +257,25 @@ typedef enum {
   OP_INI_UNSET,      // pops key, section, handle; pushes 1/0
   OP_INI_SAVE,       // pops path, handle; pushes 1/0
 
-  // XML (libxml2) optional minimal API
-  OP_XML_PARSE, // pops text string; pushes doc handle (>0) or 0
-  OP_XML_ROOT,  // pops doc handle; pushes node handle (>0) or 0
-  OP_XML_NAME,  // pops node handle; pushes string (node name)
-  OP_XML_TEXT,  // pops node handle; pushes string (node text)
+  // XML (libxml2): DOM, XPath and streaming reader
+  OP_XML_PARSE,         // pops text string; pushes doc handle (>0) or 0
+  OP_XML_ROOT,          // pops doc handle; pushes node handle (>0) or 0
+  OP_XML_NAME,          // pops node handle; pushes string (node name)
+  OP_XML_TEXT,          // pops node handle; pushes string (node text)
+  OP_XML_FREE,          // pops doc handle; frees it with its node handles; pushes 1/0
+  OP_XML_CHILDREN,      // pops node handle; pushes array of child element handles
+  OP_XML_NEXT,          // pops node handle; pushes next sibling element handle or 0
+  OP_XML_PARENT,        // pops node handle; pushes parent element handle or 0
+  OP_XML_ATTRS,         // pops node handle; pushes map of attribute name -> value
+  OP_XML_ATTR,          // pops name, node handle; pushes attribute value or Nil
+  OP_XML_XPATH,         // operand 1: pops ns map; pops expr, node handle; pushes node array or scalar
+  OP_XML_READER_OPEN,   // pops path; pushes streaming reader handle (>0) or 0
+  OP_XML_READER_NEXT,   // pops reader handle; pushes event map or Nil at end
+  OP_XML_READER_RECORD, // pops element name, reader; pushes doc handle of next such element or 0
+  OP_XML_READER_CLOSE,  // pops reader handle; pushes 1/0
 
   // Sockets (UNIX platforms)
-  OP_SOCK_TCP_LISTEN,   // pops backlog, port; returns listen fd (>0) or 0
+  OP_SOCK_TCP_LISTEN,   // operand 1: pops options map; pops backlog, port; returns listen fd (>0) or 0
   OP_SOCK_TCP_ACCEPT,   // pops listen fd; returns client fd (>0) or 0
   OP_SOCK_TCP_CONNECT,  // pops port, host; returns fd (>0) or 0
   OP_SOCK_SEND,         // pops data string, fd; returns bytes sent (>=0) or -1
@@ -285,6 +332,69 @@ typedef enum {
   OP_FMIN, // pops b, a (int/float); pushes fmin(a,b) (NaN handling per C99)
   OP_FMAX, // pops b, a (int/float); pushes fmax(a,b) (NaN handling per C99)
 
+  // Coroutines (see vm/core/coroutine_common.c)
+  OP_CO_CREATE,  // operand: 0=no args, 1=has args; pops [args?], fn; pushes coroutine id (int>0)
+  OP_CO_RESUME,  // operand: 0=no value, 1=has value; pops [value?], id; runs it until yield/return; pushes that value
+  OP_YIELD,      // operand: 0=no value, 1=has value; pops [value?]; suspends the running coroutine
+  OP_CO_STATUS,  // pops id; pushes "suspended", "running", "normal" or "dead"
+  OP_CO_CLOSE,   // pops id; discards the coroutine and its frames; pushes 1/0
+  OP_CO_RUNNING, // pushes id of the running coroutine (0 in the main program)
+
+  // Event loop handles (epoll, poll fallback; see vm/os/evloop_common.c)
+  OP_EVLOOP_NEW,   // pushes event loop handle (>0) or 0
+  OP_EVLOOP_ADD,   // pops events, fd, loop; registers fd for events (1=read, 2=write); pushes 1/0
+  OP_EVLOOP_MOD,   // pops events, fd, loop; changes the events of a registered fd; pushes 1/0
+  OP_EVLOOP_DEL,   // pops fd, loop; unregisters fd; pushes 1/0
+  OP_EVLOOP_WAIT,  // pops max_events, timeout_ms, loop; pushes array of [fd, events] (4=error/hangup)
+  OP_EVLOOP_CLOSE, // pops loop; frees the handle; pushes 1/0
+
+  // HTTP/1.1 (see vm/net/http_common.c)
+  OP_HTTP_PARSE_REQUEST, // pops buffer string; pushes map (status "ok"/"incomplete"/"error", request fields, consumed)
+  OP_HTTP_RESPONSE,      // pops [reason if operand==1], keep_alive, body, headers (map/nil), status; pushes serialized response string
+
+  // Static files (open-fd cache + sendfile)
+  OP_SOCK_SENDFILE,   // pops [head if operand==1], len, offset, path, fd; pushes bytes sent (0 = would block, -1 = error)
+  OP_FILE_CACHE_STAT, // pops path; pushes {size, mtime} of a cached regular file or nil
+
+  // Socket buffers and vectored I/O (see vm/os/sockbuf_common.c); I/O results: n>0, 0=EOF, -1=error, -2=would block
+  OP_SOCK_BUF_NEW,     // pops capacity (0 = default); pushes buffer handle or 0
+  OP_SOCK_BUF_FREE,    // pops buffer; frees it; pushes 1/0
+  OP_SOCK_BUF_LEN,     // pops buffer; pushes stored byte count or -1
+  OP_SOCK_BUF_APPEND,  // pops data string, buffer; appends; pushes new length or -1
+  OP_SOCK_BUF_TAKE,    // pops n, buffer; removes and pushes the first n bytes (n<0: all) as a string
+  OP_SOCK_BUF_CONSUME, // pops n, buffer; drops the first n bytes; pushes remaining length or -1
+  OP_SOCK_RECV_INTO,   // pops buffer, fd; receives into the buffer; pushes I/O result
+  OP_SOCK_SEND_ALL,    // pops data (string or buffer), fd; sends until done or would block; pushes bytes sent or -1/-2
+  OP_SOCK_READV,       // pops array of buffers, fd; one readv into their free space; pushes I/O result
+  OP_SOCK_WRITEV,      // pops array of strings/buffers, fd; writev until done or would block; pushes bytes sent or -1/-2
+
+  // Cycle collector and allocation pools (see gc.h, pool.h)
+  OP_GC,        // runs a cycle collection; pushes the number of arrays/maps freed
+  OP_GC_STATS,  // pushes map of collector statistics (collections, collected, pause times, ...)
+  OP_MEM_STATS, // pushes map of allocation statistics (live objects by kind, pool bytes, ...)
+
+  // Native hashes and AES-256 (see crypto.h, vm/crypto/hash_common.c)
+  OP_HASH_NEW,           // pops algorithm name; pushes hash handle or 0
+  OP_HASH_UPDATE,        // pops data string, handle; hashes it; pushes bytes hashed so far or -1
+  OP_HASH_UPDATE_HEX,    // pops hex string, handle; hashes the decoded bytes; pushes bytes hashed so far or -1
+  OP_HASH_FINAL,         // pops handle; frees it; pushes the digest as lowercase hex ("" if unknown)
+  OP_HASH_FREE,          // pops handle; frees it without a digest; pushes 1/0
+  OP_AES256_ENCRYPT_HEX, // pops key hex (64 digits), data hex (whole 16-byte blocks); pushes ECB ciphertext hex or ""
+  OP_CRYPTO_ACCEL,       // pushes map of the kernels in use (sha1, sha256, crc32c, aes)
+
+  // Base64, hex and percent-encoding (see codec.h, vm/encoding/codec_common.c)
+  OP_BASE64_ENCODE, // pops [url flag if operand], data (string or byte array); pushes base64 (base64url if url)
+  OP_BASE64_DECODE, // pops [as_bytes if operand], text; pushes decoded string (byte array if as_bytes) or nil
+  OP_HEX_ENCODE,    // pops data (string or byte array); pushes lowercase hex
+  OP_HEX_DECODE,    // pops [as_bytes if operand], hex; pushes decoded string (byte array if as_bytes) or nil
+  OP_URL_ENCODE,    // pops [form flag if operand], text; pushes percent-encoded text (space as '+' if form)
+  OP_URL_DECODE,    // pops [form flag if operand], text; pushes percent-decoded text ('+' as space if form)
+  OP_CODEC_NEW,     // pops [mode if operand], format; pushes codec handle or 0
+  OP_CODEC_UPDATE,  // pops data, handle; pushes the output for this chunk or nil
+  OP_CODEC_FINAL,   // pops handle; frees it; pushes the rest of the output or nil
+  OP_CODEC_FREE,    // pops handle; frees it without flushing; pushes 1/0
+  OP_CODEC_ACCEL,   // pushes map of the kernels in use (base64, hex, url)
+
   // Rust FFI demo opcode(s)
   OP_RUST_HELLO,             // pushes string returned from Rust (hello world)
   OP_RUST_HELLO_ARGS,        // pops message string; prints it via Rust; pushes Nil
@@ -304,16 +414,49 @@ typedef struct {
   int32_t operand;
 } Instruction;
 
+/*
+ * Expanded-line -> (file, line) mapping, built once at compile time from the
+ * include preprocessor's span markers. OP_LINE operands refer to lines in the
+ * expanded top-level source; the map translates them back to the original
+ * file without touching the filesystem. Spans are sorted by first_line and
+ * looked up with a binary search. One map is shared (refcounted) by a module
+ * and all of its nested function bytecodes.
+ */
+typedef struct {
+  int32_t first_line; /* first expanded line covered by the span (1-based) */
+  int32_t base_line;  /* line in the original file that first_line maps to */
+  int32_t file;       /* index into LineMap.files */
+} LineMapSpan;
+
+typedef struct LineMap {
+  int refcount;
+  char **files;
+  int file_count;
+  int file_cap;        /* allocated file slots (grown geometrically) */
+  int *file_index;     /* open-addressing table of file names: file index + 1, 0 = empty */
+  int file_index_cap;  /* slots in file_index (power of two, 0 = not built yet) */
+  LineMapSpan *spans;
+  int span_count;
+  int span_cap;        /* allocated span slots (grown geometrically) */
+} LineMap;
+
 typedef struct Bytecode {
   Instruction *instructions;
   int instr_count;
+  int instr_cap; /* allocated instruction slots (grown geometrically) */
 
   Value *constants;
   int const_count;
+  int const_cap;      /* allocated constant slots (grown geometrically) */
+  int *const_index;   /* open-addressing interning table: constant index + 1, 0 = empty */
+  int const_index_cap; /* slots in const_index (power of two, 0 = not built yet) */
+
+  int nlocals; /* local slots referenced by LOAD_LOCAL/STORE_LOCAL (max operand + 1) */
 
   /* debug metadata */
   const char *name;        /* function or module name (optional) */
   const char *source_file; /* originating source filename (optional) */
+  LineMap *line_map;       /* shared include line map (optional, refcounted) */
 } Bytecode;
 
 // constructors / manipulation
@@ -326,4 +469,18 @@ void bytecode_free(Bytecode *bc);
 // utilities
 void bytecode_dump(const Bytecode *bc);
 
+// include line maps
+LineMap *line_map_new(void);
+int line_map_add_span(LineMap *lm, const char *file, int first_line, int base_line); /* spans in ascending order */
+void line_map_retain(LineMap *lm);
+void line_map_release(LineMap *lm);
+int line_map_lookup(const LineMap *lm, int line, const char **out_file, int *out_line);
+void bytecode_set_line_map(Bytecode *bc, LineMap *lm); /* attaches to bc and nested functions */
+
+// serialization (.func files, see bytecode_file.c)
+#define FUNC_FILE_MAGIC "FUNC"
+int bytecode_save_file(const Bytecode *bc, const char *path); /* 1 on success */
+Bytecode *bytecode_load_file(const char *path);               /* NULL on error */
+int bytecode_file_is_compiled(const char *path);              /* checks magic */
+
 #endif
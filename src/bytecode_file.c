@@ -0,0 +1,836 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file bytecode_file.c
+ * @brief On-disk format for compiled Bytecode (.func files): writer and loader.
+ *
+ * A .func file stores a module and all nested function bytecodes reachable
+ * through VAL_FUNCTION constants, so a script can be executed without running
+ * the include preprocessor or the parser again.
+ *
+ * Layout (integers in writer byte order, guarded by an endianness tag):
+ *
+ *   FuncFileHeader                  fixed 64 bytes
+ *   FuncSection[section_count]      directory: kind, count, offset, size
+ *   section payloads                each one starts 8-byte aligned
+ *
+ * Sections:
+ * - FUNC_SECTION_STRINGS:   NUL-terminated strings referenced by byte offset
+ *                           (names, source paths, string constants).
+ * - FUNC_SECTION_CHUNKS:    FuncChunkRecord per function; chunk 0 is the entry.
+ * - FUNC_SECTION_CODE:      Instruction records of all chunks back to back.
+ *                           The record layout equals the in-memory Instruction,
+ *                           so each chunk's code is loaded with one memcpy.
+ * - FUNC_SECTION_CONSTANTS: FuncConstRecord per constant of all chunks.
+ * - FUNC_SECTION_LINEMAPS:  FuncLineSpan per include line map span (optional).
+ *
+ * Source line information travels in-band as OP_LINE instructions; the
+ * include line maps translating those lines back to the original files are
+ * stored alongside so diagnostics of loaded modules stay accurate. The loader
+ * maps the file read-only and performs only two kinds of fixups: string
+ * offsets become owned C strings, and function constants (stored as chunk
+ * indices) become Bytecode pointers. Unknown section kinds are skipped so
+ * newer writers can add optional metadata without breaking older loaders.
+ */
+
+#ifndef _WIN32
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+#endif
+
+#include "bytecode.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifndef FUN_VERSION
+#define FUN_VERSION "0.0.0-dev"
+#endif
+
+#define FUNC_FORMAT_VERSION 1
+#define FUNC_ENDIAN_TAG 0x01020304u
+#define FUNC_NO_STRING 0xFFFFFFFFu
+
+enum {
+  FUNC_SECTION_STRINGS = 1,
+  FUNC_SECTION_CHUNKS = 2,
+  FUNC_SECTION_CODE = 3,
+  FUNC_SECTION_CONSTANTS = 4,
+  FUNC_SECTION_LINEMAPS = 5
+};
+
+/* Stable constant tags; deliberately independent of the ValueType enum. */
+enum {
+  FUNC_CONST_NIL = 0,
+  FUNC_CONST_INT = 1,
+  FUNC_CONST_FLOAT = 2,
+  FUNC_CONST_BOOL = 3,
+  FUNC_CONST_STRING = 4,
+  FUNC_CONST_FUNCTION = 5
+};
+
+typedef struct {
+  char magic[4];          /* FUNC_FILE_MAGIC */
+  uint32_t version;       /* FUNC_FORMAT_VERSION */
+  uint32_t endian_tag;    /* FUNC_ENDIAN_TAG as written by the producer */
+  uint32_t opcode_count;  /* OPCODE_COUNT of the producer (opcode numbering guard) */
+  uint32_t section_count; /* entries in the section directory */
+  uint32_t chunk_count;   /* number of function chunks */
+  uint32_t producer;      /* string offset of the producing FUN_VERSION */
+  uint32_t reserved[9];
+} FuncFileHeader;
+
+typedef struct {
+  uint32_t kind;
+  uint32_t count;  /* number of records (or bytes for STRINGS) */
+  uint64_t offset; /* from start of file */
+  uint64_t size;   /* in bytes */
+} FuncSection;
+
+typedef struct {
+  uint32_t name;        /* string offset or FUNC_NO_STRING */
+  uint32_t source_file; /* string offset or FUNC_NO_STRING */
+  uint32_t instr_first; /* first record in FUNC_SECTION_CODE */
+  uint32_t instr_count;
+  uint32_t const_first; /* first record in FUNC_SECTION_CONSTANTS */
+  uint32_t const_count;
+  uint32_t line_map; /* 1-based index of the chunk's line map, 0 = none */
+  uint32_t reserved;
+} FuncChunkRecord;
+
+typedef struct {
+  uint32_t type; /* FUNC_CONST_* */
+  uint32_t aux;  /* reserved, 0 */
+  uint64_t bits; /* int/float bits, bool, string offset or chunk index */
+} FuncConstRecord;
+
+typedef struct {
+  uint32_t map;        /* 0-based line map index; spans are grouped by map */
+  int32_t first_line;  /* LineMapSpan.first_line */
+  int32_t base_line;   /* LineMapSpan.base_line */
+  uint32_t file;       /* string offset of the original file path */
+} FuncLineSpan;
+
+/* C99 compile-time layout checks: the loader relies on these sizes. */
+typedef char func_header_size_check[(sizeof(FuncFileHeader) == 64) ? 1 : -1];
+typedef char func_section_size_check[(sizeof(FuncSection) == 24) ? 1 : -1];
+typedef char func_chunk_size_check[(sizeof(FuncChunkRecord) == 32) ? 1 : -1];
+typedef char func_const_size_check[(sizeof(FuncConstRecord) == 16) ? 1 : -1];
+typedef char func_span_size_check[(sizeof(FuncLineSpan) == 16) ? 1 : -1];
+typedef char func_instr_size_check[(sizeof(Instruction) == 8) ? 1 : -1];
+
+/* ---------------------------------------------------------------------------
+ * Writer
+ * ------------------------------------------------------------------------- */
+
+/* Growable byte buffer used for section payloads. */
+typedef struct {
+  unsigned char *data;
+  size_t len;
+  size_t cap;
+} FuncBuf;
+
+/**
+ * @brief Append n bytes to a FuncBuf, growing it geometrically.
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int fbuf_append(FuncBuf *b, const void *p, size_t n) {
+  if (b->len + n > b->cap) {
+    size_t ncap = b->cap ? b->cap : 256;
+    while (ncap < b->len + n)
+      ncap *= 2;
+    unsigned char *nd = (unsigned char *)realloc(b->data, ncap);
+    if (!nd) return 0;
+    b->data = nd;
+    b->cap = ncap;
+  }
+  if (n) memcpy(b->data + b->len, p, n);
+  b->len += n;
+  return 1;
+}
+
+/* String table with an open-addressing index so repeated names/literals are stored once. */
+typedef struct {
+  FuncBuf bytes;
+  uint32_t *slots; /* offset + 1, 0 = empty */
+  size_t slot_cap;
+  size_t used;
+} FuncStrtab;
+
+/** @brief FNV-1a hash over a NUL-terminated string. */
+static uint32_t func_hash_str(const char *s) {
+  uint32_t h = 2166136261u;
+  while (*s) {
+    h ^= (unsigned char)*s++;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+/**
+ * @brief Grow and rehash the string table index.
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int strtab_grow(FuncStrtab *t) {
+  size_t ncap = t->slot_cap ? t->slot_cap * 2 : 256;
+  uint32_t *ns = (uint32_t *)calloc(ncap, sizeof(uint32_t));
+  if (!ns) return 0;
+  for (size_t i = 0; i < t->slot_cap; ++i) {
+    if (!t->slots[i]) continue;
+    const char *s = (const char *)t->bytes.data + (t->slots[i] - 1);
+    size_t j = func_hash_str(s) & (ncap - 1);
+    while (ns[j])
+      j = (j + 1) & (ncap - 1);
+    ns[j] = t->slots[i];
+  }
+  free(t->slots);
+  t->slots = ns;
+  t->slot_cap = ncap;
+  return 1;
+}
+
+/**
+ * @brief Intern a string into the table.
+ * @param t String table.
+ * @param s String to store (NULL maps to FUNC_NO_STRING).
+ * @param out Receives the byte offset of the string.
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int strtab_intern(FuncStrtab *t, const char *s, uint32_t *out) {
+  if (!s) {
+    *out = FUNC_NO_STRING;
+    return 1;
+  }
+  if ((t->used + 1) * 2 > t->slot_cap && !strtab_grow(t)) return 0;
+  size_t j = func_hash_str(s) & (t->slot_cap - 1);
+  while (t->slots[j]) {
+    const char *cand = (const char *)t->bytes.data + (t->slots[j] - 1);
+    if (strcmp(cand, s) == 0) {
+      *out = t->slots[j] - 1;
+      return 1;
+    }
+    j = (j + 1) & (t->slot_cap - 1);
+  }
+  size_t off = t->bytes.len;
+  if (off >= FUNC_NO_STRING - 1) return 0;
+  if (!fbuf_append(&t->bytes, s, strlen(s) + 1)) return 0;
+  t->slots[j] = (uint32_t)off + 1;
+  t->used++;
+  *out = (uint32_t)off;
+  return 1;
+}
+
+/* Ordered set of reachable chunks (entry first). */
+typedef struct {
+  const Bytecode **items;
+  int count;
+  int cap;
+} FuncChunkList;
+
+/** @brief Return the index of bc in the chunk list, or -1. */
+static int chunk_list_find(const FuncChunkList *l, const Bytecode *bc) {
+  for (int i = 0; i < l->count; ++i) {
+    if (l->items[i] == bc) return i;
+  }
+  return -1;
+}
+
+/**
+ * @brief Collect bc and every function bytecode reachable from its constants.
+ *
+ * Uses an explicit worklist (the list itself) instead of recursion so deeply
+ * nested closures cannot exhaust the C stack.
+ *
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int chunk_list_collect(FuncChunkList *l, const Bytecode *entry) {
+  l->cap = 16;
+  l->items = (const Bytecode **)malloc(sizeof(*l->items) * (size_t)l->cap);
+  if (!l->items) return 0;
+  l->items[l->count++] = entry;
+  for (int i = 0; i < l->count; ++i) {
+    const Bytecode *bc = l->items[i];
+    for (int k = 0; k < bc->const_count; ++k) {
+      const Value *c = &bc->constants[k];
+      if (c->type != VAL_FUNCTION || !c->fn) continue;
+      if (chunk_list_find(l, c->fn) >= 0) continue;
+      if (l->count == l->cap) {
+        int ncap = l->cap * 2;
+        const Bytecode **ni = (const Bytecode **)realloc(l->items, sizeof(*l->items) * (size_t)ncap);
+        if (!ni) return 0;
+        l->items = ni;
+        l->cap = ncap;
+      }
+      l->items[l->count++] = c->fn;
+    }
+  }
+  return 1;
+}
+
+/** @brief Pad a file offset up to the next multiple of 8. */
+static uint64_t func_align8(uint64_t v) {
+  return (v + 7u) & ~(uint64_t)7u;
+}
+
+/**
+ * @brief Serialize a module bytecode (and all nested functions) to a .func file.
+ *
+ * @param bc   Entry bytecode as returned by parse_file_to_bytecode().
+ * @param path Destination path; an existing file is replaced.
+ * @return 1 on success, 0 on error (a message is printed to stderr).
+ */
+int bytecode_save_file(const Bytecode *bc, const char *path) {
+  if (!bc || !path) return 0;
+
+  int ok = 0;
+  FILE *out = NULL;
+  FuncChunkList chunks = {NULL, 0, 0};
+  FuncStrtab strs = {{NULL, 0, 0}, NULL, 0, 0};
+  FuncBuf recs = {NULL, 0, 0};
+  FuncBuf code = {NULL, 0, 0};
+  FuncBuf consts = {NULL, 0, 0};
+  FuncBuf spans = {NULL, 0, 0};
+  const LineMap **maps = NULL;
+  uint32_t map_count = 0, span_total = 0;
+  uint32_t instr_total = 0, const_total = 0;
+  uint32_t producer = FUNC_NO_STRING;
+
+  if (!chunk_list_collect(&chunks, bc)) goto oom;
+  if (!strtab_intern(&strs, FUN_VERSION, &producer)) goto oom;
+
+  for (int i = 0; i < chunks.count; ++i) {
+    const Bytecode *c = chunks.items[i];
+    FuncChunkRecord r;
+    memset(&r, 0, sizeof(r));
+    if (!strtab_intern(&strs, c->name, &r.name)) goto oom;
+    if (!strtab_intern(&strs, c->source_file, &r.source_file)) goto oom;
+    r.instr_first = instr_total;
+    r.instr_count = (uint32_t)c->instr_count;
+    r.const_first = const_total;
+    r.const_count = (uint32_t)c->const_count;
+
+    if (c->line_map) {
+      uint32_t m = 0;
+      while (m < map_count && maps[m] != c->line_map)
+        m++;
+      if (m == map_count) {
+        const LineMap **nm = (const LineMap **)realloc(maps, sizeof(*maps) * (map_count + 1));
+        if (!nm) goto oom;
+        maps = nm;
+        maps[map_count++] = c->line_map;
+        const LineMap *lm = c->line_map;
+        for (int k = 0; k < lm->span_count; ++k) {
+          FuncLineSpan ls;
+          ls.map = m;
+          ls.first_line = lm->spans[k].first_line;
+          ls.base_line = lm->spans[k].base_line;
+          if (!strtab_intern(&strs, lm->files[lm->spans[k].file], &ls.file)) goto oom;
+          if (!fbuf_append(&spans, &ls, sizeof(ls))) goto oom;
+          span_total++;
+        }
+      }
+      r.line_map = m + 1;
+    }
+
+    if (c->instr_count > 0 && !fbuf_append(&code, c->instructions, sizeof(Instruction) * (size_t)c->instr_count)) goto oom;
+    instr_total += (uint32_t)c->instr_count;
+
+    for (int k = 0; k < c->const_count; ++k) {
+      const Value *v = &c->constants[k];
+      FuncConstRecord cr;
+      memset(&cr, 0, sizeof(cr));
+      switch (v->type) {
+      case VAL_NIL:
+        cr.type = FUNC_CONST_NIL;
+        break;
+      case VAL_INT:
+        cr.type = FUNC_CONST_INT;
+        memcpy(&cr.bits, &v->i, sizeof(cr.bits));
+        break;
+      case VAL_FLOAT:
+        cr.type = FUNC_CONST_FLOAT;
+        memcpy(&cr.bits, &v->d, sizeof(cr.bits));
+        break;
+      case VAL_BOOL:
+        cr.type = FUNC_CONST_BOOL;
+        cr.bits = v->i ? 1u : 0u;
+        break;
+      case VAL_STRING: {
+        uint32_t so;
+        if (!strtab_intern(&strs, v->s ? v->s : "", &so)) goto oom;
+        cr.type = FUNC_CONST_STRING;
+        cr.bits = so;
+        break;
+      }
+      case VAL_FUNCTION:
+        cr.type = FUNC_CONST_FUNCTION;
+        cr.bits = (uint64_t)chunk_list_find(&chunks, v->fn);
+        break;
+      default:
+        fprintf(stderr, "Error: cannot serialize constant of type %d in %s\n",
+                (int)v->type, c->name ? c->name : "<anon>");
+        goto done;
+      }
+      if (!fbuf_append(&consts, &cr, sizeof(cr))) goto oom;
+    }
+    const_total += (uint32_t)c->const_count;
+    if (!fbuf_append(&recs, &r, sizeof(r))) goto oom;
+  }
+
+  {
+    enum { NSECT = 5 };
+    FuncSection dir[NSECT];
+    const FuncBuf *payload[NSECT] = {&strs.bytes, &recs, &code, &consts, &spans};
+    uint32_t kinds[NSECT] = {FUNC_SECTION_STRINGS, FUNC_SECTION_CHUNKS, FUNC_SECTION_CODE, FUNC_SECTION_CONSTANTS,
+                             FUNC_SECTION_LINEMAPS};
+    uint32_t counts[NSECT] = {(uint32_t)strs.bytes.len, (uint32_t)chunks.count, instr_total, const_total, span_total};
+
+    uint64_t off = func_align8(sizeof(FuncFileHeader) + sizeof(dir));
+    for (int s = 0; s < NSECT; ++s) {
+      dir[s].kind = kinds[s];
+      dir[s].count = counts[s];
+      dir[s].offset = off;
+      dir[s].size = payload[s]->len;
+      off = func_align8(off + payload[s]->len);
+    }
+
+    FuncFileHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, FUNC_FILE_MAGIC, 4);
+    h.version = FUNC_FORMAT_VERSION;
+    h.endian_tag = FUNC_ENDIAN_TAG;
+    h.opcode_count = OPCODE_COUNT;
+    h.section_count = NSECT;
+    h.chunk_count = (uint32_t)chunks.count;
+    h.producer = producer;
+
+    out = fopen(path, "wb");
+    if (!out) {
+      fprintf(stderr, "Error: cannot write compiled bytecode: %s\n", path);
+      goto done;
+    }
+    static const unsigned char zeros[8] = {0};
+    uint64_t pos = 0;
+    if (fwrite(&h, sizeof(h), 1, out) != 1) goto io_error;
+    if (fwrite(dir, sizeof(dir), 1, out) != 1) goto io_error;
+    pos = sizeof(h) + sizeof(dir);
+    for (int s = 0; s < NSECT; ++s) {
+      size_t pad = (size_t)(dir[s].offset - pos);
+      if (pad && fwrite(zeros, 1, pad, out) != pad) goto io_error;
+      if (payload[s]->len && fwrite(payload[s]->data, 1, payload[s]->len, out) != payload[s]->len) goto io_error;
+      pos = dir[s].offset + payload[s]->len;
+    }
+    if (fclose(out) != 0) {
+      out = NULL;
+      goto io_error;
+    }
+    out = NULL;
+    ok = 1;
+    goto done;
+  }
+
+io_error:
+  fprintf(stderr, "Error: failed writing compiled bytecode: %s\n", path);
+  goto done;
+oom:
+  fprintf(stderr, "Error: out of memory while serializing bytecode\n");
+done:
+  if (out) fclose(out);
+  free(chunks.items);
+  free(strs.bytes.data);
+  free(strs.slots);
+  free(recs.data);
+  free(code.data);
+  free(consts.data);
+  free(spans.data);
+  free(maps);
+  return ok;
+}
+
+/* ---------------------------------------------------------------------------
+ * Loader
+ * ------------------------------------------------------------------------- */
+
+/* A read-only view of the whole file: mmap'ed where available, else read into memory. */
+typedef struct {
+  const unsigned char *data;
+  size_t size;
+  int mapped;
+} FuncImage;
+
+/**
+ * @brief Map (or read) a file into memory for loading.
+ * @return 1 on success, 0 on I/O error.
+ */
+static int func_image_open(FuncImage *img, const char *path) {
+  img->data = NULL;
+  img->size = 0;
+  img->mapped = 0;
+#ifndef _WIN32
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return 0;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    close(fd);
+    return 0;
+  }
+  void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) return 0;
+  img->data = (const unsigned char *)p;
+  img->size = (size_t)st.st_size;
+  img->mapped = 1;
+  return 1;
+#else
+  FILE *f = fopen(path, "rb");
+  if (!f) return 0;
+  if (fseek(f, 0, SEEK_END) != 0) {
+    fclose(f);
+    return 0;
+  }
+  long sz = ftell(f);
+  if (sz <= 0 || fseek(f, 0, SEEK_SET) != 0) {
+    fclose(f);
+    return 0;
+  }
+  unsigned char *buf = (unsigned char *)malloc((size_t)sz);
+  if (!buf || fread(buf, 1, (size_t)sz, f) != (size_t)sz) {
+    free(buf);
+    fclose(f);
+    return 0;
+  }
+  fclose(f);
+  img->data = buf;
+  img->size = (size_t)sz;
+  return 1;
+#endif
+}
+
+/** @brief Release a FuncImage obtained from func_image_open(). */
+static void func_image_close(FuncImage *img) {
+  if (!img->data) return;
+#ifndef _WIN32
+  if (img->mapped) {
+    munmap((void *)img->data, img->size);
+    img->data = NULL;
+    return;
+  }
+#endif
+  free((void *)img->data);
+  img->data = NULL;
+}
+
+/**
+ * @brief Check whether a file starts with the .func magic.
+ *
+ * @param path File to inspect.
+ * @return 1 if the file looks like compiled bytecode, 0 otherwise.
+ */
+int bytecode_file_is_compiled(const char *path) {
+  if (!path) return 0;
+  FILE *f = fopen(path, "rb");
+  if (!f) return 0;
+  char magic[4];
+  size_t n = fread(magic, 1, sizeof(magic), f);
+  fclose(f);
+  return n == sizeof(magic) && memcmp(magic, FUNC_FILE_MAGIC, 4) == 0;
+}
+
+/**
+ * @brief Resolve a string offset inside the string section.
+ * @return Pointer into the image, or NULL if the offset is invalid or unterminated.
+ */
+static const char *func_string_at(const FuncSection *strsec, const FuncImage *img, uint32_t off) {
+  if (off == FUNC_NO_STRING || !strsec || off >= strsec->size) return NULL;
+  const char *base = (const char *)img->data + strsec->offset;
+  if (!memchr(base + off, '\0', (size_t)(strsec->size - off))) return NULL;
+  return base + off;
+}
+
+/**
+ * @brief Load a .func file produced by bytecode_save_file().
+ *
+ * Validates the header (magic, format version, endianness, opcode numbering),
+ * bounds-checks every section and record, and rebuilds the Bytecode graph.
+ *
+ * @param path Path to the compiled file.
+ * @return Entry Bytecode on success (free with bytecode_free()), or NULL on
+ *         error (a message is printed to stderr).
+ */
+Bytecode *bytecode_load_file(const char *path) {
+  FuncImage img;
+  if (!func_image_open(&img, path)) {
+    fprintf(stderr, "Error: cannot read compiled bytecode: %s\n", path);
+    return NULL;
+  }
+
+  Bytecode **bcs = NULL;
+  uint32_t nchunks = 0;
+  LineMap **maps = NULL;
+  uint32_t nmaps = 0;
+  const char *why = NULL;
+
+  if (img.size < sizeof(FuncFileHeader)) {
+    why = "file too small";
+    goto fail;
+  }
+  FuncFileHeader h;
+  memcpy(&h, img.data, sizeof(h));
+  if (memcmp(h.magic, FUNC_FILE_MAGIC, 4) != 0) {
+    why = "bad magic";
+    goto fail;
+  }
+  if (h.endian_tag != FUNC_ENDIAN_TAG) {
+    why = "byte order mismatch";
+    goto fail;
+  }
+  if (h.version != FUNC_FORMAT_VERSION) {
+    why = "unsupported format version (recompile the script)";
+    goto fail;
+  }
+  if (h.opcode_count != OPCODE_COUNT) {
+    why = "opcode set differs from this interpreter (recompile the script)";
+    goto fail;
+  }
+  if (h.section_count > 64 || sizeof(FuncFileHeader) + (size_t)h.section_count * sizeof(FuncSection) > img.size) {
+    why = "corrupt section directory";
+    goto fail;
+  }
+
+  const FuncSection *sec_strings = NULL, *sec_chunks = NULL, *sec_code = NULL, *sec_consts = NULL;
+  const FuncSection *sec_spans = NULL;
+  const FuncSection *dir = (const FuncSection *)(img.data + sizeof(FuncFileHeader));
+  for (uint32_t s = 0; s < h.section_count; ++s) {
+    const FuncSection *d = &dir[s];
+    if (d->offset > img.size || d->size > img.size - d->offset || (d->offset & 7u)) {
+      why = "section out of bounds";
+      goto fail;
+    }
+    switch (d->kind) {
+    case FUNC_SECTION_STRINGS:
+      sec_strings = d;
+      break;
+    case FUNC_SECTION_CHUNKS:
+      sec_chunks = d;
+      break;
+    case FUNC_SECTION_CODE:
+      sec_code = d;
+      break;
+    case FUNC_SECTION_CONSTANTS:
+      sec_consts = d;
+      break;
+    case FUNC_SECTION_LINEMAPS:
+      sec_spans = d;
+      break;
+    default:
+      break; /* optional/unknown section: ignore */
+    }
+  }
+  if (!sec_strings || !sec_chunks || !sec_code || !sec_consts) {
+    why = "missing section";
+    goto fail;
+  }
+  nchunks = h.chunk_count;
+  if (nchunks == 0 || sec_chunks->count != nchunks ||
+      sec_chunks->size != (uint64_t)nchunks * sizeof(FuncChunkRecord) ||
+      sec_code->size != (uint64_t)sec_code->count * sizeof(Instruction) ||
+      sec_consts->size != (uint64_t)sec_consts->count * sizeof(FuncConstRecord)) {
+    why = "section size mismatch";
+    goto fail;
+  }
+
+  const FuncChunkRecord *recs = (const FuncChunkRecord *)(img.data + sec_chunks->offset);
+  const Instruction *code = (const Instruction *)(img.data + sec_code->offset);
+  const FuncConstRecord *crec = (const FuncConstRecord *)(img.data + sec_consts->offset);
+
+  /* Rebuild line maps; spans arrive grouped by map index in ascending order. */
+  if (sec_spans && sec_spans->count > 0) {
+    if (sec_spans->size != (uint64_t)sec_spans->count * sizeof(FuncLineSpan)) {
+      why = "section size mismatch";
+      goto fail;
+    }
+    const FuncLineSpan *sp = (const FuncLineSpan *)(img.data + sec_spans->offset);
+    nmaps = sp[sec_spans->count - 1].map + 1;
+    if (nmaps > sec_spans->count) {
+      why = "bad line map";
+      goto fail;
+    }
+    maps = (LineMap **)calloc(nmaps, sizeof(LineMap *));
+    if (!maps) {
+      why = "out of memory";
+      goto fail;
+    }
+    for (uint32_t k = 0; k < sec_spans->count; ++k) {
+      const char *file = func_string_at(sec_strings, &img, sp[k].file);
+      if (sp[k].map >= nmaps || !file) {
+        why = "bad line map";
+        goto fail;
+      }
+      if (!maps[sp[k].map] && !(maps[sp[k].map] = line_map_new())) {
+        why = "out of memory";
+        goto fail;
+      }
+      if (!line_map_add_span(maps[sp[k].map], file, sp[k].first_line, sp[k].base_line)) {
+        why = "bad line map";
+        goto fail;
+      }
+    }
+  }
+
+  /* First pass: allocate every chunk so function constants can point forward. */
+  bcs = (Bytecode **)calloc(nchunks, sizeof(Bytecode *));
+  if (!bcs) {
+    why = "out of memory";
+    goto fail;
+  }
+  for (uint32_t i = 0; i < nchunks; ++i) {
+    bcs[i] = bytecode_new();
+    if (!bcs[i]) {
+      why = "out of memory";
+      goto fail;
+    }
+  }
+
+  /* Second pass: fill code, constants and metadata. */
+  for (uint32_t i = 0; i < nchunks; ++i) {
+    const FuncChunkRecord *r = &recs[i];
+    Bytecode *bc = bcs[i];
+    if ((uint64_t)r->instr_first + r->instr_count > sec_code->count ||
+        (uint64_t)r->const_first + r->const_count > sec_consts->count) {
+      why = "chunk record out of bounds";
+      goto fail;
+    }
+
+    const char *nm = func_string_at(sec_strings, &img, r->name);
+    const char *sf = func_string_at(sec_strings, &img, r->source_file);
+    if ((r->name != FUNC_NO_STRING && !nm) || (r->source_file != FUNC_NO_STRING && !sf)) {
+      why = "bad string reference";
+      goto fail;
+    }
+    if (nm) bc->name = strdup(nm);
+    if (sf) bc->source_file = strdup(sf);
+    if (r->line_map) {
+      if (r->line_map > nmaps || !maps[r->line_map - 1]) {
+        why = "bad line map reference";
+        goto fail;
+      }
+      bc->line_map = maps[r->line_map - 1];
+      line_map_retain(bc->line_map);
+    }
+
+    if (r->instr_count > 0) {
+      const Instruction *src = code + r->instr_first;
+      for (uint32_t k = 0; k < r->instr_count; ++k) {
+        if ((int)src[k].op < 0 || (int)src[k].op >= OPCODE_COUNT) {
+          why = "invalid opcode";
+          goto fail;
+        }
+        if (src[k].op == OP_LOAD_LOCAL || src[k].op == OP_STORE_LOCAL) {
+          if (src[k].operand < 0) {
+            why = "invalid local slot";
+            goto fail;
+          }
+          if (src[k].operand >= bc->nlocals) bc->nlocals = src[k].operand + 1;
+        }
+      }
+      bc->instructions = (Instruction *)malloc(sizeof(Instruction) * r->instr_count);
+      if (!bc->instructions) {
+        why = "out of memory";
+        goto fail;
+      }
+      memcpy(bc->instructions, src, sizeof(Instruction) * r->instr_count);
+      bc->instr_count = (int)r->instr_count;
+      bc->instr_cap = (int)r->instr_count;
+    }
+
+    if (r->const_count > 0) {
+      bc->constants = (Value *)malloc(sizeof(Value) * r->const_count);
+      if (!bc->constants) {
+        why = "out of memory";
+        goto fail;
+      }
+      bc->const_cap = (int)r->const_count;
+      for (uint32_t k = 0; k < r->const_count; ++k) {
+        const FuncConstRecord *c = &crec[r->const_first + k];
+        Value v = make_nil();
+        switch (c->type) {
+        case FUNC_CONST_NIL:
+          break;
+        case FUNC_CONST_INT: {
+          int64_t iv;
+          memcpy(&iv, &c->bits, sizeof(iv));
+          v = make_int(iv);
+          break;
+        }
+        case FUNC_CONST_FLOAT: {
+          double dv;
+          memcpy(&dv, &c->bits, sizeof(dv));
+          v = make_float(dv);
+          break;
+        }
+        case FUNC_CONST_BOOL:
+          v = make_bool(c->bits != 0);
+          break;
+        case FUNC_CONST_STRING: {
+          const char *s = (c->bits <= 0xFFFFFFFFu) ? func_string_at(sec_strings, &img, (uint32_t)c->bits) : NULL;
+          if (!s) {
+            why = "bad string constant";
+            goto fail;
+          }
+          v = make_string(s);
+          break;
+        }
+        case FUNC_CONST_FUNCTION:
+          if (c->bits >= nchunks) {
+            why = "bad function reference";
+            goto fail;
+          }
+          v = make_function(bcs[c->bits]);
+          break;
+        default:
+          why = "unknown constant type";
+          goto fail;
+        }
+        bc->constants[bc->const_count++] = v;
+      }
+    }
+  }
+
+  func_image_close(&img);
+  for (uint32_t m = 0; m < nmaps; ++m)
+    line_map_release(maps[m]);
+  free(maps);
+  Bytecode *entry = bcs[0];
+  free(bcs);
+  return entry;
+
+fail:
+  fprintf(stderr, "Error: invalid compiled bytecode %s: %s\n", path, why ? why : "unknown error");
+  if (bcs) {
+    for (uint32_t i = 0; i < nchunks; ++i)
+      bytecode_free(bcs[i]);
+    free(bcs);
+  }
+  if (maps) {
+    for (uint32_t m = 0; m < nmaps; ++m)
+      line_map_release(maps[m]);
+    free(maps);
+  }
+  func_image_close(&img);
+  return NULL;
+}
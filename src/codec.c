@@ -0,0 +1,518 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file codec.c
+ * @brief Native base64, hex and percent-encoding (see codec.h).
+ *
+ * Every format has a portable table-driven loop that also handles the
+ * stream state (partial base64 groups, a dangling hex digit, a % sequence
+ * split across two updates). The x86 kernels only process the bulk in
+ * between, compiled with per-function target attributes and selected at
+ * runtime with cpuid:
+ * - base64: SSSE3, 12 bytes <-> 16 characters per step (pshufb lookups,
+ *   after W. Mula and D. Lemire); the decoder validates each block and
+ *   leaves whitespace, padding and invalid characters to the portable loop
+ * - hex: SSSE3, 16 bytes <-> 32 digits per step
+ * - url/form: SSE2 scan that copies runs of bytes needing no escape
+ */
+
+#include "codec.h"
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef __unix__
+#include <pthread.h>
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define FUN_CODEC_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+static const char fun_b64_std[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const char fun_b64_url[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+static const char fun_hex_lower[] = "0123456789abcdef";
+static const char fun_hex_upper[] = "0123456789ABCDEF";
+
+#define FUN_B64_PAD 0x40   /* '=' in fun_b64_dtab */
+#define FUN_B64_SPACE 0x41 /* space, tab, CR, LF */
+#define FUN_B64_BAD 0xff
+
+static unsigned char fun_b64_dtab[256]; /* sextet of either alphabet, or one of the markers above */
+static signed char fun_hex_dtab[256];   /* nibble value, -1 for non-hex */
+static unsigned char fun_url_safe[256]; /* 1 for A-Z a-z 0-9 - . _ ~ */
+
+static void fun_codec_tables(void) {
+  memset(fun_b64_dtab, FUN_B64_BAD, sizeof(fun_b64_dtab));
+  for (int i = 0; i < 64; ++i) {
+    fun_b64_dtab[(unsigned char)fun_b64_std[i]] = (unsigned char)i;
+    fun_b64_dtab[(unsigned char)fun_b64_url[i]] = (unsigned char)i;
+  }
+  fun_b64_dtab['='] = FUN_B64_PAD;
+  fun_b64_dtab[' '] = fun_b64_dtab['\t'] = fun_b64_dtab['\r'] = fun_b64_dtab['\n'] = FUN_B64_SPACE;
+  memset(fun_hex_dtab, -1, sizeof(fun_hex_dtab));
+  for (int i = 0; i < 16; ++i) {
+    fun_hex_dtab[(unsigned char)fun_hex_lower[i]] = (signed char)i;
+    fun_hex_dtab[(unsigned char)fun_hex_upper[i]] = (signed char)i;
+  }
+  for (int ch = 0; ch < 256; ++ch)
+    fun_url_safe[ch] = (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') || (ch >= '0' && ch <= '9') || ch == '-' || ch == '.' || ch == '_' ||
+                       ch == '~';
+}
+
+/* ---------- x86 bulk kernels ---------- */
+
+#ifdef FUN_CODEC_X86
+/* Encode 12-byte steps while 16 input bytes are readable; returns the bytes consumed (16 characters out per 12). */
+__attribute__((target("ssse3"))) static size_t fun_b64_enc_ssse3(const unsigned char *in, size_t n, unsigned char *out, int url) {
+  const __m128i shuf = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+  const __m128i shift_lut = url ? _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                '0' - 52, '-' - 62, '_' - 63, 'A', 0, 0)
+                                : _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+  size_t i = 0;
+  for (; n - i >= 16; i += 12, out += 16) {
+    __m128i v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(in + i)), shuf);
+    /* spread the four 6-bit fields of each 3-byte group into its four bytes */
+    __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+    __m128i t1 = _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+    __m128i idx = _mm_or_si128(t0, t1);
+    /* 0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12: offset to add */
+    __m128i sel = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+    sel = _mm_or_si128(sel, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), idx), _mm_set1_epi8(13)));
+    _mm_storeu_si128((__m128i *)out, _mm_add_epi8(idx, _mm_shuffle_epi8(shift_lut, sel)));
+  }
+  return i;
+}
+
+/* Decode 16-character steps (either alphabet, no padding or whitespace); stops before the first
+ * block with anything else. Stores 16 bytes per 12 decoded. Returns the characters consumed. */
+__attribute__((target("ssse3"))) static size_t fun_b64_dec_ssse3(const unsigned char *in, size_t n, unsigned char *out) {
+  const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+  const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i mask_2f = _mm_set1_epi8(0x2f);
+  const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+  size_t i = 0;
+  for (; n - i >= 16; i += 16, out += 12) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+    /* base64url: '-' -> '+', '_' -> '/' */
+    __m128i fix = _mm_or_si128(_mm_and_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('-')), _mm_set1_epi8('+' - '-')),
+                               _mm_and_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('_')), _mm_set1_epi8('/' - '_')));
+    v = _mm_add_epi8(v, fix);
+    __m128i hi_nib = _mm_and_si128(_mm_srli_epi32(v, 4), mask_2f);
+    __m128i lo_nib = _mm_and_si128(v, mask_2f);
+    __m128i bad = _mm_and_si128(_mm_shuffle_epi8(lut_lo, lo_nib), _mm_shuffle_epi8(lut_hi, hi_nib));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(bad, _mm_setzero_si128())) != 0xffff) break;
+    __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(_mm_cmpeq_epi8(v, mask_2f), hi_nib));
+    v = _mm_add_epi8(v, roll);
+    /* four sextets -> 24 bits per 32-bit lane, then gather the three bytes of each lane */
+    v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+    v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+    _mm_storeu_si128((__m128i *)out, _mm_shuffle_epi8(v, pack));
+  }
+  return i;
+}
+
+/* 16 bytes -> 32 digits per step; returns the bytes consumed. */
+__attribute__((target("ssse3"))) static size_t fun_hex_enc_ssse3(const unsigned char *in, size_t n, unsigned char *out) {
+  const __m128i lut = _mm_loadu_si128((const __m128i *)fun_hex_lower);
+  const __m128i m = _mm_set1_epi8(0x0f);
+  size_t i = 0;
+  for (; n - i >= 16; i += 16, out += 32) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+    __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), m));
+    __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(v, m));
+    _mm_storeu_si128((__m128i *)out, _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128((__m128i *)(out + 16), _mm_unpackhi_epi8(hi, lo));
+  }
+  return i;
+}
+
+/* Nibble values of 16 hex digits; *ok is 0 if any is not a hex digit. */
+__attribute__((target("ssse3"))) static inline __m128i fun_hex_nibbles(__m128i v, int *ok) {
+  __m128i d = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+  __m128i is_d = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+  __m128i a = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+  __m128i is_a = _mm_cmpeq_epi8(_mm_min_epu8(a, _mm_set1_epi8(5)), a);
+  *ok = _mm_movemask_epi8(_mm_or_si128(is_d, is_a)) == 0xffff;
+  return _mm_or_si128(_mm_and_si128(is_d, d), _mm_and_si128(is_a, _mm_add_epi8(a, _mm_set1_epi8(10))));
+}
+
+/* 32 digits -> 16 bytes per step; stops before the first block with a non-hex digit. Returns the digits consumed. */
+__attribute__((target("ssse3"))) static size_t fun_hex_dec_ssse3(const unsigned char *in, size_t n, unsigned char *out) {
+  const __m128i w = _mm_set1_epi16(0x0110); /* high digit * 16 + low digit */
+  size_t i = 0;
+  for (; n - i >= 32; i += 32, out += 16) {
+    int ok1, ok2;
+    __m128i a = fun_hex_nibbles(_mm_loadu_si128((const __m128i *)(in + i)), &ok1);
+    __m128i b = fun_hex_nibbles(_mm_loadu_si128((const __m128i *)(in + i + 16)), &ok2);
+    if (!ok1 || !ok2) break;
+    _mm_storeu_si128((__m128i *)out, _mm_packus_epi16(_mm_maddubs_epi16(a, w), _mm_maddubs_epi16(b, w)));
+  }
+  return i;
+}
+
+/* Copy the run of bytes that need no percent-encoding; returns its length. Stores whole 16-byte blocks. */
+__attribute__((target("sse2"))) static size_t fun_url_enc_sse2(const unsigned char *in, size_t n, unsigned char *out) {
+  size_t i = 0;
+  while (n - i >= 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+    __m128i a = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i d = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+    __m128i safe = _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(a, _mm_set1_epi8(25)), a), _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d));
+    safe = _mm_or_si128(safe, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('-')), _mm_cmpeq_epi8(v, _mm_set1_epi8('.'))));
+    safe = _mm_or_si128(safe, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('_')), _mm_cmpeq_epi8(v, _mm_set1_epi8('~'))));
+    unsigned m = (unsigned)_mm_movemask_epi8(safe);
+    _mm_storeu_si128((__m128i *)(out + i), v);
+    if (m != 0xffff) return i + (size_t)__builtin_ctz(~m);
+    i += 16;
+  }
+  return i;
+}
+
+/* Copy the run of bytes up to the next '%' (or '+' for form); returns its length. Stores whole 16-byte blocks. */
+__attribute__((target("sse2"))) static size_t fun_url_dec_sse2(const unsigned char *in, size_t n, unsigned char *out, int form) {
+  const __m128i plus = form ? _mm_set1_epi8('+') : _mm_set1_epi8('%');
+  size_t i = 0;
+  while (n - i >= 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+    unsigned m = (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('%')), _mm_cmpeq_epi8(v, plus)));
+    _mm_storeu_si128((__m128i *)(out + i), v);
+    if (m) return i + (size_t)__builtin_ctz(m);
+    i += 16;
+  }
+  return i;
+}
+#endif
+
+/* ---------- Kernel selection ---------- */
+
+static size_t (*fun_b64_enc_bulk)(const unsigned char *, size_t, unsigned char *, int) = NULL;
+static size_t (*fun_b64_dec_bulk)(const unsigned char *, size_t, unsigned char *) = NULL;
+static size_t (*fun_hex_enc_bulk)(const unsigned char *, size_t, unsigned char *) = NULL;
+static size_t (*fun_hex_dec_bulk)(const unsigned char *, size_t, unsigned char *) = NULL;
+static size_t (*fun_url_enc_bulk)(const unsigned char *, size_t, unsigned char *) = NULL;
+static size_t (*fun_url_dec_bulk)(const unsigned char *, size_t, unsigned char *, int) = NULL;
+static const char *fun_b64_kernel = "portable";
+static const char *fun_hexk_kernel = "portable";
+static const char *fun_url_kernel = "portable";
+
+static void fun_codec_setup_once(void) {
+  fun_codec_tables();
+  const char *env = getenv("FUN_CODEC_PORTABLE");
+  if (env && *env && strcmp(env, "0") != 0) return;
+#ifdef FUN_CODEC_X86
+  unsigned int a, b, c, d;
+  if (!__get_cpuid(1, &a, &b, &c, &d)) return;
+  if ((d >> 26) & 1) {
+    fun_url_enc_bulk = fun_url_enc_sse2;
+    fun_url_dec_bulk = fun_url_dec_sse2;
+    fun_url_kernel = "sse2";
+  }
+  if ((c >> 9) & 1) {
+    fun_b64_enc_bulk = fun_b64_enc_ssse3;
+    fun_b64_dec_bulk = fun_b64_dec_ssse3;
+    fun_hex_enc_bulk = fun_hex_enc_ssse3;
+    fun_hex_dec_bulk = fun_hex_dec_ssse3;
+    fun_b64_kernel = fun_hexk_kernel = "ssse3";
+  }
+#endif
+}
+
+#ifdef __unix__
+static pthread_once_t fun_codec_once = PTHREAD_ONCE_INIT;
+static void fun_codec_setup(void) {
+  pthread_once(&fun_codec_once, fun_codec_setup_once);
+}
+#else
+static int fun_codec_ready = 0;
+static void fun_codec_setup(void) {
+  if (!fun_codec_ready) {
+    fun_codec_setup_once();
+    fun_codec_ready = 1;
+  }
+}
+#endif
+
+const char *fun_codec_kernel(const char *what) {
+  fun_codec_setup();
+  if (strcmp(what, "base64") == 0) return fun_b64_kernel;
+  if (strcmp(what, "hex") == 0) return fun_hexk_kernel;
+  if (strcmp(what, "url") == 0) return fun_url_kernel;
+  return "portable";
+}
+
+/* ---------- base64 ---------- */
+
+/* Encode n bytes (a multiple of 3). */
+static size_t fun_b64_enc_c(const char *abc, const unsigned char *in, size_t n, unsigned char *out) {
+  size_t o = 0;
+  for (size_t i = 0; i + 3 <= n; i += 3) {
+    uint32_t v = (uint32_t)in[i] << 16 | (uint32_t)in[i + 1] << 8 | in[i + 2];
+    out[o++] = (unsigned char)abc[v >> 18];
+    out[o++] = (unsigned char)abc[(v >> 12) & 63];
+    out[o++] = (unsigned char)abc[(v >> 6) & 63];
+    out[o++] = (unsigned char)abc[v & 63];
+  }
+  return o;
+}
+
+static ptrdiff_t fun_codec_b64_encode(FunCodec *c, const unsigned char *in, size_t len, unsigned char *out) {
+  int url = c->fmt == FUN_CODEC_BASE64URL;
+  const char *abc = url ? fun_b64_url : fun_b64_std;
+  size_t i = 0, o = 0;
+  if (c->npend) {
+    while (c->npend < 3 && i < len) c->pend[c->npend++] = in[i++];
+    if (c->npend < 3) return 0;
+    o += fun_b64_enc_c(abc, c->pend, 3, out);
+    c->npend = 0;
+  }
+  if (fun_b64_enc_bulk) {
+    size_t k = fun_b64_enc_bulk(in + i, len - i, out + o, url);
+    i += k;
+    o += k / 3 * 4;
+  }
+  size_t whole = (len - i) / 3 * 3;
+  o += fun_b64_enc_c(abc, in + i, whole, out + o);
+  for (i += whole; i < len; ++i) c->pend[c->npend++] = in[i];
+  return (ptrdiff_t)o;
+}
+
+/* Bytes of a partial group of npend (2 or 3) sextets. */
+static size_t fun_b64_flush(FunCodec *c, unsigned char *out) {
+  const unsigned char *q = c->pend;
+  size_t o = 0;
+  out[o++] = (unsigned char)(q[0] << 2 | q[1] >> 4);
+  if (c->npend == 3) out[o++] = (unsigned char)((q[1] & 15) << 4 | q[2] >> 2);
+  c->npend = 0;
+  return o;
+}
+
+static ptrdiff_t fun_codec_b64_decode(FunCodec *c, const unsigned char *in, size_t len, unsigned char *out) {
+  size_t i = 0, o = 0;
+  while (i < len) {
+    if (c->npend == 0 && c->pads < 0 && fun_b64_dec_bulk && len - i >= 16) {
+      size_t k = fun_b64_dec_bulk(in + i, len - i, out + o);
+      i += k;
+      o += k / 4 * 3;
+      if (i == len) break;
+    }
+    unsigned v = fun_b64_dtab[in[i++]];
+    if (v < 64) {
+      if (c->pads >= 0) return -1; /* data after padding */
+      c->pend[c->npend++] = (unsigned char)v;
+      if (c->npend == 4) {
+        const unsigned char *q = c->pend;
+        out[o++] = (unsigned char)(q[0] << 2 | q[1] >> 4);
+        out[o++] = (unsigned char)((q[1] & 15) << 4 | q[2] >> 2);
+        out[o++] = (unsigned char)((q[2] & 3) << 6 | q[3]);
+        c->npend = 0;
+      }
+    } else if (v == FUN_B64_PAD) {
+      if (c->pads < 0) {
+        if (c->npend < 2) return -1;
+        c->pads = 3 - c->npend; /* '=' still allowed after this one */
+        o += fun_b64_flush(c, out + o);
+      } else if (c->pads == 0) {
+        return -1;
+      } else {
+        c->pads--;
+      }
+    } else if (v != FUN_B64_SPACE) {
+      return -1;
+    }
+  }
+  return (ptrdiff_t)o;
+}
+
+/* ---------- hex ---------- */
+
+static ptrdiff_t fun_codec_hex_encode(const unsigned char *in, size_t len, unsigned char *out) {
+  size_t i = fun_hex_enc_bulk ? fun_hex_enc_bulk(in, len, out) : 0, o = 2 * i;
+  for (; i < len; ++i) {
+    out[o++] = (unsigned char)fun_hex_lower[in[i] >> 4];
+    out[o++] = (unsigned char)fun_hex_lower[in[i] & 15];
+  }
+  return (ptrdiff_t)o;
+}
+
+static ptrdiff_t fun_codec_hex_decode(FunCodec *c, const unsigned char *in, size_t len, unsigned char *out) {
+  size_t i = 0, o = 0;
+  if (c->npend && len > 0) {
+    int lo = fun_hex_dtab[in[i++]];
+    if (lo < 0) return -1;
+    out[o++] = (unsigned char)(c->pend[0] << 4 | lo);
+    c->npend = 0;
+  }
+  if (fun_hex_dec_bulk) {
+    size_t k = fun_hex_dec_bulk(in + i, len - i, out + o);
+    i += k;
+    o += k / 2;
+  }
+  for (; i + 1 < len; i += 2) {
+    int hi = fun_hex_dtab[in[i]], lo = fun_hex_dtab[in[i + 1]];
+    if (hi < 0 || lo < 0) return -1;
+    out[o++] = (unsigned char)(hi << 4 | lo);
+  }
+  if (i < len) {
+    int hi = fun_hex_dtab[in[i]];
+    if (hi < 0) return -1;
+    c->pend[0] = (unsigned char)hi;
+    c->npend = 1;
+  }
+  return (ptrdiff_t)o;
+}
+
+/* ---------- percent-encoding ---------- */
+
+static ptrdiff_t fun_codec_url_encode(FunCodec *c, const unsigned char *in, size_t len, unsigned char *out) {
+  int form = c->fmt == FUN_CODEC_FORM;
+  size_t i = 0, o = 0;
+  while (i < len) {
+    if (fun_url_enc_bulk) {
+      size_t k = fun_url_enc_bulk(in + i, len - i, out + o);
+      i += k;
+      o += k;
+      if (i == len) break;
+    }
+    unsigned char ch = in[i++];
+    if (fun_url_safe[ch]) {
+      out[o++] = ch;
+    } else if (ch == ' ' && form) {
+      out[o++] = '+';
+    } else {
+      out[o++] = '%';
+      out[o++] = (unsigned char)fun_hex_upper[ch >> 4];
+      out[o++] = (unsigned char)fun_hex_upper[ch & 15];
+    }
+  }
+  return (ptrdiff_t)o;
+}
+
+static ptrdiff_t fun_codec_url_decode(FunCodec *c, const unsigned char *in, size_t len, unsigned char *out) {
+  int form = c->fmt == FUN_CODEC_FORM;
+  size_t i = 0, o = 0;
+  /* finish a % sequence split by the previous update */
+  while (c->npend && i < len) {
+    int v = fun_hex_dtab[in[i]];
+    if (c->npend == 1 && v >= 0) {
+      c->pend[1] = in[i++];
+      c->npend = 2;
+      continue;
+    }
+    if (v >= 0) {
+      out[o++] = (unsigned char)(fun_hex_dtab[c->pend[1]] << 4 | v);
+      i++;
+    } else {
+      out[o++] = '%';
+      if (c->npend == 2) out[o++] = c->pend[1];
+    }
+    c->npend = 0;
+  }
+  while (i < len) {
+    if (fun_url_dec_bulk) {
+      size_t k = fun_url_dec_bulk(in + i, len - i, out + o, form);
+      i += k;
+      o += k;
+      if (i == len) break;
+    }
+    unsigned char ch = in[i];
+    if (ch == '%') {
+      if (i + 2 < len) {
+        int hi = fun_hex_dtab[in[i + 1]], lo = fun_hex_dtab[in[i + 2]];
+        if (hi >= 0 && lo >= 0) {
+          out[o++] = (unsigned char)(hi << 4 | lo);
+          i += 3;
+          continue;
+        }
+      } else if (i + 1 == len || fun_hex_dtab[in[i + 1]] >= 0) {
+        /* may complete in the next update */
+        c->npend = (int)(len - i);
+        memcpy(c->pend, in + i, len - i);
+        break;
+      }
+      out[o++] = '%';
+      i++;
+    } else {
+      out[o++] = ch == '+' && form ? ' ' : ch;
+      i++;
+    }
+  }
+  return (ptrdiff_t)o;
+}
+
+/* ---------- Streaming API ---------- */
+
+int fun_codec_lookup(const char *name) {
+  static const char *const names[FUN_CODEC_COUNT] = {"base64", "base64url", "hex", "url", "form"};
+  for (int i = 0; i < FUN_CODEC_COUNT; ++i)
+    if (strcmp(name, names[i]) == 0) return i;
+  return -1;
+}
+
+void fun_codec_init(FunCodec *c, int fmt, int decode) {
+  fun_codec_setup();
+  memset(c, 0, sizeof(*c));
+  c->fmt = fmt;
+  c->decode = decode ? 1 : 0;
+  c->pads = -1;
+}
+
+size_t fun_codec_max_out(const FunCodec *c, size_t len) {
+  size_t n;
+  if (c->fmt == FUN_CODEC_BASE64 || c->fmt == FUN_CODEC_BASE64URL)
+    n = c->decode ? len / 4 * 3 + 3 : (len + 2) / 3 * 4 + 4;
+  else if (c->fmt == FUN_CODEC_HEX)
+    n = c->decode ? len / 2 + 1 : 2 * len;
+  else
+    n = c->decode ? len + 2 : 3 * len;
+  return n + 16; /* the bulk kernels store whole 16-byte blocks */
+}
+
+ptrdiff_t fun_codec_update(FunCodec *c, const unsigned char *in, size_t len, unsigned char *out) {
+  if (c->failed) return -1;
+  ptrdiff_t r;
+  if (c->fmt == FUN_CODEC_BASE64 || c->fmt == FUN_CODEC_BASE64URL)
+    r = c->decode ? fun_codec_b64_decode(c, in, len, out) : fun_codec_b64_encode(c, in, len, out);
+  else if (c->fmt == FUN_CODEC_HEX)
+    r = c->decode ? fun_codec_hex_decode(c, in, len, out) : fun_codec_hex_encode(in, len, out);
+  else
+    r = c->decode ? fun_codec_url_decode(c, in, len, out) : fun_codec_url_encode(c, in, len, out);
+  if (r < 0) c->failed = 1;
+  return r;
+}
+
+ptrdiff_t fun_codec_final(FunCodec *c, unsigned char *out) {
+  if (c->failed) return -1;
+  size_t o = 0;
+  if (c->fmt == FUN_CODEC_BASE64 || c->fmt == FUN_CODEC_BASE64URL) {
+    if (c->decode) {
+      if (c->npend == 1) return -1;
+      if (c->npend) o = fun_b64_flush(c, out);
+    } else if (c->npend) {
+      int url = c->fmt == FUN_CODEC_BASE64URL;
+      const char *abc = url ? fun_b64_url : fun_b64_std;
+      uint32_t v = (uint32_t)c->pend[0] << 16 | (c->npend == 2 ? (uint32_t)c->pend[1] << 8 : 0);
+      out[o++] = (unsigned char)abc[v >> 18];
+      out[o++] = (unsigned char)abc[(v >> 12) & 63];
+      if (c->npend == 2) out[o++] = (unsigned char)abc[(v >> 6) & 63];
+      while (!url && o < 4) out[o++] = '=';
+    }
+  } else if (c->fmt == FUN_CODEC_HEX) {
+    if (c->decode && c->npend) return -1;
+  } else if (c->decode && c->npend) {
+    out[o++] = '%';
+    if (c->npend == 2) out[o++] = c->pend[1];
+  }
+  c->npend = 0;
+  return (ptrdiff_t)o;
+}
@@ -0,0 +1,59 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file codec.h
+ * @brief Native base64, hex and percent-encoding (streaming, SIMD on x86).
+ *
+ * A FunCodec encodes or decodes one stream in any number of update calls
+ * followed by one final call. Formats:
+ * - base64 (RFC 4648 section 4, padded) and base64url (section 5, unpadded).
+ *   The decoder accepts both alphabets, optional padding and whitespace.
+ * - hex: lowercase digits out; either case in, no separators.
+ * - url / form: RFC 3986 percent-encoding; everything but A-Z a-z 0-9 - . _ ~
+ *   becomes %XX. form (application/x-www-form-urlencoded) writes a space as
+ *   '+' and decodes '+' as a space. Malformed % sequences decode as is.
+ * On x86 the bulk of base64 and hex uses SSSE3 and percent-encoding SSE2,
+ * chosen once per process; FUN_CODEC_PORTABLE=1 forces the portable C code.
+ */
+
+#ifndef FUN_CODEC_H
+#define FUN_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Formats of a FunCodec. */
+enum { FUN_CODEC_BASE64, FUN_CODEC_BASE64URL, FUN_CODEC_HEX, FUN_CODEC_URL, FUN_CODEC_FORM, FUN_CODEC_COUNT };
+
+/** Streaming encoder/decoder state. */
+typedef struct FunCodec {
+  int fmt;
+  int decode;
+  int failed;              /* invalid input seen (decoders) */
+  int npend;               /* bytes/chars carried to the next call */
+  unsigned char pend[4];
+  int pads;                /* base64 decode: '=' still allowed after the data ended (-1: data not ended) */
+} FunCodec;
+
+/** Format for a name ("base64", "base64url", "hex", "url", "form"); -1 if unknown. */
+int fun_codec_lookup(const char *name);
+/** Start encoding (decode 0) or decoding (decode 1). */
+void fun_codec_init(FunCodec *c, int fmt, int decode);
+/** Upper bound of the bytes one update of len bytes plus fun_codec_final write. */
+size_t fun_codec_max_out(const FunCodec *c, size_t len);
+/** Process len bytes; returns the bytes written to out, or -1 on invalid input (the codec then stays failed). */
+ptrdiff_t fun_codec_update(FunCodec *c, const unsigned char *in, size_t len, unsigned char *out);
+/** Flush what is left (base64 tail and padding, a pending % sequence); -1 if the input ended mid-unit or failed. */
+ptrdiff_t fun_codec_final(FunCodec *c, unsigned char *out);
+
+/** Kernel in use for "base64", "hex" or "url": "ssse3", "sse2" or "portable". */
+const char *fun_codec_kernel(const char *what);
+
+#endif
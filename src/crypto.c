@@ -0,0 +1,736 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file crypto.c
+ * @brief Native hash, checksum and AES-256 kernels (see crypto.h).
+ *
+ * Portable C implementations of every algorithm, plus x86 fast paths that
+ * are compiled with per-function target attributes (no -m flags needed for
+ * the rest of the build) and selected at runtime with cpuid:
+ * - SHA-1 and SHA-256: SHA extensions (sha1rnds4 / sha256rnds2)
+ * - CRC-32C: the SSE4.2 crc32 instruction (it implements only the
+ *   Castagnoli polynomial; CRC-32 uses slicing-by-8 tables everywhere)
+ * - AES-256: AES-NI, four blocks in flight
+ * MD5 and SHA-384/512 have no x86 instructions and stay portable.
+ */
+
+#include "crypto.h"
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef __unix__
+#include <pthread.h>
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define FUN_CRYPTO_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+static inline uint32_t fun_rol32(uint32_t x, int s) {
+  return (x << s) | (x >> (32 - s));
+}
+
+static inline uint32_t fun_ror32(uint32_t x, int s) {
+  return (x >> s) | (x << (32 - s));
+}
+
+static inline uint64_t fun_ror64(uint64_t x, int s) {
+  return (x >> s) | (x << (64 - s));
+}
+
+static inline uint32_t fun_load_le32(const unsigned char *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint32_t fun_load_be32(const unsigned char *p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static inline uint64_t fun_load_be64(const unsigned char *p) {
+  return ((uint64_t)fun_load_be32(p) << 32) | fun_load_be32(p + 4);
+}
+
+static inline void fun_store_le32(unsigned char *p, uint32_t v) {
+  p[0] = (unsigned char)v;
+  p[1] = (unsigned char)(v >> 8);
+  p[2] = (unsigned char)(v >> 16);
+  p[3] = (unsigned char)(v >> 24);
+}
+
+static inline void fun_store_be32(unsigned char *p, uint32_t v) {
+  p[0] = (unsigned char)(v >> 24);
+  p[1] = (unsigned char)(v >> 16);
+  p[2] = (unsigned char)(v >> 8);
+  p[3] = (unsigned char)v;
+}
+
+static inline void fun_store_be64(unsigned char *p, uint64_t v) {
+  fun_store_be32(p, (uint32_t)(v >> 32));
+  fun_store_be32(p + 4, (uint32_t)v);
+}
+
+/* ---------- MD5 (RFC 1321) ---------- */
+
+static const uint32_t fun_md5_k[64] = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+};
+
+static const unsigned char fun_md5_r[64] = {
+    7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+    5, 9,  14, 20, 5, 9,  14, 20, 5, 9,  14, 20, 5, 9,  14, 20,
+    4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+    6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21};
+
+static void fun_md5_blocks(uint32_t *h, const unsigned char *p, size_t n) {
+  uint32_t m[16];
+  for (; n > 0; --n, p += 64) {
+    for (int i = 0; i < 16; ++i)
+      m[i] = fun_load_le32(p + 4 * i);
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3];
+    for (int i = 0; i < 64; ++i) {
+      uint32_t f;
+      int g;
+      if (i < 16) {
+        f = (b & c) | (~b & d);
+        g = i;
+      } else if (i < 32) {
+        f = (d & b) | (~d & c);
+        g = (5 * i + 1) & 15;
+      } else if (i < 48) {
+        f = b ^ c ^ d;
+        g = (3 * i + 5) & 15;
+      } else {
+        f = c ^ (b | ~d);
+        g = (7 * i) & 15;
+      }
+      f += a + fun_md5_k[i] + m[g];
+      a = d;
+      d = c;
+      c = b;
+      b += fun_rol32(f, fun_md5_r[i]);
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+  }
+}
+
+/* ---------- SHA-1 and SHA-256 (FIPS 180-4) ---------- */
+
+static void fun_sha1_blocks_c(uint32_t *h, const unsigned char *p, size_t n) {
+  uint32_t w[80];
+  for (; n > 0; --n, p += 64) {
+    for (int i = 0; i < 16; ++i)
+      w[i] = fun_load_be32(p + 4 * i);
+    for (int i = 16; i < 80; ++i)
+      w[i] = fun_rol32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; ++i) {
+      uint32_t f, k;
+      if (i < 20) {
+        f = (b & c) | (~b & d);
+        k = 0x5a827999;
+      } else if (i < 40) {
+        f = b ^ c ^ d;
+        k = 0x6ed9eba1;
+      } else if (i < 60) {
+        f = (b & c) | (b & d) | (c & d);
+        k = 0x8f1bbcdc;
+      } else {
+        f = b ^ c ^ d;
+        k = 0xca62c1d6;
+      }
+      uint32_t t = fun_rol32(a, 5) + f + e + k + w[i];
+      e = d;
+      d = c;
+      c = fun_rol32(b, 30);
+      b = a;
+      a = t;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+  }
+}
+
+static const uint32_t fun_sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static const uint32_t fun_sha256_iv[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static void fun_sha256_blocks_c(uint32_t *h, const unsigned char *p, size_t n) {
+  uint32_t w[64];
+  for (; n > 0; --n, p += 64) {
+    for (int i = 0; i < 16; ++i)
+      w[i] = fun_load_be32(p + 4 * i);
+    for (int i = 16; i < 64; ++i) {
+      uint32_t s0 = fun_ror32(w[i - 15], 7) ^ fun_ror32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      uint32_t s1 = fun_ror32(w[i - 2], 17) ^ fun_ror32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+    for (int i = 0; i < 64; ++i) {
+      uint32_t t1 = hh + (fun_ror32(e, 6) ^ fun_ror32(e, 11) ^ fun_ror32(e, 25)) + ((e & f) ^ (~e & g)) + fun_sha256_k[i] + w[i];
+      uint32_t t2 = (fun_ror32(a, 2) ^ fun_ror32(a, 13) ^ fun_ror32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+      hh = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+    h[5] += f;
+    h[6] += g;
+    h[7] += hh;
+  }
+}
+
+#ifdef FUN_CRYPTO_X86
+/* SHA-1 with the SHA extensions: 20 groups of four rounds; W[g] for g >= 4
+ * is msg2(msg1(W[g-4], W[g-3]) ^ W[g-2], W[g-1]). */
+__attribute__((target("sha,sse4.1,ssse3"))) static void fun_sha1_blocks_ni(uint32_t *h, const unsigned char *p, size_t n) {
+  const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+  __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)h), 0x1b);
+  __m128i e0 = _mm_set_epi32((int)h[4], 0, 0, 0);
+  for (; n > 0; --n, p += 64) {
+    __m128i abcd_save = abcd, e_save = e0, w[4], e, prev = abcd;
+    for (int i = 0; i < 4; ++i)
+      w[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 16 * i)), mask);
+    e = _mm_add_epi32(e0, w[0]);
+#define FUN_SHA1_GROUP(g, f)                                                                                         \
+  do {                                                                                                               \
+    if ((g) > 0) e = _mm_sha1nexte_epu32(prev, w[(g) & 3]);                                                          \
+    prev = abcd;                                                                                                     \
+    abcd = _mm_sha1rnds4_epu32(abcd, e, f);                                                                          \
+    if ((g) < 16)                                                                                                    \
+      w[(g) & 3] = _mm_sha1msg2_epu32(_mm_xor_si128(_mm_sha1msg1_epu32(w[(g) & 3], w[((g) + 1) & 3]), w[((g) + 2) & 3]), \
+                                      w[((g) + 3) & 3]);                                                             \
+  } while (0)
+    FUN_SHA1_GROUP(0, 0);
+    FUN_SHA1_GROUP(1, 0);
+    FUN_SHA1_GROUP(2, 0);
+    FUN_SHA1_GROUP(3, 0);
+    FUN_SHA1_GROUP(4, 0);
+    FUN_SHA1_GROUP(5, 1);
+    FUN_SHA1_GROUP(6, 1);
+    FUN_SHA1_GROUP(7, 1);
+    FUN_SHA1_GROUP(8, 1);
+    FUN_SHA1_GROUP(9, 1);
+    FUN_SHA1_GROUP(10, 2);
+    FUN_SHA1_GROUP(11, 2);
+    FUN_SHA1_GROUP(12, 2);
+    FUN_SHA1_GROUP(13, 2);
+    FUN_SHA1_GROUP(14, 2);
+    FUN_SHA1_GROUP(15, 3);
+    FUN_SHA1_GROUP(16, 3);
+    FUN_SHA1_GROUP(17, 3);
+    FUN_SHA1_GROUP(18, 3);
+    FUN_SHA1_GROUP(19, 3);
+#undef FUN_SHA1_GROUP
+    e0 = _mm_sha1nexte_epu32(prev, e_save);
+    abcd = _mm_add_epi32(abcd, abcd_save);
+  }
+  _mm_storeu_si128((__m128i *)h, _mm_shuffle_epi32(abcd, 0x1b));
+  h[4] = (uint32_t)_mm_extract_epi32(e0, 3);
+}
+
+/* SHA-256 with the SHA extensions: 16 groups of four rounds on the ABEF/CDGH
+ * state layout; W[g] for g >= 4 is msg2(msg1(W[g-4], W[g-3]) + W[g-1..g-2 >> 4], W[g-1]). */
+__attribute__((target("sha,sse4.1,ssse3"))) static void fun_sha256_blocks_ni(uint32_t *h, const unsigned char *p, size_t n) {
+  const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+  __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)h), 0xb1);      /* CDAB */
+  __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(h + 4)), 0x1b); /* EFGH */
+  __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);                                 /* ABEF */
+  state1 = _mm_blend_epi16(state1, tmp, 0xf0);                                      /* CDGH */
+  for (; n > 0; --n, p += 64) {
+    __m128i abef_save = state0, cdgh_save = state1, w[4];
+    for (int i = 0; i < 4; ++i)
+      w[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 16 * i)), mask);
+    for (int g = 0; g < 16; ++g) {
+      __m128i msg = _mm_add_epi32(w[g & 3], _mm_loadu_si128((const __m128i *)(fun_sha256_k + 4 * g)));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0e));
+      if (g < 12) {
+        __m128i t = _mm_add_epi32(_mm_sha256msg1_epu32(w[g & 3], w[(g + 1) & 3]), _mm_alignr_epi8(w[(g + 3) & 3], w[(g + 2) & 3], 4));
+        w[g & 3] = _mm_sha256msg2_epu32(t, w[(g + 3) & 3]);
+      }
+    }
+    state0 = _mm_add_epi32(state0, abef_save);
+    state1 = _mm_add_epi32(state1, cdgh_save);
+  }
+  tmp = _mm_shuffle_epi32(state0, 0x1b);                                   /* FEBA */
+  state1 = _mm_shuffle_epi32(state1, 0xb1);                                /* DCHG */
+  _mm_storeu_si128((__m128i *)h, _mm_blend_epi16(tmp, state1, 0xf0));      /* DCBA */
+  _mm_storeu_si128((__m128i *)(h + 4), _mm_alignr_epi8(state1, tmp, 8));   /* HGFE */
+}
+#endif
+
+/* ---------- SHA-384 and SHA-512 (FIPS 180-4) ---------- */
+
+static const uint64_t fun_sha512_k[80] = {
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+    0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+    0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+    0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+    0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+    0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+    0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+    0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+    0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+    0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+    0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+    0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+    0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+    0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+static const uint64_t fun_sha512_iv[8] = {
+    0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+    0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+static const uint64_t fun_sha384_iv[8] = {
+    0xcbbb9d5dc1059ed8ULL, 0x629a292a367cd507ULL, 0x9159015a3070dd17ULL, 0x152fecd8f70e5939ULL,
+    0x67332667ffc00b31ULL, 0x8eb44a8768581511ULL, 0xdb0c2e0d64f98fa7ULL, 0x47b5481dbefa4fa4ULL
+};
+
+static void fun_sha512_blocks(uint64_t *h, const unsigned char *p, size_t n) {
+  uint64_t w[80];
+  for (; n > 0; --n, p += 128) {
+    for (int i = 0; i < 16; ++i)
+      w[i] = fun_load_be64(p + 8 * i);
+    for (int i = 16; i < 80; ++i) {
+      uint64_t s0 = fun_ror64(w[i - 15], 1) ^ fun_ror64(w[i - 15], 8) ^ (w[i - 15] >> 7);
+      uint64_t s1 = fun_ror64(w[i - 2], 19) ^ fun_ror64(w[i - 2], 61) ^ (w[i - 2] >> 6);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint64_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+    for (int i = 0; i < 80; ++i) {
+      uint64_t t1 = hh + (fun_ror64(e, 14) ^ fun_ror64(e, 18) ^ fun_ror64(e, 41)) + ((e & f) ^ (~e & g)) + fun_sha512_k[i] + w[i];
+      uint64_t t2 = (fun_ror64(a, 28) ^ fun_ror64(a, 34) ^ fun_ror64(a, 39)) + ((a & b) ^ (a & c) ^ (b & c));
+      hh = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+    h[5] += f;
+    h[6] += g;
+    h[7] += hh;
+  }
+}
+
+/* ---------- CRC-32 and CRC-32C (reflected) ---------- */
+
+static uint32_t fun_crc32_tab[8][256];  /* polynomial 0xEDB88320 */
+static uint32_t fun_crc32c_tab[8][256]; /* polynomial 0x82F63B78 (Castagnoli) */
+
+static void fun_crc_tables(uint32_t t[8][256], uint32_t poly) {
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t c = i;
+    for (int k = 0; k < 8; ++k)
+      c = (c & 1) ? (c >> 1) ^ poly : c >> 1;
+    t[0][i] = c;
+  }
+  for (int k = 1; k < 8; ++k)
+    for (int i = 0; i < 256; ++i)
+      t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xff];
+}
+
+/* Slicing-by-8: eight table lookups per 8 input bytes. */
+static uint32_t fun_crc_slice8(uint32_t t[8][256], uint32_t crc, const unsigned char *p, size_t n) {
+  for (; n >= 8; n -= 8, p += 8) {
+    uint32_t lo = fun_load_le32(p) ^ crc, hi = fun_load_le32(p + 4);
+    crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^ t[3][hi & 0xff] ^
+          t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+  }
+  for (; n > 0; --n)
+    crc = t[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+  return crc;
+}
+
+static uint32_t fun_crc32c_c(uint32_t crc, const unsigned char *p, size_t n) {
+  return fun_crc_slice8(fun_crc32c_tab, crc, p, n);
+}
+
+#ifdef FUN_CRYPTO_X86
+__attribute__((target("sse4.2"))) static uint32_t fun_crc32c_sse42(uint32_t crc, const unsigned char *p, size_t n) {
+#ifdef __x86_64__
+  uint64_t c = crc;
+  for (; n >= 8; n -= 8, p += 8) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    c = _mm_crc32_u64(c, v);
+  }
+  crc = (uint32_t)c;
+#endif
+  for (; n >= 4; n -= 4, p += 4) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    crc = _mm_crc32_u32(crc, v);
+  }
+  for (; n > 0; --n)
+    crc = _mm_crc32_u8(crc, *p++);
+  return crc;
+}
+#endif
+
+/* ---------- AES-256 (FIPS 197) ---------- */
+
+static const unsigned char fun_aes_sbox[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16
+};
+
+static inline unsigned char fun_aes_xtime(unsigned char x) {
+  return (unsigned char)((x << 1) ^ ((x & 0x80) ? 0x1b : 0));
+}
+
+static void fun_aes256_ecb_c(const unsigned char *rk, const unsigned char *in, unsigned char *out, size_t n) {
+  unsigned char s[16], t[16];
+  for (; n > 0; --n, in += 16, out += 16) {
+    for (int i = 0; i < 16; ++i)
+      s[i] = in[i] ^ rk[i];
+    for (int round = 1; round <= 14; ++round) {
+      /* SubBytes and ShiftRows (state is column-major: s[row + 4 * col]) */
+      for (int c = 0; c < 4; ++c)
+        for (int r = 0; r < 4; ++r)
+          t[r + 4 * c] = fun_aes_sbox[s[r + 4 * ((c + r) & 3)]];
+      if (round < 14) {
+        for (int c = 0; c < 4; ++c) {
+          unsigned char a0 = t[4 * c], a1 = t[4 * c + 1], a2 = t[4 * c + 2], a3 = t[4 * c + 3];
+          unsigned char all = a0 ^ a1 ^ a2 ^ a3;
+          s[4 * c] = a0 ^ all ^ fun_aes_xtime(a0 ^ a1);
+          s[4 * c + 1] = a1 ^ all ^ fun_aes_xtime(a1 ^ a2);
+          s[4 * c + 2] = a2 ^ all ^ fun_aes_xtime(a2 ^ a3);
+          s[4 * c + 3] = a3 ^ all ^ fun_aes_xtime(a3 ^ a0);
+        }
+      } else {
+        memcpy(s, t, 16);
+      }
+      for (int i = 0; i < 16; ++i)
+        s[i] ^= rk[16 * round + i];
+    }
+    memcpy(out, s, 16);
+  }
+}
+
+#ifdef FUN_CRYPTO_X86
+/* The byte layout of FunAes256.rk is what aesenc expects, so the portable
+ * key expansion serves both paths. */
+__attribute__((target("aes,sse2"))) static void fun_aes256_ecb_ni(const unsigned char *rk, const unsigned char *in, unsigned char *out, size_t n) {
+  __m128i k[15];
+  for (int i = 0; i < 15; ++i)
+    k[i] = _mm_loadu_si128((const __m128i *)(rk + 16 * i));
+  for (; n >= 4; n -= 4, in += 64, out += 64) {
+    __m128i b0 = _mm_xor_si128(_mm_loadu_si128((const __m128i *)in), k[0]);
+    __m128i b1 = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(in + 16)), k[0]);
+    __m128i b2 = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(in + 32)), k[0]);
+    __m128i b3 = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(in + 48)), k[0]);
+    for (int r = 1; r < 14; ++r) {
+      b0 = _mm_aesenc_si128(b0, k[r]);
+      b1 = _mm_aesenc_si128(b1, k[r]);
+      b2 = _mm_aesenc_si128(b2, k[r]);
+      b3 = _mm_aesenc_si128(b3, k[r]);
+    }
+    _mm_storeu_si128((__m128i *)out, _mm_aesenclast_si128(b0, k[14]));
+    _mm_storeu_si128((__m128i *)(out + 16), _mm_aesenclast_si128(b1, k[14]));
+    _mm_storeu_si128((__m128i *)(out + 32), _mm_aesenclast_si128(b2, k[14]));
+    _mm_storeu_si128((__m128i *)(out + 48), _mm_aesenclast_si128(b3, k[14]));
+  }
+  for (; n > 0; --n, in += 16, out += 16) {
+    __m128i b = _mm_xor_si128(_mm_loadu_si128((const __m128i *)in), k[0]);
+    for (int r = 1; r < 14; ++r)
+      b = _mm_aesenc_si128(b, k[r]);
+    _mm_storeu_si128((__m128i *)out, _mm_aesenclast_si128(b, k[14]));
+  }
+}
+#endif
+
+/* ---------- Kernel selection ---------- */
+
+static void (*fun_sha1_blocks)(uint32_t *, const unsigned char *, size_t) = fun_sha1_blocks_c;
+static void (*fun_sha256_blocks)(uint32_t *, const unsigned char *, size_t) = fun_sha256_blocks_c;
+static uint32_t (*fun_crc32c_update)(uint32_t, const unsigned char *, size_t) = fun_crc32c_c;
+static void (*fun_aes256_ecb)(const unsigned char *, const unsigned char *, unsigned char *, size_t) = fun_aes256_ecb_c;
+static const char *fun_sha_kernel = "portable";
+static const char *fun_crc32c_kernel = "portable";
+static const char *fun_aes_kernel = "portable";
+
+static void fun_crypto_setup_once(void) {
+  fun_crc_tables(fun_crc32_tab, 0xedb88320u);
+  fun_crc_tables(fun_crc32c_tab, 0x82f63b78u);
+  const char *env = getenv("FUN_CRYPTO_PORTABLE");
+  if (env && *env && strcmp(env, "0") != 0) return;
+#ifdef FUN_CRYPTO_X86
+  unsigned int a, b, c, d;
+  if (!__get_cpuid(1, &a, &b, &c, &d)) return;
+  int ssse3 = (c >> 9) & 1, sse41 = (c >> 19) & 1, sse42 = (c >> 20) & 1, aes = (c >> 25) & 1;
+  int sha = 0;
+  if (__get_cpuid_max(0, NULL) >= 7) {
+    __cpuid_count(7, 0, a, b, c, d);
+    sha = (b >> 29) & 1;
+  }
+  if (sha && ssse3 && sse41) {
+    fun_sha1_blocks = fun_sha1_blocks_ni;
+    fun_sha256_blocks = fun_sha256_blocks_ni;
+    fun_sha_kernel = "sha-ni";
+  }
+  if (sse42) {
+    fun_crc32c_update = fun_crc32c_sse42;
+    fun_crc32c_kernel = "sse4.2";
+  }
+  if (aes) {
+    fun_aes256_ecb = fun_aes256_ecb_ni;
+    fun_aes_kernel = "aes-ni";
+  }
+#endif
+}
+
+#ifdef __unix__
+static pthread_once_t fun_crypto_once = PTHREAD_ONCE_INIT;
+static void fun_crypto_setup(void) {
+  pthread_once(&fun_crypto_once, fun_crypto_setup_once);
+}
+#else
+static int fun_crypto_ready = 0;
+static void fun_crypto_setup(void) {
+  if (!fun_crypto_ready) {
+    fun_crypto_setup_once();
+    fun_crypto_ready = 1;
+  }
+}
+#endif
+
+const char *fun_crypto_kernel(const char *what) {
+  fun_crypto_setup();
+  if (strcmp(what, "sha1") == 0 || strcmp(what, "sha256") == 0) return fun_sha_kernel;
+  if (strcmp(what, "crc32c") == 0) return fun_crc32c_kernel;
+  if (strcmp(what, "aes") == 0) return fun_aes_kernel;
+  return "portable";
+}
+
+/* ---------- Streaming hashes ---------- */
+
+static const struct {
+  const char *name;
+  size_t block;  /* 0 for the CRCs, which take any length */
+  size_t digest;
+} fun_hash_info[FUN_HASH_COUNT] = {
+    {"md5", 64, 16},     {"sha1", 64, 20}, {"sha256", 64, 32}, {"sha384", 128, 48},
+    {"sha512", 128, 64}, {"crc32", 0, 4},  {"crc32c", 0, 4},
+};
+
+int fun_hash_lookup(const char *name) {
+  for (int i = 0; i < FUN_HASH_COUNT; ++i)
+    if (strcmp(name, fun_hash_info[i].name) == 0) return i;
+  return -1;
+}
+
+size_t fun_hash_digest_len(int alg) {
+  return fun_hash_info[alg].digest;
+}
+
+void fun_hash_init(FunHashCtx *c, int alg) {
+  static const uint32_t md5_iv[4] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476};
+  static const uint32_t sha1_iv[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+  fun_crypto_setup();
+  memset(c, 0, sizeof(*c));
+  c->alg = alg;
+  switch (alg) {
+  case FUN_HASH_MD5:
+    memcpy(c->st.h32, md5_iv, sizeof(md5_iv));
+    break;
+  case FUN_HASH_SHA1:
+    memcpy(c->st.h32, sha1_iv, sizeof(sha1_iv));
+    break;
+  case FUN_HASH_SHA256:
+    memcpy(c->st.h32, fun_sha256_iv, sizeof(fun_sha256_iv));
+    break;
+  case FUN_HASH_SHA384:
+    memcpy(c->st.h64, fun_sha384_iv, sizeof(fun_sha384_iv));
+    break;
+  case FUN_HASH_SHA512:
+    memcpy(c->st.h64, fun_sha512_iv, sizeof(fun_sha512_iv));
+    break;
+  default: /* CRCs */
+    c->st.h32[0] = 0xffffffffu;
+    break;
+  }
+}
+
+static void fun_hash_blocks(FunHashCtx *c, const unsigned char *p, size_t n) {
+  switch (c->alg) {
+  case FUN_HASH_MD5:
+    fun_md5_blocks(c->st.h32, p, n);
+    break;
+  case FUN_HASH_SHA1:
+    fun_sha1_blocks(c->st.h32, p, n);
+    break;
+  case FUN_HASH_SHA256:
+    fun_sha256_blocks(c->st.h32, p, n);
+    break;
+  default: /* SHA-384, SHA-512 */
+    fun_sha512_blocks(c->st.h64, p, n);
+    break;
+  }
+}
+
+void fun_hash_update(FunHashCtx *c, const void *data, size_t len) {
+  const unsigned char *p = (const unsigned char *)data;
+  c->total += len;
+  if (c->alg == FUN_HASH_CRC32) {
+    c->st.h32[0] = fun_crc_slice8(fun_crc32_tab, c->st.h32[0], p, len);
+    return;
+  }
+  if (c->alg == FUN_HASH_CRC32C) {
+    c->st.h32[0] = fun_crc32c_update(c->st.h32[0], p, len);
+    return;
+  }
+  size_t bs = fun_hash_info[c->alg].block;
+  if (c->buflen > 0) {
+    size_t take = bs - c->buflen < len ? bs - c->buflen : len;
+    memcpy(c->buf + c->buflen, p, take);
+    c->buflen += take;
+    p += take;
+    len -= take;
+    if (c->buflen < bs) return;
+    fun_hash_blocks(c, c->buf, 1);
+    c->buflen = 0;
+  }
+  if (len >= bs) {
+    fun_hash_blocks(c, p, len / bs);
+    p += len - len % bs;
+    len %= bs;
+  }
+  memcpy(c->buf, p, len);
+  c->buflen = len;
+}
+
+void fun_hash_final(FunHashCtx *c, unsigned char *out) {
+  if (c->alg == FUN_HASH_CRC32 || c->alg == FUN_HASH_CRC32C) {
+    fun_store_be32(out, c->st.h32[0] ^ 0xffffffffu);
+    return;
+  }
+  size_t bs = fun_hash_info[c->alg].block, lenfield = bs == 128 ? 16 : 8;
+  c->buf[c->buflen++] = 0x80;
+  if (c->buflen > bs - lenfield) {
+    memset(c->buf + c->buflen, 0, bs - c->buflen);
+    fun_hash_blocks(c, c->buf, 1);
+    c->buflen = 0;
+  }
+  memset(c->buf + c->buflen, 0, bs - c->buflen);
+  if (c->alg == FUN_HASH_MD5) {
+    fun_store_le32(c->buf + 56, (uint32_t)(c->total << 3));
+    fun_store_le32(c->buf + 60, (uint32_t)(c->total >> 29));
+  } else {
+    fun_store_be64(c->buf + bs - 8, c->total << 3);
+    if (bs == 128) fun_store_be64(c->buf + bs - 16, c->total >> 61);
+  }
+  fun_hash_blocks(c, c->buf, 1);
+  size_t dlen = fun_hash_info[c->alg].digest;
+  if (c->alg == FUN_HASH_MD5) {
+    for (int i = 0; i < 4; ++i)
+      fun_store_le32(out + 4 * i, c->st.h32[i]);
+  } else if (bs == 64) {
+    for (size_t i = 0; i < dlen / 4; ++i)
+      fun_store_be32(out + 4 * i, c->st.h32[i]);
+  } else {
+    for (size_t i = 0; i < dlen / 8; ++i)
+      fun_store_be64(out + 8 * i, c->st.h64[i]);
+  }
+}
+
+/* ---------- AES-256 ---------- */
+
+void fun_aes256_init(FunAes256 *k, const unsigned char key[32]) {
+  unsigned char *w = k->rk;
+  unsigned char rcon = 1;
+  fun_crypto_setup();
+  memcpy(w, key, 32);
+  for (int i = 8; i < 60; ++i) {
+    unsigned char t[4];
+    memcpy(t, w + 4 * (i - 1), 4);
+    if (i % 8 == 0) {
+      unsigned char u = t[0];
+      t[0] = fun_aes_sbox[t[1]] ^ rcon;
+      t[1] = fun_aes_sbox[t[2]];
+      t[2] = fun_aes_sbox[t[3]];
+      t[3] = fun_aes_sbox[u];
+      rcon = fun_aes_xtime(rcon);
+    } else if (i % 8 == 4) {
+      for (int j = 0; j < 4; ++j)
+        t[j] = fun_aes_sbox[t[j]];
+    }
+    for (int j = 0; j < 4; ++j)
+      w[4 * i + j] = w[4 * (i - 8) + j] ^ t[j];
+  }
+}
+
+void fun_aes256_encrypt_ecb(const FunAes256 *k, const unsigned char *in, unsigned char *out, size_t nblocks) {
+  fun_aes256_ecb(k->rk, in, out, nblocks);
+}
@@ -0,0 +1,71 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file crypto.h
+ * @brief Native hash, checksum and AES-256 kernels (always built, no OpenSSL).
+ *
+ * MD5, SHA-1, SHA-256, SHA-384, SHA-512, CRC-32 and CRC-32C are computed
+ * incrementally through a FunHashCtx (init/update/final); AES-256 encrypts
+ * 16-byte blocks in ECB mode. On x86-64 the kernels pick, once per process,
+ * the SHA extensions for SHA-1/SHA-256, the SSE4.2 crc32 instruction for
+ * CRC-32C and AES-NI for AES when the CPU has them; everything else, and
+ * every other CPU, uses portable C. Setting FUN_CRYPTO_PORTABLE=1 in the
+ * environment forces the portable code (to compare or test it).
+ */
+
+#ifndef FUN_CRYPTO_H
+#define FUN_CRYPTO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Algorithms of a FunHashCtx. */
+enum { FUN_HASH_MD5, FUN_HASH_SHA1, FUN_HASH_SHA256, FUN_HASH_SHA384, FUN_HASH_SHA512, FUN_HASH_CRC32, FUN_HASH_CRC32C, FUN_HASH_COUNT };
+
+/** Largest digest in bytes (SHA-512). */
+#define FUN_HASH_MAX_DIGEST 64
+
+/** Streaming hash state. */
+typedef struct FunHashCtx {
+  int alg;
+  uint64_t total;           /* bytes hashed so far */
+  size_t buflen;            /* bytes waiting in buf for a full block */
+  unsigned char buf[128];   /* partial block (64 or 128 bytes used) */
+  union {
+    uint32_t h32[8];        /* MD5, SHA-1, SHA-256; h32[0] is the CRC */
+    uint64_t h64[8];        /* SHA-384, SHA-512 */
+  } st;
+} FunHashCtx;
+
+/** Algorithm for a name ("md5", "sha1", "sha256", "sha384", "sha512", "crc32", "crc32c"); -1 if unknown. */
+int fun_hash_lookup(const char *name);
+/** Digest length of alg in bytes. */
+size_t fun_hash_digest_len(int alg);
+/** Start a hash of the given algorithm. */
+void fun_hash_init(FunHashCtx *c, int alg);
+/** Hash len more bytes. */
+void fun_hash_update(FunHashCtx *c, const void *data, size_t len);
+/** Finish and write fun_hash_digest_len() bytes to out (CRCs big-endian); c must be re-initialized before reuse. */
+void fun_hash_final(FunHashCtx *c, unsigned char *out);
+
+/** Expanded AES-256 key (15 round keys). */
+typedef struct FunAes256 {
+  unsigned char rk[240];
+} FunAes256;
+
+/** Expand a 32-byte key. */
+void fun_aes256_init(FunAes256 *k, const unsigned char key[32]);
+/** Encrypt nblocks 16-byte blocks (ECB); in and out may be the same buffer. */
+void fun_aes256_encrypt_ecb(const FunAes256 *k, const unsigned char *in, unsigned char *out, size_t nblocks);
+
+/** Kernel in use for "sha1", "sha256", "crc32c" or "aes": "sha-ni", "sse4.2", "aes-ni" or "portable". */
+const char *fun_crypto_kernel(const char *what);
+
+#endif
@@ -44,14 +44,27 @@
  *   on fwrite()'s return value; callers should check the CURLcode after
  *   performing the transfer for final status.
  *
+ * Handle pool and share:
+ * - Easy handles are not created per request. fun_curl_acquire() takes one
+ *   from a small process-wide free list (curl_easy_reset() clears the options
+ *   but keeps live connections) and fun_curl_release() returns it.
+ * - All pooled handles are attached to one CURLSH that shares the DNS cache,
+ *   TLS session IDs and the connection cache, so keep-alive connections and
+ *   TLS sessions are reused across requests, opcodes and threads.
+ *
+ * Requests described by Fun values (curl_multi):
+ * - fun_curl_req_setup() applies a URL string or an options map {url, method,
+ *   body, headers, timeout_ms} to an easy handle; fun_curl_req_result() builds
+ *   the {url, status, headers, body, error, connects, time_ms} result map.
+ *
  * Thread-safety:
- * - These helpers themselves are stateless and thread-safe as long as each
- *   CURL easy handle and associated buffers/FILE* are not shared concurrently
- *   across threads without external synchronization.
+ * - The pool and the share are guarded by mutexes. A CURL easy handle and
+ *   its buffers/FILE* must not be used by two threads at once.
  */
 
 /* Ensure libcurl headers and helpers are defined at file scope (not inside vm_run) */
 #ifdef FUN_WITH_CURL
+#include <ctype.h>
 #include <curl/curl.h>
 
 /**
@@ -115,4 +128,270 @@ static size_t fun_curl_file_write_cb(void *ptr, size_t sz, size_t nm, void *ud)
   FILE *f = (FILE *)ud;
   return fwrite(ptr, sz, nm, f);
 }
+#ifdef __unix__
+#include <pthread.h>
+#endif
+
+#define FUN_CURL_POOL_MAX 16
+
+static CURL *g_curl_pool[FUN_CURL_POOL_MAX];
+static int g_curl_pool_n = 0;
+static CURLSH *g_curl_share = NULL;
+static int g_curl_inited = 0;
+#ifdef __unix__
+static pthread_mutex_t g_curl_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t g_curl_share_locks[CURL_LOCK_DATA_LAST];
+#define FUN_CURL_POOL_LOCK() pthread_mutex_lock(&g_curl_pool_lock)
+#define FUN_CURL_POOL_UNLOCK() pthread_mutex_unlock(&g_curl_pool_lock)
+
+static void fun_curl_share_lock(CURL *h, curl_lock_data data, curl_lock_access access, void *ud) {
+  (void)h;
+  (void)access;
+  (void)ud;
+  pthread_mutex_lock(&g_curl_share_locks[data]);
+}
+
+static void fun_curl_share_unlock(CURL *h, curl_lock_data data, void *ud) {
+  (void)h;
+  (void)ud;
+  pthread_mutex_unlock(&g_curl_share_locks[data]);
+}
+#else
+#define FUN_CURL_POOL_LOCK() ((void)0)
+#define FUN_CURL_POOL_UNLOCK() ((void)0)
+#endif
+
+/* One-time libcurl and share setup. Caller holds the pool lock. */
+static void fun_curl_init_locked(void) {
+  if (g_curl_inited) return;
+  g_curl_inited = 1;
+  curl_global_init(CURL_GLOBAL_DEFAULT);
+  g_curl_share = curl_share_init();
+  if (!g_curl_share) return;
+#ifdef __unix__
+  for (int i = 0; i < CURL_LOCK_DATA_LAST; ++i)
+    pthread_mutex_init(&g_curl_share_locks[i], NULL);
+  curl_share_setopt(g_curl_share, CURLSHOPT_LOCKFUNC, fun_curl_share_lock);
+  curl_share_setopt(g_curl_share, CURLSHOPT_UNLOCKFUNC, fun_curl_share_unlock);
+#endif
+  curl_share_setopt(g_curl_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(g_curl_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+  curl_share_setopt(g_curl_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+}
+
+/**
+ * @brief Take an easy handle from the pool (or create one) with default options.
+ * @return Handle to pass to fun_curl_release(), or NULL on failure.
+ */
+static CURL *fun_curl_acquire(void) {
+  CURL *h = NULL;
+  FUN_CURL_POOL_LOCK();
+  fun_curl_init_locked();
+  if (g_curl_pool_n > 0) h = g_curl_pool[--g_curl_pool_n];
+  FUN_CURL_POOL_UNLOCK();
+  if (h) {
+    curl_easy_reset(h); /* keeps live connections and the share */
+  } else {
+    h = curl_easy_init();
+    if (!h) return NULL;
+    if (g_curl_share) curl_easy_setopt(h, CURLOPT_SHARE, g_curl_share);
+  }
+  curl_easy_setopt(h, CURLOPT_FOLLOWLOCATION, 1L);
+  curl_easy_setopt(h, CURLOPT_NOSIGNAL, 1L);
+  return h;
+}
+
+/** Return a handle to the pool; surplus handles are cleaned up. */
+static void fun_curl_release(CURL *h) {
+  if (!h) return;
+  FUN_CURL_POOL_LOCK();
+  if (g_curl_pool_n < FUN_CURL_POOL_MAX) {
+    g_curl_pool[g_curl_pool_n++] = h;
+    h = NULL;
+  }
+  FUN_CURL_POOL_UNLOCK();
+  if (h) curl_easy_cleanup(h);
+}
+
+/** Per-transfer state of a request built from Fun values. */
+typedef struct {
+  CURL *h;
+  FunCurlBuf body;
+  Value headers; /* map: lower-case name -> value (repeats joined with ", ") */
+  struct curl_slist *req_headers;
+  char *url;
+  char *post;
+  CURLcode rc;
+  int done;
+} FunCurlReq;
+
+/** CURLOPT_HEADERFUNCTION: collect response headers of the final response. */
+static size_t fun_curl_header_cb(char *ptr, size_t sz, size_t nm, void *ud) {
+  size_t n = sz * nm;
+  FunCurlReq *r = (FunCurlReq *)ud;
+  if (n >= 5 && memcmp(ptr, "HTTP/", 5) == 0) {
+    /* a new status line (redirect or 100-continue): start over */
+    free_value(r->headers);
+    r->headers = make_map_empty();
+    return n;
+  }
+  const char *colon = memchr(ptr, ':', n);
+  if (!colon || colon == ptr) return n;
+  size_t klen = (size_t)(colon - ptr);
+  char *key = (char *)malloc(klen + 1);
+  if (!key) return 0;
+  for (size_t i = 0; i < klen; ++i)
+    key[i] = (char)tolower((unsigned char)ptr[i]);
+  key[klen] = '\0';
+  const char *v = colon + 1, *end = ptr + n;
+  while (v < end && (*v == ' ' || *v == '\t'))
+    v++;
+  while (end > v && (end[-1] == '\r' || end[-1] == '\n' || end[-1] == ' ' || end[-1] == '\t'))
+    end--;
+  size_t vlen = (size_t)(end - v);
+  Value prev;
+  size_t plen = 0;
+  int had = map_get_copy(&r->headers, key, &prev) && prev.type == VAL_STRING && prev.s;
+  if (had) plen = strlen(prev.s);
+  Value sv = make_string_len(NULL, plen + (had ? 2 : 0) + vlen);
+  char *val = sv.s;
+  if (val) {
+    size_t o = 0;
+    if (had) {
+      memcpy(val, prev.s, plen);
+      memcpy(val + plen, ", ", 2);
+      o = plen + 2;
+    }
+    memcpy(val + o, v, vlen);
+    map_set(&r->headers, key, sv);
+  }
+  if (had) free_value(prev);
+  free(key);
+  return val ? n : 0;
+}
+
+/**
+ * @brief Prepare r for the request described by spec (URL string or options
+ *        map {url, method, body, headers, timeout_ms}).
+ * @return 1 on success; 0 if spec has no URL or no handle is available.
+ */
+static int fun_curl_req_setup(FunCurlReq *r, const Value *spec) {
+  memset(r, 0, sizeof(*r));
+  r->headers = make_map_empty();
+  r->rc = CURLE_OK;
+  char *method = NULL;
+  long timeout_ms = 0;
+  if (spec->type == VAL_MAP) {
+    Value v;
+    if (map_get_copy(spec, "url", &v)) {
+      r->url = value_to_string_alloc(&v);
+      free_value(v);
+    }
+    if (map_get_copy(spec, "method", &v)) {
+      method = value_to_string_alloc(&v);
+      free_value(v);
+    }
+    if (map_get_copy(spec, "body", &v)) {
+      if (v.type != VAL_NIL) r->post = value_to_string_alloc(&v);
+      free_value(v);
+    }
+    if (map_get_copy(spec, "timeout_ms", &v)) {
+      if (v.type == VAL_INT) timeout_ms = (long)v.i;
+      free_value(v);
+    }
+    if (map_get_copy(spec, "headers", &v)) {
+      if (v.type == VAL_MAP) {
+        Value ks = map_keys_array(&v);
+        int nk = array_length(&ks);
+        for (int i = 0; i < nk; ++i) {
+          Value k = array_peek_value(&ks, i);
+          Value hv;
+          if (k.type != VAL_STRING || !map_get_copy(&v, k.s, &hv)) continue;
+          char *hs = value_to_string_alloc(&hv);
+          free_value(hv);
+          if (!hs) continue;
+          size_t ln = strlen(k.s) + strlen(hs) + 3;
+          char *line = (char *)malloc(ln);
+          if (line) {
+            snprintf(line, ln, "%s: %s", k.s, hs);
+            struct curl_slist *nl = curl_slist_append(r->req_headers, line);
+            if (nl) r->req_headers = nl;
+            free(line);
+          }
+          free(hs);
+        }
+        free_value(ks);
+      }
+      free_value(v);
+    }
+  } else {
+    r->url = value_to_string_alloc(spec);
+  }
+  if (!r->url || !r->url[0] || !(r->h = fun_curl_acquire())) {
+    free(method);
+    return 0;
+  }
+  CURL *h = r->h;
+  curl_easy_setopt(h, CURLOPT_URL, r->url);
+  curl_easy_setopt(h, CURLOPT_WRITEFUNCTION, fun_curl_write_cb);
+  curl_easy_setopt(h, CURLOPT_WRITEDATA, &r->body);
+  curl_easy_setopt(h, CURLOPT_HEADERFUNCTION, fun_curl_header_cb);
+  curl_easy_setopt(h, CURLOPT_HEADERDATA, r);
+  curl_easy_setopt(h, CURLOPT_PRIVATE, r);
+  if (r->post) {
+    curl_easy_setopt(h, CURLOPT_POSTFIELDS, r->post);
+    curl_easy_setopt(h, CURLOPT_POSTFIELDSIZE, (long)strlen(r->post));
+  }
+  if (method && strcmp(method, r->post ? "POST" : "GET") != 0) {
+    if (strcmp(method, "HEAD") == 0)
+      curl_easy_setopt(h, CURLOPT_NOBODY, 1L);
+    else
+      curl_easy_setopt(h, CURLOPT_CUSTOMREQUEST, method);
+  }
+  if (r->req_headers) curl_easy_setopt(h, CURLOPT_HTTPHEADER, r->req_headers);
+  if (timeout_ms > 0) curl_easy_setopt(h, CURLOPT_TIMEOUT_MS, timeout_ms);
+  free(method);
+  return 1;
+}
+
+/**
+ * @brief Build the result map of a finished (or failed to start) request and
+ *        release its handle and buffers.
+ *
+ * Map: url, status (0 if no response), headers, body, error ("" on success),
+ * connects (new connections opened; 0 when a pooled one was reused), time_ms.
+ */
+static Value fun_curl_req_result(FunCurlReq *r) {
+  Value m = make_map_empty();
+  long status = 0, connects = 0;
+  double total = 0.0;
+  if (r->h) {
+    curl_easy_getinfo(r->h, CURLINFO_RESPONSE_CODE, &status);
+    curl_easy_getinfo(r->h, CURLINFO_NUM_CONNECTS, &connects);
+    curl_easy_getinfo(r->h, CURLINFO_TOTAL_TIME, &total);
+  }
+  map_set(&m, "url", make_string(r->url ? r->url : ""));
+  map_set(&m, "status", make_int(status));
+  map_set(&m, "headers", r->headers);
+  r->headers = make_nil();
+  map_set(&m, "body", make_string(r->body.d ? r->body.d : ""));
+  const char *err = !r->h ? "invalid request" : (r->rc != CURLE_OK ? curl_easy_strerror(r->rc) : "");
+  map_set(&m, "error", make_string(err));
+  map_set(&m, "connects", make_int(connects));
+  map_set(&m, "time_ms", make_int((int64_t)(total * 1000.0)));
+  if (r->h) {
+    /* the handle goes back to the pool: detach per-request pointers first */
+    curl_easy_setopt(r->h, CURLOPT_HTTPHEADER, NULL);
+    fun_curl_release(r->h);
+  }
+  if (r->req_headers) curl_slist_free_all(r->req_headers);
+  free(r->body.d);
+  free(r->url);
+  free(r->post);
+  free_value(r->headers);
+  memset(r, 0, sizeof(*r));
+  return m;
+}
 #endif
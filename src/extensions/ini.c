@@ -23,16 +23,18 @@
  *   in their respective VM files.
  *
  * Registry and ownership model:
- * - A very small fixed-size registry (g_ini) maps small positive integers to
- *   iniparser dictionaries. The registry OWNS the dictionary pointer and will
- *   call iniparser_freedict() when a handle is freed via ini_free_handle().
- * - Handles are in the range [1, 63]; 0 indicates failure/invalid.
+ * - A handle table (g_ini, see src/handles.c) maps generation-tagged
+ *   positive ids to iniparser dictionaries. The registry OWNS the dictionary
+ *   pointer and calls iniparser_freedict() when a handle is freed via
+ *   ini_free_handle(). There is no fixed limit; 0 indicates failure/invalid,
+ *   and a freed id stays invalid even after its slot is reused.
  * - The registry does not perform I/O; callers are responsible for creating
  *   the dictionary (e.g., iniparser_load()) prior to registration.
  *
  * Thread-safety:
- * - Not thread-safe. If used from multiple threads, coordinate access
- *   externally.
+ * - The registry is thread-safe, so thread_spawn workers can load and free
+ *   their own files. One dictionary must not be modified by two threads at
+ *   once.
  *
  * Key formatting helper:
  * - ini_make_full_key() produces a section-qualified key of the form
@@ -59,25 +61,13 @@
 #include <string.h>
 #include <stddef.h>
 
-/**
- * @brief One slot in the global INI handle registry.
- *
- * Associates an iniparser dictionary pointer with an in-use flag. The
- * registry takes ownership of the dictionary for the lifetime of the slot and
- * will free it when the handle is released via ini_free_handle().
- */
-typedef struct {
-  dictionary *dict;
-  int in_use;
-} IniSlot;
+/** Destructor of the INI table: free the dictionary. */
+static void ini_dict_release(void *d) {
+  iniparser_freedict((dictionary *)d);
+}
 
-/**
- * @brief Fixed-size registry of iniparser dictionaries.
- *
- * Index 0 is reserved and never used for valid handles. Valid handles are in
- * the range [1, 63]. When an entry's in_use flag is 0, the slot is available.
- */
-IniSlot g_ini[64];
+/** Loaded INI dictionaries by handle id. */
+static FunHandleTable g_ini = FUN_HANDLE_TABLE_INIT(ini_dict_release);
 
 /**
  * @brief Allocate a registry handle for a newly created dictionary.
@@ -86,19 +76,11 @@ IniSlot g_ini[64];
  *
  * @param d Pointer to an initialized iniparser dictionary (e.g., from
  *          iniparser_load()). Must not be NULL.
- * @return int Positive handle (>0) on success; 0 if no free slot is available
- *             or if d is NULL.
+ * @return int64_t Positive handle (>0) on success; 0 on allocation failure
+ *                 or if d is NULL (the caller still owns d then).
  */
-int ini_alloc_handle(dictionary *d) {
-  if (!d) return 0;
-  for (int i = 1; i < (int)(sizeof(g_ini) / sizeof(g_ini[0])); ++i) {
-    if (!g_ini[i].in_use) {
-      g_ini[i].in_use = 1;
-      g_ini[i].dict = d;
-      return i;
-    }
-  }
-  return 0;
+int64_t ini_alloc_handle(dictionary *d) {
+  return fun_handle_new(&g_ini, d);
 }
 
 /**
@@ -108,29 +90,21 @@ int ini_alloc_handle(dictionary *d) {
  * directly. Use ini_free_handle() to release the association.
  *
  * @param h Handle id previously returned by ini_alloc_handle().
- * @return dictionary* Pointer to dictionary if the handle is valid and in use;
- *                     NULL otherwise.
+ * @return dictionary* Pointer to dictionary if the handle is live; NULL
+ *                     otherwise.
  */
-dictionary *ini_get(int h) {
-  if (h > 0 && h < (int)(sizeof(g_ini) / sizeof(g_ini[0])) && g_ini[h].in_use) return g_ini[h].dict;
-  return NULL;
+dictionary *ini_get(int64_t h) {
+  return (dictionary *)fun_handle_get(&g_ini, h);
 }
 
 /**
  * @brief Free a previously allocated handle and close its dictionary.
  *
- * If the slot holds a dictionary, iniparser_freedict() is called. The slot is
- * then marked available for reuse.
- *
  * @param h Handle id to free.
- * @return int 1 on success; 0 if the handle is invalid or not in use.
+ * @return int 1 on success; 0 if the handle is invalid or already freed.
  */
-int ini_free_handle(int h) {
-  if (h <= 0 || h >= (int)(sizeof(g_ini) / sizeof(g_ini[0])) || !g_ini[h].in_use) return 0;
-  if (g_ini[h].dict) iniparser_freedict(g_ini[h].dict);
-  g_ini[h].dict = NULL;
-  g_ini[h].in_use = 0;
-  return 1;
+int ini_free_handle(int64_t h) {
+  return fun_handle_free(&g_ini, h);
 }
 
 /**
@@ -148,8 +148,8 @@ static Value json_to_fun(json_object *j) {
  *   json_object_put() when no longer needed.
  *
  * Notes and limitations:
- * - Map keys are enumerated via map_keys_array(); only string keys are used.
- *   Non-string keys are ignored.
+ * - Map keys are enumerated in insertion order; number and boolean keys become
+ *   their string form ("1", "2.5", "true"). Sets become arrays.
  * - json-c does not support NaN/Inf as JSON numbers in a standard way; if such
  *   values appear in Fun Float, they are forwarded to json-c as-is.
  *
@@ -184,26 +184,22 @@ static json_object *fun_to_json(const Value *v) {
   }
   case VAL_MAP: {
     json_object *obj = json_object_new_object();
-    /* We don't have an iterator API; use keys() helper */
-    Value keys = map_keys_array(v);
-    int kn = array_length(&keys);
+    int kn = map_count(v);
     for (int i = 0; i < kn; ++i) {
-      Value k;
-      if (!array_get_copy(&keys, i, &k)) continue;
-      if (k.type == VAL_STRING && k.s) {
-        Value val;
-        if (map_get_copy(v, k.s, &val)) {
-          json_object_object_add(obj, k.s, fun_to_json(&val));
-          free_value(val);
-        } else {
-          json_object_object_add(obj, k.s, json_object_new_null());
-        }
-      }
-      free_value(k);
+      char *name = value_to_string_alloc(map_peek_key(v, i));
+      if (!name) continue;
+      json_object_object_add(obj, name, fun_to_json(map_peek_val(v, i)));
+      free(name);
     }
-    free_value(keys);
     return obj;
   }
+  case VAL_SET: {
+    json_object *arr = json_object_new_array();
+    int n = map_count(v);
+    for (int i = 0; i < n; ++i)
+      json_object_array_add(arr, fun_to_json(map_peek_key(v, i)));
+    return arr;
+  }
   default:
     /* Fallback: stringify unsupported types */
     return json_object_new_string("<unsupported>");
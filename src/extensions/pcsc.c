@@ -27,26 +27,20 @@
  * - Context registry (g_pcsc_ctx): stores SCARDCONTEXT values obtained via
  *   SCardEstablishContext(). The registry DOES NOT call SCardReleaseContext()
  *   automatically — releasing is the responsibility of the opcode that owns
- *   the lifecycle. The registry merely tracks usage and provides a stable,
- *   small integer id for referencing a context in later operations.
+ *   the lifecycle. The registry merely provides a stable id for referencing a
+ *   context in later operations.
  * - Card registry (g_pcsc_card): stores SCARDHANDLE and the negotiated
  *   protocol (proto) obtained via SCardConnect(). Similarly, the registry does
  *   not call SCardDisconnect(); the VM opcode that created the handle is in
  *   charge of eventual teardown.
- * - Handles are 1-based indices into the fixed arrays (contexts: up to 8,
- *   cards: up to 32). A return value of 0 indicates failure (no free slot or
- *   invalid request).
- *
- * Error handling and limits:
- * - Allocation helpers return 0 when no free slot is available. Lookup helpers
- *   return NULL if the id is out of range or the slot is not currently in use.
- * - The fixed sizes (8 contexts, 32 cards) are pragmatic defaults for typical
- *   scripts. Increase cautiously if your workloads require more concurrent
- *   resources.
- *
- * Thread-safety:
- * - This module is not thread-safe. If the interpreter is used from multiple
- *   threads, coordinate access to these registries externally.
+ * - Both registries are FunHandleTables (src/handles.c): ids are
+ *   generation-tagged int64 values, there is no fixed limit, and the tables
+ *   are safe to use from thread_spawn workers. A return value of 0 indicates
+ *   failure.
+ *
+ * Error handling:
+ * - Allocation helpers return 0 on allocation failure. Lookup helpers return
+ *   NULL for unknown, freed or stale ids.
  */
 
 #ifdef FUN_WITH_PCSC
@@ -63,24 +57,24 @@
 #include <PCSC/winscard.h>
 #include <PCSC/wintypes.h>
 #endif
-#include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 /**
- * @brief One slot in the PC/SC context registry.
+ * @brief One entry in the PC/SC context registry.
  *
  * Ownership notes:
- * - The registry does not own the context; it merely stores the value returned
- *   by SCardEstablishContext(). Callers/opcodes are responsible for invoking
- *   SCardReleaseContext() at the appropriate time.
+ * - The registry owns the entry (heap memory) but not the context; it merely
+ *   stores the value returned by SCardEstablishContext(). Callers/opcodes are
+ *   responsible for invoking SCardReleaseContext() before pcsc_free_ctx().
  */
 typedef struct {
   SCARDCONTEXT ctx; /**< Established context value. */
-  int in_use;       /**< 1 if the slot is currently allocated; 0 otherwise. */
 } pcsc_ctx_entry;
 
 /**
- * @brief One slot in the PC/SC card handle registry.
+ * @brief One entry in the PC/SC card handle registry.
  *
  * Ownership notes:
  * - The registry does not disconnect cards; it only stores the handle returned
@@ -90,85 +84,68 @@ typedef struct {
 typedef struct {
   SCARDHANDLE h; /**< Connected card handle from SCardConnect(). */
   DWORD proto;   /**< Negotiated protocol flags (e.g., SCARD_PROTOCOL_T0/T1). */
-  int in_use;    /**< 1 if the slot is currently allocated; 0 otherwise. */
 } pcsc_card_entry;
 
-static pcsc_ctx_entry g_pcsc_ctx[8];
-static pcsc_card_entry g_pcsc_card[32];
+/* Entries are plain heap structs; freeing a handle only frees the struct. */
+static FunHandleTable g_pcsc_ctx = FUN_HANDLE_TABLE_INIT(free);
+static FunHandleTable g_pcsc_card = FUN_HANDLE_TABLE_INIT(free);
 
 /**
- * @brief Allocate a free context slot in the PC/SC registry.
- *
- * Scans the small fixed-size context registry for an available slot, marks it
- * as in use, clears the stored value, and returns a 1-based identifier.
+ * @brief Allocate a zeroed context entry in the PC/SC registry.
  *
- * @return int A 1-based slot id on success; 0 if no free slot is available.
+ * @return int64_t Handle id (>0) on success; 0 on allocation failure.
  */
-static int pcsc_alloc_ctx_slot(void) {
-  for (int i = 0; i < (int)(sizeof(g_pcsc_ctx) / sizeof(g_pcsc_ctx[0])); ++i) {
-    if (!g_pcsc_ctx[i].in_use) {
-      g_pcsc_ctx[i].in_use = 1;
-      g_pcsc_ctx[i].ctx = 0;
-      return i + 1;
-    }
-  }
-  return 0;
+static int64_t pcsc_alloc_ctx_slot(void) {
+  pcsc_ctx_entry *e = (pcsc_ctx_entry *)calloc(1, sizeof(*e));
+  if (!e) return 0;
+  int64_t id = fun_handle_new(&g_pcsc_ctx, e);
+  if (!id) free(e);
+  return id;
 }
 
 /**
- * @brief Allocate a free card slot in the PC/SC registry.
- *
- * Scans the card registry for an unused entry, sets initial values, and
- * returns a small positive identifier that can be used by opcodes to index the
- * slot later.
+ * @brief Allocate a zeroed card entry in the PC/SC registry.
  *
- * @return int A 1-based slot id on success; 0 if no free slot is available.
+ * @return int64_t Handle id (>0) on success; 0 on allocation failure.
  */
-static int pcsc_alloc_card_slot(void) {
-  for (int i = 0; i < (int)(sizeof(g_pcsc_card) / sizeof(g_pcsc_card[0])); ++i) {
-    if (!g_pcsc_card[i].in_use) {
-      g_pcsc_card[i].in_use = 1;
-      g_pcsc_card[i].h = 0;
-      g_pcsc_card[i].proto = 0;
-      return i + 1;
-    }
-  }
-  return 0;
+static int64_t pcsc_alloc_card_slot(void) {
+  pcsc_card_entry *e = (pcsc_card_entry *)calloc(1, sizeof(*e));
+  if (!e) return 0;
+  int64_t id = fun_handle_new(&g_pcsc_card, e);
+  if (!id) free(e);
+  return id;
 }
 
 /**
- * @brief Lookup a context slot by id.
+ * @brief Lookup a context entry by id.
  *
- * Validates the provided 1-based identifier, ensures the slot is currently in
- * use, and returns a pointer to the internal registry entry.
- *
- * @param id int 1-based context id previously returned by pcsc_alloc_ctx_slot().
- * @return pcsc_ctx_entry* Pointer to the entry if valid and in use; NULL otherwise.
+ * @param id int64_t Id previously returned by pcsc_alloc_ctx_slot().
+ * @return pcsc_ctx_entry* The entry, or NULL for unknown/freed/stale ids.
  */
-static pcsc_ctx_entry *pcsc_get_ctx(int id) {
-  if (id <= 0) return 0;
-  int idx = id - 1;
-  if (idx < 0 || idx >= (int)(sizeof(g_pcsc_ctx) / sizeof(g_pcsc_ctx[0]))) return 0;
-  if (!g_pcsc_ctx[idx].in_use) return 0;
-  return &g_pcsc_ctx[idx];
+static pcsc_ctx_entry *pcsc_get_ctx(int64_t id) {
+  return (pcsc_ctx_entry *)fun_handle_get(&g_pcsc_ctx, id);
 }
 
 /**
- * @brief Lookup a card slot by id.
+ * @brief Lookup a card entry by id.
  *
- * Validates the provided 1-based identifier, ensures the slot is currently in
- * use, and returns a pointer to the internal registry entry, which exposes the
- * SCARDHANDLE and negotiated protocol for subsequent operations (e.g.,
- * SCardTransmit()).
+ * The entry exposes the SCARDHANDLE and negotiated protocol for subsequent
+ * operations (e.g., SCardTransmit()).
  *
- * @param id int 1-based card id previously returned by pcsc_alloc_card_slot().
- * @return pcsc_card_entry* Pointer to the entry if valid and in use; NULL otherwise.
+ * @param id int64_t Id previously returned by pcsc_alloc_card_slot().
+ * @return pcsc_card_entry* The entry, or NULL for unknown/freed/stale ids.
  */
-static pcsc_card_entry *pcsc_get_card(int id) {
-  if (id <= 0) return 0;
-  int idx = id - 1;
-  if (idx < 0 || idx >= (int)(sizeof(g_pcsc_card) / sizeof(g_pcsc_card[0]))) return 0;
-  if (!g_pcsc_card[idx].in_use) return 0;
-  return &g_pcsc_card[idx];
+static pcsc_card_entry *pcsc_get_card(int64_t id) {
+  return (pcsc_card_entry *)fun_handle_get(&g_pcsc_card, id);
+}
+
+/** @brief Drop a context entry (does not call SCardReleaseContext()). */
+static int pcsc_free_ctx(int64_t id) {
+  return fun_handle_free(&g_pcsc_ctx, id);
+}
+
+/** @brief Drop a card entry (does not call SCardDisconnect()). */
+static int pcsc_free_card(int64_t id) {
+  return fun_handle_free(&g_pcsc_card, id);
 }
 #endif
@@ -14,10 +14,11 @@
  * This translation unit provides two small building blocks used by the Redis
  * opcodes (implemented under src/vm/redis/*.c) and included from src/vm.c:
  *
- * 1) A process-local registry that assigns monotonically increasing positive
- *    integer identifiers to hiredis connection pointers (redisContext*).
- *    VM opcodes pass integer ids on the stack instead of raw pointers, keeping
- *    the bytecode portable and preventing accidental misuse of pointers.
+ * 1) A registry that assigns generation-tagged positive integer ids to
+ *    hiredis connection pointers (redisContext*), using the shared handle
+ *    tables (src/handles.c). VM opcodes pass integer ids on the stack
+ *    instead of raw pointers, keeping the bytecode portable and preventing
+ *    accidental misuse of pointers.
  *
  * 2) Utilities to convert hiredis reply objects (redisReply) into Fun VM
  *    Value instances, recursively mapping arrays and supporting basic numeric
@@ -32,29 +33,24 @@
  *
  * Ownership and lifetime
  * ----------------------
- * - The registry does NOT open or close Redis connections by itself; it merely
- *   stores pointers created elsewhere (e.g., via redisConnectWithTimeout()).
- * - Adding an entry does not transfer ownership of the redisContext. Callers
- *   remain responsible for invoking redisFree() at the appropriate time.
- * - Removing an entry from the registry does NOT free the connection; it only
- *   forgets the mapping between id and pointer. The connect/close opcodes take
- *   care of proper ownership transitions.
- * - Integer identifiers are monotonically increasing per process. Once a
- *   handle id is deleted, it will not be reused within the same process
- *   lifetime.
+ * - The registry does NOT open Redis connections; it stores pointers created
+ *   elsewhere (e.g., via redisConnectWithTimeout()).
+ * - Adding an entry transfers ownership of the redisContext to the registry:
+ *   removing the entry frees it with redisFree().
+ * - A removed id stays invalid even when its slot is reused, so closing
+ *   twice or sending a command on a closed handle fails cleanly.
  *
  * Error handling
  * --------------
  * Functions here perform basic validation/allocations only. Allocation
- * failures return NULL (for lookups/additions) or are silently ignored (for
- * deletions of non-existent ids). No hiredis API calls are made here, so no
- * hiredis error codes are produced by this module itself.
+ * failures return 0 (for additions) and lookups of unknown ids return NULL.
+ * No hiredis error codes are produced by the registry itself.
  *
  * Thread-safety
  * -------------
- * The registry is a simple singly-linked list with no synchronization. It is
- * NOT thread-safe. If the VM uses Redis from multiple threads, the caller must
- * provide external synchronization around calls to these helpers.
+ * The registry is thread-safe (a sharded, mutex-protected table), so
+ * thread_spawn workers can open and use their own connections. A single
+ * redisContext must not be used by two threads at once.
  *
  * Example
  * -------
@@ -63,19 +59,17 @@
  * struct timeval tv = { .tv_sec = 2, .tv_usec = 0 };
  * redisContext *ctx = redisConnectWithTimeout("127.0.0.1", 6379, tv);
  * if (ctx && !ctx->err) {
- *   // Register and get an id:
- *   RedisHandle *h = redis_reg_add(ctx);
- *   int id = h ? h->id : -1;
+ *   // Register and get an id (the registry owns ctx now):
+ *   int64_t id = redis_reg_add(ctx);
  *
  *   // Later look it up:
- *   RedisHandle *same = redis_reg_get(id);
+ *   redisContext *same = redis_reg_get(id);
  *   if (same) {
- *     // use same->ctx with hiredis APIs
+ *     // use same with hiredis APIs
  *   }
  *
- *   // When finished, drop the registry entry and free manually:
+ *   // When finished, drop the registry entry; this calls redisFree():
  *   redis_reg_del(id);
- *   redisFree(ctx);
  * }
  * @endcode
  */
@@ -88,85 +82,45 @@
 /* Forward declarations from the VM (available in the same TU via includes) */
 static Value hiredis_reply_to_value(const redisReply *r);
 
-/**
- * @brief Node in a singly-linked list of registered Redis handles.
- *
- * Associates a monotonically increasing positive integer identifier with a raw
- * hiredis connection pointer. The list head is stored in a file-static global
- * (g_redis_handles).
- */
-typedef struct RedisHandle {
-  int id;                  /**< Positive identifier assigned by the registry. */
-  redisContext *ctx;       /**< Opaque pointer to a hiredis connection. */
-  struct RedisHandle *next;/**< Next entry in the singly-linked list. */
-} RedisHandle;
+/** Destructor of the connection table: free the connection. */
+static void redis_reg_free(void *ctx) {
+  redisFree((redisContext *)ctx);
+}
 
-/** @brief Global head of the Redis handle list (NULL denotes empty list). */
-static RedisHandle *g_redis_handles = NULL;
-/** @brief Next positive identifier to assign to a newly added handle. */
-static int g_redis_next_id = 1;
+/** Open Redis connections by handle id. */
+static FunHandleTable g_redis_handles = FUN_HANDLE_TABLE_INIT(redis_reg_free);
 
 /**
- * @brief Add a hiredis connection handle to the registry.
- *
- * Allocates a new list node, assigns a fresh positive id, and prepends it to
- * the internal registry list. Ownership of the redisContext remains with the
- * caller; this registry does not free it during deletion.
+ * @brief Add a hiredis connection to the registry.
  *
- * @param ctx Valid pointer to an opened hiredis connection.
- * @return Pointer to the newly created RedisHandle on success; NULL on
- *         allocation failure. The returned pointer remains owned by the
- *         registry; do not free it directly.
+ * @param ctx Valid pointer to an opened hiredis connection; the registry takes
+ *            ownership on success.
+ * @return Positive id on success; 0 on allocation failure (the caller still
+ *         owns ctx then).
  */
-static RedisHandle *redis_reg_add(redisContext *ctx) {
-  RedisHandle *h = (RedisHandle *)calloc(1, sizeof(RedisHandle));
-  if (!h) return NULL;
-  h->id = g_redis_next_id++;
-  h->ctx = ctx;
-  h->next = g_redis_handles;
-  g_redis_handles = h;
-  return h;
+static int64_t redis_reg_add(redisContext *ctx) {
+  return fun_handle_new(&g_redis_handles, ctx);
 }
 
 /**
- * @brief Look up a registered Redis handle by id.
- *
- * Performs a linear search over the internal list to find a matching id.
+ * @brief Look up a registered Redis connection by id.
  *
- * @param id Positive identifier previously returned by redis_reg_add().
- * @return Pointer to the RedisHandle entry if found; NULL otherwise.
- *
- * @note The returned pointer is owned by the registry and must not be freed by
- *       the caller.
+ * @param id Id previously returned by redis_reg_add().
+ * @return The connection if the id is live; NULL otherwise.
  */
-static RedisHandle *redis_reg_get(int id) {
-  for (RedisHandle *p = g_redis_handles; p; p = p->next)
-    if (p->id == id) return p;
-  return NULL;
+static redisContext *redis_reg_get(int64_t id) {
+  return (redisContext *)fun_handle_get(&g_redis_handles, id);
 }
 
 /**
- * @brief Remove a Redis handle entry from the registry.
- *
- * Deletes the list node associated with the given id.
- *
- * @param id Positive identifier of the entry to remove.
+ * @brief Remove a connection from the registry and free it.
  *
- * @note This function does not free the underlying redisContext; the caller is
- *       responsible for calling redisFree() if appropriate.
- * @note If the id does not exist, the function is a no-op.
+ * @param id Id of the entry to remove. Unknown or already closed ids are a
+ *           no-op.
+ * @return 1 if a connection was freed; 0 otherwise.
  */
-static void redis_reg_del(int id) {
-  RedisHandle **pp = &g_redis_handles;
-  while (*pp) {
-    if ((*pp)->id == id) {
-      RedisHandle *d = *pp;
-      *pp = d->next;
-      free(d);
-      return;
-    }
-    pp = &(*pp)->next;
-  }
+static int redis_reg_del(int64_t id) {
+  return fun_handle_free(&g_redis_handles, id);
 }
 
 /**
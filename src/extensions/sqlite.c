@@ -26,29 +26,25 @@
  *
  * Ownership and lifetime
  * ----------------------
- * - The registry does NOT open or close databases. It merely stores pointers
- *   that were created elsewhere (e.g., via sqlite3_open()).
- * - Adding an entry does not transfer ownership of the sqlite3 connection.
- *   Callers remain responsible for invoking sqlite3_close() at the appropriate
- *   time.
- * - Removing an entry from the registry does NOT close the connection; it only
- *   forgets the mapping between id and pointer.
- * - Integer identifiers are monotonically increasing per process. Once a handle
- *   id is deleted, it will not be reused within the same process lifetime.
+ * - The registry does NOT open databases; it stores connections that were
+ *   created elsewhere (e.g., via sqlite3_open()).
+ * - Adding an entry transfers ownership of the sqlite3 connection to the
+ *   registry: removing the entry closes it with sqlite3_close().
+ * - Ids are generation-tagged handles from the shared handle table
+ *   (src/handles.c). A closed id stays invalid even when its slot is
+ *   reused, so closing twice or querying a closed handle fails cleanly.
  *
  * Error handling
  * --------------
  * Functions in this module perform only basic validation and memory allocation.
- * Allocation failures return NULL (for lookups/additions) or are silently
- * ignored (for deletions of non-existent ids). No SQLite API calls are made
- * here, so no sqlite error codes are produced by this module itself.
+ * Allocation failures return 0 (for additions) and lookups of unknown ids
+ * return NULL. No SQLite error codes are produced by this module itself.
  *
  * Thread-safety
  * -------------
- * The registry is implemented as a simple singly-linked list with no
- * synchronization. It is NOT thread-safe. If the VM uses SQLite from multiple
- * threads, the caller must provide external synchronization around all calls to
- * these helpers.
+ * The registry is thread-safe (a sharded, mutex-protected table), so
+ * thread_spawn workers can open and use their own connections. A single
+ * connection is only as thread-safe as the SQLite library build.
  *
  * Example
  * -------
@@ -56,117 +52,61 @@
  * // Open a database elsewhere:
  * sqlite3 *db = NULL;
  * if (sqlite3_open(":memory:", &db) == SQLITE_OK) {
- *   // Register and get an id:
- *   SqlHandle *h = sql_reg_add(db);
- *   int id = h ? h->id : -1;
+ *   // Register and get an id (the registry owns db now):
+ *   int64_t id = sql_reg_add(db);
  *
  *   // Later look it up:
- *   SqlHandle *same = sql_reg_get(id);
+ *   sqlite3 *same = sql_reg_get(id);
  *   if (same) {
- *     // use same->db with SQLite APIs
+ *     // use same with SQLite APIs
  *   }
  *
- *   // When finished, drop the registry entry and close manually:
+ *   // When finished, drop the registry entry; this closes the connection:
  *   sql_reg_del(id);
- *   sqlite3_close(db);
  * }
  * @endcode
  */
 #ifdef FUN_WITH_SQLITE
 #include <sqlite3.h>
 
-/**
- * @brief Node in a singly-linked list of registered SQLite handles.
- *
- * Each node associates a monotonically increasing positive integer identifier
- * with a raw sqlite3* pointer. The list head is stored in a file-static global
- * (g_sql_handles).
- */
-typedef struct SqlHandle {
-  int id;                 /**< Positive identifier assigned by the registry. */
-  sqlite3 *db;            /**< Opaque pointer to an opened sqlite3 connection. */
-  struct SqlHandle *next; /**< Next entry in the singly-linked list. */
-} SqlHandle;
+/** Destructor of the connection table: close the connection. */
+static void sql_reg_close(void *db) {
+  sqlite3_close((sqlite3 *)db);
+}
 
-/**
- * @brief Global head of the SQLite handle list.
- *
- * NULL denotes an empty list. The list is modified only by the helpers in this
- * file and is never exposed directly to callers.
- */
-static SqlHandle *g_sql_handles = NULL;
-/**
- * @brief Next positive identifier to assign to a newly added handle.
- *
- * Starts at 1 and increases monotonically. Identifiers are not reused across
- * deletions within a process lifetime.
- */
-static int g_sql_next_id = 1;
+/** Open SQLite connections by handle id. */
+static FunHandleTable g_sql_handles = FUN_HANDLE_TABLE_INIT(sql_reg_close);
 
 /**
- * @brief Add a sqlite3 handle to the registry.
- *
- * Allocates a new list node, assigns a fresh positive id, and prepends it to
- * the internal registry list. Ownership of the sqlite3 connection remains with
- * the caller; this registry does not close the handle during deletion.
- *
- * @param db Valid pointer to an opened sqlite3 connection.
- * @return Pointer to the newly created SqlHandle entry on success; NULL on
- *         allocation failure. The returned pointer remains owned by the
- *         registry; do not free it directly.
+ * @brief Add a sqlite3 connection to the registry.
  *
- * @note This function does not take ownership of the sqlite3 connection in the
- *       sense of closing it; removal from the registry will not call
- *       sqlite3_close().
+ * @param db Valid pointer to an opened sqlite3 connection; the registry takes
+ *           ownership on success.
+ * @return Positive id on success; 0 on allocation failure (the caller still
+ *         owns db then).
  */
-static SqlHandle *sql_reg_add(sqlite3 *db) {
-  SqlHandle *h = (SqlHandle *)calloc(1, sizeof(SqlHandle));
-  if (!h) return NULL;
-  h->id = g_sql_next_id++;
-  h->db = db;
-  h->next = g_sql_handles;
-  g_sql_handles = h;
-  return h;
+static int64_t sql_reg_add(sqlite3 *db) {
+  return fun_handle_new(&g_sql_handles, db);
 }
 
 /**
- * @brief Look up a registered SQLite handle by id.
+ * @brief Look up a registered SQLite connection by id.
  *
- * Performs a linear search over the internal list to find a matching id.
- *
- * @param id Positive identifier previously returned by sql_reg_add().
- * @return Pointer to the SqlHandle entry if found; NULL otherwise.
- *
- * @note The returned pointer is owned by the registry and must not be freed by
- *       the caller.
+ * @param id Id previously returned by sql_reg_add().
+ * @return The connection if the id is live; NULL otherwise.
  */
-static SqlHandle *sql_reg_get(int id) {
-  for (SqlHandle *p = g_sql_handles; p; p = p->next)
-    if (p->id == id) return p;
-  return NULL;
+static sqlite3 *sql_reg_get(int64_t id) {
+  return (sqlite3 *)fun_handle_get(&g_sql_handles, id);
 }
 
 /**
- * @brief Remove a SQLite handle entry from the registry.
- *
- * Deletes the list node associated with the given id.
- *
- * @param id Positive identifier of the entry to remove.
+ * @brief Remove a connection from the registry and close it.
  *
- * @note This function does not close the underlying sqlite3 connection; the
- *       caller is responsible for calling sqlite3_close() if appropriate.
- * @note If the id does not exist, the function is a no-op.
+ * @param id Id of the entry to remove. Unknown or already closed ids are a
+ *           no-op.
+ * @return 1 if a connection was closed; 0 otherwise.
  */
-static void sql_reg_del(int id) {
-  SqlHandle **pp = &g_sql_handles;
-  while (*pp) {
-    if ((*pp)->id == id) {
-      SqlHandle *d = *pp;
-      *pp = d->next;
-      free(d);
-      return;
-    }
-    pp = &(*pp)->next;
-  }
+static int sql_reg_del(int64_t id) {
+  return fun_handle_free(&g_sql_handles, id);
 }
 #endif
@@ -13,10 +13,10 @@
  *
  * Overview
  * --------
- * This translation unit implements compact, fixed-size registries that assign
- * small positive integer handles to libxml2 objects. VM opcodes under
- * src/vm/xml2/*.c and higher-level helpers can exchange these integer handles
- * across the VM stack without exposing raw pointers.
+ * This translation unit assigns small positive integer handles to libxml2
+ * documents and nodes using the shared handle tables (src/handles.c).
+ * VM opcodes under src/vm/xml/*.c and higher-level helpers can exchange these
+ * integer handles across the VM stack without exposing raw pointers.
  *
  * Build-time feature flag
  * -----------------------
@@ -27,207 +27,346 @@
  *
  * Ownership and lifetime
  * ----------------------
- * - Document registry (XmlDocSlot) TAKES OWNERSHIP of the registered xmlDocPtr.
- *   Releasing the document handle will call xmlFreeDoc() for the stored
- *   pointer.
- * - Node registry (XmlNodeSlot) DOES NOT take ownership of xmlNodePtr values.
- *   Nodes are owned by their document. Releasing a node handle only clears the
- *   registry slot; it does not free the underlying xmlNode memory.
- * - When a document is freed, the libxml2 tree below it is destroyed by
- *   libxml2, thereby invalidating any node pointers previously returned from
- *   that document. The small node handle registry in this file does not track
- *   which document owns which node. Callers must ensure they do not use node
- *   handles after their owning document has been released; they should clear
- *   those node handles explicitly if necessary.
- *
- * Limits and handle ranges
- * ------------------------
- * - Document handles are allocated from a fixed-size array of 64 slots. Valid
- *   handles are in the inclusive range [1, 63].
- * - Node handles are allocated from a fixed-size array of 256 slots. Valid
- *   handles are in the inclusive range [1, 255].
- * - The value 0 is reserved and indicates failure or an invalid handle.
- *
- * Error handling
- * --------------
- * - Allocation requests fail with a return value of 0 when no free slot is
- *   available.
- * - Lookups return NULL for invalid or unused handles.
- * - Free functions return 1 when a valid in-use handle was released, and 0
- *   otherwise. Document release also frees the underlying xmlDoc via
- *   xmlFreeDoc(). Node release does not free the xmlNode memory.
- *
- * Thread-safety
- * -------------
- * - The registries are simple, unsynchronized arrays. They are NOT
- *   thread-safe. If the VM uses libxml2 handles across multiple threads,
- *   external synchronization is required around all calls into this module.
+ * - The document table TAKES OWNERSHIP of the registered xmlDocPtr. Releasing
+ *   the document handle calls xmlFreeDoc().
+ * - Node handles DO NOT own their xmlNodePtr; nodes belong to their document.
+ *   A node's handle is remembered in its _private field, so asking for the
+ *   same node again (e.g. xml_root() in a loop) returns the same handle
+ *   instead of using up a new one.
+ * - Releasing a document releases all node handles inside it first, so node
+ *   ids of a freed document become stale instead of dangling.
+ * - Streaming readers (xmlTextReader over a file) live in their own table and
+ *   are freed with xmlFreeTextReader(). A record read from a stream is copied
+ *   into a new, separately owned document.
+ *
+ * XPath
+ * -----
+ * Compiled expressions are cached per thread (xml_xpath_compile()), keyed by
+ * the expression text, together with one reusable evaluation context, so a
+ * query run in a loop is compiled once.
+ *
+ * Handles, errors and threads
+ * ---------------------------
+ * - Handles are generation-tagged ids (> 0) without a fixed limit; 0 means
+ *   failure or an invalid handle. Lookups of freed or stale ids return NULL.
+ * - Free functions return 1 when a live handle was released, 0 otherwise.
+ * - The tables are thread-safe. A node handle is created under a mutex so
+ *   two threads asking for the same node share one handle.
  *
  * Example
  * -------
  * @code{.c}
  * // Assume xmlInitParser() was called by the embedding application.
  * xmlDocPtr d = xmlReadMemory("<root><x/></root>", 20, "-", NULL, 0);
- * int dh = xml_doc_alloc(d);   // takes ownership of d
+ * int64_t dh = xml_doc_alloc(d);   // takes ownership of d
  * xmlDocPtr same = xml_doc_get(dh);
- * // ... use 'same' with libxml2 APIs ...
+ * int64_t rh = xml_node_alloc(xmlDocGetRootElement(same));
  *
- * // When done, free the document handle; this calls xmlFreeDoc(same).
+ * // Freeing the document also releases rh and calls xmlFreeDoc(same).
  * (void)xml_doc_free_handle(dh);
  * @endcode
  */
 #ifdef FUN_WITH_XML2
 #include <libxml/parser.h>
 #include <libxml/tree.h>
+#include <libxml/xmlreader.h>
+#include <libxml/xpath.h>
+#include <libxml/xpathInternals.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __unix__
+#include <pthread.h>
+static pthread_mutex_t g_xml_node_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t g_xml_init_once = PTHREAD_ONCE_INIT;
+#define FUN_XML_NODE_LOCK() pthread_mutex_lock(&g_xml_node_lock)
+#define FUN_XML_NODE_UNLOCK() pthread_mutex_unlock(&g_xml_node_lock)
+#define FUN_XML_TLS __thread
+#else
+#define FUN_XML_NODE_LOCK() ((void)0)
+#define FUN_XML_NODE_UNLOCK() ((void)0)
+#define FUN_XML_TLS
+#endif
+
+/** Initialize libxml2 once per process (before the first parse or reader). */
+static void xml_init(void) {
+#ifdef __unix__
+  pthread_once(&g_xml_init_once, xmlInitParser);
+#else
+  static int inited = 0;
+  if (!inited) {
+    xmlInitParser();
+    inited = 1;
+  }
+#endif
+}
+
+static void xml_doc_release(void *ptr);
+
+/** Document handles; the destructor releases the document's nodes and frees it. */
+static FunHandleTable g_xml_docs = FUN_HANDLE_TABLE_INIT(xml_doc_release);
+/** Node handles; nodes are owned by their document, so there is no destructor. */
+static FunHandleTable g_xml_nodes = FUN_HANDLE_TABLE_INIT(NULL);
 
 /**
- * @brief Slot describing a registered XML document.
+ * @brief Allocate a document handle for the given xmlDoc pointer.
  *
- * The registry owns the xmlDocPtr and will free it when the handle is released
- * via xml_doc_free_handle().
- */
-typedef struct {
-  xmlDocPtr doc; /**< Pointer to a parsed libxml2 document (owned by registry). */
-  int in_use;    /**< Non-zero if the slot is occupied. */
-} XmlDocSlot;
-/**
- * @brief Slot describing a registered XML node.
+ * Ownership is transferred to the registry; releasing the handle will call
+ * xmlFreeDoc() for the stored pointer.
  *
- * The registry does not own the node; it is managed by its document. Releasing
- * a node handle does not free the node memory.
+ * @param d Valid xmlDocPtr to register.
+ * @return Positive handle on success; 0 if d is NULL or on allocation failure
+ *         (the caller still owns d then).
  */
-typedef struct {
-  xmlNodePtr node; /**< Pointer to a node in some document (not owned). */
-  int in_use;      /**< Non-zero if the slot is occupied. */
-} XmlNodeSlot;
-
+static int64_t xml_doc_alloc(xmlDocPtr d) {
+  return fun_handle_new(&g_xml_docs, d);
+}
 /**
- * @brief Fixed-size registry storage for documents.
+ * @brief Retrieve a registered xmlDoc by handle.
  *
- * Index 0 is reserved. Valid document handle indices are in [1, 63].
+ * @param h Handle previously returned by xml_doc_alloc().
+ * @return xmlDocPtr if the handle is live; NULL otherwise.
  */
-static XmlDocSlot g_xml_docs[64];
+static xmlDocPtr xml_doc_get(int64_t h) {
+  return (xmlDocPtr)fun_handle_get(&g_xml_docs, h);
+}
 /**
- * @brief Fixed-size registry storage for nodes.
+ * @brief Free a document handle, its node handles and the underlying xmlDoc.
  *
- * Index 0 is reserved. Valid node handle indices are in [1, 255].
+ * @param h Handle to release.
+ * @return 1 if the handle was live and has been released; 0 otherwise.
  */
-static XmlNodeSlot g_xml_nodes[256];
+static int xml_doc_free_handle(int64_t h) {
+  return fun_handle_free(&g_xml_docs, h);
+}
 
 /**
- * @brief Allocate a document handle for the given xmlDoc pointer.
+ * @brief Get the handle of a node, allocating one on first use.
  *
- * Allocates a free slot in the document registry and stores the supplied
- * xmlDocPtr. Ownership is transferred to the registry; releasing the handle
- * will call xmlFreeDoc() for the stored pointer.
+ * The handle is cached in n->_private, so repeated calls for the same node
+ * return the same id. Ownership is not transferred; the node stays valid as
+ * long as its document.
  *
- * @param d Valid xmlDocPtr to register. The caller must not free the document
- *          directly after a successful registration.
- * @return Positive handle in the range [1, 63] on success; 0 if no slot is
- *         available.
- *
- * @note Passing NULL is undefined behavior for this helper in the sense that
- *       it will simply not find a slot and return 0 if no slot is free; callers
- *       should validate inputs before calling.
+ * @param n Valid xmlNodePtr inside a registered document.
+ * @return Positive handle on success; 0 on allocation failure.
  */
-static int xml_doc_alloc(xmlDocPtr d) {
-  for (int i = 1; i < (int)(sizeof(g_xml_docs) / sizeof(g_xml_docs[0])); ++i) {
-    if (!g_xml_docs[i].in_use) {
-      g_xml_docs[i].in_use = 1;
-      g_xml_docs[i].doc = d;
-      return i;
-    }
+static int64_t xml_node_alloc(xmlNodePtr n) {
+  if (!n) return 0;
+  FUN_XML_NODE_LOCK();
+  int64_t h = (int64_t)(intptr_t)n->_private;
+  if (h <= 0 || fun_handle_get(&g_xml_nodes, h) != n) {
+    h = fun_handle_new(&g_xml_nodes, n);
+    n->_private = (void *)(intptr_t)h;
   }
-  return 0;
+  FUN_XML_NODE_UNLOCK();
+  return h;
 }
 /**
- * @brief Retrieve a registered xmlDoc by handle.
- *
- * Performs bounds and state checks on the registry and returns the stored
- * xmlDocPtr for the handle if present.
+ * @brief Retrieve a registered xmlNode by handle.
  *
- * @param h Handle previously returned by xml_doc_alloc().
- * @return xmlDocPtr if the handle is valid and in use; NULL otherwise.
+ * @param h Handle previously returned by xml_node_alloc().
+ * @return xmlNodePtr if the handle is live; NULL otherwise.
  */
-static xmlDocPtr xml_doc_get(int h) {
-  if (h > 0 && h < (int)(sizeof(g_xml_docs) / sizeof(g_xml_docs[0])) && g_xml_docs[h].in_use) return g_xml_docs[h].doc;
-  return NULL;
+static xmlNodePtr xml_node_get(int64_t h) {
+  return (xmlNodePtr)fun_handle_get(&g_xml_nodes, h);
+}
+
+/** Release the node handles cached in the sibling list starting at first and
+ *  everything below it (iterative walk; attributes are visited as well). */
+static void xml_release_nodes(xmlNodePtr first) {
+  if (!first) return;
+  xmlNodePtr stop = first->parent;
+  xmlNodePtr n = first;
+  while (n) {
+    if (n->_private) {
+      fun_handle_free(&g_xml_nodes, (int64_t)(intptr_t)n->_private);
+      n->_private = NULL;
+    }
+    if (n->type == XML_ELEMENT_NODE && n->properties) xml_release_nodes((xmlNodePtr)n->properties);
+    if (n->children && n->type != XML_ENTITY_REF_NODE) {
+      n = n->children;
+      continue;
+    }
+    while (n && !n->next) {
+      n = n->parent;
+      if (n == stop) return;
+    }
+    if (!n) return;
+    n = n->next;
+  }
+}
+
+/** Destructor of the document table: drop the document's node handles, then free it. */
+static void xml_doc_release(void *ptr) {
+  xmlDocPtr doc = (xmlDocPtr)ptr;
+  FUN_XML_NODE_LOCK();
+  xml_release_nodes(doc->children);
+  FUN_XML_NODE_UNLOCK();
+  xmlFreeDoc(doc);
 }
+
+/** Whether a node found by navigation or XPath can be given a handle (its
+ *  struct starts with the common _private/type/name/children header). */
+static int xml_node_handleable(xmlNodePtr n) {
+  if (!n) return 0;
+  switch (n->type) {
+  case XML_ELEMENT_NODE:
+  case XML_ATTRIBUTE_NODE:
+  case XML_TEXT_NODE:
+  case XML_CDATA_SECTION_NODE:
+  case XML_COMMENT_NODE:
+  case XML_PI_NODE:
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+#define FUN_XML_XPATH_CACHE 64
+
+typedef struct {
+  char *expr;
+  xmlXPathCompExprPtr comp;
+} XmlXPathCacheEntry;
+
+static FUN_XML_TLS XmlXPathCacheEntry g_xpath_cache[FUN_XML_XPATH_CACHE];
+static FUN_XML_TLS xmlXPathContextPtr g_xpath_ctx;
+
+/** Structured error handler that drops XPath errors; callers report them as Nil.
+ *  (The handler's error argument is const only in newer libxml2, hence the
+ *  cast where it is installed.) */
+static void xml_xpath_silent(void *data, xmlErrorPtr err) {
+  (void)data;
+  (void)err;
+}
+
 /**
- * @brief Free a document handle and the underlying xmlDoc.
+ * @brief Evaluation context of the calling thread, pointed at node.
  *
- * If the handle is valid and in use, calls xmlFreeDoc() for the stored
- * document pointer, clears the slot, and returns 1.
+ * Registered namespaces are left to the caller, which must clear them with
+ * xmlXPathRegisteredNsCleanup() after evaluating.
  *
- * @param h Handle to release.
- * @return 1 if the handle was valid and has been released; 0 otherwise.
- *
- * @note Freeing a document invalidates any xmlNodePtr previously obtained from
- *       that document. The node registry in this file does not automatically
- *       clear entries that reference nodes from the freed document; callers are
- *       responsible for avoiding use-after-free by releasing or ignoring such
- *       node handles.
+ * @return The reusable context, or NULL on allocation failure.
  */
-static int xml_doc_free_handle(int h) {
-  if (h <= 0 || h >= (int)(sizeof(g_xml_docs) / sizeof(g_xml_docs[0])) || !g_xml_docs[h].in_use) return 0;
-  if (g_xml_docs[h].doc) xmlFreeDoc(g_xml_docs[h].doc);
-  g_xml_docs[h].doc = NULL;
-  g_xml_docs[h].in_use = 0;
-  return 1;
+static xmlXPathContextPtr xml_xpath_context(xmlNodePtr node) {
+  if (!g_xpath_ctx) {
+    g_xpath_ctx = xmlXPathNewContext(node->doc);
+    if (!g_xpath_ctx) return NULL;
+    g_xpath_ctx->error = (xmlStructuredErrorFunc)xml_xpath_silent;
+    /* reuse temporary XPath objects between evaluations */
+    xmlXPathContextSetCache(g_xpath_ctx, 1, -1, 0);
+  }
+  g_xpath_ctx->doc = node->doc;
+  g_xpath_ctx->node = node;
+  return g_xpath_ctx;
 }
 
 /**
- * @brief Allocate a node handle for the given xmlNode pointer.
+ * @brief Compile an XPath expression, or return the cached compilation.
  *
- * Allocates a free slot in the node registry and stores the supplied pointer.
- * Ownership is not transferred; the memory is managed by the owning document.
+ * The cache is direct-mapped by a hash of the expression text and private to
+ * the calling thread; a colliding expression replaces the old entry.
  *
- * @param n Valid xmlNodePtr to register. Must remain valid for as long as the
- *          handle is in use and the owning document is alive.
- * @return Positive handle in the range [1, 255] on success; 0 if no slot is
- *         available.
+ * @return Compiled expression owned by the cache, or NULL if expr is invalid.
  */
-static int xml_node_alloc(xmlNodePtr n) {
-  for (int i = 1; i < (int)(sizeof(g_xml_nodes) / sizeof(g_xml_nodes[0])); ++i) {
-    if (!g_xml_nodes[i].in_use) {
-      g_xml_nodes[i].in_use = 1;
-      g_xml_nodes[i].node = n;
-      return i;
-    }
+static xmlXPathCompExprPtr xml_xpath_compile(xmlXPathContextPtr ctx, const char *expr) {
+  uint32_t hash = 2166136261u;
+  for (const unsigned char *p = (const unsigned char *)expr; *p; ++p)
+    hash = (hash ^ *p) * 16777619u;
+  XmlXPathCacheEntry *e = &g_xpath_cache[hash % FUN_XML_XPATH_CACHE];
+  if (e->expr && strcmp(e->expr, expr) == 0) return e->comp;
+  xmlXPathCompExprPtr comp = xmlXPathCtxtCompile(ctx, (const xmlChar *)expr);
+  if (!comp) return NULL;
+  char *key = strdup(expr);
+  if (!key) {
+    xmlXPathFreeCompExpr(comp);
+    return NULL;
   }
-  return 0;
+  if (e->comp) xmlXPathFreeCompExpr(e->comp);
+  free(e->expr);
+  e->expr = key;
+  e->comp = comp;
+  return comp;
 }
+
+/** A streaming reader; pending means the current node has not been returned yet. */
+typedef struct {
+  xmlTextReaderPtr reader;
+  int pending;
+} XmlReader;
+
+static void xml_reader_release(void *ptr) {
+  XmlReader *xr = (XmlReader *)ptr;
+  xmlFreeTextReader(xr->reader);
+  free(xr);
+}
+
+/** Streaming reader handles; the destructor closes the reader. */
+static FunHandleTable g_xml_readers = FUN_HANDLE_TABLE_INIT(xml_reader_release);
+
 /**
- * @brief Retrieve a registered xmlNode by handle.
+ * @brief Open a streaming reader over a file.
  *
- * Performs bounds and state checks on the registry and returns the stored
- * xmlNodePtr for the handle if present.
+ * The file is read incrementally; memory use depends on the size of the
+ * records consumed, not of the document.
  *
- * @param h Handle previously returned by xml_node_alloc().
- * @return xmlNodePtr if the handle is valid and in use; NULL otherwise.
+ * @return Positive reader handle, or 0 if the file cannot be opened.
  */
-static xmlNodePtr xml_node_get(int h) {
-  if (h > 0 && h < (int)(sizeof(g_xml_nodes) / sizeof(g_xml_nodes[0])) && g_xml_nodes[h].in_use) return g_xml_nodes[h].node;
-  return NULL;
+static int64_t xml_reader_open(const char *path) {
+  xml_init();
+  xmlTextReaderPtr r = xmlReaderForFile(path, NULL, XML_PARSE_NONET);
+  if (!r) return 0;
+  XmlReader *xr = (XmlReader *)calloc(1, sizeof(*xr));
+  int64_t h = 0;
+  if (xr) {
+    xr->reader = r;
+    h = fun_handle_new(&g_xml_readers, xr);
+  }
+  if (!h) {
+    xmlFreeTextReader(r);
+    free(xr);
+  }
+  return h;
+}
+
+static XmlReader *xml_reader_get(int64_t h) {
+  return (XmlReader *)fun_handle_get(&g_xml_readers, h);
 }
+
+/** Move to the next node; returns 1 while positioned on a node, 0 at the end or on error. */
+static int xml_reader_advance(XmlReader *xr) {
+  if (xr->pending) {
+    xr->pending = 0;
+    return 1;
+  }
+  return xmlTextReaderRead(xr->reader) == 1;
+}
+
 /**
- * @brief Free a node handle without freeing the underlying node.
- *
- * Clears the registry slot associated with the given handle. The underlying
- * xmlNode memory is not freed because nodes are owned by their document.
- *
- * @param h Handle to release.
- * @return 1 if the handle was valid and has been released; 0 otherwise.
+ * @brief Copy the next element called name (qualified or local) out of the
+ * stream into its own document and skip past it.
  *
- * @note Releasing or freeing a document invalidates any nodes originating from
- *       that document. Callers should avoid using node handles after their
- *       document has been released.
+ * @return A new document (owned by the caller), or NULL at the end of input.
  */
-static int xml_node_free_handle(int h) {
-  if (h <= 0 || h >= (int)(sizeof(g_xml_nodes) / sizeof(g_xml_nodes[0])) || !g_xml_nodes[h].in_use) return 0;
-  /* nodes are owned by their document; do not free here */
-  g_xml_nodes[h].node = NULL;
-  g_xml_nodes[h].in_use = 0;
-  return 1;
+static xmlDocPtr xml_reader_record(XmlReader *xr, const char *name) {
+  while (xml_reader_advance(xr)) {
+    if (xmlTextReaderNodeType(xr->reader) != XML_READER_TYPE_ELEMENT) continue;
+    const char *qn = (const char *)xmlTextReaderConstName(xr->reader);
+    const char *ln = (const char *)xmlTextReaderConstLocalName(xr->reader);
+    if (!(qn && strcmp(qn, name) == 0) && !(ln && strcmp(ln, name) == 0)) continue;
+    xmlNodePtr n = xmlTextReaderExpand(xr->reader);
+    if (!n) return NULL;
+    xmlDocPtr doc = xmlNewDoc((const xmlChar *)"1.0");
+    xmlNodePtr copy = doc ? xmlDocCopyNode(n, doc, 1) : NULL;
+    if (!copy) {
+      if (doc) xmlFreeDoc(doc);
+      return NULL;
+    }
+    xmlDocSetRootElement(doc, copy);
+    /* skip the subtree; Next() leaves the reader on the following node */
+    if (xmlTextReaderNext(xr->reader) == 1) xr->pending = 1;
+    return doc;
+  }
+  return NULL;
 }
-#endif
+#endif
\ No newline at end of file
@@ -43,29 +43,81 @@ static void print_usage(const char *prog) {
   printf("Fun %s\n", FUN_VERSION);
   printf("Usage:\n");
 #ifdef FUN_WITH_REPL
-  printf("  %s [--trace|-t] [--repl-on-error] [script.fun]\n", prog ? prog : "fun");
+  printf("  %s [--trace|-t] [--profile [--profile-out <file>]] [--repl-on-error] [script.fun|script.func]\n", prog ? prog : "fun");
+  printf("  %s --compile|-c <script.fun> [-o <script.func>]\n", prog ? prog : "fun");
   printf("  %s --help | -h\n", prog ? prog : "fun");
   printf("  %s --version | -V\n", prog ? prog : "fun");
   printf("\n");
   printf("Options:\n");
   printf("  --trace, -t       Print executed ops and stack tops during run\n");
-  printf("  --repl-on-error   Enter interactive REPL on runtime error with stack preserved\n\n");
+  printf("  --profile         Print a profile of calls, time and hot lines to stderr after the run\n");
+  printf("  --profile-out <f> Collapsed stacks for flame graphs (default: fun.folded)\n");
+  printf("  --repl-on-error   Enter interactive REPL on runtime error with stack preserved\n");
+  printf("  --compile, -c     Compile the script to bytecode and write it instead of running\n");
+  printf("  -o <file>         Output path for --compile (default: script name with .func)\n\n");
   printf("When no script is provided, a REPL starts. Submit an empty line to execute the buffer.\n");
 #else
-  printf("  %s [--trace|-t] <script.fun>\n", prog ? prog : "fun");
+  printf("  %s [--trace|-t] [--profile [--profile-out <file>]] <script.fun|script.func>\n", prog ? prog : "fun");
+  printf("  %s --compile|-c <script.fun> [-o <script.func>]\n", prog ? prog : "fun");
   printf("  %s --help | -h\n", prog ? prog : "fun");
   printf("  %s --version | -V\n", prog ? prog : "fun");
   printf("\n");
-  printf("Options:\n  --trace, -t   Print executed ops and stack tops during run\n\n");
+  printf("Options:\n");
+  printf("  --trace, -t       Print executed ops and stack tops during run\n");
+  printf("  --profile         Print a profile of calls, time and hot lines to stderr after the run\n");
+  printf("  --profile-out <f> Collapsed stacks for flame graphs (default: fun.folded)\n");
+  printf("  --compile, -c     Compile the script to bytecode and write it instead of running\n");
+  printf("  -o <file>         Output path for --compile (default: script name with .func)\n\n");
   printf("REPL is disabled in this build. Please provide a script file to run.\n");
 #endif
 }
 
+/**
+ * @brief Compile a script and write its bytecode to a .func file.
+ *
+ * When out_path is NULL the output name is derived from the source path by
+ * replacing a trailing ".fun" with ".func" (or appending ".func").
+ *
+ * @param src_path Script to compile.
+ * @param out_path Destination file, or NULL for the default name.
+ * @return Process exit code: 0 on success, 1 on failure.
+ */
+static int compile_to_file(const char *src_path, const char *out_path) {
+  char *derived = NULL;
+  if (!out_path) {
+    size_t n = strlen(src_path);
+    derived = (char *)malloc(n + 6);
+    if (!derived) {
+      fprintf(stderr, "Error: out of memory\n");
+      return 1;
+    }
+    memcpy(derived, src_path, n + 1);
+    if (n >= 4 && strcmp(derived + n - 4, ".fun") == 0) {
+      strcpy(derived + n - 4, ".func");
+    } else {
+      strcpy(derived + n, ".func");
+    }
+    out_path = derived;
+  }
+
+  int rc = 1;
+  Bytecode *bc = parse_file_to_bytecode(src_path);
+  if (!bc) {
+    fprintf(stderr, "Failed to compile script: %s\n", src_path);
+  } else if (bytecode_save_file(bc, out_path)) {
+    rc = 0;
+  }
+  bytecode_free(bc);
+  free(derived);
+  return rc;
+}
+
 /**
  * @brief Program entry point for the Fun interpreter.
  *
  * Parses CLI options, compiles and runs a script file if provided, or launches
- * the REPL when enabled and no script is given. Exposes script arguments to
+ * the REPL when enabled and no script is given. Scripts starting with the
+ * .func magic are loaded as precompiled bytecode instead of parsed. Exposes script arguments to
  * the program via FUN_ARGC/FUN_ARGV_i/FUN_ARGS environment variables.
  *
  * @param argc Argument count.
@@ -79,6 +131,11 @@ int main(int argc, char **argv) {
   VM vm;
   vm_init(&vm);
 
+  int compile_only = 0;
+  const char *compile_out = NULL;
+  int profile = 0;
+  const char *profile_out = "fun.folded";
+
   int argi = 1;
   for (; argi < argc; ++argi) {
     const char *arg = argv[argi];
@@ -94,6 +151,31 @@ int main(int argc, char **argv) {
       vm.trace_enabled = 1;
       continue;
     }
+    if (strcmp(arg, "--profile") == 0) {
+      profile = 1;
+      continue;
+    }
+    if (strcmp(arg, "--profile-out") == 0) {
+      if (argi + 1 >= argc) {
+        fprintf(stderr, "Error: --profile-out requires an output path\n");
+        return 2;
+      }
+      profile_out = argv[++argi];
+      profile = 1;
+      continue;
+    }
+    if (strcmp(arg, "--compile") == 0 || strcmp(arg, "-c") == 0) {
+      compile_only = 1;
+      continue;
+    }
+    if (strcmp(arg, "-o") == 0) {
+      if (argi + 1 >= argc) {
+        fprintf(stderr, "Error: -o requires an output path\n");
+        return 2;
+      }
+      compile_out = argv[++argi];
+      continue;
+    }
 #ifdef FUN_WITH_REPL
     if (strcmp(arg, "--repl-on-error") == 0) {
       vm.repl_on_error = 1;
@@ -105,6 +187,25 @@ int main(int argc, char **argv) {
     break;
   }
 
+  if (compile_out && !compile_only) {
+    fprintf(stderr, "Error: -o is only valid with --compile\n");
+    print_usage(argv[0]);
+    return 2;
+  }
+
+  if (compile_only) {
+    if (argi >= argc) {
+      fprintf(stderr, "Error: --compile requires a script path\n");
+      print_usage(argv[0]);
+      return 2;
+    }
+    /* allow "-o out" after the script path as well */
+    if (!compile_out && argi + 2 < argc && strcmp(argv[argi + 1], "-o") == 0) {
+      compile_out = argv[argi + 2];
+    }
+    return compile_to_file(argv[argi], compile_out);
+  }
+
 #ifndef FUN_WITH_REPL
   if (argi >= argc) {
     fprintf(stderr, "Error: REPL is disabled. Please provide a script to run.\n");
@@ -170,15 +271,21 @@ int main(int argc, char **argv) {
       setenv("FUN_ARGS", "", 1);
     }
 
-    Bytecode *bc = parse_file_to_bytecode(path);
+    Bytecode *bc = bytecode_file_is_compiled(path) ? bytecode_load_file(path)
+                                                   : parse_file_to_bytecode(path);
     if (!bc) {
       fprintf(stderr, "Failed to compile script: %s\n", path);
       return 1;
     }
 
+    if (profile && !vm_profile_start(&vm, profile_out)) fprintf(stderr, "Warning: cannot start the profiler\n");
     vm_run(&vm, bc);
     vm_print_output(&vm);
     vm_clear_output(&vm);
+    if (vm.profile) {
+      fflush(stdout);
+      vm_profile_report(&vm, stderr);
+    }
     bytecode_free(bc);
     return vm.exit_code;
   }
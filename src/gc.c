@@ -0,0 +1,378 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file gc.c
+ * @brief Trial-deletion cycle collector (see gc.h).
+ *
+ * Compiled into value.c, which owns struct Array; maps and sets are walked
+ * through map_gc_visit() and emptied with map_gc_clear() from map.c.
+ *
+ * A collection works on the candidate roots buffered since the last one:
+ *   1. mark gray: walk each candidate's subgraph once, subtracting one
+ *      reference from a container for every edge that points to it;
+ *   2. scan: a gray container whose count is still above zero is referenced
+ *      from outside the subgraph, so it and everything it reaches turn black
+ *      again (restoring their counts); the rest turn white;
+ *   3. collect: white containers are garbage. Their counts are restored, each
+ *      is held once, emptied (dropping the references inside the cycle through
+ *      the normal free_value() path) and released.
+ * The walks use an explicit stack, so long chains do not recurse.
+ *
+ * Only the mark gray walk allocates: it reserves room for a container's
+ * children before subtracting any of them, and afterwards the stack and the
+ * garbage list are sized for the whole subgraph, so the later phases cannot
+ * fail half way. When an allocation fails the collection is aborted: the
+ * subtractions are undone, the candidates go back into the buffer for the
+ * next try and gc_collect() returns -1.
+ */
+
+#include "gc.h"
+#include <limits.h>
+#include <time.h>
+
+#define GC_THRESHOLD 10000       /* container allocations between collections */
+#define GC_THRESHOLD_MAX 1048576 /* limit when collections keep finding nothing */
+
+enum { GC_BLACK, GC_GRAY, GC_WHITE };
+
+typedef struct {
+  GcHeader **items;
+  int count;
+  int cap;
+} GcVec;
+
+__thread int gc_pending = 0;
+static __thread GcVec g_gc_roots;
+static __thread GcVec g_gc_stack;
+static __thread GcVec g_gc_garbage;
+static __thread GcStats g_gc_stats;
+static __thread int g_gc_allocs = 0;
+static __thread int g_gc_threshold = GC_THRESHOLD;
+static __thread int64_t g_gc_marked; /* containers turned gray in this collection */
+static __thread int64_t g_gc_edges;  /* references subtracted in this collection */
+static __thread int g_gc_children;   /* result of gc_visit_count */
+
+/* Make room for at least n items; 0 on allocation failure or overflow */
+static int gc_vec_reserve(GcVec *v, int64_t n) {
+  if (n <= v->cap) return 1;
+  if (n > INT_MAX) return 0;
+  int64_t cap = v->cap ? v->cap : 256;
+  while (cap < n)
+    cap *= 2;
+  if (cap > INT_MAX) cap = INT_MAX;
+  GcHeader **items = (GcHeader **)realloc(v->items, sizeof(GcHeader *) * (size_t)cap);
+  if (!items) return 0;
+  v->items = items;
+  v->cap = (int)cap;
+  return 1;
+}
+
+static int gc_vec_push(GcVec *v, GcHeader *h) {
+  if (v->count == v->cap && !gc_vec_reserve(v, (int64_t)v->count + 1)) return 0;
+  v->items[v->count++] = h;
+  return 1;
+}
+
+static void gc_vec_free(GcVec *v) {
+  free(v->items);
+  v->items = NULL;
+  v->count = v->cap = 0;
+}
+
+void gc_header_init(GcHeader *h, int kind) {
+  h->refcount = 1;
+  h->kind = (unsigned char)kind;
+  h->color = GC_BLACK;
+  h->root = -1;
+  if (++g_gc_allocs >= g_gc_threshold) gc_pending = 1;
+}
+
+void gc_possible_root(GcHeader *h) {
+  /* sets hold only strings, numbers and booleans: never part of a cycle */
+  if (h->root >= 0 || h->kind == GC_SET) return;
+  if (!gc_vec_push(&g_gc_roots, h)) return;
+  h->root = g_gc_roots.count - 1;
+}
+
+void gc_forget(GcHeader *h) {
+  int i = h->root;
+  h->root = -1;
+  /* the check keeps a header buffered by another thread's VM harmless */
+  if (i < 0 || i >= g_gc_roots.count || g_gc_roots.items[i] != h) return;
+  GcHeader *last = g_gc_roots.items[--g_gc_roots.count];
+  if (last != h) {
+    g_gc_roots.items[i] = last;
+    last->root = i;
+  }
+}
+
+void gc_drop_roots(void) {
+  for (int i = 0; i < g_gc_roots.count; ++i)
+    g_gc_roots.items[i]->root = -1;
+  gc_vec_free(&g_gc_roots);
+  gc_vec_free(&g_gc_stack);
+  gc_vec_free(&g_gc_garbage);
+}
+
+typedef void (*GcVisit)(GcHeader *child);
+
+/* Call visit for each array, map or set directly referenced by h */
+static void gc_children(GcHeader *h, GcVisit visit) {
+  if (h->kind == GC_ARRAY) {
+    Array *a = (Array *)h;
+    for (int i = 0; i < a->count; ++i) {
+      Value v = slot_view(a->items[i]);
+      if (v.type == VAL_ARRAY && v.arr) {
+        visit((GcHeader *)v.arr);
+      } else if ((v.type == VAL_MAP || v.type == VAL_SET) && v.map) {
+        visit((GcHeader *)v.map);
+      }
+    }
+  } else if (h->kind == GC_MAP) {
+    map_gc_visit((struct Map *)h, visit);
+  }
+}
+
+static void gc_visit_count(GcHeader *c) {
+  (void)c;
+  g_gc_children++;
+}
+
+/* The stack has room for every child (see gc_mark_gray), so the push cannot fail */
+static void gc_visit_gray(GcHeader *c) {
+  c->refcount--;
+  g_gc_edges++;
+  if (c->color != GC_GRAY) {
+    c->color = GC_GRAY;
+    g_gc_marked++;
+    gc_vec_push(&g_gc_stack, c);
+  }
+}
+
+/* Undo gc_visit_gray for an edge out of a container that was walked */
+static void gc_visit_ungray(GcHeader *c) {
+  c->refcount++;
+  if (c->color == GC_GRAY) {
+    c->color = GC_BLACK;
+    gc_vec_push(&g_gc_stack, c);
+  } else {
+    c->color = GC_BLACK; /* GC_WHITE: grayed, but its own edges were not walked */
+  }
+}
+
+static void gc_visit_black(GcHeader *c) {
+  c->refcount++;
+  if (c->color != GC_BLACK) {
+    c->color = GC_BLACK;
+    gc_vec_push(&g_gc_stack, c);
+  }
+}
+
+static void gc_visit_scan(GcHeader *c) {
+  if (c->color == GC_GRAY) gc_vec_push(&g_gc_stack, c);
+}
+
+static void gc_visit_white(GcHeader *c) {
+  if (c->color == GC_WHITE) {
+    c->color = GC_BLACK;
+    gc_vec_push(&g_gc_garbage, c);
+    gc_vec_push(&g_gc_stack, c);
+  }
+}
+
+static void gc_visit_restore(GcHeader *c) {
+  c->refcount++;
+}
+
+/* Run visit over the subgraphs of the nodes on the work stack */
+static void gc_drain(GcVisit visit) {
+  while (g_gc_stack.count > 0) {
+    GcHeader *h = g_gc_stack.items[--g_gc_stack.count];
+    gc_children(h, visit);
+  }
+}
+
+/*
+ * Mark gray the subgraph of root. Before a container's edges are subtracted,
+ * the stack is grown to hold all of its children; if that fails, the
+ * container stays on the stack unwalked and 0 is returned.
+ */
+static int gc_mark_gray(GcHeader *root) {
+  if (!gc_vec_push(&g_gc_stack, root)) return 0;
+  root->color = GC_GRAY;
+  g_gc_marked++;
+  while (g_gc_stack.count > 0) {
+    GcHeader *h = g_gc_stack.items[g_gc_stack.count - 1];
+    int bound;
+    if (h->kind == GC_ARRAY) {
+      bound = ((Array *)h)->count;
+    } else {
+      g_gc_children = 0;
+      gc_children(h, gc_visit_count);
+      bound = g_gc_children;
+    }
+    if (!gc_vec_reserve(&g_gc_stack, (int64_t)g_gc_stack.count + bound)) return 0;
+    g_gc_stack.count--;
+    gc_children(h, gc_visit_gray);
+  }
+  return 1;
+}
+
+/*
+ * Abort a collection during or right after the mark gray phase. Gray
+ * containers still on the stack were never walked; the others had their edges
+ * subtracted. Walking the walked ones again in the same order restores the
+ * counts and needs no more stack than the mark gray walk had. The candidates
+ * go back into the (still empty) buffer.
+ */
+static void gc_abort(GcVec *roots) {
+  for (int i = 0; i < g_gc_stack.count; ++i)
+    g_gc_stack.items[i]->color = GC_WHITE;
+  g_gc_stack.count = 0;
+  for (int i = 0; i < roots->count; ++i) {
+    GcHeader *h = roots->items[i];
+    if (h->color == GC_GRAY) {
+      h->color = GC_BLACK;
+      gc_vec_push(&g_gc_stack, h);
+      gc_drain(gc_visit_ungray);
+    } else {
+      h->color = GC_BLACK;
+    }
+  }
+  gc_vec_free(&g_gc_stack);
+
+  gc_vec_free(&g_gc_roots);
+  g_gc_roots = *roots;
+  for (int i = 0; i < g_gc_roots.count; ++i)
+    g_gc_roots.items[i]->root = i;
+  g_gc_stats.aborted++;
+}
+
+static void gc_scan(GcHeader *root) {
+  gc_vec_push(&g_gc_stack, root);
+  while (g_gc_stack.count > 0) {
+    GcHeader *h = g_gc_stack.items[--g_gc_stack.count];
+    if (h->color != GC_GRAY) continue;
+    if (h->refcount > 0) {
+      /* referenced from outside: h and everything it reaches stay alive */
+      int base = g_gc_stack.count;
+      h->color = GC_BLACK;
+      gc_vec_push(&g_gc_stack, h);
+      while (g_gc_stack.count > base) {
+        GcHeader *b = g_gc_stack.items[--g_gc_stack.count];
+        gc_children(b, gc_visit_black);
+      }
+    } else {
+      h->color = GC_WHITE;
+      gc_children(h, gc_visit_scan);
+    }
+  }
+}
+
+static double gc_now_ms(void) {
+#if defined(CLOCK_MONOTONIC) && !defined(_WIN32)
+  struct timespec ts;
+  if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+#endif
+  return (double)clock() * 1000.0 / CLOCKS_PER_SEC;
+}
+
+int gc_collect(void) {
+  gc_pending = 0;
+  g_gc_allocs = 0;
+  if (g_gc_roots.count == 0) return 0;
+  double t0 = gc_now_ms();
+
+  /* take the candidates; frees during the collection buffer new ones */
+  GcVec roots = g_gc_roots;
+  g_gc_roots.items = NULL;
+  g_gc_roots.count = g_gc_roots.cap = 0;
+  for (int i = 0; i < roots.count; ++i)
+    roots.items[i]->root = -1;
+
+  g_gc_marked = g_gc_edges = 0;
+  int ok = 1;
+  for (int i = 0; ok && i < roots.count; ++i) {
+    if (roots.items[i]->color != GC_GRAY) ok = gc_mark_gray(roots.items[i]);
+  }
+  /*
+   * Scan pushes each root once, each gray child of a container turning white
+   * once per edge and each container turning black once; the white phase
+   * pushes every garbage container once onto the stack and the garbage list.
+   */
+  if (ok) ok = gc_vec_reserve(&g_gc_stack, g_gc_edges + 2 * g_gc_marked) && gc_vec_reserve(&g_gc_garbage, g_gc_marked);
+  if (!ok) {
+    gc_abort(&roots);
+    return -1;
+  }
+  for (int i = 0; i < roots.count; ++i)
+    gc_scan(roots.items[i]);
+  for (int i = 0; i < roots.count; ++i) {
+    GcHeader *h = roots.items[i];
+    if (h->color != GC_WHITE) continue;
+    h->color = GC_BLACK;
+    gc_vec_push(&g_gc_garbage, h);
+    gc_vec_push(&g_gc_stack, h);
+    gc_drain(gc_visit_white);
+  }
+
+  /* undo the subtractions for edges out of garbage, then free it normally */
+  int n = g_gc_garbage.count;
+  GcHeader **garbage = g_gc_garbage.items;
+  for (int i = 0; i < n; ++i) {
+    gc_children(garbage[i], gc_visit_restore);
+    garbage[i]->refcount++;
+  }
+  for (int i = 0; i < n; ++i) {
+    if (garbage[i]->kind == GC_ARRAY) {
+      Value v;
+      v.type = VAL_ARRAY;
+      v.arr = (struct Array *)garbage[i];
+      array_clear(&v);
+    } else {
+      map_gc_clear((struct Map *)garbage[i]);
+    }
+  }
+  for (int i = 0; i < n; ++i) {
+    Value v;
+    if (garbage[i]->kind == GC_ARRAY) {
+      v.type = VAL_ARRAY;
+      v.arr = (struct Array *)garbage[i];
+    } else {
+      v.type = garbage[i]->kind == GC_SET ? VAL_SET : VAL_MAP;
+      v.map = (struct Map *)garbage[i];
+    }
+    free_value(v);
+  }
+  g_gc_garbage.count = 0;
+  int scanned = roots.count;
+  gc_vec_free(&roots);
+
+  /* back off while collections find nothing, e.g. many long-lived candidates */
+  if (n > 0)
+    g_gc_threshold = GC_THRESHOLD;
+  else if (g_gc_threshold < GC_THRESHOLD_MAX)
+    g_gc_threshold *= 2;
+
+  double ms = gc_now_ms() - t0;
+  g_gc_stats.collections++;
+  g_gc_stats.collected += n;
+  g_gc_stats.scanned += scanned;
+  g_gc_stats.last_pause_ms = ms;
+  if (ms > g_gc_stats.max_pause_ms) g_gc_stats.max_pause_ms = ms;
+  g_gc_stats.total_pause_ms += ms;
+  return n;
+}
+
+void gc_get_stats(GcStats *out) {
+  *out = g_gc_stats;
+  out->roots = g_gc_roots.count;
+  out->threshold = g_gc_threshold;
+}
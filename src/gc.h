@@ -0,0 +1,71 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file gc.h
+ * @brief Cycle collector for the refcounted containers (arrays, maps, sets).
+ *
+ * Refcounting frees everything except cycles. Every container starts with a
+ * GcHeader; when a reference to one is dropped but others remain, it becomes
+ * a candidate root. The collector (synchronous trial deletion after Bacon and
+ * Rajan, "Concurrent Cycle Collection in Reference Counted Systems", 2001)
+ * subtracts the references that candidates' subgraphs hold among themselves
+ * and frees what is left with a count of zero.
+ *
+ * Collections run between statements (OP_LINE) once enough containers were
+ * allocated since the last one, or on demand with gc(). Candidate buffers and
+ * statistics are per thread, like the refcounts themselves.
+ */
+
+#ifndef FUN_GC_H
+#define FUN_GC_H
+
+#include <stdint.h>
+
+/** Container kinds known to the collector. */
+enum { GC_ARRAY, GC_MAP, GC_SET };
+
+/** First member of struct Array and struct Map. */
+typedef struct GcHeader {
+  int refcount;
+  unsigned char kind;  /* GC_ARRAY, GC_MAP or GC_SET */
+  unsigned char color; /* collector state, black outside collections */
+  int root;            /* position in the candidate buffer, -1 if not buffered */
+} GcHeader;
+
+/** Collector statistics of the calling thread (see gc_stats()). */
+typedef struct GcStats {
+  int64_t collections;   /* collections run */
+  int64_t collected;     /* containers freed by the collector */
+  int64_t scanned;       /* candidate roots examined */
+  int64_t aborted;       /* collections given up for lack of memory */
+  int roots;             /* candidates currently buffered */
+  int threshold;         /* container allocations between collections */
+  double last_pause_ms;  /* duration of the last collection */
+  double max_pause_ms;   /* longest collection */
+  double total_pause_ms; /* time spent in all collections */
+} GcStats;
+
+/** Set when a collection is due; checked by the VM between statements. */
+extern __thread int gc_pending;
+
+/** Initialize the header of a new container (refcount 1). */
+void gc_header_init(GcHeader *h, int kind);
+/** A reference to h was dropped and others remain: h may now be garbage. */
+void gc_possible_root(GcHeader *h);
+/** h is being freed: drop it from the candidate buffer. */
+void gc_forget(GcHeader *h);
+/** Run a collection now; returns the number of containers freed, or -1 if it ran out of memory. */
+int gc_collect(void);
+/** Copy the collector statistics of the calling thread. */
+void gc_get_stats(GcStats *out);
+/** Forget all candidates of the calling thread (used when a VM is freed). */
+void gc_drop_roots(void);
+
+#endif
@@ -0,0 +1,251 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file handles.c
+ * @brief Shared, thread-safe handle tables for native objects.
+ *
+ * Extensions (SQLite, Redis, INI, XML, PC/SC) and core built-ins (event
+ * loops, socket buffers, child processes, CSV readers/writers, hashes,
+ * codecs) hand out small positive integers to Fun code instead of raw
+ * pointers. A FunHandleTable maps those ids to pointers:
+ *
+ * - Sharded: FUN_HANDLE_SHARDS independent slot arrays, each with its own
+ *   mutex. A thread allocates from its home shard (assigned round-robin on
+ *   first use), so thread_spawn workers creating handles do not contend;
+ *   lookups go to the shard encoded in the id, from any thread.
+ * - O(1): new/get/free use a per-shard free list and direct indexing.
+ *   Shards grow by doubling; there is no fixed cap.
+ * - Generation-tagged ids: freeing a handle bumps its slot's generation, so
+ *   a stale id (use after free, double free) no longer matches once the slot
+ *   is reused and lookups return NULL instead of someone else's object.
+ * - Automatic release: each table has an optional destructor that is called
+ *   (outside the lock) with the pointer when its handle is freed.
+ * - Borrowing: fun_handle_acquire() returns the pointer with a use count
+ *   held on the slot. Freeing the handle meanwhile invalidates the id at
+ *   once but defers the destructor (and slot reuse) to the last
+ *   fun_handle_release(), so an object is never destroyed under a user.
+ *
+ * Id layout (int64): generation << 32 | shard << 28 | (slot + 1). The first
+ * handles of a single-threaded program are therefore 1, 2, 3, ... as before.
+ *
+ * fun_handle_get() returns the pointer without a use count; it suits callers
+ * whose handles are only used from one thread at a time (the extensions).
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __unix__
+#include <pthread.h>
+#endif
+
+#define FUN_HANDLE_SHARDS 8
+#define FUN_HANDLE_SHARD_BITS 28
+#define FUN_HANDLE_SLOT_MASK ((int64_t)((1 << FUN_HANDLE_SHARD_BITS) - 1))
+#define FUN_HANDLE_GEN_MASK 0x7fffffffu
+
+typedef void (*FunHandleDtor)(void *ptr);
+
+typedef struct {
+  void *ptr;
+  uint32_t gen;
+  int in_use;
+  int refs;      /* fun_handle_acquire() borrows not yet released */
+  int next_free; /* free list link, -1 = end */
+} FunHandleSlot;
+
+typedef struct {
+#ifdef __unix__
+  pthread_mutex_t lock;
+#endif
+  FunHandleSlot *slots;
+  int cap;
+  int free_head; /* -1 = empty */
+} FunHandleShard;
+
+typedef struct {
+  FunHandleDtor dtor; /* called with the pointer when a handle is freed; may be NULL */
+  FunHandleShard shards[FUN_HANDLE_SHARDS];
+} FunHandleTable;
+
+#ifdef __unix__
+#define FUN_HANDLE_SHARD_INIT {PTHREAD_MUTEX_INITIALIZER, NULL, 0, -1}
+#define FUN_HANDLE_LOCK(s) pthread_mutex_lock(&(s)->lock)
+#define FUN_HANDLE_UNLOCK(s) pthread_mutex_unlock(&(s)->lock)
+#else
+#define FUN_HANDLE_SHARD_INIT {NULL, 0, -1}
+#define FUN_HANDLE_LOCK(s) ((void)0)
+#define FUN_HANDLE_UNLOCK(s) ((void)0)
+#endif
+
+/** Static initializer: static FunHandleTable t = FUN_HANDLE_TABLE_INIT(dtor); */
+#define FUN_HANDLE_TABLE_INIT(dtor)                                                                          \
+  {                                                                                                          \
+    (dtor), {                                                                                                \
+      FUN_HANDLE_SHARD_INIT, FUN_HANDLE_SHARD_INIT, FUN_HANDLE_SHARD_INIT, FUN_HANDLE_SHARD_INIT,            \
+          FUN_HANDLE_SHARD_INIT, FUN_HANDLE_SHARD_INIT, FUN_HANDLE_SHARD_INIT, FUN_HANDLE_SHARD_INIT         \
+    }                                                                                                        \
+  }
+
+/** Home shard of the calling thread. */
+static int fun_handle_home_shard(void) {
+#ifdef __unix__
+  static __thread int home = -1;
+  static pthread_mutex_t next_lock = PTHREAD_MUTEX_INITIALIZER;
+  static int next = 0;
+  if (home < 0) {
+    pthread_mutex_lock(&next_lock);
+    home = next;
+    next = (next + 1) % FUN_HANDLE_SHARDS;
+    pthread_mutex_unlock(&next_lock);
+  }
+  return home;
+#else
+  return 0;
+#endif
+}
+
+/** Split an id into shard and slot; returns the shard or NULL if malformed. */
+static FunHandleShard *fun_handle_decode(FunHandleTable *t, int64_t id, int *slot, uint32_t *gen) {
+  if (id <= 0) return NULL;
+  int64_t low = id & FUN_HANDLE_SLOT_MASK;
+  int shard = (int)((id >> FUN_HANDLE_SHARD_BITS) & 0xf);
+  if (low == 0 || shard >= FUN_HANDLE_SHARDS) return NULL;
+  *slot = (int)low - 1;
+  *gen = (uint32_t)((id >> 32) & FUN_HANDLE_GEN_MASK);
+  return &t->shards[shard];
+}
+
+/** Register ptr; returns its id (>0), or 0 when ptr is NULL or on allocation failure. */
+static int64_t fun_handle_new(FunHandleTable *t, void *ptr) {
+  if (!ptr) return 0;
+  int shard = fun_handle_home_shard();
+  FunHandleShard *s = &t->shards[shard];
+  FUN_HANDLE_LOCK(s);
+  if (s->free_head < 0) {
+    int ncap = s->cap ? s->cap * 2 : 16;
+    if (ncap > FUN_HANDLE_SLOT_MASK) ncap = (int)FUN_HANDLE_SLOT_MASK;
+    if (ncap <= s->cap) {
+      FUN_HANDLE_UNLOCK(s);
+      return 0;
+    }
+    FunHandleSlot *ns = (FunHandleSlot *)realloc(s->slots, sizeof(FunHandleSlot) * (size_t)ncap);
+    if (!ns) {
+      FUN_HANDLE_UNLOCK(s);
+      return 0;
+    }
+    /* chain the new slots in index order so ids are handed out ascending */
+    for (int i = s->cap; i < ncap; ++i) {
+      ns[i].ptr = NULL;
+      ns[i].gen = 0;
+      ns[i].in_use = 0;
+      ns[i].refs = 0;
+      ns[i].next_free = i + 1 < ncap ? i + 1 : -1;
+    }
+    s->free_head = s->cap;
+    s->slots = ns;
+    s->cap = ncap;
+  }
+  int slot = s->free_head;
+  FunHandleSlot *e = &s->slots[slot];
+  s->free_head = e->next_free;
+  e->ptr = ptr;
+  e->in_use = 1;
+  e->next_free = -1;
+  int64_t id = ((int64_t)e->gen << 32) | ((int64_t)shard << FUN_HANDLE_SHARD_BITS) | (int64_t)(slot + 1);
+  FUN_HANDLE_UNLOCK(s);
+  return id;
+}
+
+/** Pointer registered under id; NULL if the id is unknown, freed or stale. */
+static void *fun_handle_get(FunHandleTable *t, int64_t id) {
+  int slot;
+  uint32_t gen;
+  FunHandleShard *s = fun_handle_decode(t, id, &slot, &gen);
+  if (!s) return NULL;
+  void *ptr = NULL;
+  FUN_HANDLE_LOCK(s);
+  if (slot < s->cap && s->slots[slot].in_use && s->slots[slot].gen == gen) ptr = s->slots[slot].ptr;
+  FUN_HANDLE_UNLOCK(s);
+  return ptr;
+}
+
+/**
+ * Pointer registered under id with a use count held on it; NULL if the id
+ * is unknown, freed or stale. Every non-NULL result must be matched by one
+ * fun_handle_release(t, id).
+ */
+static void *fun_handle_acquire(FunHandleTable *t, int64_t id) {
+  int slot;
+  uint32_t gen;
+  FunHandleShard *s = fun_handle_decode(t, id, &slot, &gen);
+  if (!s) return NULL;
+  void *ptr = NULL;
+  FUN_HANDLE_LOCK(s);
+  if (slot < s->cap && s->slots[slot].in_use && s->slots[slot].gen == gen) {
+    ptr = s->slots[slot].ptr;
+    s->slots[slot].refs++;
+  }
+  FUN_HANDLE_UNLOCK(s);
+  return ptr;
+}
+
+/** Drop a use count taken by fun_handle_acquire(); runs a deferred destructor. */
+static void fun_handle_release(FunHandleTable *t, int64_t id) {
+  int slot;
+  uint32_t gen;
+  FunHandleShard *s = fun_handle_decode(t, id, &slot, &gen);
+  if (!s) return;
+  void *ptr = NULL;
+  FUN_HANDLE_LOCK(s);
+  /* the slot cannot be reused while borrowed, so the generation is not checked */
+  if (slot < s->cap && s->slots[slot].refs > 0) {
+    FunHandleSlot *e = &s->slots[slot];
+    if (--e->refs == 0 && !e->in_use && e->ptr) {
+      ptr = e->ptr;
+      e->ptr = NULL;
+      e->next_free = s->free_head;
+      s->free_head = slot;
+    }
+  }
+  FUN_HANDLE_UNLOCK(s);
+  if (ptr && t->dtor) t->dtor(ptr);
+}
+
+/**
+ * Unregister id and hand its pointer to the table's destructor, at once or,
+ * while the handle is borrowed, at the last fun_handle_release().
+ * Returns 1 if a live handle was freed, 0 for unknown/stale ids (so a double
+ * free is harmless).
+ */
+static int fun_handle_free(FunHandleTable *t, int64_t id) {
+  int slot;
+  uint32_t gen;
+  FunHandleShard *s = fun_handle_decode(t, id, &slot, &gen);
+  if (!s) return 0;
+  void *ptr = NULL;
+  int found = 0;
+  FUN_HANDLE_LOCK(s);
+  if (slot < s->cap && s->slots[slot].in_use && s->slots[slot].gen == gen) {
+    FunHandleSlot *e = &s->slots[slot];
+    found = 1;
+    e->in_use = 0;
+    e->gen = (e->gen + 1) & FUN_HANDLE_GEN_MASK;
+    if (e->refs == 0) {
+      ptr = e->ptr;
+      e->ptr = NULL;
+      e->next_free = s->free_head;
+      s->free_head = slot;
+    }
+  }
+  FUN_HANDLE_UNLOCK(s);
+  if (ptr && t->dtor) t->dtor(ptr);
+  return found;
+}
@@ -9,43 +9,233 @@
 
 /**
  * @file map.c
- * @brief Simple string-keyed map implementation backing VAL_MAP Values.
+ * @brief Hashed, insertion-ordered table backing VAL_MAP and VAL_SET Values.
+ *
+ * Keys are strings, ints, floats or bools. Entries are kept in insertion
+ * order in parallel key/value arrays (the order of keys() and iteration).
+ * Once a table holds more than MAP_LINEAR_MAX entries, an open-addressing
+ * index (linear probing, load factor <= 1/2) maps key hashes to entry
+ * positions; smaller tables, like records and option maps, are scanned.
+ * A set is the same table without values.
+ *
+ * Keys compare like == with one exception: 1, 1.0 and true are the same key
+ * (integral floats are stored as ints, a bool keeps the type it was first
+ * inserted with) and false is the key 0, but true does not match 2 or other
+ * nonzero ints, although true == 2 holds. A hashed key can equal only one
+ * int, so a bool key is taken as its 0/1 value. "1" is a different key.
+ *
+ * Removing an entry leaves a dead entry (nil key, which never matches) in
+ * its place, so the index needs no tombstones of its own. Dead entries are
+ * squeezed out, keeping the order, once they outnumber the live ones or
+ * before entries are accessed by position. Lookups, inserts and removals
+ * are O(1) on average.
+ *
+ * This is the only place that knows the table layout; value.c and the VM
+ * use the functions declared in value.h.
  */
 
 #include "value.h"
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-/* Internal Map definition; Value holds struct Map* */
-typedef struct Map {
+#define MAP_LINEAR_MAX 8 /* tables up to this size have no hash index */
+
+/* Refcounted keys shared by maps built with make_map_shared() */
+typedef struct MapKeys {
   int refcount;
   int count;
+  Value *keys;
+  int32_t *index;
+  uint32_t index_mask;
+} MapKeys;
+
+/* Internal Map definition; Value holds struct Map* */
+typedef struct Map {
+  GcHeader gc; /* refcount and cycle collector state */
+  int count;              /* entries in keys/vals, dead ones included */
+  int dead;               /* removed entries not yet compacted */
   int cap;
-  char **keys; /* each key owned here */
-  Value *vals; /* each value owned here */
+  int is_set;
+  Value *keys;            /* each key owned here, unless shared */
+  Value *vals;            /* each value owned here; NULL for sets */
+  struct MapKeys *shared; /* non-NULL: keys and index belong to this key set */
+  int32_t *index;         /* per slot: entry position + 1, 0 = free; NULL while small */
+  uint32_t index_mask;    /* slot count - 1 */
 } Map;
 
+/* ---- keys ---- */
+
 /**
- * @brief Construct a new empty map Value.
+ * @brief Canonical form of a key.
  *
- * Allocates an internal Map structure with refcount=1 and zero capacity.
+ * Strings are borrowed, not copied; integral floats become ints.
  *
- * @return A Value of type VAL_MAP on success, or VAL_NIL on allocation failure.
+ * @return 1 on success, 0 if the Value type cannot be a key.
  */
-Value make_map_empty(void) {
-  Map *m = (Map *)malloc(sizeof(Map));
+static int map_key_norm(const Value *k, Value *out) {
+  switch (k ? k->type : VAL_NIL) {
+  case VAL_STRING:
+    out->type = VAL_STRING;
+    out->s = k->s ? k->s : (char *)"";
+    return 1;
+  case VAL_INT:
+    *out = *k;
+    return 1;
+  case VAL_BOOL:
+    out->type = VAL_BOOL;
+    out->i = k->i != 0;
+    return 1;
+  case VAL_FLOAT:
+    if (k->d >= -9223372036854775808.0 && k->d < 9223372036854775808.0 && (double)(int64_t)k->d == k->d) {
+      out->type = VAL_INT;
+      out->i = (int64_t)k->d;
+    } else {
+      *out = *k;
+    }
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+/** Hash of a canonical key. */
+static uint32_t map_key_hash(const Value *k) {
+  uint64_t h;
+  switch (k->type) {
+  case VAL_STRING: {
+    h = 1469598103934665603ULL; /* FNV-1a */
+    for (const unsigned char *p = (const unsigned char *)k->s; *p; ++p)
+      h = (h ^ *p) * 1099511628211ULL;
+    break;
+  }
+  case VAL_FLOAT:
+    memcpy(&h, &k->d, sizeof(h));
+    h ^= 0x5bd1e9955bd1e995ULL;
+    break;
+  default: /* ints and bools (0/1) */
+    h = (uint64_t)k->i;
+    break;
+  }
+  /* splitmix64 finalizer: spreads sequential ints over the slots */
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebULL;
+  h ^= h >> 31;
+  return (uint32_t)h;
+}
+
+/** Equality of two canonical keys. */
+static int map_key_eq(const Value *a, const Value *b) {
+  if (a->type != b->type) /* true is 1 and false is 0 (not: true == any nonzero int) */
+    return (a->type == VAL_INT || a->type == VAL_BOOL) && (b->type == VAL_INT || b->type == VAL_BOOL) && a->i == b->i;
+  switch (a->type) {
+  case VAL_STRING:
+    return a->s == b->s || strcmp(a->s, b->s) == 0;
+  case VAL_FLOAT:
+    return memcmp(&a->d, &b->d, sizeof(double)) == 0;
+  default:
+    return a->i == b->i;
+  }
+}
+
+/* ---- hash index ---- */
+
+/** Put entry position pos with hash h into an index that has a free slot. */
+static void map_index_put(int32_t *index, uint32_t mask, uint32_t h, int pos) {
+  uint32_t s = h & mask;
+  while (index[s])
+    s = (s + 1) & mask;
+  index[s] = pos + 1;
+}
+
+/** (Re)build an index for keys[0..count); returns 1, or 0 on allocation failure. */
+static int map_index_build(int32_t **index, uint32_t *mask, const Value *keys, int count) {
+  uint32_t slots = 16;
+  while (slots < (uint32_t)count * 2)
+    slots <<= 1;
+  int32_t *ni = (int32_t *)calloc(slots, sizeof(int32_t));
+  if (!ni) return 0;
+  for (int i = 0; i < count; ++i)
+    map_index_put(ni, slots - 1, map_key_hash(&keys[i]), i);
+  free(*index);
+  *index = ni;
+  *mask = slots - 1;
+  return 1;
+}
+
+/** Position of canonical key k (hash h), or -1. */
+static int map_find(const Map *m, const Value *k, uint32_t h) {
+  if (!m->index) {
+    for (int i = 0; i < m->count; ++i)
+      if (map_key_eq(&m->keys[i], k)) return i;
+    return -1;
+  }
+  for (uint32_t s = h & m->index_mask;; s = (s + 1) & m->index_mask) {
+    int32_t e = m->index[s];
+    if (!e) return -1;
+    if (map_key_eq(&m->keys[e - 1], k)) return e - 1;
+  }
+}
+
+/* ---- construction ---- */
+
+static Value map_new_value(int is_set) {
+  Map *m = (Map *)pool_object_alloc(is_set ? POOL_SET : POOL_MAP, sizeof(Map));
   if (!m) return make_nil();
-  m->refcount = 1;
-  m->count = 0;
-  m->cap = 0;
-  m->keys = NULL;
-  m->vals = NULL;
+  memset(m, 0, sizeof(Map));
+  gc_header_init(&m->gc, is_set ? GC_SET : GC_MAP);
+  m->is_set = is_set;
   Value v;
-  v.type = VAL_MAP;
+  v.type = is_set ? VAL_SET : VAL_MAP;
   v.map = (struct Map *)m;
   return v;
 }
 
+/**
+ * @brief Construct a new empty map Value.
+ *
+ * Allocates an internal Map structure with refcount=1 and zero capacity.
+ *
+ * @return A Value of type VAL_MAP on success, or VAL_NIL on allocation failure.
+ */
+Value make_map_empty(void) {
+  return map_new_value(0);
+}
+
+/**
+ * @brief Construct a new empty set Value.
+ * @return A Value of type VAL_SET on success, or VAL_NIL on allocation failure.
+ */
+Value make_set_empty(void) {
+  return map_new_value(1);
+}
+
+/** Internal table of a map or set Value; NULL for other types. */
+static Map *map_of(const Value *v) {
+  if (!v || (v->type != VAL_MAP && v->type != VAL_SET)) return NULL;
+  return (Map *)v->map;
+}
+
+/** Squeeze out dead entries, keeping the order, and rebuild the index. */
+static void map_compact(Map *m) {
+  if (m->dead == 0) return;
+  int n = 0;
+  for (int i = 0; i < m->count; ++i) {
+    if (m->keys[i].type == VAL_NIL) continue;
+    m->keys[n] = m->keys[i];
+    if (!m->is_set) m->vals[n] = m->vals[i];
+    n++;
+  }
+  m->count = n;
+  m->dead = 0;
+  if ((m->index || m->count > MAP_LINEAR_MAX) && !map_index_build(&m->index, &m->index_mask, m->keys, m->count)) {
+    free(m->index);
+    m->index = NULL;
+  }
+}
+
 /**
  * @brief Ensure the map has capacity for at least need elements.
  * @param m    Internal map pointer (must not be NULL).
@@ -57,19 +247,194 @@ static int map_ensure_cap(Map *m, int need) {
   int ncap = m->cap == 0 ? 4 : m->cap * 2;
   while (ncap < need)
     ncap *= 2;
-  char **nkeys = (char **)realloc(m->keys, sizeof(char *) * ncap);
-  Value *nvals = (Value *)realloc(m->vals, sizeof(Value) * ncap);
-  if (!nkeys || !nvals) return 0;
+  /* both buffers move together: their pool size class follows m->cap */
+  Value *nkeys = (Value *)pool_alloc(sizeof(Value) * ncap);
+  Value *nvals = m->is_set ? NULL : (Value *)pool_alloc(sizeof(Value) * ncap);
+  if (!nkeys || (!m->is_set && !nvals)) {
+    pool_free(nkeys, sizeof(Value) * ncap);
+    pool_free(nvals, sizeof(Value) * ncap);
+    return 0;
+  }
+  if (m->count > 0) {
+    memcpy(nkeys, m->keys, sizeof(Value) * m->count);
+    if (nvals) memcpy(nvals, m->vals, sizeof(Value) * m->count);
+  }
+  pool_free(m->keys, sizeof(Value) * m->cap);
+  pool_free(m->vals, sizeof(Value) * m->cap);
   m->keys = nkeys;
   m->vals = nvals;
   m->cap = ncap;
   return 1;
 }
 
+/**
+ * @brief Create a shared key set.
+ *
+ * @param names Key names (copied); must be distinct.
+ * @param count Number of names.
+ * @return Key set with one reference, or NULL on allocation failure.
+ */
+MapKeys *map_keys_new(const char *const *names, int count) {
+  MapKeys *k = (MapKeys *)calloc(1, sizeof(MapKeys));
+  if (!k) return NULL;
+  k->refcount = 1;
+  if (count > 0) {
+    k->keys = (Value *)calloc((size_t)count, sizeof(Value));
+    if (!k->keys) {
+      free(k);
+      return NULL;
+    }
+    for (int i = 0; i < count; ++i) {
+      k->keys[i] = make_string(names[i] ? names[i] : "");
+      k->count = i + 1;
+      if (!k->keys[i].s) {
+        map_keys_release(k);
+        return NULL;
+      }
+    }
+    if (count > MAP_LINEAR_MAX && !map_index_build(&k->index, &k->index_mask, k->keys, count)) {
+      map_keys_release(k);
+      return NULL;
+    }
+  }
+  return k;
+}
+
+/**
+ * @brief Drop one reference to a shared key set, freeing it with the last.
+ * @param k Key set (NULL is ignored).
+ */
+void map_keys_release(MapKeys *k) {
+  if (!k || --k->refcount > 0) return;
+  for (int i = 0; i < k->count; ++i)
+    free_value(k->keys[i]);
+  free(k->keys);
+  free(k->index);
+  free(k);
+}
+
+/**
+ * @brief Build a map whose keys are a shared key set.
+ *
+ * The map references k (keys and hash index) instead of copying its keys;
+ * it takes a private copy only when a key is added or removed. Values are
+ * moved from vals[0..k->count), which must hold one value per key; they are
+ * freed on failure.
+ *
+ * @param k    Shared key set (retained).
+ * @param vals Values in key order (ownership transferred).
+ * @return A Value of type VAL_MAP, or VAL_NIL on allocation failure.
+ */
+Value make_map_shared(MapKeys *k, Value *vals) {
+  int n = k ? k->count : 0;
+  Map *m = (Map *)pool_object_alloc(POOL_MAP, sizeof(Map));
+  Value *mv = n > 0 ? (Value *)pool_alloc(sizeof(Value) * n) : NULL;
+  if (!m || (n > 0 && !mv)) {
+    pool_object_free(POOL_MAP, m, sizeof(Map));
+    pool_free(mv, sizeof(Value) * n);
+    for (int i = 0; i < n; ++i)
+      free_value(vals[i]);
+    return make_nil();
+  }
+  memset(m, 0, sizeof(Map));
+  if (n > 0) memcpy(mv, vals, sizeof(Value) * n);
+  gc_header_init(&m->gc, GC_MAP);
+  m->count = n;
+  m->cap = n;
+  m->keys = k ? k->keys : NULL;
+  m->vals = mv;
+  if (k) {
+    m->shared = k;
+    m->index = k->index;
+    m->index_mask = k->index_mask;
+    k->refcount++;
+  }
+  Value v;
+  v.type = VAL_MAP;
+  v.map = (struct Map *)m;
+  return v;
+}
+
+/** Give a map built on a shared key set its own keys and index; returns 1/0. */
+static int map_own_keys(Map *m) {
+  if (!m->shared) return 1;
+  Value *nk = m->cap > 0 ? (Value *)pool_alloc(sizeof(Value) * m->cap) : NULL;
+  int32_t *ni = NULL;
+  if (nk && m->index) {
+    ni = (int32_t *)malloc(sizeof(int32_t) * ((size_t)m->index_mask + 1));
+    if (ni) memcpy(ni, m->index, sizeof(int32_t) * ((size_t)m->index_mask + 1));
+  }
+  if ((m->cap > 0 && !nk) || (m->index && !ni)) {
+    pool_free(nk, sizeof(Value) * m->cap);
+    free(ni);
+    return 0;
+  }
+  for (int i = 0; i < m->count; ++i)
+    nk[i] = copy_value(&m->keys[i]);
+  map_keys_release(m->shared);
+  m->shared = NULL;
+  m->keys = nk;
+  m->index = ni;
+  return 1;
+}
+
+/** Append a new canonical key k (hash h, copied) with value v (taken); returns 1/0. */
+static int map_append(Map *m, const Value *k, uint32_t h, Value v) {
+  if (!map_own_keys(m) || !map_ensure_cap(m, m->count + 1)) {
+    free_value(v);
+    return 0;
+  }
+  int pos = m->count;
+  m->keys[pos] = copy_value(k);
+  if (!m->is_set) m->vals[pos] = v;
+  m->count++;
+  if (m->index && (uint32_t)m->count * 2 <= m->index_mask + 1) {
+    map_index_put(m->index, m->index_mask, h, pos);
+  } else if (m->dead > 0) {
+    map_compact(m); /* rebuilds the index without the dead entries */
+  } else if (m->index || m->count > MAP_LINEAR_MAX) {
+    /* grow (or create) the index; without one the table still works, just scanned */
+    if (!map_index_build(&m->index, &m->index_mask, m->keys, m->count)) {
+      free(m->index);
+      m->index = NULL;
+    }
+  }
+  return 1;
+}
+
+/* ---- map API ---- */
+
+/**
+ * @brief Insert or replace a key of any key type.
+ *
+ * The key is copied; v is consumed in all cases.
+ *
+ * @param vm  Target Value of type VAL_MAP.
+ * @param key String, int, float or bool key.
+ * @param v   Value to store.
+ * @return 1 on success, 0 on error (not a map, unsupported key type, OOM).
+ */
+int map_set_key(Value *vm, const Value *key, Value v) {
+  Map *m = vm && vm->type == VAL_MAP ? (Map *)vm->map : NULL;
+  Value k;
+  if (!m || !map_key_norm(key, &k)) {
+    free_value(v);
+    return 0;
+  }
+  uint32_t h = map_key_hash(&k);
+  int i = map_find(m, &k, h);
+  if (i >= 0) {
+    free_value(m->vals[i]);
+    m->vals[i] = v;
+    return 1;
+  }
+  return map_append(m, &k, h, v);
+}
+
 /**
  * @brief Insert or replace a key in the map.
  *
- * On success, ownership of v transfers into the map. On failure, v is freed.
+ * On success the map takes ownership of v; on failure v is freed.
  *
  * @param vm  Target Value of type VAL_MAP.
  * @param key NUL-terminated key string (copied into the map).
@@ -77,26 +442,14 @@ static int map_ensure_cap(Map *m, int need) {
  * @return 1 on success, 0 on error (type mismatch, OOM, or NULL params).
  */
 int map_set(Value *vm, const char *key, Value v) {
-  if (!vm || vm->type != VAL_MAP || !vm->map || !key) {
-    free_value(v);
-    return 0;
-  }
-  Map *m = (Map *)vm->map;
-  for (int i = 0; i < m->count; ++i) {
-    if (strcmp(m->keys[i], key) == 0) {
-      free_value(m->vals[i]);
-      m->vals[i] = v;
-      return 1;
-    }
-  }
-  if (!map_ensure_cap(m, m->count + 1)) {
+  if (!key) {
     free_value(v);
     return 0;
   }
-  m->keys[m->count] = strdup(key);
-  m->vals[m->count] = v;
-  m->count++;
-  return 1;
+  Value k;
+  k.type = VAL_STRING;
+  k.s = (char *)key;
+  return map_set_key(vm, &k, v);
 }
 
 /**
@@ -112,33 +465,57 @@ int map_set(Value *vm, const char *key, Value v) {
  * @return 1 on success, 0 on error (type mismatch, OOM, or NULL params).
  */
 int map_set_copy(Value *vm, const char *key, const Value *v) {
-  if (!vm || vm->type != VAL_MAP || !vm->map || !key || !v) {
-    return 0;
-  }
-  /* make a defensive copy first so we can reuse map_set path semantics */
-  Value cv = copy_value(v);
-  Map *m = (Map *)vm->map;
-  for (int i = 0; i < m->count; ++i) {
-    if (strcmp(m->keys[i], key) == 0) {
-      free_value(m->vals[i]);
-      m->vals[i] = cv;
-      return 1;
-    }
-  }
-  if (!map_ensure_cap(m, m->count + 1)) {
-    free_value(cv);
-    return 0;
+  if (!v) return 0;
+  return map_set(vm, key, copy_value(v));
+}
+
+/**
+ * @brief Borrow the stored value of a key, inserting nil if it is missing.
+ *
+ * Lets callers update a value in place (counters, group arrays) with one
+ * lookup and without copying the key of an existing entry. The pointer is
+ * valid until the map is next modified.
+ *
+ * @param vm  Target Value of type VAL_MAP.
+ * @param key String, int, float or bool key (copied only when inserted).
+ * @return Pointer to the stored value, or NULL if not a map, the key type is
+ *         unsupported, or on allocation failure.
+ */
+Value *map_slot_key(Value *vm, const Value *key) {
+  Map *m = vm && vm->type == VAL_MAP ? (Map *)vm->map : NULL;
+  Value k;
+  if (!m || !map_key_norm(key, &k)) return NULL;
+  uint32_t h = map_key_hash(&k);
+  int i = map_find(m, &k, h);
+  if (i < 0) {
+    if (!map_append(m, &k, h, make_nil())) return NULL;
+    i = m->count - 1;
   }
-  m->keys[m->count] = strdup(key);
-  m->vals[m->count] = cv;
-  m->count++;
+  return &m->vals[i];
+}
+
+/**
+ * @brief Look up a key of any key type and copy the stored value into out.
+ *
+ * @param vm  Source map Value (VAL_MAP).
+ * @param key Key to search for.
+ * @param out Output pointer to receive a copy; may be NULL to only test presence.
+ * @return 1 if found (and out filled if non-NULL), 0 otherwise.
+ */
+int map_get_key(const Value *vm, const Value *key, Value *out) {
+  Map *m = vm && vm->type == VAL_MAP ? (Map *)vm->map : NULL;
+  Value k;
+  if (!m || !map_key_norm(key, &k)) return 0;
+  int i = map_find(m, &k, m->index ? map_key_hash(&k) : 0);
+  if (i < 0) return 0;
+  if (out) *out = copy_value(&m->vals[i]);
   return 1;
 }
 
 /**
  * @brief Look up a key and copy the stored value into out.
  *
- * The returned value is a deep copy; caller owns it and must free it.
+ * The returned value is a copy (copy_value() semantics); caller owns it and must free it.
  *
  * @param vm  Source map Value (VAL_MAP).
  * @param key Key to search for.
@@ -146,15 +523,24 @@ int map_set_copy(Value *vm, const char *key, const Value *v) {
  * @return 1 if found (and out filled if non-NULL), 0 otherwise.
  */
 int map_get_copy(const Value *vm, const char *key, Value *out) {
-  if (!vm || vm->type != VAL_MAP || !vm->map || !key) return 0;
-  Map *m = (Map *)vm->map;
-  for (int i = 0; i < m->count; ++i) {
-    if (strcmp(m->keys[i], key) == 0) {
-      if (out) *out = copy_value(&m->vals[i]);
-      return 1;
-    }
-  }
-  return 0;
+  if (!key) return 0;
+  Value k;
+  k.type = VAL_STRING;
+  k.s = (char *)key;
+  return map_get_key(vm, &k, out);
+}
+
+/**
+ * @brief Check whether a map contains a key, or a set an element.
+ * @param vm  Map or set Value.
+ * @param key Key (element) of any key type.
+ * @return 1 if present, 0 if absent or on invalid input.
+ */
+int map_has_key(const Value *vm, const Value *key) {
+  Map *m = map_of(vm);
+  Value k;
+  if (!m || !map_key_norm(key, &k)) return 0;
+  return map_find(m, &k, m->index ? map_key_hash(&k) : 0) >= 0;
 }
 
 /**
@@ -164,36 +550,77 @@ int map_get_copy(const Value *vm, const char *key, Value *out) {
  * @return 1 if present, 0 if absent or on invalid input.
  */
 int map_has(const Value *vm, const char *key) {
-  if (!vm || vm->type != VAL_MAP || !vm->map || !key) return 0;
-  Map *m = (Map *)vm->map;
-  for (int i = 0; i < m->count; ++i) {
-    if (strcmp(m->keys[i], key) == 0) return 1;
+  if (!key) return 0;
+  Value k;
+  k.type = VAL_STRING;
+  k.s = (char *)key;
+  return map_has_key(vm, &k);
+}
+
+/**
+ * @brief Remove a key from a map, or an element from a set.
+ *
+ * The entry is marked dead in place; dead entries are compacted once they
+ * outnumber the live ones, so removal is amortized O(1) and keeps the
+ * insertion order of the rest.
+ *
+ * @param vm  Map or set Value.
+ * @param key Key (element) to remove.
+ * @return 1 if it was present, 0 otherwise.
+ */
+int map_remove_key(Value *vm, const Value *key) {
+  Map *m = map_of(vm);
+  Value k;
+  if (!m || !map_key_norm(key, &k)) return 0;
+  int i = map_find(m, &k, m->index ? map_key_hash(&k) : 0);
+  if (i < 0 || !map_own_keys(m)) return 0;
+  free_value(m->keys[i]);
+  m->keys[i] = make_nil();
+  if (!m->is_set) {
+    free_value(m->vals[i]);
+    m->vals[i] = make_nil();
   }
-  return 0;
+  m->dead++;
+  if (m->dead * 2 > m->count) map_compact(m);
+  return 1;
 }
 
 /**
- * @brief Return all map keys as an array of strings.
+ * @brief Number of entries of a map or elements of a set.
+ * @return The count, or -1 if vm is neither.
+ */
+int map_count(const Value *vm) {
+  Map *m = map_of(vm);
+  return m ? m->count - m->dead : -1;
+}
+
+/** Borrow the key (set element) at position i in insertion order; NULL if out of range. */
+const Value *map_peek_key(const Value *vm, int i) {
+  Map *m = map_of(vm);
+  if (m) map_compact(m);
+  return m && i >= 0 && i < m->count ? &m->keys[i] : NULL;
+}
+
+/** Borrow the value at position i in insertion order; NULL if out of range or a set. */
+const Value *map_peek_val(const Value *vm, int i) {
+  Map *m = map_of(vm);
+  if (m) map_compact(m);
+  return m && !m->is_set && i >= 0 && i < m->count ? &m->vals[i] : NULL;
+}
+
+/**
+ * @brief Return all map keys (set elements) as an array, in insertion order.
  *
  * Ownership: Caller must free the returned Value with free_value().
  *
- * @param vm Map Value (VAL_MAP).
- * @return Array Value of keys; empty array if vm is not a map or is empty.
+ * @param vm Map or set Value.
+ * @return Array Value of keys; empty array if vm is neither or is empty.
  */
 Value map_keys_array(const Value *vm) {
-  if (!vm || vm->type != VAL_MAP || !vm->map) return make_array_from_values(NULL, 0);
-  Map *m = (Map *)vm->map;
-  if (m->count <= 0) return make_array_from_values(NULL, 0);
-  Value *tmp = (Value *)malloc(sizeof(Value) * m->count);
-  if (!tmp) return make_array_from_values(NULL, 0);
-  for (int i = 0; i < m->count; ++i) {
-    tmp[i] = make_string(m->keys[i]);
-  }
-  Value arr = make_array_from_values(tmp, m->count);
-  for (int i = 0; i < m->count; ++i)
-    free_value(tmp[i]);
-  free(tmp);
-  return arr;
+  Map *m = map_of(vm);
+  if (m) map_compact(m);
+  if (!m || m->count <= 0) return make_array_from_values(NULL, 0);
+  return make_array_from_values(m->keys, m->count);
 }
 
 /**
@@ -205,17 +632,166 @@ Value map_keys_array(const Value *vm) {
  * @return Array Value of values; empty array if vm is not a map or is empty.
  */
 Value map_values_array(const Value *vm) {
-  if (!vm || vm->type != VAL_MAP || !vm->map) return make_array_from_values(NULL, 0);
-  Map *m = (Map *)vm->map;
-  if (m->count <= 0) return make_array_from_values(NULL, 0);
-  Value *tmp = (Value *)malloc(sizeof(Value) * m->count);
-  if (!tmp) return make_array_from_values(NULL, 0);
+  Map *m = vm && vm->type == VAL_MAP ? (Map *)vm->map : NULL;
+  if (m) map_compact(m);
+  if (!m || m->count <= 0) return make_array_from_values(NULL, 0);
+  return make_array_from_values(m->vals, m->count);
+}
+
+/* ---- lifetime, copies, printing (used by value.c) ---- */
+
+/** Add a reference to a map or set table. */
+struct Map *map_retain(struct Map *mp) {
+  Map *m = (Map *)mp;
+  if (m) m->gc.refcount++;
+  return mp;
+}
+
+/** Drop a reference to a map or set table, freeing it with the last. */
+void map_release(struct Map *mp) {
+  Map *m = (Map *)mp;
+  if (!m) return;
+  if (--m->gc.refcount > 0) {
+    gc_possible_root(&m->gc);
+    return;
+  }
+  if (m->gc.root >= 0) gc_forget(&m->gc);
   for (int i = 0; i < m->count; ++i) {
-    tmp[i] = copy_value(&m->vals[i]);
+    if (!m->shared) free_value(m->keys[i]);
+    if (!m->is_set) free_value(m->vals[i]);
   }
-  Value arr = make_array_from_values(tmp, m->count);
-  for (int i = 0; i < m->count; ++i)
-    free_value(tmp[i]);
-  free(tmp);
-  return arr;
+  if (m->shared) {
+    map_keys_release(m->shared);
+  } else {
+    pool_free(m->keys, sizeof(Value) * m->cap);
+    free(m->index);
+  }
+  pool_free(m->vals, sizeof(Value) * m->cap);
+  pool_object_free(m->is_set ? POOL_SET : POOL_MAP, m, sizeof(Map));
+}
+
+/** Visit the arrays, maps and sets held as values of a map. */
+void map_gc_visit(struct Map *mp, void (*visit)(GcHeader *child)) {
+  Map *m = (Map *)mp;
+  if (m->is_set) return;
+  for (int i = 0; i < m->count; ++i) {
+    const Value *v = &m->vals[i];
+    if (v->type == VAL_ARRAY && v->arr) {
+      visit((GcHeader *)v->arr);
+    } else if ((v->type == VAL_MAP || v->type == VAL_SET) && v->map) {
+      visit((GcHeader *)v->map);
+    }
+  }
+}
+
+/** Release the values of a map that the cycle collector found unreachable. */
+void map_gc_clear(struct Map *mp) {
+  Map *m = (Map *)mp;
+  if (m->is_set) return;
+  for (int i = 0; i < m->count; ++i) {
+    Value v = m->vals[i];
+    m->vals[i] = make_nil();
+    free_value(v);
+  }
+}
+
+/** Deep copy of a map (values copied recursively) or set. */
+Value map_deep_copy(const Value *vm) {
+  Map *m = map_of(vm);
+  if (m) map_compact(m);
+  Value out = m && m->is_set ? make_set_empty() : make_map_empty();
+  Map *o = map_of(&out);
+  if (!m || !o || m->count <= 0 || !map_ensure_cap(o, m->count)) return out;
+  for (int i = 0; i < m->count; ++i) {
+    o->keys[i] = copy_value(&m->keys[i]);
+    if (!m->is_set) o->vals[i] = deep_copy_value(&m->vals[i]);
+  }
+  o->count = m->count;
+  if (m->index && !map_index_build(&o->index, &o->index_mask, o->keys, o->count)) o->index = NULL;
+  return out;
+}
+
+/** Print a map as {"key": value, 1: value} or a set as {1, "a"} (empty set: set()). */
+void map_print(const Value *vm) {
+  Map *m = map_of(vm);
+  if (m) map_compact(m);
+  if (m && m->is_set && m->count == 0) {
+    printf("set()");
+    return;
+  }
+  printf("{");
+  for (int i = 0; m && i < m->count; ++i) {
+    if (i > 0) printf(", ");
+    if (m->keys[i].type == VAL_STRING)
+      printf("\"%s\"", m->keys[i].s);
+    else
+      print_value(&m->keys[i]);
+    if (!m->is_set) {
+      printf(": ");
+      print_value(&m->vals[i]);
+    }
+  }
+  printf("}");
+}
+
+/* ---- sets ---- */
+
+/**
+ * @brief Add an element (copied) to a set.
+ * @return 1 if added, 0 if already present, -1 if v cannot be an element
+ *         (arrays, maps, sets, functions, nil) or on error.
+ */
+int set_add(Value *sv, const Value *v) {
+  Map *m = sv && sv->type == VAL_SET ? (Map *)sv->map : NULL;
+  Value k;
+  if (!m || !map_key_norm(v, &k)) return -1;
+  uint32_t h = map_key_hash(&k);
+  if (map_find(m, &k, h) >= 0) return 0;
+  return map_append(m, &k, h, make_nil()) ? 1 : -1;
+}
+
+/** New set with the elements of an array (or set); unhashable items are skipped. */
+Value set_from_values(const Value *src) {
+  Value out = make_set_empty();
+  if (src && (src->type == VAL_SET || src->type == VAL_MAP)) {
+    int n = map_count(src);
+    for (int i = 0; i < n; ++i)
+      set_add(&out, map_peek_key(src, i));
+  } else if (src && src->type == VAL_ARRAY) {
+    int n = array_length(src);
+    for (int i = 0; i < n; ++i) {
+      Value item = array_peek_value(src, i);
+      set_add(&out, &item);
+    }
+  }
+  return out;
+}
+
+/** New set with the elements of a followed by those of b not in a. */
+Value set_union(const Value *a, const Value *b) {
+  Value out = set_from_values(a);
+  int n = map_count(b);
+  for (int i = 0; i < n; ++i)
+    set_add(&out, map_peek_key(b, i));
+  return out;
+}
+
+/** New set with the elements of a (in a's order) that are also in b. */
+Value set_intersect(const Value *a, const Value *b) {
+  Value out = make_set_empty();
+  int n = map_count(a);
+  for (int i = 0; i < n; ++i) {
+    const Value *e = map_peek_key(a, i);
+    if (map_has_key(b, e)) set_add(&out, e);
+  }
+  return out;
+}
+
+/** 1 if both sets hold the same elements (in any order). */
+int set_equals(const Value *a, const Value *b) {
+  int n = map_count(a);
+  if (n < 0 || n != map_count(b)) return 0;
+  for (int i = 0; i < n; ++i)
+    if (!map_has_key(b, map_peek_key(a, i))) return 0;
+  return 1;
 }
@@ -168,11 +168,23 @@ static void parser_fail(size_t pos, const char *fmt, ...) {
   va_end(ap);
 }
 
+/* Resume point of the last calc_line_col() scan. Statements are compiled in
+ * source order, so continuing from here keeps per-statement OP_LINE emission
+ * linear instead of rescanning from the start of the buffer every time. */
+static struct {
+  const char *src;
+  size_t len;
+  size_t pos;
+  int line;
+  int col;
+} g_line_cache = {NULL, 0, 0, 1, 1};
+
 /**
  * @brief Compute one-based line and column from a byte position.
  *
  * Counts newlines up to the smaller of pos and len to derive a human-friendly
  * (line, column) pair. Columns are one-based and reset after each newline.
+ * Scans resume from the previous result when moving forward in the same buffer.
  *
  * @param src Source buffer.
  * @param len Source length in bytes.
@@ -183,7 +195,13 @@ static void parser_fail(size_t pos, const char *fmt, ...) {
 static void calc_line_col(const char *src, size_t len, size_t pos, int *out_line, int *out_col) {
   int line = 1, col = 1;
   size_t limit = pos < len ? pos : len;
-  for (size_t i = 0; i < limit; ++i) {
+  size_t i = 0;
+  if (g_line_cache.src == src && g_line_cache.len == len && g_line_cache.pos <= limit) {
+    i = g_line_cache.pos;
+    line = g_line_cache.line;
+    col = g_line_cache.col;
+  }
+  for (; i < limit; ++i) {
     if (src[i] == '\n') {
       line++;
       col = 1;
@@ -191,6 +209,11 @@ static void calc_line_col(const char *src, size_t len, size_t pos, int *out_line
       col++;
     }
   }
+  g_line_cache.src = src;
+  g_line_cache.len = len;
+  g_line_cache.pos = limit;
+  g_line_cache.line = line;
+  g_line_cache.col = col;
   if (out_line) *out_line = line;
   if (out_col) *out_col = col;
 }
@@ -278,13 +301,28 @@ static int is_ns_alias(const char *name) {
 
 #include "parser_utils.c"
 
-/* very small global symbol table for LOAD_GLOBAL/STORE_GLOBAL */
+/**
+ * @brief FNV-1a hash of an identifier, used by the symbol tables.
+ */
+static uint32_t sym_hash(const char *name) {
+  uint32_t h = 2166136261u;
+  while (*name) {
+    h ^= (unsigned char)*name++;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+/* global symbol table for LOAD_GLOBAL/STORE_GLOBAL (grows up to MAX_GLOBALS) */
 static struct {
-  char *names[MAX_GLOBALS];
-  int types[MAX_GLOBALS];    /* 0=untyped/number default; else bit width: 8/16/32/64; negative for signed */
-  int is_class[MAX_GLOBALS]; /* 1 if this global name denotes a class factory */
+  char **names;
+  int *types;    /* 0=untyped/number default; else bit width: 8/16/32/64; negative for signed */
+  int *is_class; /* 1 if this global name denotes a class factory */
   int count;
-} G = {{0}, {0}, {0}, 0};
+  int cap;
+  int *slots;   /* open-addressing name index: global index + 1, 0 = empty */
+  int slot_cap; /* power of two */
+} G = {NULL, NULL, NULL, 0, 0, NULL, 0};
 
 /**
  * @brief Find a global symbol index by name.
@@ -293,12 +331,45 @@ static struct {
  * @return Index in the global table, or -1 if not found.
  */
 static int sym_find(const char *name) {
-  for (int i = 0; i < G.count; ++i) {
-    if (strcmp(G.names[i], name) == 0) return i;
+  if (G.slot_cap == 0) return -1;
+  uint32_t mask = (uint32_t)(G.slot_cap - 1);
+  for (uint32_t j = sym_hash(name) & mask; G.slots[j]; j = (j + 1) & mask) {
+    if (strcmp(G.names[G.slots[j] - 1], name) == 0) return G.slots[j] - 1;
   }
   return -1;
 }
 
+/**
+ * @brief Record global @p idx in the name index, growing it when half full.
+ * @return 1 on success, 0 after reporting an error (out of memory).
+ */
+static int sym_hash_insert(int idx) {
+  if ((G.count + 1) * 2 > G.slot_cap) {
+    int ncap = G.slot_cap ? G.slot_cap * 2 : 64;
+    int *ns = (int *)calloc((size_t)ncap, sizeof(int));
+    if (!ns) {
+      parser_fail(0, "Out of memory growing the global table");
+      return 0;
+    }
+    for (int i = 0; i < G.count; ++i) {
+      if (i == idx) continue;
+      uint32_t j = sym_hash(G.names[i]) & (uint32_t)(ncap - 1);
+      while (ns[j])
+        j = (j + 1) & (uint32_t)(ncap - 1);
+      ns[j] = i + 1;
+    }
+    free(G.slots);
+    G.slots = ns;
+    G.slot_cap = ncap;
+  }
+  uint32_t mask = (uint32_t)(G.slot_cap - 1);
+  uint32_t j = sym_hash(G.names[idx]) & mask;
+  while (G.slots[j])
+    j = (j + 1) & mask;
+  G.slots[j] = idx + 1;
+  return 1;
+}
+
 /**
  * @brief Get or create a global symbol index for a name.
  *
@@ -307,7 +378,7 @@ static int sym_find(const char *name) {
  *
  * @param name Symbol name.
  * @return Index of the symbol (>=0). Returns 0 after reporting an error if
- *         the table is full.
+ *         the MAX_GLOBALS limit is reached.
  */
 static int sym_index(const char *name) {
   int existing = sym_find(name);
@@ -316,19 +387,72 @@ static int sym_index(const char *name) {
     parser_fail(0, "Too many globals (max %d)", MAX_GLOBALS);
     return 0;
   }
+  if (G.count == G.cap) {
+    int ncap = G.cap ? G.cap * 2 : 64;
+    char **nn = (char **)realloc(G.names, sizeof(char *) * (size_t)ncap);
+    if (nn) G.names = nn;
+    int *nt = (int *)realloc(G.types, sizeof(int) * (size_t)ncap);
+    if (nt) G.types = nt;
+    int *nc = (int *)realloc(G.is_class, sizeof(int) * (size_t)ncap);
+    if (nc) G.is_class = nc;
+    if (!nn || !nt || !nc) {
+      parser_fail(0, "Out of memory growing the global table");
+      return 0;
+    }
+    G.cap = ncap;
+  }
   G.names[G.count] = strdup(name);
+  if (!G.names[G.count]) {
+    parser_fail(0, "Out of memory growing the global table");
+    return 0;
+  }
   G.types[G.count] = 0;    /* default: untyped */
   G.is_class[G.count] = 0; /* default: not a class */
+  if (!sym_hash_insert(G.count)) {
+    free(G.names[G.count]);
+    G.names[G.count] = NULL;
+    return 0;
+  }
   return G.count++;
 }
 
-/* ---- locals environment for functions ---- */
+/* ---- locals environment for functions ----
+ * All-zero is a valid empty env; storage grows up to MAX_FRAME_LOCALS. */
 typedef struct {
-  char *names[MAX_FRAME_LOCALS];
-  int types[MAX_FRAME_LOCALS]; /* 0=untyped; else bit width: 8/16/32/64 */
+  char **names;
+  int *types; /* 0=untyped; else bit width: 8/16/32/64 */
   int count;
+  int cap;
+  int *slots;   /* name index: local index + 1, 0 = empty */
+  int slot_cap; /* power of two */
 } LocalEnv;
 
+/**
+ * @brief Find a local by name in a given environment via its hash index.
+ *
+ * @return Local index, or -1 if the name is not defined in @p e.
+ */
+static int env_find(const LocalEnv *e, const char *name) {
+  if (e->slot_cap == 0) return -1;
+  uint32_t mask = (uint32_t)(e->slot_cap - 1);
+  for (uint32_t j = sym_hash(name) & mask; e->slots[j]; j = (j + 1) & mask) {
+    if (strcmp(e->names[e->slots[j] - 1], name) == 0) return e->slots[j] - 1;
+  }
+  return -1;
+}
+
+/**
+ * @brief Release the storage of a function's local environment.
+ */
+static void local_env_free(LocalEnv *e) {
+  for (int i = 0; i < e->count; ++i)
+    free(e->names[i]);
+  free(e->names);
+  free(e->types);
+  free(e->slots);
+  memset(e, 0, sizeof(*e));
+}
+
 static LocalEnv *g_locals = NULL;
 
 /* --- nested function environment tracking (for no-capture enforcement) --- */
@@ -347,10 +471,7 @@ static int name_in_outer_envs(const char *name) {
   if (g_func_env_depth <= 0) return 0;
   for (int d = g_func_env_depth - 1; d >= 0; --d) {
     LocalEnv *e = g_func_env_stack[d];
-    if (!e) continue;
-    for (int i = 0; i < e->count; ++i) {
-      if (e->names[i] && strcmp(e->names[i], name) == 0) return 1;
-    }
+    if (e && env_find(e, name) >= 0) return 1;
   }
   return 0;
 }
@@ -374,10 +495,7 @@ static LoopCtx *g_loop_ctx = NULL;
  */
 static int local_find(const char *name) {
   if (!g_locals) return -1;
-  for (int i = 0; i < g_locals->count; ++i) {
-    if (strcmp(g_locals->names[i], name) == 0) return i;
-  }
-  return -1;
+  return env_find(g_locals, name);
 }
 
 /**
@@ -388,17 +506,125 @@ static int local_find(const char *name) {
  */
 static int local_add(const char *name) {
   if (!g_locals) return -1;
-  if (g_locals->count >= MAX_FRAME_LOCALS) {
+  LocalEnv *e = g_locals;
+  if (e->count >= MAX_FRAME_LOCALS) {
     parser_fail(0, "Too many local variables/parameters (max %d)", MAX_FRAME_LOCALS);
     return -1;
   }
-  int idx = g_locals->count++;
-  g_locals->names[idx] = strdup(name);
+  if (e->count == e->cap) {
+    int ncap = e->cap ? e->cap * 2 : 16;
+    char **nn = (char **)realloc(e->names, sizeof(char *) * (size_t)ncap);
+    if (nn) e->names = nn;
+    int *nt = (int *)realloc(e->types, sizeof(int) * (size_t)ncap);
+    if (nt) e->types = nt;
+    if (!nn || !nt) {
+      parser_fail(0, "Out of memory growing local variables");
+      return -1;
+    }
+    e->cap = ncap;
+  }
+  if ((e->count + 1) * 2 > e->slot_cap) {
+    int ncap = e->slot_cap ? e->slot_cap * 2 : 32;
+    int *ns = (int *)calloc((size_t)ncap, sizeof(int));
+    if (!ns) {
+      parser_fail(0, "Out of memory growing local variables");
+      return -1;
+    }
+    for (int i = 0; i < e->count; ++i) {
+      uint32_t j = sym_hash(e->names[i]) & (uint32_t)(ncap - 1);
+      while (ns[j])
+        j = (j + 1) & (uint32_t)(ncap - 1);
+      ns[j] = i + 1;
+    }
+    free(e->slots);
+    e->slots = ns;
+    e->slot_cap = ncap;
+  }
+  char *copy = strdup(name);
+  if (!copy) {
+    parser_fail(0, "Out of memory growing local variables");
+    return -1;
+  }
+  int idx = e->count++;
+  e->names[idx] = copy;
+  e->types[idx] = 0;
+  uint32_t mask = (uint32_t)(e->slot_cap - 1);
+  uint32_t j = sym_hash(name) & mask;
+  while (e->slots[j])
+    j = (j + 1) & mask;
+  e->slots[j] = idx + 1;
   return idx;
 }
 
 /* forward declaration so helpers can recurse */
 static int emit_expression(Bytecode *bc, const char *src, size_t len, size_t *pos);
+static int emit_unary(Bytecode *bc, const char *src, size_t len, size_t *pos);
+
+/* Hidden temporary for builtin expansions: a local inside functions, else a global */
+static int temp_slot(const char *prefix) {
+  char name[64];
+  snprintf(name, sizeof(name), "__%s_%d", prefix, g_temp_counter++);
+  return g_locals ? local_add(name) : sym_index(name);
+}
+
+static void emit_temp(Bytecode *bc, int store, int slot) {
+  if (g_locals)
+    bytecode_add_instruction(bc, store ? OP_STORE_LOCAL : OP_LOAD_LOCAL, slot);
+  else
+    bytecode_add_instruction(bc, store ? OP_STORE_GLOBAL : OP_LOAD_GLOBAL, slot);
+}
+
+/**
+ * @brief Emit a loop that calls a function on every array item.
+ *
+ * Stack before: [array, fn]; after: [array, results] where results[i] is
+ * fn(array[i]). Used by count_by/group_by with a key function; the temps
+ * are cleared afterwards so they do not keep the arrays alive.
+ */
+static void emit_call_each(Bytecode *bc) {
+  int tfn = temp_slot("each_fn");
+  emit_temp(bc, 1, tfn);
+  int tarr = temp_slot("each_arr");
+  emit_temp(bc, 1, tarr);
+  int tres = temp_slot("each_res");
+  bytecode_add_instruction(bc, OP_MAKE_ARRAY, 0);
+  emit_temp(bc, 1, tres);
+  int ti = temp_slot("each_i");
+  int c0 = bytecode_add_constant(bc, make_int(0));
+  bytecode_add_instruction(bc, OP_LOAD_CONST, c0);
+  emit_temp(bc, 1, ti);
+  /* while i < len(arr): push(res, fn(arr[i])); i = i + 1 */
+  int loop_start = bc->instr_count;
+  emit_temp(bc, 0, ti);
+  emit_temp(bc, 0, tarr);
+  bytecode_add_instruction(bc, OP_LEN, 0);
+  bytecode_add_instruction(bc, OP_LT, 0);
+  int jf = bytecode_add_instruction(bc, OP_JUMP_IF_FALSE, 0);
+  emit_temp(bc, 0, tres);
+  emit_temp(bc, 0, tfn);
+  emit_temp(bc, 0, tarr);
+  emit_temp(bc, 0, ti);
+  bytecode_add_instruction(bc, OP_INDEX_GET, 0);
+  bytecode_add_instruction(bc, OP_CALL, 1);
+  bytecode_add_instruction(bc, OP_PUSH, 0);
+  bytecode_add_instruction(bc, OP_POP, 0);
+  int c1 = bytecode_add_constant(bc, make_int(1));
+  emit_temp(bc, 0, ti);
+  bytecode_add_instruction(bc, OP_LOAD_CONST, c1);
+  bytecode_add_instruction(bc, OP_ADD, 0);
+  emit_temp(bc, 1, ti);
+  bytecode_add_instruction(bc, OP_JUMP, loop_start);
+  bytecode_set_operand(bc, jf, bc->instr_count);
+  emit_temp(bc, 0, tarr);
+  emit_temp(bc, 0, tres);
+  int cn = bytecode_add_constant(bc, make_nil());
+  bytecode_add_instruction(bc, OP_LOAD_CONST, cn);
+  bytecode_add_instruction(bc, OP_DUP, 0);
+  bytecode_add_instruction(bc, OP_DUP, 0);
+  emit_temp(bc, 1, tfn);
+  emit_temp(bc, 1, tarr);
+  emit_temp(bc, 1, tres);
+}
 
 /* primary: (expr) | string | number | true/false | identifier */
 /**
@@ -426,7 +652,7 @@ static int emit_primary(Bytecode *bc, const char *src, size_t len, size_t *pos)
     }
 
     /* build locals from parameters */
-    LocalEnv env = {{0}, {0}, 0};
+    LocalEnv env = {NULL, NULL, 0, 0, NULL, 0};
     LocalEnv *prev = g_locals;
     int saved_depth = g_func_env_depth;
     /* push outer env for no-capture checks */
@@ -493,11 +719,14 @@ static int emit_primary(Bytecode *bc, const char *src, size_t len, size_t *pos)
     } else {
       /* empty body ok */
     }
+    /* implicit return nil (RETURN pops its value, so never leave the stack short) */
+    bytecode_add_instruction(fn_bc, OP_LOAD_CONST, bytecode_add_constant(fn_bc, make_nil()));
     bytecode_add_instruction(fn_bc, OP_RETURN, 0);
 
     /* restore env stack */
     g_locals = prev;
     g_func_env_depth = saved_depth;
+    local_env_free(&env);
 
     int fci = bytecode_add_constant(bc, make_function(fn_bc));
     bytecode_add_instruction(bc, OP_LOAD_CONST, fci);
@@ -669,7 +898,7 @@ static int emit_primary(Bytecode *bc, const char *src, size_t len, size_t *pos)
     return 1;
   }
 
-  /* map literal: { "key": expr, ... } */
+  /* map literal: { "key": expr, 1: expr, true: expr, ... } */
   skip_spaces(src, len, pos);
   if (*pos < len && src[*pos] == '{') {
     (*pos)++; /* '{' */
@@ -677,15 +906,17 @@ static int emit_primary(Bytecode *bc, const char *src, size_t len, size_t *pos)
     skip_spaces(src, len, pos);
     if (*pos < len && src[*pos] != '}') {
       for (;;) {
-        /* key must be a string literal */
+        /* key: a string literal, or a unary expression (number, boolean,
+         * variable) whose value MAKE_MAP checks is a string, number or boolean */
         char *k = parse_string_literal_any_quote(src, len, pos);
-        if (!k) {
-          parser_fail(*pos, "Expected string key in map literal");
+        if (k) {
+          int kci = bytecode_add_constant(bc, make_string(k));
+          free(k);
+          bytecode_add_instruction(bc, OP_LOAD_CONST, kci);
+        } else if (!emit_unary(bc, src, len, pos)) {
+          parser_fail(*pos, "Expected key in map literal");
           return 0;
         }
-        int kci = bytecode_add_constant(bc, make_string(k));
-        free(k);
-        bytecode_add_instruction(bc, OP_LOAD_CONST, kci);
         skip_spaces(src, len, pos);
         if (!consume_char(src, len, pos, ':')) {
           parser_fail(*pos, "Expected ':' after map key");
@@ -1186,2110 +1417,3364 @@ static int emit_primary(Bytecode *bc, const char *src, size_t len, size_t *pos)
         free(name);
         return 1;
       }
-      if (strcmp(name, "read_file") == 0) {
+      if (strcmp(name, "set_new") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "read_file expects 1 arg");
+        int has_arg = 0;
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] != ')') {
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "set_new expects 0 or 1 arg");
+            free(name);
+            return 0;
+          }
+          has_arg = 1;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "set_new expects 0 or 1 arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_READ_FILE, 0);
+        bytecode_add_instruction(bc, OP_SET_NEW, has_arg);
         free(name);
         return 1;
       }
-      if (strcmp(name, "write_file") == 0) {
+      if (strcmp(name, "set_add") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "write_file expects 2 args");
+          parser_fail(*pos, "set_add expects (set, value)");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "write_file expects 2 args");
+          parser_fail(*pos, "set_add expects (set, value)");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_WRITE_FILE, 0);
+        bytecode_add_instruction(bc, OP_SET_ADD, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "input") == 0) {
+      if (strcmp(name, "set_has") == 0) {
         (*pos)++; /* '(' */
-        int hasPrompt = 0;
-        skip_spaces(src, len, pos);
-        if (*pos < len && src[*pos] != ')') {
-          if (!emit_expression(bc, src, len, pos)) {
-            parser_fail(*pos, "input expects 0 or 1 argument");
-            free(name);
-            return 0;
-          }
-          hasPrompt = 1;
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "set_has expects (set, value)");
+          free(name);
+          return 0;
         }
-        if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after input arg(s)");
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "set_has expects (set, value)");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_INPUT_LINE, hasPrompt ? 1 : 0);
+        bytecode_add_instruction(bc, OP_HAS_KEY, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "input_hidden") == 0) {
+      if (strcmp(name, "set_remove") == 0) {
         (*pos)++; /* '(' */
-        int hasPrompt = 0;
-        skip_spaces(src, len, pos);
-        if (*pos < len && src[*pos] != ')') {
-          if (!emit_expression(bc, src, len, pos)) {
-            parser_fail(*pos, "input_hidden expects 0 or 1 argument");
-            free(name);
-            return 0;
-          }
-          hasPrompt = 1;
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "set_remove expects (set, value)");
+          free(name);
+          return 0;
         }
-        if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after input_hidden arg(s)");
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "set_remove expects (set, value)");
           free(name);
           return 0;
         }
-        /* operand bit0 = hasPrompt, bit1 = hidden */
-        bytecode_add_instruction(bc, OP_INPUT_LINE, (hasPrompt ? 1 : 0) | 2);
+        bytecode_add_instruction(bc, OP_SET_REMOVE, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "proc_run") == 0) {
+      if (strcmp(name, "map_remove") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "proc_run expects 1 argument (command string)");
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "map_remove expects (map, key)");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after proc_run arg");
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "map_remove expects (map, key)");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_PROC_RUN, 0);
+        bytecode_add_instruction(bc, OP_SET_REMOVE, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "system") == 0) {
+      if (strcmp(name, "set_union") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "system expects 1 argument (command string)");
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "set_union expects (set, set)");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after system arg");
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "set_union expects (set, set)");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_PROC_SYSTEM, 0);
+        bytecode_add_instruction(bc, OP_SET_UNION, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "time_now_ms") == 0) {
+      if (strcmp(name, "set_intersect") == 0) {
         (*pos)++; /* '(' */
-        if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "time_now_ms expects ()");
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "set_intersect expects (set, set)");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_TIME_NOW_MS, 0);
-        free(name);
-        return 1;
-      }
-      if (strcmp(name, "clock_mono_ms") == 0) {
-        (*pos)++; /* '(' */
-        if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "clock_mono_ms expects ()");
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "set_intersect expects (set, set)");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_CLOCK_MONO_MS, 0);
+        bytecode_add_instruction(bc, OP_SET_INTERSECT, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "date_format") == 0) {
+      if (strcmp(name, "map_incr") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "date_format expects (ms:int, fmt:string)");
-          free(name);
-          return 0;
-        }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "date_format expects 2 args");
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',') || !emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "map_incr expects (map, key [, delta])");
           free(name);
           return 0;
         }
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "date_format expects (ms:int, fmt:string)");
-          free(name);
-          return 0;
+        int has_delta = 0;
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "map_incr expects (map, key [, delta])");
+            free(name);
+            return 0;
+          }
+          has_delta = 1;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after date_format args");
+          parser_fail(*pos, "map_incr expects (map, key [, delta])");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_DATE_FORMAT, 0);
+        bytecode_add_instruction(bc, OP_MAP_INCR, has_delta);
         free(name);
         return 1;
       }
-      if (strcmp(name, "env") == 0) {
+      if (strcmp(name, "count_by") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "env expects 1 argument");
+          parser_fail(*pos, "count_by expects (array [, key_fn])");
           free(name);
           return 0;
         }
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "count_by expects (array [, key_fn])");
+            free(name);
+            return 0;
+          }
+          /* count the keys instead of the items */
+          emit_call_each(bc);
+          bytecode_add_instruction(bc, OP_SWAP, 0);
+          bytecode_add_instruction(bc, OP_POP, 0);
+        }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after env arg");
+          parser_fail(*pos, "count_by expects (array [, key_fn])");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_ENV, 0);
+        bytecode_add_instruction(bc, OP_COUNT_BY, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "env_all") == 0) {
+      if (strcmp(name, "group_by") == 0) {
         (*pos)++; /* '(' */
-        if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "env_all expects ()");
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',') || !emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "group_by expects (array, key_fn)");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_ENV_ALL, 0);
+        emit_call_each(bc);
+        bytecode_add_instruction(bc, OP_GROUP_BY, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "fun_version") == 0) {
+      if (strcmp(name, "read_file") == 0) {
         (*pos)++; /* '(' */
-        if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "fun_version expects ()");
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "read_file expects 1 arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_FUN_VERSION, 0);
+        bytecode_add_instruction(bc, OP_READ_FILE, 0);
         free(name);
         return 1;
       }
-      /* KCGI intrinsics (optional feature; opcodes are safe no-ops when disabled) */
-      if (strcmp(name, "kcgi_parse") == 0) {
+      if (strcmp(name, "write_file") == 0) {
         (*pos)++; /* '(' */
-        if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "kcgi_parse expects ()");
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "write_file expects 2 args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_KCGI_PARSE, 0);
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "write_file expects 2 args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_WRITE_FILE, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "kcgi_reply_start") == 0) {
+      if (strcmp(name, "csv_open") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "kcgi_reply_start expects (code:int, content_type:string)");
-          free(name);
-          return 0;
-        }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "kcgi_reply_start expects 2 args");
+          parser_fail(*pos, "csv_open expects (path_or_fd [, options])");
           free(name);
           return 0;
         }
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "kcgi_reply_start expects (code:int, content_type:string)");
-          free(name);
-          return 0;
+        int hasOpts = 0;
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "csv_open expects (path_or_fd [, options])");
+            free(name);
+            return 0;
+          }
+          hasOpts = 1;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after kcgi_reply_start args");
+          parser_fail(*pos, "Expected ')' after csv_open args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_KCGI_REPLY_START, 0);
+        bytecode_add_instruction(bc, OP_CSV_OPEN, hasOpts);
         free(name);
         return 1;
       }
-      if (strcmp(name, "kcgi_write") == 0) {
+      if (strcmp(name, "csv_next") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "kcgi_write expects (chunk:string)");
+          parser_fail(*pos, "csv_next expects 1 arg (reader)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after kcgi_write arg");
+          parser_fail(*pos, "Expected ')' after csv_next arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_KCGI_WRITE, 0);
+        bytecode_add_instruction(bc, OP_CSV_NEXT, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "kcgi_end") == 0) {
+      if (strcmp(name, "csv_read") == 0) {
         (*pos)++; /* '(' */
-        if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "kcgi_end expects ()");
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "csv_read expects (reader, count)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "csv_read expects (reader, count)");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_KCGI_END, 0);
-        free(name);
-        return 1;
-      }
-      if (strcmp(name, "rust_hello") == 0) {
-        (*pos)++; /* '(' */
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "rust_hello expects ()");
+          parser_fail(*pos, "Expected ')' after csv_read args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_RUST_HELLO, 0);
+        bytecode_add_instruction(bc, OP_CSV_READ, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "rust_hello_args") == 0) {
+      if (strcmp(name, "csv_header") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "rust_hello_args expects (message:string)");
+          parser_fail(*pos, "csv_header expects 1 arg (reader)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after rust_hello_args arg");
+          parser_fail(*pos, "Expected ')' after csv_header arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_RUST_HELLO_ARGS, 0);
+        bytecode_add_instruction(bc, OP_CSV_HEADER, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "rust_hello_args_return") == 0) {
+      if (strcmp(name, "csv_close") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "rust_hello_args_return expects (message:string)");
+          parser_fail(*pos, "csv_close expects 1 arg (reader)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after rust_hello_args_return arg");
+          parser_fail(*pos, "Expected ')' after csv_close arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_RUST_HELLO_ARGS_RETURN, 0);
+        bytecode_add_instruction(bc, OP_CSV_CLOSE, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "rust_get_sp") == 0) {
+      if (strcmp(name, "csv_parse") == 0) {
         (*pos)++; /* '(' */
-        if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "rust_get_sp expects ()");
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "csv_parse expects (text [, options])");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_RUST_GET_SP, 0);
-        free(name);
-        return 1;
-      }
-      if (strcmp(name, "rust_set_exit") == 0) {
-        (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "rust_set_exit expects (code:int)");
-          free(name);
-          return 0;
+        int hasOpts = 0;
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "csv_parse expects (text [, options])");
+            free(name);
+            return 0;
+          }
+          hasOpts = 1;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after rust_set_exit arg");
+          parser_fail(*pos, "Expected ')' after csv_parse args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_RUST_SET_EXIT, 0);
+        bytecode_add_instruction(bc, OP_CSV_PARSE, hasOpts);
         free(name);
         return 1;
       }
-      if (strcmp(name, "cpp_add") == 0) {
+      if (strcmp(name, "csv_writer") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "cpp_add expects (a:int, b:int)");
-          free(name);
-          return 0;
-        }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "cpp_add expects two arguments");
+          parser_fail(*pos, "csv_writer expects (path_or_fd [, options])");
           free(name);
           return 0;
         }
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "cpp_add expects (a:int, b:int)");
-          free(name);
-          return 0;
+        int hasOpts = 0;
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "csv_writer expects (path_or_fd [, options])");
+            free(name);
+            return 0;
+          }
+          hasOpts = 1;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after cpp_add args");
+          parser_fail(*pos, "Expected ')' after csv_writer args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_CPP_ADD, 0);
+        bytecode_add_instruction(bc, OP_CSV_WRITER, hasOpts);
         free(name);
         return 1;
       }
-      if (strcmp(name, "os_list_dir") == 0) {
+      if (strcmp(name, "csv_write") == 0) {
         (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "csv_write expects (writer, row_or_rows)");
+          free(name);
+          return 0;
+        }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "os_list_dir expects (path)");
+          parser_fail(*pos, "csv_write expects (writer, row_or_rows)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after os_list_dir arg");
+          parser_fail(*pos, "Expected ')' after csv_write args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_OS_LIST_DIR, 0);
+        bytecode_add_instruction(bc, OP_CSV_WRITE, 0);
         free(name);
         return 1;
       }
-      /* JSON builtins */
-      if (strcmp(name, "json_parse") == 0) {
+      if (strcmp(name, "csv_writer_close") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "json_parse expects (text)");
+          parser_fail(*pos, "csv_writer_close expects 1 arg (writer)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after json_parse arg");
+          parser_fail(*pos, "Expected ')' after csv_writer_close arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_JSON_PARSE, 0);
+        bytecode_add_instruction(bc, OP_CSV_WRITER_CLOSE, 0);
         free(name);
         return 1;
       }
-      /* XML builtins (minimal) */
-      if (strcmp(name, "xml_parse") == 0) {
+      if (strcmp(name, "csv_format") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "xml_parse expects (text)");
+          parser_fail(*pos, "csv_format expects (rows [, options])");
           free(name);
           return 0;
         }
+        int hasOpts = 0;
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "csv_format expects (rows [, options])");
+            free(name);
+            return 0;
+          }
+          hasOpts = 1;
+        }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after xml_parse arg");
+          parser_fail(*pos, "Expected ')' after csv_format args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_XML_PARSE, 0);
+        bytecode_add_instruction(bc, OP_CSV_FORMAT, hasOpts);
         free(name);
         return 1;
       }
-      if (strcmp(name, "xml_root") == 0) {
+      if (strcmp(name, "input") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "xml_root expects (doc_handle)");
-          free(name);
-          return 0;
+        int hasPrompt = 0;
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] != ')') {
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "input expects 0 or 1 argument");
+            free(name);
+            return 0;
+          }
+          hasPrompt = 1;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after xml_root arg");
+          parser_fail(*pos, "Expected ')' after input arg(s)");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_XML_ROOT, 0);
+        bytecode_add_instruction(bc, OP_INPUT_LINE, hasPrompt ? 1 : 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "xml_name") == 0) {
+      if (strcmp(name, "input_hidden") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "xml_name expects (node_handle)");
-          free(name);
-          return 0;
+        int hasPrompt = 0;
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] != ')') {
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "input_hidden expects 0 or 1 argument");
+            free(name);
+            return 0;
+          }
+          hasPrompt = 1;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after xml_name arg");
+          parser_fail(*pos, "Expected ')' after input_hidden arg(s)");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_XML_NAME, 0);
+        /* operand bit0 = hasPrompt, bit1 = hidden */
+        bytecode_add_instruction(bc, OP_INPUT_LINE, (hasPrompt ? 1 : 0) | 2);
         free(name);
         return 1;
       }
-      if (strcmp(name, "xml_text") == 0) {
+      if (strcmp(name, "proc_run") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "xml_text expects (node_handle)");
+          parser_fail(*pos, "proc_run expects 1 argument (command string)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after xml_text arg");
+          parser_fail(*pos, "Expected ')' after proc_run arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_XML_TEXT, 0);
+        bytecode_add_instruction(bc, OP_PROC_RUN, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "json_stringify") == 0) {
+      if (strcmp(name, "system") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "json_stringify expects (value, pretty)");
-          free(name);
-          return 0;
-        }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "json_stringify expects (value, pretty)");
-          free(name);
-          return 0;
-        }
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "json_stringify expects (value, pretty)");
+          parser_fail(*pos, "system expects 1 argument (command string)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after json_stringify args");
+          parser_fail(*pos, "Expected ')' after system arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_JSON_STRINGIFY, 0);
+        bytecode_add_instruction(bc, OP_PROC_SYSTEM, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "json_from_file") == 0) {
+      if (strcmp(name, "proc_fork") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "json_from_file expects (path)");
-          free(name);
-          return 0;
-        }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after json_from_file arg");
+          parser_fail(*pos, "proc_fork expects ()");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_JSON_FROM_FILE, 0);
+        bytecode_add_instruction(bc, OP_PROC_FORK, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "json_to_file") == 0) {
+      if (strcmp(name, "proc_waitpid") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "json_to_file expects (path, value, pretty)");
+          parser_fail(*pos, "proc_waitpid expects 1 argument (pid)");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "json_to_file expects (path, value, pretty)");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after proc_waitpid arg");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_PROC_WAITPID, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "proc_kill") == 0) {
+        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "json_to_file expects (path, value, pretty)");
+          parser_fail(*pos, "proc_kill expects (pid, signal)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "json_to_file expects (path, value, pretty)");
+          parser_fail(*pos, "proc_kill expects (pid, signal)");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "json_to_file expects (path, value, pretty)");
+          parser_fail(*pos, "proc_kill expects (pid, signal)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after json_to_file args");
+          parser_fail(*pos, "Expected ')' after proc_kill args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_JSON_TO_FILE, 0);
+        bytecode_add_instruction(bc, OP_PROC_KILL, 0);
         free(name);
         return 1;
       }
-      /* INI (iniparser 4.2.6) builtins */
-      if (strcmp(name, "ini_load") == 0) {
+      if (strcmp(name, "proc_getpid") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_load expects (path)");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "proc_getpid expects ()");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_PROC_GETPID, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "proc_getppid") == 0) {
+        (*pos)++; /* '(' */
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after ini_load arg");
+          parser_fail(*pos, "proc_getppid expects ()");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_INI_LOAD, 0);
+        bytecode_add_instruction(bc, OP_PROC_GETPPID, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "ini_free") == 0) {
+      if (strcmp(name, "proc_spawn") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_free expects (handle)");
+          parser_fail(*pos, "proc_spawn expects (argv [, options])");
           free(name);
           return 0;
         }
+        int hasOpts = 0;
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "proc_spawn expects (argv [, options])");
+            free(name);
+            return 0;
+          }
+          hasOpts = 1;
+        }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after ini_free arg");
+          parser_fail(*pos, "Expected ')' after proc_spawn args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_INI_FREE, 0);
+        bytecode_add_instruction(bc, OP_PROC_SPAWN, hasOpts);
         free(name);
         return 1;
       }
-      if (strcmp(name, "ini_get_string") == 0) {
+      if (strcmp(name, "proc_write") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_get_string expects (handle, section, key, default)");
+          parser_fail(*pos, "proc_write expects (handle, data)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "ini_get_string expects 4 args");
+          parser_fail(*pos, "proc_write expects (handle, data)");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_get_string expects 4 args");
+          parser_fail(*pos, "proc_write expects (handle, data)");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "ini_get_string expects 4 args");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after proc_write args");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_PROC_WRITE, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "proc_close_stdin") == 0) {
+        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_get_string expects 4 args");
+          parser_fail(*pos, "proc_close_stdin expects (handle)");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "ini_get_string expects 4 args");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after proc_close_stdin arg");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_PROC_CLOSE_STDIN, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "proc_read") == 0) {
+        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_get_string expects 4 args");
+          parser_fail(*pos, "proc_read expects (handle [, stream])");
           free(name);
           return 0;
         }
+        int hasStream = 0;
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "proc_read expects (handle [, stream])");
+            free(name);
+            return 0;
+          }
+          hasStream = 1;
+        }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after ini_get_string args");
+          parser_fail(*pos, "Expected ')' after proc_read args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_INI_GET_STRING, 0);
+        bytecode_add_instruction(bc, OP_PROC_READ, hasStream);
         free(name);
         return 1;
       }
-      if (strcmp(name, "ini_get_int") == 0) {
+      if (strcmp(name, "proc_poll") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_get_int expects (handle, section, key, default)");
+          parser_fail(*pos, "proc_poll expects (handle)");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "ini_get_int expects 4 args");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after proc_poll arg");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_PROC_POLL, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "proc_wait") == 0) {
+        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_get_int expects 4 args");
+          parser_fail(*pos, "proc_wait expects (handle [, timeout_ms])");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "ini_get_int expects 4 args");
+        int hasTimeout = 0;
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "proc_wait expects (handle [, timeout_ms])");
+            free(name);
+            return 0;
+          }
+          hasTimeout = 1;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after proc_wait args");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_PROC_WAIT, hasTimeout);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "proc_wait_many") == 0) {
+        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_get_int expects 4 args");
+          parser_fail(*pos, "proc_wait_many expects (handles [, timeout_ms])");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "ini_get_int expects 4 args");
+        int hasTimeout = 0;
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "proc_wait_many expects (handles [, timeout_ms])");
+            free(name);
+            return 0;
+          }
+          hasTimeout = 1;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after proc_wait_many args");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_PROC_WAIT_MANY, hasTimeout);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "proc_pid") == 0) {
+        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_get_int expects 4 args");
+          parser_fail(*pos, "proc_pid expects (handle)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after ini_get_int args");
+          parser_fail(*pos, "Expected ')' after proc_pid arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_INI_GET_INT, 0);
+        bytecode_add_instruction(bc, OP_PROC_PID, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "ini_get_double") == 0) {
+      if (strcmp(name, "proc_close") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_get_double expects (handle, section, key, default)");
+          parser_fail(*pos, "proc_close expects (handle)");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "ini_get_double expects 4 args");
-          free(name);
-          return 0;
-        }
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_get_double expects 4 args");
-          free(name);
-          return 0;
-        }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "ini_get_double expects 4 args");
-          free(name);
-          return 0;
-        }
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_get_double expects 4 args");
-          free(name);
-          return 0;
-        }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "ini_get_double expects 4 args");
-          free(name);
-          return 0;
-        }
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_get_double expects 4 args");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after proc_close arg");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_PROC_CLOSE, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "time_now_ms") == 0) {
+        (*pos)++; /* '(' */
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after ini_get_double args");
+          parser_fail(*pos, "time_now_ms expects ()");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_INI_GET_DOUBLE, 0);
+        bytecode_add_instruction(bc, OP_TIME_NOW_MS, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "ini_get_bool") == 0) {
+      if (strcmp(name, "clock_mono_ms") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_get_bool expects (handle, section, key, default)");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "clock_mono_ms expects ()");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "ini_get_bool expects 4 args");
+        bytecode_add_instruction(bc, OP_CLOCK_MONO_MS, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "clock_mono_ns") == 0) {
+        (*pos)++; /* '(' */
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "clock_mono_ns expects ()");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_CLOCK_MONO_NS, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "date_format") == 0) {
+        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_get_bool expects 4 args");
+          parser_fail(*pos, "date_format expects (ms:int, fmt:string)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "ini_get_bool expects 4 args");
+          parser_fail(*pos, "date_format expects 2 args");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_get_bool expects 4 args");
+          parser_fail(*pos, "date_format expects (ms:int, fmt:string)");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "ini_get_bool expects 4 args");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after date_format args");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_DATE_FORMAT, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "env") == 0) {
+        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_get_bool expects 4 args");
+          parser_fail(*pos, "env expects 1 argument");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after ini_get_bool args");
+          parser_fail(*pos, "Expected ')' after env arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_INI_GET_BOOL, 0);
+        bytecode_add_instruction(bc, OP_ENV, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "ini_set") == 0) {
+      if (strcmp(name, "env_all") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_set expects (handle, section, key, value)");
-          free(name);
-          return 0;
-        }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "ini_set expects 4 args");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "env_all expects ()");
           free(name);
           return 0;
         }
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_set expects 4 args");
+        bytecode_add_instruction(bc, OP_ENV_ALL, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "fun_version") == 0) {
+        (*pos)++; /* '(' */
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "fun_version expects ()");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "ini_set expects 4 args");
+        bytecode_add_instruction(bc, OP_FUN_VERSION, 0);
+        free(name);
+        return 1;
+      }
+      /* KCGI intrinsics (optional feature; opcodes are safe no-ops when disabled) */
+      if (strcmp(name, "kcgi_parse") == 0) {
+        (*pos)++; /* '(' */
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "kcgi_parse expects ()");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_KCGI_PARSE, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "kcgi_reply_start") == 0) {
+        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_set expects 4 args");
+          parser_fail(*pos, "kcgi_reply_start expects (code:int, content_type:string)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "ini_set expects 4 args");
+          parser_fail(*pos, "kcgi_reply_start expects 2 args");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_set expects 4 args");
+          parser_fail(*pos, "kcgi_reply_start expects (code:int, content_type:string)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after ini_set args");
+          parser_fail(*pos, "Expected ')' after kcgi_reply_start args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_INI_SET, 0);
+        bytecode_add_instruction(bc, OP_KCGI_REPLY_START, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "ini_unset") == 0) {
+      if (strcmp(name, "kcgi_write") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_unset expects (handle, section, key)");
-          free(name);
-          return 0;
-        }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "ini_unset expects 3 args");
-          free(name);
-          return 0;
-        }
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_unset expects 3 args");
+          parser_fail(*pos, "kcgi_write expects (chunk:string)");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "ini_unset expects 3 args");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after kcgi_write arg");
           free(name);
           return 0;
         }
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_unset expects 3 args");
+        bytecode_add_instruction(bc, OP_KCGI_WRITE, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "kcgi_end") == 0) {
+        (*pos)++; /* '(' */
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "kcgi_end expects ()");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_KCGI_END, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "rust_hello") == 0) {
+        (*pos)++; /* '(' */
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after ini_unset args");
+          parser_fail(*pos, "rust_hello expects ()");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_INI_UNSET, 0);
+        bytecode_add_instruction(bc, OP_RUST_HELLO, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "ini_save") == 0) {
+      if (strcmp(name, "rust_hello_args") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_save expects (handle, path)");
+          parser_fail(*pos, "rust_hello_args expects (message:string)");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "ini_save expects 2 args");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after rust_hello_args arg");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_RUST_HELLO_ARGS, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "rust_hello_args_return") == 0) {
+        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "ini_save expects 2 args");
+          parser_fail(*pos, "rust_hello_args_return expects (message:string)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after ini_save args");
+          parser_fail(*pos, "Expected ')' after rust_hello_args_return arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_INI_SAVE, 0);
+        bytecode_add_instruction(bc, OP_RUST_HELLO_ARGS_RETURN, 0);
         free(name);
         return 1;
       }
-      /* CURL builtins (minimal interface like JSON) */
-      if (strcmp(name, "curl_get") == 0) {
+      if (strcmp(name, "rust_get_sp") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "curl_get expects (url)");
-          free(name);
-          return 0;
-        }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after curl_get arg");
+          parser_fail(*pos, "rust_get_sp expects ()");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_CURL_GET, 0);
+        bytecode_add_instruction(bc, OP_RUST_GET_SP, 0);
         free(name);
         return 1;
       }
-      /* SQLite builtins */
-      if (strcmp(name, "sqlite_open") == 0) {
+      if (strcmp(name, "rust_set_exit") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "sqlite_open expects (path)");
+          parser_fail(*pos, "rust_set_exit expects (code:int)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after sqlite_open arg");
+          parser_fail(*pos, "Expected ')' after rust_set_exit arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_SQLITE_OPEN, 0);
+        bytecode_add_instruction(bc, OP_RUST_SET_EXIT, 0);
         free(name);
         return 1;
       }
-      /* Redis builtins (hiredis) */
-      if (strcmp(name, "redis_connect") == 0) {
+      if (strcmp(name, "cpp_add") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "redis_connect expects (host, port)");
+          parser_fail(*pos, "cpp_add expects (a:int, b:int)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "redis_connect expects (host, port)");
+          parser_fail(*pos, "cpp_add expects two arguments");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "redis_connect expects (host, port)");
+          parser_fail(*pos, "cpp_add expects (a:int, b:int)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after redis_connect args");
+          parser_fail(*pos, "Expected ')' after cpp_add args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_REDIS_CONNECT, 0);
+        bytecode_add_instruction(bc, OP_CPP_ADD, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "redis_cmd") == 0) {
+      if (strcmp(name, "os_list_dir") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "redis_cmd expects (handle, cmd)");
+          parser_fail(*pos, "os_list_dir expects (path)");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "redis_cmd expects (handle, cmd)");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after os_list_dir arg");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_OS_LIST_DIR, 0);
+        free(name);
+        return 1;
+      }
+      /* JSON builtins */
+      if (strcmp(name, "json_parse") == 0) {
+        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "redis_cmd expects (handle, cmd)");
+          parser_fail(*pos, "json_parse expects (text)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after redis_cmd args");
+          parser_fail(*pos, "Expected ')' after json_parse arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_REDIS_CMD, 0);
+        bytecode_add_instruction(bc, OP_JSON_PARSE, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "redis_close") == 0) {
+      /* XML builtins (minimal) */
+      if (strcmp(name, "xml_parse") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "redis_close expects (handle)");
+          parser_fail(*pos, "xml_parse expects (text)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after redis_close arg");
+          parser_fail(*pos, "Expected ')' after xml_parse arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_REDIS_CLOSE, 0);
+        bytecode_add_instruction(bc, OP_XML_PARSE, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "sqlite_close") == 0) {
+      if (strcmp(name, "xml_root") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "sqlite_close expects (handle)");
+          parser_fail(*pos, "xml_root expects (doc_handle)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after sqlite_close arg");
+          parser_fail(*pos, "Expected ')' after xml_root arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_SQLITE_CLOSE, 0);
+        bytecode_add_instruction(bc, OP_XML_ROOT, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "sqlite_exec") == 0) {
+      if (strcmp(name, "xml_name") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "sqlite_exec expects (handle, sql)");
+          parser_fail(*pos, "xml_name expects (node_handle)");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "sqlite_exec expects (handle, sql)");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after xml_name arg");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_XML_NAME, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "xml_text") == 0) {
+        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "sqlite_exec expects (handle, sql)");
+          parser_fail(*pos, "xml_text expects (node_handle)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after sqlite_exec args");
+          parser_fail(*pos, "Expected ')' after xml_text arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_SQLITE_EXEC, 0);
+        bytecode_add_instruction(bc, OP_XML_TEXT, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "sqlite_query") == 0) {
+      if (strcmp(name, "xml_free") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "sqlite_query expects (handle, sql)");
+          parser_fail(*pos, "xml_free expects (doc_handle)");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "sqlite_query expects (handle, sql)");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after xml_free arg");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_XML_FREE, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "xml_children") == 0) {
+        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "sqlite_query expects (handle, sql)");
+          parser_fail(*pos, "xml_children expects (node_handle)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after sqlite_query args");
+          parser_fail(*pos, "Expected ')' after xml_children arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_SQLITE_QUERY, 0);
+        bytecode_add_instruction(bc, OP_XML_CHILDREN, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "curl_post") == 0) {
+      if (strcmp(name, "xml_next") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "curl_post expects (url, body)");
+          parser_fail(*pos, "xml_next expects (node_handle)");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "curl_post expects (url, body)");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after xml_next arg");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_XML_NEXT, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "xml_parent") == 0) {
+        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "curl_post expects (url, body)");
+          parser_fail(*pos, "xml_parent expects (node_handle)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after curl_post args");
+          parser_fail(*pos, "Expected ')' after xml_parent arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_CURL_POST, 0);
+        bytecode_add_instruction(bc, OP_XML_PARENT, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "curl_download") == 0) {
+      if (strcmp(name, "xml_attrs") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "curl_download expects (url, path)");
+          parser_fail(*pos, "xml_attrs expects (node_handle)");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "curl_download expects (url, path)");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after xml_attrs arg");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_XML_ATTRS, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "xml_attr") == 0) {
+        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "curl_download expects (url, path)");
+          parser_fail(*pos, "xml_attr expects (node_handle, name)");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after curl_download args");
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "xml_attr expects 2 args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_CURL_DOWNLOAD, 0);
-        free(name);
-        return 1;
-      }
-      /* OpenSSL (md5/sha256/sha512) */
-      if (strcmp(name, "openssl_md5") == 0) {
-        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "openssl_md5 expects (data)");
+          parser_fail(*pos, "xml_attr expects (node_handle, name)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after openssl_md5 arg");
+          parser_fail(*pos, "Expected ')' after xml_attr args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_OPENSSL_MD5, 0);
+        bytecode_add_instruction(bc, OP_XML_ATTR, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "openssl_sha256") == 0) {
+      if (strcmp(name, "xml_xpath") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "openssl_sha256 expects (data)");
+          parser_fail(*pos, "xml_xpath expects (node_handle, expr [, namespaces])");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after openssl_sha256 arg");
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "xml_xpath expects (node_handle, expr [, namespaces])");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_OPENSSL_SHA256, 0);
-        free(name);
-        return 1;
-      }
-      if (strcmp(name, "openssl_sha512") == 0) {
-        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "openssl_sha512 expects (data)");
+          parser_fail(*pos, "xml_xpath expects (node_handle, expr [, namespaces])");
           free(name);
           return 0;
         }
+        int hasNs = 0;
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "xml_xpath expects (node_handle, expr [, namespaces])");
+            free(name);
+            return 0;
+          }
+          hasNs = 1;
+        }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after openssl_sha512 arg");
+          parser_fail(*pos, "Expected ')' after xml_xpath args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_OPENSSL_SHA512, 0);
+        bytecode_add_instruction(bc, OP_XML_XPATH, hasNs);
         free(name);
         return 1;
       }
-      if (strcmp(name, "openssl_ripemd160") == 0) {
+      if (strcmp(name, "xml_reader_open") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "openssl_ripemd160 expects (data)");
+          parser_fail(*pos, "xml_reader_open expects (path)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after openssl_ripemd160 arg");
+          parser_fail(*pos, "Expected ')' after xml_reader_open arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_OPENSSL_RIPEMD160, 0);
+        bytecode_add_instruction(bc, OP_XML_READER_OPEN, 0);
         free(name);
         return 1;
       }
-      /* LibreSSL builtins removed */
-      /* PCSC builtins */
-      if (strcmp(name, "pcsc_establish") == 0) {
+      if (strcmp(name, "xml_reader_next") == 0) {
         (*pos)++; /* '(' */
-        /* no args */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "xml_reader_next expects (reader)");
+          free(name);
+          return 0;
+        }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "pcsc_establish expects ()");
+          parser_fail(*pos, "Expected ')' after xml_reader_next arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_PCSC_ESTABLISH, 0);
+        bytecode_add_instruction(bc, OP_XML_READER_NEXT, 0);
         free(name);
         return 1;
       }
-      /* PCRE2 builtins */
-      if (strcmp(name, "pcre2_test") == 0) {
+      if (strcmp(name, "xml_reader_record") == 0) {
         (*pos)++; /* '(' */
-        /* (pattern, text, flags) */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "pcre2_test expects (pattern, text, flags)");
+          parser_fail(*pos, "xml_reader_record expects (reader, element_name)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "pcre2_test expects (pattern, text, flags)");
+          parser_fail(*pos, "xml_reader_record expects 2 args");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "pcre2_test expects (pattern, text, flags)");
+          parser_fail(*pos, "xml_reader_record expects (reader, element_name)");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "pcre2_test expects (pattern, text, flags)");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after xml_reader_record args");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_XML_READER_RECORD, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "xml_reader_close") == 0) {
+        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "pcre2_test expects (pattern, text, flags)");
+          parser_fail(*pos, "xml_reader_close expects (reader)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after pcre2_test args");
+          parser_fail(*pos, "Expected ')' after xml_reader_close arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_PCRE2_TEST, 0);
+        bytecode_add_instruction(bc, OP_XML_READER_CLOSE, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "pcre2_match") == 0) {
+      if (strcmp(name, "json_stringify") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "pcre2_match expects (pattern, text, flags)");
+          parser_fail(*pos, "json_stringify expects (value, pretty)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "pcre2_match expects (pattern, text, flags)");
+          parser_fail(*pos, "json_stringify expects (value, pretty)");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "pcre2_match expects (pattern, text, flags)");
+          parser_fail(*pos, "json_stringify expects (value, pretty)");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "pcre2_match expects (pattern, text, flags)");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after json_stringify args");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_JSON_STRINGIFY, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "json_from_file") == 0) {
+        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "pcre2_match expects (pattern, text, flags)");
+          parser_fail(*pos, "json_from_file expects (path)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after pcre2_match args");
+          parser_fail(*pos, "Expected ')' after json_from_file arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_PCRE2_MATCH, 0);
+        bytecode_add_instruction(bc, OP_JSON_FROM_FILE, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "pcre2_findall") == 0) {
+      if (strcmp(name, "json_to_file") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "pcre2_findall expects (pattern, text, flags)");
+          parser_fail(*pos, "json_to_file expects (path, value, pretty)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "pcre2_findall expects (pattern, text, flags)");
+          parser_fail(*pos, "json_to_file expects (path, value, pretty)");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "pcre2_findall expects (pattern, text, flags)");
+          parser_fail(*pos, "json_to_file expects (path, value, pretty)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "pcre2_findall expects (pattern, text, flags)");
+          parser_fail(*pos, "json_to_file expects (path, value, pretty)");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "pcre2_findall expects (pattern, text, flags)");
+          parser_fail(*pos, "json_to_file expects (path, value, pretty)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after pcre2_findall args");
+          parser_fail(*pos, "Expected ')' after json_to_file args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_PCRE2_FINDALL, 0);
+        bytecode_add_instruction(bc, OP_JSON_TO_FILE, 0);
         free(name);
         return 1;
       }
-      /* PCSC builtins (optional) */
-      if (strcmp(name, "pcsc_release") == 0) {
+      /* INI (iniparser 4.2.6) builtins */
+      if (strcmp(name, "ini_load") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "pcsc_release expects 1 argument (ctx)");
+          parser_fail(*pos, "ini_load expects (path)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after pcsc_release arg");
+          parser_fail(*pos, "Expected ')' after ini_load arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_PCSC_RELEASE, 0);
+        bytecode_add_instruction(bc, OP_INI_LOAD, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "pcsc_list_readers") == 0) {
+      if (strcmp(name, "ini_free") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "pcsc_list_readers expects 1 argument (ctx)");
+          parser_fail(*pos, "ini_free expects (handle)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after pcsc_list_readers arg");
+          parser_fail(*pos, "Expected ')' after ini_free arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_PCSC_LIST_READERS, 0);
+        bytecode_add_instruction(bc, OP_INI_FREE, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "pcsc_connect") == 0) {
+      if (strcmp(name, "ini_get_string") == 0) {
         (*pos)++; /* '(' */
-        /* ctx, reader */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "pcsc_connect expects (ctx, reader)");
+          parser_fail(*pos, "ini_get_string expects (handle, section, key, default)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "pcsc_connect expects (ctx, reader)");
+          parser_fail(*pos, "ini_get_string expects 4 args");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "pcsc_connect expects (ctx, reader)");
+          parser_fail(*pos, "ini_get_string expects 4 args");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after pcsc_connect args");
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "ini_get_string expects 4 args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_PCSC_CONNECT, 0);
-        free(name);
-        return 1;
-      }
-      if (strcmp(name, "pcsc_disconnect") == 0) {
-        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "pcsc_disconnect expects 1 argument (handle)");
+          parser_fail(*pos, "ini_get_string expects 4 args");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "ini_get_string expects 4 args");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "ini_get_string expects 4 args");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after pcsc_disconnect arg");
+          parser_fail(*pos, "Expected ')' after ini_get_string args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_PCSC_DISCONNECT, 0);
+        bytecode_add_instruction(bc, OP_INI_GET_STRING, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "pcsc_transmit") == 0) {
+      if (strcmp(name, "ini_get_int") == 0) {
         (*pos)++; /* '(' */
-        /* handle, bytes */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "pcsc_transmit expects (handle, bytes)");
+          parser_fail(*pos, "ini_get_int expects (handle, section, key, default)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "pcsc_transmit expects (handle, bytes)");
+          parser_fail(*pos, "ini_get_int expects 4 args");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "pcsc_transmit expects (handle, bytes)");
+          parser_fail(*pos, "ini_get_int expects 4 args");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after pcsc_transmit args");
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "ini_get_int expects 4 args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_PCSC_TRANSMIT, 0);
-        free(name);
-        return 1;
-      }
-      /* Socket builtins */
-      if (strcmp(name, "tcp_listen") == 0) {
-        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "tcp_listen expects (port, backlog)");
+          parser_fail(*pos, "ini_get_int expects 4 args");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "tcp_listen expects (port, backlog)");
+          parser_fail(*pos, "ini_get_int expects 4 args");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "tcp_listen expects (port, backlog)");
+          parser_fail(*pos, "ini_get_int expects 4 args");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after tcp_listen args");
+          parser_fail(*pos, "Expected ')' after ini_get_int args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_SOCK_TCP_LISTEN, 0);
+        bytecode_add_instruction(bc, OP_INI_GET_INT, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "tcp_accept") == 0) {
+      if (strcmp(name, "ini_get_double") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "tcp_accept expects (listen_fd)");
+          parser_fail(*pos, "ini_get_double expects (handle, section, key, default)");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after tcp_accept arg");
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "ini_get_double expects 4 args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_SOCK_TCP_ACCEPT, 0);
-        free(name);
-        return 1;
-      }
-      if (strcmp(name, "tcp_connect") == 0) {
-        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "tcp_connect expects (host, port)");
+          parser_fail(*pos, "ini_get_double expects 4 args");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "tcp_connect expects (host, port)");
+          parser_fail(*pos, "ini_get_double expects 4 args");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "tcp_connect expects (host, port)");
+          parser_fail(*pos, "ini_get_double expects 4 args");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "ini_get_double expects 4 args");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "ini_get_double expects 4 args");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after tcp_connect args");
+          parser_fail(*pos, "Expected ')' after ini_get_double args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_SOCK_TCP_CONNECT, 0);
+        bytecode_add_instruction(bc, OP_INI_GET_DOUBLE, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "sock_send") == 0) {
+      if (strcmp(name, "ini_get_bool") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "sock_send expects (fd, data)");
+          parser_fail(*pos, "ini_get_bool expects (handle, section, key, default)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "sock_send expects (fd, data)");
+          parser_fail(*pos, "ini_get_bool expects 4 args");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "sock_send expects (fd, data)");
+          parser_fail(*pos, "ini_get_bool expects 4 args");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after sock_send args");
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "ini_get_bool expects 4 args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_SOCK_SEND, 0);
-        free(name);
-        return 1;
-      }
-      if (strcmp(name, "sock_recv") == 0) {
-        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "sock_recv expects (fd, maxlen)");
+          parser_fail(*pos, "ini_get_bool expects 4 args");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "sock_recv expects (fd, maxlen)");
+          parser_fail(*pos, "ini_get_bool expects 4 args");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "sock_recv expects (fd, maxlen)");
+          parser_fail(*pos, "ini_get_bool expects 4 args");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after sock_recv args");
+          parser_fail(*pos, "Expected ')' after ini_get_bool args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_SOCK_RECV, 0);
+        bytecode_add_instruction(bc, OP_INI_GET_BOOL, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "sock_close") == 0) {
+      if (strcmp(name, "ini_set") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "sock_close expects (fd)");
+          parser_fail(*pos, "ini_set expects (handle, section, key, value)");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after sock_close arg");
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "ini_set expects 4 args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_SOCK_CLOSE, 0);
-        free(name);
-        return 1;
-      }
-      if (strcmp(name, "unix_listen") == 0) {
-        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "unix_listen expects (path, backlog)");
+          parser_fail(*pos, "ini_set expects 4 args");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "unix_listen expects (path, backlog)");
+          parser_fail(*pos, "ini_set expects 4 args");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "unix_listen expects (path, backlog)");
+          parser_fail(*pos, "ini_set expects 4 args");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after unix_listen args");
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "ini_set expects 4 args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_SOCK_UNIX_LISTEN, 0);
-        free(name);
-        return 1;
-      }
-      if (strcmp(name, "unix_connect") == 0) {
-        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "unix_connect expects (path)");
+          parser_fail(*pos, "ini_set expects 4 args");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after unix_connect arg");
+          parser_fail(*pos, "Expected ')' after ini_set args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_SOCK_UNIX_CONNECT, 0);
+        bytecode_add_instruction(bc, OP_INI_SET, 0);
         free(name);
         return 1;
       }
-      /* Async-friendly FD helpers */
-      if (strcmp(name, "fd_set_nonblock") == 0) {
+      if (strcmp(name, "ini_unset") == 0) {
         (*pos)++; /* '(' */
-        /* Expect (fd, on) -> push fd then on so VM pops on first */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "fd_set_nonblock expects (fd, on)");
+          parser_fail(*pos, "ini_unset expects (handle, section, key)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "fd_set_nonblock expects (fd, on)");
+          parser_fail(*pos, "ini_unset expects 3 args");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "fd_set_nonblock expects (fd, on)");
+          parser_fail(*pos, "ini_unset expects 3 args");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "ini_unset expects 3 args");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "ini_unset expects 3 args");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after fd_set_nonblock args");
+          parser_fail(*pos, "Expected ')' after ini_unset args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_FD_SET_NONBLOCK, 0);
+        bytecode_add_instruction(bc, OP_INI_UNSET, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "fd_poll_read") == 0) {
+      if (strcmp(name, "ini_save") == 0) {
         (*pos)++; /* '(' */
-        /* Expect (fd, timeout_ms) -> push fd then timeout so VM pops timeout first */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "fd_poll_read expects (fd, timeout_ms)");
+          parser_fail(*pos, "ini_save expects (handle, path)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "fd_poll_read expects (fd, timeout_ms)");
+          parser_fail(*pos, "ini_save expects 2 args");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "fd_poll_read expects (fd, timeout_ms)");
+          parser_fail(*pos, "ini_save expects 2 args");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after fd_poll_read args");
+          parser_fail(*pos, "Expected ')' after ini_save args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_FD_POLL_READ, 0);
+        bytecode_add_instruction(bc, OP_INI_SAVE, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "fd_poll_write") == 0) {
+      /* CURL builtins (minimal interface like JSON) */
+      if (strcmp(name, "curl_get") == 0) {
         (*pos)++; /* '(' */
-        /* Expect (fd, timeout_ms) */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "fd_poll_write expects (fd, timeout_ms)");
+          parser_fail(*pos, "curl_get expects (url)");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "fd_poll_write expects (fd, timeout_ms)");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after curl_get arg");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_CURL_GET, 0);
+        free(name);
+        return 1;
+      }
+      /* SQLite builtins */
+      if (strcmp(name, "sqlite_open") == 0) {
+        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "fd_poll_write expects (fd, timeout_ms)");
+          parser_fail(*pos, "sqlite_open expects (path)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after fd_poll_write args");
+          parser_fail(*pos, "Expected ')' after sqlite_open arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_FD_POLL_WRITE, 0);
+        bytecode_add_instruction(bc, OP_SQLITE_OPEN, 0);
         free(name);
         return 1;
       }
-      /* Serial builtins */
-      if (strcmp(name, "serial_open") == 0) {
+      /* Redis builtins (hiredis) */
+      if (strcmp(name, "redis_connect") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "serial_open expects (path, baud)");
+          parser_fail(*pos, "redis_connect expects (host, port)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "serial_open expects (path, baud)");
+          parser_fail(*pos, "redis_connect expects (host, port)");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "serial_open expects (path, baud)");
-          free(name);
-          return 0;
-        }
-        if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after serial_open args");
+          parser_fail(*pos, "redis_connect expects (host, port)");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_SERIAL_OPEN, 0);
-        free(name);
-        return 1;
-      }
-      if (strcmp(name, "serial_config") == 0) {
-        (*pos)++; /* '(' */
-        // fd, data_bits, parity, stop_bits, flow_control
-        for (int i = 0; i < 5; ++i) {
-          if (!emit_expression(bc, src, len, pos)) {
-            parser_fail(*pos, "serial_config expects 5 arguments");
-            free(name);
-            return 0;
-          }
-          if (i < 4) {
-            if (!consume_char(src, len, pos, ',')) {
-              parser_fail(*pos, "serial_config expects 5 arguments");
-              free(name);
-              return 0;
-            }
-          }
-        }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after serial_config args");
+          parser_fail(*pos, "Expected ')' after redis_connect args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_SERIAL_CONFIG, 0);
+        bytecode_add_instruction(bc, OP_REDIS_CONNECT, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "serial_send") == 0) {
+      if (strcmp(name, "redis_cmd") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "serial_send expects (fd, data)");
+          parser_fail(*pos, "redis_cmd expects (handle, cmd)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "serial_send expects (fd, data)");
+          parser_fail(*pos, "redis_cmd expects (handle, cmd)");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "serial_send expects (fd, data)");
+          parser_fail(*pos, "redis_cmd expects (handle, cmd)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after serial_send args");
+          parser_fail(*pos, "Expected ')' after redis_cmd args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_SERIAL_SEND, 0);
+        bytecode_add_instruction(bc, OP_REDIS_CMD, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "serial_recv") == 0) {
+      if (strcmp(name, "redis_close") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "serial_recv expects (fd, maxlen)");
-          free(name);
-          return 0;
-        }
-        if (!consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "serial_recv expects (fd, maxlen)");
-          free(name);
-          return 0;
-        }
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "serial_recv expects (fd, maxlen)");
+          parser_fail(*pos, "redis_close expects (handle)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after serial_recv args");
+          parser_fail(*pos, "Expected ')' after redis_close arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_SERIAL_RECV, 0);
+        bytecode_add_instruction(bc, OP_REDIS_CLOSE, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "serial_close") == 0) {
+      if (strcmp(name, "sqlite_close") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "serial_close expects (fd)");
+          parser_fail(*pos, "sqlite_close expects (handle)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after serial_close arg");
+          parser_fail(*pos, "Expected ')' after sqlite_close arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_SERIAL_CLOSE, 0);
+        bytecode_add_instruction(bc, OP_SQLITE_CLOSE, 0);
         free(name);
         return 1;
       }
-      /* string ops */
-      if (strcmp(name, "split") == 0) {
+      if (strcmp(name, "sqlite_exec") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "split expects string");
+          parser_fail(*pos, "sqlite_exec expects (handle, sql)");
           free(name);
           return 0;
         }
-        if (*pos < len && src[*pos] == ',') {
-          (*pos)++;
-          skip_spaces(src, len, pos);
-        } else {
-          parser_fail(*pos, "split expects 2 args");
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "sqlite_exec expects (handle, sql)");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "split expects separator");
+          parser_fail(*pos, "sqlite_exec expects (handle, sql)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after split args");
+          parser_fail(*pos, "Expected ')' after sqlite_exec args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_SPLIT, 0);
+        bytecode_add_instruction(bc, OP_SQLITE_EXEC, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "join") == 0) {
+      if (strcmp(name, "sqlite_query") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "join expects array");
+          parser_fail(*pos, "sqlite_query expects (handle, sql)");
           free(name);
           return 0;
         }
-        if (*pos < len && src[*pos] == ',') {
-          (*pos)++;
-          skip_spaces(src, len, pos);
-        } else {
-          parser_fail(*pos, "join expects 2 args");
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "sqlite_query expects (handle, sql)");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "join expects separator");
+          parser_fail(*pos, "sqlite_query expects (handle, sql)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after join args");
+          parser_fail(*pos, "Expected ')' after sqlite_query args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_JOIN, 0);
+        bytecode_add_instruction(bc, OP_SQLITE_QUERY, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "substr") == 0) {
+      if (strcmp(name, "curl_post") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "substr expects string");
+          parser_fail(*pos, "curl_post expects (url, body)");
           free(name);
           return 0;
         }
-        if (*pos < len && src[*pos] == ',') {
-          (*pos)++;
-          skip_spaces(src, len, pos);
-        } else {
-          parser_fail(*pos, "substr expects 3 args");
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "curl_post expects (url, body)");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "substr expects start");
+          parser_fail(*pos, "curl_post expects (url, body)");
           free(name);
           return 0;
         }
-        if (*pos < len && src[*pos] == ',') {
-          (*pos)++;
-          skip_spaces(src, len, pos);
-        } else {
-          parser_fail(*pos, "substr expects 3 args");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after curl_post args");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_CURL_POST, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "curl_download") == 0) {
+        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "substr expects len");
+          parser_fail(*pos, "curl_download expects (url, path)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "curl_download expects (url, path)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "curl_download expects (url, path)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after substr args");
+          parser_fail(*pos, "Expected ')' after curl_download args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_SUBSTR, 0);
+        bytecode_add_instruction(bc, OP_CURL_DOWNLOAD, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "find") == 0) {
+      if (strcmp(name, "curl_multi") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "find expects haystack");
+          parser_fail(*pos, "curl_multi expects (requests [, max_parallel])");
           free(name);
           return 0;
         }
+        int hasMax = 0;
+        skip_spaces(src, len, pos);
         if (*pos < len && src[*pos] == ',') {
           (*pos)++;
           skip_spaces(src, len, pos);
-        } else {
-          parser_fail(*pos, "find expects 2 args");
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "curl_multi expects (requests [, max_parallel])");
+            free(name);
+            return 0;
+          }
+          hasMax = 1;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after curl_multi args");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_CURL_MULTI, hasMax);
+        free(name);
+        return 1;
+      }
+      /* OpenSSL (md5/sha256/sha512) */
+      if (strcmp(name, "openssl_md5") == 0) {
+        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "find expects needle");
+          parser_fail(*pos, "openssl_md5 expects (data)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after find args");
+          parser_fail(*pos, "Expected ')' after openssl_md5 arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_FIND, 0);
+        bytecode_add_instruction(bc, OP_OPENSSL_MD5, 0);
         free(name);
         return 1;
       }
-      /* regex ops */
-      if (strcmp(name, "regex_match") == 0) {
+      if (strcmp(name, "openssl_sha256") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "regex_match expects text");
+          parser_fail(*pos, "openssl_sha256 expects (data)");
           free(name);
           return 0;
         }
-        if (*pos < len && src[*pos] == ',') {
-          (*pos)++;
-          skip_spaces(src, len, pos);
-        } else {
-          parser_fail(*pos, "regex_match expects 2 args");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after openssl_sha256 arg");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_OPENSSL_SHA256, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "openssl_sha512") == 0) {
+        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "regex_match expects pattern");
+          parser_fail(*pos, "openssl_sha512 expects (data)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after regex_match args");
+          parser_fail(*pos, "Expected ')' after openssl_sha512 arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_REGEX_MATCH, 0);
+        bytecode_add_instruction(bc, OP_OPENSSL_SHA512, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "regex_search") == 0) {
+      if (strcmp(name, "openssl_ripemd160") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "regex_search expects text");
-          free(name);
-          return 0;
-        }
-        if (*pos < len && src[*pos] == ',') {
-          (*pos)++;
-          skip_spaces(src, len, pos);
-        } else {
-          parser_fail(*pos, "regex_search expects 2 args");
+          parser_fail(*pos, "openssl_ripemd160 expects (data)");
           free(name);
           return 0;
         }
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "regex_search expects pattern");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after openssl_ripemd160 arg");
           free(name);
           return 0;
         }
+        bytecode_add_instruction(bc, OP_OPENSSL_RIPEMD160, 0);
+        free(name);
+        return 1;
+      }
+      /* LibreSSL builtins removed */
+      /* PCSC builtins */
+      if (strcmp(name, "pcsc_establish") == 0) {
+        (*pos)++; /* '(' */
+        /* no args */
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after regex_search args");
+          parser_fail(*pos, "pcsc_establish expects ()");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_REGEX_SEARCH, 0);
+        bytecode_add_instruction(bc, OP_PCSC_ESTABLISH, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "regex_replace") == 0) {
+      /* PCRE2 builtins */
+      if (strcmp(name, "pcre2_test") == 0) {
         (*pos)++; /* '(' */
+        /* (pattern, text, flags) */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "regex_replace expects text");
+          parser_fail(*pos, "pcre2_test expects (pattern, text, flags)");
           free(name);
           return 0;
         }
-        if (*pos < len && src[*pos] == ',') {
-          (*pos)++;
-          skip_spaces(src, len, pos);
-        } else {
-          parser_fail(*pos, "regex_replace expects 3 args");
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "pcre2_test expects (pattern, text, flags)");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "regex_replace expects pattern");
+          parser_fail(*pos, "pcre2_test expects (pattern, text, flags)");
           free(name);
           return 0;
         }
-        if (*pos < len && src[*pos] == ',') {
-          (*pos)++;
-          skip_spaces(src, len, pos);
-        } else {
-          parser_fail(*pos, "regex_replace expects 3 args");
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "pcre2_test expects (pattern, text, flags)");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "regex_replace expects replacement");
+          parser_fail(*pos, "pcre2_test expects (pattern, text, flags)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after regex_replace args");
+          parser_fail(*pos, "Expected ')' after pcre2_test args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_REGEX_REPLACE, 0);
+        bytecode_add_instruction(bc, OP_PCRE2_TEST, 0);
         free(name);
         return 1;
       }
-      /* array utils */
-      if (strcmp(name, "contains") == 0) {
+      if (strcmp(name, "pcre2_match") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "contains expects array");
+          parser_fail(*pos, "pcre2_match expects (pattern, text, flags)");
           free(name);
           return 0;
         }
-        if (*pos < len && src[*pos] == ',') {
-          (*pos)++;
-          skip_spaces(src, len, pos);
-        } else {
-          parser_fail(*pos, "contains expects 2 args");
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "pcre2_match expects (pattern, text, flags)");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "contains expects value");
+          parser_fail(*pos, "pcre2_match expects (pattern, text, flags)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "pcre2_match expects (pattern, text, flags)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "pcre2_match expects (pattern, text, flags)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after contains args");
+          parser_fail(*pos, "Expected ')' after pcre2_match args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_CONTAINS, 0);
+        bytecode_add_instruction(bc, OP_PCRE2_MATCH, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "indexOf") == 0) {
+      if (strcmp(name, "pcre2_findall") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "indexOf expects array");
+          parser_fail(*pos, "pcre2_findall expects (pattern, text, flags)");
           free(name);
           return 0;
         }
-        if (*pos < len && src[*pos] == ',') {
-          (*pos)++;
-          skip_spaces(src, len, pos);
-        } else {
-          parser_fail(*pos, "indexOf expects 2 args");
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "pcre2_findall expects (pattern, text, flags)");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "indexOf expects value");
+          parser_fail(*pos, "pcre2_findall expects (pattern, text, flags)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "pcre2_findall expects (pattern, text, flags)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "pcre2_findall expects (pattern, text, flags)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after indexOf args");
+          parser_fail(*pos, "Expected ')' after pcre2_findall args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_INDEX_OF, 0);
+        bytecode_add_instruction(bc, OP_PCRE2_FINDALL, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "clear") == 0) {
+      /* PCSC builtins (optional) */
+      if (strcmp(name, "pcsc_release") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "clear expects array");
+          parser_fail(*pos, "pcsc_release expects 1 argument (ctx)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after clear arg");
+          parser_fail(*pos, "Expected ')' after pcsc_release arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_CLEAR, 0);
+        bytecode_add_instruction(bc, OP_PCSC_RELEASE, 0);
         free(name);
         return 1;
       }
-      /* iteration helpers */
-      if (strcmp(name, "enumerate") == 0) {
+      if (strcmp(name, "pcsc_list_readers") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "enumerate expects array");
+          parser_fail(*pos, "pcsc_list_readers expects 1 argument (ctx)");
           free(name);
           return 0;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after enumerate arg");
+          parser_fail(*pos, "Expected ')' after pcsc_list_readers arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_ENUMERATE, 0);
+        bytecode_add_instruction(bc, OP_PCSC_LIST_READERS, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "map") == 0) {
+      if (strcmp(name, "pcsc_connect") == 0) {
         (*pos)++; /* '(' */
-        /* arr */
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "map expects (array, function)");
+        /* ctx, reader */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "pcsc_connect expects (ctx, reader)");
           free(name);
           return 0;
         }
-        /* store arr -> __map_arr */
-        char tarr[64];
-        snprintf(tarr, sizeof(tarr), "__map_arr_%d", g_temp_counter++);
-        int larr = -1, garr = -1;
-        if (g_locals) {
-          larr = local_add(tarr);
-          bytecode_add_instruction(bc, OP_STORE_LOCAL, larr);
-        } else {
-          garr = sym_index(tarr);
-          bytecode_add_instruction(bc, OP_STORE_GLOBAL, garr);
-        }
-        /* func */
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "map expects (array, function)");
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "pcsc_connect expects (ctx, reader)");
           free(name);
           return 0;
         }
-        char tfn[64];
-        snprintf(tfn, sizeof(tfn), "__map_fn_%d", g_temp_counter++);
-        int lfn = -1, gfn = -1;
-        if (g_locals) {
-          lfn = local_add(tfn);
-          bytecode_add_instruction(bc, OP_STORE_LOCAL, lfn);
-        } else {
-          gfn = sym_index(tfn);
-          bytecode_add_instruction(bc, OP_STORE_GLOBAL, gfn);
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "pcsc_connect expects (ctx, reader)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after pcsc_connect args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_PCSC_CONNECT, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "pcsc_disconnect") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "pcsc_disconnect expects 1 argument (handle)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after pcsc_disconnect arg");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_PCSC_DISCONNECT, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "pcsc_transmit") == 0) {
+        (*pos)++; /* '(' */
+        /* handle, bytes */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "pcsc_transmit expects (handle, bytes)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "pcsc_transmit expects (handle, bytes)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "pcsc_transmit expects (handle, bytes)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after pcsc_transmit args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_PCSC_TRANSMIT, 0);
+        free(name);
+        return 1;
+      }
+      /* Socket builtins */
+      if (strcmp(name, "tcp_listen") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "tcp_listen expects (port, backlog)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "tcp_listen expects (port, backlog)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "tcp_listen expects (port, backlog)");
+          free(name);
+          return 0;
+        }
+        int hasOptions = 0;
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "tcp_listen expects an options map as third arg");
+            free(name);
+            return 0;
+          }
+          hasOptions = 1;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after tcp_listen args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SOCK_TCP_LISTEN, hasOptions);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "tcp_accept") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "tcp_accept expects (listen_fd)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after tcp_accept arg");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SOCK_TCP_ACCEPT, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "tcp_connect") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "tcp_connect expects (host, port)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "tcp_connect expects (host, port)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "tcp_connect expects (host, port)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after tcp_connect args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SOCK_TCP_CONNECT, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "sock_send") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "sock_send expects (fd, data)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "sock_send expects (fd, data)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "sock_send expects (fd, data)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after sock_send args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SOCK_SEND, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "sock_recv") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "sock_recv expects (fd, maxlen)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "sock_recv expects (fd, maxlen)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "sock_recv expects (fd, maxlen)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after sock_recv args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SOCK_RECV, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "sock_close") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "sock_close expects (fd)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after sock_close arg");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SOCK_CLOSE, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "unix_listen") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "unix_listen expects (path, backlog)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "unix_listen expects (path, backlog)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "unix_listen expects (path, backlog)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after unix_listen args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SOCK_UNIX_LISTEN, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "unix_connect") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "unix_connect expects (path)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after unix_connect arg");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SOCK_UNIX_CONNECT, 0);
+        free(name);
+        return 1;
+      }
+      /* Async-friendly FD helpers */
+      if (strcmp(name, "fd_set_nonblock") == 0) {
+        (*pos)++; /* '(' */
+        /* Expect (fd, on) -> push fd then on so VM pops on first */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "fd_set_nonblock expects (fd, on)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "fd_set_nonblock expects (fd, on)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "fd_set_nonblock expects (fd, on)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after fd_set_nonblock args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_FD_SET_NONBLOCK, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "fd_poll_read") == 0) {
+        (*pos)++; /* '(' */
+        /* Expect (fd, timeout_ms) -> push fd then timeout so VM pops timeout first */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "fd_poll_read expects (fd, timeout_ms)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "fd_poll_read expects (fd, timeout_ms)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "fd_poll_read expects (fd, timeout_ms)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after fd_poll_read args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_FD_POLL_READ, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "fd_poll_write") == 0) {
+        (*pos)++; /* '(' */
+        /* Expect (fd, timeout_ms) */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "fd_poll_write expects (fd, timeout_ms)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "fd_poll_write expects (fd, timeout_ms)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "fd_poll_write expects (fd, timeout_ms)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after fd_poll_write args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_FD_POLL_WRITE, 0);
+        free(name);
+        return 1;
+      }
+      /* Event loop handles: evloop_new(), evloop_add/mod(loop, fd, events), evloop_del(loop, fd),
+       * evloop_wait(loop, timeout_ms, max_events), evloop_close(loop) */
+      if (strcmp(name, "evloop_new") == 0) {
+        (*pos)++; /* '(' */
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "evloop_new expects ()");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_EVLOOP_NEW, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "evloop_add") == 0) {
+        (*pos)++; /* '(' */
+        /* Expect (loop, fd, events) */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "evloop_add expects (loop, fd, events)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "evloop_add expects (loop, fd, events)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "evloop_add expects (loop, fd, events)");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_EVLOOP_ADD, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "evloop_mod") == 0) {
+        (*pos)++; /* '(' */
+        /* Expect (loop, fd, events) */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "evloop_mod expects (loop, fd, events)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "evloop_mod expects (loop, fd, events)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "evloop_mod expects (loop, fd, events)");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_EVLOOP_MOD, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "evloop_del") == 0) {
+        (*pos)++; /* '(' */
+        /* Expect (loop, fd) */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "evloop_del expects (loop, fd)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "evloop_del expects (loop, fd)");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_EVLOOP_DEL, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "evloop_wait") == 0) {
+        (*pos)++; /* '(' */
+        /* Expect (loop, timeout_ms, max_events) */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "evloop_wait expects (loop, timeout_ms, max_events)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "evloop_wait expects (loop, timeout_ms, max_events)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "evloop_wait expects (loop, timeout_ms, max_events)");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_EVLOOP_WAIT, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "evloop_close") == 0) {
+        (*pos)++; /* '(' */
+        /* Expect (loop) */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "evloop_close expects (loop)");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_EVLOOP_CLOSE, 0);
+        free(name);
+        return 1;
+      }
+      /* HTTP/1.1: http_parse_request(buf), http_response(status, headers, body, keep_alive) */
+      if (strcmp(name, "http_parse_request") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "http_parse_request expects (buf)");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_HTTP_PARSE_REQUEST, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "http_response") == 0) {
+        (*pos)++; /* '(' */
+        /* Expect (status, headers, body, keep_alive [, reason]) */
+        int hasReason = 0;
+        for (int ai = 0; ai < 5; ++ai) {
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "http_response expects (status, headers, body, keep_alive [, reason])");
+            free(name);
+            return 0;
+          }
+          skip_spaces(src, len, pos);
+          if (ai >= 3 && *pos < len && src[*pos] == ')') break;
+          if (ai == 4 || !consume_char(src, len, pos, ',')) {
+            parser_fail(*pos, "http_response expects (status, headers, body, keep_alive [, reason])");
+            free(name);
+            return 0;
+          }
+          if (ai == 3) hasReason = 1;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after http_response args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_HTTP_RESPONSE, hasReason);
+        free(name);
+        return 1;
+      }
+      /* Static files: sock_sendfile(fd, path, offset, len [, head]), file_cache_stat(path) */
+      if (strcmp(name, "sock_sendfile") == 0) {
+        (*pos)++; /* '(' */
+        int hasHead = 0;
+        for (int ai = 0; ai < 5; ++ai) {
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "sock_sendfile expects (fd, path, offset, len [, head])");
+            free(name);
+            return 0;
+          }
+          skip_spaces(src, len, pos);
+          if (ai >= 3 && *pos < len && src[*pos] == ')') break;
+          if (ai == 4 || !consume_char(src, len, pos, ',')) {
+            parser_fail(*pos, "sock_sendfile expects (fd, path, offset, len [, head])");
+            free(name);
+            return 0;
+          }
+          if (ai == 3) hasHead = 1;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after sock_sendfile args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SOCK_SENDFILE, hasHead);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "file_cache_stat") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "file_cache_stat expects (path)");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_FILE_CACHE_STAT, 0);
+        free(name);
+        return 1;
+      }
+      /* Socket buffers and vectored I/O */
+      if (strcmp(name, "sock_buf_new") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "sock_buf_new expects (capacity)");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SOCK_BUF_NEW, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "sock_buf_free") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "sock_buf_free expects (buf)");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SOCK_BUF_FREE, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "sock_buf_len") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "sock_buf_len expects (buf)");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SOCK_BUF_LEN, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "sock_buf_append") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',') || !emit_expression(bc, src, len, pos) ||
+            !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "sock_buf_append expects (buf, data)");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SOCK_BUF_APPEND, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "sock_buf_take") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',') || !emit_expression(bc, src, len, pos) ||
+            !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "sock_buf_take expects (buf, n)");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SOCK_BUF_TAKE, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "sock_buf_consume") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',') || !emit_expression(bc, src, len, pos) ||
+            !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "sock_buf_consume expects (buf, n)");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SOCK_BUF_CONSUME, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "sock_recv_into") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',') || !emit_expression(bc, src, len, pos) ||
+            !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "sock_recv_into expects (fd, buf)");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SOCK_RECV_INTO, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "sock_send_all") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',') || !emit_expression(bc, src, len, pos) ||
+            !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "sock_send_all expects (fd, data)");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SOCK_SEND_ALL, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "sock_readv") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',') || !emit_expression(bc, src, len, pos) ||
+            !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "sock_readv expects (fd, bufs)");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SOCK_READV, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "sock_writev") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',') || !emit_expression(bc, src, len, pos) ||
+            !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "sock_writev expects (fd, parts)");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SOCK_WRITEV, 0);
+        free(name);
+        return 1;
+      }
+      /* Serial builtins */
+      if (strcmp(name, "serial_open") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "serial_open expects (path, baud)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "serial_open expects (path, baud)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "serial_open expects (path, baud)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after serial_open args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SERIAL_OPEN, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "serial_config") == 0) {
+        (*pos)++; /* '(' */
+        // fd, data_bits, parity, stop_bits, flow_control
+        for (int i = 0; i < 5; ++i) {
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "serial_config expects 5 arguments");
+            free(name);
+            return 0;
+          }
+          if (i < 4) {
+            if (!consume_char(src, len, pos, ',')) {
+              parser_fail(*pos, "serial_config expects 5 arguments");
+              free(name);
+              return 0;
+            }
+          }
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after serial_config args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SERIAL_CONFIG, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "serial_send") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "serial_send expects (fd, data)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "serial_send expects (fd, data)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "serial_send expects (fd, data)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after serial_send args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SERIAL_SEND, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "serial_recv") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "serial_recv expects (fd, maxlen)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "serial_recv expects (fd, maxlen)");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "serial_recv expects (fd, maxlen)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after serial_recv args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SERIAL_RECV, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "serial_close") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "serial_close expects (fd)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after serial_close arg");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SERIAL_CLOSE, 0);
+        free(name);
+        return 1;
+      }
+      /* string ops */
+      if (strcmp(name, "split") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "split expects string");
+          free(name);
+          return 0;
+        }
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+        } else {
+          parser_fail(*pos, "split expects 2 args");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "split expects separator");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after split args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SPLIT, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "join") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "join expects array");
+          free(name);
+          return 0;
+        }
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+        } else {
+          parser_fail(*pos, "join expects 2 args");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "join expects separator");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after join args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_JOIN, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "substr") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "substr expects string");
+          free(name);
+          return 0;
+        }
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+        } else {
+          parser_fail(*pos, "substr expects 3 args");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "substr expects start");
+          free(name);
+          return 0;
+        }
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+        } else {
+          parser_fail(*pos, "substr expects 3 args");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "substr expects len");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after substr args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SUBSTR, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "find") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "find expects haystack");
+          free(name);
+          return 0;
+        }
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+        } else {
+          parser_fail(*pos, "find expects 2 args");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "find expects needle");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after find args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_FIND, 0);
+        free(name);
+        return 1;
+      }
+      /* regex ops */
+      if (strcmp(name, "regex_match") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "regex_match expects text");
+          free(name);
+          return 0;
+        }
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+        } else {
+          parser_fail(*pos, "regex_match expects 2 args");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "regex_match expects pattern");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after regex_match args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_REGEX_MATCH, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "regex_search") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "regex_search expects text");
+          free(name);
+          return 0;
+        }
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+        } else {
+          parser_fail(*pos, "regex_search expects 2 args");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "regex_search expects pattern");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after regex_search args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_REGEX_SEARCH, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "regex_replace") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "regex_replace expects text");
+          free(name);
+          return 0;
+        }
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+        } else {
+          parser_fail(*pos, "regex_replace expects 3 args");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "regex_replace expects pattern");
+          free(name);
+          return 0;
+        }
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+        } else {
+          parser_fail(*pos, "regex_replace expects 3 args");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "regex_replace expects replacement");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after regex_replace args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_REGEX_REPLACE, 0);
+        free(name);
+        return 1;
+      }
+      /* array utils */
+      if (strcmp(name, "contains") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "contains expects array");
+          free(name);
+          return 0;
+        }
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+        } else {
+          parser_fail(*pos, "contains expects 2 args");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "contains expects value");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after contains args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_CONTAINS, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "indexOf") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "indexOf expects array");
+          free(name);
+          return 0;
+        }
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+        } else {
+          parser_fail(*pos, "indexOf expects 2 args");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "indexOf expects value");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after indexOf args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_INDEX_OF, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "clear") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "clear expects array");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after clear arg");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_CLEAR, 0);
+        free(name);
+        return 1;
+      }
+      /* iteration helpers */
+      if (strcmp(name, "enumerate") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "enumerate expects array");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after enumerate arg");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_ENUMERATE, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "map") == 0) {
+        (*pos)++; /* '(' */
+        /* arr */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "map expects (array, function)");
+          free(name);
+          return 0;
+        }
+        /* store arr -> __map_arr */
+        char tarr[64];
+        snprintf(tarr, sizeof(tarr), "__map_arr_%d", g_temp_counter++);
+        int larr = -1, garr = -1;
+        if (g_locals) {
+          larr = local_add(tarr);
+          bytecode_add_instruction(bc, OP_STORE_LOCAL, larr);
+        } else {
+          garr = sym_index(tarr);
+          bytecode_add_instruction(bc, OP_STORE_GLOBAL, garr);
+        }
+        /* func */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "map expects (array, function)");
+          free(name);
+          return 0;
+        }
+        char tfn[64];
+        snprintf(tfn, sizeof(tfn), "__map_fn_%d", g_temp_counter++);
+        int lfn = -1, gfn = -1;
+        if (g_locals) {
+          lfn = local_add(tfn);
+          bytecode_add_instruction(bc, OP_STORE_LOCAL, lfn);
+        } else {
+          gfn = sym_index(tfn);
+          bytecode_add_instruction(bc, OP_STORE_GLOBAL, gfn);
         }
         /* res array */
         bytecode_add_instruction(bc, OP_MAKE_ARRAY, 0);
@@ -3512,41 +4997,185 @@ static int emit_primary(Bytecode *bc, const char *src, size_t len, size_t *pos)
           lvf = local_add(tvf);
           bytecode_add_instruction(bc, OP_STORE_LOCAL, lvf);
         } else {
-          gvf = sym_index(tvf);
-          bytecode_add_instruction(bc, OP_STORE_GLOBAL, gvf);
+          gvf = sym_index(tvf);
+          bytecode_add_instruction(bc, OP_STORE_GLOBAL, gvf);
+        }
+
+        /* Push array */
+        if (g_locals) {
+          bytecode_add_instruction(bc, OP_LOAD_LOCAL, lres);
+        } else {
+          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, gres);
+        }
+
+        /* index = len(res) */
+        if (g_locals) {
+          bytecode_add_instruction(bc, OP_LOAD_LOCAL, lres);
+        } else {
+          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, gres);
+        }
+        bytecode_add_instruction(bc, OP_LEN, 0);
+
+        /* value */
+        if (g_locals) {
+          bytecode_add_instruction(bc, OP_LOAD_LOCAL, lvf);
+        } else {
+          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, gvf);
+        }
+
+        /* Append via insert: res.insert(index=len(res), value) */
+        bytecode_add_instruction(bc, OP_INSERT, 0);
+        /* dApache-2.0ard returned new length */
+        bytecode_add_instruction(bc, OP_POP, 0);
+
+        int c1 = bytecode_add_constant(bc, make_int(1));
+        /* patch skip over append */
+        bytecode_set_operand(bc, jskip, bc->instr_count);
+        /* i++ */
+        if (g_locals) {
+          bytecode_add_instruction(bc, OP_LOAD_LOCAL, li);
+          bytecode_add_instruction(bc, OP_LOAD_CONST, c1);
+          bytecode_add_instruction(bc, OP_ADD, 0);
+          bytecode_add_instruction(bc, OP_STORE_LOCAL, li);
+        } else {
+          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, gi);
+          bytecode_add_instruction(bc, OP_LOAD_CONST, c1);
+          bytecode_add_instruction(bc, OP_ADD, 0);
+          bytecode_add_instruction(bc, OP_STORE_GLOBAL, gi);
+        }
+        bytecode_add_instruction(bc, OP_JUMP, loop_start);
+        bytecode_set_operand(bc, jf, bc->instr_count);
+        if (g_locals) {
+          bytecode_add_instruction(bc, OP_LOAD_LOCAL, lres);
+        } else {
+          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, gres);
+        }
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "reduce") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "reduce expects (array, init, function)");
+          free(name);
+          return 0;
+        }
+        char tarr[64];
+        snprintf(tarr, sizeof(tarr), "__red_arr_%d", g_temp_counter++);
+        int larr = -1, garr = -1;
+        if (g_locals) {
+          larr = local_add(tarr);
+          bytecode_add_instruction(bc, OP_STORE_LOCAL, larr);
+        } else {
+          garr = sym_index(tarr);
+          bytecode_add_instruction(bc, OP_STORE_GLOBAL, garr);
+        }
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "reduce expects (array, init, function)");
+          free(name);
+          return 0;
+        }
+        char tacc[64];
+        snprintf(tacc, sizeof(tacc), "__red_acc_%d", g_temp_counter++);
+        int lacc = -1, gacc = -1;
+        if (g_locals) {
+          lacc = local_add(tacc);
+          bytecode_add_instruction(bc, OP_STORE_LOCAL, lacc);
+        } else {
+          gacc = sym_index(tacc);
+          bytecode_add_instruction(bc, OP_STORE_GLOBAL, gacc);
+        }
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "reduce expects (array, init, function)");
+          free(name);
+          return 0;
+        }
+        char tfn[64];
+        snprintf(tfn, sizeof(tfn), "__red_fn_%d", g_temp_counter++);
+        int lfn = -1, gfn = -1;
+        if (g_locals) {
+          lfn = local_add(tfn);
+          bytecode_add_instruction(bc, OP_STORE_LOCAL, lfn);
+        } else {
+          gfn = sym_index(tfn);
+          bytecode_add_instruction(bc, OP_STORE_GLOBAL, gfn);
+        }
+        /* loop */
+        int c0 = bytecode_add_constant(bc, make_int(0));
+        bytecode_add_instruction(bc, OP_LOAD_CONST, c0);
+        char ti[64];
+        snprintf(ti, sizeof(ti), "__red_i_%d", g_temp_counter++);
+        int li = -1, gi = -1;
+        if (g_locals) {
+          li = local_add(ti);
+          bytecode_add_instruction(bc, OP_STORE_LOCAL, li);
+        } else {
+          gi = sym_index(ti);
+          bytecode_add_instruction(bc, OP_STORE_GLOBAL, gi);
+        }
+        int loop_start = bc->instr_count;
+        if (g_locals) {
+          bytecode_add_instruction(bc, OP_LOAD_LOCAL, li);
+          bytecode_add_instruction(bc, OP_LOAD_LOCAL, larr);
+        } else {
+          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, gi);
+          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, garr);
+        }
+        bytecode_add_instruction(bc, OP_LEN, 0);
+        bytecode_add_instruction(bc, OP_LT, 0);
+        int jf = bytecode_add_instruction(bc, OP_JUMP_IF_FALSE, 0);
+        /* elem */
+        if (g_locals) {
+          bytecode_add_instruction(bc, OP_LOAD_LOCAL, larr);
+          bytecode_add_instruction(bc, OP_LOAD_LOCAL, li);
+        } else {
+          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, garr);
+          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, gi);
+        }
+        bytecode_add_instruction(bc, OP_INDEX_GET, 0);
+
+        /* Store elem to a temp so we can build stack as: fn, acc, elem */
+        char telem[64];
+        snprintf(telem, sizeof(telem), "__red_elem_%d", g_temp_counter++);
+        int lelem = -1, gelem = -1;
+        if (g_locals) {
+          lelem = local_add(telem);
+          bytecode_add_instruction(bc, OP_STORE_LOCAL, lelem);
+        } else {
+          gelem = sym_index(telem);
+          bytecode_add_instruction(bc, OP_STORE_GLOBAL, gelem);
+        }
+
+        /* push function */
+        if (g_locals) {
+          bytecode_add_instruction(bc, OP_LOAD_LOCAL, lfn);
+        } else {
+          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, gfn);
         }
 
-        /* Push array */
+        /* push accumulator (arg1) */
         if (g_locals) {
-          bytecode_add_instruction(bc, OP_LOAD_LOCAL, lres);
+          bytecode_add_instruction(bc, OP_LOAD_LOCAL, lacc);
         } else {
-          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, gres);
+          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, gacc);
         }
 
-        /* index = len(res) */
+        /* push element (arg2) */
         if (g_locals) {
-          bytecode_add_instruction(bc, OP_LOAD_LOCAL, lres);
+          bytecode_add_instruction(bc, OP_LOAD_LOCAL, lelem);
         } else {
-          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, gres);
+          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, gelem);
         }
-        bytecode_add_instruction(bc, OP_LEN, 0);
 
-        /* value */
+        /* call fn(acc, elem) -> result */
+        bytecode_add_instruction(bc, OP_CALL, 2);
+        /* store to acc */
         if (g_locals) {
-          bytecode_add_instruction(bc, OP_LOAD_LOCAL, lvf);
+          bytecode_add_instruction(bc, OP_STORE_LOCAL, lacc);
         } else {
-          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, gvf);
+          bytecode_add_instruction(bc, OP_STORE_GLOBAL, gacc);
         }
-
-        /* Append via insert: res.insert(index=len(res), value) */
-        bytecode_add_instruction(bc, OP_INSERT, 0);
-        /* dApache-2.0ard returned new length */
-        bytecode_add_instruction(bc, OP_POP, 0);
-
         int c1 = bytecode_add_constant(bc, make_int(1));
-        /* patch skip over append */
-        bytecode_set_operand(bc, jskip, bc->instr_count);
-        /* i++ */
         if (g_locals) {
           bytecode_add_instruction(bc, OP_LOAD_LOCAL, li);
           bytecode_add_instruction(bc, OP_LOAD_CONST, c1);
@@ -3560,561 +5189,834 @@ static int emit_primary(Bytecode *bc, const char *src, size_t len, size_t *pos)
         }
         bytecode_add_instruction(bc, OP_JUMP, loop_start);
         bytecode_set_operand(bc, jf, bc->instr_count);
+        /* result = acc on stack */
         if (g_locals) {
-          bytecode_add_instruction(bc, OP_LOAD_LOCAL, lres);
+          bytecode_add_instruction(bc, OP_LOAD_LOCAL, lacc);
         } else {
-          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, gres);
+          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, gacc);
+        }
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "zip") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "zip expects first array");
+          free(name);
+          return 0;
+        }
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+        } else {
+          parser_fail(*pos, "zip expects 2 args");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "zip expects second array");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after zip args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_ZIP, 0);
+        free(name);
+        return 1;
+      }
+      /* math */
+      if (strcmp(name, "min") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "min expects 2 args");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "min expects 2 args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_MIN, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "max") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "max expects 2 args");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "max expects 2 args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_MAX, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "fmin") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "fmin expects 2 args");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "fmin expects 2 args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_FMIN, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "fmax") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "fmax expects 2 args");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "fmax expects 2 args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_FMAX, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "clamp") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "clamp expects 3 args");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "clamp expects 3 args");
+          free(name);
+          return 0;
+        }
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "clamp expects 3 args");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_CLAMP, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "abs") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "abs expects 1 arg");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_ABS, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "floor") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "floor expects 1 arg");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_FLOOR, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "ceil") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "ceil expects 1 arg");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_CEIL, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "trunc") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "trunc expects 1 arg");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_TRUNC, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "round") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "round expects 1 arg");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_ROUND, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "sin") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "sin expects 1 arg");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_SIN, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "cos") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "cos expects 1 arg");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_COS, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "tan") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "tan expects 1 arg");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_TAN, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "exp") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "exp expects 1 arg");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_EXP, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "log") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "log expects 1 arg");
+          free(name);
+          return 0;
         }
+        bytecode_add_instruction(bc, OP_LOG, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "reduce") == 0) {
+      if (strcmp(name, "log10") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "reduce expects (array, init, function)");
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "log10 expects 1 arg");
           free(name);
           return 0;
         }
-        char tarr[64];
-        snprintf(tarr, sizeof(tarr), "__red_arr_%d", g_temp_counter++);
-        int larr = -1, garr = -1;
-        if (g_locals) {
-          larr = local_add(tarr);
-          bytecode_add_instruction(bc, OP_STORE_LOCAL, larr);
-        } else {
-          garr = sym_index(tarr);
-          bytecode_add_instruction(bc, OP_STORE_GLOBAL, garr);
+        bytecode_add_instruction(bc, OP_LOG10, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "sqrt") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "sqrt expects 1 arg");
+          free(name);
+          return 0;
         }
+        bytecode_add_instruction(bc, OP_SQRT, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "gcd") == 0) {
+        (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "reduce expects (array, init, function)");
+          parser_fail(*pos, "gcd expects 2 args");
           free(name);
           return 0;
         }
-        char tacc[64];
-        snprintf(tacc, sizeof(tacc), "__red_acc_%d", g_temp_counter++);
-        int lacc = -1, gacc = -1;
-        if (g_locals) {
-          lacc = local_add(tacc);
-          bytecode_add_instruction(bc, OP_STORE_LOCAL, lacc);
-        } else {
-          gacc = sym_index(tacc);
-          bytecode_add_instruction(bc, OP_STORE_GLOBAL, gacc);
-        }
         if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "reduce expects (array, init, function)");
+          parser_fail(*pos, "gcd expects 2 args");
           free(name);
           return 0;
         }
-        char tfn[64];
-        snprintf(tfn, sizeof(tfn), "__red_fn_%d", g_temp_counter++);
-        int lfn = -1, gfn = -1;
-        if (g_locals) {
-          lfn = local_add(tfn);
-          bytecode_add_instruction(bc, OP_STORE_LOCAL, lfn);
-        } else {
-          gfn = sym_index(tfn);
-          bytecode_add_instruction(bc, OP_STORE_GLOBAL, gfn);
-        }
-        /* loop */
-        int c0 = bytecode_add_constant(bc, make_int(0));
-        bytecode_add_instruction(bc, OP_LOAD_CONST, c0);
-        char ti[64];
-        snprintf(ti, sizeof(ti), "__red_i_%d", g_temp_counter++);
-        int li = -1, gi = -1;
-        if (g_locals) {
-          li = local_add(ti);
-          bytecode_add_instruction(bc, OP_STORE_LOCAL, li);
-        } else {
-          gi = sym_index(ti);
-          bytecode_add_instruction(bc, OP_STORE_GLOBAL, gi);
-        }
-        int loop_start = bc->instr_count;
-        if (g_locals) {
-          bytecode_add_instruction(bc, OP_LOAD_LOCAL, li);
-          bytecode_add_instruction(bc, OP_LOAD_LOCAL, larr);
-        } else {
-          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, gi);
-          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, garr);
-        }
-        bytecode_add_instruction(bc, OP_LEN, 0);
-        bytecode_add_instruction(bc, OP_LT, 0);
-        int jf = bytecode_add_instruction(bc, OP_JUMP_IF_FALSE, 0);
-        /* elem */
-        if (g_locals) {
-          bytecode_add_instruction(bc, OP_LOAD_LOCAL, larr);
-          bytecode_add_instruction(bc, OP_LOAD_LOCAL, li);
-        } else {
-          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, garr);
-          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, gi);
-        }
-        bytecode_add_instruction(bc, OP_INDEX_GET, 0);
-
-        /* Store elem to a temp so we can build stack as: fn, acc, elem */
-        char telem[64];
-        snprintf(telem, sizeof(telem), "__red_elem_%d", g_temp_counter++);
-        int lelem = -1, gelem = -1;
-        if (g_locals) {
-          lelem = local_add(telem);
-          bytecode_add_instruction(bc, OP_STORE_LOCAL, lelem);
-        } else {
-          gelem = sym_index(telem);
-          bytecode_add_instruction(bc, OP_STORE_GLOBAL, gelem);
-        }
-
-        /* push function */
-        if (g_locals) {
-          bytecode_add_instruction(bc, OP_LOAD_LOCAL, lfn);
-        } else {
-          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, gfn);
-        }
-
-        /* push accumulator (arg1) */
-        if (g_locals) {
-          bytecode_add_instruction(bc, OP_LOAD_LOCAL, lacc);
-        } else {
-          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, gacc);
-        }
-
-        /* push element (arg2) */
-        if (g_locals) {
-          bytecode_add_instruction(bc, OP_LOAD_LOCAL, lelem);
-        } else {
-          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, gelem);
-        }
-
-        /* call fn(acc, elem) -> result */
-        bytecode_add_instruction(bc, OP_CALL, 2);
-        /* store to acc */
-        if (g_locals) {
-          bytecode_add_instruction(bc, OP_STORE_LOCAL, lacc);
-        } else {
-          bytecode_add_instruction(bc, OP_STORE_GLOBAL, gacc);
+        bytecode_add_instruction(bc, OP_GCD, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "lcm") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "lcm expects 2 args");
+          free(name);
+          return 0;
         }
-        int c1 = bytecode_add_constant(bc, make_int(1));
-        if (g_locals) {
-          bytecode_add_instruction(bc, OP_LOAD_LOCAL, li);
-          bytecode_add_instruction(bc, OP_LOAD_CONST, c1);
-          bytecode_add_instruction(bc, OP_ADD, 0);
-          bytecode_add_instruction(bc, OP_STORE_LOCAL, li);
-        } else {
-          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, gi);
-          bytecode_add_instruction(bc, OP_LOAD_CONST, c1);
-          bytecode_add_instruction(bc, OP_ADD, 0);
-          bytecode_add_instruction(bc, OP_STORE_GLOBAL, gi);
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "lcm expects 2 args");
+          free(name);
+          return 0;
         }
-        bytecode_add_instruction(bc, OP_JUMP, loop_start);
-        bytecode_set_operand(bc, jf, bc->instr_count);
-        /* result = acc on stack */
-        if (g_locals) {
-          bytecode_add_instruction(bc, OP_LOAD_LOCAL, lacc);
-        } else {
-          bytecode_add_instruction(bc, OP_LOAD_GLOBAL, gacc);
+        bytecode_add_instruction(bc, OP_LCM, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "isqrt") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "isqrt expects 1 arg");
+          free(name);
+          return 0;
         }
+        bytecode_add_instruction(bc, OP_ISQRT, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "zip") == 0) {
+      if (strcmp(name, "sign") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "zip expects first array");
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "sign expects 1 arg");
           free(name);
           return 0;
         }
-        if (*pos < len && src[*pos] == ',') {
-          (*pos)++;
-          skip_spaces(src, len, pos);
-        } else {
-          parser_fail(*pos, "zip expects 2 args");
+        bytecode_add_instruction(bc, OP_SIGN, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "pow") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
+          parser_fail(*pos, "pow expects 2 args");
           free(name);
           return 0;
         }
-        if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "zip expects second array");
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "pow expects 2 args");
           free(name);
           return 0;
         }
-        if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after zip args");
+        bytecode_add_instruction(bc, OP_POW, 0);
+        free(name);
+        return 1;
+      }
+
+      if (strcmp(name, "random_seed") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "random_seed expects 1 arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_ZIP, 0);
+        bytecode_add_instruction(bc, OP_RANDOM_SEED, 0);
         free(name);
         return 1;
       }
-      /* math */
-      if (strcmp(name, "min") == 0) {
+      if (strcmp(name, "random_int") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "min expects 2 args");
+          parser_fail(*pos, "random_int expects 2 args");
           free(name);
           return 0;
         }
         if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "min expects 2 args");
+          parser_fail(*pos, "random_int expects 2 args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_MIN, 0);
+        bytecode_add_instruction(bc, OP_RANDOM_INT, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "max") == 0) {
+
+      if (strcmp(name, "random_number") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "max expects 2 args");
+        /* expects exactly 1 arg: length */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "random_number expects 1 arg (length)");
+          free(name);
+          return 0;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after random_number arg");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_RANDOM_NUMBER, 0);
+        free(name);
+        return 1;
+      }
+
+      /* threading */
+      if (strcmp(name, "thread_spawn") == 0) {
+        (*pos)++; /* '(' */
+        /* thread_spawn(fn [, args]) */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "thread_spawn expects function as first arg");
           free(name);
           return 0;
         }
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "max expects 2 args");
+        int hasArgs = 0;
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "thread_spawn second arg must be array or value");
+            free(name);
+            return 0;
+          }
+          hasArgs = 1;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "Expected ')' after thread_spawn args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_MAX, 0);
+        bytecode_add_instruction(bc, OP_THREAD_SPAWN, hasArgs ? 1 : 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "fmin") == 0) {
+      if (strcmp(name, "thread_join") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "fmin expects 2 args");
-          free(name);
-          return 0;
-        }
         if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "fmin expects 2 args");
+          parser_fail(*pos, "thread_join expects 1 arg (thread id)");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_FMIN, 0);
+        bytecode_add_instruction(bc, OP_THREAD_JOIN, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "fmax") == 0) {
+
+      /* coroutines */
+      if (strcmp(name, "co_create") == 0 || strcmp(name, "co_resume") == 0) {
+        int is_create = (name[3] == 'c');
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "fmax expects 2 args");
+        /* co_create(fn [, args]) / co_resume(co [, value]) */
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, is_create ? "co_create expects function as first arg" : "co_resume expects coroutine id");
           free(name);
           return 0;
         }
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "fmax expects 2 args");
+        int hasArg = 0;
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, is_create ? "co_create second arg must be array or value" : "co_resume expects a value as second arg");
+            free(name);
+            return 0;
+          }
+          hasArg = 1;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, is_create ? "Expected ')' after co_create args" : "Expected ')' after co_resume args");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_FMAX, 0);
+        bytecode_add_instruction(bc, is_create ? OP_CO_CREATE : OP_CO_RESUME, hasArg);
         free(name);
         return 1;
       }
-      if (strcmp(name, "clamp") == 0) {
+      if (strcmp(name, "yield") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "clamp expects 3 args");
-          free(name);
-          return 0;
-        }
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "clamp expects 3 args");
-          free(name);
-          return 0;
+        /* yield() / yield(value) */
+        int hasArg = 0;
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] != ')') {
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "yield expects at most 1 arg");
+            free(name);
+            return 0;
+          }
+          hasArg = 1;
         }
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "clamp expects 3 args");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "yield expects at most 1 arg");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_CLAMP, 0);
+        bytecode_add_instruction(bc, OP_YIELD, hasArg);
         free(name);
         return 1;
       }
-      if (strcmp(name, "abs") == 0) {
+      if (strcmp(name, "co_status") == 0 || strcmp(name, "co_close") == 0) {
+        int is_status = (name[3] == 's');
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "abs expects 1 arg");
+          parser_fail(*pos, is_status ? "co_status expects 1 arg (coroutine id)" : "co_close expects 1 arg (coroutine id)");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_ABS, 0);
+        bytecode_add_instruction(bc, is_status ? OP_CO_STATUS : OP_CO_CLOSE, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "floor") == 0) {
+      if (strcmp(name, "co_running") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "floor expects 1 arg");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "co_running expects ()");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_FLOOR, 0);
+        bytecode_add_instruction(bc, OP_CO_RUNNING, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "ceil") == 0) {
+      if (strcmp(name, "gc") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "ceil expects 1 arg");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "gc expects ()");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_CEIL, 0);
+        bytecode_add_instruction(bc, OP_GC, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "trunc") == 0) {
+      if (strcmp(name, "gc_stats") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "trunc expects 1 arg");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "gc_stats expects ()");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_TRUNC, 0);
+        bytecode_add_instruction(bc, OP_GC_STATS, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "round") == 0) {
+      if (strcmp(name, "mem_stats") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "round expects 1 arg");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "mem_stats expects ()");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_ROUND, 0);
+        bytecode_add_instruction(bc, OP_MEM_STATS, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "sin") == 0) {
+      /* Native hashes and AES-256 */
+      if (strcmp(name, "hash_new") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "sin expects 1 arg");
+          parser_fail(*pos, "hash_new expects (algorithm)");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_SIN, 0);
+        bytecode_add_instruction(bc, OP_HASH_NEW, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "cos") == 0) {
+      if (strcmp(name, "hash_update") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "cos expects 1 arg");
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',') || !emit_expression(bc, src, len, pos) ||
+            !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "hash_update expects (h, data)");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_COS, 0);
+        bytecode_add_instruction(bc, OP_HASH_UPDATE, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "tan") == 0) {
+      if (strcmp(name, "hash_update_hex") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "tan expects 1 arg");
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',') || !emit_expression(bc, src, len, pos) ||
+            !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "hash_update_hex expects (h, hex)");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_TAN, 0);
+        bytecode_add_instruction(bc, OP_HASH_UPDATE_HEX, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "exp") == 0) {
+      if (strcmp(name, "hash_final") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "exp expects 1 arg");
+          parser_fail(*pos, "hash_final expects (h)");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_EXP, 0);
+        bytecode_add_instruction(bc, OP_HASH_FINAL, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "log") == 0) {
+      if (strcmp(name, "hash_free") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "log expects 1 arg");
+          parser_fail(*pos, "hash_free expects (h)");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_LOG, 0);
+        bytecode_add_instruction(bc, OP_HASH_FREE, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "log10") == 0) {
+      if (strcmp(name, "aes256_encrypt_hex") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "log10 expects 1 arg");
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',') || !emit_expression(bc, src, len, pos) ||
+            !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "aes256_encrypt_hex expects (data_hex, key_hex)");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_LOG10, 0);
+        bytecode_add_instruction(bc, OP_AES256_ENCRYPT_HEX, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "sqrt") == 0) {
+      if (strcmp(name, "crypto_accel") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "sqrt expects 1 arg");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "crypto_accel expects ()");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_SQRT, 0);
+        bytecode_add_instruction(bc, OP_CRYPTO_ACCEL, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "gcd") == 0) {
+
+      /* Base64, hex and percent-encoding */
+      if (strcmp(name, "base64_encode") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "gcd expects 2 args");
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "base64_encode expects (data [, url])");
           free(name);
           return 0;
         }
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "gcd expects 2 args");
+        int hasOpt = 0;
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "base64_encode expects (data [, url])");
+            free(name);
+            return 0;
+          }
+          hasOpt = 1;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "base64_encode expects (data [, url])");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_GCD, 0);
+        bytecode_add_instruction(bc, OP_BASE64_ENCODE, hasOpt);
         free(name);
         return 1;
       }
-      if (strcmp(name, "lcm") == 0) {
+      if (strcmp(name, "base64_decode") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "lcm expects 2 args");
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "base64_decode expects (text [, as_bytes])");
           free(name);
           return 0;
         }
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "lcm expects 2 args");
-          free(name);
-          return 0;
+        int hasOpt = 0;
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "base64_decode expects (text [, as_bytes])");
+            free(name);
+            return 0;
+          }
+          hasOpt = 1;
         }
-        bytecode_add_instruction(bc, OP_LCM, 0);
-        free(name);
-        return 1;
-      }
-      if (strcmp(name, "isqrt") == 0) {
-        (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "isqrt expects 1 arg");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "base64_decode expects (text [, as_bytes])");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_ISQRT, 0);
+        bytecode_add_instruction(bc, OP_BASE64_DECODE, hasOpt);
         free(name);
         return 1;
       }
-      if (strcmp(name, "sign") == 0) {
+      if (strcmp(name, "hex_encode") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "sign expects 1 arg");
+          parser_fail(*pos, "hex_encode expects (data)");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_SIGN, 0);
+        bytecode_add_instruction(bc, OP_HEX_ENCODE, 0);
         free(name);
         return 1;
       }
-      if (strcmp(name, "pow") == 0) {
+      if (strcmp(name, "hex_decode") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "pow expects 2 args");
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "hex_decode expects (hex [, as_bytes])");
           free(name);
           return 0;
         }
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "pow expects 2 args");
-          free(name);
-          return 0;
+        int hasOpt = 0;
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "hex_decode expects (hex [, as_bytes])");
+            free(name);
+            return 0;
+          }
+          hasOpt = 1;
         }
-        bytecode_add_instruction(bc, OP_POW, 0);
-        free(name);
-        return 1;
-      }
-
-      if (strcmp(name, "random_seed") == 0) {
-        (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "random_seed expects 1 arg");
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "hex_decode expects (hex [, as_bytes])");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_RANDOM_SEED, 0);
+        bytecode_add_instruction(bc, OP_HEX_DECODE, hasOpt);
         free(name);
         return 1;
       }
-      if (strcmp(name, "random_int") == 0) {
+      if (strcmp(name, "url_encode") == 0) {
         (*pos)++; /* '(' */
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',')) {
-          parser_fail(*pos, "random_int expects 2 args");
+        if (!emit_expression(bc, src, len, pos)) {
+          parser_fail(*pos, "url_encode expects (text [, form])");
           free(name);
           return 0;
         }
-        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "random_int expects 2 args");
+        int hasOpt = 0;
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "url_encode expects (text [, form])");
+            free(name);
+            return 0;
+          }
+          hasOpt = 1;
+        }
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "url_encode expects (text [, form])");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_RANDOM_INT, 0);
+        bytecode_add_instruction(bc, OP_URL_ENCODE, hasOpt);
         free(name);
         return 1;
       }
-
-      if (strcmp(name, "random_number") == 0) {
+      if (strcmp(name, "url_decode") == 0) {
         (*pos)++; /* '(' */
-        /* expects exactly 1 arg: length */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "random_number expects 1 arg (length)");
+          parser_fail(*pos, "url_decode expects (text [, form])");
           free(name);
           return 0;
         }
+        int hasOpt = 0;
+        skip_spaces(src, len, pos);
+        if (*pos < len && src[*pos] == ',') {
+          (*pos)++;
+          skip_spaces(src, len, pos);
+          if (!emit_expression(bc, src, len, pos)) {
+            parser_fail(*pos, "url_decode expects (text [, form])");
+            free(name);
+            return 0;
+          }
+          hasOpt = 1;
+        }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after random_number arg");
+          parser_fail(*pos, "url_decode expects (text [, form])");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_RANDOM_NUMBER, 0);
+        bytecode_add_instruction(bc, OP_URL_DECODE, hasOpt);
         free(name);
         return 1;
       }
-
-      /* threading */
-      if (strcmp(name, "thread_spawn") == 0) {
+      if (strcmp(name, "codec_new") == 0) {
         (*pos)++; /* '(' */
-        /* thread_spawn(fn [, args]) */
         if (!emit_expression(bc, src, len, pos)) {
-          parser_fail(*pos, "thread_spawn expects function as first arg");
+          parser_fail(*pos, "codec_new expects (format [, mode])");
           free(name);
           return 0;
         }
-        int hasArgs = 0;
+        int hasOpt = 0;
         skip_spaces(src, len, pos);
         if (*pos < len && src[*pos] == ',') {
           (*pos)++;
           skip_spaces(src, len, pos);
           if (!emit_expression(bc, src, len, pos)) {
-            parser_fail(*pos, "thread_spawn second arg must be array or value");
+            parser_fail(*pos, "codec_new expects (format [, mode])");
             free(name);
             return 0;
           }
-          hasArgs = 1;
+          hasOpt = 1;
         }
         if (!consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "Expected ')' after thread_spawn args");
+          parser_fail(*pos, "codec_new expects (format [, mode])");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_THREAD_SPAWN, hasArgs ? 1 : 0);
+        bytecode_add_instruction(bc, OP_CODEC_NEW, hasOpt);
         free(name);
         return 1;
       }
-      if (strcmp(name, "thread_join") == 0) {
+      if (strcmp(name, "codec_update") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ',') || !emit_expression(bc, src, len, pos) ||
+            !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "codec_update expects (c, data)");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_CODEC_UPDATE, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "codec_final") == 0) {
         (*pos)++; /* '(' */
         if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
-          parser_fail(*pos, "thread_join expects 1 arg (thread id)");
+          parser_fail(*pos, "codec_final expects (c)");
           free(name);
           return 0;
         }
-        bytecode_add_instruction(bc, OP_THREAD_JOIN, 0);
+        bytecode_add_instruction(bc, OP_CODEC_FINAL, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "codec_free") == 0) {
+        (*pos)++; /* '(' */
+        if (!emit_expression(bc, src, len, pos) || !consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "codec_free expects (c)");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_CODEC_FREE, 0);
+        free(name);
+        return 1;
+      }
+      if (strcmp(name, "codec_accel") == 0) {
+        (*pos)++; /* '(' */
+        if (!consume_char(src, len, pos, ')')) {
+          parser_fail(*pos, "codec_accel expects ()");
+          free(name);
+          return 0;
+        }
+        bytecode_add_instruction(bc, OP_CODEC_ACCEL, 0);
         free(name);
         return 1;
       }
@@ -6539,11 +8441,13 @@ static void parse_block(Bytecode *bc, const char *src, size_t len, size_t *pos,
             } else {
               /* empty method body allowed -> return */
             }
-            /* ensure return */
+            /* ensure return (implicit nil) */
+            bytecode_add_instruction(m_bc, OP_LOAD_CONST, bytecode_add_constant(m_bc, make_nil()));
             bytecode_add_instruction(m_bc, OP_RETURN, 0);
 
             /* restore env to factory */
             g_locals = saved;
+            local_env_free(&m_env);
 
             /* Insert method function into instance: this["mname"] = <function> */
             bytecode_add_instruction(ctor_bc, OP_LOAD_LOCAL, l_this);
@@ -6638,6 +8542,7 @@ static void parse_block(Bytecode *bc, const char *src, size_t len, size_t *pos,
 
       /* restore outer locals env */
       g_locals = prev_env;
+      local_env_free(&ctor_env);
 
       /* bind factory function globally under class name */
       int cci = bytecode_add_constant(bc, make_function(ctor_bc));
@@ -6671,7 +8576,7 @@ static void parse_block(Bytecode *bc, const char *src, size_t len, size_t *pos,
       }
 
       /* build locals from parameters */
-      LocalEnv env = {{0}, {0}, 0};
+      LocalEnv env = {NULL, NULL, 0, 0, NULL, 0};
       LocalEnv *prev = g_locals;
       int saved_depth = g_func_env_depth;
       if (prev != NULL) {
@@ -6739,7 +8644,8 @@ static void parse_block(Bytecode *bc, const char *src, size_t len, size_t *pos,
       } else {
         /* empty body: ok */
       }
-      /* ensure function returns */
+      /* ensure function returns (implicit nil) */
+      bytecode_add_instruction(fn_bc, OP_LOAD_CONST, bytecode_add_constant(fn_bc, make_nil()));
       bytecode_add_instruction(fn_bc, OP_RETURN, 0);
 
 #ifdef FUN_DEBUG
@@ -6791,6 +8697,7 @@ static void parse_block(Bytecode *bc, const char *src, size_t len, size_t *pos,
 
       g_locals = prev;
       g_func_env_depth = saved_depth;
+      local_env_free(&env);
       free(fname);
       continue;
     }
@@ -7653,6 +9560,9 @@ static Bytecode *compile_minimal(const char *src, size_t len) {
   Bytecode *bc = bytecode_new();
   size_t pos = 0;
 
+  /* a new buffer may reuse the address of a previous one */
+  g_line_cache.src = NULL;
+
   /* Refresh namespace alias table for this compilation unit */
   ns_aliases_reset();
   ns_aliases_scan(src, len);
@@ -7863,6 +9773,12 @@ Bytecode *parse_file_to_bytecode(const char *path) {
     return NULL;
   }
 
+  /* Record the include span markers once so runtime errors can be mapped
+   * back to the original files without re-reading the script. */
+  LineMap *lm = line_map_from_expanded(compile_src);
+  bytecode_set_line_map(bc, lm);
+  line_map_release(lm);
+
   if (prep) free(prep);
   free(src);
   return bc;
@@ -7928,6 +9844,10 @@ Bytecode *parse_string_to_bytecode(const char *source) {
     if (prep) free(prep);
     return NULL;
   }
+  LineMap *lm = line_map_from_expanded(compile_src);
+  bytecode_set_line_map(bc, lm);
+  line_map_release(lm);
+
   if (prep) free(prep);
   return bc;
 }
@@ -974,132 +974,73 @@ char *preprocess_includes_with_path(const char *src, const char *current_path) {
   return preprocess_includes_internal(src, current_path, 0);
 }
 
-/*
- * Public helper: map a line number in the include-expanded top-level source file
- * back to the original included file path and inner line number, using the
- * `// __include_begin__: <path>[ as <alias>]` markers injected by the
- * preprocessor. Returns 1 on success and fills out_path/out_line; 0 otherwise.
- */
 /**
- * @brief Map a line number in expanded source back to original include path/line.
+ * @brief Build the expanded-line -> (file, line) map for preprocessed source.
  *
- * Scans the expanded text for the nearest preceding `__include_begin__` marker
- * and computes the corresponding inner line number.
+ * Scans the expanded text once for the `// __include_begin__: <path>[ as
+ * <alias>] @line N` markers injected by the preprocessor and records one span
+ * per marker, starting at the line after it. The resulting map is attached to
+ * the compiled bytecode so runtime diagnostics can resolve OP_LINE operands
+ * with a binary search instead of re-reading and re-expanding the script.
  *
- * @param path           Path to the original top-level file that was expanded.
- * @param line           1-based line number in the expanded text.
- * @param out_path       Output buffer for the resolved file path.
- * @param out_path_cap   Capacity of out_path.
- * @param out_line       Receives 1-based line number within resolved file.
- * @return 1 on success, 0 on failure.
+ * @param prep Include-expanded source text.
+ * @return New LineMap (refcount 1), or NULL if the text has no markers or on OOM.
  */
-int map_expanded_line_to_include_path(const char *path, int line,
-                                      char *out_path, size_t out_path_cap,
-                                      int *out_line) {
-  if (!path || line <= 0 || !out_path || out_path_cap == 0 || !out_line) return 0;
-  out_path[0] = '\0';
-  *out_line = line;
-
-  /* read original top-level file */
-  size_t fsz = 0;
-  char *orig = read_file_all(path, &fsz);
-  if (!orig) return 0;
-
-  char *prep = preprocess_includes_internal(orig, path, 0);
-  free(orig);
-  if (!prep) return 0;
-
-  /* find start offset of requested 1-based line */
-  size_t len = strlen(prep);
-  size_t pos = 0;
-  int cur = 1;
-  while (pos < len && cur < line) {
-    if (prep[pos] == '\n') cur++;
-    pos++;
-  }
-  if (cur != line) { free(prep); return 0; }
-
-  /* scan backward to find the nearest include/resume marker line */
+static LineMap *line_map_from_expanded(const char *prep) {
+  if (!prep) return NULL;
   const char *marker = "// __include_begin__: ";
   size_t mlen = strlen(marker);
-  size_t scan = pos;
-  while (scan > 0) {
-    /* find start of current line */
-    size_t ls = scan;
-    while (ls > 0 && prep[ls - 1] != '\n') ls--;
-    /* check if this line starts with marker */
-    if (ls + mlen <= len && strncmp(prep + ls, marker, mlen) == 0) {
-      /* Parse marker line: path [as alias] [@line N] */
-      size_t p = ls + mlen;
-      size_t eol = p;
-      while (eol < len && prep[eol] != '\n') eol++;
-      /* find separators */
-      size_t pos_as = eol, pos_line = eol;
-      for (size_t t = p; t + 3 < eol; ++t) {
-        if (prep[t] == ' ' && strncmp(prep + t, " as ", 4) == 0) { pos_as = t; break; }
-      }
-      for (size_t t = p; t + 6 < eol; ++t) {
-        if (prep[t] == ' ' && strncmp(prep + t, " @line ", 7) == 0) { pos_line = t; break; }
+  LineMap *lm = NULL;
+  int line = 1;
+  const char *p = prep;
+  while (*p) {
+    const char *eol = strchr(p, '\n');
+    if (!eol) eol = p + strlen(p);
+    if ((size_t)(eol - p) >= mlen && strncmp(p, marker, mlen) == 0) {
+      const char *ps = p + mlen;
+      /* path ends at " as " or " @line ", whichever comes first */
+      const char *path_end = eol;
+      for (const char *t = ps; t < eol; ++t) {
+        if (*t == ' ' && ((eol - t >= 4 && strncmp(t, " as ", 4) == 0) ||
+                          (eol - t >= 7 && strncmp(t, " @line ", 7) == 0))) {
+          path_end = t;
+          break;
+        }
       }
-      size_t path_end = pos_as < pos_line ? pos_as : pos_line;
-      if (path_end < p) path_end = eol;
-      size_t copy = (path_end - p) < (out_path_cap - 1) ? (path_end - p) : (out_path_cap - 1);
-      memcpy(out_path, prep + p, copy);
-      out_path[copy] = '\0';
-
-      /* parse optional base line number */
       int base_line = 1;
-      if (pos_line < eol) {
-        size_t num_start = pos_line + 7; /* after ' @line ' */
-        int v = 0;
-        while (num_start < eol && prep[num_start] == ' ') num_start++;
-        while (num_start < eol && prep[num_start] >= '0' && prep[num_start] <= '9') {
-          v = v * 10 + (prep[num_start] - '0');
-          num_start++;
+      const char *at = NULL;
+      for (const char *t = ps; t + 7 <= eol; ++t) {
+        if (strncmp(t, " @line ", 7) == 0) {
+          at = t + 7;
+          break;
         }
-        if (v > 0) base_line = v;
       }
-
-      /* determine the span: from the end of this marker line to the start of the next marker line */
-      size_t q = eol;
-      if (q < len && prep[q] == '\n') q++;
-      size_t span_start = q;
-      size_t span_end = len;
-      size_t fwd = q;
-      while (fwd < len) {
-        /* find start of next line */
-        size_t ls2 = fwd;
-        while (ls2 > 0 && prep[ls2 - 1] != '\n') ls2--;
-        if (ls2 + mlen <= len && strncmp(prep + ls2, marker, mlen) == 0) {
-          span_end = ls2; /* region ends right before the next marker */
-          break;
+      if (at) {
+        int v = 0;
+        while (at < eol && *at == ' ') at++;
+        while (at < eol && *at >= '0' && *at <= '9') {
+          v = v * 10 + (*at - '0');
+          at++;
         }
-        while (fwd < len && prep[fwd] != '\n') fwd++;
-        if (fwd < len && prep[fwd] == '\n') fwd++;
+        if (v > 0) base_line = v;
       }
 
-      /* If the requested position is not within [span_start, span_end), this
-       * begin marker does not apply; continue scanning backward. */
-      if (!(pos >= span_start && pos < span_end)) {
-        /* not inside this include span */
-        goto next_scan_back;
+      if (!lm) lm = line_map_new();
+      char *file = lm ? (char *)malloc((size_t)(path_end - ps) + 1) : NULL;
+      if (!file) {
+        line_map_release(lm);
+        return NULL;
       }
-
-      /* compute inner line as number of newlines from span_start to current pos */
-      int inner = 1;
-      size_t cnt = span_start;
-      while (cnt < pos) { if (prep[cnt] == '\n') inner++; cnt++; }
-      *out_line = base_line + inner - 1;
-      free(prep);
-      return 1;
+      memcpy(file, ps, (size_t)(path_end - ps));
+      file[path_end - ps] = '\0';
+      line_map_add_span(lm, file, line + 1, base_line);
+      free(file);
     }
-    if (ls == 0) break;
-next_scan_back:
-    scan = (ls > 0) ? (ls - 1) : 0;
+    if (!*eol) break;
+    p = eol + 1;
+    line++;
   }
-
-  free(prep);
-  return 0;
+  return lm;
 }
 
 /* Float literal parser: supports decimal and scientific notation. Returns parsed double and advances pos on success. */
@@ -0,0 +1,249 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file pool.c
+ * @brief Size-class slab pools (see pool.h).
+ *
+ * Compiled into value.c. Every thread has a PoolThread cache: one free list
+ * per size class plus a bump region in the current slab. Allocation pops the
+ * free list or bumps; freeing pushes onto the calling thread's list, whichever
+ * thread allocated the block. Caches are never freed: pool_thread_release()
+ * marks one idle and the next new thread adopts it with its free lists.
+ *
+ * Statistics are per-cache counters written only by the owning thread and
+ * summed by pool_get_stats(), so counting takes no lock or atomic RMW.
+ *
+ * String payloads carry a one-byte prefix with their size class (or
+ * POOL_STRING_LARGE), so pool_string_free() needs no length.
+ *
+ * Built with FUN_NO_POOL or AddressSanitizer, every block comes from malloc()
+ * so the sanitizer still sees each object; the counters keep working.
+ */
+
+#include "pool.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define POOL_BYPASS 1
+#endif
+#endif
+#if defined(FUN_NO_POOL) || defined(__SANITIZE_ADDRESS__)
+#define POOL_BYPASS 1
+#endif
+
+#define POOL_SLAB (64 * 1024)    /* bytes per slab */
+#define POOL_SLAB_HEADER 16      /* slab list link, keeps blocks 16-byte aligned */
+#define POOL_CLASSES 12
+#define POOL_STRING_LARGE 0xFF   /* string prefix of a malloc()ed payload */
+
+static const uint16_t pool_class_size[POOL_CLASSES] = {8, 16, 24, 32, 48, 64, 80, 96, 128, 160, 192, 256};
+
+/* size class for (size + 7) / 8 */
+static const unsigned char pool_class_of[POOL_MAX / 8 + 1] = {
+    0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 8, 8,
+    9, 9, 9, 9, 10, 10, 10, 10, 11, 11, 11, 11, 11, 11, 11, 11};
+
+typedef struct PoolNode {
+  struct PoolNode *next;
+} PoolNode;
+
+typedef struct PoolThread {
+  struct PoolThread *next; /* all caches, for pool_get_stats() */
+  int idle;                /* released by its thread, free to adopt */
+  PoolNode *free[POOL_CLASSES];
+  char *bump, *bump_end; /* unused rest of the current slab */
+  int64_t allocs[POOL_CLASSES];
+  int64_t frees[POOL_CLASSES];
+  int64_t large; /* requests above POOL_MAX, net of frees */
+  int64_t made[POOL_KINDS];
+  int64_t freed[POOL_KINDS];
+} PoolThread;
+
+/* Only the owning thread writes a counter; pool_get_stats() may read it concurrently */
+#define POOL_ADD(x, n) __atomic_store_n(&(x), __atomic_load_n(&(x), __ATOMIC_RELAXED) + (n), __ATOMIC_RELAXED)
+#define POOL_READ(x) __atomic_load_n(&(x), __ATOMIC_RELAXED)
+
+static PoolThread *g_pool_threads = NULL;
+static void *g_pool_slabs = NULL; /* each slab starts with the link to the next */
+static int64_t g_pool_slab_count = 0;
+static char g_pool_lock = 0;
+static __thread PoolThread *t_pool = NULL;
+
+/* Guards the cache list and slab list; taken only on slow paths */
+static void pool_lock(void) {
+  while (__atomic_test_and_set(&g_pool_lock, __ATOMIC_ACQUIRE)) {
+  }
+}
+
+static void pool_unlock(void) {
+  __atomic_clear(&g_pool_lock, __ATOMIC_RELEASE);
+}
+
+static PoolThread *pool_thread_attach(void) {
+  pool_lock();
+  PoolThread *t = g_pool_threads;
+  while (t && !t->idle)
+    t = t->next;
+  if (t) {
+    t->idle = 0;
+  } else if ((t = (PoolThread *)calloc(1, sizeof(PoolThread))) != NULL) {
+    t->next = g_pool_threads;
+    g_pool_threads = t;
+  }
+  pool_unlock();
+  t_pool = t;
+  return t;
+}
+
+static PoolThread *pool_thread(void) {
+  return t_pool ? t_pool : pool_thread_attach();
+}
+
+#ifndef POOL_BYPASS
+/* Take a block of class c from the bump region, starting a new slab if needed */
+static PoolNode *pool_carve(PoolThread *t, int c) {
+  size_t size = pool_class_size[c];
+  if (!t->bump || (size_t)(t->bump_end - t->bump) < size) {
+    char *slab = (char *)malloc(POOL_SLAB);
+    if (!slab) return NULL;
+    pool_lock();
+    *(void **)slab = g_pool_slabs;
+    g_pool_slabs = slab;
+    g_pool_slab_count++;
+    pool_unlock();
+    t->bump = slab + POOL_SLAB_HEADER;
+    t->bump_end = slab + POOL_SLAB;
+  }
+  PoolNode *n = (PoolNode *)t->bump;
+  t->bump += size;
+  return n;
+}
+#endif
+
+void *pool_alloc(size_t size) {
+  if (size == 0) return NULL;
+  PoolThread *t = pool_thread();
+  if (!t) return NULL;
+  if (size > POOL_MAX) {
+    void *p = malloc(size);
+    if (p) POOL_ADD(t->large, 1);
+    return p;
+  }
+  int c = pool_class_of[(size + 7) >> 3];
+#ifdef POOL_BYPASS
+  void *n = malloc(pool_class_size[c]);
+#else
+  PoolNode *n = t->free[c];
+  if (n)
+    t->free[c] = n->next;
+  else
+    n = pool_carve(t, c);
+#endif
+  if (n) POOL_ADD(t->allocs[c], 1);
+  return n;
+}
+
+void *pool_calloc(size_t size) {
+  void *p = pool_alloc(size);
+  if (p) memset(p, 0, size);
+  return p;
+}
+
+void pool_free(void *p, size_t size) {
+  if (!p) return;
+  PoolThread *t = pool_thread();
+  if (size > POOL_MAX) {
+    free(p);
+    if (t) POOL_ADD(t->large, -1);
+    return;
+  }
+  /* without a cache (out of memory) the block is leaked, never misplaced */
+  if (!t) return;
+  int c = pool_class_of[(size + 7) >> 3];
+#ifdef POOL_BYPASS
+  free(p);
+#else
+  PoolNode *n = (PoolNode *)p;
+  n->next = t->free[c];
+  t->free[c] = n;
+#endif
+  POOL_ADD(t->frees[c], 1);
+}
+
+void *pool_resize(void *p, size_t old, size_t size) {
+  if (!p || old == 0) return pool_alloc(size);
+  if (old > POOL_MAX && size > POOL_MAX) return realloc(p, size);
+  if (old <= POOL_MAX && size <= POOL_MAX && size > 0 && pool_class_of[(old + 7) >> 3] == pool_class_of[(size + 7) >> 3])
+    return p;
+  void *q = pool_alloc(size);
+  if (!q) return NULL;
+  memcpy(q, p, old < size ? old : size);
+  pool_free(p, old);
+  return q;
+}
+
+void *pool_object_alloc(int kind, size_t size) {
+  void *p = pool_alloc(size);
+  if (p) POOL_ADD(t_pool->made[kind], 1);
+  return p;
+}
+
+void pool_object_free(int kind, void *p, size_t size) {
+  if (!p) return;
+  pool_free(p, size);
+  if (t_pool) POOL_ADD(t_pool->freed[kind], 1);
+}
+
+char *pool_string_alloc(size_t len) {
+  size_t n = len + 2; /* size prefix and NUL */
+  unsigned char *p = (unsigned char *)pool_alloc(n);
+  if (!p) return NULL;
+  p[0] = n <= POOL_MAX ? pool_class_of[(n + 7) >> 3] : POOL_STRING_LARGE;
+  POOL_ADD(t_pool->made[POOL_STRING], 1);
+  return (char *)p + 1;
+}
+
+void pool_string_free(char *s) {
+  if (!s) return;
+  unsigned char *p = (unsigned char *)s - 1;
+  /* any size above POOL_MAX selects free() */
+  pool_free(p, p[0] == POOL_STRING_LARGE ? POOL_MAX + 1 : pool_class_size[p[0]]);
+  if (t_pool) POOL_ADD(t_pool->freed[POOL_STRING], 1);
+}
+
+void pool_thread_release(void) {
+  PoolThread *t = t_pool;
+  if (!t) return;
+  t_pool = NULL;
+  pool_lock();
+  t->idle = 1;
+  pool_unlock();
+}
+
+void pool_get_stats(PoolStats *out) {
+  memset(out, 0, sizeof(*out));
+  pool_lock();
+  for (PoolThread *t = g_pool_threads; t; t = t->next) {
+    out->threads++;
+    for (int k = 0; k < POOL_KINDS; ++k) {
+      int64_t made = POOL_READ(t->made[k]);
+      out->total[k] += made;
+      out->live[k] += made - POOL_READ(t->freed[k]);
+    }
+    for (int c = 0; c < POOL_CLASSES; ++c)
+      out->used_bytes += (POOL_READ(t->allocs[c]) - POOL_READ(t->frees[c])) * pool_class_size[c];
+    out->large += POOL_READ(t->large);
+  }
+  out->slabs = g_pool_slab_count;
+  out->slab_bytes = g_pool_slab_count * POOL_SLAB;
+  pool_unlock();
+}
@@ -0,0 +1,71 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file pool.h
+ * @brief Size-class slab pools for small runtime objects.
+ *
+ * Array and map headers, small element/key buffers, boxed ints and short
+ * string payloads are carved from 64 KiB slabs in size classes of up to
+ * POOL_MAX bytes; larger requests go to malloc(). Each thread allocates from
+ * and frees to its own cache, so the fast path takes no lock. A thread's
+ * cache outlives it: when a worker thread finishes, the next one adopts it.
+ * Slab memory is reused but never returned to the system.
+ *
+ * The pools also count live objects by kind (see mem_stats()).
+ */
+
+#ifndef FUN_POOL_H
+#define FUN_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Largest request served from the pools, in bytes. */
+#define POOL_MAX 256
+
+/** Object kinds counted by the pools. */
+enum { POOL_ARRAY, POOL_MAP, POOL_SET, POOL_STRING, POOL_KINDS };
+
+/** Process-wide allocation statistics (see mem_stats()). */
+typedef struct PoolStats {
+  int64_t live[POOL_KINDS];  /* objects allocated and not yet freed */
+  int64_t total[POOL_KINDS]; /* objects allocated so far */
+  int64_t slabs;             /* slabs carved */
+  int64_t slab_bytes;        /* bytes reserved by slabs */
+  int64_t used_bytes;        /* pooled bytes handed out and not freed */
+  int64_t large;             /* live requests above POOL_MAX (malloc) */
+  int threads;               /* thread caches created */
+} PoolStats;
+
+/** Allocate size bytes (pooled up to POOL_MAX); NULL for size 0 or on failure. */
+void *pool_alloc(size_t size);
+/** Like pool_alloc(), zero-filled. */
+void *pool_calloc(size_t size);
+/** Free p, which must have been allocated with this size. */
+void pool_free(void *p, size_t size);
+/** Resize p from old to size bytes, keeping the contents; NULL on failure (p stays valid). */
+void *pool_resize(void *p, size_t old, size_t size);
+
+/** Allocate a counted object of the given kind (POOL_ARRAY, POOL_MAP, POOL_SET). */
+void *pool_object_alloc(int kind, size_t size);
+/** Free an object from pool_object_alloc(). */
+void pool_object_free(int kind, void *p, size_t size);
+
+/** Buffer for a string of len bytes plus the NUL; free with pool_string_free(). */
+char *pool_string_alloc(size_t len);
+/** Free a string payload (the s of a VAL_STRING Value). */
+void pool_string_free(char *s);
+
+/** Hand the calling thread's cache to the next thread (call before it exits). */
+void pool_thread_release(void);
+/** Sum the statistics of all thread caches. */
+void pool_get_stats(PoolStats *out);
+
+#endif
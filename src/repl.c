@@ -22,9 +22,6 @@
 #include "value.h"
 #include "vm.h"
 
-/* include mapping helper from parser_utils.c */
-extern int map_expanded_line_to_include_path(const char *path, int line, char *out_path, size_t out_path_cap, int *out_line);
-
 #include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -1423,7 +1420,7 @@ int fun_run_repl(VM *vm) {
         int filtered = (pattern && *pattern);
         printf("=== globals%s%s ===\n", filtered ? " matching '" : "", filtered ? pattern : "");
         if (filtered) printf("'\n");
-        for (int i = 0; i < MAX_GLOBALS; ++i) {
+        for (int i = 0; i < vm->globals_cap; ++i) {
           if (vm->globals[i].type == VAL_NIL) continue;
           char *sv = value_to_string_alloc(&vm->globals[i]);
           if (!filtered || (sv && strstr(sv, pattern))) {
@@ -1736,7 +1733,7 @@ int fun_run_repl(VM *vm) {
         const char *fname = (f->fn && f->fn->name) ? f->fn->name : "<entry>";
         printf("Locals in frame #%d (%s):\n", idx, fname);
         int any = 0;
-        for (int i = 0; i < MAX_FRAME_LOCALS; ++i) {
+        for (int i = 0; i < f->nlocals; ++i) {
           if (f->locals[i].type != VAL_NIL) {
             char *sv = value_to_string_alloc(&f->locals[i]);
             printf("  %d: %s\n", i, sv ? sv : "nil");
@@ -1788,9 +1785,9 @@ int fun_run_repl(VM *vm) {
         }
         const char *path = f->fn->source_file;
         /* Map to included file if the current line belongs to an included chunk */
-        char mapped_path[1024];
+        const char *mapped_path = NULL;
         int mapped_line = line;
-        if (map_expanded_line_to_include_path(path, line, mapped_path, sizeof(mapped_path), &mapped_line)) {
+        if (line_map_lookup(f->fn->line_map, line, &mapped_path, &mapped_line)) {
           path = mapped_path;
           line = mapped_line;
         }
@@ -1982,7 +1979,7 @@ int fun_run_repl(VM *vm) {
           total = (size_t)count * sizeof(Value);
         } else if (strcmp(what, "globals") == 0) {
           base = (const unsigned char *)vm->globals;
-          total = (size_t)MAX_GLOBALS * sizeof(Value);
+          total = (size_t)vm->globals_cap * sizeof(Value);
         } else {
           ok_region = 0;
         }
@@ -2041,7 +2038,7 @@ int fun_run_repl(VM *vm) {
         int idx = -1;
         if (sscanf(spec, "local[%d]", &idx) == 1) {
           int fidx = (selected_frame >= 0 && selected_frame <= vm->fp) ? selected_frame : vm->fp;
-          if (fidx < 0 || idx < 0 || idx >= MAX_FRAME_LOCALS) {
+          if (fidx < 0 || idx < 0 || idx >= vm->frames[fidx].nlocals) {
             printf("(out of range)\n");
             continue;
           }
@@ -2058,7 +2055,7 @@ int fun_run_repl(VM *vm) {
           printf("%s\n", sv ? sv : "nil");
           free(sv);
         } else if (sscanf(spec, "global[%d]", &idx) == 1) {
-          if (idx < 0 || idx >= MAX_GLOBALS) {
+          if (idx < 0 || idx >= vm->globals_cap) {
             printf("(out of range)\n");
             continue;
           }
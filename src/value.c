@@ -20,27 +20,202 @@
  */
 
 #include "value.h"
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 /* Compile helper implementations into this TU to avoid build system changes */
 #include "array_utils.c"
+#include "pool.c"
 #include "str_utils.c"
 
+/*
+ * Array element storage.
+ *
+ * By default every element is a full Value. With FUN_NANBOX each element is
+ * packed into one 64-bit word, halving the memory of large arrays:
+ *   - doubles are stored as-is (every NaN is canonicalized first);
+ *   - everything else lives in the quiet-NaN space: the 4-bit tag is the sign
+ *     bit plus bits 48..50, the payload is the low 48 bits;
+ *   - ints in [-2^47, 2^47) are inline, larger ones point to a boxed int64_t;
+ *   - strings, arrays, maps and sets keep their owned pointer, functions their
+ *     borrowed one (user-space pointers fit in 48 bits on x86-64 and AArch64).
+ * The encoding never leaves this file: callers see Values through the array
+ * API below.
+ */
+#ifdef FUN_NANBOX
+#include <stdint.h>
+
+typedef uint64_t ArraySlot;
+
+typedef char nanbox_needs_64bit_pointers[sizeof(void *) == 8 ? 1 : -1];
+
+#define NB_QNAN 0x7FF8000000000000ULL
+#define NB_PAYLOAD 0x0000FFFFFFFFFFFFULL
+#define NB_MAKE(tag, payload) \
+  ((((uint64_t)(tag) >> 3) << 63) | NB_QNAN | (((uint64_t)(tag) & 7) << 48) | ((uint64_t)(payload) & NB_PAYLOAD))
+#define NB_IS_DOUBLE(s) (((s) & NB_QNAN) != NB_QNAN)
+#define NB_TAG(s) ((int)((((s) >> 63) << 3) | (((s) >> 48) & 7)))
+#define NB_PTR(s) ((void *)(uintptr_t)((s) & NB_PAYLOAD))
+#define NB_INT_MIN (-(INT64_C(1) << 47))
+#define NB_INT_MAX ((INT64_C(1) << 47) - 1)
+
+enum {
+  NB_NAN, /* the canonical quiet NaN itself */
+  NB_NIL,
+  NB_BOOL,
+  NB_INT,
+  NB_BIGINT, /* owned int64_t box */
+  NB_STRING,
+  NB_FUNCTION,
+  NB_ARRAY,
+  NB_MAP,
+  NB_SET
+};
+
+/* Pack a Value, taking ownership of it */
+static ArraySlot slot_encode(Value v) {
+  switch (v.type) {
+  case VAL_FLOAT: {
+    uint64_t bits;
+    if (v.d != v.d) return NB_QNAN;
+    memcpy(&bits, &v.d, sizeof bits);
+    return bits;
+  }
+  case VAL_INT:
+    if (v.i >= NB_INT_MIN && v.i <= NB_INT_MAX) return NB_MAKE(NB_INT, (uint64_t)v.i);
+    {
+      int64_t *box = (int64_t *)pool_alloc(sizeof(int64_t));
+      if (!box) return NB_MAKE(NB_NIL, 0);
+      *box = v.i;
+      return NB_MAKE(NB_BIGINT, (uintptr_t)box);
+    }
+  case VAL_BOOL:
+    return NB_MAKE(NB_BOOL, v.i ? 1 : 0);
+  case VAL_STRING:
+    return NB_MAKE(NB_STRING, (uintptr_t)v.s);
+  case VAL_FUNCTION:
+    return NB_MAKE(NB_FUNCTION, (uintptr_t)v.fn);
+  case VAL_ARRAY:
+    return NB_MAKE(NB_ARRAY, (uintptr_t)v.arr);
+  case VAL_MAP:
+    return NB_MAKE(NB_MAP, (uintptr_t)v.map);
+  case VAL_SET:
+    return NB_MAKE(NB_SET, (uintptr_t)v.map);
+  case VAL_NIL:
+  default:
+    return NB_MAKE(NB_NIL, 0);
+  }
+}
+
+/* Unpack a slot; the result borrows any string/array/map the slot owns */
+static Value slot_view(ArraySlot s) {
+  Value v;
+  if (NB_IS_DOUBLE(s) || s == NB_QNAN) {
+    v.type = VAL_FLOAT;
+    memcpy(&v.d, &s, sizeof v.d);
+    return v;
+  }
+  switch (NB_TAG(s)) {
+  case NB_BOOL:
+    v.type = VAL_BOOL;
+    v.i = (int64_t)(s & 1);
+    break;
+  case NB_INT:
+    v.type = VAL_INT;
+    v.i = (int64_t)((s & NB_PAYLOAD) << 16) >> 16;
+    break;
+  case NB_BIGINT:
+    v.type = VAL_INT;
+    v.i = *(const int64_t *)NB_PTR(s);
+    break;
+  case NB_STRING:
+    v.type = VAL_STRING;
+    v.s = (char *)NB_PTR(s);
+    break;
+  case NB_FUNCTION:
+    v.type = VAL_FUNCTION;
+    v.fn = (struct Bytecode *)NB_PTR(s);
+    break;
+  case NB_ARRAY:
+    v.type = VAL_ARRAY;
+    v.arr = (struct Array *)NB_PTR(s);
+    break;
+  case NB_MAP:
+  case NB_SET:
+    v.type = NB_TAG(s) == NB_MAP ? VAL_MAP : VAL_SET;
+    v.map = (struct Map *)NB_PTR(s);
+    break;
+  default:
+    v.type = VAL_NIL;
+    v.i = 0;
+    break;
+  }
+  return v;
+}
+
+/* Unpack a slot, moving its ownership to the returned Value */
+static Value slot_take(ArraySlot s) {
+  Value v = slot_view(s);
+  if (!NB_IS_DOUBLE(s) && NB_TAG(s) == NB_BIGINT) pool_free(NB_PTR(s), sizeof(int64_t));
+  return v;
+}
+
+static void slot_free(ArraySlot s) {
+  if (NB_IS_DOUBLE(s)) return;
+  switch (NB_TAG(s)) {
+  case NB_BIGINT:
+    pool_free(NB_PTR(s), sizeof(int64_t));
+    break;
+  case NB_STRING:
+  case NB_ARRAY:
+  case NB_MAP:
+  case NB_SET:
+    free_value(slot_view(s));
+    break;
+  default:
+    break;
+  }
+}
+
+/* Shallow copy (see copy_value); inline scalars are plain words */
+static ArraySlot slot_copy(ArraySlot s) {
+  if (NB_IS_DOUBLE(s)) return s;
+  switch (NB_TAG(s)) {
+  case NB_BIGINT:
+  case NB_STRING:
+  case NB_ARRAY:
+  case NB_MAP:
+  case NB_SET: {
+    Value v = slot_view(s);
+    return slot_encode(copy_value(&v));
+  }
+  default:
+    return s;
+  }
+}
+#else
+typedef Value ArraySlot;
+
+#define slot_encode(v) (v)
+#define slot_view(s) (s)
+#define slot_take(s) (s)
+#define slot_free(s) free_value(s)
+#define slot_copy(s) copy_value(&(s))
+#endif
+
 typedef struct Array {
-  int refcount;
+  GcHeader gc; /* refcount and cycle collector state */
   int count;
-  Value *items; /* owns items; each item owned by array */
+  int cap;
+  ArraySlot *items; /* owns items; each item owned by array */
 } Array;
 
-typedef struct Map {
-  int refcount;
-  int count;
-  int cap;
-  char **keys; /* each key owned here */
-  Value *vals; /* each value owned here */
-} Map;
+/* struct Map (maps and sets) is private to map.c */
+
+/* The cycle collector walks struct Array directly */
+#include "gc.c"
 
 /**
  * @brief Construct a Value representing a 64-bit integer.
@@ -93,12 +268,29 @@ Value make_bool(int v) {
  * @return A Value with type VAL_STRING.
  */
 Value make_string(const char *s) {
+  if (!s) s = "";
+  return make_string_len(s, strlen(s));
+}
+
+/**
+ * @brief Construct a string Value from the first len bytes of s.
+ *
+ * The payload comes from the string pools (see pool.h) and is always
+ * NUL-terminated; every VAL_STRING must be built here or by make_string so
+ * that free_value can release it. On allocation failure the Value's s is NULL.
+ *
+ * @param s   Bytes to copy, or NULL for an uninitialized buffer the caller fills.
+ * @param len Number of bytes.
+ * @return A Value with type VAL_STRING.
+ */
+Value make_string_len(const char *s, size_t len) {
   Value val;
   val.type = VAL_STRING;
-  if (s)
-    val.s = strdup(s);
-  else
-    val.s = strdup("");
+  val.s = pool_string_alloc(len);
+  if (val.s) {
+    if (s) memcpy(val.s, s, len);
+    val.s[len] = '\0';
+  }
   return val;
 }
 
@@ -129,6 +321,35 @@ Value make_nil(void) {
   return v;
 }
 
+/**
+ * @brief Allocate an empty array with room for @p cap items.
+ *
+ * @return Internal Array pointer, or NULL on allocation failure.
+ */
+static Array *array_alloc(int cap) {
+  Array *arr = (Array *)pool_object_alloc(POOL_ARRAY, sizeof(Array));
+  if (!arr) return NULL;
+  gc_header_init(&arr->gc, GC_ARRAY);
+  arr->count = 0;
+  arr->cap = cap > 0 ? cap : 0;
+  arr->items = NULL;
+  if (arr->cap > 0) {
+    arr->items = (ArraySlot *)pool_alloc(sizeof(ArraySlot) * arr->cap);
+    if (!arr->items) {
+      pool_object_free(POOL_ARRAY, arr, sizeof(Array));
+      return NULL;
+    }
+  }
+  return arr;
+}
+
+static Value array_value(Array *arr) {
+  Value v;
+  v.type = VAL_ARRAY;
+  v.arr = (struct Array *)arr;
+  return v;
+}
+
 /**
  * @brief Create an array Value by copying items from an input span.
  *
@@ -141,30 +362,13 @@ Value make_nil(void) {
  */
 Value make_array_from_values(const Value *vals, int count) {
   if (count < 0) count = 0;
-  Array *arr = (Array *)malloc(sizeof(Array));
-  if (!arr) {
-    Value nil = make_nil();
-    return nil;
+  Array *arr = array_alloc(count);
+  if (!arr) return make_nil();
+  for (int i = 0; i < count; ++i) {
+    arr->items[i] = slot_encode(copy_value(&vals[i]));
   }
-  arr->refcount = 1;
   arr->count = count;
-  if (count > 0) {
-    arr->items = (Value *)malloc(sizeof(Value) * count);
-    if (!arr->items) {
-      free(arr);
-      Value nil = make_nil();
-      return nil;
-    }
-    for (int i = 0; i < count; ++i) {
-      arr->items[i] = copy_value(&vals[i]);
-    }
-  } else {
-    arr->items = NULL;
-  }
-  Value v;
-  v.type = VAL_ARRAY;
-  v.arr = (struct Array *)arr;
-  return v;
+  return array_value(arr);
 }
 
 /**
@@ -193,10 +397,31 @@ int array_get_copy(const Value *v, int index, Value *out) {
   if (!v || v->type != VAL_ARRAY || !v->arr) return 0;
   const Array *a = (const Array *)v->arr;
   if (index < 0 || index >= a->count) return 0;
-  if (out) *out = copy_value(&a->items[index]);
+  if (out) {
+    Value item = slot_view(a->items[index]);
+    *out = copy_value(&item);
+  }
   return 1;
 }
 
+/**
+ * @brief Borrow an array element without copying it.
+ *
+ * The result is a view of the element, not a copy: it must not be freed and
+ * stays valid until the array is modified or freed. It is returned by value
+ * because with FUN_NANBOX the element only exists encoded in its slot, so
+ * there is no Value in the array a pointer could refer to.
+ *
+ * @return The element, or nil if @p v is not an array or the index is out of
+ *         range.
+ */
+Value array_peek_value(const Value *v, int index) {
+  if (!v || v->type != VAL_ARRAY || !v->arr) return make_nil();
+  const Array *a = (const Array *)v->arr;
+  if (index < 0 || index >= a->count) return make_nil();
+  return slot_view(a->items[index]);
+}
+
 /**
  * @brief Replace an element of an array with a new Value.
  *
@@ -211,37 +436,30 @@ int array_set(Value *v, int index, Value newElem) {
   if (!v || v->type != VAL_ARRAY || !v->arr) return 0;
   Array *a = (Array *)v->arr;
   if (index < 0 || index >= a->count) return 0;
-  free_value(a->items[index]);
-  a->items[index] = newElem; /* take ownership */
+  slot_free(a->items[index]);
+  a->items[index] = slot_encode(newElem); /* take ownership */
   return 1;
 }
 
 /**
  * @brief Ensure the internal items buffer can hold at least newCount items.
  *
- * May grow the allocation exponentially; initializes new slots to nil.
+ * Grows the allocation geometrically so that repeated pushes are amortized
+ * O(1).
  *
  * @param a Internal Array pointer.
- * @param newCount Required minimum logical capacity.
+ * @param newCount Required minimum capacity.
  * @return 1 on success, 0 on allocation failure.
  */
 static int ensure_array_capacity(Array *a, int newCount) {
-  if (newCount <= a->count) return 1;
-  /* grow to at least newCount; double strategy */
-  int curr = a->count;
-  int cap = curr;
-  if (cap < 4) cap = 4;
+  if (newCount <= a->cap) return 1;
+  int cap = a->cap < 4 ? 4 : a->cap;
   while (cap < newCount)
-    cap *= 2;
-  Value *newItems = (Value *)realloc(a->items, sizeof(Value) * cap);
+    cap = cap > INT_MAX / 2 ? newCount : cap * 2;
+  ArraySlot *newItems = (ArraySlot *)pool_resize(a->items, sizeof(ArraySlot) * a->cap, sizeof(ArraySlot) * cap);
   if (!newItems) return 0;
-  /* if growing beyond current count, initialize new slots to nil */
-  if (cap > a->count) {
-    for (int i = a->count; i < cap; ++i) {
-      newItems[i] = make_nil();
-    }
-  }
   a->items = newItems;
+  a->cap = cap;
   return 1;
 }
 
@@ -257,14 +475,11 @@ static int ensure_array_capacity(Array *a, int newCount) {
 int array_push(Value *v, Value newElem) {
   if (!v || v->type != VAL_ARRAY || !v->arr) return -1;
   Array *a = (Array *)v->arr;
-  /* ensure capacity for count+1 by reallocating items array to at least count+1 elements */
-  Value *newItems = (Value *)realloc(a->items, sizeof(Value) * (a->count + 1));
-  if (!newItems) {
+  if (!ensure_array_capacity(a, a->count + 1)) {
     free_value(newElem);
     return -1;
   }
-  a->items = newItems;
-  a->items[a->count] = newElem; /* take ownership */
+  a->items[a->count] = slot_encode(newElem); /* take ownership */
   a->count += 1;
   return a->count;
 }
@@ -285,9 +500,9 @@ int array_pop(Value *v, Value *out) {
   if (a->count <= 0) return 0;
   int idx = a->count - 1;
   if (out)
-    *out = a->items[idx]; /* transfer ownership */
+    *out = slot_take(a->items[idx]); /* transfer ownership */
   else
-    free_value(a->items[idx]);
+    slot_free(a->items[idx]);
   a->count -= 1;
   return 1;
 }
@@ -307,17 +522,13 @@ int array_insert(Value *v, int index, Value newElem) {
   Array *a = (Array *)v->arr;
   if (index < 0) index = 0;
   if (index > a->count) index = a->count;
-  Value *newItems = (Value *)realloc(a->items, sizeof(Value) * (a->count + 1));
-  if (!newItems) {
+  if (!ensure_array_capacity(a, a->count + 1)) {
     free_value(newElem);
     return -1;
   }
-  a->items = newItems;
   /* shift right */
-  for (int i = a->count; i > index; --i) {
-    a->items[i] = a->items[i - 1];
-  }
-  a->items[index] = newElem; /* take ownership */
+  memmove(&a->items[index + 1], &a->items[index], sizeof(ArraySlot) * (a->count - index));
+  a->items[index] = slot_encode(newElem); /* take ownership */
   a->count += 1;
   return a->count;
 }
@@ -338,17 +549,24 @@ int array_remove(Value *v, int index, Value *out) {
   Array *a = (Array *)v->arr;
   if (index < 0 || index >= a->count) return 0;
   if (out)
-    *out = a->items[index]; /* transfer ownership */
+    *out = slot_take(a->items[index]); /* transfer ownership */
   else
-    free_value(a->items[index]);
+    slot_free(a->items[index]);
   /* shift left */
-  for (int i = index; i < a->count - 1; ++i) {
-    a->items[i] = a->items[i + 1];
-  }
+  memmove(&a->items[index], &a->items[index + 1], sizeof(ArraySlot) * (a->count - index - 1));
   a->count -= 1;
   return 1;
 }
 
+/**
+ * @brief Append shallow copies of src[0..n) to an array with enough capacity.
+ */
+static void array_append_copies(Array *dst, const ArraySlot *src, int n) {
+  for (int i = 0; i < n; ++i) {
+    dst->items[dst->count++] = slot_copy(src[i]);
+  }
+}
+
 /**
  * @brief Create a shallow-copied slice of an array Value.
  *
@@ -367,10 +585,10 @@ Value array_slice(const Value *v, int start, int end) {
   if (end < 0 || end > n) end = n;
   if (start > end) start = end;
   int m = end - start;
-  if (m <= 0) {
-    return make_array_from_values(NULL, 0);
-  }
-  return make_array_from_values(a->items + start, m);
+  Array *out = array_alloc(m);
+  if (!out) return make_nil();
+  array_append_copies(out, a->items + start, m);
+  return array_value(out);
 }
 
 /**
@@ -389,18 +607,11 @@ Value array_concat(const Value *av, const Value *bv) {
   const Array *b = (const Array *)bv->arr;
   int na = a ? a->count : 0;
   int nb = b ? b->count : 0;
-  int total = na + nb;
-  if (total <= 0) return make_array_from_values(NULL, 0);
-  Value *tmp = (Value *)malloc(sizeof(Value) * total);
-  if (!tmp) return make_nil();
-  for (int i = 0; i < na; ++i)
-    tmp[i] = a->items[i];
-  for (int j = 0; j < nb; ++j)
-    tmp[na + j] = b->items[j];
-  Value out = make_array_from_values(tmp, total);
-  /* free temporaries we copied from (deep copy in make_array_from_values) */
-  free(tmp);
-  return out;
+  Array *out = array_alloc(na + nb);
+  if (!out) return make_nil();
+  if (na > 0) array_append_copies(out, a->items, na);
+  if (nb > 0) array_append_copies(out, b->items, nb);
+  return array_value(out);
 }
 
 /**
@@ -426,7 +637,7 @@ Value copy_value(const Value *v) {
     out.i = v->i ? 1 : 0;
     break;
   case VAL_STRING:
-    out.s = v->s ? strdup(v->s) : strdup("");
+    out.s = make_string(v->s).s;
     break;
   case VAL_FUNCTION:
     out.fn = v->fn; /* shallow copy pointer */
@@ -434,15 +645,13 @@ Value copy_value(const Value *v) {
   case VAL_ARRAY: {
     Array *a = (Array *)v->arr;
     out.arr = (struct Array *)a;
-    if (a) a->refcount++;
+    if (a) a->gc.refcount++;
     break;
   }
-  case VAL_MAP: {
-    Map *m = (Map *)v->map;
-    out.map = (struct Map *)m;
-    if (m) m->refcount++;
+  case VAL_MAP:
+  case VAL_SET:
+    out.map = map_retain(v->map);
     break;
-  }
   case VAL_NIL:
   default:
     break;
@@ -450,6 +659,31 @@ Value copy_value(const Value *v) {
   return out;
 }
 
+/**
+ * @brief Construct an array Value that takes over existing items.
+ *
+ * Unlike make_array_from_values(), the items are moved instead of copied:
+ * ownership of vals[0..count) passes to the array (also on failure, where
+ * they are freed). The vals buffer itself remains owned by the caller.
+ *
+ * @param vals  Items to move into the array.
+ * @param count Number of items.
+ * @return A Value of type VAL_ARRAY, or VAL_NIL on allocation failure.
+ */
+Value make_array_take(Value *vals, int count) {
+  if (count < 0) count = 0;
+  Array *arr = array_alloc(count);
+  if (!arr) {
+    for (int i = 0; i < count; ++i)
+      free_value(vals[i]);
+    return make_nil();
+  }
+  for (int i = 0; i < count; ++i)
+    arr->items[i] = slot_encode(vals[i]);
+  arr->count = count;
+  return array_value(arr);
+}
+
 /* deep copy including arrays (recursively copies items) */
 /**
  * @brief Deep copy a Value, recursively copying arrays and maps.
@@ -481,7 +715,8 @@ Value deep_copy_value(const Value *v) {
     Value *tmp = (Value *)malloc(sizeof(Value) * a->count);
     if (!tmp) return make_nil();
     for (int i = 0; i < a->count; ++i) {
-      tmp[i] = deep_copy_value(&a->items[i]);
+      Value item = slot_view(a->items[i]);
+      tmp[i] = deep_copy_value(&item);
     }
     Value out = make_array_from_values(tmp, a->count);
     for (int i = 0; i < a->count; ++i) {
@@ -490,16 +725,9 @@ Value deep_copy_value(const Value *v) {
     free(tmp);
     return out;
   }
-  case VAL_MAP: {
-    const Map *m = (const Map *)v->map;
-    if (!m || m->count <= 0) return make_map_empty();
-    Value out = make_map_empty();
-    for (int i = 0; i < m->count; ++i) {
-      Value dv = deep_copy_value(&m->vals[i]);
-      map_set(&out, m->keys[i], dv);
-    }
-    return out;
-  }
+  case VAL_MAP:
+  case VAL_SET:
+    return map_deep_copy(v);
   case VAL_NIL:
   default:
     return make_nil();
@@ -516,27 +744,21 @@ Value deep_copy_value(const Value *v) {
  */
 void free_value(Value v) {
   if (v.type == VAL_STRING && v.s) {
-    free(v.s);
+    pool_string_free(v.s);
   } else if (v.type == VAL_ARRAY && v.arr) {
     Array *a = (Array *)v.arr;
-    if (--a->refcount == 0) {
+    if (--a->gc.refcount > 0) {
+      gc_possible_root(&a->gc);
+    } else {
+      if (a->gc.root >= 0) gc_forget(&a->gc);
       for (int i = 0; i < a->count; ++i) {
-        free_value(a->items[i]);
+        slot_free(a->items[i]);
       }
-      free(a->items);
-      free(a);
-    }
-  } else if (v.type == VAL_MAP && v.map) {
-    Map *m = (Map *)v.map;
-    if (--m->refcount == 0) {
-      for (int i = 0; i < m->count; ++i) {
-        if (m->keys[i]) free(m->keys[i]);
-        free_value(m->vals[i]);
-      }
-      free(m->keys);
-      free(m->vals);
-      free(m);
+      pool_free(a->items, sizeof(ArraySlot) * a->cap);
+      pool_object_free(POOL_ARRAY, a, sizeof(Array));
     }
+  } else if ((v.type == VAL_MAP || v.type == VAL_SET) && v.map) {
+    map_release(v.map);
   }
   /* VAL_FUNCTION: we *do not* free the Bytecode here (caller frees it) */
 }
@@ -572,25 +794,17 @@ void print_value(const Value *v) {
     if (a) {
       for (int i = 0; i < a->count; ++i) {
         if (i > 0) printf(", ");
-        print_value(&a->items[i]);
+        Value item = slot_view(a->items[i]);
+        print_value(&item);
       }
     }
     printf("]");
     break;
   }
-  case VAL_MAP: {
-    const Map *m = (const Map *)v->map;
-    printf("{");
-    if (m) {
-      for (int i = 0; i < m->count; ++i) {
-        if (i > 0) printf(", ");
-        printf("\"%s\": ", m->keys[i] ? m->keys[i] : "");
-        print_value(&m->vals[i]);
-      }
-    }
-    printf("}");
+  case VAL_MAP:
+  case VAL_SET:
+    map_print(v);
     break;
-  }
   case VAL_NIL:
   default:
     printf("nil");
@@ -601,7 +815,7 @@ void print_value(const Value *v) {
 /**
  * @brief Evaluate a Value's truthiness according to Fun language rules.
  *
- * Empty strings, zero numbers, nil and empty arrays are falsey; everything
+ * Empty strings, zero numbers, nil, empty arrays and empty sets are falsey; everything
  * else is truthy.
  *
  * @param v Value to evaluate.
@@ -623,6 +837,8 @@ int value_is_truthy(const Value *v) {
     const Array *a = (const Array *)v->arr;
     return a && a->count > 0;
   }
+  case VAL_SET:
+    return map_count(v) > 0;
   case VAL_NIL:
   default:
     return 0;
@@ -666,13 +882,11 @@ char *value_to_string_alloc(const Value *v) {
     snprintf(buf, sizeof(buf), "[array n=%d]", n);
     return strdup(buf);
   }
-  case VAL_MAP: {
-    int n = 0;
-    if (v->type == VAL_MAP && v->map) {
-      const Map *m = (const Map *)v->map;
-      n = m ? m->count : 0;
-    }
-    snprintf(buf, sizeof(buf), "{map n=%d}", n);
+  case VAL_MAP:
+  case VAL_SET: {
+    int n = map_count(v);
+    if (n < 0) n = 0;
+    snprintf(buf, sizeof(buf), v->type == VAL_SET ? "{set n=%d}" : "{map n=%d}", n);
     return strdup(buf);
   }
   case VAL_NIL:
@@ -685,8 +899,8 @@ char *value_to_string_alloc(const Value *v) {
  * @brief Compare two Values for equality.
  *
  * Supports numeric cross-type equality between ints and floats. Strings are
- * compared by content. Other types default to pointer/type equality as
- * implemented in the switch.
+ * compared by content, sets by their elements. Other types default to
+ * pointer/type equality as implemented in the switch.
  *
  * @param a First Value.
  * @param b Second Value.
@@ -710,6 +924,8 @@ int value_equals(const Value *a, const Value *b) {
     const char *sb = b->s ? b->s : "";
     return strcmp(sa, sb) == 0;
   }
+  case VAL_SET:
+    return set_equals(a, b);
   default:
     return 0;
   }
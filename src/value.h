@@ -38,6 +38,8 @@
 #ifndef FUN_VALUE_H
 #define FUN_VALUE_H
 
+#include "gc.h"
+#include "pool.h"
 #include <inttypes.h>
 
 struct Bytecode; /* forward */
@@ -55,7 +57,8 @@ typedef enum {
   VAL_ARRAY,
   VAL_MAP,
   VAL_NIL,
-  VAL_FLOAT
+  VAL_FLOAT,
+  VAL_SET /* hashed set of ints/floats/bools/strings; shares the map table */
 } ValueType;
 
 /**
@@ -70,10 +73,10 @@ typedef struct {
   union {
     int64_t i;
     double d;
-    char *s;
+    char *s; /* owned payload from make_string/make_string_len; never free() it */
     struct Bytecode *fn;
     struct Array *arr;
-    struct Map *map;
+    struct Map *map; /* VAL_MAP and VAL_SET */
   };
 } Value;
 
@@ -84,6 +87,8 @@ Value make_int(int64_t v);
 Value make_bool(int v);
 /** Create a string Value by copying @p s. */
 Value make_string(const char *s);
+/** Create a string Value from @p len bytes of @p s (NULL: uninitialized, to be filled in). */
+Value make_string_len(const char *s, size_t len);
 /** Create a function Value from bytecode pointer (shallow). */
 Value make_function(struct Bytecode *fn);
 /** Create a nil Value. */
@@ -94,10 +99,14 @@ Value make_float(double v);
 /* arrays */
 /** Build an array from a list of Values (deep-copies vals). */
 Value make_array_from_values(const Value *vals, int count);
+/** Build an array that takes ownership of vals[0..count); the vals buffer itself stays the caller's. */
+Value make_array_take(Value *vals, int count);
 /** Get array length or -1 if @p v is not an array. */
 int array_length(const Value *v);
 /** Copy array item at index to out; returns 0 on error. */
 int array_get_copy(const Value *v, int index, Value *out);
+/** Borrow array item at index (a view, do not free); nil on error. */
+Value array_peek_value(const Value *v, int index);
 /** Set element at index; takes ownership of newElem; 0 on error. */
 int array_set(Value *v, int index, Value newElem);
 /** Push new element; returns new length or -1 on error. */
@@ -113,8 +122,8 @@ Value array_slice(const Value *v, int start, int end);
 /** Concatenate arrays a and b into a new array. */
 Value array_concat(const Value *a, const Value *b);
 
-/* maps (string keys) */
-/** Create a new empty string-keyed map Value. */
+/* maps (string, int, float and bool keys; hashed, insertion-ordered) */
+/** Create a new empty map Value. */
 Value make_map_empty(void);
 /** Set key to v (takes ownership); returns 1 on success. */
 int map_set(Value *m, const char *key, Value v);
@@ -124,10 +133,64 @@ int map_set_copy(Value *m, const char *key, const Value *v);
 int map_get_copy(const Value *m, const char *key, Value *out);
 /** Test if key exists; returns 1/0. */
 int map_has(const Value *m, const char *key);
-/** Return array of string keys. */
+/** Return array of keys (set elements) in insertion order. */
 Value map_keys_array(const Value *m);
 /** Return array of values (copies). */
 Value map_values_array(const Value *m);
+/** Set a key of any key type to v (takes ownership); 0 if not a map or the key type is unsupported. */
+int map_set_key(Value *m, const Value *key, Value v);
+/** Lookup a key of any key type; returns 1 and copies value to out (if non-NULL) on success. */
+int map_get_key(const Value *m, const Value *key, Value *out);
+/** Test if a map has the key or a set the element; returns 1/0. */
+int map_has_key(const Value *m, const Value *key);
+/** Borrow the value of a key, inserting nil if missing; valid until the map changes; NULL on error. */
+Value *map_slot_key(Value *m, const Value *key);
+/** Remove a map key or set element (O(n): keeps insertion order); returns 1 if it was present. */
+int map_remove_key(Value *m, const Value *key);
+/** Number of map entries or set elements; -1 for other types. */
+int map_count(const Value *m);
+/** Borrow the key (set element) at insertion position i; NULL if out of range. */
+const Value *map_peek_key(const Value *m, int i);
+/** Borrow the map value at insertion position i; NULL if out of range or a set. */
+const Value *map_peek_val(const Value *m, int i);
+
+/* sets (same table as maps, without values) */
+/** Create a new empty set Value. */
+Value make_set_empty(void);
+/** Add a copy of v; returns 1 if added, 0 if present, -1 if v cannot be an element. */
+int set_add(Value *s, const Value *v);
+/** New set from the items of an array or the keys of a set/map; unhashable items are skipped. */
+Value set_from_values(const Value *src);
+/** New set: elements of a, then those of b not in a. */
+Value set_union(const Value *a, const Value *b);
+/** New set: elements of a that are also in b. */
+Value set_intersect(const Value *a, const Value *b);
+/** 1 if both sets have the same elements. */
+int set_equals(const Value *a, const Value *b);
+
+/* map/set internals used by value.c */
+/** Add a reference to a map/set table. */
+struct Map *map_retain(struct Map *m);
+/** Drop a reference to a map/set table; frees it with the last one. */
+void map_release(struct Map *m);
+/** Deep copy of a map (values copied recursively) or set. */
+Value map_deep_copy(const Value *m);
+/** Print a map or set to stdout. */
+void map_print(const Value *m);
+/** Call visit for every array, map or set stored as a map value (cycle collector). */
+void map_gc_visit(struct Map *m, void (*visit)(GcHeader *child));
+/** Release every map value, leaving nil (cycle collector, on garbage maps). */
+void map_gc_clear(struct Map *m);
+
+/* shared key sets: many maps with the same keys (e.g. table rows) point to one
+ * refcounted key array; a map copies the keys only when a key is added */
+struct MapKeys;
+/** Create a key set from count names (copied); NULL on allocation failure. */
+struct MapKeys *map_keys_new(const char *const *names, int count);
+/** Drop one reference to a key set; frees it with the last one. */
+void map_keys_release(struct MapKeys *k);
+/** Build a map with the keys of k (shared, not copied), taking ownership of vals[0..count of k). */
+Value make_map_shared(struct MapKeys *k, Value *vals);
 
 /* copy/free */
 /** Shallow/deep copy depending on type (deep for strings, RC for arrays/maps). */
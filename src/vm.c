@@ -26,6 +26,14 @@
 #ifndef _XOPEN_SOURCE
 #define _XOPEN_SOURCE 700
 #endif
+/* glibc hides SO_REUSEPORT and TCP_DEFER_ACCEPT under strict POSIX */
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+/* ...and the posix_spawn chdir/closefrom file actions behind _GNU_SOURCE */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
 #endif
 
 #include <math.h>
@@ -39,6 +47,8 @@
 #ifdef __unix__
 #include <netdb.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/un.h>
@@ -63,6 +73,9 @@
 #include "value.h"
 #include "vm.h"
 
+// Handle tables for native objects (core built-ins and extensions)
+#include "handles.c"
+
 // Optional by extensions commonly used code. #ifdef's are in each single file.
 #include "extensions/curl.c"
 #include "extensions/ini.c"
@@ -75,13 +88,36 @@
 #include "extensions/kcgi.c"
 #include "extensions/redis.c"
 
-/* forward declarations for include mapping used in error reporting */
-extern char *preprocess_includes(const char *src);
-extern int map_expanded_line_to_include_path(const char *path, int line, char *out_path, size_t out_path_cap, int *out_line);
-
 /* Threading internals (registry and platform glue) */
 #include "vm/os/thread_common.c"
 
+/* Event loop handles (epoll/poll backends) */
+#include "vm/os/evloop_common.c"
+
+/* HTTP/1.1 request parser and response builder */
+#include "vm/net/http_common.c"
+
+/* Open file descriptor cache and sendfile for static file serving */
+#include "vm/os/file_cache_common.c"
+
+/* Reusable socket buffers, send-all and vectored I/O */
+#include "vm/os/sockbuf_common.c"
+
+/* Child process handles (posix_spawn with stdin/stdout/stderr pipes) */
+#include "vm/os/proc_common.c"
+
+/* Streaming CSV reader and writer */
+#include "vm/io/csv_common.c"
+
+/* Profiler for fun --profile (call/line hooks, SIGPROF sampling, report) */
+#include "vm/core/profile_common.c"
+
+/* Native base64, hex and percent-encoding (codec.c) behind codec handles */
+#include "vm/encoding/codec_common.c"
+
+/* Native hashes, CRCs and AES-256 (crypto.c) behind hash handles; hex via codec.c */
+#include "vm/crypto/hash_common.c"
+
 /* Track the currently running VM to annotate error messages */
 #ifdef _WIN32
 static __declspec(thread) VM *g_active_vm = NULL;
@@ -136,26 +172,17 @@ static int fun_vm_vfprintf(FILE *stream, const char *fmt, va_list ap) {
         if (line <= 0) line = g_active_vm->current_line > 0 ? g_active_vm->current_line : 1;
 
         /* Map expanded line back to the real included file.
-         * Important: OP_LINE operands refer to the expanded, top-level source produced by
-         * the preprocessor. Therefore we must pass the TOP-LEVEL script path to the mapper,
-         * not the current function's own source_file (which may point at an included file).
-         */
+         * OP_LINE operands refer to the expanded, top-level source produced by
+         * the preprocessor; the line map recorded at compile time (shared by the
+         * module and all of its functions) resolves them without any I/O. */
         if (line > 0) {
-          /* Attempt to retrieve the entry frame's source file as the true top-level path */
-          const char *top_path = NULL;
-          if (g_active_vm->fp >= 0) {
-            Frame *entry = &g_active_vm->frames[0];
-            if (entry && entry->fn && entry->fn->source_file) top_path = entry->fn->source_file;
-          }
-          /* Fallback: use current function's source when entry is unavailable */
-          if (!top_path) top_path = sfile;
-          if (top_path) {
-            char mapped_path[1024];
-            int mapped_line = line;
-            if (map_expanded_line_to_include_path(top_path, line, mapped_path, sizeof(mapped_path), &mapped_line)) {
-              sfile = strdup(mapped_path); /* leak acceptable on error paths */
-              line = mapped_line;
-            }
+          const LineMap *lm = f->fn->line_map;
+          if (!lm && g_active_vm->frames[0].fn) lm = g_active_vm->frames[0].fn->line_map;
+          const char *mapped_path = NULL;
+          int mapped_line = line;
+          if (line_map_lookup(lm, line, &mapped_path, &mapped_line)) {
+            sfile = mapped_path;
+            line = mapped_line;
           }
         }
       }
@@ -213,6 +240,7 @@ static void fun_vm_exit(int code) {
     longjmp(g_vm_err_jmp, code ? code : 1);
   }
   /* Fallback: terminate immediately if not in REPL-on-error mode */
+  if (g_active_vm && g_active_vm->profile) vm_profile_report(g_active_vm, stderr);
 #ifdef _WIN32
   _exit(code);
 #else
@@ -339,6 +367,8 @@ static const char *value_type_name(ValueType t) {
     return "array";
   case VAL_MAP:
     return "map";
+  case VAL_SET:
+    return "set";
   case VAL_NIL:
     return "nil";
   case VAL_STRING:
@@ -366,20 +396,96 @@ void vm_clear_output(VM *vm) {
     vm->output_is_partial[i] = 0;
 }
 
+/* forward declaration for helpers used in vm_reset/vm_free */
+static void vm_pop_frame(VM *vm);
+void vm_reset(VM *vm);
+static void vm_co_free_all(VM *vm);
+static void vm_co_finish(VM *vm);
+static Coroutine *vm_co_get(VM *vm, int64_t id);
+
 /**
  * @brief Free resources owned directly by the VM structure.
  *
- * Currently a no-op because the VM does not allocate persistent internal
- * resources outside frames, globals and outputs, which are managed elsewhere.
+ * Releases all values (as vm_reset does) and then the heap storage of the
+ * operand stack, call frames (including their locals buffers) and globals.
  *
  * @param vm VM instance to free resources for.
  */
 void vm_free(VM *vm) {
-  // currently nothing persistent allocated inside VM itself
+  vm_reset(vm);
+  vm_co_free_all(vm);
+  for (int i = 0; i < vm->frames_cap; ++i)
+    free(vm->frames[i].locals);
+  free(vm->frames);
+  free(vm->stack);
+  free(vm->globals);
+  vm->frames = NULL;
+  vm->frames_cap = 0;
+  vm->stack = NULL;
+  vm->stack_cap = 0;
+  vm->globals = NULL;
+  vm->globals_cap = 0;
+  /* cycles left by this VM's values, then the thread's candidate buffer */
+  gc_collect();
+  gc_drop_roots();
+  vm_profile_free(vm);
 }
 
-/* forward declaration for helper used in vm_reset */
-static void vm_pop_frame(VM *vm);
+/**
+ * @brief Change the growth limits of the VM's stack, frames and globals.
+ *
+ * Values <= 0 leave the corresponding limit unchanged. Lowering a limit below
+ * the currently allocated size does not shrink storage; it only stops growth.
+ *
+ * @param vm VM instance.
+ * @param max_stack Maximum operand stack depth in values.
+ * @param max_frames Maximum call depth.
+ * @param max_globals Maximum number of global slots.
+ */
+void vm_set_limits(VM *vm, int max_stack, int max_frames, int max_globals) {
+  if (max_stack > 0) vm->max_stack = max_stack;
+  if (max_frames > 0) vm->max_frames = max_frames;
+  if (max_globals > 0) vm->max_globals = max_globals;
+}
+
+/**
+ * @brief Compute the next capacity for a doubling buffer.
+ *
+ * @param cap Current capacity.
+ * @param need Minimum required capacity.
+ * @param initial Capacity used for the first allocation.
+ * @param limit Hard upper bound.
+ * @return New capacity (>= need), or -1 if need exceeds limit.
+ */
+static int vm_grow_cap(int cap, int need, int initial, int limit) {
+  if (need > limit) return -1;
+  int ncap = cap > 0 ? cap : initial;
+  while (ncap < need)
+    ncap = (ncap > limit / 2) ? limit : ncap * 2;
+  return ncap < limit ? ncap : limit;
+}
+
+/**
+ * @brief Grow the global table so that index idx is valid.
+ *
+ * New slots are initialized to nil. Aborts with a runtime error when the
+ * index exceeds the VM's global limit.
+ *
+ * @param vm VM instance.
+ * @param idx Global slot that must become addressable.
+ */
+static void vm_grow_globals(VM *vm, int idx) {
+  int ncap = vm_grow_cap(vm->globals_cap, idx + 1, 64, vm->max_globals);
+  Value *ng = ncap > 0 ? (Value *)realloc(vm->globals, sizeof(Value) * (size_t)ncap) : NULL;
+  if (!ng) {
+    fprintf(stderr, "Runtime error: too many globals (limit %d)\n", vm->max_globals);
+    exit(1);
+  }
+  for (int i = vm->globals_cap; i < ncap; ++i)
+    ng[i] = make_nil();
+  vm->globals = ng;
+  vm->globals_cap = ncap;
+}
 
 /**
  * @brief Reset the VM to a clean state.
@@ -396,8 +502,10 @@ void vm_reset(VM *vm) {
   }
   // Clear stack
   vm->sp = -1;
+  // Drop suspended coroutines
+  vm_co_free_all(vm);
   // Free globals
-  for (int i = 0; i < MAX_GLOBALS; ++i) {
+  for (int i = 0; i < vm->globals_cap; ++i) {
     free_value(vm->globals[i]);
     vm->globals[i] = make_nil();
   }
@@ -422,7 +530,7 @@ void vm_reset(VM *vm) {
  */
 void vm_dump_globals(VM *vm) {
   printf("=== globals ===\n");
-  for (int i = 0; i < MAX_GLOBALS; ++i) {
+  for (int i = 0; i < vm->globals_cap; ++i) {
     if (vm->globals[i].type != VAL_NIL) {
       printf("[%d] ", i);
       print_value(&vm->globals[i]);
@@ -572,8 +680,8 @@ void vm_debug_request_continue(VM *vm) {
 /** Return current number of values on the stack. */
 static inline int vm_stack_count(const VM *vm) { return vm->sp + 1; }
 
-/** Return available space left on the stack (in Values). */
-static inline int vm_stack_space(const VM *vm) { return STACK_SIZE - (vm->sp + 1); }
+/** Return available space left on the stack (in Values) before hitting the limit. */
+static inline int vm_stack_space(const VM *vm) { return vm->max_stack - (vm->sp + 1); }
 
 /** Ensure at least n values are available to pop; aborts on underflow. */
 static inline void vm_require_stack(VM *vm, int n) {
@@ -585,18 +693,35 @@ static inline void vm_require_stack(VM *vm, int n) {
 }
 
 /**
- * @brief Push a Value onto the VM operand stack.
+ * @brief Grow the operand stack storage (up to max_stack) to hold need values.
  *
- * Takes ownership of the provided Value. Aborts execution on overflow.
+ * Aborts execution with a stack overflow error once the limit is reached.
  *
  * @param vm VM instance.
- * @param v Value to push (ownership transferred).
+ * @param need Number of stack slots that must be allocated.
  */
-static void push_value(VM *vm, Value v) {
-  if (vm->sp >= STACK_SIZE - 1) {
+static void vm_grow_stack(VM *vm, int need) {
+  int ncap = vm_grow_cap(vm->stack_cap, need, 256, vm->max_stack);
+  Value *ns = ncap > 0 ? (Value *)realloc(vm->stack, sizeof(Value) * (size_t)ncap) : NULL;
+  if (!ns) {
     fprintf(stderr, "Runtime error: stack overflow\n");
     exit(1);
   }
+  vm->stack = ns;
+  vm->stack_cap = ncap;
+}
+
+/**
+ * @brief Push a Value onto the VM operand stack.
+ *
+ * Takes ownership of the provided Value. Grows the stack on demand and aborts
+ * execution when the stack limit is exceeded.
+ *
+ * @param vm VM instance.
+ * @param v Value to push (ownership transferred).
+ */
+static void push_value(VM *vm, Value v) {
+  if (vm->sp >= vm->stack_cap - 1) vm_grow_stack(vm, vm->sp + 2);
   vm->stack[++vm->sp] = v; /* take ownership of v */
 }
 
@@ -616,6 +741,30 @@ static Value pop_value(VM *vm) {
   return vm->stack[vm->sp--]; /* caller owns returned Value */
 }
 
+/* --- Numeric fast paths for binary operators --- */
+/** True for VAL_INT and VAL_FLOAT. */
+static inline int vm_is_num(const Value *v) { return v->type == VAL_INT || v->type == VAL_FLOAT; }
+
+/** Numeric Value (int or float) as double. */
+static inline double vm_num_as_double(const Value *v) { return v->type == VAL_FLOAT ? v->d : (double)v->i; }
+
+/**
+ * @brief Return the left operand slot if the two topmost stack values are numbers.
+ *
+ * Binary arithmetic/comparison handlers use this to work on the stack in place:
+ * the result overwrites the left operand and the right operand is dropped by
+ * decrementing sp. Ints and floats own no heap memory, so no pop/free/push is
+ * needed. Returns NULL when the generic path has to handle the operands.
+ *
+ * @param vm VM instance.
+ * @return Pointer to the left operand (the right one follows it), or NULL.
+ */
+static inline Value *vm_num_operands(VM *vm) {
+  if (vm->sp < 1) return NULL;
+  Value *a = &vm->stack[vm->sp - 1];
+  return (vm_is_num(a) && vm_is_num(a + 1)) ? a : NULL;
+}
+
 /* --- C ABI helpers for Rust FFI --- */
 /**
  * @brief Pop a numeric Value and convert it to a 64-bit integer (C ABI helper).
@@ -703,6 +852,8 @@ size_t vm_offset_of_sp(void) {
 /**
  * @brief Obtain offsetof(VM, stack) for FFI struct field access.
  *
+ * The field is a pointer to the heap-allocated stack (Value *).
+ *
  * @return Byte offset of the stack field within VM.
  */
 size_t vm_offset_of_stack(void) {
@@ -712,37 +863,38 @@ size_t vm_offset_of_stack(void) {
 /**
  * @brief Obtain offsetof(VM, globals) for FFI struct field access.
  *
+ * The field is a pointer to the heap-allocated globals (Value *).
+ *
  * @return Byte offset of the globals field within VM.
  */
 size_t vm_offset_of_globals(void) {
   return offsetof(VM, globals);
 }
 
-/**
- * @brief Initialize a call frame to a clean state.
- *
- * Sets function pointer and instruction pointer, zeroes locals to nil and
- * resets the try-stack pointer.
- *
- * @param f Frame to initialize.
- */
-static void frame_init(Frame *f) {
-  f->fn = NULL;
-  f->ip = 0;
-  for (int i = 0; i < MAX_FRAME_LOCALS; ++i)
-    f->locals[i] = make_nil();
-  f->try_sp = -1;
-}
-
 /**
  * @brief Initialize a VM instance to its default state.
  *
  * Resets stack/frame pointers, output buffers, instruction counters, debugger
- * state and globals. Does not allocate memory.
+ * state and limits. Does not allocate memory: stack, frames and globals are
+ * allocated on first use.
  *
  * @param vm VM instance to initialize.
  */
 void vm_init(VM *vm) {
+  vm->stack = NULL;
+  vm->stack_cap = 0;
+  vm->frames = NULL;
+  vm->frames_cap = 0;
+  vm->globals = NULL;
+  vm->globals_cap = 0;
+  vm->max_stack = STACK_SIZE;
+  vm->max_frames = MAX_FRAMES;
+  vm->max_globals = MAX_GLOBALS;
+  vm->co_slots = NULL;
+  vm->co_slot_count = 0;
+  vm->co_slot_cap = 0;
+  vm->co_free = -1;
+  vm->co_current = 0;
   vm->sp = -1;
   vm->fp = -1;
   vm->output_count = 0;
@@ -751,6 +903,7 @@ void vm_init(VM *vm) {
   vm->instr_count = 0;
   vm->exit_code = 0;
   vm->trace_enabled = 0;
+  vm->profile = NULL;
   vm->repl_on_error = 0;
   vm->on_error_repl = NULL;
 
@@ -769,9 +922,27 @@ void vm_init(VM *vm) {
     vm->breakpoints[i].line = 0;
     vm->breakpoints[i].active = 0;
   }
+}
 
-  for (int i = 0; i < MAX_GLOBALS; ++i)
-    vm->globals[i] = make_nil();
+/**
+ * @brief Grow the frame array (up to max_frames) to hold need frames.
+ *
+ * New frame slots are zeroed (no locals buffer yet). Aborts when the call
+ * depth limit is exceeded.
+ *
+ * @param vm VM instance.
+ * @param need Number of frame slots that must be allocated.
+ */
+static void vm_grow_frames(VM *vm, int need) {
+  int ncap = vm_grow_cap(vm->frames_cap, need, 16, vm->max_frames);
+  Frame *nf = ncap > 0 ? (Frame *)realloc(vm->frames, sizeof(Frame) * (size_t)ncap) : NULL;
+  if (!nf) {
+    fprintf(stderr, "Runtime error: too many frames (limit %d)\n", vm->max_frames);
+    exit(1);
+  }
+  memset(nf + vm->frames_cap, 0, sizeof(Frame) * (size_t)(ncap - vm->frames_cap));
+  vm->frames = nf;
+  vm->frames_cap = ncap;
 }
 
 /* push a new frame, transferring ownership of args[] into frame->locals[0..argc-1] */
@@ -779,7 +950,9 @@ void vm_init(VM *vm) {
  * @brief Push a new call frame for a function and transfer arguments.
  *
  * The first argc Values from args are moved (ownership transfer) into the new
- * frame's local slots starting at index 0. Aborts on frame stack overflow.
+ * frame's local slots starting at index 0; the remaining slots the function
+ * uses are set to nil. The frame array and the frame's locals buffer grow on
+ * demand. Aborts when the call depth limit is exceeded.
  *
  * @param vm VM instance.
  * @param fn Function bytecode to execute in the new frame.
@@ -787,18 +960,32 @@ void vm_init(VM *vm) {
  * @param args Array of argument Values (may be NULL if argc == 0).
  */
 static void vm_push_frame(VM *vm, Bytecode *fn, int argc, Value *args) {
-  if (vm->fp >= MAX_FRAMES - 1) {
-    fprintf(stderr, "Runtime error: too many frames\n");
-    exit(1);
-  }
+  if (vm->fp >= vm->frames_cap - 1) vm_grow_frames(vm, vm->fp + 2);
   Frame *f = &vm->frames[++vm->fp];
-  frame_init(f);
+  int need = fn->nlocals > argc ? fn->nlocals : argc;
+  if (need > f->locals_cap) {
+    int ncap = vm_grow_cap(f->locals_cap, need, 8, INT32_MAX);
+    Value *nl = (Value *)realloc(f->locals, sizeof(Value) * (size_t)ncap);
+    if (!nl) {
+      vm->fp--;
+      fprintf(stderr, "Runtime error: out of memory for locals\n");
+      exit(1);
+    }
+    f->locals = nl;
+    f->locals_cap = ncap;
+  }
   f->fn = fn;
   f->ip = 0;
+  f->try_sp = -1;
+  f->nlocals = need;
   /* move args into locals 0..argc-1 */
-  for (int i = 0; i < argc && i < MAX_FRAME_LOCALS; ++i) {
+  for (int i = 0; i < argc; ++i) {
     f->locals[i] = args[i]; /* transfer ownership */
   }
+  for (int i = argc; i < need; ++i) {
+    f->locals[i] = make_nil();
+  }
+  if (vm->profile) vm_profile_enter(vm);
 }
 
 /* pop current frame and free its locals */
@@ -814,14 +1001,23 @@ static void vm_pop_frame(VM *vm) {
     fprintf(stderr, "Runtime error: pop frame with empty frame stack\n");
     exit(1);
   }
+  if (vm->profile) vm_profile_leave(vm);
   Frame *f = &vm->frames[vm->fp];
-  for (int i = 0; i < MAX_FRAME_LOCALS; ++i) {
+  for (int i = 0; i < f->nlocals; ++i) {
     free_value(f->locals[i]);
-    f->locals[i] = make_nil();
   }
+  f->nlocals = 0;
   vm->fp--;
+  /* the running coroutine's entry function returned */
+  if (vm->co_current) {
+    Coroutine *co = vm_co_get(vm, vm->co_current);
+    if (!co || vm->fp == co->base_fp) vm_co_finish(vm);
+  }
 }
 
+/* Coroutine table and stack switching (uses the frame/stack helpers above) */
+#include "vm/core/coroutine_common.c"
+
 /**
  * @brief Print the VM's buffered output values to stdout.
  *
@@ -922,6 +1118,9 @@ void vm_run(VM *vm, Bytecode *entry) {
     }
   }
 
+  /* coroutines left running by an aborted previous run lost their frames */
+  vm_co_abandon_running(vm);
+
   /* start with entry frame (no args) */
   vm_push_frame(vm, entry, 0, NULL);
 
@@ -1057,8 +1256,16 @@ void vm_run(VM *vm, Bytecode *entry) {
 #include "vm/bitwise/shr.c"
 
 #include "vm/core/call.c"
+#include "vm/core/co_close.c"
+#include "vm/core/co_create.c"
+#include "vm/core/co_resume.c"
+#include "vm/core/co_running.c"
+#include "vm/core/co_status.c"
 #include "vm/core/dup.c"
 #include "vm/core/exit.c"
+#include "vm/core/gc.c"
+#include "vm/core/gc_stats.c"
+#include "vm/core/mem_stats.c"
 #include "vm/core/halt.c"
 #include "vm/core/jump.c"
 #include "vm/core/jump_if_false.c"
@@ -1074,10 +1281,43 @@ void vm_run(VM *vm, Bytecode *entry) {
 #include "vm/core/throw.c"
 #include "vm/core/try_pop.c"
 #include "vm/core/try_push.c"
+#include "vm/core/yield.c"
+
+/* Native crypto ops */
+#include "vm/crypto/aes256_encrypt_hex.c"
+#include "vm/crypto/crypto_accel.c"
+#include "vm/crypto/hash_final.c"
+#include "vm/crypto/hash_free.c"
+#include "vm/crypto/hash_new.c"
+#include "vm/crypto/hash_update.c"
+#include "vm/crypto/hash_update_hex.c"
+
+/* Base64, hex and percent-encoding ops */
+#include "vm/encoding/base64_decode.c"
+#include "vm/encoding/base64_encode.c"
+#include "vm/encoding/codec_accel.c"
+#include "vm/encoding/codec_final.c"
+#include "vm/encoding/codec_free.c"
+#include "vm/encoding/codec_new.c"
+#include "vm/encoding/codec_update.c"
+#include "vm/encoding/hex_decode.c"
+#include "vm/encoding/hex_encode.c"
+#include "vm/encoding/url_decode.c"
+#include "vm/encoding/url_encode.c"
 
 #include "vm/io/input_line.c"
 #include "vm/io/read_file.c"
 #include "vm/io/write_file.c"
+#include "vm/io/csv_open.c"
+#include "vm/io/csv_next.c"
+#include "vm/io/csv_read.c"
+#include "vm/io/csv_header.c"
+#include "vm/io/csv_close.c"
+#include "vm/io/csv_parse.c"
+#include "vm/io/csv_writer.c"
+#include "vm/io/csv_write.c"
+#include "vm/io/csv_writer_close.c"
+#include "vm/io/csv_format.c"
 
 #include "vm/logic/and.c"
 #include "vm/logic/eq.c"
@@ -1089,9 +1329,17 @@ void vm_run(VM *vm, Bytecode *entry) {
 #include "vm/logic/not.c"
 #include "vm/logic/or.c"
 
+#include "vm/maps/count_by.c"
+#include "vm/maps/group_by.c"
 #include "vm/maps/has_key.c"
 #include "vm/maps/keys.c"
 #include "vm/maps/make_map.c"
+#include "vm/maps/map_incr.c"
+#include "vm/maps/set_add.c"
+#include "vm/maps/set_intersect.c"
+#include "vm/maps/set_new.c"
+#include "vm/maps/set_remove.c"
+#include "vm/maps/set_union.c"
 #include "vm/maps/values.c"
 
 #include "vm/math/abs.c"
@@ -1128,12 +1376,27 @@ void vm_run(VM *vm, Bytecode *entry) {
 #include "vm/rust/set_exit.c"
 
 #include "vm/os/clock_mono_ms.c"
+#include "vm/os/clock_mono_ns.c"
 #include "vm/os/date_format.c"
 #include "vm/os/env.c"
 #include "vm/os/env_all.c"
 #include "vm/os/fun_version.c"
 #include "vm/os/proc_run.c"
 #include "vm/os/proc_system.c"
+#include "vm/os/proc_fork.c"
+#include "vm/os/proc_waitpid.c"
+#include "vm/os/proc_kill.c"
+#include "vm/os/proc_getpid.c"
+#include "vm/os/proc_getppid.c"
+#include "vm/os/proc_spawn.c"
+#include "vm/os/proc_write.c"
+#include "vm/os/proc_close_stdin.c"
+#include "vm/os/proc_read.c"
+#include "vm/os/proc_poll.c"
+#include "vm/os/proc_wait.c"
+#include "vm/os/proc_wait_many.c"
+#include "vm/os/proc_pid.c"
+#include "vm/os/proc_close.c"
 #include "vm/os/random_number.c"
 #include "vm/os/serial_close.c"
 #include "vm/os/serial_config.c"
@@ -1159,6 +1422,26 @@ void vm_run(VM *vm, Bytecode *entry) {
 #include "vm/os/fd_set_nonblock.c"
 #include "vm/os/fd_poll_read.c"
 #include "vm/os/fd_poll_write.c"
+#include "vm/os/evloop_new.c"
+#include "vm/os/evloop_add.c"
+#include "vm/os/evloop_mod.c"
+#include "vm/os/evloop_del.c"
+#include "vm/os/evloop_wait.c"
+#include "vm/os/evloop_close.c"
+#include "vm/net/http_parse_request.c"
+#include "vm/net/http_response.c"
+#include "vm/os/socket_sendfile.c"
+#include "vm/os/file_cache_stat.c"
+#include "vm/os/socket_buf_new.c"
+#include "vm/os/socket_buf_free.c"
+#include "vm/os/socket_buf_len.c"
+#include "vm/os/socket_buf_append.c"
+#include "vm/os/socket_buf_take.c"
+#include "vm/os/socket_buf_consume.c"
+#include "vm/os/socket_recv_into.c"
+#include "vm/os/socket_send_all.c"
+#include "vm/os/socket_readv.c"
+#include "vm/os/socket_writev.c"
 
 #ifdef FUN_WITH_PCSC
 #include "vm/pcsc/connect.c"
@@ -1179,10 +1462,21 @@ void vm_run(VM *vm, Bytecode *entry) {
 
 /* XML ops (libxml2) */
 #ifdef FUN_WITH_XML2
+#include "vm/xml/attr.c"
+#include "vm/xml/attrs.c"
+#include "vm/xml/children.c"
+#include "vm/xml/free.c"
 #include "vm/xml/name.c"
+#include "vm/xml/next.c"
+#include "vm/xml/parent.c"
 #include "vm/xml/parse.c"
+#include "vm/xml/reader_close.c"
+#include "vm/xml/reader_next.c"
+#include "vm/xml/reader_open.c"
+#include "vm/xml/reader_record.c"
 #include "vm/xml/root.c"
 #include "vm/xml/text.c"
+#include "vm/xml/xpath.c"
 #endif
 
 /* INI ops (iniparser 4.2.6) */
@@ -1204,6 +1498,7 @@ void vm_run(VM *vm, Bytecode *entry) {
 #ifdef FUN_WITH_CURL
 #include "vm/curl/download.c"
 #include "vm/curl/get.c"
+#include "vm/curl/multi.c"
 #include "vm/curl/post.c"
 #endif
 
@@ -21,17 +21,25 @@
 
 #include "bytecode.h"
 #include <stddef.h>
+#include <stdio.h>
 
+/*
+ * Limits of the growable VM storage. Stack, frames, globals and per-frame
+ * locals start small and double on demand; these values only cap the growth.
+ * They are the defaults of a new VM and can be changed per VM with
+ * vm_set_limits(). MAX_FRAME_LOCALS and MAX_GLOBALS are also enforced by the
+ * compiler.
+ */
 #ifndef MAX_FRAMES
-#define MAX_FRAMES 128
+#define MAX_FRAMES 100000
 #endif
 
 #ifndef MAX_FRAME_LOCALS
-#define MAX_FRAME_LOCALS 64
+#define MAX_FRAME_LOCALS 65536
 #endif
 
 #ifndef MAX_GLOBALS
-#define MAX_GLOBALS 128
+#define MAX_GLOBALS 65536
 #endif
 
 #ifndef OUTPUT_SIZE
@@ -39,68 +47,133 @@
 #endif
 
 #ifndef STACK_SIZE
-#define STACK_SIZE 1024
+#define STACK_SIZE 1048576
 #endif
 
+/* Mnemonics indexed by OpCode; keep in the same order as the enum in bytecode.h. */
 static const char *opcode_names[] = {
   "NOP", "LOAD_CONST", "LOAD_LOCAL", "STORE_LOCAL",
-  "LOAD_GLOBAL", "STORE_GLOBAL", "ADD", "SUB", "MUL", "DIV",
-  "LT", "LTE", "GT", "GTE", "EQ", "NEQ", "POP", "JUMP",
-  "JUMP_IF_FALSE", "CALL", "RETURN", "PRINT", "ECHO", "HALT",
+  "LOAD_GLOBAL", "STORE_GLOBAL",
+  "ADD", "SUB", "MUL", "DIV",
+  "LT", "LTE", "GT", "GTE", "EQ", "NEQ",
+  "POP", "JUMP", "JUMP_IF_FALSE",
+  "CALL", "RETURN",
+  "PRINT", "ECHO", "HALT",
   "LINE",
-  "MOD", "AND", "OR", "NOT", "DUP", "SWAP",
+  "MOD", "AND", "OR", "NOT",
+  "DUP", "SWAP",
   "MAKE_ARRAY", "INDEX_GET", "INDEX_SET",
   "LEN", "PUSH", "APOP", "SET", "INSERT", "REMOVE", "SLICE",
-  "TO_NUMBER", "TO_STRING", "CAST", "TYPEOF",
+  "TO_NUMBER", "TO_STRING", "CAST", "TYPEOF", "UCLAMP", "SCLAMP",
   "SPLIT", "JOIN", "SUBSTR", "FIND",
   "REGEX_MATCH", "REGEX_SEARCH", "REGEX_REPLACE",
   "CONTAINS", "INDEX_OF", "CLEAR",
   "ENUMERATE", "ZIP",
   "MIN", "MAX", "CLAMP", "ABS", "POW", "RANDOM_SEED", "RANDOM_INT",
   "MAKE_MAP", "KEYS", "VALUES", "HAS_KEY",
-  "READ_FILE", "WRITE_FILE", "ENV", "INPUT_LINE", "PROC_RUN", "PROC_SYSTEM",
-  "TIME_NOW_MS", "CLOCK_MONO_MS", "DATE_FORMAT",
-  "THREAD_SPAWN", "THREAD_JOIN", "SLEEP_MS",
-  "RANDOM_NUMBER",
+  "SET_NEW", "SET_ADD", "SET_REMOVE", "SET_UNION", "SET_INTERSECT", "MAP_INCR", "COUNT_BY", "GROUP_BY",
+  "READ_FILE", "WRITE_FILE",
+  "CSV_OPEN", "CSV_NEXT", "CSV_READ", "CSV_HEADER", "CSV_CLOSE", "CSV_PARSE", "CSV_WRITER", "CSV_WRITE",
+  "CSV_WRITER_CLOSE", "CSV_FORMAT",
+  "ENV", "INPUT_LINE", "PROC_RUN", "PROC_SYSTEM", "PROC_FORK", "PROC_WAITPID", "PROC_KILL",
+  "PROC_GETPID", "PROC_GETPPID", "PROC_SPAWN", "PROC_WRITE", "PROC_CLOSE_STDIN", "PROC_READ", "PROC_POLL",
+  "PROC_WAIT", "PROC_WAIT_MANY", "PROC_PID", "PROC_CLOSE", "TIME_NOW_MS", "CLOCK_MONO_MS",
+  "CLOCK_MONO_NS", "KCGI_PARSE", "KCGI_REPLY_START", "KCGI_WRITE", "KCGI_END", "DATE_FORMAT", "ENV_ALL", "FUN_VERSION",
+  "THREAD_SPAWN", "THREAD_JOIN", "SLEEP_MS", "RANDOM_NUMBER",
   "BAND", "BOR", "BXOR", "BNOT", "SHL", "SHR", "ROTL", "ROTR",
   "JSON_PARSE", "JSON_STRINGIFY", "JSON_FROM_FILE", "JSON_TO_FILE",
-  "CURL_GET", "CURL_POST", "CURL_DOWNLOAD",
+  "CURL_GET", "CURL_POST", "CURL_DOWNLOAD", "CURL_MULTI",
   "SQLITE_OPEN", "SQLITE_CLOSE", "SQLITE_EXEC", "SQLITE_QUERY",
-  /* Redis (hiredis) */
   "REDIS_CONNECT", "REDIS_CMD", "REDIS_CLOSE",
-  "LIBSQL_OPEN", "LIBSQL_CLOSE", "LIBSQL_EXEC", "LIBSQL_QUERY",
   "PCSC_ESTABLISH", "PCSC_RELEASE", "PCSC_LIST_READERS", "PCSC_CONNECT", "PCSC_DISCONNECT", "PCSC_TRANSMIT",
   "PCRE2_TEST", "PCRE2_MATCH", "PCRE2_FINDALL",
-  "INI_LOAD", "INI_FREE", "INI_GET_STRING", "INI_GET_INT", "INI_GET_DOUBLE", "INI_GET_BOOL", "INI_SET", "INI_UNSET", "INI_SAVE",
-  "XML_PARSE", "XML_ROOT", "XML_NAME", "XML_TEXT",
-  "SOCK_TCP_LISTEN", "SOCK_TCP_ACCEPT", "SOCK_TCP_CONNECT", "SOCK_SEND", "SOCK_RECV", "SOCK_CLOSE", "SOCK_UNIX_LISTEN", "SOCK_UNIX_CONNECT",
+  "OPENSSL_MD5", "OPENSSL_SHA256", "OPENSSL_SHA512", "OPENSSL_RIPEMD160",
+  "INI_LOAD", "INI_FREE", "INI_GET_STRING", "INI_GET_INT", "INI_GET_DOUBLE", "INI_GET_BOOL", "INI_SET",
+  "INI_UNSET", "INI_SAVE",
+  "XML_PARSE", "XML_ROOT", "XML_NAME", "XML_TEXT", "XML_FREE", "XML_CHILDREN", "XML_NEXT", "XML_PARENT",
+  "XML_ATTRS", "XML_ATTR", "XML_XPATH", "XML_READER_OPEN", "XML_READER_NEXT", "XML_READER_RECORD", "XML_READER_CLOSE",
+  "SOCK_TCP_LISTEN", "SOCK_TCP_ACCEPT", "SOCK_TCP_CONNECT", "SOCK_SEND", "SOCK_RECV", "SOCK_CLOSE",
+  "SOCK_UNIX_LISTEN", "SOCK_UNIX_CONNECT",
   "FD_SET_NONBLOCK", "FD_POLL_READ", "FD_POLL_WRITE",
   "EXIT",
   "OS_LIST_DIR",
   "SERIAL_OPEN", "SERIAL_CONFIG", "SERIAL_SEND", "SERIAL_RECV", "SERIAL_CLOSE",
   "TRY_PUSH", "TRY_POP", "THROW",
+  "FLOOR", "CEIL", "TRUNC", "ROUND",
+  "SIN", "COS", "TAN", "EXP", "LOG", "LOG10", "SQRT",
+  "GCD", "LCM", "ISQRT", "SIGN",
   "FMIN", "FMAX",
-  /* Rust FFI demo */
+  "CO_CREATE", "CO_RESUME", "YIELD", "CO_STATUS", "CO_CLOSE", "CO_RUNNING",
+  "EVLOOP_NEW", "EVLOOP_ADD", "EVLOOP_MOD", "EVLOOP_DEL", "EVLOOP_WAIT", "EVLOOP_CLOSE",
+  "HTTP_PARSE_REQUEST", "HTTP_RESPONSE",
+  "SOCK_SENDFILE", "FILE_CACHE_STAT",
+  "SOCK_BUF_NEW", "SOCK_BUF_FREE", "SOCK_BUF_LEN", "SOCK_BUF_APPEND", "SOCK_BUF_TAKE", "SOCK_BUF_CONSUME", "SOCK_RECV_INTO", "SOCK_SEND_ALL", "SOCK_READV", "SOCK_WRITEV",
+  "GC", "GC_STATS", "MEM_STATS",
+  "HASH_NEW", "HASH_UPDATE", "HASH_UPDATE_HEX", "HASH_FINAL", "HASH_FREE", "AES256_ENCRYPT_HEX", "CRYPTO_ACCEL",
+  "BASE64_ENCODE", "BASE64_DECODE", "HEX_ENCODE", "HEX_DECODE", "URL_ENCODE", "URL_DECODE", "CODEC_NEW", "CODEC_UPDATE", "CODEC_FINAL", "CODEC_FREE", "CODEC_ACCEL",
   "RUST_HELLO", "RUST_HELLO_ARGS", "RUST_HELLO_ARGS_RETURN", "RUST_GET_SP", "RUST_SET_EXIT",
-  /* C++ demo */
   "CPP_ADD"};
 
 /**
  * @brief Call frame representing one active function invocation.
  *
  * Each frame keeps a pointer to its function bytecode, the current
- * instruction pointer within that bytecode, a fixed-size array of local
- * variables, and a small try/catch stack for exception handling.
+ * instruction pointer within that bytecode, its local variable slots, and a
+ * small try/catch stack for exception handling. The locals buffer belongs to
+ * the frame slot and is reused by later calls at the same depth.
  */
 typedef struct {
   Bytecode *fn;
   int ip;
-  Value locals[MAX_FRAME_LOCALS];
+  Value *locals;  /* nlocals live slots */
+  int nlocals;    /* slots used by the current call */
+  int locals_cap; /* allocated slots */
   /* exception handling (per-frame) */
   int try_stack[16];
   int try_sp; /* -1 when empty */
+  /* profiler (fun --profile) */
+  int64_t prof_start; /* when this call (or its resume) started, ns */
+  int prof_outer;     /* outermost active call of fn: owns the inclusive time */
 } Frame;
 
+/** Coroutine states (Coroutine.status, reported by co_status()). */
+enum { CO_SUSPENDED = 0, CO_RUNNING = 1, CO_NORMAL = 2, CO_DEAD = 3 };
+
+/**
+ * @brief A function activation that can be suspended at yield and resumed later.
+ *
+ * While it runs, a coroutine's frames and operand values sit on the VM stacks
+ * directly above those of its resumer (base_fp/base_sp). On yield they are
+ * moved into the coroutine's own buffers, and co_resume moves them back. A
+ * suspended coroutine therefore costs only its live frames, locals and
+ * pending operands.
+ */
+typedef struct Coroutine {
+  Bytecode *fn; /* entry function */
+  Value *args;  /* arguments for the first resume (owned), NULL once started */
+  int argc;
+  int started;
+  int status; /* CO_* */
+
+  Frame *frames; /* saved frames, outermost first */
+  int nframes;
+  int frames_cap;
+  Value *stack; /* saved operand stack segment (owned values) */
+  int nstack;
+  int stack_cap;
+
+  int base_fp;     /* resumer's fp while running */
+  int base_sp;     /* resumer's sp while running */
+  int64_t resumer; /* id of the coroutine that resumed this one, 0 = main program */
+} Coroutine;
+
+/** Coroutine table slot; ids combine slot index and generation. */
+typedef struct {
+  Coroutine *co;
+  uint32_t gen;  /* bumped when the slot is freed, so stale ids never match */
+  int next_free; /* free-list link, -1 at the end */
+} CoSlot;
+
 /**
  * @brief The Fun virtual machine state.
  *
@@ -108,15 +181,31 @@ typedef struct {
  * runtime counters, and debugger state. Functions in this header operate on
  * this structure; callers must ensure proper initialization with vm_init()
  * before use and call vm_free()/vm_reset() as appropriate.
+ *
+ * Stack, frames and globals are heap arrays that grow by doubling up to the
+ * max_* limits, so an idle VM allocates nothing for them.
  */
 struct VM {
-  Value stack[STACK_SIZE];
+  Value *stack;
   int sp;
+  int stack_cap;
 
-  Frame frames[MAX_FRAMES];
+  Frame *frames;
   int fp; // frame pointer, -1 when no frame
+  int frames_cap;
+
+  Value *globals;
+  int globals_cap;
+
+  int max_stack;   // growth limit for stack (values)
+  int max_frames;  // growth limit for frames (call depth)
+  int max_globals; // growth limit for globals
 
-  Value globals[MAX_GLOBALS];
+  CoSlot *co_slots; // coroutine table (see vm/core/coroutine_common.c)
+  int co_slot_count;
+  int co_slot_cap;
+  int co_free;        // head of the free slot list, -1 when empty
+  int64_t co_current; // id of the running coroutine, 0 in the main program
 
   Value output[OUTPUT_SIZE]; // store printed values
   int output_count;
@@ -134,6 +223,7 @@ struct VM {
   int exit_code; // process exit code set by OP_EXIT
 
   int trace_enabled;                   // when non-zero, print executed ops and stack
+  struct VmProfile *profile;           // profiler state while profiling (see vm_profile_start), else NULL
   int repl_on_error;                   // when non-zero, enter REPL on runtime error (preserve stack)
   int (*on_error_repl)(struct VM *vm); // optional hook to run REPL on error
 
@@ -160,6 +250,16 @@ typedef struct VM VM;
  */
 void vm_init(VM *vm);
 
+/**
+ * @brief Change the growth limits of a VM's stack, call frames and globals.
+ * Values <= 0 keep the current limit. Storage already allocated is kept.
+ * @param vm VM instance.
+ * @param max_stack Maximum operand stack depth (values).
+ * @param max_frames Maximum call depth.
+ * @param max_globals Maximum number of global slots.
+ */
+void vm_set_limits(VM *vm, int max_stack, int max_frames, int max_globals);
+
 /**
  * @brief Clear the buffered output captured by the VM.
  * @param vm VM instance.
@@ -175,8 +275,23 @@ void vm_dump_opcode_counters(VM *vm);
 /** Print a human-readable VM stack trace to stderr (top frame first). */
 void vm_print_stacktrace(VM *vm);
 /**
- * @brief Free all resources owned by the VM (globals, frames, output buffers).
- * The VM object itself is not freed when allocated on the stack.
+ * @brief Start profiling calls, time and source lines of this VM (fun --profile).
+ * @param vm VM instance.
+ * @param folded_path File for the sampled stacks in collapsed "a;b;c count"
+ *        form (flame graph tools), written by vm_profile_report(); NULL for none.
+ * @return 1 on success (or when already profiling), 0 when out of memory.
+ */
+int vm_profile_start(VM *vm, const char *folded_path);
+/**
+ * @brief Stop profiling, print the report to out and write the collapsed stacks.
+ * Also called when a runtime error terminates the process.
+ * @param vm VM instance.
+ * @param out Stream for the text report.
+ */
+void vm_profile_report(VM *vm, FILE *out);
+/**
+ * @brief Free all resources owned by the VM (globals, frames, stack, output).
+ * The VM object itself is not freed. Call vm_init() before reusing it.
  * @param vm VM instance to dispose.
  */
 void vm_free(VM *vm);
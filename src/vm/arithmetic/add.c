@@ -18,7 +18,8 @@
  * - Arrays: Concatenates two arrays.
  *
  * Behavior:
- * - Pops two values from the stack.
+ * - Int/float operands are combined in place on the stack top (no pop/push).
+ * - Otherwise pops two values from the stack.
  * - Performs the operation based on the types of the operands.
  * - Pushes the result back onto the stack.
  *
@@ -33,39 +34,33 @@
  */
 
 case OP_ADD: {
+  Value *na = vm_num_operands(vm);
+  if (na) {
+    /* numeric fast path: compute in place on the stack */
+    if (na[0].type == VAL_INT && na[1].type == VAL_INT) {
+      na[0].i += na[1].i;
+    } else {
+      na[0].d = vm_num_as_double(&na[0]) + vm_num_as_double(&na[1]);
+      na[0].type = VAL_FLOAT;
+    }
+    vm->sp--;
+    break;
+  }
   vm_require_stack(vm, 2);
   Value b = pop_value(vm);
   Value a = pop_value(vm);
-  if ((a.type == VAL_INT || a.type == VAL_FLOAT) && (b.type == VAL_INT || b.type == VAL_FLOAT)) {
-    if (a.type == VAL_FLOAT || b.type == VAL_FLOAT) {
-      double da = (a.type == VAL_FLOAT) ? a.d : (double)a.i;
-      double db = (b.type == VAL_FLOAT) ? b.d : (double)b.i;
-      Value res = make_float(da + db);
-      free_value(a);
-      free_value(b);
-      push_value(vm, res);
-    } else {
-      Value res = make_int(a.i + b.i);
-      free_value(a);
-      free_value(b);
-      push_value(vm, res);
-    }
-  } else if (a.type == VAL_STRING && b.type == VAL_STRING) {
+  if (a.type == VAL_STRING && b.type == VAL_STRING) {
     const char *sa = a.s ? a.s : "";
     const char *sb = b.s ? b.s : "";
     size_t la = strlen(sa);
     size_t lb = strlen(sb);
-    char *buf = (char *)malloc(la + lb + 1);
-    if (!buf) {
+    Value res = make_string_len(NULL, la + lb);
+    if (!res.s) {
       fprintf(stderr, "Runtime error: out of memory during string concatenation\n");
       exit(1);
     }
-    memcpy(buf, sa, la);
-    memcpy(buf + la, sb, lb);
-    buf[la + lb] = '\0';
-    Value res;
-    res.type = VAL_STRING;
-    res.s = buf;
+    memcpy(res.s, sa, la);
+    memcpy(res.s + la, sb, lb);
     free_value(a);
     free_value(b);
     push_value(vm, res);
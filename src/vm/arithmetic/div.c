@@ -20,6 +20,7 @@
  * - Pops two values from the stack.
  * - If any operand is VAL_FLOAT, computes (double)a / (double)b and pushes a VAL_FLOAT.
  * - Else computes a.i / b.i and pushes a VAL_INT.
+ * - Numeric operands with a non-zero divisor are divided in place on the stack top.
  *
  * Error Handling:
  * - Raises a runtime error and aborts execution if operands are not numeric.
@@ -34,6 +35,18 @@
  */
 
 case OP_DIV: {
+  Value *na = vm_num_operands(vm);
+  if (na && vm_num_as_double(&na[1]) != 0.0) {
+    /* numeric fast path: compute in place on the stack (zero divisor takes the generic path) */
+    if (na[0].type == VAL_INT && na[1].type == VAL_INT) {
+      na[0].i /= na[1].i;
+    } else {
+      na[0].d = vm_num_as_double(&na[0]) / vm_num_as_double(&na[1]);
+      na[0].type = VAL_FLOAT;
+    }
+    vm->sp--;
+    break;
+  }
   Value b = pop_value(vm);
   Value a = pop_value(vm);
   if ((a.type == VAL_INT || a.type == VAL_FLOAT) && (b.type == VAL_INT || b.type == VAL_FLOAT)) {
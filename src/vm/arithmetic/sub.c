@@ -17,7 +17,7 @@
  * subtraction.
  *
  * Behavior:
- * - Pops two values from the stack.
+ * - Works in place on the two topmost stack values (no pop/free/push).
  * - If any operand is VAL_FLOAT, computes (double)a - (double)b and pushes a VAL_FLOAT.
  * - Else computes a.i - b.i and pushes a VAL_INT.
  *
@@ -33,26 +33,22 @@
  */
 
 case OP_SUB: {
-  Value b = pop_value(vm);
-  Value a = pop_value(vm);
-  if ((a.type == VAL_INT || a.type == VAL_FLOAT) && (b.type == VAL_INT || b.type == VAL_FLOAT)) {
-    if (a.type == VAL_FLOAT || b.type == VAL_FLOAT) {
-      double da = (a.type == VAL_FLOAT) ? a.d : (double)a.i;
-      double db = (b.type == VAL_FLOAT) ? b.d : (double)b.i;
-      Value res = make_float(da - db);
-      free_value(a);
-      free_value(b);
-      push_value(vm, res);
+  Value *na = vm_num_operands(vm);
+  if (na) {
+    /* numeric fast path: compute in place on the stack */
+    if (na[0].type == VAL_INT && na[1].type == VAL_INT) {
+      na[0].i -= na[1].i;
     } else {
-      Value res = make_int(a.i - b.i);
-      free_value(a);
-      free_value(b);
-      push_value(vm, res);
+      na[0].d = vm_num_as_double(&na[0]) - vm_num_as_double(&na[1]);
+      na[0].type = VAL_FLOAT;
     }
-  } else {
-    fprintf(stderr, "Runtime type error: SUB expects numbers, got %s and %s\n",
-            value_type_name(a.type), value_type_name(b.type));
-    exit(1);
+    vm->sp--;
+    break;
   }
+  Value b = pop_value(vm);
+  Value a = pop_value(vm);
+  fprintf(stderr, "Runtime type error: SUB expects numbers, got %s and %s\n",
+          value_type_name(a.type), value_type_name(b.type));
+  exit(1);
   break;
 }
@@ -18,6 +18,7 @@
  * - Pops the index/key and container from the stack.
  * - For arrays, retrieves the element at the specified index.
  * - For maps, retrieves the value associated with the specified key.
+ * - For sets, retrieves the element at the specified insertion position.
  * - Pushes the retrieved value onto the stack.
  *
  * Error Handling:
@@ -51,17 +52,28 @@ case OP_INDEX_GET: {
     free_value(idx);
     push_value(vm, elem);
   } else if (container.type == VAL_MAP) {
-    if (idx.type != VAL_STRING) {
-      fprintf(stderr, "INDEX_GET key must be string for map\n");
+    if (idx.type != VAL_STRING && idx.type != VAL_INT && idx.type != VAL_FLOAT && idx.type != VAL_BOOL) {
+      fprintf(stderr, "INDEX_GET key must be string, number or boolean for map\n");
       exit(1);
     }
     Value out;
-    if (!map_get_copy(&container, idx.s ? idx.s : "", &out)) {
+    if (!map_get_key(&container, &idx, &out)) {
       out = make_nil();
     }
     free_value(container);
     free_value(idx);
     push_value(vm, out);
+  } else if (container.type == VAL_SET) {
+    /* sets are read by position (insertion order), which is what for-in uses */
+    const Value *e = idx.type == VAL_INT ? map_peek_key(&container, (int)idx.i) : NULL;
+    if (!e) {
+      fprintf(stderr, "Runtime error: set index out of range\n");
+      exit(1);
+    }
+    Value elem = copy_value(e);
+    free_value(container);
+    free_value(idx);
+    push_value(vm, elem);
   } else {
     fprintf(stderr, "Runtime type error: INDEX_GET expects array or map (got container=%s, index=%s)\n",
             value_type_name(container.type), value_type_name(idx.type));
@@ -49,11 +49,11 @@ case OP_INDEX_SET: {
     free_value(container);
     free_value(idx);
   } else if (container.type == VAL_MAP) {
-    if (idx.type != VAL_STRING) {
-      fprintf(stderr, "INDEX_SET key must be string for map\n");
+    if (idx.type != VAL_STRING && idx.type != VAL_INT && idx.type != VAL_FLOAT && idx.type != VAL_BOOL) {
+      fprintf(stderr, "INDEX_SET key must be string, number or boolean for map\n");
       exit(1);
     }
-    if (!map_set(&container, idx.s ? idx.s : "", v)) {
+    if (!map_set_key(&container, &idx, v)) {
       fprintf(stderr, "Runtime error: map set failed\n");
       exit(1);
     }
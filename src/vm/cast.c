@@ -65,6 +65,8 @@ case OP_CAST: {
   } else if (strcmp(target, "array") == 0) {
     if (v.type == VAL_ARRAY) {
       out = copy_value(&v);
+    } else if (v.type == VAL_SET) {
+      out = map_keys_array(&v);
     } else {
       Value tmp = deep_copy_value(&v);
       out = make_array_from_values(&tmp, 1);
@@ -76,6 +78,15 @@ case OP_CAST: {
     } else {
       out = make_map_empty();
     }
+  } else if (strcmp(target, "set") == 0) {
+    if (v.type == VAL_SET) {
+      out = copy_value(&v);
+    } else if (v.type == VAL_ARRAY) {
+      out = set_from_values(&v);
+    } else {
+      out = make_set_empty();
+      set_add(&out, &v);
+    }
   } else if (strcmp(target, "nil") == 0) {
     out = make_nil();
   } else if (strcmp(target, "function") == 0) {
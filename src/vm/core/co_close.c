@@ -0,0 +1,36 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file co_close.c
+ * @brief Implements OP_CO_CLOSE to discard a suspended coroutine.
+ *
+ * Behavior:
+ * - Pops a coroutine id.
+ * - Frees a suspended coroutine with its saved frames and operands and pushes 1.
+ * - Pushes 0 if the coroutine is dead/unknown or currently active (running or
+ *   waiting on a coroutine it resumed).
+ *
+ * Finished coroutines release their memory automatically; co_close is only
+ * needed for coroutines that are abandoned before they return.
+ */
+
+case OP_CO_CLOSE: {
+  Value idv = pop_value(vm);
+  int64_t id = (idv.type == VAL_INT) ? idv.i : 0;
+  free_value(idv);
+  Coroutine *co = vm_co_get(vm, id);
+  int ok = 0;
+  if (co && co->status == CO_SUSPENDED) {
+    vm_co_destroy(vm, id);
+    ok = 1;
+  }
+  push_value(vm, make_int(ok));
+  break;
+}
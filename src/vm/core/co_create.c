@@ -0,0 +1,53 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file co_create.c
+ * @brief Implements OP_CO_CREATE to wrap a function in a new coroutine.
+ *
+ * Behavior:
+ * - Pops the function and, if operand == 1, one argument or an array of arguments
+ *   (same convention as thread_spawn).
+ * - Creates a suspended coroutine; the function starts on the first co_resume.
+ * - Pushes the coroutine id (int > 0).
+ *
+ * Error Handling:
+ * - Exits with an error if the first operand is not a function.
+ */
+
+case OP_CO_CREATE: {
+  Value argv = make_nil();
+  if (inst.operand == 1) argv = pop_value(vm);
+  Value fnv = pop_value(vm);
+  if (fnv.type != VAL_FUNCTION || !fnv.fn) {
+    fprintf(stderr, "Runtime type error: co_create expects a function, got %s\n", value_type_name(fnv.type));
+    exit(1);
+  }
+  int argc = 0;
+  Value *args = NULL;
+  if (argv.type == VAL_ARRAY) {
+    argc = array_length(&argv);
+    if (argc > 0) args = (Value *)malloc(sizeof(Value) * (size_t)argc);
+    for (int i = 0; i < argc; ++i) {
+      if (!array_get_copy(&argv, i, &args[i])) args[i] = make_nil();
+    }
+  } else if (inst.operand == 1 && argv.type != VAL_NIL) {
+    args = (Value *)malloc(sizeof(Value));
+    args[0] = copy_value(&argv);
+    argc = 1;
+  }
+  free_value(argv);
+  int64_t id = vm_co_new(vm, fnv.fn, args, argc);
+  if (!id) {
+    fprintf(stderr, "Runtime error: out of memory creating coroutine\n");
+    exit(1);
+  }
+  push_value(vm, make_int(id));
+  break;
+}
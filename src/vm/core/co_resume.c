@@ -0,0 +1,44 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file co_resume.c
+ * @brief Implements OP_CO_RESUME to run a coroutine until it yields or returns.
+ *
+ * Behavior:
+ * - Pops an optional value (operand == 1) and the coroutine id.
+ * - Moves the coroutine's saved frames and operands back onto the VM stacks and
+ *   continues it; the value becomes the result of its pending yield (it is
+ *   ignored on the first resume, which calls the function).
+ * - When the coroutine yields or returns, the yielded/returned value is pushed
+ *   as the result of co_resume.
+ *
+ * Error Handling:
+ * - Raises a runtime error (catchable) if the coroutine is dead or already running.
+ *
+ * Example:
+ * - Stack before: [co, 5]
+ * - Stack after (once the coroutine yields x): [x]
+ */
+
+case OP_CO_RESUME: {
+  Value v = make_nil();
+  if (inst.operand == 1) v = pop_value(vm);
+  Value idv = pop_value(vm);
+  int64_t id = (idv.type == VAL_INT) ? idv.i : 0;
+  free_value(idv);
+  Coroutine *co = vm_co_get(vm, id);
+  if (!co || co->status != CO_SUSPENDED) {
+    free_value(v);
+    vm_raise_error(vm, co ? "cannot resume a running coroutine" : "cannot resume a dead coroutine");
+    break;
+  }
+  vm_co_resume(vm, id, co, v);
+  break;
+}
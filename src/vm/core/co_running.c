@@ -0,0 +1,21 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file co_running.c
+ * @brief Implements OP_CO_RUNNING to push the id of the running coroutine.
+ *
+ * Stack before: []
+ * Stack after: [int id] (0 in the main program)
+ */
+
+case OP_CO_RUNNING: {
+  push_value(vm, make_int(vm->co_current));
+  break;
+}
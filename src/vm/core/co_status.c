@@ -0,0 +1,43 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file co_status.c
+ * @brief Implements OP_CO_STATUS to report the state of a coroutine.
+ *
+ * Behavior:
+ * - Pops a coroutine id.
+ * - Pushes "suspended" (created or yielded), "running" (the current coroutine),
+ *   "normal" (it resumed another coroutine) or "dead" (finished, closed or
+ *   unknown id).
+ */
+
+case OP_CO_STATUS: {
+  Value idv = pop_value(vm);
+  Coroutine *co = (idv.type == VAL_INT) ? vm_co_get(vm, idv.i) : NULL;
+  free_value(idv);
+  const char *st = "dead";
+  if (co) {
+    switch (co->status) {
+    case CO_SUSPENDED:
+      st = "suspended";
+      break;
+    case CO_RUNNING:
+      st = "running";
+      break;
+    case CO_NORMAL:
+      st = "normal";
+      break;
+    default:
+      break;
+    }
+  }
+  push_value(vm, make_string(st));
+  break;
+}
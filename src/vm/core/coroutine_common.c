@@ -0,0 +1,262 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file coroutine_common.c
+ * @brief Coroutine table and stack switching shared by the OP_CO_* / OP_YIELD handlers.
+ *
+ * A running coroutine executes on the VM's own frame and operand stacks, on top
+ * of the frames of whoever resumed it. Yield moves that segment (frames and
+ * operand values above base_fp/base_sp) into the Coroutine's buffers and
+ * returns control to the resumer; resume moves it back. Frames are swapped
+ * rather than copied, so the locals buffers cached in the VM's frame slots are
+ * reused and a switch does not allocate in the steady state.
+ *
+ * Coroutines are referenced by int ids: the low 32 bits are the table slot + 1,
+ * the high 32 bits the slot's generation. A finished or closed coroutine frees
+ * its slot and bumps the generation, so old ids report "dead" instead of
+ * aliasing a newer coroutine.
+ *
+ * Included into vm.c after the frame/stack helpers.
+ */
+
+/**
+ * @brief Look up a coroutine by id.
+ * @return The coroutine, or NULL if the id is unknown, finished or closed.
+ */
+static Coroutine *vm_co_get(VM *vm, int64_t id) {
+  int slot = (int)(id & 0xffffffff) - 1;
+  if (slot < 0 || slot >= vm->co_slot_count) return NULL;
+  CoSlot *s = &vm->co_slots[slot];
+  if (!s->co || s->gen != (uint32_t)(id >> 32)) return NULL;
+  return s->co;
+}
+
+/**
+ * @brief Create a suspended coroutine that will call fn(args...) on first resume.
+ *
+ * Takes ownership of args (argc Values, malloc'ed array, may be NULL).
+ *
+ * @return Coroutine id (> 0), or 0 if memory is exhausted.
+ */
+static int64_t vm_co_new(VM *vm, Bytecode *fn, Value *args, int argc) {
+  Coroutine *co = (Coroutine *)calloc(1, sizeof(Coroutine));
+  if (!co) return 0;
+  int slot = vm->co_free;
+  if (slot >= 0) {
+    vm->co_free = vm->co_slots[slot].next_free;
+  } else {
+    if (vm->co_slot_count == vm->co_slot_cap) {
+      int ncap = vm->co_slot_cap ? vm->co_slot_cap * 2 : 16;
+      CoSlot *ns = (CoSlot *)realloc(vm->co_slots, sizeof(CoSlot) * (size_t)ncap);
+      if (!ns) {
+        free(co);
+        return 0;
+      }
+      vm->co_slots = ns;
+      vm->co_slot_cap = ncap;
+    }
+    slot = vm->co_slot_count++;
+    vm->co_slots[slot].gen = 0;
+  }
+  co->fn = fn;
+  co->args = args;
+  co->argc = argc;
+  co->status = CO_SUSPENDED;
+  vm->co_slots[slot].co = co;
+  vm->co_slots[slot].next_free = -1;
+  return ((int64_t)vm->co_slots[slot].gen << 32) | (int64_t)(slot + 1);
+}
+
+/**
+ * @brief Free a coroutine with everything it still owns and release its slot.
+ *
+ * Must not be called for a coroutine whose frames are on the VM stacks
+ * (status CO_RUNNING/CO_NORMAL) unless those frames are already gone.
+ */
+static void vm_co_destroy(VM *vm, int64_t id) {
+  Coroutine *co = vm_co_get(vm, id);
+  if (!co) return;
+  for (int i = 0; i < co->argc; ++i)
+    free_value(co->args[i]);
+  free(co->args);
+  for (int i = 0; i < co->frames_cap; ++i) {
+    Frame *fr = &co->frames[i];
+    if (i < co->nframes) {
+      for (int j = 0; j < fr->nlocals; ++j)
+        free_value(fr->locals[j]);
+    }
+    free(fr->locals);
+  }
+  free(co->frames);
+  for (int i = 0; i < co->nstack; ++i)
+    free_value(co->stack[i]);
+  free(co->stack);
+  free(co);
+
+  int slot = (int)(id & 0xffffffff) - 1;
+  vm->co_slots[slot].co = NULL;
+  vm->co_slots[slot].gen++;
+  vm->co_slots[slot].next_free = vm->co_free;
+  vm->co_free = slot;
+}
+
+/** Free every coroutine and the slot table (used by vm_reset/vm_free). */
+static void vm_co_free_all(VM *vm) {
+  for (int i = 0; i < vm->co_slot_count; ++i) {
+    if (vm->co_slots[i].co) vm_co_destroy(vm, ((int64_t)vm->co_slots[i].gen << 32) | (int64_t)(i + 1));
+  }
+  free(vm->co_slots);
+  vm->co_slots = NULL;
+  vm->co_slot_count = 0;
+  vm->co_slot_cap = 0;
+  vm->co_free = -1;
+  vm->co_current = 0;
+}
+
+/**
+ * @brief Drop the chain of running coroutines after their frames were discarded.
+ *
+ * An unhandled error or halt inside a coroutine stops the VM without unwinding
+ * it; the next vm_run starts from a clean state.
+ */
+static void vm_co_abandon_running(VM *vm) {
+  while (vm->co_current) {
+    int64_t id = vm->co_current;
+    Coroutine *co = vm_co_get(vm, id);
+    vm->co_current = co ? co->resumer : 0;
+    if (co) {
+      co->nframes = 0;
+      co->nstack = 0;
+      vm_co_destroy(vm, id);
+    }
+  }
+}
+
+/** Make the resumer of the current coroutine the running one again. */
+static void vm_co_return_to_resumer(VM *vm, Coroutine *co) {
+  vm->co_current = co->resumer;
+  Coroutine *r = co->resumer ? vm_co_get(vm, co->resumer) : NULL;
+  if (r) r->status = CO_RUNNING;
+}
+
+/**
+ * @brief Transfer control into a suspended coroutine.
+ *
+ * The first resume calls the entry function with the creation arguments and
+ * drops v; later resumes restore the saved frames and operands and push v as
+ * the result of the pending yield. Takes ownership of v.
+ */
+static void vm_co_resume(VM *vm, int64_t id, Coroutine *co, Value v) {
+  Coroutine *cur = vm->co_current ? vm_co_get(vm, vm->co_current) : NULL;
+  if (cur) cur->status = CO_NORMAL;
+  co->resumer = vm->co_current;
+  co->base_fp = vm->fp;
+  co->base_sp = vm->sp;
+  co->status = CO_RUNNING;
+  vm->co_current = id;
+
+  if (!co->started) {
+    co->started = 1;
+    free_value(v);
+    vm_push_frame(vm, co->fn, co->argc, co->args); /* moves the args */
+    free(co->args);
+    co->args = NULL;
+    co->argc = 0;
+    return;
+  }
+
+  if (vm->fp + 1 + co->nframes > vm->frames_cap) vm_grow_frames(vm, vm->fp + 1 + co->nframes);
+  for (int k = 0; k < co->nframes; ++k) {
+    Frame tmp = vm->frames[vm->fp + 1 + k];
+    vm->frames[vm->fp + 1 + k] = co->frames[k];
+    co->frames[k] = tmp; /* keep the slot's idle locals buffer for the next yield */
+  }
+  vm->fp += co->nframes;
+  co->nframes = 0;
+  if (vm->profile) vm_profile_resume(vm, co->base_fp);
+
+  if (vm->sp + 2 + co->nstack > vm->stack_cap) vm_grow_stack(vm, vm->sp + 2 + co->nstack);
+  if (co->nstack > 0) memcpy(&vm->stack[vm->sp + 1], co->stack, sizeof(Value) * (size_t)co->nstack);
+  vm->sp += co->nstack;
+  co->nstack = 0;
+  push_value(vm, v);
+}
+
+/**
+ * @brief Suspend the running coroutine and hand v to its resumer.
+ *
+ * Takes ownership of v. Raises a runtime error outside of a coroutine.
+ */
+static void vm_co_yield(VM *vm, Value v) {
+  Coroutine *co = vm->co_current ? vm_co_get(vm, vm->co_current) : NULL;
+  if (!co) {
+    free_value(v);
+    vm_raise_error(vm, "yield outside of a coroutine");
+    return;
+  }
+  if (vm->profile) vm_profile_suspend(vm, co->base_fp);
+  int n = vm->fp - co->base_fp;
+  if (n > co->frames_cap) {
+    Frame *nf = (Frame *)realloc(co->frames, sizeof(Frame) * (size_t)n);
+    if (!nf) {
+      fprintf(stderr, "Runtime error: out of memory suspending coroutine\n");
+      exit(1);
+    }
+    memset(nf + co->frames_cap, 0, sizeof(Frame) * (size_t)(n - co->frames_cap));
+    co->frames = nf;
+    co->frames_cap = n;
+  }
+  for (int k = 0; k < n; ++k) {
+    Frame tmp = co->frames[k];
+    co->frames[k] = vm->frames[co->base_fp + 1 + k];
+    vm->frames[co->base_fp + 1 + k] = tmp;
+  }
+  co->nframes = n;
+  vm->fp = co->base_fp;
+
+  int m = vm->sp - co->base_sp;
+  if (m < 0) m = 0;
+  if (m > co->stack_cap) {
+    Value *ns = (Value *)realloc(co->stack, sizeof(Value) * (size_t)m);
+    if (!ns) {
+      fprintf(stderr, "Runtime error: out of memory suspending coroutine\n");
+      exit(1);
+    }
+    co->stack = ns;
+    co->stack_cap = m;
+  }
+  if (m > 0) memcpy(co->stack, &vm->stack[co->base_sp + 1], sizeof(Value) * (size_t)m);
+  co->nstack = m;
+  vm->sp = co->base_sp;
+
+  co->status = CO_SUSPENDED;
+  vm_co_return_to_resumer(vm, co);
+  push_value(vm, v);
+}
+
+/**
+ * @brief Called by vm_pop_frame: the running coroutine's entry frame returned.
+ *
+ * The coroutine becomes dead and is freed; its return value (pushed by the
+ * caller of vm_pop_frame) becomes the result of co_resume.
+ */
+static void vm_co_finish(VM *vm) {
+  int64_t id = vm->co_current;
+  Coroutine *co = vm_co_get(vm, id);
+  if (!co) {
+    vm->co_current = 0;
+    return;
+  }
+  co->status = CO_DEAD;
+  co->nframes = 0;
+  co->nstack = 0;
+  vm_co_return_to_resumer(vm, co);
+  vm_co_destroy(vm, id);
+}
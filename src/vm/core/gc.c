@@ -0,0 +1,24 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file gc.c
+ * @brief Implements OP_GC (gc()).
+ *
+ * Behavior:
+ * - Runs a cycle collection now (see src/gc.h) instead of waiting for the
+ *   allocation threshold.
+ * - Pushes the number of arrays, maps and sets it freed, or -1 if the
+ *   collection ran out of memory and was abandoned (nothing is freed then).
+ */
+
+case OP_GC: {
+  push_value(vm, make_int(gc_collect()));
+  break;
+}
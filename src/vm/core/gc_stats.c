@@ -0,0 +1,37 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file gc_stats.c
+ * @brief Implements OP_GC_STATS (gc_stats()).
+ *
+ * Behavior:
+ * - Pushes a map with the cycle collector statistics of the running thread:
+ *   collections, collected (containers freed), scanned (candidate roots
+ *   examined), aborted (collections abandoned for lack of memory), roots
+ *   (candidates buffered now), threshold (container allocations between
+ *   automatic collections), last_pause_ms, max_pause_ms and total_pause_ms.
+ */
+
+case OP_GC_STATS: {
+  GcStats st;
+  gc_get_stats(&st);
+  Value m = make_map_empty();
+  map_set(&m, "collections", make_int(st.collections));
+  map_set(&m, "collected", make_int(st.collected));
+  map_set(&m, "scanned", make_int(st.scanned));
+  map_set(&m, "aborted", make_int(st.aborted));
+  map_set(&m, "roots", make_int(st.roots));
+  map_set(&m, "threshold", make_int(st.threshold));
+  map_set(&m, "last_pause_ms", make_float(st.last_pause_ms));
+  map_set(&m, "max_pause_ms", make_float(st.max_pause_ms));
+  map_set(&m, "total_pause_ms", make_float(st.total_pause_ms));
+  push_value(vm, m);
+  break;
+}
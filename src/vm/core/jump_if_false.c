@@ -18,6 +18,7 @@
  * - Pops condition value from stack
  * - Jumps to operand IP if falsey
  * - Continues normally if truthy
+ * - Int/bool conditions are tested in place without free_value
  *
  * Used for:
  * - If statements
@@ -26,6 +27,11 @@
  */
 
 case OP_JUMP_IF_FALSE: {
+  if (vm->sp >= 0 && (vm->stack[vm->sp].type == VAL_INT || vm->stack[vm->sp].type == VAL_BOOL)) {
+    /* fast path for comparison results: nothing to free */
+    if (vm->stack[vm->sp--].i == 0) f->ip = inst.operand;
+    break;
+  }
   Value cond = pop_value(vm);
   int truthy = value_is_truthy(&cond);
   free_value(cond);
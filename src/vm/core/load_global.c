@@ -19,7 +19,8 @@
  * - Pushes the value onto the stack.
  *
  * Error Handling:
- * - Exits with an error if the index is out of bounds.
+ * - Grows the global table on demand; exits with an error if the index is
+ *   negative or exceeds the VM global limit.
  *
  * Example:
  * - Bytecode: OP_LOAD_GLOBAL 0
@@ -29,10 +30,11 @@
 
 case OP_LOAD_GLOBAL: {
   int idx = inst.operand;
-  if (idx < 0 || idx >= MAX_GLOBALS) {
+  if (idx < 0) {
     fprintf(stderr, "Runtime error: global index out of range\n");
     exit(1);
   }
+  if (idx >= vm->globals_cap) vm_grow_globals(vm, idx);
 #ifdef FUN_DEBUG
   fprintf(stderr, "DEBUG LOAD_GLOBAL[%d]: type=%d\n", idx, vm->globals[idx].type);
 #endif
@@ -0,0 +1,43 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file mem_stats.c
+ * @brief Implements OP_MEM_STATS (mem_stats()).
+ *
+ * Behavior:
+ * - Pushes a map with the allocation statistics of the whole process (all
+ *   threads, see pool.h): arrays, maps, sets and strings (live objects of
+ *   each kind), allocated (objects of all four kinds allocated so far),
+ *   pool_bytes (bytes handed out from the pools and not freed), slab_bytes
+ *   (memory reserved by the pools), slabs, large (live allocations too big
+ *   for the pools) and threads (thread caches).
+ * - The map itself is counted: it is allocated before the counters are read.
+ */
+
+case OP_MEM_STATS: {
+  Value m = make_map_empty();
+  PoolStats st;
+  pool_get_stats(&st);
+  int64_t allocated = 0;
+  for (int k = 0; k < POOL_KINDS; ++k)
+    allocated += st.total[k];
+  map_set(&m, "arrays", make_int(st.live[POOL_ARRAY]));
+  map_set(&m, "maps", make_int(st.live[POOL_MAP]));
+  map_set(&m, "sets", make_int(st.live[POOL_SET]));
+  map_set(&m, "strings", make_int(st.live[POOL_STRING]));
+  map_set(&m, "allocated", make_int(allocated));
+  map_set(&m, "pool_bytes", make_int(st.used_bytes));
+  map_set(&m, "slab_bytes", make_int(st.slab_bytes));
+  map_set(&m, "slabs", make_int(st.slabs));
+  map_set(&m, "large", make_int(st.large));
+  map_set(&m, "threads", make_int(st.threads));
+  push_value(vm, m);
+  break;
+}
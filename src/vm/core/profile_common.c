@@ -0,0 +1,451 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file profile_common.c
+ * @brief Sampling and instrumenting profiler behind fun --profile.
+ *
+ * Included into vm.c. While vm->profile is set, vm_push_frame(),
+ * vm_pop_frame() and the coroutine switches call the hooks below:
+ *   - every call is counted, and the wall time between two such events is
+ *     charged to the function on top of the stack (self time);
+ *   - a function's total time runs from its outermost active call to that
+ *     call's return, so recursion is not counted twice. Suspended coroutine
+ *     frames are not on the stack and do not accumulate time.
+ *
+ * A SIGPROF interval timer (1 ms of process CPU time) only sets a flag. The
+ * next statement boundary (OP_LINE), call or return takes the sample: the
+ * line the top frame is executing and the whole stack, root first. Stacks are
+ * written in the collapsed "a;b;c count" format read by flamegraph.pl,
+ * inferno and speedscope. Windows builds have no SIGPROF and report only the
+ * instrumented numbers.
+ */
+
+#include <signal.h>
+#ifndef _WIN32
+#include <sys/time.h>
+#endif
+
+#define PROF_INTERVAL_US 1000 /* sampling period in CPU time */
+#define PROF_TOP 20           /* rows per report table */
+
+typedef struct {
+  const Bytecode *fn; /* key, NULL for an empty slot */
+  char *name;         /* fn->name with ';' replaced, for stack keys */
+  char *file;         /* source of the first statement */
+  int line;
+  int64_t calls;
+  int64_t total_ns;   /* inclusive */
+  int64_t self_ns;    /* exclusive */
+  int64_t samples;    /* samples with fn on top of the stack */
+  int active;         /* calls of fn currently on the stack */
+} ProfFunc;
+
+typedef struct {
+  char *key; /* NULL for an empty slot */
+  int64_t count;
+} ProfCount;
+
+/* String -> count hash table (open addressing, cap a power of two) */
+typedef struct {
+  ProfCount *items;
+  int count;
+  int cap;
+} ProfTable;
+
+typedef struct VmProfile VmProfile;
+
+struct VmProfile {
+  ProfFunc *funcs; /* Bytecode * -> ProfFunc hash table */
+  int nfuncs;
+  int funcs_cap;
+  ProfTable lines;  /* "file:line" -> samples */
+  ProfTable stacks; /* "root;...;top" -> samples */
+  int64_t start_ns;
+  int64_t last_ns; /* last event, for self time */
+  int64_t samples;
+  int fp;          /* profiled frames, mirrors vm->fp after each hook */
+  int line;        /* statement running in the top frame, 0 = derive from ip */
+  char *buf;       /* scratch for sample keys */
+  size_t buf_cap;
+  char *folded_path; /* collapsed stacks output, NULL for none */
+};
+
+static volatile sig_atomic_t g_prof_tick = 0;
+
+static size_t vm_profile_hash(const char *s) {
+  uint64_t h = 1469598103934665603ULL; /* FNV-1a */
+  for (const unsigned char *c = (const unsigned char *)s; *c; ++c)
+    h = (h ^ *c) * 1099511628211ULL;
+  return (size_t)(h ^ (h >> 32));
+}
+
+static int vm_ip_to_line(const Bytecode *bc, int ip);
+
+static int64_t vm_profile_now(void) {
+#if defined(CLOCK_MONOTONIC) && !defined(_WIN32)
+  struct timespec ts;
+  if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+  return (int64_t)clock() * (1000000000 / CLOCKS_PER_SEC);
+}
+
+#ifndef _WIN32
+static void vm_profile_on_sigprof(int sig) {
+  (void)sig;
+  g_prof_tick = 1;
+}
+#endif
+
+static void vm_profile_timer(int on) {
+#ifndef _WIN32
+  struct itimerval it;
+  memset(&it, 0, sizeof(it));
+  if (on) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = vm_profile_on_sigprof;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGPROF, &sa, NULL);
+    it.it_interval.tv_usec = PROF_INTERVAL_US;
+    it.it_value.tv_usec = PROF_INTERVAL_US;
+  }
+  setitimer(ITIMER_PROF, &it, NULL);
+#else
+  (void)on;
+#endif
+}
+
+/* Map an OP_LINE operand of fn to the real (possibly included) file and line */
+static void vm_profile_where(VM *vm, const Bytecode *fn, int line, const char **file, int *out) {
+  const LineMap *lm = fn ? fn->line_map : NULL;
+  if (!lm && vm->frames && vm->frames[0].fn) lm = vm->frames[0].fn->line_map;
+  *file = fn && fn->source_file ? fn->source_file : "<unknown>";
+  *out = line;
+  const char *mapped = NULL;
+  int mline = line;
+  if (line_map_lookup(lm, line, &mapped, &mline)) {
+    *file = mapped;
+    *out = mline;
+  }
+}
+
+static int vm_profile_grow_funcs(VmProfile *p) {
+  int ncap = p->funcs_cap ? p->funcs_cap * 2 : 64;
+  ProfFunc *nf = (ProfFunc *)calloc((size_t)ncap, sizeof(ProfFunc));
+  if (!nf) return 0;
+  for (int i = 0; i < p->funcs_cap; ++i) {
+    if (!p->funcs[i].fn) continue;
+    size_t j = ((uintptr_t)p->funcs[i].fn >> 4) * 2654435761u & (size_t)(ncap - 1);
+    while (nf[j].fn)
+      j = (j + 1) & (size_t)(ncap - 1);
+    nf[j] = p->funcs[i];
+  }
+  free(p->funcs);
+  p->funcs = nf;
+  p->funcs_cap = ncap;
+  return 1;
+}
+
+/* Entry of fn, created on first sight; NULL when out of memory */
+static ProfFunc *vm_profile_func(VM *vm, VmProfile *p, const Bytecode *fn) {
+  if (!fn) return NULL;
+  if (p->nfuncs * 2 >= p->funcs_cap && !vm_profile_grow_funcs(p) && p->nfuncs + 1 >= p->funcs_cap) return NULL;
+  size_t mask = (size_t)(p->funcs_cap - 1);
+  size_t i = ((uintptr_t)fn >> 4) * 2654435761u & mask;
+  while (p->funcs[i].fn && p->funcs[i].fn != fn)
+    i = (i + 1) & mask;
+  ProfFunc *e = &p->funcs[i];
+  if (e->fn) return e;
+
+  int line = 0;
+  for (int k = 0; k < fn->instr_count && !line; ++k)
+    if (fn->instructions[k].op == OP_LINE) line = fn->instructions[k].operand;
+  const char *file;
+  vm_profile_where(vm, fn, line, &file, &line);
+  char *name = strdup(fn->name ? fn->name : "<anon>");
+  char *fdup = strdup(file);
+  if (!name || !fdup) {
+    free(name);
+    free(fdup);
+    return NULL;
+  }
+  for (char *c = name; *c; ++c)
+    if (*c == ';') *c = '_';
+  e->fn = fn;
+  e->name = name;
+  e->file = fdup;
+  e->line = line;
+  p->nfuncs++;
+  return e;
+}
+
+static void vm_profile_table_free(ProfTable *t) {
+  for (int i = 0; i < t->cap; ++i)
+    free(t->items[i].key);
+  free(t->items);
+  t->items = NULL;
+  t->count = t->cap = 0;
+}
+
+/* Add one to the count of key */
+static void vm_profile_count(ProfTable *t, const char *key) {
+  if (t->count * 2 >= t->cap) {
+    int ncap = t->cap ? t->cap * 2 : 256;
+    ProfCount *ni = (ProfCount *)calloc((size_t)ncap, sizeof(ProfCount));
+    if (!ni) {
+      if (t->count + 1 >= t->cap) return;
+    } else {
+      for (int i = 0; i < t->cap; ++i) {
+        if (!t->items[i].key) continue;
+        size_t j = vm_profile_hash(t->items[i].key) & (size_t)(ncap - 1);
+        while (ni[j].key)
+          j = (j + 1) & (size_t)(ncap - 1);
+        ni[j] = t->items[i];
+      }
+      free(t->items);
+      t->items = ni;
+      t->cap = ncap;
+    }
+  }
+  size_t mask = (size_t)(t->cap - 1);
+  size_t i = vm_profile_hash(key) & mask;
+  while (t->items[i].key && strcmp(t->items[i].key, key) != 0)
+    i = (i + 1) & mask;
+  if (!t->items[i].key) {
+    if (!(t->items[i].key = strdup(key))) return;
+    t->count++;
+  }
+  t->items[i].count++;
+}
+
+/* Make room for len more bytes after used in the key buffer */
+static int vm_profile_reserve(VmProfile *p, size_t used, size_t len) {
+  if (used + len + 1 <= p->buf_cap) return 1;
+  size_t ncap = p->buf_cap ? p->buf_cap : 256;
+  while (ncap < used + len + 1)
+    ncap *= 2;
+  char *nb = (char *)realloc(p->buf, ncap);
+  if (!nb) return 0;
+  p->buf = nb;
+  p->buf_cap = ncap;
+  return 1;
+}
+
+/* Record a pending sample for frames 0..top (called on the profiled VM only) */
+static void vm_profile_sample(VM *vm, int top) {
+  VmProfile *p = vm->profile;
+  /* worker VMs leave the tick to the profiled one */
+  if (!p) return;
+  g_prof_tick = 0;
+  if (top < 0) return;
+  p->samples++;
+
+  Frame *f = &vm->frames[top];
+  ProfFunc *e = vm_profile_func(vm, p, f->fn);
+  if (e) e->samples++;
+  int line = p->line > 0 ? p->line : vm_ip_to_line(f->fn, f->ip - 1);
+  const char *file;
+  vm_profile_where(vm, f->fn, line, &file, &line);
+  if (vm_profile_reserve(p, 0, strlen(file) + 24)) {
+    snprintf(p->buf, p->buf_cap, "%s:%d", file, line);
+    vm_profile_count(&p->lines, p->buf);
+  }
+
+  size_t used = 0;
+  for (int i = 0; i <= top; ++i) {
+    ProfFunc *fe = vm_profile_func(vm, p, vm->frames[i].fn);
+    const char *name = fe ? fe->name : "<anon>";
+    size_t len = strlen(name);
+    if (!vm_profile_reserve(p, used, len + 1)) return;
+    if (i > 0) p->buf[used++] = ';';
+    memcpy(p->buf + used, name, len);
+    used += len;
+  }
+  p->buf[used] = '\0';
+  vm_profile_count(&p->stacks, p->buf);
+}
+
+/* Charge the time since the last event to frames[top]; returns now */
+static int64_t vm_profile_charge(VM *vm, VmProfile *p, int top) {
+  int64_t now = vm_profile_now();
+  if (top >= 0) {
+    ProfFunc *e = vm_profile_func(vm, p, vm->frames[top].fn);
+    if (e) e->self_ns += now - p->last_ns;
+  }
+  p->last_ns = now;
+  return now;
+}
+
+/* Frame f starts running: a call, or a coroutine frame put back on the stack */
+static void vm_profile_open(VM *vm, VmProfile *p, Frame *f, int64_t now) {
+  ProfFunc *e = vm_profile_func(vm, p, f->fn);
+  f->prof_start = now;
+  f->prof_outer = e && e->active++ == 0;
+}
+
+/* Frame f leaves the stack: returns, unwinds or is suspended */
+static void vm_profile_close(VM *vm, VmProfile *p, Frame *f, int64_t now) {
+  ProfFunc *e = vm_profile_func(vm, p, f->fn);
+  if (!e) return;
+  if (e->active > 0) e->active--;
+  if (f->prof_outer) e->total_ns += now - f->prof_start;
+  f->prof_outer = 0;
+}
+
+/* Line of the statement frames[fp] is in the middle of (it made a call) */
+static int vm_profile_frame_line(VM *vm, int fp) {
+  return fp >= 0 ? vm_ip_to_line(vm->frames[fp].fn, vm->frames[fp].ip - 1) : 0;
+}
+
+/* vm_push_frame() pushed vm->frames[vm->fp] */
+static void vm_profile_enter(VM *vm) {
+  VmProfile *p = vm->profile;
+  if (g_prof_tick) vm_profile_sample(vm, vm->fp - 1);
+  int64_t now = vm_profile_charge(vm, p, vm->fp - 1);
+  Frame *f = &vm->frames[vm->fp];
+  ProfFunc *e = vm_profile_func(vm, p, f->fn);
+  if (e) e->calls++;
+  vm_profile_open(vm, p, f, now);
+  p->fp = vm->fp;
+  p->line = 0;
+}
+
+/* vm_pop_frame() is about to pop vm->frames[vm->fp] */
+static void vm_profile_leave(VM *vm) {
+  VmProfile *p = vm->profile;
+  if (g_prof_tick) vm_profile_sample(vm, vm->fp);
+  int64_t now = vm_profile_charge(vm, p, vm->fp);
+  vm_profile_close(vm, p, &vm->frames[vm->fp], now);
+  p->fp = vm->fp - 1;
+  p->line = vm_profile_frame_line(vm, p->fp);
+}
+
+/* A coroutine is about to move frames base_fp+1..vm->fp off the stack */
+static void vm_profile_suspend(VM *vm, int base_fp) {
+  VmProfile *p = vm->profile;
+  if (g_prof_tick) vm_profile_sample(vm, vm->fp);
+  int64_t now = vm_profile_charge(vm, p, vm->fp);
+  for (int i = vm->fp; i > base_fp; --i)
+    vm_profile_close(vm, p, &vm->frames[i], now);
+  p->fp = base_fp;
+  p->line = vm_profile_frame_line(vm, base_fp);
+}
+
+/* A coroutine put its frames back at base_fp+1..vm->fp */
+static void vm_profile_resume(VM *vm, int base_fp) {
+  VmProfile *p = vm->profile;
+  if (g_prof_tick) vm_profile_sample(vm, base_fp);
+  int64_t now = vm_profile_charge(vm, p, base_fp);
+  for (int i = base_fp + 1; i <= vm->fp; ++i)
+    vm_profile_open(vm, p, &vm->frames[i], now);
+  p->fp = vm->fp;
+  p->line = vm_profile_frame_line(vm, vm->fp);
+}
+
+static void vm_profile_free(VM *vm) {
+  VmProfile *p = vm->profile;
+  if (!p) return;
+  vm_profile_timer(0);
+  for (int i = 0; i < p->funcs_cap; ++i) {
+    free(p->funcs[i].name);
+    free(p->funcs[i].file);
+  }
+  free(p->funcs);
+  vm_profile_table_free(&p->lines);
+  vm_profile_table_free(&p->stacks);
+  free(p->buf);
+  free(p->folded_path);
+  free(p);
+  vm->profile = NULL;
+}
+
+int vm_profile_start(VM *vm, const char *folded_path) {
+  if (vm->profile) return 1;
+  VmProfile *p = (VmProfile *)calloc(1, sizeof(VmProfile));
+  if (!p) return 0;
+  if (folded_path && !(p->folded_path = strdup(folded_path))) {
+    free(p);
+    return 0;
+  }
+  vm->profile = p;
+  p->start_ns = p->last_ns = vm_profile_now();
+  for (int i = 0; i <= vm->fp; ++i)
+    vm_profile_open(vm, p, &vm->frames[i], p->start_ns);
+  p->fp = vm->fp;
+  g_prof_tick = 0;
+  vm_profile_timer(1);
+  return 1;
+}
+
+static int vm_profile_by_self(const void *a, const void *b) {
+  const ProfFunc *x = *(const ProfFunc *const *)a, *y = *(const ProfFunc *const *)b;
+  if (x->self_ns != y->self_ns) return x->self_ns < y->self_ns ? 1 : -1;
+  return x->calls < y->calls ? 1 : (x->calls > y->calls ? -1 : 0);
+}
+
+static int vm_profile_by_count(const void *a, const void *b) {
+  const ProfCount *x = *(const ProfCount *const *)a, *y = *(const ProfCount *const *)b;
+  if (x->count != y->count) return x->count < y->count ? 1 : -1;
+  return strcmp(x->key, y->key);
+}
+
+void vm_profile_report(VM *vm, FILE *out) {
+  VmProfile *p = vm->profile;
+  if (!p) return;
+  vm_profile_timer(0);
+  /* frames still on the stack: the script called exit() or hit an error */
+  int64_t now = vm_profile_charge(vm, p, p->fp);
+  for (int i = p->fp; i >= 0; --i)
+    vm_profile_close(vm, p, &vm->frames[i], now);
+  p->fp = -1;
+  double total_ms = (double)(now - p->start_ns) / 1e6;
+
+  ProfFunc **funcs = (ProfFunc **)malloc(sizeof(ProfFunc *) * (size_t)(p->nfuncs + 1));
+  int n = 0;
+  for (int i = 0; funcs && i < p->funcs_cap; ++i)
+    if (p->funcs[i].fn) funcs[n++] = &p->funcs[i];
+  if (funcs) qsort(funcs, (size_t)n, sizeof(*funcs), vm_profile_by_self);
+  fprintf(out, "=== profile: %.2f ms, %lld samples, %d functions ===\n", total_ms, (long long)p->samples, n);
+  fprintf(out, "%10s %11s %11s %6s %8s  %s\n", "calls", "total ms", "self ms", "self%", "samples", "function");
+  for (int i = 0; i < n && i < PROF_TOP; ++i) {
+    ProfFunc *e = funcs[i];
+    fprintf(out, "%10lld %11.3f %11.3f %5.1f%% %8lld  %s (%s:%d)\n", (long long)e->calls, (double)e->total_ns / 1e6,
+            (double)e->self_ns / 1e6, total_ms > 0 ? (double)e->self_ns / 1e4 / total_ms : 0.0, (long long)e->samples,
+            e->name, e->file, e->line);
+  }
+  free(funcs);
+
+  if (p->samples > 0) {
+    ProfCount **lines = (ProfCount **)malloc(sizeof(ProfCount *) * (size_t)(p->lines.count + 1));
+    int nl = 0;
+    for (int i = 0; lines && i < p->lines.cap; ++i)
+      if (p->lines.items[i].key) lines[nl++] = &p->lines.items[i];
+    if (lines) qsort(lines, (size_t)nl, sizeof(*lines), vm_profile_by_count);
+    fprintf(out, "=== hot lines (samples) ===\n");
+    for (int i = 0; i < nl && i < PROF_TOP; ++i)
+      fprintf(out, "%10lld %5.1f%%  %s\n", (long long)lines[i]->count, 100.0 * (double)lines[i]->count / (double)p->samples,
+              lines[i]->key);
+    free(lines);
+  }
+
+  if (p->folded_path) {
+    FILE *fp = fopen(p->folded_path, "w");
+    if (!fp) {
+      fprintf(out, "profile: cannot write %s\n", p->folded_path);
+    } else {
+      for (int i = 0; i < p->stacks.cap; ++i)
+        if (p->stacks.items[i].key) fprintf(fp, "%s %lld\n", p->stacks.items[i].key, (long long)p->stacks.items[i].count);
+      fclose(fp);
+      fprintf(out, "collapsed stacks: %s (%d stacks)\n", p->folded_path, p->stacks.count);
+    }
+  }
+  vm_profile_free(vm);
+}
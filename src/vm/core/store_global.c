@@ -19,7 +19,8 @@
  * - Stores the value into the global variable at the specified index.
  *
  * Error Handling:
- * - Exits with an error if the index is out of bounds.
+ * - Grows the global table on demand; exits with an error if the index is
+ *   negative or exceeds the VM global limit.
  *
  * Example:
  * - Bytecode: OP_STORE_GLOBAL 0
@@ -29,10 +30,11 @@
 
 case OP_STORE_GLOBAL: {
   int idx = inst.operand;
-  if (idx < 0 || idx >= MAX_GLOBALS) {
+  if (idx < 0) {
     fprintf(stderr, "Runtime error: global index out of range\n");
     exit(1);
   }
+  if (idx >= vm->globals_cap) vm_grow_globals(vm, idx);
   Value v = pop_value(vm);
 #ifdef FUN_DEBUG
   fprintf(stderr, "DEBUG STORE_GLOBAL[%d]: new.type=%d\n", idx, v.type);
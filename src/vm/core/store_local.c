@@ -29,7 +29,7 @@
 
 case OP_STORE_LOCAL: {
   int slot = inst.operand;
-  if (slot < 0 || slot >= MAX_FRAME_LOCALS) {
+  if (slot < 0 || slot >= f->nlocals) {
     fprintf(stderr, "Runtime error: local slot out of range\n");
     exit(1);
   }
@@ -0,0 +1,30 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file yield.c
+ * @brief Implements OP_YIELD to suspend the running coroutine.
+ *
+ * Behavior:
+ * - Pops an optional value (operand == 1, else nil).
+ * - Moves the coroutine's frames and operands off the VM stacks and returns to
+ *   the resumer, whose co_resume evaluates to the value.
+ * - When the coroutine is resumed again, yield evaluates to the value passed
+ *   to that co_resume.
+ *
+ * Error Handling:
+ * - Raises a runtime error (catchable) when used outside of a coroutine.
+ */
+
+case OP_YIELD: {
+  Value v = make_nil();
+  if (inst.operand == 1) v = pop_value(vm);
+  vm_co_yield(vm, v);
+  break;
+}
@@ -0,0 +1,45 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file aes256_encrypt_hex.c
+ * @brief Implements OP_AES256_ENCRYPT_HEX (aes256_encrypt_hex(data_hex, key_hex)).
+ *
+ * Behavior:
+ * - Pops the key (64 hex digits) and the data (hex, a whole number of
+ *   16-byte blocks).
+ * - Encrypts every block with AES-256 in ECB mode and pushes the ciphertext
+ *   as lowercase hex, or "" if either argument is malformed.
+ */
+
+case OP_AES256_ENCRYPT_HEX: {
+  Value keyv = pop_value(vm);
+  Value datav = pop_value(vm);
+  Value out = make_string("");
+  if (keyv.type == VAL_STRING && datav.type == VAL_STRING && keyv.s && datav.s) {
+    size_t klen = 0, dlen = 0;
+    unsigned char *key = fun_hex_decode(keyv.s, &klen);
+    unsigned char *data = fun_hex_decode(datav.s, &dlen);
+    if (key && data && klen == 32 && dlen % 16 == 0) {
+      FunAes256 k;
+      fun_aes256_init(&k, key);
+      fun_aes256_encrypt_ecb(&k, data, data, dlen / 16);
+      free_value(out);
+      out = fun_hex_value(data, dlen);
+      memset(&k, 0, sizeof(k));
+    }
+    if (key) memset(key, 0, klen);
+    free(key);
+    free(data);
+  }
+  free_value(keyv);
+  free_value(datav);
+  push_value(vm, out);
+  break;
+}
@@ -0,0 +1,28 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file crypto_accel.c
+ * @brief Implements OP_CRYPTO_ACCEL (crypto_accel()).
+ *
+ * Pushes a map naming the kernel each accelerated algorithm uses in this
+ * process: sha1/sha256 "sha-ni" or "portable", crc32c "sse4.2" or
+ * "portable", aes "aes-ni" or "portable". FUN_CRYPTO_PORTABLE=1 in the
+ * environment selects "portable" everywhere.
+ */
+
+case OP_CRYPTO_ACCEL: {
+  Value m = make_map_empty();
+  map_set(&m, "sha1", make_string(fun_crypto_kernel("sha1")));
+  map_set(&m, "sha256", make_string(fun_crypto_kernel("sha256")));
+  map_set(&m, "crc32c", make_string(fun_crypto_kernel("crc32c")));
+  map_set(&m, "aes", make_string(fun_crypto_kernel("aes")));
+  push_value(vm, m);
+  break;
+}
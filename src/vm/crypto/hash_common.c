@@ -0,0 +1,87 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file hash_common.c
+ * @brief Hash handles and hex helpers for the OP_HASH_* / OP_AES256_* opcodes.
+ *
+ * A hash handle owns one FunHashCtx from crypto.c and lives in the g_hashes
+ * handle table (src/handles.c). Ops borrow the context for one call, so a
+ * hash_free() from another thread cannot release it under a running update.
+ * hash_final() and hash_free() release the handle; only one of them wins
+ * for a given id.
+ *
+ * Fun strings end at the first NUL byte, so binary input is passed as hex
+ * (hash_update_hex, aes256_encrypt_hex) and digests come back as lowercase
+ * hex (through the hex codec of codec.c). Data strings are hashed as their
+ * bytes (UTF-8 for non-ASCII text).
+ */
+
+#include "crypto.c"
+
+static void fun_hash_destroy(void *p) {
+  free(p);
+}
+
+static FunHandleTable g_hashes = FUN_HANDLE_TABLE_INIT(fun_hash_destroy);
+
+/** Borrow a hash by handle; NULL if unknown or finished. Pair with fun_hash_release(). */
+static FunHashCtx *fun_hash_acquire(int64_t id) {
+  return (FunHashCtx *)fun_handle_acquire(&g_hashes, id);
+}
+
+static void fun_hash_release(int64_t id) {
+  fun_handle_release(&g_hashes, id);
+}
+
+/** Release a hash (once no op is using it); returns 1/0. */
+static int fun_hash_free(int64_t id) {
+  return fun_handle_free(&g_hashes, id);
+}
+
+/** Start a hash of the named algorithm; returns handle (>0) or 0. */
+static int64_t fun_hash_new(const char *name) {
+  int alg = fun_hash_lookup(name);
+  if (alg < 0) return 0;
+  FunHashCtx *c = (FunHashCtx *)malloc(sizeof(FunHashCtx));
+  if (!c) return 0;
+  fun_hash_init(c, alg);
+  int64_t id = fun_handle_new(&g_hashes, c);
+  if (!id) free(c);
+  return id;
+}
+
+/**
+ * Decode hex digits into a malloc'd buffer (*out_len bytes). Returns NULL for
+ * an odd length, a non-hex digit or out of memory.
+ */
+static unsigned char *fun_hex_decode(const char *hex, size_t *out_len) {
+  FunCodec c;
+  fun_codec_init(&c, FUN_CODEC_HEX, 1);
+  size_t n = strlen(hex);
+  unsigned char *out = (unsigned char *)malloc(fun_codec_max_out(&c, n));
+  if (!out) return NULL;
+  ptrdiff_t r = fun_codec_update(&c, (const unsigned char *)hex, n, out);
+  if (r < 0 || fun_codec_final(&c, out + r) < 0) {
+    free(out);
+    return NULL;
+  }
+  *out_len = (size_t)r;
+  return out;
+}
+
+/** Encode len bytes as a lowercase hex Fun string. */
+static Value fun_hex_value(const unsigned char *p, size_t len) {
+  Value v = make_string_len(NULL, len * 2);
+  if (!v.s) return v;
+  FunCodec c;
+  fun_codec_init(&c, FUN_CODEC_HEX, 0);
+  fun_codec_update(&c, p, len, (unsigned char *)v.s); /* writes exactly 2 * len digits */
+  return v;
+}
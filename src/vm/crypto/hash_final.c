@@ -0,0 +1,36 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file hash_final.c
+ * @brief Implements OP_HASH_FINAL (hash_final(h)).
+ *
+ * Behavior:
+ * - Pops a hash handle, finishes the hash and frees the handle.
+ * - Pushes the digest as lowercase hex (CRCs as 8 digits, most significant
+ *   byte first), or "" if the handle is unknown or already finished.
+ */
+
+case OP_HASH_FINAL: {
+  Value hv = pop_value(vm);
+  FunHashCtx *c = hv.type == VAL_INT ? fun_hash_acquire(hv.i) : NULL;
+  Value res = make_string("");
+  /* freeing the handle while borrowed keeps c alive until the release; only
+   * the caller whose free succeeds computes the digest */
+  if (c && fun_hash_free(hv.i)) {
+    unsigned char digest[FUN_HASH_MAX_DIGEST];
+    fun_hash_final(c, digest);
+    free_value(res);
+    res = fun_hex_value(digest, fun_hash_digest_len(c->alg));
+  }
+  if (c) fun_hash_release(hv.i);
+  free_value(hv);
+  push_value(vm, res);
+  break;
+}
@@ -0,0 +1,25 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file hash_free.c
+ * @brief Implements OP_HASH_FREE (hash_free(h)).
+ *
+ * Behavior:
+ * - Pops a hash handle and frees it without computing a digest (for hashes
+ *   that are abandoned). Pushes 1, or 0 if the handle is unknown.
+ */
+
+case OP_HASH_FREE: {
+  Value hv = pop_value(vm);
+  int ok = hv.type == VAL_INT ? fun_hash_free(hv.i) : 0;
+  free_value(hv);
+  push_value(vm, make_int(ok));
+  break;
+}
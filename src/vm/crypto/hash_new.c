@@ -0,0 +1,27 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file hash_new.c
+ * @brief Implements OP_HASH_NEW (hash_new(algorithm)).
+ *
+ * Behavior:
+ * - Pops the algorithm name: "md5", "sha1", "sha256", "sha384", "sha512",
+ *   "crc32" or "crc32c".
+ * - Pushes a hash handle for hash_update()/hash_final(), or 0 for an
+ *   unknown algorithm.
+ */
+
+case OP_HASH_NEW: {
+  Value namev = pop_value(vm);
+  int64_t id = namev.type == VAL_STRING && namev.s ? fun_hash_new(namev.s) : 0;
+  free_value(namev);
+  push_value(vm, make_int(id));
+  break;
+}
@@ -0,0 +1,37 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file hash_update.c
+ * @brief Implements OP_HASH_UPDATE (hash_update(h, data)).
+ *
+ * Behavior:
+ * - Pops data (string; other values are stringified) and a hash handle.
+ * - Hashes the bytes of the string and pushes the number of bytes hashed so
+ *   far, or -1 if the handle is unknown.
+ */
+
+case OP_HASH_UPDATE: {
+  Value datav = pop_value(vm);
+  Value hv = pop_value(vm);
+  FunHashCtx *c = hv.type == VAL_INT ? fun_hash_acquire(hv.i) : NULL;
+  int64_t res = -1;
+  if (c) {
+    char *tmp = datav.type == VAL_STRING ? NULL : value_to_string_alloc(&datav);
+    const char *p = datav.type == VAL_STRING ? (datav.s ? datav.s : "") : (tmp ? tmp : "");
+    fun_hash_update(c, p, strlen(p));
+    res = (int64_t)c->total;
+    free(tmp);
+    fun_hash_release(hv.i);
+  }
+  free_value(datav);
+  free_value(hv);
+  push_value(vm, make_int(res));
+  break;
+}
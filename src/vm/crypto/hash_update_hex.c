@@ -0,0 +1,40 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file hash_update_hex.c
+ * @brief Implements OP_HASH_UPDATE_HEX (hash_update_hex(h, hex)).
+ *
+ * Behavior:
+ * - Pops a hex string and a hash handle.
+ * - Hashes the decoded bytes (which may include NUL) and pushes the number
+ *   of bytes hashed so far, or -1 if the handle is unknown or the string is
+ *   not an even number of hex digits (nothing is hashed then).
+ */
+
+case OP_HASH_UPDATE_HEX: {
+  Value hexv = pop_value(vm);
+  Value hv = pop_value(vm);
+  FunHashCtx *c = hv.type == VAL_INT ? fun_hash_acquire(hv.i) : NULL;
+  int64_t res = -1;
+  if (c && hexv.type == VAL_STRING) {
+    size_t n = 0;
+    unsigned char *bytes = fun_hex_decode(hexv.s ? hexv.s : "", &n);
+    if (bytes) {
+      fun_hash_update(c, bytes, n);
+      res = (int64_t)c->total;
+      free(bytes);
+    }
+  }
+  if (c) fun_hash_release(hv.i);
+  free_value(hexv);
+  free_value(hv);
+  push_value(vm, make_int(res));
+  break;
+}
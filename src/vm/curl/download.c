@@ -32,6 +32,8 @@
  *
  * Notes:
  * - All temporary allocations (URL, path) are freed; FILE* is closed.
+ * - The easy handle comes from the shared pool (fun_curl_acquire), so
+ *   connections, DNS lookups and TLS sessions are reused across requests.
  * - On builds without FUN_WITH_CURL, consumes two values and pushes 0.
  */
 
@@ -56,7 +58,7 @@ case OP_CURL_DOWNLOAD: {
     push_value(vm, make_int(0));
     break;
   }
-  CURL *h = curl_easy_init();
+  CURL *h = fun_curl_acquire();
   if (!h) {
     fclose(fp);
     free(url);
@@ -69,7 +71,7 @@ case OP_CURL_DOWNLOAD: {
   curl_easy_setopt(h, CURLOPT_WRITEFUNCTION, fun_curl_file_write_cb);
   curl_easy_setopt(h, CURLOPT_WRITEDATA, fp);
   CURLcode rc = curl_easy_perform(h);
-  curl_easy_cleanup(h);
+  fun_curl_release(h);
   fclose(fp);
   free(url);
   free(path);
@@ -33,6 +33,8 @@
  *
  * Notes:
  * - Uses FunCurlBuf and fun_curl_write_cb from the curl extension helpers.
+ * - The easy handle comes from the shared pool (fun_curl_acquire), so
+ *   connections, DNS lookups and TLS sessions are reused across requests.
  * - Memory allocated for temporary strings and buffers is freed before exit.
  */
 
@@ -46,7 +48,7 @@ case OP_CURL_GET: {
     break;
   }
   FunCurlBuf buf = {NULL, 0};
-  CURL *h = curl_easy_init();
+  CURL *h = fun_curl_acquire();
   if (!h) {
     free(url);
     push_value(vm, make_string(""));
@@ -57,7 +59,7 @@ case OP_CURL_GET: {
   curl_easy_setopt(h, CURLOPT_WRITEFUNCTION, fun_curl_write_cb);
   curl_easy_setopt(h, CURLOPT_WRITEDATA, &buf);
   CURLcode rc = curl_easy_perform(h);
-  curl_easy_cleanup(h);
+  fun_curl_release(h);
   free(url);
   if (rc != CURLE_OK) {
     if (buf.d) free(buf.d);
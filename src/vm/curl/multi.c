@@ -0,0 +1,97 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file multi.c
+ * @brief Fun VM opcode snippet: concurrent HTTP requests via curl_multi (OP_CURL_MULTI).
+ *
+ * Runs a batch of requests concurrently on one curl multi handle, using
+ * pooled easy handles (shared connection/DNS/TLS session caches, see
+ * extensions/curl.c).
+ *
+ * Stack behavior:
+ * - Pops: [max_parallel:int if operand == 1], requests:array
+ *   Each request is a URL string or a map {url, method, body, headers,
+ *   timeout_ms}. At most max_parallel transfers run at once (default: all).
+ * - Pushes: array of result maps in request order:
+ *   {url, status, headers, body, error, connects, time_ms}. status is 0 and
+ *   error non-empty when a request failed; headers has lower-case names.
+ *
+ * Notes:
+ * - Without FUN_WITH_CURL, pushes an empty array.
+ * - The VM blocks until the whole batch is done.
+ */
+
+case OP_CURL_MULTI: {
+  Value vmax = inst.operand == 1 ? pop_value(vm) : make_nil();
+  Value vreqs = pop_value(vm);
+#ifdef FUN_WITH_CURL
+  int n = array_length(&vreqs);
+  if (n <= 0) {
+    free_value(vmax);
+    free_value(vreqs);
+    push_value(vm, make_array_from_values(NULL, 0));
+    break;
+  }
+  int max_par = vmax.type == VAL_INT && vmax.i > 0 ? (int)vmax.i : n;
+  FunCurlReq *reqs = (FunCurlReq *)calloc((size_t)n, sizeof(FunCurlReq));
+  CURLM *mh = reqs ? curl_multi_init() : NULL;
+  if (!mh) {
+    free(reqs);
+    free_value(vmax);
+    free_value(vreqs);
+    push_value(vm, make_array_from_values(NULL, 0));
+    break;
+  }
+  int next = 0, running = 0;
+  for (;;) {
+    /* keep up to max_par transfers in flight */
+    while (next < n && running < max_par) {
+      FunCurlReq *r = &reqs[next++];
+      Value spec = array_peek_value(&vreqs, next - 1);
+      if (!fun_curl_req_setup(r, &spec) || curl_multi_add_handle(mh, r->h) != CURLM_OK) {
+        r->rc = CURLE_FAILED_INIT;
+        r->done = 1;
+        continue;
+      }
+      running++;
+    }
+    if (running == 0) break;
+    int still = 0;
+    curl_multi_perform(mh, &still);
+    CURLMsg *msg;
+    int left;
+    while ((msg = curl_multi_info_read(mh, &left)) != NULL) {
+      if (msg->msg != CURLMSG_DONE) continue;
+      FunCurlReq *r = NULL;
+      curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&r);
+      curl_multi_remove_handle(mh, msg->easy_handle);
+      if (r) {
+        r->rc = msg->data.result;
+        r->done = 1;
+      }
+      running--;
+    }
+    if (running > 0 && still > 0) curl_multi_wait(mh, NULL, 0, 100, NULL);
+  }
+  curl_multi_cleanup(mh);
+  Value out = make_array_from_values(NULL, 0);
+  for (int i = 0; i < n; ++i)
+    array_push(&out, fun_curl_req_result(&reqs[i]));
+  free(reqs);
+  free_value(vmax);
+  free_value(vreqs);
+  push_value(vm, out);
+#else
+  free_value(vmax);
+  free_value(vreqs);
+  push_value(vm, make_array_from_values(NULL, 0));
+#endif
+  break;
+}
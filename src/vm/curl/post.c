@@ -33,6 +33,8 @@
  *
  * Notes:
  * - Uses FunCurlBuf and fun_curl_write_cb from the curl extension helpers.
+ * - The easy handle comes from the shared pool (fun_curl_acquire), so
+ *   connections, DNS lookups and TLS sessions are reused across requests.
  * - All temporary allocations (URL, body, response buffer) are freed.
  */
 
@@ -51,7 +53,7 @@ case OP_CURL_POST: {
   }
   if (!body) body = strdup("");
   FunCurlBuf buf = {NULL, 0};
-  CURL *h = curl_easy_init();
+  CURL *h = fun_curl_acquire();
   if (!h) {
     free(url);
     free(body);
@@ -65,7 +67,7 @@ case OP_CURL_POST: {
   curl_easy_setopt(h, CURLOPT_WRITEFUNCTION, fun_curl_write_cb);
   curl_easy_setopt(h, CURLOPT_WRITEDATA, &buf);
   CURLcode rc = curl_easy_perform(h);
-  curl_easy_cleanup(h);
+  fun_curl_release(h);
   free(url);
   free(body);
   if (rc != CURLE_OK) {
@@ -0,0 +1,30 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file base64_decode.c
+ * @brief Implements OP_BASE64_DECODE (base64_decode(text [, as_bytes])).
+ *
+ * Behavior:
+ * - Operand 1 means an as_bytes flag was passed.
+ * - Pops base64 text in either alphabet (standard or base64url); padding
+ *   is optional and spaces, tabs and line breaks are skipped.
+ * - Pushes the decoded bytes as a string (cut at the first NUL byte) or,
+ *   if as_bytes is truthy, as an array of ints; nil for invalid input.
+ */
+
+case OP_BASE64_DECODE: {
+  Value asv = inst.operand ? pop_value(vm) : make_nil();
+  Value text = pop_value(vm);
+  Value res = fun_codec_oneshot(FUN_CODEC_BASE64, 1, &text, value_is_truthy(&asv));
+  free_value(asv);
+  free_value(text);
+  push_value(vm, res);
+  break;
+}
@@ -0,0 +1,31 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file base64_encode.c
+ * @brief Implements OP_BASE64_ENCODE (base64_encode(data [, url])).
+ *
+ * Behavior:
+ * - Operand 1 means a url flag was passed; a truthy flag selects base64url
+ *   (RFC 4648 section 5: '-' and '_', no padding).
+ * - Pops data: a string or a byte array (ints 0..255); other values are
+ *   stringified.
+ * - Pushes the base64 text, or nil for an array with other items.
+ */
+
+case OP_BASE64_ENCODE: {
+  Value urlv = inst.operand ? pop_value(vm) : make_nil();
+  Value data = pop_value(vm);
+  int fmt = value_is_truthy(&urlv) ? FUN_CODEC_BASE64URL : FUN_CODEC_BASE64;
+  Value res = fun_codec_oneshot(fmt, 0, &data, 0);
+  free_value(urlv);
+  free_value(data);
+  push_value(vm, res);
+  break;
+}
@@ -0,0 +1,26 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file codec_accel.c
+ * @brief Implements OP_CODEC_ACCEL (codec_accel()).
+ *
+ * Pushes a map naming the kernel each format uses in this process: base64
+ * and hex "ssse3" or "portable", url (also form) "sse2" or "portable".
+ * FUN_CODEC_PORTABLE=1 in the environment selects "portable" everywhere.
+ */
+
+case OP_CODEC_ACCEL: {
+  Value m = make_map_empty();
+  map_set(&m, "base64", make_string(fun_codec_kernel("base64")));
+  map_set(&m, "hex", make_string(fun_codec_kernel("hex")));
+  map_set(&m, "url", make_string(fun_codec_kernel("url")));
+  push_value(vm, m);
+  break;
+}
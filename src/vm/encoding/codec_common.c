@@ -0,0 +1,163 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file codec_common.c
+ * @brief Codec handles and value conversion for the base64/hex/url opcodes.
+ *
+ * Input is a string (its bytes up to the terminating NUL) or a byte array
+ * (ints 0..255); other values are stringified. Decoders return strings,
+ * which end at the first NUL byte, or byte arrays when asked (as_bytes, or
+ * mode "decode_bytes" for codec_new), so binary data can round-trip.
+ * Percent-decoding to a string keeps %00 as is rather than cutting the text
+ * short (e.g. "name.txt%00.jpg").
+ *
+ * A codec handle owns one FunCodec from codec.c and lives in the g_codecs
+ * handle table (src/handles.c); codec_update borrows it for the call.
+ * codec_final() and codec_free() release the handle, and only one of them
+ * succeeds for a given id.
+ */
+
+#include "codec.c"
+
+typedef struct FunCodecHandle {
+  FunCodec c;
+  int as_bytes; /* decoder output as byte arrays */
+} FunCodecHandle;
+
+static void fun_codec_destroy(void *p) {
+  free(p);
+}
+
+static FunHandleTable g_codecs = FUN_HANDLE_TABLE_INIT(fun_codec_destroy);
+
+/** Borrow a codec by handle; NULL if unknown or finished. Pair with fun_codec_release(). */
+static FunCodecHandle *fun_codec_acquire(int64_t id) {
+  return (FunCodecHandle *)fun_handle_acquire(&g_codecs, id);
+}
+
+static void fun_codec_release(int64_t id) {
+  fun_handle_release(&g_codecs, id);
+}
+
+/** Release a codec (once no op is using it); returns 1/0. */
+static int fun_codec_free(int64_t id) {
+  return fun_handle_free(&g_codecs, id);
+}
+
+/** Start a codec; returns handle (>0) or 0. */
+static int64_t fun_codec_new(int fmt, int decode, int as_bytes) {
+  FunCodecHandle *h = (FunCodecHandle *)malloc(sizeof(FunCodecHandle));
+  if (!h) return 0;
+  fun_codec_init(&h->c, fmt, decode);
+  h->as_bytes = as_bytes;
+  int64_t id = fun_handle_new(&g_codecs, h);
+  if (!id) free(h);
+  return id;
+}
+
+/**
+ * Bytes of v: a string directly, a byte array or another value (stringified)
+ * through *tmp, which the caller frees. Returns 0 for an array holding
+ * anything but integers 0..255.
+ */
+static int fun_codec_input(const Value *v, const unsigned char **p, size_t *n, unsigned char **tmp) {
+  *tmp = NULL;
+  if (v->type == VAL_STRING) {
+    *p = (const unsigned char *)(v->s ? v->s : "");
+    *n = strlen((const char *)*p);
+    return 1;
+  }
+  if (v->type == VAL_ARRAY) {
+    int count = array_length(v);
+    unsigned char *b = (unsigned char *)malloc(count > 0 ? (size_t)count : 1);
+    if (!b) return 0;
+    for (int i = 0; i < count; ++i) {
+      Value it = array_peek_value(v, i);
+      double d = it.type == VAL_INT ? (double)it.i : it.type == VAL_FLOAT ? it.d : -1;
+      if (d < 0 || d > 255 || d != (double)(int)d) {
+        free(b);
+        return 0;
+      }
+      b[i] = (unsigned char)d;
+    }
+    *p = *tmp = b;
+    *n = (size_t)count;
+    return 1;
+  }
+  char *s = value_to_string_alloc(v);
+  if (!s) return 0;
+  *p = *tmp = (unsigned char *)s;
+  *n = strlen(s);
+  return 1;
+}
+
+/** Output bytes as a string (NUL bytes as "%00" if pct00) or, with as_bytes, an array of ints. */
+static Value fun_codec_value(const unsigned char *p, size_t n, int as_bytes, int pct00) {
+  if (!as_bytes && pct00 && memchr(p, 0, n)) {
+    size_t nul = 0;
+    for (size_t i = 0; i < n; ++i) nul += p[i] == 0;
+    Value v = make_string_len(NULL, n + 2 * nul);
+    if (!v.s) return v;
+    char *q = v.s;
+    for (size_t i = 0; i < n; ++i) {
+      if (p[i]) {
+        *q++ = (char)p[i];
+      } else {
+        memcpy(q, "%00", 3);
+        q += 3;
+      }
+    }
+    return v;
+  }
+  if (!as_bytes) return make_string_len((const char *)p, n);
+  Value *items = (Value *)malloc(sizeof(Value) * (n ? n : 1));
+  if (!items) return make_array_take(NULL, 0);
+  for (size_t i = 0; i < n; ++i) items[i] = make_int(p[i]);
+  Value arr = make_array_take(items, (int)n);
+  free(items);
+  return arr;
+}
+
+/** Feed n bytes through c (and finish it if finish); returns the output or nil on invalid input. */
+static Value fun_codec_run(FunCodec *c, const unsigned char *p, size_t n, int finish, int as_bytes) {
+  unsigned char *out = (unsigned char *)malloc(fun_codec_max_out(c, n));
+  if (!out) return make_nil();
+  Value res = make_nil();
+  ptrdiff_t r = fun_codec_update(c, p, n, out);
+  ptrdiff_t f = r >= 0 && finish ? fun_codec_final(c, out + r) : 0;
+  int pct00 = c->decode && (c->fmt == FUN_CODEC_URL || c->fmt == FUN_CODEC_FORM);
+  if (r >= 0 && f >= 0) res = fun_codec_value(out, (size_t)(r + f), as_bytes, pct00);
+  free(out);
+  return res;
+}
+
+/** One-shot encode or decode of v; nil for invalid input. */
+static Value fun_codec_oneshot(int fmt, int decode, const Value *v, int as_bytes) {
+  const unsigned char *p;
+  size_t n;
+  unsigned char *tmp;
+  if (!fun_codec_input(v, &p, &n, &tmp)) return make_nil();
+  FunCodec c;
+  fun_codec_init(&c, fmt, decode);
+  Value res;
+  if (!decode && fmt != FUN_CODEC_URL && fmt != FUN_CODEC_FORM) {
+    /* base64 and hex output sizes are known: encode straight into the string */
+    size_t olen = fmt == FUN_CODEC_HEX ? 2 * n : fmt == FUN_CODEC_BASE64 ? (n + 2) / 3 * 4 : n / 3 * 4 + (n % 3 ? n % 3 + 1 : 0);
+    res = make_string_len(NULL, olen);
+    if (res.s) {
+      ptrdiff_t r = fun_codec_update(&c, p, n, (unsigned char *)res.s);
+      fun_codec_final(&c, (unsigned char *)res.s + r);
+    }
+  } else {
+    res = fun_codec_run(&c, p, n, 1, as_bytes);
+  }
+  free(tmp);
+  return res;
+}
@@ -0,0 +1,31 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file codec_final.c
+ * @brief Implements OP_CODEC_FINAL (codec_final(c)).
+ *
+ * Behavior:
+ * - Pops a codec handle, flushes it and frees the handle.
+ * - Pushes the rest of the output (base64 tail and padding, a pending '%'),
+ *   possibly empty; nil if the handle is unknown, the input was invalid or
+ *   it ended in the middle of a base64 group or hex byte.
+ */
+
+case OP_CODEC_FINAL: {
+  Value hv = pop_value(vm);
+  FunCodecHandle *h = hv.type == VAL_INT ? fun_codec_acquire(hv.i) : NULL;
+  Value res = make_nil();
+  /* h stays alive until the release; only the caller whose free succeeds flushes */
+  if (h && fun_codec_free(hv.i)) res = fun_codec_run(&h->c, (const unsigned char *)"", 0, 1, h->as_bytes);
+  if (h) fun_codec_release(hv.i);
+  free_value(hv);
+  push_value(vm, res);
+  break;
+}
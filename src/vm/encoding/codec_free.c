@@ -0,0 +1,25 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file codec_free.c
+ * @brief Implements OP_CODEC_FREE (codec_free(c)).
+ *
+ * Behavior:
+ * - Pops a codec handle and frees it without flushing.
+ * - Pushes 1 if the handle existed, else 0.
+ */
+
+case OP_CODEC_FREE: {
+  Value hv = pop_value(vm);
+  int ok = hv.type == VAL_INT ? fun_codec_free(hv.i) : 0;
+  free_value(hv);
+  push_value(vm, make_int(ok));
+  break;
+}
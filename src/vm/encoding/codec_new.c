@@ -0,0 +1,33 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file codec_new.c
+ * @brief Implements OP_CODEC_NEW (codec_new(format [, mode])).
+ *
+ * Behavior:
+ * - Operand 1 means a mode was passed: "encode" (the default), "decode"
+ *   (output as strings) or "decode_bytes" (output as byte arrays).
+ * - Pops the format: "base64", "base64url", "hex", "url" or "form".
+ * - Pushes a codec handle for codec_update()/codec_final(), or 0 for an
+ *   unknown format or mode.
+ */
+
+case OP_CODEC_NEW: {
+  Value modev = inst.operand ? pop_value(vm) : make_nil();
+  Value fmtv = pop_value(vm);
+  int fmt = fmtv.type == VAL_STRING && fmtv.s ? fun_codec_lookup(fmtv.s) : -1;
+  const char *mode = modev.type == VAL_STRING && modev.s ? modev.s : modev.type == VAL_NIL ? "encode" : "";
+  int decode = strcmp(mode, "encode") == 0 ? 0 : strcmp(mode, "decode") == 0 ? 1 : strcmp(mode, "decode_bytes") == 0 ? 2 : -1;
+  int64_t id = fmt >= 0 && decode >= 0 ? fun_codec_new(fmt, decode > 0, decode == 2) : 0;
+  free_value(modev);
+  free_value(fmtv);
+  push_value(vm, make_int(id));
+  break;
+}
@@ -0,0 +1,38 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file codec_update.c
+ * @brief Implements OP_CODEC_UPDATE (codec_update(c, data)).
+ *
+ * Behavior:
+ * - Pops data (a string or byte array; other values are stringified) and a
+ *   codec handle.
+ * - Pushes the output for the input so far that is complete (a base64
+ *   encoder keeps up to 2 bytes, a decoder up to 3 characters for the next
+ *   call); nil for invalid input or an unknown handle. After invalid input
+ *   the codec only returns nil.
+ */
+
+case OP_CODEC_UPDATE: {
+  Value data = pop_value(vm);
+  Value hv = pop_value(vm);
+  FunCodecHandle *h = hv.type == VAL_INT ? fun_codec_acquire(hv.i) : NULL;
+  const unsigned char *p;
+  size_t n;
+  unsigned char *tmp = NULL;
+  Value res = make_nil();
+  if (h && fun_codec_input(&data, &p, &n, &tmp)) res = fun_codec_run(&h->c, p, n, 0, h->as_bytes);
+  if (h) fun_codec_release(hv.i);
+  free(tmp);
+  free_value(data);
+  free_value(hv);
+  push_value(vm, res);
+  break;
+}
@@ -0,0 +1,30 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file hex_decode.c
+ * @brief Implements OP_HEX_DECODE (hex_decode(hex [, as_bytes])).
+ *
+ * Behavior:
+ * - Operand 1 means an as_bytes flag was passed.
+ * - Pops hex digits (either case, no separators).
+ * - Pushes the bytes as a string (cut at the first NUL byte) or, if
+ *   as_bytes is truthy, as an array of ints; nil for an odd number of
+ *   digits or a non-hex character.
+ */
+
+case OP_HEX_DECODE: {
+  Value asv = inst.operand ? pop_value(vm) : make_nil();
+  Value text = pop_value(vm);
+  Value res = fun_codec_oneshot(FUN_CODEC_HEX, 1, &text, value_is_truthy(&asv));
+  free_value(asv);
+  free_value(text);
+  push_value(vm, res);
+  break;
+}
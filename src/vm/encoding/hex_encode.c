@@ -0,0 +1,27 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file hex_encode.c
+ * @brief Implements OP_HEX_ENCODE (hex_encode(data)).
+ *
+ * Behavior:
+ * - Pops data: a string or a byte array (ints 0..255); other values are
+ *   stringified.
+ * - Pushes two lowercase hex digits per byte, or nil for an array with
+ *   other items.
+ */
+
+case OP_HEX_ENCODE: {
+  Value data = pop_value(vm);
+  Value res = fun_codec_oneshot(FUN_CODEC_HEX, 0, &data, 0);
+  free_value(data);
+  push_value(vm, res);
+  break;
+}
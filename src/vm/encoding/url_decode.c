@@ -0,0 +1,30 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file url_decode.c
+ * @brief Implements OP_URL_DECODE (url_decode(text [, form])).
+ *
+ * Behavior:
+ * - Operand 1 means a form flag was passed.
+ * - Pops text and decodes every %XX; a '%' not followed by two hex digits
+ *   is kept as is. With a truthy form flag '+' decodes to a space.
+ * - Pushes the decoded text; %00 stays as is, since Fun strings end at a
+ *   NUL byte.
+ */
+
+case OP_URL_DECODE: {
+  Value formv = inst.operand ? pop_value(vm) : make_nil();
+  Value text = pop_value(vm);
+  Value res = fun_codec_oneshot(value_is_truthy(&formv) ? FUN_CODEC_FORM : FUN_CODEC_URL, 1, &text, 0);
+  free_value(formv);
+  free_value(text);
+  push_value(vm, res);
+  break;
+}
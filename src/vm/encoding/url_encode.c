@@ -0,0 +1,31 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file url_encode.c
+ * @brief Implements OP_URL_ENCODE (url_encode(text [, form])).
+ *
+ * Behavior:
+ * - Operand 1 means a form flag was passed.
+ * - Pops text (a string or byte array; other values are stringified) and
+ *   percent-encodes every byte except A-Z a-z 0-9 - . _ ~ as %XX.
+ * - With a truthy form flag a space becomes '+'
+ *   (application/x-www-form-urlencoded).
+ * - Pushes the encoded text, or nil for an array with other items.
+ */
+
+case OP_URL_ENCODE: {
+  Value formv = inst.operand ? pop_value(vm) : make_nil();
+  Value text = pop_value(vm);
+  Value res = fun_codec_oneshot(value_is_truthy(&formv) ? FUN_CODEC_FORM : FUN_CODEC_URL, 0, &text, 0);
+  free_value(formv);
+  free_value(text);
+  push_value(vm, res);
+  break;
+}
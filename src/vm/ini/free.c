@@ -27,14 +27,14 @@
  * - No VM error is thrown for invalid handles; the opcode simply returns 0.
  *
  * See also
- * - ini_alloc_handle(), ini_free_handle() in src/vm/ini/handles.c
+ * - ini_alloc_handle(), ini_free_handle() in src/extensions/ini.c
  */
 
 /* OP_INI_FREE: pops handle; pushes 1/0 */
 #ifdef FUN_WITH_INI
 case OP_INI_FREE: {
   Value vh = pop_value(vm);
-  int h = (vh.type == VAL_INT) ? (int)vh.i : 0;
+  int64_t h = (vh.type == VAL_INT) ? vh.i : 0;
   free_value(vh);
   int ok = ini_free_handle(h);
   push_value(vm, make_int(ok));
@@ -39,7 +39,7 @@ case OP_INI_GET_BOOL: {
   int def = (vdef.type == VAL_INT || vdef.type == VAL_BOOL) ? (int)vdef.i : 0;
   const char *key = (vkey.type == VAL_STRING) ? vkey.s : NULL;
   const char *sec = (vsec.type == VAL_STRING) ? vsec.s : NULL;
-  int h = (vh.type == VAL_INT) ? (int)vh.i : 0;
+  int64_t h = (vh.type == VAL_INT) ? vh.i : 0;
   dictionary *d = ini_get(h);
   int outb = def;
   if (d && sec && key) {
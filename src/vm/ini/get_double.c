@@ -33,7 +33,7 @@ case OP_INI_GET_DOUBLE: {
   double def = (vdef.type == VAL_FLOAT) ? vdef.d : (vdef.type == VAL_INT ? (double)vdef.i : 0.0);
   const char *key = (vkey.type == VAL_STRING) ? vkey.s : NULL;
   const char *sec = (vsec.type == VAL_STRING) ? vsec.s : NULL;
-  int h = (vh.type == VAL_INT) ? (int)vh.i : 0;
+  int64_t h = (vh.type == VAL_INT) ? vh.i : 0;
   dictionary *d = ini_get(h);
   double outd = def;
   if (d && sec && key) {
@@ -33,7 +33,7 @@ case OP_INI_GET_STRING: {
   const char *def = (vdef.type == VAL_STRING && vdef.s) ? vdef.s : "";
   const char *key = (vkey.type == VAL_STRING) ? vkey.s : NULL;
   const char *sec = (vsec.type == VAL_STRING) ? vsec.s : NULL;
-  int h = (vh.type == VAL_INT) ? (int)vh.i : 0;
+  int64_t h = (vh.type == VAL_INT) ? vh.i : 0;
   dictionary *d = ini_get(h);
   const char *res = def;
   if (d && sec && key) {
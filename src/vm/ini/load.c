@@ -29,7 +29,7 @@
 case OP_INI_LOAD: {
   Value vpath = pop_value(vm);
   const char *path = (vpath.type == VAL_STRING && vpath.s) ? vpath.s : NULL;
-  int h = 0;
+  int64_t h = 0;
   if (path) {
     dictionary *d = iniparser_load(path);
     if (d) {
@@ -29,7 +29,7 @@ case OP_INI_SAVE: {
   Value vpath = pop_value(vm);
   Value vh = pop_value(vm);
   const char *path = (vpath.type == VAL_STRING) ? vpath.s : NULL;
-  dictionary *d = ini_get((vh.type == VAL_INT) ? (int)vh.i : 0);
+  dictionary *d = ini_get((vh.type == VAL_INT) ? vh.i : 0);
   int ok = 0;
   if (d && path) {
     FILE *f = fopen(path, "w");
@@ -31,7 +31,7 @@ case OP_INI_SET: {
   Value vkey = pop_value(vm);
   Value vsec = pop_value(vm);
   Value vh = pop_value(vm);
-  dictionary *d = ini_get((vh.type == VAL_INT) ? (int)vh.i : 0);
+  dictionary *d = ini_get((vh.type == VAL_INT) ? vh.i : 0);
   const char *key = (vkey.type == VAL_STRING) ? vkey.s : NULL;
   const char *sec = (vsec.type == VAL_STRING) ? vsec.s : NULL;
   int ok = 0;
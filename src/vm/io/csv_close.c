@@ -0,0 +1,26 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file csv_close.c
+ * @brief Implements OP_CSV_CLOSE (csv_close(reader)).
+ *
+ * Behavior:
+ * - Releases the reader and closes its file (a caller's descriptor stays
+ *   open). Rows already returned stay valid.
+ * - Pushes 1, or 0 if the handle is unknown or already closed.
+ */
+
+case OP_CSV_CLOSE: {
+  Value hv = pop_value(vm);
+  int ok = fun_csv_close(FUN_CSV_READER, &hv);
+  free_value(hv);
+  push_value(vm, make_int(ok));
+  break;
+}
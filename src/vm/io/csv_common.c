@@ -0,0 +1,842 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file csv_common.c
+ * @brief Streaming CSV (RFC 4180) reader and writer used by the OP_CSV_* opcodes.
+ *
+ * Reader: records are parsed incrementally from a file, a file descriptor
+ * (pipes, sockets) or a string. Input is read in 64 KiB chunks into a
+ * buffer that only grows when a single record does not fit; a record that
+ * is cut off by the end of the buffer is re-parsed after the next read, so
+ * memory stays bounded by the longest record, not the file. Quoted fields
+ * may contain separators, doubled quotes and line breaks; CRLF, LF and lone
+ * CR end records; a UTF-8 BOM is skipped. Malformed input is read
+ * leniently (text after a closing quote is appended, an unterminated quote
+ * runs to the end of input) instead of failing the whole file.
+ *
+ * Unquoted fields become strings straight from the input buffer; only
+ * quoted fields are unescaped through a scratch buffer. Rows are arrays, or
+ * maps keyed by the header when one is known. All map rows of a reader
+ * share one refcounted key set (make_map_shared()), so column names are not
+ * copied per row. Columns can be coerced to int, float, number or bool; an
+ * empty typed field becomes nil, a field that does not parse stays a
+ * string.
+ *
+ * Writer: rows (arrays or maps) are formatted into a buffer that is flushed
+ * to the file or descriptor every 64 KiB, or kept in memory for
+ * csv_format(). Fields are quoted only when they contain the separator, the
+ * quote character or a line break.
+ *
+ * Readers and writers share the g_csv handle table (src/handles.c); both
+ * structs start with their kind, so a reader id passed to csv_write (or the
+ * reverse) is rejected. Ops borrow the object for one call, and a close
+ * from another thread takes effect when that call returns.
+ *
+ * Options map (all optional):
+ *   sep        separator, first character of a string (default ",")
+ *   quote      quote character (default "\""; "" disables quoting)
+ *   header     reader: first record holds the column names;
+ *              writer: write a header line when the columns are known
+ *              (reader default false, writer default true)
+ *   columns    array of column names (reader: used instead of a header)
+ *   maps       reader: emit maps instead of arrays (default: true when
+ *              column names are known)
+ *   types      reader: {"name": "int"} or ["string", "int", ...] with
+ *              "int", "float", "number", "bool" or "string"
+ *   skip_empty reader: drop blank lines (default true)
+ *   eol        writer: line ending (default "\r\n")
+ *   append     writer: append to an existing file (default false)
+ */
+
+#include <errno.h>
+
+#define FUN_CSV_CHUNK 65536 /* bytes read or buffered before a write */
+
+enum { FUN_CSV_READER = 1, FUN_CSV_WRITER = 2 };
+
+enum { FUN_CSV_T_STRING = 0, FUN_CSV_T_INT, FUN_CSV_T_FLOAT, FUN_CSV_T_NUMBER, FUN_CSV_T_BOOL };
+
+typedef struct {
+  size_t off;     /* start in buf, or in scratch when in_scratch */
+  size_t len;
+  int in_scratch; /* quoted field, unescaped into scratch */
+} FunCsvField;
+
+typedef struct {
+  int kind;       /* FUN_CSV_READER; must stay first */
+  FILE *f;        /* owned file, or NULL */
+  int fd;         /* caller's descriptor (not closed), or -1 */
+  char *buf;      /* input; borrowed for csv_parse() strings */
+  size_t start;   /* first unparsed byte */
+  size_t len;
+  size_t cap;
+  int owns_buf;
+  int eof;
+  int bom_done;
+  char sep;
+  char quote;
+  int header;     /* first record still to be taken as header */
+  int maps;       /* -1 = when names are known */
+  int skip_empty;
+  unsigned char stop[256]; /* bytes ending an unquoted field */
+  FunCsvField *fields;
+  int nfields;
+  int fields_cap;
+  char *scratch;
+  size_t scratch_len;
+  size_t scratch_cap;
+  Value *vals; /* row assembly */
+  int vals_cap;
+  char **names;
+  int ncols;
+  struct MapKeys *keys;
+  Value types; /* types option until the column names are known */
+  unsigned char *col_types;
+  int ntypes;
+} FunCsvReader;
+
+typedef struct {
+  int kind; /* FUN_CSV_WRITER; must stay first */
+  FILE *f;  /* owned file, or NULL */
+  int fd;   /* caller's descriptor (not closed), or -1; both unset: memory */
+  char *buf;
+  size_t len;
+  size_t cap;
+  char sep;
+  char quote;
+  char eol[3];
+  int header;
+  int started;
+  int failed;
+  char **cols;
+  int ncols;
+} FunCsvWriter;
+
+/* ---- options ---- */
+
+/** Option value by key; Nil when opts is not a map or the key is missing. */
+static Value fun_csv_opt(const Value *opts, const char *key) {
+  Value v = make_nil();
+  if (opts && opts->type == VAL_MAP) map_get_copy(opts, key, &v);
+  return v;
+}
+
+static int fun_csv_opt_bool(const Value *opts, const char *key, int dflt) {
+  Value v = fun_csv_opt(opts, key);
+  int out = dflt;
+  if (v.type == VAL_BOOL || v.type == VAL_INT) out = v.i != 0;
+  free_value(v);
+  return out;
+}
+
+/** First character of a string option; "" yields '\0'. */
+static char fun_csv_opt_char(const Value *opts, const char *key, char dflt) {
+  Value v = fun_csv_opt(opts, key);
+  char out = dflt;
+  if (v.type == VAL_STRING) out = v.s ? v.s[0] : '\0';
+  free_value(v);
+  return out;
+}
+
+/** Column names from an array of strings; returns count (0 if none), sets *out. */
+static int fun_csv_opt_names(const Value *opts, const char *key, char ***out) {
+  Value v = fun_csv_opt(opts, key);
+  int n = v.type == VAL_ARRAY ? array_length(&v) : 0;
+  char **names = n > 0 ? (char **)calloc((size_t)n, sizeof(char *)) : NULL;
+  if (!names) n = 0;
+  for (int i = 0; i < n; ++i) {
+    Value it = array_peek_value(&v, i);
+    names[i] = it.type == VAL_STRING ? strdup(it.s ? it.s : "") : value_to_string_alloc(&it);
+  }
+  free_value(v);
+  *out = names;
+  return n;
+}
+
+static void fun_csv_free_names(char **names, int n) {
+  for (int i = 0; i < n; ++i)
+    free(names[i]);
+  free(names);
+}
+
+static int fun_csv_type_code(const Value *v) {
+  if (!v || v->type != VAL_STRING || !v->s) return FUN_CSV_T_STRING;
+  if (strcmp(v->s, "int") == 0) return FUN_CSV_T_INT;
+  if (strcmp(v->s, "float") == 0) return FUN_CSV_T_FLOAT;
+  if (strcmp(v->s, "number") == 0) return FUN_CSV_T_NUMBER;
+  if (strcmp(v->s, "bool") == 0) return FUN_CSV_T_BOOL;
+  return FUN_CSV_T_STRING;
+}
+
+/* ---- reader ---- */
+
+static void fun_csv_reader_free(FunCsvReader *r) {
+  if (!r) return;
+  if (r->f) fclose(r->f);
+  if (r->owns_buf) free(r->buf);
+  free(r->fields);
+  free(r->scratch);
+  free(r->vals);
+  fun_csv_free_names(r->names, r->ncols);
+  map_keys_release(r->keys);
+  free_value(r->types);
+  free(r->col_types);
+  free(r);
+}
+
+/**
+ * Create a reader over a file (f, owned), a descriptor (fd) or a string
+ * (text, borrowed: it must outlive the reader). Returns NULL on failure.
+ */
+static FunCsvReader *fun_csv_reader_new(FILE *f, int fd, const char *text, const Value *opts) {
+  FunCsvReader *r = (FunCsvReader *)calloc(1, sizeof(FunCsvReader));
+  if (!r) {
+    if (f) fclose(f);
+    return NULL;
+  }
+  r->kind = FUN_CSV_READER;
+  r->f = f;
+  r->fd = fd;
+  r->types = make_nil();
+  if (text) {
+    r->buf = (char *)text;
+    r->len = strlen(text);
+    r->cap = r->len;
+    r->eof = 1;
+  } else {
+    r->buf = (char *)malloc(FUN_CSV_CHUNK);
+    r->cap = FUN_CSV_CHUNK;
+    r->owns_buf = 1;
+    if (!r->buf) {
+      fun_csv_reader_free(r);
+      return NULL;
+    }
+    /* we buffer ourselves; avoid a second copy through stdio */
+    if (f) setvbuf(f, NULL, _IONBF, 0);
+  }
+  r->sep = fun_csv_opt_char(opts, "sep", ',');
+  r->quote = fun_csv_opt_char(opts, "quote", '"');
+  r->header = fun_csv_opt_bool(opts, "header", 0);
+  r->skip_empty = fun_csv_opt_bool(opts, "skip_empty", 1);
+  Value m = fun_csv_opt(opts, "maps");
+  r->maps = (m.type == VAL_BOOL || m.type == VAL_INT) ? (m.i != 0) : -1;
+  free_value(m);
+  r->types = fun_csv_opt(opts, "types");
+  r->stop[(unsigned char)r->sep] = 1;
+  r->stop['\n'] = 1;
+  r->stop['\r'] = 1;
+  char **names = NULL;
+  int n = fun_csv_opt_names(opts, "columns", &names);
+  if (n > 0) {
+    r->names = names;
+    r->ncols = n;
+  }
+  return r;
+}
+
+/** Make room at the end of the buffer and read more input; sets eof when exhausted. */
+static void fun_csv_fill(FunCsvReader *r) {
+  if (r->eof) return;
+  if (r->start > 0) {
+    memmove(r->buf, r->buf + r->start, r->len - r->start);
+    r->len -= r->start;
+    r->start = 0;
+  }
+  if (r->len == r->cap) {
+    char *nb = (char *)realloc(r->buf, r->cap * 2);
+    if (!nb) {
+      r->eof = 1;
+      return;
+    }
+    r->buf = nb;
+    r->cap *= 2;
+  }
+  size_t room = r->cap - r->len;
+  long got = 0;
+  if (r->f) {
+    got = (long)fread(r->buf + r->len, 1, room, r->f);
+  }
+#ifdef __unix__
+  else if (r->fd >= 0) {
+    ssize_t n;
+    do {
+      n = read(r->fd, r->buf + r->len, room);
+    } while (n < 0 && errno == EINTR);
+    got = n > 0 ? (long)n : 0;
+  }
+#endif
+  if (got <= 0)
+    r->eof = 1;
+  else
+    r->len += (size_t)got;
+}
+
+/** Append a field descriptor; NULL on allocation failure. */
+static FunCsvField *fun_csv_field_add(FunCsvReader *r) {
+  if (r->nfields == r->fields_cap) {
+    int ncap = r->fields_cap ? r->fields_cap * 2 : 32;
+    FunCsvField *nf = (FunCsvField *)realloc(r->fields, sizeof(FunCsvField) * (size_t)ncap);
+    if (!nf) return NULL;
+    r->fields = nf;
+    r->fields_cap = ncap;
+  }
+  FunCsvField *f = &r->fields[r->nfields++];
+  f->off = 0;
+  f->len = 0;
+  f->in_scratch = 0;
+  return f;
+}
+
+static int fun_csv_scratch_put(FunCsvReader *r, const char *p, size_t n) {
+  if (r->scratch_len + n > r->scratch_cap) {
+    size_t ncap = r->scratch_cap ? r->scratch_cap : 1024;
+    while (ncap < r->scratch_len + n)
+      ncap *= 2;
+    char *ns = (char *)realloc(r->scratch, ncap);
+    if (!ns) return 0;
+    r->scratch = ns;
+    r->scratch_cap = ncap;
+  }
+  memcpy(r->scratch + r->scratch_len, p, n);
+  r->scratch_len += n;
+  return 1;
+}
+
+/**
+ * Parse one record at r->start into r->fields.
+ * Returns 1 for a record (r->start advanced), 0 when more input is needed
+ * (nothing consumed) and -1 at the end of input or on allocation failure.
+ */
+static int fun_csv_parse_record(FunCsvReader *r) {
+  const char *b = r->buf;
+  size_t n = r->len, i = r->start;
+  char q = r->quote;
+  if (i >= n) return r->eof ? -1 : 0;
+  r->nfields = 0;
+  r->scratch_len = 0;
+  for (;;) {
+    if (i >= n && !r->eof) return 0;
+    FunCsvField *f = fun_csv_field_add(r);
+    if (!f) return -1;
+    if (q && i < n && b[i] == q) {
+      f->in_scratch = 1;
+      f->off = r->scratch_len;
+      size_t s = ++i;
+      for (;;) {
+        const char *e = (const char *)memchr(b + i, q, n - i);
+        if (!e) {
+          if (!r->eof) return 0;
+          /* unterminated quote: the field runs to the end of input */
+          if (!fun_csv_scratch_put(r, b + s, n - s)) return -1;
+          i = n;
+          break;
+        }
+        size_t qi = (size_t)(e - b);
+        if (qi + 1 >= n && !r->eof) return 0;
+        if (qi + 1 < n && b[qi + 1] == q) {
+          /* doubled quote */
+          if (!fun_csv_scratch_put(r, b + s, qi + 1 - s)) return -1;
+          i = s = qi + 2;
+          continue;
+        }
+        if (!fun_csv_scratch_put(r, b + s, qi - s)) return -1;
+        i = qi + 1;
+        /* lenient: text between the closing quote and the separator is kept */
+        s = i;
+        while (i < n && !r->stop[(unsigned char)b[i]])
+          i++;
+        if (i >= n && !r->eof) return 0;
+        if (i > s && !fun_csv_scratch_put(r, b + s, i - s)) return -1;
+        break;
+      }
+      f->len = r->scratch_len - f->off;
+    } else {
+      size_t s = i;
+      while (i < n && !r->stop[(unsigned char)b[i]])
+        i++;
+      f->off = s;
+      f->len = i - s;
+    }
+    if (i >= n) {
+      if (!r->eof) return 0;
+      break;
+    }
+    if (b[i] == r->sep) {
+      i++;
+      continue;
+    }
+    if (b[i] == '\r') {
+      if (i + 1 >= n && !r->eof) return 0;
+      i++;
+      if (i < n && b[i] == '\n') i++;
+    } else {
+      i++; /* '\n' */
+    }
+    break;
+  }
+  r->start = i;
+  return 1;
+}
+
+/** Parse the next record, reading input as needed; 1 = record, -1 = end. */
+static int fun_csv_next_record(FunCsvReader *r) {
+  while (!r->bom_done) {
+    if (r->len - r->start >= 3 || r->eof) {
+      if (r->len - r->start >= 3 && memcmp(r->buf + r->start, "\xEF\xBB\xBF", 3) == 0) r->start += 3;
+      r->bom_done = 1;
+    } else {
+      fun_csv_fill(r);
+    }
+  }
+  for (;;) {
+    int rc = fun_csv_parse_record(r);
+    if (rc == 0) {
+      fun_csv_fill(r);
+      continue;
+    }
+    if (rc < 0) return -1;
+    if (r->skip_empty && r->nfields == 1 && r->fields[0].len == 0 && !r->fields[0].in_scratch) continue;
+    return 1;
+  }
+}
+
+static const char *fun_csv_field_ptr(const FunCsvReader *r, const FunCsvField *f) {
+  return f->in_scratch ? r->scratch + f->off : r->buf + f->off;
+}
+
+static Value fun_csv_string(const char *p, size_t len) {
+  Value v = make_string_len(p, len);
+  if (!v.s) return make_nil();
+  return v;
+}
+
+/** Field i as a Value, coerced to the column's type. */
+static Value fun_csv_field_value(const FunCsvReader *r, int i) {
+  const FunCsvField *f = &r->fields[i];
+  const char *p = fun_csv_field_ptr(r, f);
+  int t = i < r->ntypes ? r->col_types[i] : FUN_CSV_T_STRING;
+  if (t == FUN_CSV_T_STRING) return fun_csv_string(p, f->len);
+  if (f->len == 0) return make_nil();
+  char tmp[64];
+  if (f->len >= sizeof(tmp)) return fun_csv_string(p, f->len);
+  memcpy(tmp, p, f->len);
+  tmp[f->len] = '\0';
+  char *end = NULL;
+  if (t == FUN_CSV_T_INT || t == FUN_CSV_T_NUMBER) {
+    errno = 0;
+    long long ll = strtoll(tmp, &end, 10);
+    if (end != tmp && *end == '\0' && errno == 0) return make_int((int64_t)ll);
+  }
+  if (t == FUN_CSV_T_FLOAT || t == FUN_CSV_T_NUMBER) {
+    double d = strtod(tmp, &end);
+    if (end != tmp && *end == '\0') return make_float(d);
+  }
+  if (t == FUN_CSV_T_BOOL) {
+    for (char *c = tmp; *c; ++c)
+      if (*c >= 'A' && *c <= 'Z') *c = (char)(*c - 'A' + 'a');
+    if (strcmp(tmp, "true") == 0 || strcmp(tmp, "1") == 0 || strcmp(tmp, "yes") == 0) return make_bool(1);
+    if (strcmp(tmp, "false") == 0 || strcmp(tmp, "0") == 0 || strcmp(tmp, "no") == 0) return make_bool(0);
+  }
+  return fun_csv_string(p, f->len);
+}
+
+/** Resolve the types option against the column names (if any). */
+static void fun_csv_resolve_types(FunCsvReader *r) {
+  if (r->types.type == VAL_ARRAY) {
+    int n = array_length(&r->types);
+    r->col_types = n > 0 ? (unsigned char *)calloc((size_t)n, 1) : NULL;
+    if (r->col_types) {
+      r->ntypes = n;
+      for (int i = 0; i < n; ++i) {
+        Value t = array_peek_value(&r->types, i);
+        r->col_types[i] = (unsigned char)fun_csv_type_code(&t);
+      }
+    }
+  } else if (r->types.type == VAL_MAP && r->ncols > 0) {
+    r->col_types = (unsigned char *)calloc((size_t)r->ncols, 1);
+    if (r->col_types) {
+      r->ntypes = r->ncols;
+      for (int i = 0; i < r->ncols; ++i) {
+        Value t;
+        if (map_get_copy(&r->types, r->names[i], &t)) {
+          r->col_types[i] = (unsigned char)fun_csv_type_code(&t);
+          free_value(t);
+        }
+      }
+    }
+  }
+  free_value(r->types);
+  r->types = make_nil();
+}
+
+/** base, or base_2, base_3, ... when one of the first count names already uses it. */
+static char *fun_csv_unique_name(char **names, int count, const char *base) {
+  size_t bl = strlen(base) + 16;
+  char *name = (char *)malloc(bl);
+  if (!name) return NULL;
+  snprintf(name, bl, "%s", base);
+  for (int dup = 2;; ++dup) {
+    int clash = 0;
+    for (int j = 0; j < count && !clash; ++j)
+      clash = names[j] && strcmp(names[j], name) == 0;
+    if (!clash) return name;
+    snprintf(name, bl, "%s_%d", base, dup);
+  }
+}
+
+/** Take the pending header record (if any) and set up names, key set and types. */
+static void fun_csv_prepare(FunCsvReader *r) {
+  if (r->header) {
+    r->header = 0;
+    if (fun_csv_next_record(r) > 0 && r->ncols == 0) {
+      int n = r->nfields;
+      char **names = (char **)calloc((size_t)n, sizeof(char *));
+      for (int i = 0; names && i < n; ++i) {
+        const FunCsvField *f = &r->fields[i];
+        char base[32];
+        Value s = fun_csv_string(fun_csv_field_ptr(r, f), f->len);
+        snprintf(base, sizeof(base), "col%d", i + 1);
+        char *name = fun_csv_unique_name(names, i, s.type == VAL_STRING && s.s[0] ? s.s : base);
+        free_value(s);
+        names[i] = name ? name : strdup("");
+      }
+      if (names) {
+        r->names = names;
+        r->ncols = n;
+      }
+    }
+  }
+  if (r->ncols > 0 && !r->keys) r->keys = map_keys_new((const char *const *)r->names, r->ncols);
+  if (r->types.type != VAL_NIL) fun_csv_resolve_types(r);
+  if (r->maps < 0) r->maps = r->keys != NULL;
+}
+
+/** Next row as an array or map; Nil at the end of input. */
+static Value fun_csv_reader_row(FunCsvReader *r) {
+  if (r->header || r->maps < 0) fun_csv_prepare(r);
+  if (fun_csv_next_record(r) < 0) return make_nil();
+  int n = r->nfields;
+  int use_map = r->maps && r->keys;
+  int width = use_map && r->ncols > n ? r->ncols : n;
+  if (width > r->vals_cap) {
+    Value *nv = (Value *)realloc(r->vals, sizeof(Value) * (size_t)width);
+    if (!nv) return make_nil();
+    r->vals = nv;
+    r->vals_cap = width;
+  }
+  if (!use_map) {
+    for (int i = 0; i < n; ++i)
+      r->vals[i] = fun_csv_field_value(r, i);
+    return make_array_take(r->vals, n);
+  }
+  for (int i = 0; i < r->ncols; ++i)
+    r->vals[i] = i < n ? fun_csv_field_value(r, i) : make_nil();
+  Value row = make_map_shared(r->keys, r->vals);
+  /* fields beyond the named columns get col<N> keys */
+  for (int i = r->ncols; i < n && row.type == VAL_MAP; ++i) {
+    char key[32];
+    snprintf(key, sizeof(key), "col%d", i + 1);
+    map_set(&row, key, fun_csv_field_value(r, i));
+  }
+  return row;
+}
+
+/** Column names as an array of strings (reads the header if still pending). */
+static Value fun_csv_reader_header(FunCsvReader *r) {
+  if (r->header || r->maps < 0) fun_csv_prepare(r);
+  Value out = make_array_from_values(NULL, 0);
+  for (int i = 0; i < r->ncols; ++i)
+    array_push(&out, make_string(r->names[i]));
+  return out;
+}
+
+/**
+ * Open a reader on a path (string) or an open descriptor (int; not closed
+ * by the reader). Returns NULL if the file cannot be opened.
+ */
+static FunCsvReader *fun_csv_reader_open(const Value *src, const Value *opts) {
+  if (src->type == VAL_STRING) {
+    FILE *f = fopen(src->s ? src->s : "", "rb");
+    if (!f) return NULL;
+    return fun_csv_reader_new(f, -1, NULL, opts);
+  }
+#ifdef __unix__
+  if (src->type == VAL_INT && src->i >= 0) return fun_csv_reader_new(NULL, (int)src->i, NULL, opts);
+#endif
+  return NULL;
+}
+
+/* ---- writer ---- */
+
+static int fun_csv_writer_flush(FunCsvWriter *w) {
+  size_t off = 0;
+  if (w->f) {
+    if (fwrite(w->buf, 1, w->len, w->f) != w->len) w->failed = 1;
+    off = w->len;
+  }
+#ifdef __unix__
+  else if (w->fd >= 0) {
+    while (off < w->len) {
+      ssize_t n = write(w->fd, w->buf + off, w->len - off);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) {
+        w->failed = 1;
+        break;
+      }
+      off += (size_t)n;
+    }
+  }
+#endif
+  else {
+    return 1; /* memory writer keeps everything */
+  }
+  w->len = 0;
+  return !w->failed;
+}
+
+static int fun_csv_put(FunCsvWriter *w, const char *p, size_t n) {
+  if (w->len + n > w->cap) {
+    size_t ncap = w->cap ? w->cap : FUN_CSV_CHUNK;
+    while (ncap < w->len + n)
+      ncap *= 2;
+    char *nb = (char *)realloc(w->buf, ncap);
+    if (!nb) {
+      w->failed = 1;
+      return 0;
+    }
+    w->buf = nb;
+    w->cap = ncap;
+  }
+  memcpy(w->buf + w->len, p, n);
+  w->len += n;
+  return 1;
+}
+
+/** Append one field, quoted if it contains the separator, the quote or a line break. */
+static void fun_csv_put_field(FunCsvWriter *w, const char *s, size_t n) {
+  int need = 0;
+  for (size_t i = 0; i < n && !need; ++i) {
+    char c = s[i];
+    need = c == w->sep || c == '\n' || c == '\r' || (w->quote && c == w->quote);
+  }
+  if (!need || !w->quote) {
+    fun_csv_put(w, s, n);
+    return;
+  }
+  fun_csv_put(w, &w->quote, 1);
+  size_t start = 0;
+  for (size_t i = 0; i < n; ++i) {
+    if (s[i] == w->quote) {
+      fun_csv_put(w, s + start, i + 1 - start);
+      fun_csv_put(w, &w->quote, 1);
+      start = i + 1;
+    }
+  }
+  fun_csv_put(w, s + start, n - start);
+  fun_csv_put(w, &w->quote, 1);
+}
+
+static void fun_csv_put_value(FunCsvWriter *w, const Value *v) {
+  char tmp[64];
+  switch (v ? v->type : VAL_NIL) {
+  case VAL_STRING:
+    fun_csv_put_field(w, v->s ? v->s : "", v->s ? strlen(v->s) : 0);
+    return;
+  case VAL_NIL:
+    return;
+  case VAL_INT:
+    snprintf(tmp, sizeof(tmp), "%" PRId64, v->i);
+    fun_csv_put(w, tmp, strlen(tmp));
+    return;
+  case VAL_FLOAT:
+    /* shortest of %.15g/%.17g that reads back as the same double */
+    snprintf(tmp, sizeof(tmp), "%.15g", v->d);
+    if (strtod(tmp, NULL) != v->d) snprintf(tmp, sizeof(tmp), "%.17g", v->d);
+    fun_csv_put(w, tmp, strlen(tmp));
+    return;
+  default: {
+    char *s = value_to_string_alloc(v);
+    if (s) fun_csv_put_field(w, s, strlen(s));
+    free(s);
+    return;
+  }
+  }
+}
+
+static void fun_csv_put_eol(FunCsvWriter *w) {
+  fun_csv_put(w, w->eol, strlen(w->eol));
+}
+
+/** Append one row (array or map); returns 1, or 0 for other values and empty arrays. */
+static int fun_csv_writer_row(FunCsvWriter *w, const Value *row) {
+  if (row->type != VAL_ARRAY && row->type != VAL_MAP) return 0;
+  /* an empty array has no fields: writing it would emit a blank line */
+  if (row->type == VAL_ARRAY && array_length(row) == 0) return 0;
+  if (row->type == VAL_MAP && w->ncols == 0) {
+    Value keys = map_keys_array(row);
+    int n = array_length(&keys);
+    w->cols = n > 0 ? (char **)calloc((size_t)n, sizeof(char *)) : NULL;
+    for (int i = 0; w->cols && i < n; ++i) {
+      Value k = array_peek_value(&keys, i);
+      w->cols[i] = strdup(k.type == VAL_STRING && k.s ? k.s : "");
+      w->ncols = i + 1;
+    }
+    free_value(keys);
+  }
+  if (!w->started) {
+    w->started = 1;
+    if (w->header && w->ncols > 0) {
+      for (int i = 0; i < w->ncols; ++i) {
+        if (i) fun_csv_put(w, &w->sep, 1);
+        fun_csv_put_field(w, w->cols[i], strlen(w->cols[i]));
+      }
+      fun_csv_put_eol(w);
+    }
+  }
+  if (row->type == VAL_ARRAY) {
+    int n = array_length(row);
+    for (int i = 0; i < n; ++i) {
+      if (i) fun_csv_put(w, &w->sep, 1);
+      Value cell = array_peek_value(row, i);
+      fun_csv_put_value(w, &cell);
+    }
+  } else {
+    for (int i = 0; i < w->ncols; ++i) {
+      if (i) fun_csv_put(w, &w->sep, 1);
+      Value v;
+      if (map_get_copy(row, w->cols[i], &v)) {
+        fun_csv_put_value(w, &v);
+        free_value(v);
+      }
+    }
+  }
+  fun_csv_put_eol(w);
+  if ((w->f || w->fd >= 0) && w->len >= FUN_CSV_CHUNK) fun_csv_writer_flush(w);
+  return 1;
+}
+
+/**
+ * Append a row, or every row of an array of rows (an array whose first
+ * item is an array or map). Returns the number of rows written.
+ */
+static int64_t fun_csv_writer_rows(FunCsvWriter *w, const Value *v) {
+  Value first = array_peek_value(v, 0);
+  if (first.type == VAL_ARRAY || first.type == VAL_MAP) {
+    int64_t count = 0;
+    int n = array_length(v);
+    for (int i = 0; i < n; ++i) {
+      Value row = array_peek_value(v, i);
+      count += fun_csv_writer_row(w, &row);
+    }
+    return count;
+  }
+  return fun_csv_writer_row(w, v);
+}
+
+static FunCsvWriter *fun_csv_writer_new(FILE *f, int fd, const Value *opts) {
+  FunCsvWriter *w = (FunCsvWriter *)calloc(1, sizeof(FunCsvWriter));
+  if (!w) {
+    if (f) fclose(f);
+    return NULL;
+  }
+  w->kind = FUN_CSV_WRITER;
+  w->f = f;
+  w->fd = fd;
+  w->sep = fun_csv_opt_char(opts, "sep", ',');
+  w->quote = fun_csv_opt_char(opts, "quote", '"');
+  w->header = fun_csv_opt_bool(opts, "header", 1);
+  strcpy(w->eol, "\r\n");
+  Value eol = fun_csv_opt(opts, "eol");
+  if (eol.type == VAL_STRING && eol.s && strlen(eol.s) < sizeof(w->eol)) strcpy(w->eol, eol.s);
+  free_value(eol);
+  w->ncols = fun_csv_opt_names(opts, "columns", &w->cols);
+  return w;
+}
+
+/** Flush, close an owned file and free; returns 1 if every write succeeded. */
+static int fun_csv_writer_free(FunCsvWriter *w) {
+  if (!w) return 0;
+  fun_csv_writer_flush(w);
+  if (w->f && fclose(w->f) != 0) w->failed = 1;
+  int ok = !w->failed;
+  free(w->buf);
+  fun_csv_free_names(w->cols, w->ncols);
+  free(w);
+  return ok;
+}
+
+/* ---- handles ---- */
+
+/** Handle table destructor for readers and writers. */
+static void fun_csv_destroy(void *p) {
+  if (*(int *)p == FUN_CSV_READER)
+    fun_csv_reader_free((FunCsvReader *)p);
+  else
+    fun_csv_writer_free((FunCsvWriter *)p);
+}
+
+static FunHandleTable g_csv = FUN_HANDLE_TABLE_INIT(fun_csv_destroy);
+
+/**
+ * Borrow the reader or writer (kind) behind the handle id; NULL if unknown,
+ * closed or of the other kind. Pair with fun_csv_release().
+ */
+static void *fun_csv_acquire(int kind, const Value *id) {
+  if (id->type != VAL_INT) return NULL;
+  void *p = fun_handle_acquire(&g_csv, id->i);
+  if (p && *(int *)p != kind) {
+    fun_handle_release(&g_csv, id->i);
+    p = NULL;
+  }
+  return p;
+}
+
+static void fun_csv_release(const Value *id) {
+  fun_handle_release(&g_csv, id->i);
+}
+
+/** Register a reader or writer; returns handle (>0), or 0 after freeing it. */
+static int64_t fun_csv_register(void *p) {
+  int64_t id = fun_handle_new(&g_csv, p);
+  if (!id && p) fun_csv_destroy(p);
+  return id;
+}
+
+/**
+ * Close the reader or writer (kind) behind id. For writers the buffered rows
+ * are flushed first. Returns 1 if the handle was closed (and, for writers,
+ * every write succeeded), 0 otherwise.
+ */
+static int fun_csv_close(int kind, const Value *id) {
+  void *p = fun_csv_acquire(kind, id);
+  if (!p) return 0;
+  int ok = 1;
+  if (kind == FUN_CSV_WRITER) {
+    FunCsvWriter *w = (FunCsvWriter *)p;
+    fun_csv_writer_flush(w);
+    if (w->f && fflush(w->f) != 0) w->failed = 1;
+    ok = !w->failed;
+  }
+  fun_csv_release(id);
+  return fun_handle_free(&g_csv, id->i) && ok;
+}
+
+/** Open a writer on a path (truncated, or appended with append: true) or a descriptor. */
+static FunCsvWriter *fun_csv_writer_open(const Value *dst, const Value *opts) {
+  if (dst->type == VAL_STRING) {
+    FILE *f = fopen(dst->s ? dst->s : "", fun_csv_opt_bool(opts, "append", 0) ? "ab" : "wb");
+    if (!f) return NULL;
+    return fun_csv_writer_new(f, -1, opts);
+  }
+#ifdef __unix__
+  if (dst->type == VAL_INT && dst->i >= 0) return fun_csv_writer_new(NULL, (int)dst->i, opts);
+#endif
+  return NULL;
+}
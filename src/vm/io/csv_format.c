@@ -0,0 +1,34 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file csv_format.c
+ * @brief Implements OP_CSV_FORMAT (csv_format(rows [, options])).
+ *
+ * Behavior:
+ * - Operand 1 means an options map was passed (see csv_common.c).
+ * - Formats one row or an array of rows exactly like csv_write and pushes
+ *   the CSV text as a string ("" for anything else).
+ */
+
+case OP_CSV_FORMAT: {
+  Value opts = inst.operand ? pop_value(vm) : make_nil();
+  Value rows = pop_value(vm);
+  FunCsvWriter *w = fun_csv_writer_new(NULL, -1, &opts);
+  Value out = make_string("");
+  if (w && fun_csv_writer_rows(w, &rows) > 0 && !w->failed) {
+    free_value(out);
+    out = fun_csv_string(w->buf, w->len);
+  }
+  fun_csv_writer_free(w);
+  free_value(rows);
+  free_value(opts);
+  push_value(vm, out);
+  break;
+}
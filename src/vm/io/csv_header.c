@@ -0,0 +1,30 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file csv_header.c
+ * @brief Implements OP_CSV_HEADER (csv_header(reader)).
+ *
+ * Behavior:
+ * - Pushes the column names as an array of strings: the header record
+ *   (read now if the reader was opened with header: true and no row has
+ *   been read yet) or the columns option. Empty names become col<N>,
+ *   repeated names get a _2, _3, ... suffix.
+ * - Pushes [] when the reader has no column names or the handle is unknown.
+ */
+
+case OP_CSV_HEADER: {
+  Value hv = pop_value(vm);
+  FunCsvReader *r = (FunCsvReader *)fun_csv_acquire(FUN_CSV_READER, &hv);
+  Value res = r ? fun_csv_reader_header(r) : make_array_from_values(NULL, 0);
+  if (r) fun_csv_release(&hv);
+  free_value(hv);
+  push_value(vm, res);
+  break;
+}
@@ -0,0 +1,29 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file csv_next.c
+ * @brief Implements OP_CSV_NEXT (csv_next(reader)).
+ *
+ * Behavior:
+ * - Parses the next record, reading more input as needed.
+ * - Pushes it as an array of fields, or as a map keyed by the column names
+ *   when the reader has a header or columns (maps share one key set).
+ * - Pushes Nil at the end of input or for an unknown handle.
+ */
+
+case OP_CSV_NEXT: {
+  Value hv = pop_value(vm);
+  FunCsvReader *r = (FunCsvReader *)fun_csv_acquire(FUN_CSV_READER, &hv);
+  Value res = r ? fun_csv_reader_row(r) : make_nil();
+  if (r) fun_csv_release(&hv);
+  free_value(hv);
+  push_value(vm, res);
+  break;
+}
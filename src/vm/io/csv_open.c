@@ -0,0 +1,31 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file csv_open.c
+ * @brief Implements OP_CSV_OPEN (csv_open(path_or_fd [, options])).
+ *
+ * Behavior:
+ * - Operand 1 means an options map was passed (see csv_common.c).
+ * - A string opens that file for reading; an int reads from an open file
+ *   descriptor (pipe, socket, stdin), which csv_close() leaves open.
+ * - Nothing is read yet; rows are parsed on demand by csv_next/csv_read.
+ * - Pushes a reader handle, or 0 if the file cannot be opened.
+ */
+
+case OP_CSV_OPEN: {
+  Value opts = inst.operand ? pop_value(vm) : make_nil();
+  Value src = pop_value(vm);
+  FunCsvReader *r = fun_csv_reader_open(&src, &opts);
+  int64_t id = r ? fun_csv_register(r) : 0;
+  free_value(src);
+  free_value(opts);
+  push_value(vm, make_int(id));
+  break;
+}
@@ -0,0 +1,48 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file csv_parse.c
+ * @brief Implements OP_CSV_PARSE (csv_parse(text [, options])).
+ *
+ * Behavior:
+ * - Operand 1 means an options map was passed (see csv_common.c).
+ * - Parses a whole CSV string in place with the same parser and options
+ *   as csv_open and pushes an array of all rows.
+ * - Pushes [] for non-string input.
+ */
+
+case OP_CSV_PARSE: {
+  Value opts = inst.operand ? pop_value(vm) : make_nil();
+  Value text = pop_value(vm);
+  FunCsvReader *r = text.type == VAL_STRING ? fun_csv_reader_new(NULL, -1, text.s ? text.s : "", &opts) : NULL;
+  Value *rows = NULL;
+  int count = 0, cap = 0;
+  while (r) {
+    Value row = fun_csv_reader_row(r);
+    if (row.type == VAL_NIL) break;
+    if (count == cap) {
+      int ncap = cap ? cap * 2 : 64;
+      Value *nr = (Value *)realloc(rows, sizeof(Value) * (size_t)ncap);
+      if (!nr) {
+        free_value(row);
+        break;
+      }
+      rows = nr;
+      cap = ncap;
+    }
+    rows[count++] = row;
+  }
+  fun_csv_reader_free(r);
+  free_value(text);
+  free_value(opts);
+  push_value(vm, make_array_take(rows, count));
+  free(rows);
+  break;
+}
@@ -0,0 +1,48 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file csv_read.c
+ * @brief Implements OP_CSV_READ (csv_read(reader, count)).
+ *
+ * Behavior:
+ * - Pushes an array with the next count rows (fewer near the end of input,
+ *   [] once it is exhausted). count <= 0 reads all remaining rows.
+ * - Batches amortize the per-call dispatch when ingesting large files.
+ */
+
+case OP_CSV_READ: {
+  Value nv = pop_value(vm);
+  Value hv = pop_value(vm);
+  FunCsvReader *r = (FunCsvReader *)fun_csv_acquire(FUN_CSV_READER, &hv);
+  int64_t want = nv.type == VAL_INT ? nv.i : 0;
+  free_value(nv);
+  Value *rows = NULL;
+  int64_t count = 0, cap = 0;
+  while (r && (want <= 0 || count < want)) {
+    Value row = fun_csv_reader_row(r);
+    if (row.type == VAL_NIL) break;
+    if (count == cap) {
+      int64_t ncap = cap ? cap * 2 : (want > 0 && want < 1024 ? want : 1024);
+      Value *nr = (Value *)realloc(rows, sizeof(Value) * (size_t)ncap);
+      if (!nr) {
+        free_value(row);
+        break;
+      }
+      rows = nr;
+      cap = ncap;
+    }
+    rows[count++] = row;
+  }
+  if (r) fun_csv_release(&hv);
+  free_value(hv);
+  push_value(vm, make_array_take(rows, (int)count));
+  free(rows);
+  break;
+}
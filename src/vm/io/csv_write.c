@@ -0,0 +1,37 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file csv_write.c
+ * @brief Implements OP_CSV_WRITE (csv_write(writer, row_or_rows)).
+ *
+ * Behavior:
+ * - Accepts one row (an array of fields or a map) or an array of rows.
+ * - Map rows are written in column order: the columns option, else the
+ *   keys of the first map row. The header line goes out before the first
+ *   row when the columns are known (unless header: false).
+ * - Nil fields are written empty; strings are quoted only when needed.
+ * - An empty array writes nothing (not even a blank line) and counts as 0 rows.
+ * - Pushes the number of rows written (0 for an unknown handle).
+ */
+
+case OP_CSV_WRITE: {
+  Value row = pop_value(vm);
+  Value hv = pop_value(vm);
+  FunCsvWriter *w = (FunCsvWriter *)fun_csv_acquire(FUN_CSV_WRITER, &hv);
+  int64_t n = 0;
+  if (w) {
+    n = fun_csv_writer_rows(w, &row);
+    fun_csv_release(&hv);
+  }
+  free_value(row);
+  free_value(hv);
+  push_value(vm, make_int(n));
+  break;
+}
@@ -0,0 +1,31 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file csv_writer.c
+ * @brief Implements OP_CSV_WRITER (csv_writer(path_or_fd [, options])).
+ *
+ * Behavior:
+ * - Operand 1 means an options map was passed (see csv_common.c).
+ * - A string creates (or, with append: true, appends to) that file; an int
+ *   writes to an open file descriptor, which csv_writer_close() leaves open.
+ * - Rows are buffered and written in 64 KiB blocks.
+ * - Pushes a writer handle, or 0 if the file cannot be opened.
+ */
+
+case OP_CSV_WRITER: {
+  Value opts = inst.operand ? pop_value(vm) : make_nil();
+  Value dst = pop_value(vm);
+  FunCsvWriter *w = fun_csv_writer_open(&dst, &opts);
+  int64_t id = w ? fun_csv_register(w) : 0;
+  free_value(dst);
+  free_value(opts);
+  push_value(vm, make_int(id));
+  break;
+}
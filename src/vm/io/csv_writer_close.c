@@ -0,0 +1,27 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file csv_writer_close.c
+ * @brief Implements OP_CSV_WRITER_CLOSE (csv_writer_close(writer)).
+ *
+ * Behavior:
+ * - Flushes buffered rows, closes the writer's file (a caller's descriptor
+ *   stays open) and releases the handle.
+ * - Pushes 1 if every write succeeded, 0 on a write error or for an unknown
+ *   handle.
+ */
+
+case OP_CSV_WRITER_CLOSE: {
+  Value hv = pop_value(vm);
+  int ok = fun_csv_close(FUN_CSV_WRITER, &hv);
+  free_value(hv);
+  push_value(vm, make_int(ok));
+  break;
+}
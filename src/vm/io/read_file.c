@@ -55,8 +55,25 @@ case OP_READ_FILE: {
     break;
   }
   rewind(f);
-  char *buf = (char *)malloc((size_t)sz + 1);
-  size_t n = buf ? fread(buf, 1, (size_t)sz, f) : 0;
+  /* the size is only a hint: files under /proc report 0, so read to EOF */
+  size_t cap = (size_t)sz + 1 < 4096 ? 4096 : (size_t)sz + 1;
+  char *buf = (char *)malloc(cap);
+  size_t n = 0;
+  while (buf) {
+    n += fread(buf + n, 1, cap - 1 - n, f);
+    if (n < cap - 1) break;
+    int c = fgetc(f);
+    if (c == EOF) break;
+    char *nb = (char *)realloc(buf, cap * 2);
+    if (!nb) {
+      free(buf);
+      buf = NULL;
+      break;
+    }
+    buf = nb;
+    cap *= 2;
+    buf[n++] = (char)c;
+  }
   fclose(f);
   if (!buf) {
     free_value(path);
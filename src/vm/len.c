@@ -9,7 +9,7 @@
 
 /**
  * @file len.c
- * @brief Implements the OP_LEN opcode for getting the length of arrays or strings in the VM.
+ * @brief Implements the OP_LEN opcode for getting the length of strings, arrays, maps and sets in the VM.
  *
  * This file handles the OP_LEN instruction, which retrieves the length of an array or string.
  * The array or string is popped from the stack, and the length is pushed back.
@@ -36,10 +36,10 @@ case OP_LEN: {
   } else if (a.type == VAL_ARRAY) {
     len = array_length(&a);
     if (len < 0) len = 0;
-  } else {
-    /* Be lenient: for non-array/non-string, treat length as 0 */
-    push_value(vm, make_int(0));
+  } else if (a.type == VAL_MAP || a.type == VAL_SET) {
+    len = map_count(&a);
   }
+  /* Be lenient: other types have length 0 */
   free_value(a);
   push_value(vm, make_int(len));
   break;
@@ -16,11 +16,19 @@
  * operand so that runtime errors and debugger output can reference the correct
  * line in the original program.
  *
+ * Statement boundaries are also where a pending cycle collection runs (see
+ * src/gc.h): no handler is holding borrowed values there, and where the
+ * profiler takes its samples (see vm/core/profile_common.c).
+ *
  * Stack contract: none (does not read or write the VM value stack).
  */
 
 case OP_LINE: {
+  /* a pending profiler sample belongs to the statement that just ran */
+  if (g_prof_tick) vm_profile_sample(vm, vm->fp);
   /* operand holds the source line number */
   vm->current_line = inst.operand;
+  if (vm->profile) vm->profile->line = inst.operand;
+  if (gc_pending) gc_collect();
   break;
 }
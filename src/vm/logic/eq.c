@@ -18,6 +18,7 @@
  * - Pops two values from the stack.
  * - Checks if the values are equal.
  * - Pushes 1 (true) or 0 (false) onto the stack.
+ * - Int/float operands are compared numerically in place on the stack top (1 == 1.0).
  *
  * Error Handling:
  * - Exits with an error if the operands are of incompatible types.
@@ -29,6 +30,16 @@
  */
 
 case OP_EQ: {
+  Value *na = vm_num_operands(vm);
+  if (na) {
+    /* numeric fast path: compare in place on the stack (ints and floats compare by value) */
+    int r = (na[0].type == VAL_INT && na[1].type == VAL_INT) ? (na[0].i == na[1].i)
+                                                             : (vm_num_as_double(&na[0]) == vm_num_as_double(&na[1]));
+    na[0].type = VAL_BOOL;
+    na[0].i = r;
+    vm->sp--;
+    break;
+  }
   Value b = pop_value(vm);
   Value a = pop_value(vm);
   int eq = 0;
@@ -49,6 +60,9 @@ case OP_EQ: {
     case VAL_NIL:
       eq = 1;
       break;
+    case VAL_SET:
+      eq = set_equals(&a, &b);
+      break;
     default:
       eq = 0;
       break;
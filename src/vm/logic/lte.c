@@ -18,6 +18,7 @@
  * - Pops two values from the stack.
  * - Checks if the first value is less than or equal to the second.
  * - Pushes 1 (true) or 0 (false) onto the stack.
+ * - Int/float operands (mixed allowed) are compared in place on the stack top.
  *
  * Error Handling:
  * - Exits with an error if the operands are of incompatible types.
@@ -29,6 +30,16 @@
  */
 
 case OP_LTE: {
+  Value *na = vm_num_operands(vm);
+  if (na) {
+    /* numeric fast path: compare in place on the stack */
+    int r = (na[0].type == VAL_INT && na[1].type == VAL_INT) ? (na[0].i <= na[1].i)
+                                                             : (vm_num_as_double(&na[0]) <= vm_num_as_double(&na[1]));
+    na[0].type = VAL_INT;
+    na[0].i = r;
+    vm->sp--;
+    break;
+  }
   Value b = pop_value(vm);
   Value a = pop_value(vm);
   if (a.type != VAL_INT || b.type != VAL_INT) {
@@ -0,0 +1,52 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file count_by.c
+ * @brief Implements the OP_COUNT_BY opcode (count_by(array [, key_fn])).
+ *
+ * Behavior:
+ * - Pops an array and pushes a map from each distinct item to the number of
+ *   times it occurs, in first-seen order. With a key function the parser
+ *   first maps the array through it, so the items here are the keys.
+ *
+ * Error Handling:
+ * - Exits if the argument is not an array or an item is not a string,
+ *   number or boolean.
+ *
+ * Example:
+ * - Bytecode: OP_COUNT_BY
+ * - Stack before: [["a", "b", "a"]]
+ * - Stack after: [{"a": 2, "b": 1}]
+ */
+
+case OP_COUNT_BY: {
+  Value arr = pop_value(vm);
+  if (arr.type != VAL_ARRAY) {
+    fprintf(stderr, "COUNT_BY expects array\n");
+    exit(1);
+  }
+  Value counts = make_map_empty();
+  int n = array_length(&arr);
+  for (int i = 0; i < n; ++i) {
+    Value item = array_peek_value(&arr, i);
+    Value *slot = map_slot_key(&counts, &item);
+    if (!slot) {
+      fprintf(stderr, "COUNT_BY items must be strings, numbers or booleans (got %s at %d)\n", value_type_name(item.type), i);
+      exit(1);
+    }
+    if (slot->type == VAL_INT)
+      slot->i++;
+    else
+      *slot = make_int(1);
+  }
+  free_value(arr);
+  push_value(vm, counts);
+  break;
+}
@@ -0,0 +1,57 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file group_by.c
+ * @brief Implements the OP_GROUP_BY opcode (group_by(array, key_fn)).
+ *
+ * The parser maps the array through key_fn and leaves both arrays on the
+ * stack; this opcode does the grouping.
+ *
+ * Behavior:
+ * - Pops the keys array and the items array (same length) and pushes a map
+ *   from each distinct key to the array of items with that key, keys in
+ *   first-seen order and items in their original order.
+ *
+ * Error Handling:
+ * - Exits if the arguments are not arrays or a key is not a string, number
+ *   or boolean.
+ *
+ * Example:
+ * - Bytecode: OP_GROUP_BY
+ * - Stack before: [[1, 2, 3], ["odd", "even", "odd"]]
+ * - Stack after: [{"odd": [1, 3], "even": [2]}]
+ */
+
+case OP_GROUP_BY: {
+  Value keys = pop_value(vm);
+  Value items = pop_value(vm);
+  if (keys.type != VAL_ARRAY || items.type != VAL_ARRAY) {
+    fprintf(stderr, "GROUP_BY expects (array, function)\n");
+    exit(1);
+  }
+  Value groups = make_map_empty();
+  int n = array_length(&items);
+  int nk = array_length(&keys);
+  for (int i = 0; i < n && i < nk; ++i) {
+    Value key = array_peek_value(&keys, i);
+    Value *slot = map_slot_key(&groups, &key);
+    if (!slot) {
+      fprintf(stderr, "GROUP_BY keys must be strings, numbers or booleans (got %s at %d)\n", value_type_name(key.type), i);
+      exit(1);
+    }
+    if (slot->type != VAL_ARRAY) *slot = make_array_from_values(NULL, 0);
+    Value item = array_peek_value(&items, i);
+    array_push(slot, copy_value(&item));
+  }
+  free_value(keys);
+  free_value(items);
+  push_value(vm, groups);
+  break;
+}
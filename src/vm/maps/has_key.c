@@ -12,10 +12,10 @@
  * @brief Implements the OP_HAS_KEY opcode for map key checking in the VM.
  *
  * This file handles the OP_HAS_KEY instruction, which checks if a map contains
- * a specific key.
+ * a specific key (string, number or boolean), or a set an element.
  *
  * Behavior:
- * - Pops key and map from stack
+ * - Pops key and map (or set) from stack
  * - Pushes 1 if key exists, 0 otherwise
  *
  * Error Handling:
@@ -25,11 +25,11 @@
 case OP_HAS_KEY: {
   Value key = pop_value(vm);
   Value m = pop_value(vm);
-  if (m.type != VAL_MAP || key.type != VAL_STRING) {
-    fprintf(stderr, "HAS_KEY expects (map, string)\n");
+  if (m.type != VAL_MAP && m.type != VAL_SET) {
+    fprintf(stderr, "HAS_KEY expects (map or set, key)\n");
     exit(1);
   }
-  int ok = map_has(&m, key.s ? key.s : "");
+  int ok = map_has_key(&m, &key);
   free_value(m);
   free_value(key);
   push_value(vm, make_int(ok ? 1 : 0));
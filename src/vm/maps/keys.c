@@ -30,8 +30,8 @@
 
 case OP_KEYS: {
   Value m = pop_value(vm);
-  if (m.type != VAL_MAP) {
-    fprintf(stderr, "KEYS expects map\n");
+  if (m.type != VAL_MAP && m.type != VAL_SET) {
+    fprintf(stderr, "KEYS expects map or set\n");
     exit(1);
   }
   Value arr = map_keys_array(&m);
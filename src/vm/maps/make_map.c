@@ -40,11 +40,11 @@ case OP_MAKE_MAP: {
   for (int i = 0; i < pairs; ++i) {
     Value val = pop_value(vm);
     Value key = pop_value(vm);
-    if (key.type != VAL_STRING) {
-      fprintf(stderr, "Map literal keys must be strings\n");
+    if (key.type != VAL_STRING && key.type != VAL_INT && key.type != VAL_FLOAT && key.type != VAL_BOOL) {
+      fprintf(stderr, "Map literal keys must be strings, numbers or booleans\n");
       exit(1);
     }
-    if (!map_set(&m, key.s ? key.s : "", val)) {
+    if (!map_set_key(&m, &key, val)) {
       fprintf(stderr, "Map literal set failed\n");
       exit(1);
     }
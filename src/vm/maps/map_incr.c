@@ -0,0 +1,57 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file map_incr.c
+ * @brief Implements the OP_MAP_INCR opcode (map_incr(map, key [, delta])).
+ *
+ * Behavior:
+ * - Operand 1: pops delta (a number); operand 0: delta is 1.
+ * - Pops key and map; adds delta to the value of key in place, treating a
+ *   missing key or nil as 0, and pushes the new value. The key is copied
+ *   only when it is inserted.
+ *
+ * Error Handling:
+ * - Exits if the container is not a map, the key is not a string, number
+ *   or boolean, or the stored value or delta is not a number.
+ *
+ * Example:
+ * - Bytecode: OP_MAP_INCR 0
+ * - Stack before: [{"a": 1}, "a"]
+ * - Stack after: [2]   (map is now {"a": 2})
+ */
+
+case OP_MAP_INCR: {
+  Value delta = inst.operand ? pop_value(vm) : make_int(1);
+  Value key = pop_value(vm);
+  Value m = pop_value(vm);
+  if (m.type != VAL_MAP || (delta.type != VAL_INT && delta.type != VAL_FLOAT)) {
+    fprintf(stderr, "MAP_INCR expects (map, key [, number])\n");
+    exit(1);
+  }
+  Value *slot = map_slot_key(&m, &key);
+  if (!slot) {
+    fprintf(stderr, "MAP_INCR key must be string, number or boolean (got %s)\n", value_type_name(key.type));
+    exit(1);
+  }
+  if (slot->type == VAL_NIL) *slot = make_int(0);
+  if (slot->type == VAL_INT && delta.type == VAL_INT) {
+    slot->i = (int64_t)((uint64_t)slot->i + (uint64_t)delta.i);
+  } else if (slot->type == VAL_INT || slot->type == VAL_FLOAT) {
+    *slot = make_float(vm_num_as_double(slot) + vm_num_as_double(&delta));
+  } else {
+    fprintf(stderr, "MAP_INCR value is not a number (got %s)\n", value_type_name(slot->type));
+    exit(1);
+  }
+  Value out = *slot;
+  free_value(m);
+  free_value(key);
+  push_value(vm, out);
+  break;
+}
@@ -0,0 +1,35 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file set_add.c
+ * @brief Implements the OP_SET_ADD opcode (set_add(set, value)).
+ *
+ * Behavior:
+ * - Pops value and set; adds a copy of value to the set (in place).
+ * - Pushes 1 if it was added, 0 if it was already present, -1 if it cannot
+ *   be a set element (only strings, numbers and booleans can).
+ *
+ * Error Handling:
+ * - Exits if the first argument is not a set.
+ */
+
+case OP_SET_ADD: {
+  Value v = pop_value(vm);
+  Value s = pop_value(vm);
+  if (s.type != VAL_SET) {
+    fprintf(stderr, "SET_ADD expects (set, value)\n");
+    exit(1);
+  }
+  int added = set_add(&s, &v);
+  free_value(s);
+  free_value(v);
+  push_value(vm, make_int(added));
+  break;
+}
@@ -0,0 +1,34 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file set_intersect.c
+ * @brief Implements the OP_SET_INTERSECT opcode (set_intersect(a, b)).
+ *
+ * Behavior:
+ * - Pops sets b and a; pushes a new set with the elements of a (in a's
+ *   order) that are also in b. Neither input is modified.
+ *
+ * Error Handling:
+ * - Exits if either argument is not a set.
+ */
+
+case OP_SET_INTERSECT: {
+  Value b = pop_value(vm);
+  Value a = pop_value(vm);
+  if (a.type != VAL_SET || b.type != VAL_SET) {
+    fprintf(stderr, "SET_INTERSECT expects (set, set)\n");
+    exit(1);
+  }
+  Value out = set_intersect(&a, &b);
+  free_value(a);
+  free_value(b);
+  push_value(vm, out);
+  break;
+}
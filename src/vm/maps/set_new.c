@@ -0,0 +1,43 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file set_new.c
+ * @brief Implements the OP_SET_NEW opcode (set_new([array])).
+ *
+ * Behavior:
+ * - Operand 0: pushes an empty set.
+ * - Operand 1: pops an array (or set) and pushes a set of its items, in
+ *   first-seen order; items that cannot be set elements (arrays, maps,
+ *   nil, ...) are skipped.
+ *
+ * Error Handling:
+ * - Exits if the argument is not an array or set.
+ *
+ * Example:
+ * - Bytecode: OP_SET_NEW 1
+ * - Stack before: [[3, 1, 3, "a"]]
+ * - Stack after: [{3, 1, "a"}]
+ */
+
+case OP_SET_NEW: {
+  if (inst.operand == 0) {
+    push_value(vm, make_set_empty());
+    break;
+  }
+  Value src = pop_value(vm);
+  if (src.type != VAL_ARRAY && src.type != VAL_SET) {
+    fprintf(stderr, "SET_NEW expects array or set\n");
+    exit(1);
+  }
+  Value s = set_from_values(&src);
+  free_value(src);
+  push_value(vm, s);
+  break;
+}
@@ -0,0 +1,36 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file set_remove.c
+ * @brief Implements the OP_SET_REMOVE opcode (set_remove(set, value) and
+ *        map_remove(map, key)).
+ *
+ * Behavior:
+ * - Pops key and set (or map); removes the element (or key and its value)
+ *   in place, keeping the order of the others.
+ * - Pushes 1 if it was present, 0 otherwise.
+ *
+ * Error Handling:
+ * - Exits if the first argument is not a set or map.
+ */
+
+case OP_SET_REMOVE: {
+  Value key = pop_value(vm);
+  Value s = pop_value(vm);
+  if (s.type != VAL_SET && s.type != VAL_MAP) {
+    fprintf(stderr, "SET_REMOVE expects (set or map, key)\n");
+    exit(1);
+  }
+  int removed = map_remove_key(&s, &key);
+  free_value(s);
+  free_value(key);
+  push_value(vm, make_int(removed));
+  break;
+}
@@ -0,0 +1,34 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file set_union.c
+ * @brief Implements the OP_SET_UNION opcode (set_union(a, b)).
+ *
+ * Behavior:
+ * - Pops sets b and a; pushes a new set with the elements of a followed by
+ *   the elements of b that are not in a. Neither input is modified.
+ *
+ * Error Handling:
+ * - Exits if either argument is not a set.
+ */
+
+case OP_SET_UNION: {
+  Value b = pop_value(vm);
+  Value a = pop_value(vm);
+  if (a.type != VAL_SET || b.type != VAL_SET) {
+    fprintf(stderr, "SET_UNION expects (set, set)\n");
+    exit(1);
+  }
+  Value out = set_union(&a, &b);
+  free_value(a);
+  free_value(b);
+  push_value(vm, out);
+  break;
+}
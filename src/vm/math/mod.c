@@ -18,6 +18,7 @@
  * - Pops two integer values from the stack.
  * - Computes the modulo of the first value by the second.
  * - Pushes the result onto the stack.
+ * - Int operands with a non-zero divisor are handled in place on the stack top.
  *
  * Error Handling:
  * - Exits with an error if the operands are not integers.
@@ -30,6 +31,13 @@
  */
 
 case OP_MOD: {
+  if (vm->sp >= 1 && vm->stack[vm->sp - 1].type == VAL_INT && vm->stack[vm->sp].type == VAL_INT &&
+      vm->stack[vm->sp].i != 0) {
+    /* int fast path: compute in place on the stack */
+    vm->stack[vm->sp - 1].i %= vm->stack[vm->sp].i;
+    vm->sp--;
+    break;
+  }
   Value b = pop_value(vm);
   Value a = pop_value(vm);
   if (a.type != VAL_INT || b.type != VAL_INT) {
@@ -0,0 +1,522 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file http_common.c
+ * @brief HTTP/1.1 request parser and response builder used by OP_HTTP_PARSE_REQUEST/OP_HTTP_RESPONSE.
+ *
+ * The parser is incremental in the way a non-blocking server needs it: it is
+ * handed whatever bytes have arrived for a connection and either reports a
+ * complete request plus the number of bytes it consumed (the rest belongs to
+ * the next, pipelined request) or "incomplete" together with the total buffer
+ * length worth re-parsing at, so large bodies are not rescanned per recv.
+ *
+ * Headers are located as (offset, length) slices into the input first; Fun
+ * strings are only allocated for the final request map. Chunked bodies are
+ * decoded. Request smuggling vectors (Content-Length together with
+ * Transfer-Encoding, conflicting Content-Length values, obs-fold lines) are
+ * rejected with 400, header names longer than FUN_HTTP_MAX_NAME with 431.
+ *
+ * The response builder refuses header names that are not HTTP tokens and
+ * values or reason phrases containing CR or LF, so data from a request
+ * cannot inject header lines or split the response.
+ *
+ * Limitations: Fun strings are NUL-terminated, so bodies containing NUL bytes
+ * are truncated when exposed to Fun code.
+ */
+
+#include <ctype.h>
+
+#define FUN_HTTP_MAX_HEADERS 100
+#define FUN_HTTP_MAX_HEADER_BYTES (64 * 1024)
+#define FUN_HTTP_MAX_NAME 255 /* longest accepted header name */
+
+typedef struct {
+  size_t off, len;
+} FunHttpSlice;
+
+typedef struct {
+  FunHttpSlice name, value;
+} FunHttpHeader;
+
+/** Fun string from a byte range (always NUL-terminated). */
+static Value fun_http_str(const char *p, size_t n) {
+  Value v = make_string_len(p, n);
+  if (!v.s) return make_string("");
+  return v;
+}
+
+static int fun_http_is_tchar(unsigned char c) {
+  return isalnum(c) || (c && strchr("!#$%&'*+-.^_`|~", c) != NULL);
+}
+
+static int fun_http_ieq(const char *p, size_t n, const char *lit) {
+  size_t m = strlen(lit);
+  if (n != m) return 0;
+  for (size_t i = 0; i < n; ++i)
+    if (tolower((unsigned char)p[i]) != lit[i]) return 0;
+  return 1;
+}
+
+/** Case-insensitive search for token lit in a comma separated header value. */
+static int fun_http_has_token(const char *p, size_t n, const char *lit) {
+  size_t i = 0;
+  while (i < n) {
+    while (i < n && (p[i] == ' ' || p[i] == '\t' || p[i] == ','))
+      i++;
+    size_t s = i;
+    while (i < n && p[i] != ',')
+      i++;
+    size_t e = i;
+    while (e > s && (p[e - 1] == ' ' || p[e - 1] == '\t'))
+      e--;
+    if (e > s && fun_http_ieq(p + s, e - s, lit)) return 1;
+  }
+  return 0;
+}
+
+/** Find the end of the line starting at i; returns index of '\n' or -1. */
+static long fun_http_eol(const char *buf, size_t n, size_t i) {
+  const char *nl = memchr(buf + i, '\n', n - i);
+  return nl ? (long)(nl - buf) : -1;
+}
+
+static Value fun_http_result(const char *status) {
+  Value m = make_map_empty();
+  map_set(&m, "status", make_string(status));
+  return m;
+}
+
+static Value fun_http_error(int code, const char *msg) {
+  Value m = fun_http_result("error");
+  map_set(&m, "code", make_int(code));
+  map_set(&m, "error", make_string(msg));
+  return m;
+}
+
+static Value fun_http_incomplete(size_t need) {
+  Value m = fun_http_result("incomplete");
+  map_set(&m, "need", make_int((int64_t)need));
+  return m;
+}
+
+/**
+ * @brief Decode a chunked body starting at buf[i].
+ *
+ * @return 1 when complete (*out_len bytes written to out, *end = index after
+ *         the trailers), 0 when more input is needed (*need = minimal total
+ *         length to retry at), -1 on malformed input.
+ */
+static int fun_http_dechunk(const char *buf, size_t n, size_t i, char *out, size_t *out_len, size_t *end, size_t *need) {
+  size_t o = 0;
+  for (;;) {
+    long eol = fun_http_eol(buf, n, i);
+    if (eol < 0) {
+      *need = n + 1;
+      return 0;
+    }
+    size_t sz = 0;
+    size_t k = i;
+    int digits = 0;
+    while (k < (size_t)eol && isxdigit((unsigned char)buf[k])) {
+      int c = tolower((unsigned char)buf[k]);
+      int d = c <= '9' ? c - '0' : c - 'a' + 10;
+      if (sz > ((size_t)1 << 40)) return -1;
+      sz = sz * 16 + (size_t)d;
+      k++;
+      digits++;
+    }
+    if (!digits) return -1;
+    /* skip chunk extensions up to the line end */
+    i = (size_t)eol + 1;
+    if (sz == 0) {
+      /* trailer section: header lines until an empty line */
+      for (;;) {
+        long te = fun_http_eol(buf, n, i);
+        if (te < 0) {
+          *need = n + 1;
+          return 0;
+        }
+        size_t line_len = (size_t)te - i;
+        if (line_len > 0 && buf[te - 1] == '\r') line_len--;
+        i = (size_t)te + 1;
+        if (line_len == 0) break;
+      }
+      *out_len = o;
+      *end = i;
+      return 1;
+    }
+    if (n < i + sz + 1) {
+      *need = i + sz + 2;
+      return 0;
+    }
+    if (out) memcpy(out + o, buf + i, sz);
+    o += sz;
+    i += sz;
+    /* chunk data is followed by CRLF (or bare LF) */
+    if (i < n && buf[i] == '\r') i++;
+    if (i >= n) {
+      *need = i + 1;
+      return 0;
+    }
+    if (buf[i] != '\n') return -1;
+    i++;
+  }
+}
+
+/**
+ * @brief Parse one HTTP/1.x request from the start of buf.
+ *
+ * @return Map with status "ok" (method, target, path, query, version, headers
+ *         (lower-cased names; repeats joined with ", "), body, consumed,
+ *         keep_alive, chunked), "incomplete" (need) or "error" (code, error).
+ */
+static Value fun_http_parse_request(const char *buf, size_t n) {
+  size_t i = 0;
+  /* ignore empty lines before the request line (RFC 9112 2.2) */
+  while (i < n && (buf[i] == '\r' || buf[i] == '\n'))
+    i++;
+  size_t start = i;
+
+  /* locate the end of the header section before doing any work */
+  size_t hdr_end = 0;
+  {
+    size_t k = i;
+    int found = 0;
+    while (k < n) {
+      const char *nl = memchr(buf + k, '\n', n - k);
+      if (!nl) break;
+      size_t j = (size_t)(nl - buf) + 1;
+      if (j < n && buf[j] == '\n') {
+        hdr_end = j + 1;
+        found = 1;
+        break;
+      }
+      if (j + 1 < n && buf[j] == '\r' && buf[j + 1] == '\n') {
+        hdr_end = j + 2;
+        found = 1;
+        break;
+      }
+      k = j;
+    }
+    if (!found) {
+      if (n - start > FUN_HTTP_MAX_HEADER_BYTES) return fun_http_error(431, "request header section too large");
+      return fun_http_incomplete(n + 1);
+    }
+    if (hdr_end - start > FUN_HTTP_MAX_HEADER_BYTES) return fun_http_error(431, "request header section too large");
+  }
+
+  /* request line: method SP target SP HTTP/x.y */
+  long eol = fun_http_eol(buf, n, i);
+  size_t line_end = (size_t)eol;
+  if (line_end > i && buf[line_end - 1] == '\r') line_end--;
+  FunHttpSlice method = {i, 0};
+  while (i < line_end && fun_http_is_tchar((unsigned char)buf[i]))
+    i++;
+  method.len = i - method.off;
+  if (method.len == 0 || i >= line_end || buf[i] != ' ') return fun_http_error(400, "malformed request line");
+  i++;
+  FunHttpSlice target = {i, 0};
+  while (i < line_end && buf[i] != ' ') {
+    if ((unsigned char)buf[i] < 0x21 || buf[i] == 0x7f) return fun_http_error(400, "invalid character in request target");
+    i++;
+  }
+  target.len = i - target.off;
+  if (target.len == 0 || i >= line_end) return fun_http_error(400, "malformed request line");
+  i++;
+  FunHttpSlice version = {i, line_end - i};
+  if (version.len != 8 || memcmp(buf + i, "HTTP/1.", 7) != 0 || (buf[i + 7] != '0' && buf[i + 7] != '1'))
+    return fun_http_error(505, "unsupported HTTP version");
+  int minor = buf[i + 7] - '0';
+  i = (size_t)eol + 1;
+
+  /* header lines as slices */
+  FunHttpHeader hdrs[FUN_HTTP_MAX_HEADERS];
+  int nh = 0;
+  long content_length = -1;
+  int chunked = 0, has_te = 0, conn_close = 0, conn_keep = 0;
+  while (i < hdr_end) {
+    long le = fun_http_eol(buf, n, i);
+    size_t end = (size_t)le;
+    if (end > i && buf[end - 1] == '\r') end--;
+    if (end == i) break; /* blank line */
+    if (buf[i] == ' ' || buf[i] == '\t') return fun_http_error(400, "obsolete header line folding");
+    size_t c = i;
+    while (c < end && fun_http_is_tchar((unsigned char)buf[c]))
+      c++;
+    if (c == i || c >= end || buf[c] != ':') return fun_http_error(400, "malformed header line");
+    if (nh == FUN_HTTP_MAX_HEADERS) return fun_http_error(431, "too many request headers");
+    if (c - i > FUN_HTTP_MAX_NAME) return fun_http_error(431, "request header name too long");
+    size_t vs = c + 1, ve = end;
+    while (vs < ve && (buf[vs] == ' ' || buf[vs] == '\t'))
+      vs++;
+    while (ve > vs && (buf[ve - 1] == ' ' || buf[ve - 1] == '\t'))
+      ve--;
+    FunHttpHeader *h = &hdrs[nh++];
+    h->name.off = i;
+    h->name.len = c - i;
+    h->value.off = vs;
+    h->value.len = ve - vs;
+
+    const char *nm = buf + h->name.off;
+    const char *val = buf + vs;
+    if (fun_http_ieq(nm, h->name.len, "content-length")) {
+      long v = 0;
+      if (ve == vs) return fun_http_error(400, "invalid Content-Length");
+      for (size_t k = vs; k < ve; ++k) {
+        if (!isdigit((unsigned char)buf[k]) || v > 1000000000L) return fun_http_error(400, "invalid Content-Length");
+        v = v * 10 + (buf[k] - '0');
+      }
+      if (content_length >= 0 && content_length != v) return fun_http_error(400, "conflicting Content-Length");
+      content_length = v;
+    } else if (fun_http_ieq(nm, h->name.len, "transfer-encoding")) {
+      has_te = 1;
+      /* chunked must be the final coding */
+      size_t k = ve;
+      while (k > vs && val[k - vs - 1] != ',')
+        k--;
+      size_t ls = k;
+      while (ls < ve && (buf[ls] == ' ' || buf[ls] == '\t'))
+        ls++;
+      chunked = fun_http_ieq(buf + ls, ve - ls, "chunked");
+      if (!chunked) return fun_http_error(501, "unsupported Transfer-Encoding");
+    } else if (fun_http_ieq(nm, h->name.len, "connection")) {
+      if (fun_http_has_token(val, ve - vs, "close")) conn_close = 1;
+      if (fun_http_has_token(val, ve - vs, "keep-alive")) conn_keep = 1;
+    }
+    i = (size_t)le + 1;
+  }
+  if (has_te && content_length >= 0) return fun_http_error(400, "both Content-Length and Transfer-Encoding");
+  if (has_te && minor == 0) return fun_http_error(400, "Transfer-Encoding in HTTP/1.0 request");
+
+  /* body */
+  size_t body_off = hdr_end, body_len = 0, consumed = hdr_end;
+  char *decoded = NULL;
+  if (chunked) {
+    size_t need = 0, end = 0, out_len = 0;
+    int r = fun_http_dechunk(buf, n, hdr_end, NULL, &out_len, &end, &need);
+    if (r == 0) return fun_http_incomplete(need);
+    if (r < 0) return fun_http_error(400, "malformed chunked body");
+    decoded = (char *)malloc(out_len + 1);
+    if (!decoded) return fun_http_error(500, "out of memory");
+    fun_http_dechunk(buf, n, hdr_end, decoded, &out_len, &end, &need);
+    body_len = out_len;
+    consumed = end;
+  } else if (content_length > 0) {
+    if (n < hdr_end + (size_t)content_length) return fun_http_incomplete(hdr_end + (size_t)content_length);
+    body_len = (size_t)content_length;
+    consumed = hdr_end + body_len;
+  }
+
+  Value m = fun_http_result("ok");
+  map_set(&m, "method", fun_http_str(buf + method.off, method.len));
+  map_set(&m, "target", fun_http_str(buf + target.off, target.len));
+  const char *q = memchr(buf + target.off, '?', target.len);
+  size_t path_len = q ? (size_t)(q - (buf + target.off)) : target.len;
+  map_set(&m, "path", fun_http_str(buf + target.off, path_len));
+  map_set(&m, "query", q ? fun_http_str(q + 1, target.len - path_len - 1) : make_string(""));
+  map_set(&m, "version", fun_http_str(buf + version.off, version.len));
+
+  Value headers = make_map_empty();
+  char key[FUN_HTTP_MAX_NAME + 1];
+  for (int k = 0; k < nh; ++k) {
+    size_t kl = hdrs[k].name.len; /* <= FUN_HTTP_MAX_NAME, checked above */
+    for (size_t c = 0; c < kl; ++c)
+      key[c] = (char)tolower((unsigned char)buf[hdrs[k].name.off + c]);
+    key[kl] = '\0';
+    Value prev;
+    if (map_get_copy(&headers, key, &prev) && prev.type == VAL_STRING) {
+      /* repeated field: combine as a comma separated list */
+      size_t pl = strlen(prev.s), vl = hdrs[k].value.len;
+      Value joined = make_string_len(NULL, pl + 2 + vl);
+      if (joined.s) {
+        memcpy(joined.s, prev.s, pl);
+        memcpy(joined.s + pl, ", ", 2);
+        memcpy(joined.s + pl + 2, buf + hdrs[k].value.off, vl);
+        map_set(&headers, key, joined);
+      }
+      free_value(prev);
+    } else {
+      map_set(&headers, key, fun_http_str(buf + hdrs[k].value.off, hdrs[k].value.len));
+    }
+  }
+  map_set(&m, "headers", headers);
+  map_set(&m, "body", decoded ? fun_http_str(decoded, body_len) : fun_http_str(buf + body_off, body_len));
+  free(decoded);
+  map_set(&m, "consumed", make_int((int64_t)consumed));
+  int keep = minor == 1 ? !conn_close : (conn_keep && !conn_close);
+  map_set(&m, "keep_alive", make_int(keep));
+  map_set(&m, "chunked", make_int(chunked));
+  return m;
+}
+
+static const char *fun_http_reason(int code) {
+  switch (code) {
+  case 100: return "Continue";
+  case 101: return "Switching Protocols";
+  case 200: return "OK";
+  case 201: return "Created";
+  case 202: return "Accepted";
+  case 204: return "No Content";
+  case 206: return "Partial Content";
+  case 301: return "Moved Permanently";
+  case 302: return "Found";
+  case 303: return "See Other";
+  case 304: return "Not Modified";
+  case 307: return "Temporary Redirect";
+  case 308: return "Permanent Redirect";
+  case 400: return "Bad Request";
+  case 401: return "Unauthorized";
+  case 403: return "Forbidden";
+  case 404: return "Not Found";
+  case 405: return "Method Not Allowed";
+  case 408: return "Request Timeout";
+  case 411: return "Length Required";
+  case 413: return "Content Too Large";
+  case 414: return "URI Too Long";
+  case 415: return "Unsupported Media Type";
+  case 429: return "Too Many Requests";
+  case 431: return "Request Header Fields Too Large";
+  case 500: return "Internal Server Error";
+  case 501: return "Not Implemented";
+  case 502: return "Bad Gateway";
+  case 503: return "Service Unavailable";
+  case 505: return "HTTP Version Not Supported";
+  default: return "Unknown";
+  }
+}
+
+typedef struct {
+  Value str; /* string Value being filled; room for cap - 1 bytes */
+  size_t len, cap;
+} FunHttpBuf;
+
+static int fun_http_put(FunHttpBuf *b, const char *s, size_t n) {
+  if (b->len + n + 1 > b->cap) {
+    size_t ncap = b->cap ? b->cap : 256;
+    while (ncap < b->len + n + 1)
+      ncap *= 2;
+    Value ns = make_string_len(NULL, ncap - 1);
+    if (!ns.s) return 0;
+    if (b->len) memcpy(ns.s, b->str.s, b->len);
+    free_value(b->str);
+    b->str = ns;
+    b->cap = ncap;
+  }
+  memcpy(b->str.s + b->len, s, n);
+  b->len += n;
+  b->str.s[b->len] = '\0';
+  return 1;
+}
+
+/** 1 if s[0..n) holds no CR or LF (a header value or reason phrase stays one line). */
+static int fun_http_one_line(const char *s, size_t n) {
+  return memchr(s, '\r', n) == NULL && memchr(s, '\n', n) == NULL;
+}
+
+/**
+ * Check header names (non-empty tokens) and values (no CR/LF) of a headers
+ * map; returns the first offending name, or NULL when all are valid.
+ */
+static const char *fun_http_bad_header(const Value *headers) {
+  if (!headers || headers->type != VAL_MAP || !headers->map) return NULL;
+  int nh = map_count(headers);
+  for (int k = 0; k < nh; ++k) {
+    const Value *key = map_peek_key(headers, k);
+    if (key->type != VAL_STRING) continue;
+    const char *name = key->s ? key->s : "";
+    int ok = name[0] != '\0';
+    for (const char *c = name; ok && *c; ++c)
+      ok = fun_http_is_tchar((unsigned char)*c);
+    const Value *v = map_peek_val(headers, k);
+    if (ok && v->type == VAL_STRING) {
+      ok = !v->s || fun_http_one_line(v->s, strlen(v->s));
+    } else if (ok) {
+      char *val = value_to_string_alloc(v);
+      ok = !val || fun_http_one_line(val, strlen(val));
+      free(val);
+    }
+    if (!ok) return name;
+  }
+  return NULL;
+}
+
+/**
+ * @brief Serialize a response: status line, headers (map or nil), Content-Length,
+ *        Connection (unless given) and body, in one allocation.
+ *
+ * Content-Length is computed from body; only a NULL body (headers for a
+ * payload sent separately, e.g. with sock_sendfile) keeps a given one.
+ * reason replaces the standard reason phrase when non-NULL and non-empty.
+ * A header that is not a token or a value/reason with CR or LF is reported
+ * on stderr and the result is a bodiless 500 response with Connection: close.
+ */
+static Value fun_http_response(int status, const Value *headers, const char *body, int keep_alive, const char *reason) {
+  const char *bad = fun_http_bad_header(headers);
+  if (bad || (reason && !fun_http_one_line(reason, strlen(reason)))) {
+    if (bad)
+      fprintf(stderr, "Runtime error: http_response header '%.64s' has an invalid name or a CR/LF in its value\n", bad);
+    else
+      fprintf(stderr, "Runtime error: http_response reason contains CR or LF\n");
+    return fun_http_response(500, NULL, "", 0, NULL);
+  }
+  FunHttpBuf b;
+  size_t body_len = body ? strlen(body) : 0;
+  b.len = 0;
+  b.cap = body_len + 256; /* room for a typical header block: usually one allocation */
+  b.str = make_string_len(NULL, b.cap - 1);
+  if (b.str.s)
+    b.str.s[0] = '\0';
+  else
+    b.cap = 0;
+  char line[128];
+  int has_conn = 0, has_ctype = 0, has_clen = 0;
+  snprintf(line, sizeof(line), "HTTP/1.1 %d ", status);
+  fun_http_put(&b, line, strlen(line));
+  if (!reason || !*reason) reason = fun_http_reason(status);
+  fun_http_put(&b, reason, strlen(reason));
+  fun_http_put(&b, "\r\n", 2);
+  if (headers && headers->type == VAL_MAP && headers->map) {
+    int nh = map_count(headers);
+    for (int k = 0; k < nh; ++k) {
+      const Value *key = map_peek_key(headers, k);
+      if (key->type != VAL_STRING) continue;
+      const char *name = key->s;
+      size_t nl = strlen(name);
+      if (fun_http_ieq(name, nl, "content-length")) {
+        if (body) continue; /* computed below */
+        has_clen = 1;
+      }
+      if (fun_http_ieq(name, nl, "connection")) has_conn = 1;
+      if (fun_http_ieq(name, nl, "content-type")) has_ctype = 1;
+      char *val = value_to_string_alloc(map_peek_val(headers, k));
+      fun_http_put(&b, name, nl);
+      fun_http_put(&b, ": ", 2);
+      if (val) fun_http_put(&b, val, strlen(val));
+      fun_http_put(&b, "\r\n", 2);
+      free(val);
+    }
+  }
+  if (!has_ctype && body_len > 0) {
+    const char *ct = "Content-Type: text/html; charset=utf-8\r\n";
+    fun_http_put(&b, ct, strlen(ct));
+  }
+  if (!has_conn) {
+    const char *c = keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+    fun_http_put(&b, c, strlen(c));
+  }
+  if (has_clen)
+    snprintf(line, sizeof(line), "\r\n");
+  else
+    snprintf(line, sizeof(line), "Content-Length: %zu\r\n\r\n", body_len);
+  fun_http_put(&b, line, strlen(line));
+  if (body_len) fun_http_put(&b, body, body_len);
+  if (!b.str.s) return make_string("");
+  return b.str;
+}
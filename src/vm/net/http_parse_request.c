@@ -0,0 +1,46 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file http_parse_request.c
+ * @brief Implements OP_HTTP_PARSE_REQUEST (http_parse_request(buf)).
+ *
+ * Behavior:
+ * - Pops a string holding the bytes received so far on a connection, or a
+ *   socket buffer handle (sock_buf_new), which is parsed in place; drop the
+ *   request afterwards with sock_buf_consume(buf, consumed).
+ * - Pushes a map whose "status" is:
+ *   - "ok": method, target, path, query, version, headers (lower-cased
+ *     names), body (chunked bodies decoded), consumed (bytes used; the rest
+ *     of buf starts the next pipelined request), keep_alive (1/0), chunked.
+ *   - "incomplete": need (buffer length worth parsing again at).
+ *   - "error": code (400/431/501/505) and error message.
+ *
+ * Errors:
+ * - Any other argument (or an unknown buffer) prints a type error and pushes
+ *   an "error" map.
+ */
+
+case OP_HTTP_PARSE_REQUEST: {
+  Value bufv = pop_value(vm);
+  Value res;
+  FunSockBuf *sb = bufv.type == VAL_INT ? fun_sockbuf_acquire(bufv.i) : NULL;
+  if (sb) {
+    res = fun_http_parse_request(sb->data + sb->start, sb->len);
+    fun_sockbuf_release(bufv.i);
+  } else if (bufv.type == VAL_STRING && bufv.s) {
+    res = fun_http_parse_request(bufv.s, strlen(bufv.s));
+  } else {
+    fprintf(stderr, "Runtime type error: http_parse_request expects a string or socket buffer\n");
+    res = fun_http_error(400, "http_parse_request expects a string or socket buffer");
+  }
+  free_value(bufv);
+  push_value(vm, res);
+  break;
+}
@@ -0,0 +1,56 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file http_response.c
+ * @brief Implements OP_HTTP_RESPONSE (http_response(status, headers, body, keep_alive [, reason])).
+ *
+ * Behavior:
+ * - Operand 1 means a reason phrase was passed; it is popped first. A nil
+ *   or empty reason uses the standard phrase for the status.
+ * - Pops keep_alive (int/bool), body (string; other values are stringified),
+ *   headers (map of name -> value, or nil) and status (int).
+ * - Pushes "HTTP/1.1 <status> <reason>" followed by the headers, a computed
+ *   Content-Length, Connection (keep-alive/close unless given in headers),
+ *   a default text/html Content-Type for non-empty bodies, and the body.
+ * - With a nil body a Content-Length given in headers is kept, so the headers
+ *   can precede a payload sent separately (sock_sendfile).
+ *
+ * Errors:
+ * - A non-int status prints a type error and is treated as 500.
+ * - A header name that is not an HTTP token, or a header value or reason
+ *   containing CR or LF, prints a runtime error and yields a bodiless 500
+ *   response (Connection: close) instead of the requested one.
+ */
+
+case OP_HTTP_RESPONSE: {
+  Value reasonv = inst.operand ? pop_value(vm) : make_nil();
+  Value kav = pop_value(vm);
+  Value bodyv = pop_value(vm);
+  Value hv = pop_value(vm);
+  Value sv = pop_value(vm);
+  int status = 500;
+  if (sv.type == VAL_INT)
+    status = (int)sv.i;
+  else
+    fprintf(stderr, "Runtime type error: http_response expects an int status\n");
+  char *body = bodyv.type == VAL_STRING ? NULL : (bodyv.type == VAL_NIL ? NULL : value_to_string_alloc(&bodyv));
+  const char *bp = bodyv.type == VAL_STRING ? bodyv.s : body;
+  char *reason = reasonv.type == VAL_NIL ? NULL : value_to_string_alloc(&reasonv);
+  Value res = fun_http_response(status, &hv, bp, value_is_truthy(&kav), reason);
+  free(reason);
+  free(body);
+  free_value(reasonv);
+  free_value(kav);
+  free_value(bodyv);
+  free_value(hv);
+  free_value(sv);
+  push_value(vm, res);
+  break;
+}
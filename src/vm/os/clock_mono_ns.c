@@ -0,0 +1,37 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file clock_mono_ns.c
+ * @brief Implements OP_CLOCK_MONO_NS to push the monotonic clock in ns.
+ *
+ * For timing intervals shorter than clock_mono_ms() resolves. Falls back to
+ * clock() (process time) where CLOCK_MONOTONIC is not available.
+ *
+ * Example:
+ * - OP_CLOCK_MONO_NS
+ * - Stack before: []
+ * - Stack after: [int ns]
+ */
+
+case OP_CLOCK_MONO_NS: {
+  int64_t ns;
+#if defined(CLOCK_MONOTONIC) && !defined(_WIN32)
+  struct timespec ts;
+  if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) {
+    ns = (int64_t)ts.tv_sec * 1000000000 + (int64_t)ts.tv_nsec;
+  } else {
+    ns = (int64_t)clock() * (1000000000 / CLOCKS_PER_SEC);
+  }
+#else
+  ns = (int64_t)clock() * (1000000000 / CLOCKS_PER_SEC);
+#endif
+  push_value(vm, make_int(ns));
+  break;
+}
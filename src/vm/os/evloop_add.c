@@ -0,0 +1,38 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file evloop_add.c
+ * @brief Implements OP_EVLOOP_ADD for event loop handles.
+ *
+ * Behavior:
+ * - Pops events (int), fd (int) and loop (int).
+ * - Registers fd with the loop for the given events (1 = read, 2 = write, 3 = both).
+ * - Pushes 1 on success, 0 if the loop is unknown, the fd is already registered or the OS rejects it.
+ *
+ * Errors:
+ * - If types are wrong, prints an error and pushes 0.
+ */
+
+case OP_EVLOOP_ADD: {
+  Value evv = pop_value(vm);
+  Value fdv = pop_value(vm);
+  Value lv = pop_value(vm);
+  int ok = 0;
+  if (lv.type != VAL_INT || fdv.type != VAL_INT || evv.type != VAL_INT) {
+    fprintf(stderr, "Runtime type error: evloop_add expects (int loop, int fd, int events)\n");
+  } else {
+    ok = fun_evloop_ctl(lv.i, 0, (int)fdv.i, (int)evv.i);
+  }
+  free_value(evv);
+  free_value(fdv);
+  free_value(lv);
+  push_value(vm, make_int(ok));
+  break;
+}
@@ -0,0 +1,25 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file evloop_close.c
+ * @brief Implements OP_EVLOOP_CLOSE to free an event loop handle.
+ *
+ * Behavior:
+ * - Pops loop (int); releases the loop (registered fds stay open).
+ * - Pushes 1 on success, 0 if the handle is unknown or already closed.
+ */
+
+case OP_EVLOOP_CLOSE: {
+  Value lv = pop_value(vm);
+  int ok = lv.type == VAL_INT ? fun_evloop_close(lv.i) : 0;
+  free_value(lv);
+  push_value(vm, make_int(ok));
+  break;
+}
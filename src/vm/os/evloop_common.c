@@ -0,0 +1,249 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file evloop_common.c
+ * @brief Event loop handle registry used by the OP_EVLOOP_* opcodes.
+ *
+ * An event loop holds a set of file descriptors with the events they wait for
+ * and reports the ready ones with a single wait call, so a scheduler with many
+ * idle connections costs one syscall per tick instead of one poll() per fd.
+ *
+ * Backends:
+ * - Linux: epoll (level-triggered, so semantics match poll()).
+ * - Other UNIX platforms, or when built with FUN_EVLOOP_POLL: one poll() over
+ *   an array of pollfds; an fd -> slot index keeps add/mod/del O(1).
+ * - Non-UNIX platforms: every call fails (handles are never created).
+ *
+ * Event bits (as seen by Fun code): 1 = read, 2 = write, 4 = error/hangup
+ * (reported only by wait).
+ *
+ * Loops live in the g_evloops handle table (src/handles.c). Every operation
+ * borrows the loop with fun_handle_acquire(), so evloop_close from another
+ * thread invalidates the id at once but releases the loop only after a
+ * running evloop_wait returns. One loop should still be driven by one thread
+ * at a time; separate loops are independent.
+ */
+
+#include <errno.h>
+
+#define FUN_EV_READ 1
+#define FUN_EV_WRITE 2
+#define FUN_EV_ERROR 4
+
+#if defined(__linux__) && !defined(FUN_EVLOOP_POLL)
+#define FUN_EVLOOP_EPOLL 1
+#include <sys/epoll.h>
+#endif
+
+/* upper bound for evloop_wait's max_events (size of the per-loop buffer) */
+#define FUN_EVLOOP_MAX_EVENTS 4096
+
+typedef struct {
+#ifdef FUN_EVLOOP_EPOLL
+  int epfd;
+  struct epoll_event *evs; /* wait buffer */
+  int evs_cap;
+#elif defined(__unix__)
+  struct pollfd *pfds; /* registered fds */
+  int npfds;
+  int pfds_cap;
+  int *slot_of; /* fd -> index in pfds, -1 when not registered */
+  int slot_of_cap;
+#endif
+} FunEvLoop;
+
+/** Handle table destructor: release the loop. Registered fds are not closed. */
+static void fun_evloop_destroy(void *p) {
+  FunEvLoop *l = (FunEvLoop *)p;
+#ifdef FUN_EVLOOP_EPOLL
+  close(l->epfd);
+  free(l->evs);
+#elif defined(__unix__)
+  free(l->pfds);
+  free(l->slot_of);
+#endif
+  free(l);
+}
+
+static FunHandleTable g_evloops = FUN_HANDLE_TABLE_INIT(fun_evloop_destroy);
+
+/** Create a loop; returns handle (>0) or 0 on failure/unsupported platform. */
+static int64_t fun_evloop_new(void) {
+#ifdef __unix__
+  FunEvLoop *l = (FunEvLoop *)calloc(1, sizeof(FunEvLoop));
+  if (!l) return 0;
+#ifdef FUN_EVLOOP_EPOLL
+  l->epfd = epoll_create1(EPOLL_CLOEXEC);
+  if (l->epfd < 0) {
+    free(l);
+    return 0;
+  }
+#endif
+  int64_t id = fun_handle_new(&g_evloops, l);
+  if (!id) fun_evloop_destroy(l);
+  return id;
+#else
+  return 0;
+#endif
+}
+
+#if defined(__unix__) && !defined(FUN_EVLOOP_EPOLL)
+static short fun_evloop_to_poll(int events) {
+  short e = 0;
+  if (events & FUN_EV_READ) e |= POLLIN;
+  if (events & FUN_EV_WRITE) e |= POLLOUT;
+  return e;
+}
+#endif
+
+/** fun_evloop_ctl() on a borrowed loop. */
+static int fun_evloop_ctl_on(FunEvLoop *l, int op, int fd, int events) {
+#ifdef FUN_EVLOOP_EPOLL
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  if (events & FUN_EV_READ) ev.events |= EPOLLIN;
+  if (events & FUN_EV_WRITE) ev.events |= EPOLLOUT;
+  ev.data.fd = fd;
+  int eop = op == 0 ? EPOLL_CTL_ADD : (op == 1 ? EPOLL_CTL_MOD : EPOLL_CTL_DEL);
+  return epoll_ctl(l->epfd, eop, fd, &ev) == 0 ? 1 : 0;
+#elif defined(__unix__)
+  int idx = fd < l->slot_of_cap ? l->slot_of[fd] : -1;
+  if (op == 0) {
+    if (idx >= 0) return 0;
+    if (fd >= l->slot_of_cap) {
+      int ncap = l->slot_of_cap ? l->slot_of_cap : 64;
+      while (ncap <= fd)
+        ncap *= 2;
+      int *ns = (int *)realloc(l->slot_of, sizeof(int) * (size_t)ncap);
+      if (!ns) return 0;
+      for (int i = l->slot_of_cap; i < ncap; ++i)
+        ns[i] = -1;
+      l->slot_of = ns;
+      l->slot_of_cap = ncap;
+    }
+    if (l->npfds == l->pfds_cap) {
+      int ncap = l->pfds_cap ? l->pfds_cap * 2 : 16;
+      struct pollfd *np = (struct pollfd *)realloc(l->pfds, sizeof(struct pollfd) * (size_t)ncap);
+      if (!np) return 0;
+      l->pfds = np;
+      l->pfds_cap = ncap;
+    }
+    l->pfds[l->npfds].fd = fd;
+    l->pfds[l->npfds].events = fun_evloop_to_poll(events);
+    l->pfds[l->npfds].revents = 0;
+    l->slot_of[fd] = l->npfds++;
+    return 1;
+  }
+  if (idx < 0) return 0;
+  if (op == 1) {
+    l->pfds[idx].events = fun_evloop_to_poll(events);
+    return 1;
+  }
+  /* unregister: move the last entry into the hole */
+  l->pfds[idx] = l->pfds[--l->npfds];
+  if (idx < l->npfds) l->slot_of[l->pfds[idx].fd] = idx;
+  l->slot_of[fd] = -1;
+  return 1;
+#else
+  (void)l;
+  (void)op;
+  (void)fd;
+  (void)events;
+  return 0;
+#endif
+}
+
+/**
+ * @brief Register (op 0), modify (op 1) or unregister (op 2) fd.
+ * @return 1 on success, 0 on error (unknown loop, fd already/not registered, OS error).
+ */
+static int fun_evloop_ctl(int64_t id, int op, int fd, int events) {
+  if (fd < 0) return 0;
+  FunEvLoop *l = (FunEvLoop *)fun_handle_acquire(&g_evloops, id);
+  if (!l) return 0;
+  int ok = fun_evloop_ctl_on(l, op, fd, events);
+  fun_handle_release(&g_evloops, id);
+  return ok;
+}
+
+/** fun_evloop_wait() on a borrowed loop; max_events is already clamped. */
+static Value fun_evloop_wait_on(FunEvLoop *l, int timeout_ms, int max_events) {
+#ifdef FUN_EVLOOP_EPOLL
+  if (max_events > l->evs_cap) {
+    struct epoll_event *ne = (struct epoll_event *)realloc(l->evs, sizeof(struct epoll_event) * (size_t)max_events);
+    if (!ne) return make_nil();
+    l->evs = ne;
+    l->evs_cap = max_events;
+  }
+  int n;
+  do {
+    n = epoll_wait(l->epfd, l->evs, max_events, timeout_ms);
+  } while (n < 0 && errno == EINTR);
+  if (n < 0) return make_nil();
+  Value out = make_array_from_values(NULL, 0);
+  for (int i = 0; i < n; ++i) {
+    uint32_t e = l->evs[i].events;
+    int bits = 0;
+    if (e & EPOLLIN) bits |= FUN_EV_READ;
+    if (e & EPOLLOUT) bits |= FUN_EV_WRITE;
+    if (e & (EPOLLERR | EPOLLHUP)) bits |= FUN_EV_ERROR;
+    Value pair[2] = {make_int(l->evs[i].data.fd), make_int(bits)};
+    array_push(&out, make_array_from_values(pair, 2));
+  }
+  return out;
+#elif defined(__unix__)
+  int n;
+  do {
+    n = poll(l->pfds, (nfds_t)l->npfds, timeout_ms);
+  } while (n < 0 && errno == EINTR);
+  if (n < 0) return make_nil();
+  Value out = make_array_from_values(NULL, 0);
+  for (int i = 0; i < l->npfds && n > 0 && max_events > 0; ++i) {
+    short e = l->pfds[i].revents;
+    if (!e) continue;
+    n--;
+    max_events--;
+    int bits = 0;
+    if (e & POLLIN) bits |= FUN_EV_READ;
+    if (e & POLLOUT) bits |= FUN_EV_WRITE;
+    if (e & (POLLERR | POLLHUP | POLLNVAL)) bits |= FUN_EV_ERROR;
+    Value pair[2] = {make_int(l->pfds[i].fd), make_int(bits)};
+    array_push(&out, make_array_from_values(pair, 2));
+  }
+  return out;
+#else
+  (void)l;
+  (void)timeout_ms;
+  (void)max_events;
+  return make_nil();
+#endif
+}
+
+/**
+ * @brief Wait up to timeout_ms (-1 = forever) for at most max_events ready fds.
+ *
+ * max_events <= 0 means 64; larger values are clamped to FUN_EVLOOP_MAX_EVENTS
+ * (the remaining ready fds are reported by the next wait).
+ * @return Array of [fd, events] pairs (empty on timeout), or nil on error.
+ */
+static Value fun_evloop_wait(int64_t id, int timeout_ms, int max_events) {
+  if (max_events <= 0) max_events = 64;
+  if (max_events > FUN_EVLOOP_MAX_EVENTS) max_events = FUN_EVLOOP_MAX_EVENTS;
+  FunEvLoop *l = (FunEvLoop *)fun_handle_acquire(&g_evloops, id);
+  if (!l) return make_nil();
+  Value out = fun_evloop_wait_on(l, timeout_ms, max_events);
+  fun_handle_release(&g_evloops, id);
+  return out;
+}
+
+/** Close a loop; returns 1/0. Registered fds are not closed. */
+static int fun_evloop_close(int64_t id) {
+  return fun_handle_free(&g_evloops, id);
+}
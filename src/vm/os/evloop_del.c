@@ -0,0 +1,36 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file evloop_del.c
+ * @brief Implements OP_EVLOOP_DEL to unregister an fd from an event loop.
+ *
+ * Behavior:
+ * - Pops fd (int) and loop (int); removes fd from the loop's interest set.
+ * - Pushes 1 on success, 0 if the loop is unknown or fd is not registered.
+ * - Unregister fds before closing them (epoll forgets closed fds, poll() does not).
+ *
+ * Errors:
+ * - If types are wrong, prints an error and pushes 0.
+ */
+
+case OP_EVLOOP_DEL: {
+  Value fdv = pop_value(vm);
+  Value lv = pop_value(vm);
+  int ok = 0;
+  if (lv.type != VAL_INT || fdv.type != VAL_INT) {
+    fprintf(stderr, "Runtime type error: evloop_del expects (int loop, int fd)\n");
+  } else {
+    ok = fun_evloop_ctl(lv.i, 2, (int)fdv.i, 0);
+  }
+  free_value(fdv);
+  free_value(lv);
+  push_value(vm, make_int(ok));
+  break;
+}
@@ -0,0 +1,38 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file evloop_mod.c
+ * @brief Implements OP_EVLOOP_MOD for event loop handles.
+ *
+ * Behavior:
+ * - Pops events (int), fd (int) and loop (int).
+ * - Replaces the events a registered fd waits for.
+ * - Pushes 1 on success, 0 if the loop is unknown, the fd is not registered or the OS rejects it.
+ *
+ * Errors:
+ * - If types are wrong, prints an error and pushes 0.
+ */
+
+case OP_EVLOOP_MOD: {
+  Value evv = pop_value(vm);
+  Value fdv = pop_value(vm);
+  Value lv = pop_value(vm);
+  int ok = 0;
+  if (lv.type != VAL_INT || fdv.type != VAL_INT || evv.type != VAL_INT) {
+    fprintf(stderr, "Runtime type error: evloop_mod expects (int loop, int fd, int events)\n");
+  } else {
+    ok = fun_evloop_ctl(lv.i, 1, (int)fdv.i, (int)evv.i);
+  }
+  free_value(evv);
+  free_value(fdv);
+  free_value(lv);
+  push_value(vm, make_int(ok));
+  break;
+}
@@ -0,0 +1,22 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file evloop_new.c
+ * @brief Implements OP_EVLOOP_NEW to create an event loop handle.
+ *
+ * Behavior:
+ * - Pushes a new event loop handle (int > 0) backed by epoll on Linux and poll() elsewhere.
+ * - Pushes 0 if the loop cannot be created or the platform is unsupported.
+ */
+
+case OP_EVLOOP_NEW: {
+  push_value(vm, make_int(fun_evloop_new()));
+  break;
+}
@@ -0,0 +1,40 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file evloop_wait.c
+ * @brief Implements OP_EVLOOP_WAIT to collect ready fds from an event loop.
+ *
+ * Behavior:
+ * - Pops max_events (int), timeout_ms (int, -1 = no timeout) and loop (int).
+ * - Blocks until at least one registered fd is ready or the timeout expires.
+ * - Pushes an array of [fd, events] pairs (events: 1 = read, 2 = write,
+ *   4 = error/hangup, or-ed); an empty array on timeout.
+ * - max_events <= 0 means 64.
+ *
+ * Errors:
+ * - Pushes nil if the loop is unknown or the wait fails; wrong types print an error.
+ */
+
+case OP_EVLOOP_WAIT: {
+  Value maxv = pop_value(vm);
+  Value tov = pop_value(vm);
+  Value lv = pop_value(vm);
+  Value res = make_nil();
+  if (lv.type != VAL_INT || tov.type != VAL_INT || maxv.type != VAL_INT) {
+    fprintf(stderr, "Runtime type error: evloop_wait expects (int loop, int timeout_ms, int max_events)\n");
+  } else {
+    res = fun_evloop_wait(lv.i, (int)tov.i, (int)maxv.i);
+  }
+  free_value(maxv);
+  free_value(tov);
+  free_value(lv);
+  push_value(vm, res);
+  break;
+}
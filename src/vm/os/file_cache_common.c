@@ -0,0 +1,210 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file file_cache_common.c
+ * @brief Open file descriptor cache and sendfile helper used by OP_SOCK_SENDFILE/OP_FILE_CACHE_STAT.
+ *
+ * Static file servers send the same few files over and over. The cache keeps
+ * them open together with their stat() metadata so a request costs no
+ * open/fstat/close, and the data goes from the page cache to the socket with
+ * sendfile() without passing through Fun strings.
+ *
+ * - Direct-mapped table of FUN_FILE_CACHE_SLOTS entries keyed by path; a
+ *   colliding path evicts the old entry.
+ * - An entry is trusted for FUN_FILE_CACHE_VALID_MS; after that one stat()
+ *   revalidates it (same device, inode, size and mtime) or it is reopened.
+ *   Missing files are not cached.
+ * - Entries are reference counted, so a thread still sending from an evicted
+ *   entry keeps its descriptor until it is done.
+ *
+ * Only regular files are served. Non-UNIX platforms have no cache (every
+ * lookup fails).
+ */
+
+#ifdef __unix__
+#include <errno.h>
+#include <pthread.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+#define FUN_FILE_CACHE_SLOTS 256
+#define FUN_FILE_CACHE_VALID_MS 1000
+
+typedef struct {
+  char *path;
+  int fd;
+  int64_t size;
+  int64_t mtime;
+  dev_t dev;
+  ino_t ino;
+  int64_t checked_ms;
+  int refs; /* the table holds one reference while the entry is cached */
+} FunFileEntry;
+
+static FunFileEntry *g_file_cache[FUN_FILE_CACHE_SLOTS];
+static pthread_mutex_t g_file_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int64_t fun_file_cache_now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Drop one reference; the last one closes the descriptor. Caller holds the lock. */
+static void fun_file_entry_unref_locked(FunFileEntry *e) {
+  if (--e->refs > 0) return;
+  close(e->fd);
+  free(e->path);
+  free(e);
+}
+
+/** Release an entry returned by fun_file_cache_acquire. */
+static void fun_file_cache_release(FunFileEntry *e) {
+  pthread_mutex_lock(&g_file_cache_lock);
+  fun_file_entry_unref_locked(e);
+  pthread_mutex_unlock(&g_file_cache_lock);
+}
+
+/**
+ * @brief Look up (or open and cache) a regular file.
+ * @return Referenced entry (release with fun_file_cache_release) or NULL when
+ *         the path is missing, unreadable or not a regular file.
+ */
+static FunFileEntry *fun_file_cache_acquire(const char *path) {
+  uint32_t h = 2166136261u;
+  for (const unsigned char *p = (const unsigned char *)path; *p; ++p)
+    h = (h ^ *p) * 16777619u;
+  FunFileEntry **slot = &g_file_cache[h % FUN_FILE_CACHE_SLOTS];
+  int64_t now = fun_file_cache_now_ms();
+  struct stat st;
+
+  pthread_mutex_lock(&g_file_cache_lock);
+  FunFileEntry *e = *slot;
+  if (e && strcmp(e->path, path) == 0) {
+    if (now - e->checked_ms < FUN_FILE_CACHE_VALID_MS) {
+      e->refs++;
+      pthread_mutex_unlock(&g_file_cache_lock);
+      return e;
+    }
+    if (stat(path, &st) == 0 && st.st_dev == e->dev && st.st_ino == e->ino && (int64_t)st.st_size == e->size &&
+        (int64_t)st.st_mtime == e->mtime) {
+      e->checked_ms = now;
+      e->refs++;
+      pthread_mutex_unlock(&g_file_cache_lock);
+      return e;
+    }
+  }
+  /* miss or changed on disk: (re)open */
+  if (e) {
+    *slot = NULL;
+    fun_file_entry_unref_locked(e);
+  }
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    if (fd >= 0) close(fd);
+    pthread_mutex_unlock(&g_file_cache_lock);
+    return NULL;
+  }
+  e = (FunFileEntry *)calloc(1, sizeof(FunFileEntry));
+  char *pcopy = strdup(path);
+  if (!e || !pcopy) {
+    free(e);
+    free(pcopy);
+    close(fd);
+    pthread_mutex_unlock(&g_file_cache_lock);
+    return NULL;
+  }
+  e->path = pcopy;
+  e->fd = fd;
+  e->size = (int64_t)st.st_size;
+  e->mtime = (int64_t)st.st_mtime;
+  e->dev = st.st_dev;
+  e->ino = st.st_ino;
+  e->checked_ms = now;
+  e->refs = 2; /* table + caller */
+  *slot = e;
+  pthread_mutex_unlock(&g_file_cache_lock);
+  return e;
+}
+
+/**
+ * @brief Send head (may be NULL), then up to len bytes of e starting at offset
+ *        (len <= 0: to end of file) to a socket.
+ *
+ * head goes out with MSG_MORE so a response head and a small file share one
+ * segment instead of the file waiting behind the head for the peer's ACK.
+ *
+ * @return Bytes sent including head; 0 when nothing could be sent (socket
+ *         would block, or no head and offset at or past the end); -1 on error.
+ */
+static int64_t fun_file_cache_send(int sock, FunFileEntry *e, int64_t offset, int64_t len, const char *head, size_t head_len) {
+  if (offset < 0) return -1;
+  if (offset >= e->size) offset = len = 0;
+  else if (len <= 0 || len > e->size - offset) len = e->size - offset;
+  /* without TCP_NODELAY Nagle holds the last partial segment of the file
+   * until the peer's delayed ACK (~40ms per keep-alive response). Fails
+   * harmlessly on non-TCP sockets. */
+  int one = 1;
+  setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  int64_t total = 0;
+  if (head_len > 0) {
+    int flags = 0;
+#ifdef MSG_MORE
+    if (len > 0) flags |= MSG_MORE;
+#endif
+#ifdef MSG_NOSIGNAL
+    flags |= MSG_NOSIGNAL;
+#endif
+    ssize_t h = send(sock, head, head_len, flags);
+    if (h < 0) return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    if ((size_t)h < head_len || len == 0) return (int64_t)h;
+    total = (int64_t)h;
+  }
+  if (len == 0) return total;
+#ifdef __linux__
+  /* sendfile has no MSG_NOSIGNAL: block SIGPIPE for the call and swallow
+   * the one raised by a closed peer */
+  sigset_t pipe_set, old_set;
+  sigemptyset(&pipe_set);
+  sigaddset(&pipe_set, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &pipe_set, &old_set);
+  off_t off = (off_t)offset;
+  ssize_t n;
+  do {
+    n = sendfile(sock, e->fd, &off, (size_t)len);
+  } while (n < 0 && errno == EINTR);
+  int err = errno;
+  if (n < 0 && err == EPIPE) {
+    struct timespec zero = {0, 0};
+    sigtimedwait(&pipe_set, NULL, &zero);
+  }
+  pthread_sigmask(SIG_SETMASK, &old_set, NULL);
+  if (n < 0) return (err == EAGAIN || err == EWOULDBLOCK) ? total : -1;
+  return total + (int64_t)n;
+#else
+  /* portable fallback: pread into a bounce buffer and send what the socket takes */
+  char buf[65536];
+  size_t want = len > (int64_t)sizeof(buf) ? sizeof(buf) : (size_t)len;
+  ssize_t r = pread(e->fd, buf, want, (off_t)offset);
+  if (r <= 0) return r == 0 ? total : -1;
+#ifdef MSG_NOSIGNAL
+  ssize_t n = send(sock, buf, (size_t)r, MSG_NOSIGNAL);
+#else
+  ssize_t n = send(sock, buf, (size_t)r, 0);
+#endif
+  if (n < 0) return (errno == EAGAIN || errno == EWOULDBLOCK) ? total : -1;
+  return total + (int64_t)n;
+#endif
+}
+#endif
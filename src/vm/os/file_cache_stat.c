@@ -0,0 +1,44 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file file_cache_stat.c
+ * @brief Implements OP_FILE_CACHE_STAT (file_cache_stat(path)).
+ *
+ * Behavior:
+ * - Pops path (string); opens it through the open-file cache used by
+ *   sock_sendfile (vm/os/file_cache_common.c).
+ * - Pushes {size, mtime} (bytes, seconds since the epoch) for a readable
+ *   regular file, else nil. Metadata is at most about one second old.
+ * - On non-UNIX platforms, pushes nil.
+ *
+ * Errors:
+ * - A non-string path prints a type error and pushes nil.
+ */
+
+case OP_FILE_CACHE_STAT: {
+  Value pathv = pop_value(vm);
+  Value res = make_nil();
+#ifdef __unix__
+  if (pathv.type != VAL_STRING) {
+    fprintf(stderr, "Runtime type error: file_cache_stat expects (string path)\n");
+  } else {
+    FunFileEntry *e = fun_file_cache_acquire(pathv.s ? pathv.s : "");
+    if (e) {
+      res = make_map_empty();
+      map_set(&res, "size", make_int(e->size));
+      map_set(&res, "mtime", make_int(e->mtime));
+      fun_file_cache_release(e);
+    }
+  }
+#endif
+  free_value(pathv);
+  push_value(vm, res);
+  break;
+}
@@ -0,0 +1,29 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file proc_close.c
+ * @brief Implements OP_PROC_CLOSE (proc_close(handle)).
+ *
+ * Behavior:
+ * - Pops a process handle and releases it with its pipes and buffers. A
+ *   child that is still running is killed (SIGKILL) and reaped.
+ * - Pushes 1 on success, 0 for an unknown handle.
+ */
+
+case OP_PROC_CLOSE: {
+  Value hv = pop_value(vm);
+  int ok = 0;
+#ifdef __unix__
+  if (hv.type == VAL_INT) ok = fun_proc_close(hv.i);
+#endif
+  free_value(hv);
+  push_value(vm, make_int(ok));
+  break;
+}
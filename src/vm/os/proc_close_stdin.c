@@ -0,0 +1,36 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file proc_close_stdin.c
+ * @brief Implements OP_PROC_CLOSE_STDIN (proc_close_stdin(handle)).
+ *
+ * Behavior:
+ * - Pops a process handle and closes the child's stdin pipe, so it sees
+ *   end of input.
+ * - Pushes 1 if a pipe was closed, else 0.
+ */
+
+case OP_PROC_CLOSE_STDIN: {
+  Value hv = pop_value(vm);
+  int ok = 0;
+#ifdef __unix__
+  FunProc *p = hv.type == VAL_INT ? fun_proc_acquire(hv.i) : NULL;
+  if (p) {
+    if (p->in_fd >= 0) {
+      fun_proc_close_fd(&p->in_fd);
+      ok = 1;
+    }
+    fun_proc_release(hv.i);
+  }
+#endif
+  free_value(hv);
+  push_value(vm, make_int(ok));
+  break;
+}
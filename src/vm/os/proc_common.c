@@ -0,0 +1,461 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file proc_common.c
+ * @brief Child process handles used by the OP_PROC_SPAWN family of opcodes.
+ *
+ * proc_spawn() starts a program with posix_spawnp() from an argv array (no
+ * shell, so arguments need no quoting) and keeps the parent ends of pipes
+ * for the child's stdin, stdout and stderr. The stdout/stderr pipes are
+ * non-blocking; whenever a handle is read, polled or waited on, everything
+ * available is drained into per-handle buffers, so a child never stalls on
+ * a full pipe while the VM is busy with another one. proc_read() hands the
+ * buffered bytes out in one piece.
+ *
+ * Exit detection uses waitpid(WNOHANG). Blocking waits poll() the output
+ * pipes and, on Linux, a pidfd that becomes readable when the child exits;
+ * elsewhere the wait wakes up in short slices to reap.
+ *
+ * Processes live in the g_procs handle table (src/handles.c). Ops borrow a
+ * process for the duration of one call, so proc_close from another thread
+ * while a proc_wait is blocked takes effect (kill and reap) when the wait
+ * returns. All pipe ends are created close-on-exec, so concurrent spawns do
+ * not leak each other's pipes. Exit codes follow proc_waitpid(): the exit
+ * status, or 128 + signal number.
+ */
+
+#ifdef __unix__
+#include <errno.h>
+#include <pthread.h>
+#include <spawn.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+extern char **environ;
+
+#define FUN_PROC_READ_CHUNK 65536
+#define FUN_PROC_SLICE_MS 10 /* reap interval when no pidfd is available */
+
+typedef struct {
+  char *data;
+  size_t len;
+  size_t cap;
+} FunProcBuf;
+
+typedef struct {
+  pid_t pid;
+  int in_fd;  /* child's stdin, -1 when closed or not piped */
+  int out_fd; /* child's stdout, -1 at EOF */
+  int err_fd; /* child's stderr, -1 at EOF or when merged/discarded */
+  int pidfd;  /* readable once the child exits; -1 if unsupported */
+  int exited;
+  int code;
+  FunProcBuf out;
+  FunProcBuf err;
+} FunProc;
+
+static void fun_proc_close_fd(int *fd) {
+  if (*fd >= 0) close(*fd);
+  *fd = -1;
+}
+
+/** Handle table destructor: a child that is still running is killed (SIGKILL) and reaped. */
+static void fun_proc_destroy(void *ptr) {
+  FunProc *p = (FunProc *)ptr;
+  fun_proc_close_fd(&p->in_fd);
+  fun_proc_close_fd(&p->out_fd);
+  fun_proc_close_fd(&p->err_fd);
+  fun_proc_close_fd(&p->pidfd);
+  if (!p->exited) {
+    kill(p->pid, SIGKILL);
+    while (waitpid(p->pid, NULL, 0) < 0 && errno == EINTR) {
+    }
+  }
+  free(p->out.data);
+  free(p->err.data);
+  free(p);
+}
+
+static FunHandleTable g_procs = FUN_HANDLE_TABLE_INIT(fun_proc_destroy);
+
+/** Borrow a process by handle; NULL if unknown or closed. Pair with fun_proc_release(). */
+static FunProc *fun_proc_acquire(int64_t id) {
+  return (FunProc *)fun_handle_acquire(&g_procs, id);
+}
+
+static void fun_proc_release(int64_t id) {
+  fun_handle_release(&g_procs, id);
+}
+
+/** Record a waitpid() status. */
+static void fun_proc_set_status(FunProc *p, int status) {
+  p->exited = 1;
+  if (WIFEXITED(status))
+    p->code = WEXITSTATUS(status);
+  else if (WIFSIGNALED(status))
+    p->code = 128 + WTERMSIG(status);
+  else
+    p->code = -1;
+  fun_proc_close_fd(&p->pidfd);
+}
+
+/** Read everything available from *fd into b; closes *fd at EOF or error. */
+static void fun_proc_drain(int *fd, FunProcBuf *b) {
+  while (*fd >= 0) {
+    if (b->cap - b->len < FUN_PROC_READ_CHUNK + 1) {
+      size_t ncap = b->cap ? b->cap * 2 : FUN_PROC_READ_CHUNK * 2;
+      while (ncap - b->len < FUN_PROC_READ_CHUNK + 1)
+        ncap *= 2;
+      char *nd = (char *)realloc(b->data, ncap);
+      if (!nd) return;
+      b->data = nd;
+      b->cap = ncap;
+    }
+    ssize_t n = read(*fd, b->data + b->len, FUN_PROC_READ_CHUNK);
+    if (n > 0) {
+      b->len += (size_t)n;
+      continue;
+    }
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+    fun_proc_close_fd(fd);
+  }
+}
+
+/** Drain the output pipes and reap the child if it has exited; returns p->exited. */
+static int fun_proc_pump(FunProc *p) {
+  fun_proc_drain(&p->out_fd, &p->out);
+  fun_proc_drain(&p->err_fd, &p->err);
+  if (!p->exited) {
+    int status = 0;
+    pid_t r;
+    do {
+      r = waitpid(p->pid, &status, WNOHANG);
+    } while (r < 0 && errno == EINTR);
+    if (r == p->pid) {
+      fun_proc_set_status(p, status);
+    } else if (r < 0) {
+      /* reaped elsewhere (e.g. proc_waitpid): the code is lost */
+      p->exited = 1;
+      p->code = -1;
+      fun_proc_close_fd(&p->pidfd);
+    }
+  }
+  if (p->exited) {
+    /* the child is gone; what it wrote is in the pipe buffer now */
+    fun_proc_drain(&p->out_fd, &p->out);
+    fun_proc_drain(&p->err_fd, &p->err);
+  }
+  return p->exited;
+}
+
+/**
+ * Buffered output of stream 1 (stdout) or 2 (stderr) as a string, copied by
+ * length rather than up to the first NUL; clears the buffer. On allocation
+ * failure the buffer is kept and "" is returned.
+ */
+static Value fun_proc_take(FunProc *p, int stream) {
+  FunProcBuf *b = stream == 2 ? &p->err : &p->out;
+  Value s = make_string_len(b->data ? b->data : "", b->len);
+  if (!s.s) {
+    free_value(s);
+    return make_string("");
+  }
+  b->len = 0;
+  return s;
+}
+
+/**
+ * Wait until at least one of ps[0..n) has exited or timeout_ms passes
+ * (< 0 = no limit), draining all of their output pipes meanwhile.
+ * Returns the number of exited processes.
+ */
+static int fun_proc_wait_set(FunProc **ps, int n, int64_t timeout_ms) {
+  struct pollfd stack_pfds[48];
+  struct pollfd *pfds = n * 3 <= 48 ? stack_pfds : (struct pollfd *)malloc(sizeof(struct pollfd) * (size_t)n * 3);
+  if (!pfds) return 0;
+  struct timespec t0;
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  int done = 0;
+  for (;;) {
+    done = 0;
+    for (int i = 0; i < n; ++i)
+      done += fun_proc_pump(ps[i]);
+    if (done > 0) break;
+    int wait_ms = -1;
+    if (timeout_ms >= 0) {
+      struct timespec t1;
+      clock_gettime(CLOCK_MONOTONIC, &t1);
+      int64_t spent = (int64_t)(t1.tv_sec - t0.tv_sec) * 1000 + (t1.tv_nsec - t0.tv_nsec) / 1000000;
+      if (spent >= timeout_ms) break;
+      wait_ms = (int)(timeout_ms - spent);
+    }
+    int np = 0, all_pidfd = 1;
+    for (int i = 0; i < n; ++i) {
+      FunProc *p = ps[i];
+      if (p->out_fd >= 0) pfds[np++] = (struct pollfd){.fd = p->out_fd, .events = POLLIN};
+      if (p->err_fd >= 0) pfds[np++] = (struct pollfd){.fd = p->err_fd, .events = POLLIN};
+      if (p->pidfd >= 0)
+        pfds[np++] = (struct pollfd){.fd = p->pidfd, .events = POLLIN};
+      else
+        all_pidfd = 0;
+    }
+    if (!all_pidfd && (wait_ms < 0 || wait_ms > FUN_PROC_SLICE_MS)) wait_ms = FUN_PROC_SLICE_MS;
+    if (poll(pfds, (nfds_t)np, wait_ms) < 0 && errno != EINTR) break;
+  }
+  if (pfds != stack_pfds) free(pfds);
+  return done;
+}
+
+/** Blocking write of len bytes to the child's stdin, draining its output meanwhile;
+ *  returns bytes written or -1 (stdin closed/not piped, or the child closed it). */
+static int64_t fun_proc_write(FunProc *p, const char *data, size_t len) {
+  if (p->in_fd < 0) return -1;
+  size_t off = 0;
+  /* a child that closed its stdin raises SIGPIPE: block it for the call and
+   * swallow the pending one */
+  sigset_t pipe_set, old_set;
+  sigemptyset(&pipe_set);
+  sigaddset(&pipe_set, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &pipe_set, &old_set);
+  int failed = 0;
+  while (off < len) {
+    ssize_t w = write(p->in_fd, data + off, len - off);
+    if (w > 0) {
+      off += (size_t)w;
+      continue;
+    }
+    if (w < 0 && errno == EINTR) continue;
+    if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      fun_proc_pump(p);
+      struct pollfd pfds[3];
+      int np = 0;
+      pfds[np++] = (struct pollfd){.fd = p->in_fd, .events = POLLOUT};
+      if (p->out_fd >= 0) pfds[np++] = (struct pollfd){.fd = p->out_fd, .events = POLLIN};
+      if (p->err_fd >= 0) pfds[np++] = (struct pollfd){.fd = p->err_fd, .events = POLLIN};
+      poll(pfds, (nfds_t)np, -1);
+      continue;
+    }
+    if (errno == EPIPE) {
+      struct timespec zero = {0, 0};
+      sigtimedwait(&pipe_set, NULL, &zero);
+    }
+    failed = 1;
+    break;
+  }
+  pthread_sigmask(SIG_SETMASK, &old_set, NULL);
+  return failed && off == 0 ? -1 : (int64_t)off;
+}
+
+/** Build a NULL-terminated "K=V" array from an env map; NULL on error. */
+static char **fun_proc_envp(const Value *envm) {
+  Value keys = map_keys_array(envm);
+  int n = array_length(&keys);
+  char **envp = (char **)calloc((size_t)(n < 0 ? 0 : n) + 1, sizeof(char *));
+  int ok = envp != NULL;
+  for (int i = 0; ok && i < n; ++i) {
+    Value k = array_peek_value(&keys, i);
+    Value v;
+    char *vs = NULL;
+    if (k.type == VAL_STRING && map_get_copy(envm, k.s, &v)) {
+      vs = value_to_string_alloc(&v);
+      free_value(v);
+    }
+    if (!vs) {
+      ok = 0;
+      break;
+    }
+    size_t kl = strlen(k.s), vl = strlen(vs);
+    envp[i] = (char *)malloc(kl + vl + 2);
+    if (envp[i]) {
+      memcpy(envp[i], k.s, kl);
+      envp[i][kl] = '=';
+      memcpy(envp[i] + kl + 1, vs, vl + 1);
+    } else {
+      ok = 0;
+    }
+    free(vs);
+  }
+  free_value(keys);
+  if (!ok && envp) {
+    for (int i = 0; envp[i]; ++i)
+      free(envp[i]);
+    free(envp);
+    envp = NULL;
+  }
+  return envp;
+}
+
+static void fun_proc_free_strv(char **v) {
+  if (!v) return;
+  for (int i = 0; v[i]; ++i)
+    free(v[i]);
+  free(v);
+}
+
+/** Option string from an options map, or NULL. Caller frees. */
+static char *fun_proc_opt(const Value *opts, const char *key) {
+  Value v;
+  if (!opts || opts->type != VAL_MAP || !map_get_copy(opts, key, &v)) return NULL;
+  char *s = v.type == VAL_NIL ? NULL : value_to_string_alloc(&v);
+  free_value(v);
+  return s;
+}
+
+/** pipe() with both ends close-on-exec; the child gets its ends through dup2. */
+static int fun_proc_pipe(int fds[2]) {
+#ifdef __linux__
+  return pipe2(fds, O_CLOEXEC);
+#else
+  /* no pipe2: a fork in another thread can still see these between the calls */
+  if (pipe(fds) != 0) return -1;
+  fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+  fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+  return 0;
+#endif
+}
+
+static void fun_proc_nonblock(int fd) {
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+/**
+ * Spawn argv[0] (searched in PATH) with the given options map:
+ *   "cwd"    working directory
+ *   "env"    map replacing the environment
+ *   "stdin"  "pipe" (default) or "null"
+ *   "stderr" "pipe" (default), "stdout" (merged into stdout) or "null"
+ * Returns a handle (>0) or 0 on error.
+ */
+static int64_t fun_proc_spawn(const Value *argvv, const Value *opts) {
+  int argc = argvv->type == VAL_ARRAY ? array_length(argvv) : 0;
+  if (argc <= 0) return 0;
+  char **argv = (char **)calloc((size_t)argc + 1, sizeof(char *));
+  if (!argv) return 0;
+  for (int i = 0; i < argc; ++i) {
+    Value a = array_peek_value(argvv, i);
+    argv[i] = value_to_string_alloc(&a);
+    if (!argv[i]) {
+      fun_proc_free_strv(argv);
+      return 0;
+    }
+  }
+  char *cwd = fun_proc_opt(opts, "cwd");
+  char *in_mode = fun_proc_opt(opts, "stdin");
+  char *err_mode = fun_proc_opt(opts, "stderr");
+  int in_null = in_mode && strcmp(in_mode, "null") == 0;
+  int err_merge = err_mode && strcmp(err_mode, "stdout") == 0;
+  int err_null = err_mode && strcmp(err_mode, "null") == 0;
+  char **envp = NULL;
+  Value envm;
+  int has_env = opts && opts->type == VAL_MAP && map_get_copy(opts, "env", &envm);
+  int ok = 1;
+  if (has_env) {
+    if (envm.type == VAL_MAP) envp = fun_proc_envp(&envm);
+    ok = envp != NULL;
+    free_value(envm);
+  }
+
+  int in_p[2] = {-1, -1}, out_p[2] = {-1, -1}, err_p[2] = {-1, -1};
+  if (ok && !in_null && fun_proc_pipe(in_p) != 0) ok = 0;
+  if (ok && fun_proc_pipe(out_p) != 0) ok = 0;
+  if (ok && !err_merge && !err_null && fun_proc_pipe(err_p) != 0) ok = 0;
+
+  posix_spawn_file_actions_t fa;
+  posix_spawnattr_t attr;
+  int fa_init = 0, attr_init = 0;
+  pid_t pid = -1;
+  if (ok) {
+    fa_init = posix_spawn_file_actions_init(&fa) == 0;
+    attr_init = posix_spawnattr_init(&attr) == 0;
+    ok = fa_init && attr_init;
+  }
+  if (ok) {
+    if (in_null)
+      posix_spawn_file_actions_addopen(&fa, 0, "/dev/null", O_RDONLY, 0);
+    else
+      posix_spawn_file_actions_adddup2(&fa, in_p[0], 0);
+    posix_spawn_file_actions_adddup2(&fa, out_p[1], 1);
+    if (err_merge)
+      posix_spawn_file_actions_adddup2(&fa, out_p[1], 2);
+    else if (err_null)
+      posix_spawn_file_actions_addopen(&fa, 2, "/dev/null", O_WRONLY, 0);
+    else
+      posix_spawn_file_actions_adddup2(&fa, err_p[1], 2);
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 34)
+    /* sockets and other descriptors of the VM stay out of the child */
+    posix_spawn_file_actions_addclosefrom_np(&fa, 3);
+#endif
+    if (cwd) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 29)
+      if (posix_spawn_file_actions_addchdir_np(&fa, cwd) != 0) ok = 0;
+#else
+      ok = 0; /* no portable way to chdir in the child */
+#endif
+    }
+    /* the child starts with default SIGPIPE and an empty signal mask */
+    sigset_t none, def;
+    sigemptyset(&none);
+    sigemptyset(&def);
+    sigaddset(&def, SIGPIPE);
+    posix_spawnattr_setsigmask(&attr, &none);
+    posix_spawnattr_setsigdefault(&attr, &def);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+  }
+  if (ok && posix_spawnp(&pid, argv[0], &fa, &attr, argv, envp ? envp : environ) != 0) {
+    pid = -1;
+    ok = 0;
+  }
+  if (fa_init) posix_spawn_file_actions_destroy(&fa);
+  if (attr_init) posix_spawnattr_destroy(&attr);
+  fun_proc_close_fd(&in_p[0]);
+  fun_proc_close_fd(&out_p[1]);
+  fun_proc_close_fd(&err_p[1]);
+  fun_proc_free_strv(argv);
+  fun_proc_free_strv(envp);
+  free(cwd);
+  free(in_mode);
+  free(err_mode);
+
+  FunProc *p = ok ? (FunProc *)calloc(1, sizeof(FunProc)) : NULL;
+  if (!p) {
+    fun_proc_close_fd(&in_p[1]);
+    fun_proc_close_fd(&out_p[0]);
+    fun_proc_close_fd(&err_p[0]);
+    if (pid > 0) {
+      kill(pid, SIGKILL);
+      while (waitpid(pid, NULL, 0) < 0 && errno == EINTR) {
+      }
+    }
+    return 0;
+  }
+  p->pid = pid;
+  p->in_fd = in_p[1];
+  p->out_fd = out_p[0];
+  p->err_fd = err_p[0];
+  p->pidfd = -1;
+  if (p->in_fd >= 0) fun_proc_nonblock(p->in_fd);
+  fun_proc_nonblock(p->out_fd);
+  if (p->err_fd >= 0) fun_proc_nonblock(p->err_fd);
+#if defined(__linux__) && defined(SYS_pidfd_open)
+  p->pidfd = (int)syscall(SYS_pidfd_open, pid, 0);
+  if (p->pidfd >= 0) fcntl(p->pidfd, F_SETFD, FD_CLOEXEC);
+#endif
+  int64_t id = fun_handle_new(&g_procs, p);
+  if (!id) fun_proc_destroy(p);
+  return id;
+}
+
+/** Release a handle: a child that is still running is killed (SIGKILL) and reaped. */
+static int fun_proc_close(int64_t id) {
+  return fun_handle_free(&g_procs, id);
+}
+#endif
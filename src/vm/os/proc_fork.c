@@ -0,0 +1,36 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file proc_fork.c
+ * @brief Implements OP_PROC_FORK (proc_fork()) to fork the running program.
+ *
+ * Behavior:
+ * - Flushes stdio, then fork()s. The child continues with a copy of the whole
+ *   VM (globals, open fds, handles) and gets 0; the parent gets the child's
+ *   pid. Used for prefork servers where each worker opens its own
+ *   SO_REUSEPORT listener (see tcp_listen options).
+ * - Only the calling thread exists in the child; threads started with
+ *   thread_spawn are not copied.
+ *
+ * Errors:
+ * - Pushes -1 if fork() fails or on non-UNIX platforms.
+ */
+
+case OP_PROC_FORK: {
+  int64_t pid = -1;
+#ifdef __unix__
+  /* buffered output would otherwise be written by both processes */
+  fflush(NULL);
+  pid = (int64_t)fork();
+  if (pid < 0) pid = -1;
+#endif
+  push_value(vm, make_int(pid));
+  break;
+}
@@ -0,0 +1,26 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file proc_getpid.c
+ * @brief Implements OP_PROC_GETPID (proc_getpid()).
+ *
+ * Behavior:
+ * - Pushes the id of the running process (differs per proc_fork() worker).
+ * - Pushes 0 on platforms without getpid().
+ */
+
+case OP_PROC_GETPID: {
+#ifdef __unix__
+  push_value(vm, make_int((int64_t)getpid()));
+#else
+  push_value(vm, make_int(0));
+#endif
+  break;
+}
@@ -0,0 +1,27 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file proc_getppid.c
+ * @brief Implements OP_PROC_GETPPID (proc_getppid()).
+ *
+ * Behavior:
+ * - Pushes the id of the parent process. A forked worker sees this change
+ *   when its parent exits (it is reparented), which is how it notices.
+ * - Pushes 0 on platforms without getppid().
+ */
+
+case OP_PROC_GETPPID: {
+#ifdef __unix__
+  push_value(vm, make_int((int64_t)getppid()));
+#else
+  push_value(vm, make_int(0));
+#endif
+  break;
+}
@@ -0,0 +1,36 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file proc_kill.c
+ * @brief Implements OP_PROC_KILL (proc_kill(pid, signal)) to signal a process.
+ *
+ * Behavior:
+ * - Pops signal (int) and pid (int); sends the signal with kill(2) (15 is
+ *   SIGTERM, 9 SIGKILL; 0 only checks that the process exists).
+ * - Pushes 1 on success, 0 otherwise.
+ *
+ * Errors:
+ * - Non-int arguments, pids <= 0 (process groups are refused) and non-UNIX
+ *   platforms push 0.
+ */
+
+case OP_PROC_KILL: {
+  Value sigv = pop_value(vm);
+  Value pidv = pop_value(vm);
+  int ok = 0;
+#ifdef __unix__
+  if (pidv.type == VAL_INT && sigv.type == VAL_INT && pidv.i > 0 && sigv.i >= 0)
+    ok = kill((pid_t)pidv.i, (int)sigv.i) == 0;
+#endif
+  free_value(sigv);
+  free_value(pidv);
+  push_value(vm, make_int(ok));
+  break;
+}
@@ -0,0 +1,32 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file proc_pid.c
+ * @brief Implements OP_PROC_PID (proc_pid(handle)).
+ *
+ * Behavior:
+ * - Pops a process handle; pushes the child's pid (for proc_kill), or 0 for
+ *   an unknown handle.
+ */
+
+case OP_PROC_PID: {
+  Value hv = pop_value(vm);
+  int64_t pid = 0;
+#ifdef __unix__
+  FunProc *p = hv.type == VAL_INT ? fun_proc_acquire(hv.i) : NULL;
+  if (p) {
+    pid = (int64_t)p->pid;
+    fun_proc_release(hv.i);
+  }
+#endif
+  free_value(hv);
+  push_value(vm, make_int(pid));
+  break;
+}
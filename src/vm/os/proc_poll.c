@@ -0,0 +1,34 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file proc_poll.c
+ * @brief Implements OP_PROC_POLL (proc_poll(handle)).
+ *
+ * Behavior:
+ * - Pops a process handle; drains its output pipes and checks for exit
+ *   without blocking.
+ * - Pushes nil while the child runs, then its exit code (128 + signal if
+ *   killed). Pushes -1 for an unknown handle.
+ */
+
+case OP_PROC_POLL: {
+  Value hv = pop_value(vm);
+  Value res = make_int(-1);
+#ifdef __unix__
+  FunProc *p = hv.type == VAL_INT ? fun_proc_acquire(hv.i) : NULL;
+  if (p) {
+    res = fun_proc_pump(p) ? make_int(p->code) : make_nil();
+    fun_proc_release(hv.i);
+  }
+#endif
+  free_value(hv);
+  push_value(vm, res);
+  break;
+}
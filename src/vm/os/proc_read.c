@@ -0,0 +1,38 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file proc_read.c
+ * @brief Implements OP_PROC_READ (proc_read(handle [, stream])).
+ *
+ * Behavior:
+ * - Operand 1 means a stream was passed: 1 = stdout (default), 2 = stderr.
+ * - Drains what the child has written so far without blocking and pushes
+ *   all buffered output of that stream as one string, clearing the buffer.
+ * - Pushes "" if nothing is buffered or the handle is unknown.
+ */
+
+case OP_PROC_READ: {
+  Value streamv = inst.operand ? pop_value(vm) : make_int(1);
+  Value hv = pop_value(vm);
+  Value res = make_string("");
+#ifdef __unix__
+  FunProc *p = hv.type == VAL_INT ? fun_proc_acquire(hv.i) : NULL;
+  if (p) {
+    fun_proc_pump(p);
+    free_value(res);
+    res = fun_proc_take(p, streamv.type == VAL_INT && streamv.i == 2 ? 2 : 1);
+    fun_proc_release(hv.i);
+  }
+#endif
+  free_value(streamv);
+  free_value(hv);
+  push_value(vm, res);
+  break;
+}
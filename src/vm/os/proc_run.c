@@ -17,6 +17,9 @@
  *
  * Errors:
  * - On allocation failures or popen errors, returns {out: "", code: -1}.
+ *
+ * See proc_spawn() for running programs without a shell, with stdin/stderr
+ * pipes and without blocking the VM until the child exits.
  */
 
 #include <stdio.h>
@@ -57,9 +60,9 @@ case OP_PROC_RUN: {
       push_value(vm, m);
       break;
     }
-    int c;
-    while ((c = fgetc(fp)) != EOF) {
-      if (len + 1 >= cap) {
+    size_t n;
+    for (;;) {
+      if (cap - len < 2048) {
         cap *= 2;
         char *nb = (char *)realloc(out, cap);
         if (!nb) {
@@ -74,7 +77,10 @@ case OP_PROC_RUN: {
         }
         out = nb;
       }
-      out[len++] = (char)c;
+      /* read in bulk; the last byte of the buffer stays free for the NUL */
+      n = fread(out + len, 1, cap - len - 1, fp);
+      if (n == 0) break;
+      len += n;
     }
     out[len] = '\0';
     int status = pclose(fp);
@@ -0,0 +1,35 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file proc_spawn.c
+ * @brief Implements OP_PROC_SPAWN (proc_spawn(argv [, options])).
+ *
+ * Behavior:
+ * - Operand 1 means an options map was passed. Pops [options] and an argv
+ *   array; starts argv[0] (searched in PATH, no shell) with pipes for stdin,
+ *   stdout and stderr and returns immediately.
+ * - Options: "cwd", "env" (map replacing the environment), "stdin" ("pipe"
+ *   or "null"), "stderr" ("pipe", "stdout" to merge, or "null").
+ * - Pushes a process handle (>0), or 0 if the program could not be started,
+ *   argv is empty, or on non-UNIX platforms.
+ */
+
+case OP_PROC_SPAWN: {
+  Value optsv = inst.operand ? pop_value(vm) : make_nil();
+  Value argvv = pop_value(vm);
+  int64_t h = 0;
+#ifdef __unix__
+  h = fun_proc_spawn(&argvv, &optsv);
+#endif
+  free_value(argvv);
+  free_value(optsv);
+  push_value(vm, make_int(h));
+  break;
+}
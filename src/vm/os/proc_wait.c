@@ -0,0 +1,39 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file proc_wait.c
+ * @brief Implements OP_PROC_WAIT (proc_wait(handle [, timeout_ms])).
+ *
+ * Behavior:
+ * - Operand 1 means a timeout was passed (< 0 waits without limit, the
+ *   default). Pops [timeout_ms] and a process handle.
+ * - Waits for the child to exit while draining its stdout/stderr into the
+ *   handle's buffers (read them afterwards with proc_read).
+ * - Pushes the exit code (128 + signal if killed), nil on timeout, or -1
+ *   for an unknown handle.
+ */
+
+case OP_PROC_WAIT: {
+  Value tov = inst.operand ? pop_value(vm) : make_int(-1);
+  Value hv = pop_value(vm);
+  Value res = make_int(-1);
+#ifdef __unix__
+  FunProc *p = hv.type == VAL_INT ? fun_proc_acquire(hv.i) : NULL;
+  if (p) {
+    int64_t to = tov.type == VAL_INT ? tov.i : -1;
+    res = fun_proc_wait_set(&p, 1, to) ? make_int(p->code) : make_nil();
+    fun_proc_release(hv.i);
+  }
+#endif
+  free_value(tov);
+  free_value(hv);
+  push_value(vm, res);
+  break;
+}
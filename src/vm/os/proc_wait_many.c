@@ -0,0 +1,53 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file proc_wait_many.c
+ * @brief Implements OP_PROC_WAIT_MANY (proc_wait_many(handles [, timeout_ms])).
+ *
+ * Behavior:
+ * - Operand 1 means a timeout was passed (< 0 waits without limit, the
+ *   default). Pops [timeout_ms] and an array of process handles.
+ * - Blocks until at least one of them has exited, draining the output of
+ *   all of them meanwhile, with one poll() over their pipes.
+ * - Pushes the array of handles that have exited (in input order; empty on
+ *   timeout). Unknown handles are skipped.
+ */
+
+case OP_PROC_WAIT_MANY: {
+  Value tov = inst.operand ? pop_value(vm) : make_int(-1);
+  Value hsv = pop_value(vm);
+  Value out = make_array_from_values(NULL, 0);
+#ifdef __unix__
+  int n = hsv.type == VAL_ARRAY ? array_length(&hsv) : 0;
+  FunProc **ps = n > 0 ? (FunProc **)malloc(sizeof(FunProc *) * (size_t)n) : NULL;
+  int64_t *ids = n > 0 ? (int64_t *)malloc(sizeof(int64_t) * (size_t)n) : NULL;
+  int np = 0;
+  for (int i = 0; ps && ids && i < n; ++i) {
+    Value hv = array_peek_value(&hsv, i);
+    FunProc *p = hv.type == VAL_INT ? fun_proc_acquire(hv.i) : NULL;
+    if (p) {
+      ps[np] = p;
+      ids[np++] = hv.i;
+    }
+  }
+  if (np > 0 && fun_proc_wait_set(ps, np, tov.type == VAL_INT ? tov.i : -1) > 0) {
+    for (int i = 0; i < np; ++i)
+      if (ps[i]->exited) array_push(&out, make_int(ids[i]));
+  }
+  for (int i = 0; i < np; ++i)
+    fun_proc_release(ids[i]);
+  free(ps);
+  free(ids);
+#endif
+  free_value(tov);
+  free_value(hsv);
+  push_value(vm, out);
+  break;
+}
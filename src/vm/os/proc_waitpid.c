@@ -0,0 +1,45 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file proc_waitpid.c
+ * @brief Implements OP_PROC_WAITPID (proc_waitpid(pid)) to reap a child process.
+ *
+ * Behavior:
+ * - Pops pid (int); blocks until that child exits.
+ * - Pushes its exit code, or 128 + signal number if it was killed by a signal
+ *   (like a shell's $?).
+ *
+ * Errors:
+ * - Pushes -1 for a non-int pid, a pid that is not a child of this process,
+ *   or on non-UNIX platforms.
+ */
+
+case OP_PROC_WAITPID: {
+  Value pidv = pop_value(vm);
+  int64_t code = -1;
+#ifdef __unix__
+  if (pidv.type == VAL_INT && pidv.i > 0) {
+    int status = 0;
+    pid_t r;
+    do {
+      r = waitpid((pid_t)pidv.i, &status, 0);
+    } while (r < 0 && errno == EINTR);
+    if (r > 0) {
+      if (WIFEXITED(status))
+        code = WEXITSTATUS(status);
+      else if (WIFSIGNALED(status))
+        code = 128 + WTERMSIG(status);
+    }
+  }
+#endif
+  free_value(pidv);
+  push_value(vm, make_int(code));
+  break;
+}
@@ -0,0 +1,42 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file proc_write.c
+ * @brief Implements OP_PROC_WRITE (proc_write(handle, data)).
+ *
+ * Behavior:
+ * - Pops data (string) and a process handle; writes all of data to the
+ *   child's stdin. While the pipe is full the child's output is drained into
+ *   the handle's buffers, so a child that answers as it reads cannot
+ *   deadlock the writer.
+ * - Pushes the bytes written, or -1 if stdin is closed (by proc_close_stdin
+ *   or by the child), the handle is unknown, or on non-UNIX platforms.
+ */
+
+case OP_PROC_WRITE: {
+  Value datav = pop_value(vm);
+  Value hv = pop_value(vm);
+  int64_t n = -1;
+#ifdef __unix__
+  FunProc *p = hv.type == VAL_INT ? fun_proc_acquire(hv.i) : NULL;
+  if (p) {
+    char *s = value_to_string_alloc(&datav);
+    if (s) {
+      n = fun_proc_write(p, s, strlen(s));
+      free(s);
+    }
+    fun_proc_release(hv.i);
+  }
+#endif
+  free_value(datav);
+  free_value(hv);
+  push_value(vm, make_int(n));
+  break;
+}
@@ -0,0 +1,314 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file sockbuf_common.c
+ * @brief Reusable byte buffers and socket I/O helpers for the OP_SOCK_BUF_* / OP_SOCK_*V opcodes.
+ *
+ * A connection keeps one buffer for incoming and optionally one for outgoing
+ * bytes. sock_recv_into() reads straight into the buffer's free tail, so a
+ * recv costs no allocation once the buffer has grown to the working size;
+ * consumers take or drop bytes from the front (http_parse_request parses a
+ * buffer in place). Buffers are binary safe; only sock_buf_take() converts
+ * to a (NUL-terminated) Fun string.
+ *
+ * Buffers live in the g_sockbufs handle table (src/handles.c). Ops borrow a
+ * buffer with fun_sockbuf_acquire() for the duration of one call, so
+ * sock_buf_free from another thread cannot release it mid-recv; the free
+ * takes effect when the call returns. Sending a buffer consumes the bytes sent.
+ *
+ * I/O result convention (recv/readv, and send ops that could send nothing):
+ *   n > 0  bytes transferred
+ *   0      end of file (peer closed; receive side only)
+ *   -1     error
+ *   -2     would block (EAGAIN/EWOULDBLOCK on a non-blocking socket)
+ */
+
+#include <errno.h>
+#ifdef __unix__
+#include <limits.h>
+#include <sys/uio.h>
+#endif
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+#define FUN_IO_ERROR (-1)
+#define FUN_IO_AGAIN (-2)
+
+#define FUN_SOCKBUF_MIN_READ 16384 /* free space guaranteed before a recv */
+#define FUN_SOCKBUF_MAX_READ 65536 /* bytes read per sock_recv_into call */
+
+typedef struct {
+  char *data;
+  size_t start; /* offset of the first unread byte */
+  size_t len;   /* bytes stored */
+  size_t cap;
+} FunSockBuf;
+
+/** Handle table destructor. */
+static void fun_sockbuf_destroy(void *p) {
+  FunSockBuf *b = (FunSockBuf *)p;
+  free(b->data);
+  free(b);
+}
+
+static FunHandleTable g_sockbufs = FUN_HANDLE_TABLE_INIT(fun_sockbuf_destroy);
+
+/** Borrow a buffer by handle; NULL if unknown or freed. Pair with fun_sockbuf_release(). */
+static FunSockBuf *fun_sockbuf_acquire(int64_t id) {
+  return (FunSockBuf *)fun_handle_acquire(&g_sockbufs, id);
+}
+
+static void fun_sockbuf_release(int64_t id) {
+  fun_handle_release(&g_sockbufs, id);
+}
+
+/** Create a buffer with an initial capacity; returns handle (>0) or 0. */
+static int64_t fun_sockbuf_new(int64_t cap) {
+  if (cap <= 0) cap = FUN_SOCKBUF_MIN_READ;
+  FunSockBuf *b = (FunSockBuf *)calloc(1, sizeof(FunSockBuf));
+  if (!b) return 0;
+  b->data = (char *)malloc((size_t)cap);
+  if (!b->data) {
+    free(b);
+    return 0;
+  }
+  b->cap = (size_t)cap;
+  int64_t id = fun_handle_new(&g_sockbufs, b);
+  if (!id) fun_sockbuf_destroy(b);
+  return id;
+}
+
+/** Free a buffer (once no op is using it); returns 1/0. */
+static int fun_sockbuf_free(int64_t id) {
+  return fun_handle_free(&g_sockbufs, id);
+}
+
+/** Make room for at least `extra` bytes after the stored ones; returns 1/0. */
+static int fun_sockbuf_reserve(FunSockBuf *b, size_t extra) {
+  if (b->start + b->len + extra <= b->cap) return 1;
+  /* slide unread bytes to the front first; grow only when that is not enough */
+  if (b->start > 0) {
+    memmove(b->data, b->data + b->start, b->len);
+    b->start = 0;
+    if (b->len + extra <= b->cap) return 1;
+  }
+  size_t ncap = b->cap ? b->cap : FUN_SOCKBUF_MIN_READ;
+  while (ncap < b->len + extra)
+    ncap *= 2;
+  char *nd = (char *)realloc(b->data, ncap);
+  if (!nd) return 0;
+  b->data = nd;
+  b->cap = ncap;
+  return 1;
+}
+
+static int fun_sockbuf_append(FunSockBuf *b, const char *p, size_t n) {
+  if (!fun_sockbuf_reserve(b, n)) return 0;
+  memcpy(b->data + b->start + b->len, p, n);
+  b->len += n;
+  return 1;
+}
+
+/** Drop n bytes from the front (all when n exceeds the length). */
+static void fun_sockbuf_consume(FunSockBuf *b, size_t n) {
+  if (n >= b->len) {
+    b->start = 0;
+    b->len = 0;
+    return;
+  }
+  b->start += n;
+  b->len -= n;
+}
+
+/** Map a failed recv/send errno to FUN_IO_AGAIN or FUN_IO_ERROR. */
+static int fun_io_errno_result(void) {
+  return (errno == EAGAIN || errno == EWOULDBLOCK) ? FUN_IO_AGAIN : FUN_IO_ERROR;
+}
+
+#ifdef __unix__
+#ifdef MSG_NOSIGNAL
+#define FUN_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define FUN_SEND_FLAGS 0
+#endif
+
+/** One recv into the free tail of b; result per the I/O convention. */
+static int64_t fun_sockbuf_recv(int fd, FunSockBuf *b) {
+  if (!fun_sockbuf_reserve(b, FUN_SOCKBUF_MIN_READ)) return FUN_IO_ERROR;
+  size_t room = b->cap - b->start - b->len;
+  if (room > FUN_SOCKBUF_MAX_READ) room = FUN_SOCKBUF_MAX_READ;
+  ssize_t n;
+  do {
+    n = recv(fd, b->data + b->start + b->len, room, 0);
+  } while (n < 0 && errno == EINTR);
+  if (n < 0) return fun_io_errno_result();
+  b->len += (size_t)n;
+  return (int64_t)n;
+}
+
+/**
+ * @brief Send p[0..n) until done or the socket would block.
+ * @return Bytes sent (n when complete), FUN_IO_AGAIN if nothing could be
+ *         sent, FUN_IO_ERROR on error.
+ */
+static int64_t fun_send_all(int fd, const char *p, size_t n) {
+  size_t off = 0;
+  while (off < n) {
+    ssize_t w = send(fd, p + off, n - off, FUN_SEND_FLAGS);
+    if (w < 0) {
+      if (errno == EINTR) continue;
+      int r = fun_io_errno_result();
+      if (r == FUN_IO_AGAIN && off > 0) break;
+      return r;
+    }
+    off += (size_t)w;
+  }
+  return (int64_t)off;
+}
+
+#define FUN_IOV_STACK 16
+
+/**
+ * @brief One readv() into the free tails of the buffers in the array bufs
+ *        (filled in order; each first gets FUN_SOCKBUF_MIN_READ free bytes).
+ * @return I/O result; -1 also for an empty array or unknown buffer handles.
+ */
+static int64_t fun_sockbuf_readv(int fd, const Value *bufs) {
+  int nb = array_length(bufs);
+  if (nb <= 0 || nb > IOV_MAX) return FUN_IO_ERROR;
+  struct iovec iov_stack[FUN_IOV_STACK];
+  FunSockBuf *sb_stack[FUN_IOV_STACK];
+  struct iovec *iov = nb <= FUN_IOV_STACK ? iov_stack : (struct iovec *)malloc(sizeof(struct iovec) * (size_t)nb);
+  FunSockBuf **sb = nb <= FUN_IOV_STACK ? sb_stack : (FunSockBuf **)malloc(sizeof(FunSockBuf *) * (size_t)nb);
+  int64_t res = FUN_IO_ERROR;
+  int held = 0; /* sb[0..held) are borrowed */
+  if (!iov || !sb) goto done;
+  for (int i = 0; i < nb; ++i) {
+    Value h = array_peek_value(bufs, i);
+    sb[i] = h.type == VAL_INT ? fun_sockbuf_acquire(h.i) : NULL;
+    if (!sb[i]) goto done;
+    held++;
+    if (!fun_sockbuf_reserve(sb[i], FUN_SOCKBUF_MIN_READ)) goto done;
+    iov[i].iov_base = sb[i]->data + sb[i]->start + sb[i]->len;
+    iov[i].iov_len = sb[i]->cap - sb[i]->start - sb[i]->len;
+  }
+  ssize_t n;
+  do {
+    n = readv(fd, iov, nb);
+  } while (n < 0 && errno == EINTR);
+  if (n < 0) {
+    res = fun_io_errno_result();
+    goto done;
+  }
+  res = (int64_t)n;
+  for (int i = 0; i < nb && n > 0; ++i) {
+    size_t take = (size_t)n < iov[i].iov_len ? (size_t)n : iov[i].iov_len;
+    sb[i]->len += take;
+    n -= (ssize_t)take;
+  }
+done:
+  for (int i = 0; i < held; ++i)
+    fun_sockbuf_release(array_peek_value(bufs, i).i);
+  if (iov != iov_stack) free(iov);
+  if (sb != sb_stack) free(sb);
+  return res;
+}
+
+/**
+ * @brief writev() the parts (strings or buffer handles) until all are sent or
+ *        the socket would block. Buffers are consumed by the bytes sent from them.
+ * @return Bytes sent, FUN_IO_AGAIN if nothing could be sent, FUN_IO_ERROR on
+ *         error (including a part that is neither a string nor a buffer).
+ */
+static int64_t fun_writev_parts(int fd, const Value *parts) {
+  int np = array_length(parts);
+  if (np < 0 || np > IOV_MAX) return FUN_IO_ERROR;
+  if (np == 0) return 0;
+  struct iovec iov_stack[FUN_IOV_STACK];
+  FunSockBuf *sb_stack[FUN_IOV_STACK];
+  struct iovec *iov = np <= FUN_IOV_STACK ? iov_stack : (struct iovec *)malloc(sizeof(struct iovec) * (size_t)np);
+  FunSockBuf **sb = np <= FUN_IOV_STACK ? sb_stack : (FunSockBuf **)malloc(sizeof(FunSockBuf *) * (size_t)np);
+  int64_t res = FUN_IO_ERROR;
+  size_t total = 0, sent = 0;
+  int seen = 0; /* sb[0..seen) are set; non-NULL entries are borrowed */
+  if (!iov || !sb) goto done;
+  for (int i = 0; i < np; ++i) {
+    Value v = array_peek_value(parts, i);
+    sb[i] = NULL;
+    seen++;
+    if (v.type == VAL_STRING) {
+      iov[i].iov_base = v.s ? v.s : (char *)"";
+      iov[i].iov_len = v.s ? strlen(v.s) : 0;
+    } else if (v.type == VAL_INT && (sb[i] = fun_sockbuf_acquire(v.i)) != NULL) {
+      iov[i].iov_base = sb[i]->data + sb[i]->start;
+      iov[i].iov_len = sb[i]->len;
+    } else {
+      goto done;
+    }
+    total += iov[i].iov_len;
+  }
+  /* consumption below needs the original part lengths; keep them in a copy */
+  {
+    struct iovec *cur = iov;
+    int left = np;
+    struct iovec cur_stack[FUN_IOV_STACK];
+    struct iovec *work = np <= FUN_IOV_STACK ? cur_stack : (struct iovec *)malloc(sizeof(struct iovec) * (size_t)np);
+    if (!work) goto done;
+    memcpy(work, iov, sizeof(struct iovec) * (size_t)np);
+    cur = work;
+    while (sent < total) {
+#ifdef MSG_NOSIGNAL
+      struct msghdr msg;
+      memset(&msg, 0, sizeof(msg));
+      msg.msg_iov = cur;
+      msg.msg_iovlen = (size_t)left;
+      ssize_t w = sendmsg(fd, &msg, MSG_NOSIGNAL);
+#else
+      ssize_t w = writev(fd, cur, left);
+#endif
+      if (w < 0) {
+        if (errno == EINTR) continue;
+        int r = fun_io_errno_result();
+        if (!(r == FUN_IO_AGAIN && sent > 0)) res = r;
+        break;
+      }
+      sent += (size_t)w;
+      /* skip fully written parts, trim the partially written one */
+      while (left > 0 && (size_t)w >= cur->iov_len) {
+        w -= (ssize_t)cur->iov_len;
+        cur++;
+        left--;
+      }
+      if (left > 0) {
+        cur->iov_base = (char *)cur->iov_base + w;
+        cur->iov_len -= (size_t)w;
+      }
+    }
+    if (work != cur_stack) free(work);
+  }
+  if (sent > 0 || total == 0) res = (int64_t)sent;
+  /* consume what was sent from buffer parts */
+  {
+    size_t left_bytes = sent;
+    for (int i = 0; i < np && left_bytes > 0; ++i) {
+      size_t take = left_bytes < iov[i].iov_len ? left_bytes : iov[i].iov_len;
+      if (sb[i]) fun_sockbuf_consume(sb[i], take);
+      left_bytes -= take;
+    }
+  }
+done:
+  for (int i = 0; i < seen; ++i)
+    if (sb[i]) fun_sockbuf_release(array_peek_value(parts, i).i);
+  if (iov != iov_stack) free(iov);
+  if (sb != sb_stack) free(sb);
+  return res;
+}
+#endif
@@ -0,0 +1,36 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file socket_buf_append.c
+ * @brief Implements OP_SOCK_BUF_APPEND (sock_buf_append(buf, data)).
+ *
+ * Behavior:
+ * - Pops data (string; other values are stringified) and a buffer handle.
+ * - Appends the bytes and pushes the new length, or -1 if the handle is
+ *   unknown or memory ran out. Used to queue output for sock_send_all().
+ */
+
+case OP_SOCK_BUF_APPEND: {
+  Value datav = pop_value(vm);
+  Value bv = pop_value(vm);
+  FunSockBuf *b = bv.type == VAL_INT ? fun_sockbuf_acquire(bv.i) : NULL;
+  int64_t res = -1;
+  if (b) {
+    char *tmp = datav.type == VAL_STRING ? NULL : value_to_string_alloc(&datav);
+    const char *p = datav.type == VAL_STRING ? (datav.s ? datav.s : "") : (tmp ? tmp : "");
+    if (fun_sockbuf_append(b, p, strlen(p))) res = (int64_t)b->len;
+    free(tmp);
+    fun_sockbuf_release(bv.i);
+  }
+  free_value(datav);
+  free_value(bv);
+  push_value(vm, make_int(res));
+  break;
+}
@@ -0,0 +1,34 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file socket_buf_consume.c
+ * @brief Implements OP_SOCK_BUF_CONSUME (sock_buf_consume(buf, n)).
+ *
+ * Behavior:
+ * - Pops n (int) and a buffer handle; drops the first n bytes (for example
+ *   the "consumed" count of http_parse_request) without creating a string.
+ * - Pushes the remaining length, or -1 if the handle is unknown.
+ */
+
+case OP_SOCK_BUF_CONSUME: {
+  Value nv = pop_value(vm);
+  Value bv = pop_value(vm);
+  FunSockBuf *b = bv.type == VAL_INT ? fun_sockbuf_acquire(bv.i) : NULL;
+  int64_t res = -1;
+  if (b) {
+    if (nv.type == VAL_INT && nv.i > 0) fun_sockbuf_consume(b, (size_t)nv.i);
+    res = (int64_t)b->len;
+    fun_sockbuf_release(bv.i);
+  }
+  free_value(nv);
+  free_value(bv);
+  push_value(vm, make_int(res));
+  break;
+}
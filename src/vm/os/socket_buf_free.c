@@ -0,0 +1,25 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file socket_buf_free.c
+ * @brief Implements OP_SOCK_BUF_FREE (sock_buf_free(buf)).
+ *
+ * Behavior:
+ * - Pops a buffer handle, frees the buffer and pushes 1, or 0 if the handle
+ *   is unknown or already freed.
+ */
+
+case OP_SOCK_BUF_FREE: {
+  Value bv = pop_value(vm);
+  int ok = bv.type == VAL_INT ? fun_sockbuf_free(bv.i) : 0;
+  free_value(bv);
+  push_value(vm, make_int(ok));
+  break;
+}
@@ -0,0 +1,30 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file socket_buf_len.c
+ * @brief Implements OP_SOCK_BUF_LEN (sock_buf_len(buf)).
+ *
+ * Behavior:
+ * - Pops a buffer handle; pushes the number of bytes stored, or -1 if the
+ *   handle is unknown.
+ */
+
+case OP_SOCK_BUF_LEN: {
+  Value bv = pop_value(vm);
+  FunSockBuf *b = bv.type == VAL_INT ? fun_sockbuf_acquire(bv.i) : NULL;
+  int64_t len = -1;
+  if (b) {
+    len = (int64_t)b->len;
+    fun_sockbuf_release(bv.i);
+  }
+  free_value(bv);
+  push_value(vm, make_int(len));
+  break;
+}
@@ -0,0 +1,33 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file socket_buf_new.c
+ * @brief Implements OP_SOCK_BUF_NEW (sock_buf_new(capacity)).
+ *
+ * Behavior:
+ * - Pops the initial capacity in bytes (int; <= 0 selects the 16 KB default).
+ * - Pushes a buffer handle (>0), or 0 on allocation failure. Buffers grow as
+ *   needed and live until sock_buf_free().
+ *
+ * Errors:
+ * - A non-int capacity prints a type error and pushes 0.
+ */
+
+case OP_SOCK_BUF_NEW: {
+  Value capv = pop_value(vm);
+  int64_t id = 0;
+  if (capv.type != VAL_INT)
+    fprintf(stderr, "Runtime type error: sock_buf_new expects (int capacity)\n");
+  else
+    id = fun_sockbuf_new(capv.i);
+  free_value(capv);
+  push_value(vm, make_int(id));
+  break;
+}
@@ -0,0 +1,41 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file socket_buf_take.c
+ * @brief Implements OP_SOCK_BUF_TAKE (sock_buf_take(buf, n)).
+ *
+ * Behavior:
+ * - Pops n (int) and a buffer handle.
+ * - Removes the first n bytes (all of them when n < 0 or n exceeds the
+ *   length) and pushes them as a string. Fun strings end at the first NUL
+ *   byte, so binary data is cut there; the bytes are consumed either way.
+ * - Pushes "" for an unknown handle.
+ */
+
+case OP_SOCK_BUF_TAKE: {
+  Value nv = pop_value(vm);
+  Value bv = pop_value(vm);
+  FunSockBuf *b = bv.type == VAL_INT ? fun_sockbuf_acquire(bv.i) : NULL;
+  Value res = make_string("");
+  if (b && b->len > 0) {
+    size_t n = (nv.type != VAL_INT || nv.i < 0 || (uint64_t)nv.i > b->len) ? b->len : (size_t)nv.i;
+    Value s = make_string_len(b->data + b->start, n);
+    if (s.s) {
+      free_value(res);
+      res = s;
+      fun_sockbuf_consume(b, n);
+    }
+  }
+  if (b) fun_sockbuf_release(bv.i);
+  free_value(nv);
+  free_value(bv);
+  push_value(vm, res);
+  break;
+}
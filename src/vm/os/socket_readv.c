@@ -0,0 +1,34 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file socket_readv.c
+ * @brief Implements OP_SOCK_READV (sock_readv(fd, bufs)).
+ *
+ * Behavior:
+ * - Pops an array of buffer handles and a socket fd; performs one readv()
+ *   that fills the buffers' free space in array order (each buffer first
+ *   gets at least 16 KB of free space).
+ * - Pushes the total bytes read, 0 on EOF, -1 on error (also for an empty
+ *   array or unknown handles) or -2 if the socket would block.
+ * - On non-UNIX platforms, pushes -1 (unsupported).
+ */
+
+case OP_SOCK_READV: {
+  Value bufsv = pop_value(vm);
+  Value fdv = pop_value(vm);
+  int64_t res = FUN_IO_ERROR;
+#ifdef __unix__
+  if (fdv.type == VAL_INT && bufsv.type == VAL_ARRAY) res = fun_sockbuf_readv((int)fdv.i, &bufsv);
+#endif
+  free_value(bufsv);
+  free_value(fdv);
+  push_value(vm, make_int(res));
+  break;
+}
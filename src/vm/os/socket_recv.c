@@ -14,6 +14,8 @@
  * Behavior:
  * - Pops max_len (int) and fd (int); attempts to read up to max_len bytes; pushes a string with the bytes read.
  * - On EOF or error, pushes empty string. Non-UNIX platforms return empty string (unsupported).
+ *   Use sock_recv_into() to tell EOF, would-block and errors apart.
+ * - Up to 16 KB are received on the C stack; only the bytes that arrived are allocated.
  *
  * Errors:
  * - If argument types are wrong, prints an error and pushes empty string.
@@ -23,7 +25,7 @@ case OP_SOCK_RECV: {
   /* Pops maxlen, fd; pushes data string ("" on EOF/error) */
   Value maxv = pop_value(vm);
   Value fdv = pop_value(vm);
-  char *out = NULL;
+  Value s = make_nil();
 #ifdef __unix__
   if (fdv.type != VAL_INT || maxv.type != VAL_INT) {
     fprintf(stderr, "Runtime type error: sock_recv expects (int fd, int maxlen)\n");
@@ -36,21 +38,23 @@ case OP_SOCK_RECV: {
   int maxlen = (int)maxv.i;
   if (maxlen <= 0) maxlen = 4096;
   if (maxlen > 1 << 20) maxlen = 1 << 20; /* cap at 1MB */
-  out = (char *)malloc((size_t)maxlen + 1);
-  if (out) {
-    ssize_t n = recv(fd, out, (size_t)maxlen, 0);
-    if (n <= 0) {
-      free(out);
-      out = NULL;
-    } else {
-      out[n] = '\0';
+  /* receive into scratch space, then allocate only what arrived */
+  char stack_buf[16384];
+  char *tmp = maxlen <= (int)sizeof(stack_buf) ? stack_buf : (char *)malloc((size_t)maxlen);
+  if (tmp) {
+    ssize_t n;
+    do {
+      n = recv(fd, tmp, (size_t)maxlen, 0);
+    } while (n < 0 && errno == EINTR);
+    if (n > 0) {
+      s = make_string_len(tmp, (size_t)n);
+      if (!s.s) s = make_nil();
     }
+    if (tmp != stack_buf) free(tmp);
   }
 #endif
   free_value(maxv);
   free_value(fdv);
-  Value s = make_string(out ? out : "");
-  if (out) free(out);
-  push_value(vm, s);
+  push_value(vm, s.type == VAL_STRING ? s : make_string(""));
   break;
 }
@@ -0,0 +1,38 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file socket_recv_into.c
+ * @brief Implements OP_SOCK_RECV_INTO (sock_recv_into(fd, buf)).
+ *
+ * Behavior:
+ * - Pops a buffer handle and a socket fd; performs one recv() of up to 64 KB
+ *   straight into the buffer's free space (growing it when less than 16 KB is
+ *   free), so steady-state receives do not allocate.
+ * - Pushes n > 0 (bytes appended), 0 (EOF: peer closed), -1 (error or
+ *   unknown buffer) or -2 (non-blocking socket has no data yet).
+ * - On non-UNIX platforms, pushes -1 (unsupported).
+ */
+
+case OP_SOCK_RECV_INTO: {
+  Value bv = pop_value(vm);
+  Value fdv = pop_value(vm);
+  int64_t res = FUN_IO_ERROR;
+#ifdef __unix__
+  FunSockBuf *b = bv.type == VAL_INT ? fun_sockbuf_acquire(bv.i) : NULL;
+  if (b) {
+    if (fdv.type == VAL_INT) res = fun_sockbuf_recv((int)fdv.i, b);
+    fun_sockbuf_release(bv.i);
+  }
+#endif
+  free_value(bv);
+  free_value(fdv);
+  push_value(vm, make_int(res));
+  break;
+}
@@ -14,6 +14,7 @@
  * Behavior:
  * - Pops data (string) and a socket file descriptor (int) and pushes the number of bytes sent (>=0) or -1 on error.
  * - On non-UNIX platforms, pushes -1 (unsupported) without sending.
+ * - Sends with MSG_NOSIGNAL where available, so writing to a closed peer returns -1 instead of raising SIGPIPE.
  *
  * Errors:
  * - If argument types are wrong, prints an error, frees values, and pushes -1.
@@ -35,7 +36,12 @@ case OP_SOCK_SEND: {
   int fd = (int)fdv.i;
   const char *buf = datav.s ? datav.s : "";
   size_t len = strlen(buf);
+#ifdef MSG_NOSIGNAL
+  /* a peer that already closed must not kill the process with SIGPIPE */
+  ssize_t n = send(fd, buf, len, MSG_NOSIGNAL);
+#else
   ssize_t n = send(fd, buf, len, 0);
+#endif
   if (n >= 0)
     sent = (int)n;
   else
@@ -0,0 +1,47 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file socket_send_all.c
+ * @brief Implements OP_SOCK_SEND_ALL (sock_send_all(fd, data)).
+ *
+ * Behavior:
+ * - Pops data (string or buffer handle) and a socket fd.
+ * - Calls send() until everything is sent or the (non-blocking) socket would
+ *   block; a blocking socket therefore always sends everything. A buffer is
+ *   consumed by the bytes sent, so calling again continues where it stopped.
+ * - Pushes the number of bytes sent (the full length when complete), -2 if
+ *   nothing could be sent because the socket would block, or -1 on error.
+ *   A closed peer yields -1, not SIGPIPE.
+ * - On non-UNIX platforms, pushes -1 (unsupported).
+ */
+
+case OP_SOCK_SEND_ALL: {
+  Value datav = pop_value(vm);
+  Value fdv = pop_value(vm);
+  int64_t res = FUN_IO_ERROR;
+#ifdef __unix__
+  if (fdv.type == VAL_INT && datav.type == VAL_STRING) {
+    res = fun_send_all((int)fdv.i, datav.s ? datav.s : "", datav.s ? strlen(datav.s) : 0);
+  } else if (fdv.type == VAL_INT && datav.type == VAL_INT) {
+    FunSockBuf *b = fun_sockbuf_acquire(datav.i);
+    if (b) {
+      res = fun_send_all((int)fdv.i, b->data + b->start, b->len);
+      if (res > 0) fun_sockbuf_consume(b, (size_t)res);
+      fun_sockbuf_release(datav.i);
+    }
+  } else {
+    fprintf(stderr, "Runtime type error: sock_send_all expects (int fd, string or buffer data)\n");
+  }
+#endif
+  free_value(datav);
+  free_value(fdv);
+  push_value(vm, make_int(res));
+  break;
+}
@@ -0,0 +1,60 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file socket_sendfile.c
+ * @brief Implements OP_SOCK_SENDFILE (sock_sendfile(fd, path, offset, len [, head])).
+ *
+ * Behavior:
+ * - Pops head (string, only when operand == 1), len (int; <= 0 means to end
+ *   of file), offset (int), path (string) and a socket fd (int).
+ * - head (e.g. the response headers) is sent first and coalesced with the
+ *   start of the file into one segment.
+ * - Sends the file range with sendfile() on Linux (a pread/send loop
+ *   elsewhere) from the open-file cache in vm/os/file_cache_common.c, so the
+ *   bytes never become a Fun string.
+ * - Pushes the number of bytes sent, head included. Like send() this may be
+ *   less than asked for; 0 means the (non-blocking) socket would block or
+ *   there was nothing to send; -1 means error, a missing path or not a
+ *   regular file.
+ * - A peer that already closed yields -1, not SIGPIPE.
+ * - On non-UNIX platforms, pushes -1 (unsupported).
+ *
+ * Errors:
+ * - If argument types are wrong, prints an error and pushes -1.
+ */
+
+case OP_SOCK_SENDFILE: {
+  Value headv = inst.operand == 1 ? pop_value(vm) : make_nil();
+  Value lenv = pop_value(vm);
+  Value offv = pop_value(vm);
+  Value pathv = pop_value(vm);
+  Value fdv = pop_value(vm);
+  int64_t sent = -1;
+#ifdef __unix__
+  if (fdv.type != VAL_INT || pathv.type != VAL_STRING || offv.type != VAL_INT || lenv.type != VAL_INT ||
+      (headv.type != VAL_NIL && headv.type != VAL_STRING)) {
+    fprintf(stderr, "Runtime type error: sock_sendfile expects (int fd, string path, int offset, int len [, string head])\n");
+  } else {
+    FunFileEntry *e = fun_file_cache_acquire(pathv.s ? pathv.s : "");
+    if (e) {
+      const char *head = headv.type == VAL_STRING && headv.s ? headv.s : "";
+      sent = fun_file_cache_send((int)fdv.i, e, offv.i, lenv.i, head, strlen(head));
+      fun_file_cache_release(e);
+    }
+  }
+#endif
+  free_value(headv);
+  free_value(lenv);
+  free_value(offv);
+  free_value(pathv);
+  free_value(fdv);
+  push_value(vm, make_int(sent));
+  break;
+}
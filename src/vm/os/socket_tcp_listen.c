@@ -12,20 +12,34 @@
  * @brief Implements OP_SOCK_TCP_LISTEN to create a TCP listening socket.
  *
  * Behavior:
- * - Pops port (int); creates a listening socket bound to INADDR_ANY; pushes fd (>0) on success or 0.
+ * - Pops port (int) and backlog (int), and an options map when operand == 1;
+ *   creates a listening socket (SO_REUSEADDR) bound to INADDR_ANY; pushes fd
+ *   (>0) on success or 0.
+ * - Options (all optional):
+ *   - "host": address or name to bind instead of all interfaces.
+ *   - "reuseport": SO_REUSEPORT, so several processes can each listen on the
+ *     same port with their own socket and the kernel spreads connections
+ *     across them (prefork servers).
+ *   - "nodelay": TCP_NODELAY on the listener; accepted sockets inherit it on
+ *     Linux and the BSDs.
+ *   - "defer_accept": seconds (or true for 1); TCP_DEFER_ACCEPT on Linux, so
+ *     accept() only returns connections that have sent data. Ignored elsewhere.
  *
  * Errors:
  * - On wrong type or OS errors, prints an error and pushes 0. Non-UNIX platforms return 0.
+ * - "reuseport" on a platform without SO_REUSEPORT fails with an error.
  */
 
 case OP_SOCK_TCP_LISTEN: {
-  /* Pops backlog, port; pushes listen fd (>0) or 0 */
+  /* Pops [options], backlog, port; pushes listen fd (>0) or 0 */
+  Value optv = inst.operand == 1 ? pop_value(vm) : make_nil();
   Value backlogv = pop_value(vm);
   Value portv = pop_value(vm);
   int fd = 0;
 #ifdef __unix__
-  if (portv.type != VAL_INT || backlogv.type != VAL_INT) {
-    fprintf(stderr, "Runtime type error: tcp_listen expects (int port, int backlog)\n");
+  if (portv.type != VAL_INT || backlogv.type != VAL_INT || (optv.type != VAL_MAP && optv.type != VAL_NIL)) {
+    fprintf(stderr, "Runtime type error: tcp_listen expects (int port, int backlog [, map options])\n");
+    free_value(optv);
     free_value(backlogv);
     free_value(portv);
     push_value(vm, make_int(0));
@@ -33,15 +47,67 @@ case OP_SOCK_TCP_LISTEN: {
   }
   int port = (int)portv.i;
   int backlog = (int)backlogv.i;
-  int s = socket(AF_INET, SOCK_STREAM, 0);
+  int reuseport = 0, nodelay = 0, defer_accept = 0;
+  char *host = NULL;
+  if (optv.type == VAL_MAP) {
+    Value ov;
+    if (map_get_copy(&optv, "reuseport", &ov)) {
+      reuseport = value_is_truthy(&ov);
+      free_value(ov);
+    }
+    if (map_get_copy(&optv, "nodelay", &ov)) {
+      nodelay = value_is_truthy(&ov);
+      free_value(ov);
+    }
+    if (map_get_copy(&optv, "defer_accept", &ov)) {
+      defer_accept = ov.type == VAL_INT ? (int)ov.i : value_is_truthy(&ov);
+      free_value(ov);
+    }
+    if (map_get_copy(&optv, "host", &ov)) {
+      if (ov.type == VAL_STRING && ov.s && ov.s[0]) host = strdup(ov.s);
+      free_value(ov);
+    }
+  }
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons((uint16_t)port);
+  int ok = 1;
+  if (host) {
+    struct addrinfo hints, *res = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, NULL, &hints, &res) == 0 && res) {
+      addr.sin_addr = ((struct sockaddr_in *)res->ai_addr)->sin_addr;
+      freeaddrinfo(res);
+    } else {
+      fprintf(stderr, "Runtime error: tcp_listen cannot resolve host '%s'\n", host);
+      ok = 0;
+    }
+    free(host);
+  }
+#ifndef SO_REUSEPORT
+  if (reuseport) {
+    fprintf(stderr, "Runtime error: tcp_listen option reuseport is not supported on this platform\n");
+    ok = 0;
+  }
+#endif
+  int s = ok ? socket(AF_INET, SOCK_STREAM, 0) : -1;
   if (s >= 0) {
     int yes = 1;
     setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
-    struct sockaddr_in addr;
-    memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_addr.s_addr = htonl(INADDR_ANY);
-    addr.sin_port = htons((uint16_t)port);
+#ifdef SO_REUSEPORT
+    /* must be set before bind() on every socket sharing the port */
+    if (reuseport) setsockopt(s, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof(yes));
+#endif
+    if (nodelay) setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+#ifdef TCP_DEFER_ACCEPT
+    if (defer_accept > 0) setsockopt(s, IPPROTO_TCP, TCP_DEFER_ACCEPT, &defer_accept, sizeof(defer_accept));
+#else
+    (void)defer_accept;
+#endif
     if (bind(s, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
       if (listen(s, backlog > 0 ? backlog : 1) == 0) {
         fd = s;
@@ -55,6 +121,7 @@ case OP_SOCK_TCP_LISTEN: {
 #else
   (void)fd;
 #endif
+  free_value(optv);
   free_value(backlogv);
   free_value(portv);
   push_value(vm, make_int(fd > 0 ? fd : 0));
@@ -0,0 +1,35 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file socket_writev.c
+ * @brief Implements OP_SOCK_WRITEV (sock_writev(fd, parts)).
+ *
+ * Behavior:
+ * - Pops an array of parts (strings or buffer handles) and a socket fd.
+ * - Sends the parts with vectored writes, without joining them first, until
+ *   all are sent or the socket would block. Buffer parts are consumed by the
+ *   bytes sent from them; for string parts the caller uses the count.
+ * - Pushes the bytes sent, -2 if nothing could be sent because the socket
+ *   would block, or -1 on error (also for a part of another type).
+ * - On non-UNIX platforms, pushes -1 (unsupported).
+ */
+
+case OP_SOCK_WRITEV: {
+  Value partsv = pop_value(vm);
+  Value fdv = pop_value(vm);
+  int64_t res = FUN_IO_ERROR;
+#ifdef __unix__
+  if (fdv.type == VAL_INT && partsv.type == VAL_ARRAY) res = fun_writev_parts((int)fdv.i, &partsv);
+#endif
+  free_value(partsv);
+  free_value(fdv);
+  push_value(vm, make_int(res));
+  break;
+}
@@ -144,7 +144,7 @@ static fun_thread_ret_t fun_thread_main(void *param)
   }
   free(task->args);
   bytecode_free(wrap);
-  vm_reset(tvm);
+  vm_free(tvm);
   free(tvm);
 
   /* store result */
@@ -154,6 +154,7 @@ static fun_thread_ret_t fun_thread_main(void *param)
   fun_unlock();
 
   free(task);
+  pool_thread_release();
 
 #ifdef _WIN32
   return 0;
@@ -30,7 +30,7 @@ case OP_PCSC_CONNECT: {
   Value vreader = pop_value(vm);
   Value vctx = pop_value(vm);
 
-  int ctx_id = (int)vctx.i;
+  int64_t ctx_id = vctx.type == VAL_INT ? vctx.i : 0;
   free_value(vctx);
   char *rname = value_to_string_alloc(&vreader);
   free_value(vreader);
@@ -42,7 +42,7 @@ case OP_PCSC_CONNECT: {
     break;
   }
 
-  int hslot = pcsc_alloc_card_slot();
+  int64_t hslot = pcsc_alloc_card_slot();
   if (!hslot) {
     free(rname);
     push_value(vm, make_int(0));
@@ -55,7 +55,7 @@ case OP_PCSC_CONNECT: {
                          &ce->h, &dwActive);
   free(rname);
   if (rv != SCARD_S_SUCCESS) {
-    ce->in_use = 0;
+    pcsc_free_card(hslot);
     push_value(vm, make_int(0));
     break;
   }
@@ -30,7 +30,7 @@
 case OP_PCSC_DISCONNECT: {
 #ifdef FUN_WITH_PCSC
   Value vh = pop_value(vm);
-  int hid = (int)vh.i;
+  int64_t hid = vh.type == VAL_INT ? vh.i : 0;
   free_value(vh);
   pcsc_card_entry *ce = pcsc_get_card(hid);
   if (!ce) {
@@ -38,9 +38,7 @@ case OP_PCSC_DISCONNECT: {
     break;
   }
   SCardDisconnect(ce->h, SCARD_LEAVE_CARD);
-  ce->in_use = 0;
-  ce->h = 0;
-  ce->proto = 0;
+  pcsc_free_card(hid);
   push_value(vm, make_int(1));
 #else
   Value vh = pop_value(vm);
@@ -24,7 +24,7 @@
 /* PCSC establish */
 case OP_PCSC_ESTABLISH: {
 #ifdef FUN_WITH_PCSC
-  int slot = pcsc_alloc_ctx_slot();
+  int64_t slot = pcsc_alloc_ctx_slot();
   if (!slot) {
     push_value(vm, make_int(0));
     break;
@@ -36,7 +36,7 @@ case OP_PCSC_ESTABLISH: {
   }
   LONG rv = SCardEstablishContext(SCARD_SCOPE_SYSTEM, NULL, NULL, &e->ctx);
   if (rv != SCARD_S_SUCCESS) {
-    e->in_use = 0;
+    pcsc_free_ctx(slot);
     push_value(vm, make_int(0));
     break;
   }
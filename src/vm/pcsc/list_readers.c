@@ -26,7 +26,7 @@ case OP_PCSC_LIST_READERS: {
 #ifdef FUN_WITH_PCSC
   /* Pop context id; return [] if anything goes wrong */
   Value vid = pop_value(vm);
-  int id = (int)vid.i;
+  int64_t id = vid.type == VAL_INT ? vid.i : 0;
   free_value(vid);
 
   pcsc_ctx_entry *e = pcsc_get_ctx(id);
@@ -25,7 +25,7 @@
 case OP_PCSC_RELEASE: {
 #ifdef FUN_WITH_PCSC
   Value vid = pop_value(vm);
-  int id = (int)vid.i;
+  int64_t id = vid.type == VAL_INT ? vid.i : 0;
   free_value(vid);
   pcsc_ctx_entry *e = pcsc_get_ctx(id);
   if (!e) {
@@ -33,8 +33,7 @@ case OP_PCSC_RELEASE: {
     break;
   }
   SCardReleaseContext(e->ctx);
-  e->in_use = 0;
-  e->ctx = 0;
+  pcsc_free_ctx(id);
   push_value(vm, make_int(1));
 #else
   Value vid = pop_value(vm);
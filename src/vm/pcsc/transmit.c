@@ -33,7 +33,7 @@ case OP_PCSC_TRANSMIT: {
   /* pops apdu array, handle_id */
   Value vapdu = pop_value(vm);
   Value vh = pop_value(vm);
-  int hid = (int)vh.i;
+  int64_t hid = vh.type == VAL_INT ? vh.i : 0;
   free_value(vh);
   pcsc_card_entry *ce = pcsc_get_card(hid);
 
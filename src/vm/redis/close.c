@@ -19,22 +19,17 @@
  *
  * Behavior
  * --------
- * - When FUN_WITH_REDIS is enabled, looks up the handle, calls redisFree() on
- *   the underlying connection if present, clears the pointer, and removes the
- *   registry entry. Always pushes Nil.
+ * - When FUN_WITH_REDIS is enabled, removes the registry entry, which calls
+ *   redisFree() on the connection. Unknown or already closed handles are
+ *   ignored. Always pushes Nil.
  * - When FUN_WITH_REDIS is disabled, pops the argument and pushes Nil.
  */
 
 case OP_REDIS_CLOSE: {
 #ifdef FUN_WITH_REDIS
   Value vh = pop_value(vm);
-  int hid = (int)vh.i;
+  int64_t hid = (vh.type == VAL_INT) ? vh.i : 0;
   free_value(vh);
-  RedisHandle *h = redis_reg_get(hid);
-  if (h && h->ctx) {
-    redisFree(h->ctx);
-    h->ctx = NULL;
-  }
   redis_reg_del(hid);
   push_value(vm, make_nil());
 #else
@@ -37,13 +37,13 @@ case OP_REDIS_CMD: {
 #ifdef FUN_WITH_REDIS
   Value vcmd = pop_value(vm);
   Value vh = pop_value(vm);
-  int hid = (int)vh.i;
+  int64_t hid = (vh.type == VAL_INT) ? vh.i : 0;
   char *cmd = value_to_string_alloc(&vcmd);
   free_value(vh);
   free_value(vcmd);
-  RedisHandle *h = redis_reg_get(hid);
-  if (!h || !h->ctx || !cmd) { if (cmd) free(cmd); push_value(vm, make_nil()); break; }
-  redisReply *r = (redisReply *)redisCommand(h->ctx, cmd);
+  redisContext *ctx = redis_reg_get(hid);
+  if (!ctx || !cmd) { if (cmd) free(cmd); push_value(vm, make_nil()); break; }
+  redisReply *r = (redisReply *)redisCommand(ctx, cmd);
   free(cmd);
   if (!r) { push_value(vm, make_nil()); break; }
   Value out = hiredis_reply_to_value(r);
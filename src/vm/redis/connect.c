@@ -49,13 +49,9 @@ case OP_REDIS_CONNECT: {
     push_value(vm, make_int(0));
     break;
   }
-  RedisHandle *h = redis_reg_add(ctx);
-  if (!h) {
-    redisFree(ctx);
-    push_value(vm, make_int(0));
-    break;
-  }
-  push_value(vm, make_int(h->id));
+  int64_t id = redis_reg_add(ctx);
+  if (!id) redisFree(ctx);
+  push_value(vm, make_int(id));
 #else
   Value v1 = pop_value(vm); free_value(v1);
   Value v2 = pop_value(vm); free_value(v2);
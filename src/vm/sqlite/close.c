@@ -20,14 +20,9 @@
 case OP_SQLITE_CLOSE: {
 #ifdef FUN_WITH_SQLITE
   Value vh = pop_value(vm);
-  int hid = (int)vh.i;
+  int64_t hid = (vh.type == VAL_INT) ? vh.i : 0;
   free_value(vh);
-  SqlHandle *h = sql_reg_get(hid);
-  if (h && h->db) {
-    sqlite3_close(h->db);
-    h->db = NULL;
-    sql_reg_del(hid);
-  }
+  sql_reg_del(hid);
   push_value(vm, make_nil());
 #else
   Value v = pop_value(vm);
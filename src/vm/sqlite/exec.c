@@ -21,18 +21,18 @@ case OP_SQLITE_EXEC: {
 #ifdef FUN_WITH_SQLITE
   Value vsql = pop_value(vm);
   Value vh = pop_value(vm);
-  int hid = (int)vh.i;
+  int64_t hid = (vh.type == VAL_INT) ? vh.i : 0;
   char *sql = value_to_string_alloc(&vsql);
   free_value(vh);
   free_value(vsql);
-  SqlHandle *h = sql_reg_get(hid);
-  if (!h || !h->db || !sql) {
+  sqlite3 *db = sql_reg_get(hid);
+  if (!db || !sql) {
     if (sql) free(sql);
     push_value(vm, make_int(SQLITE_MISUSE));
     break;
   }
   char *errmsg = NULL;
-  int rc = sqlite3_exec(h->db, sql, NULL, NULL, &errmsg);
+  int rc = sqlite3_exec(db, sql, NULL, NULL, &errmsg);
   if (errmsg) sqlite3_free(errmsg);
   free(sql);
   push_value(vm, make_int(rc));
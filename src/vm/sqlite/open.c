@@ -34,13 +34,9 @@ case OP_SQLITE_OPEN: {
     push_value(vm, make_int(0));
     break;
   }
-  SqlHandle *h = sql_reg_add(db);
-  if (!h) {
-    sqlite3_close(db);
-    push_value(vm, make_int(0));
-    break;
-  }
-  push_value(vm, make_int(h->id));
+  int64_t id = sql_reg_add(db);
+  if (!id) sqlite3_close(db);
+  push_value(vm, make_int(id));
 #else
   Value v = pop_value(vm);
   free_value(v);
@@ -21,18 +21,18 @@ case OP_SQLITE_QUERY: {
 #ifdef FUN_WITH_SQLITE
   Value vsql = pop_value(vm);
   Value vh = pop_value(vm);
-  int hid = (int)vh.i;
+  int64_t hid = (vh.type == VAL_INT) ? vh.i : 0;
   char *sql = value_to_string_alloc(&vsql);
   free_value(vh);
   free_value(vsql);
-  SqlHandle *h = sql_reg_get(hid);
-  if (!h || !h->db || !sql) {
+  sqlite3 *db = sql_reg_get(hid);
+  if (!db || !sql) {
     if (sql) free(sql);
     push_value(vm, make_array_from_values(NULL, 0));
     break;
   }
   sqlite3_stmt *stmt = NULL;
-  if (sqlite3_prepare_v2(h->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+  if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
     free(sql);
     push_value(vm, make_array_from_values(NULL, 0));
     break;
@@ -46,6 +46,9 @@ case OP_TYPEOF: {
   case VAL_MAP:
     tname = "Map";
     break;
+  case VAL_SET:
+    tname = "Set";
+    break;
   case VAL_NIL:
     tname = "Nil";
     break;
@@ -0,0 +1,61 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file attr.c
+ * @brief VM opcode snippet for reading one attribute of an XML element.
+ *
+ * Included by vm.c; implements OP_XML_ATTR.
+ *
+ * Opcode: OP_XML_ATTR
+ * - Stack effect: pop (string name), pop (int node_handle) → push (string | Nil)
+ * - Behavior: Looks the attribute up by name, ignoring namespaces; "prefix:name"
+ *   also matches a prefixed attribute. Pushes Nil when the attribute is
+ *   missing or the handle is invalid, so "" and absent can be told apart.
+ * - Gating: If FUN_WITH_XML2 is disabled, the inputs are discarded and Nil is
+ *   pushed.
+ */
+
+case OP_XML_ATTR: {
+#ifdef FUN_WITH_XML2
+  Value vname = pop_value(vm);
+  Value vh = pop_value(vm);
+  xmlNodePtr n = xml_node_get(vh.type == VAL_INT ? vh.i : 0);
+  free_value(vh);
+  xmlChar *v = NULL;
+  if (n && n->type == XML_ELEMENT_NODE && vname.type == VAL_STRING) {
+    const char *colon = strchr(vname.s, ':');
+    v = xmlGetProp(n, (const xmlChar *)vname.s);
+    if (!v && colon) {
+      size_t plen = (size_t)(colon - vname.s);
+      for (xmlAttrPtr a = n->properties; a; a = a->next) {
+        if (a->ns && a->ns->prefix && strlen((const char *)a->ns->prefix) == plen &&
+            strncmp((const char *)a->ns->prefix, vname.s, plen) == 0 && strcmp((const char *)a->name, colon + 1) == 0) {
+          v = xmlNodeListGetString(n->doc, a->children, 1);
+          break;
+        }
+      }
+    }
+  }
+  free_value(vname);
+  if (v) {
+    push_value(vm, make_string((const char *)v));
+    xmlFree(v);
+  } else {
+    push_value(vm, make_nil());
+  }
+#else
+  Value vname = pop_value(vm);
+  free_value(vname);
+  Value vh = pop_value(vm);
+  free_value(vh);
+  push_value(vm, make_nil());
+#endif
+  break;
+}
@@ -0,0 +1,50 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file attrs.c
+ * @brief VM opcode snippet for reading all attributes of an XML element.
+ *
+ * Included by vm.c; implements OP_XML_ATTRS.
+ *
+ * Opcode: OP_XML_ATTRS
+ * - Stack effect: pop (int node_handle) → push (map name → string value)
+ * - Behavior: Keys are the attribute names as written (with their namespace
+ *   prefix, if any). Non-elements and invalid handles yield an empty map.
+ * - Gating: If FUN_WITH_XML2 is disabled, the input is discarded and an empty
+ *   map is pushed.
+ */
+
+case OP_XML_ATTRS: {
+#ifdef FUN_WITH_XML2
+  Value vh = pop_value(vm);
+  xmlNodePtr n = xml_node_get(vh.type == VAL_INT ? vh.i : 0);
+  free_value(vh);
+  Value m = make_map_empty();
+  if (n && n->type == XML_ELEMENT_NODE) {
+    for (xmlAttrPtr a = n->properties; a; a = a->next) {
+      char qname[256];
+      const char *key = (const char *)a->name;
+      if (a->ns && a->ns->prefix) {
+        snprintf(qname, sizeof(qname), "%s:%s", (const char *)a->ns->prefix, (const char *)a->name);
+        key = qname;
+      }
+      xmlChar *v = xmlNodeListGetString(n->doc, a->children, 1);
+      map_set(&m, key, make_string(v ? (const char *)v : ""));
+      if (v) xmlFree(v);
+    }
+  }
+  push_value(vm, m);
+#else
+  Value drop = pop_value(vm);
+  free_value(drop);
+  push_value(vm, make_map_empty());
+#endif
+  break;
+}
@@ -0,0 +1,49 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file children.c
+ * @brief VM opcode snippet for listing the child elements of an XML node.
+ *
+ * Included by vm.c; implements OP_XML_CHILDREN.
+ *
+ * Opcode: OP_XML_CHILDREN
+ * - Stack effect: pop (int node_handle) → push (array of int node handles)
+ * - Behavior: Returns the element children in document order; text, comment
+ *   and other nodes are skipped (use xml_text() for text content). Each child
+ *   keeps the same handle on later calls. An invalid handle yields [].
+ * - Gating: If FUN_WITH_XML2 is disabled, the input is discarded and [] is
+ *   pushed.
+ */
+
+case OP_XML_CHILDREN: {
+#ifdef FUN_WITH_XML2
+  Value vh = pop_value(vm);
+  xmlNodePtr n = xml_node_get(vh.type == VAL_INT ? vh.i : 0);
+  free_value(vh);
+  int count = 0;
+  if (n && n->type == XML_ELEMENT_NODE) {
+    for (xmlNodePtr c = n->children; c; c = c->next)
+      if (c->type == XML_ELEMENT_NODE) count++;
+  }
+  Value *vals = count > 0 ? (Value *)malloc(sizeof(Value) * (size_t)count) : NULL;
+  int k = 0;
+  if (vals) {
+    for (xmlNodePtr c = n->children; c && k < count; c = c->next)
+      if (c->type == XML_ELEMENT_NODE) vals[k++] = make_int(xml_node_alloc(c));
+  }
+  push_value(vm, make_array_from_values(vals, k));
+  free(vals);
+#else
+  Value drop = pop_value(vm);
+  free_value(drop);
+  push_value(vm, make_array_from_values(NULL, 0));
+#endif
+  break;
+}
@@ -0,0 +1,38 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file free.c
+ * @brief VM opcode snippet for releasing an XML document.
+ *
+ * Included by vm.c; implements OP_XML_FREE.
+ *
+ * Opcode: OP_XML_FREE
+ * - Stack effect: pop (int doc_handle) → push (int 1 | 0)
+ * - Behavior: Releases the document handle, every node handle obtained from
+ *   that document, and the libxml2 document itself. Those ids become stale:
+ *   later lookups fail instead of touching freed memory. Pushes 1 if a live
+ *   document was released, 0 otherwise (including a second free).
+ * - Gating: If FUN_WITH_XML2 is disabled, the input is discarded and 0 is
+ *   pushed.
+ */
+
+case OP_XML_FREE: {
+#ifdef FUN_WITH_XML2
+  Value vh = pop_value(vm);
+  int64_t h = (vh.type == VAL_INT) ? vh.i : 0;
+  free_value(vh);
+  push_value(vm, make_int(xml_doc_free_handle(h)));
+#else
+  Value drop = pop_value(vm);
+  free_value(drop);
+  push_value(vm, make_int(0));
+#endif
+  break;
+}
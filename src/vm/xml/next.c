@@ -0,0 +1,40 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file next.c
+ * @brief VM opcode snippet for stepping to the next sibling element.
+ *
+ * Included by vm.c; implements OP_XML_NEXT.
+ *
+ * Opcode: OP_XML_NEXT
+ * - Stack effect: pop (int node_handle) → push (int node_handle | 0)
+ * - Behavior: Pushes the handle of the next sibling that is an element, or 0
+ *   when there is none or the handle is invalid. Together with xml_children()
+ *   or xml_root() this walks a level without building an array.
+ * - Gating: If FUN_WITH_XML2 is disabled, the input is discarded and 0 is
+ *   pushed.
+ */
+
+case OP_XML_NEXT: {
+#ifdef FUN_WITH_XML2
+  Value vh = pop_value(vm);
+  xmlNodePtr n = xml_node_get(vh.type == VAL_INT ? vh.i : 0);
+  free_value(vh);
+  xmlNodePtr s = (n && n->type != XML_ATTRIBUTE_NODE) ? n->next : NULL;
+  while (s && s->type != XML_ELEMENT_NODE)
+    s = s->next;
+  push_value(vm, make_int(s ? xml_node_alloc(s) : 0));
+#else
+  Value drop = pop_value(vm);
+  free_value(drop);
+  push_value(vm, make_int(0));
+#endif
+  break;
+}
@@ -0,0 +1,37 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file parent.c
+ * @brief VM opcode snippet for retrieving the parent element of an XML node.
+ *
+ * Included by vm.c; implements OP_XML_PARENT.
+ *
+ * Opcode: OP_XML_PARENT
+ * - Stack effect: pop (int node_handle) → push (int node_handle | 0)
+ * - Behavior: Pushes the handle of the enclosing element (the owner element
+ *   for an attribute node), or 0 for the root element and invalid handles.
+ * - Gating: If FUN_WITH_XML2 is disabled, the input is discarded and 0 is
+ *   pushed.
+ */
+
+case OP_XML_PARENT: {
+#ifdef FUN_WITH_XML2
+  Value vh = pop_value(vm);
+  xmlNodePtr n = xml_node_get(vh.type == VAL_INT ? vh.i : 0);
+  free_value(vh);
+  xmlNodePtr p = n ? n->parent : NULL;
+  push_value(vm, make_int(p && p->type == XML_ELEMENT_NODE ? xml_node_alloc(p) : 0));
+#else
+  Value drop = pop_value(vm);
+  free_value(drop);
+  push_value(vm, make_int(0));
+#endif
+  break;
+}
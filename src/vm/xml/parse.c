@@ -35,11 +35,7 @@
 /* OP_XML_PARSE: pops text string; pushes doc handle (>0) or 0 */
 case OP_XML_PARSE: {
 #ifdef FUN_WITH_XML2
-  static int xml_inited = 0;
-  if (!xml_inited) {
-    xmlInitParser();
-    xml_inited = 1;
-  }
+  xml_init();
   Value vtext = pop_value(vm);
   char *text = value_to_string_alloc(&vtext);
   free_value(vtext);
@@ -49,7 +45,7 @@ case OP_XML_PARSE: {
   }
   xmlDocPtr doc = xmlReadMemory(text, (int)strlen(text), NULL, NULL, XML_PARSE_NONET);
   free(text);
-  int h = 0;
+  int64_t h = 0;
   if (doc) {
     h = xml_doc_alloc(doc);
     if (!h) {
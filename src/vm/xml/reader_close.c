@@ -0,0 +1,37 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file reader_close.c
+ * @brief VM opcode snippet for closing a streaming XML reader.
+ *
+ * Included by vm.c; implements OP_XML_READER_CLOSE.
+ *
+ * Opcode: OP_XML_READER_CLOSE
+ * - Stack effect: pop (int reader_handle) → push (int 1 | 0)
+ * - Behavior: Closes the reader and its file. Documents returned by
+ *   xml_reader_record() stay valid. Pushes 1 if a live reader was closed,
+ *   0 otherwise.
+ * - Gating: If FUN_WITH_XML2 is disabled, the input is discarded and 0 is
+ *   pushed.
+ */
+
+case OP_XML_READER_CLOSE: {
+#ifdef FUN_WITH_XML2
+  Value vh = pop_value(vm);
+  int64_t h = vh.type == VAL_INT ? vh.i : 0;
+  free_value(vh);
+  push_value(vm, make_int(fun_handle_free(&g_xml_readers, h)));
+#else
+  Value drop = pop_value(vm);
+  free_value(drop);
+  push_value(vm, make_int(0));
+#endif
+  break;
+}
@@ -0,0 +1,97 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file reader_next.c
+ * @brief VM opcode snippet for pulling the next event from a streaming reader.
+ *
+ * Included by vm.c; implements OP_XML_READER_NEXT.
+ *
+ * Opcode: OP_XML_READER_NEXT
+ * - Stack effect: pop (int reader_handle) → push (map | Nil)
+ * - Behavior: Advances to the next node and pushes a map with
+ *   - type:  "start", "end", "text", "cdata", "comment", "pi" or "other"
+ *   - name:  node name ("#text" for text)
+ *   - depth: nesting depth (the root element is 0)
+ *   - value: text of text/cdata/comment/pi nodes, "" otherwise
+ *   - empty: true for a self-closing start tag (no "end" event follows)
+ *   - attrs: map of attributes (start events only)
+ *   Whitespace-only text between elements is skipped. Pushes Nil at the end
+ *   of the document, on a parse error or for an invalid handle.
+ * - Gating: If FUN_WITH_XML2 is disabled, the input is discarded and Nil is
+ *   pushed.
+ */
+
+case OP_XML_READER_NEXT: {
+#ifdef FUN_WITH_XML2
+  Value vh = pop_value(vm);
+  XmlReader *xr = xml_reader_get(vh.type == VAL_INT ? vh.i : 0);
+  free_value(vh);
+  int type = -1;
+  while (xr && xml_reader_advance(xr)) {
+    type = xmlTextReaderNodeType(xr->reader);
+    if (type != XML_READER_TYPE_WHITESPACE && type != XML_READER_TYPE_SIGNIFICANT_WHITESPACE) break;
+    type = -1;
+  }
+  if (type < 0) {
+    push_value(vm, make_nil());
+    break;
+  }
+  xmlTextReaderPtr r = xr->reader;
+  const char *tname = "other";
+  switch (type) {
+  case XML_READER_TYPE_ELEMENT:
+    tname = "start";
+    break;
+  case XML_READER_TYPE_END_ELEMENT:
+    tname = "end";
+    break;
+  case XML_READER_TYPE_TEXT:
+    tname = "text";
+    break;
+  case XML_READER_TYPE_CDATA:
+    tname = "cdata";
+    break;
+  case XML_READER_TYPE_COMMENT:
+    tname = "comment";
+    break;
+  case XML_READER_TYPE_PROCESSING_INSTRUCTION:
+    tname = "pi";
+    break;
+  default:
+    break;
+  }
+  const char *name = (const char *)xmlTextReaderConstName(r);
+  const char *value = (const char *)xmlTextReaderConstValue(r);
+  Value m = make_map_empty();
+  map_set(&m, "type", make_string(tname));
+  map_set(&m, "name", make_string(name ? name : ""));
+  map_set(&m, "depth", make_int(xmlTextReaderDepth(r)));
+  map_set(&m, "value", make_string(value ? value : ""));
+  if (type == XML_READER_TYPE_ELEMENT) {
+    map_set(&m, "empty", make_bool(xmlTextReaderIsEmptyElement(r) == 1));
+    Value attrs = make_map_empty();
+    if (xmlTextReaderHasAttributes(r) == 1) {
+      while (xmlTextReaderMoveToNextAttribute(r) == 1) {
+        const char *an = (const char *)xmlTextReaderConstName(r);
+        const char *av = (const char *)xmlTextReaderConstValue(r);
+        if (an) map_set(&attrs, an, make_string(av ? av : ""));
+      }
+      xmlTextReaderMoveToElement(r);
+    }
+    map_set(&m, "attrs", attrs);
+  }
+  push_value(vm, m);
+#else
+  Value drop = pop_value(vm);
+  free_value(drop);
+  push_value(vm, make_nil());
+#endif
+  break;
+}
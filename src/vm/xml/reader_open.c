@@ -0,0 +1,37 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file reader_open.c
+ * @brief VM opcode snippet for opening a streaming XML reader.
+ *
+ * Included by vm.c; implements OP_XML_READER_OPEN.
+ *
+ * Opcode: OP_XML_READER_OPEN
+ * - Stack effect: pop (string path) → push (int reader_handle | 0)
+ * - Behavior: Opens path with libxml2's xmlTextReader. The file is parsed
+ *   incrementally by xml_reader_next()/xml_reader_record(), so documents
+ *   larger than memory can be processed. Close with xml_reader_close().
+ * - Gating: If FUN_WITH_XML2 is disabled, the input is discarded and 0 is
+ *   pushed.
+ */
+
+case OP_XML_READER_OPEN: {
+#ifdef FUN_WITH_XML2
+  Value vpath = pop_value(vm);
+  int64_t h = vpath.type == VAL_STRING ? xml_reader_open(vpath.s) : 0;
+  free_value(vpath);
+  push_value(vm, make_int(h));
+#else
+  Value drop = pop_value(vm);
+  free_value(drop);
+  push_value(vm, make_int(0));
+#endif
+  break;
+}
@@ -0,0 +1,48 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file reader_record.c
+ * @brief VM opcode snippet for reading one record element from a stream.
+ *
+ * Included by vm.c; implements OP_XML_READER_RECORD.
+ *
+ * Opcode: OP_XML_READER_RECORD
+ * - Stack effect: pop (string name), pop (int reader_handle)
+ *   → push (int doc_handle | 0)
+ * - Behavior: Skips ahead to the next element called name (qualified or
+ *   local name), copies that element and its subtree into a new document and
+ *   pushes the document handle; its root is the record element. Use the DOM
+ *   and XPath builtins on it, then release it with xml_free(). Only one
+ *   record is held in memory at a time. Pushes 0 at the end of the stream or
+ *   for an invalid handle.
+ * - Gating: If FUN_WITH_XML2 is disabled, the inputs are discarded and 0 is
+ *   pushed.
+ */
+
+case OP_XML_READER_RECORD: {
+#ifdef FUN_WITH_XML2
+  Value vname = pop_value(vm);
+  Value vh = pop_value(vm);
+  XmlReader *xr = xml_reader_get(vh.type == VAL_INT ? vh.i : 0);
+  free_value(vh);
+  xmlDocPtr doc = (xr && vname.type == VAL_STRING) ? xml_reader_record(xr, vname.s) : NULL;
+  free_value(vname);
+  int64_t h = doc ? xml_doc_alloc(doc) : 0;
+  if (doc && !h) xmlFreeDoc(doc);
+  push_value(vm, make_int(h));
+#else
+  Value vname = pop_value(vm);
+  free_value(vname);
+  Value vh = pop_value(vm);
+  free_value(vh);
+  push_value(vm, make_int(0));
+#endif
+  break;
+}
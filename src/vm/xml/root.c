@@ -22,8 +22,8 @@
  *   pushed.
  *
  * Notes
- * - Returned node handles are managed by the XML node registry. They must be
- *   released by corresponding XML VM opcodes to avoid leaks.
+ * - Returned node handles are managed by the XML node registry. Asking for
+ *   the root again returns the same handle; xml_free(doc) releases it.
  *
  * Example
  *  - stack: [ doc_handle ]
@@ -34,10 +34,10 @@
 case OP_XML_ROOT: {
 #ifdef FUN_WITH_XML2
   Value vh = pop_value(vm);
-  int h = (vh.type == VAL_INT) ? (int)vh.i : 0;
+  int64_t h = (vh.type == VAL_INT) ? vh.i : 0;
   xmlDocPtr doc = xml_doc_get(h);
   free_value(vh);
-  int nh = 0;
+  int64_t nh = 0;
   if (doc) {
     xmlNodePtr root = xmlDocGetRootElement(doc);
     if (root) nh = xml_node_alloc(root);
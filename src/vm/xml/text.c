@@ -35,7 +35,7 @@
 case OP_XML_TEXT: {
 #ifdef FUN_WITH_XML2
   Value vh = pop_value(vm);
-  int h = (vh.type == VAL_INT) ? (int)vh.i : 0;
+  int64_t h = (vh.type == VAL_INT) ? vh.i : 0;
   xmlNodePtr n = xml_node_get(h);
   free_value(vh);
   if (!n) {
@@ -0,0 +1,116 @@
+/*
+ * This file is part of the Fun programming language.
+ * https://fun-lang.xyz/
+ *
+ * Copyright 2026 Johannes Findeisen <you@hanez.org>
+ * Licensed under the terms of the Apache-2.0 license.
+ * https://opensource.org/license/apache-2-0
+ */
+
+/**
+ * @file xpath.c
+ * @brief VM opcode snippet for evaluating XPath expressions.
+ *
+ * Included by vm.c; implements OP_XML_XPATH.
+ *
+ * Opcode: OP_XML_XPATH
+ * - Stack effect: [pop (map ns) if operand == 1], pop (string expr),
+ *   pop (int node_handle) → push (array | number | string | bool | Nil)
+ * - Behavior: Evaluates expr with the node as context node (absolute paths
+ *   search the node's whole document). Node-sets become arrays of node
+ *   handles in document order (elements, attributes, text, comments, PIs;
+ *   namespace nodes are skipped). count()/sum() and other numbers push an
+ *   int when integral, otherwise a float; strings and booleans are pushed
+ *   as such. Invalid expressions, unbound prefixes and invalid handles push
+ *   Nil (libxml2 does not print the error).
+ * - Namespaces: the optional map binds prefixes to URIs for this call, e.g.
+ *   {"c": "urn:catalog"} for "//c:product".
+ * - Compiled expressions are cached per thread (see xml_xpath_compile()), so
+ *   repeated queries are not re-parsed.
+ * - Gating: If FUN_WITH_XML2 is disabled, the inputs are discarded and Nil is
+ *   pushed.
+ */
+
+case OP_XML_XPATH: {
+#ifdef FUN_WITH_XML2
+  Value vns = inst.operand ? pop_value(vm) : make_nil();
+  Value vexpr = pop_value(vm);
+  Value vh = pop_value(vm);
+  xmlNodePtr n = xml_node_get(vh.type == VAL_INT ? vh.i : 0);
+  free_value(vh);
+  xmlXPathContextPtr ctx = (n && vexpr.type == VAL_STRING) ? xml_xpath_context(n) : NULL;
+  xmlXPathCompExprPtr comp = ctx ? xml_xpath_compile(ctx, vexpr.s) : NULL;
+  free_value(vexpr);
+  if (!comp) {
+    free_value(vns);
+    push_value(vm, make_nil());
+    break;
+  }
+  int has_ns = 0;
+  if (vns.type == VAL_MAP) {
+    Value keys = map_keys_array(&vns);
+    int nk = array_length(&keys);
+    for (int i = 0; i < nk; ++i) {
+      Value k = array_peek_value(&keys, i);
+      Value uri;
+      if (k.type == VAL_STRING && map_get_copy(&vns, k.s, &uri)) {
+        if (uri.type == VAL_STRING) {
+          xmlXPathRegisterNs(ctx, (const xmlChar *)k.s, (const xmlChar *)uri.s);
+          has_ns = 1;
+        }
+        free_value(uri);
+      }
+    }
+    free_value(keys);
+  }
+  free_value(vns);
+  xmlXPathObjectPtr obj = xmlXPathCompiledEval(comp, ctx);
+  if (has_ns) xmlXPathRegisteredNsCleanup(ctx);
+  Value out = make_nil();
+  if (obj) {
+    switch (obj->type) {
+    case XPATH_NODESET: {
+      int total = obj->nodesetval ? obj->nodesetval->nodeNr : 0;
+      Value *vals = total > 0 ? (Value *)malloc(sizeof(Value) * (size_t)total) : NULL;
+      int k = 0;
+      for (int i = 0; vals && i < total; ++i) {
+        xmlNodePtr r = obj->nodesetval->nodeTab[i];
+        if (xml_node_handleable(r)) vals[k++] = make_int(xml_node_alloc(r));
+      }
+      out = make_array_from_values(vals, k);
+      free(vals);
+      break;
+    }
+    case XPATH_BOOLEAN:
+      out = make_bool(obj->boolval);
+      break;
+    case XPATH_NUMBER: {
+      double d = obj->floatval;
+      if (d > -9007199254740992.0 && d < 9007199254740992.0 && d == (double)(int64_t)d)
+        out = make_int((int64_t)d);
+      else
+        out = make_float(d);
+      break;
+    }
+    case XPATH_STRING:
+      out = make_string(obj->stringval ? (const char *)obj->stringval : "");
+      break;
+    default:
+      break;
+    }
+    xmlXPathFreeObject(obj);
+  }
+  push_value(vm, out);
+#else
+  if (inst.operand) {
+    Value vns = pop_value(vm);
+    free_value(vns);
+  }
+  Value vexpr = pop_value(vm);
+  free_value(vexpr);
+  Value vh = pop_value(vm);
+  free_value(vh);
+  push_value(vm, make_nil());
+#endif
+  break;
+}